@@ -0,0 +1,2190 @@
+// band math: derived rasters such as NDVI computed on the fly from the bands of a multi-band source
+// An expression over band references (b1, b2, ...) is parsed once and compiled two ways:
+//   - to a GLSL function, spliced into the fragment shader that draws the tiles. The tile pipeline (LOD
+//     selection, prefetching request queue, loader threads, GPU tile cache) moves the raw bands, one
+//     2D-array texture per tile with one layer per band, and the result is computed per pixel at the level on
+//     screen. Changing the expression swaps the program and keeps every cached tile.
+//   - to a register bytecode run over blocks of samples by vectorized kernels (scalar / SSE2 / AVX2 / NEON,
+//     the widest the CPU supports), on all cores, for statistics and export. Every kernel set computes the
+//     scalar formula operation for operation, so they all give the same values.
+// The result is never materialized as a raster to view it. Statistics read a reduced level (the first with at
+// most statsSampleBudget samples, or any level with T), and export streams a level to a float TIFF a strip at
+// a time.
+// Language: numbers, b1..bN, + - * /, unary -, < and > (1 or 0), parentheses, min(a, b), max(a, b), abs(a),
+// sqrt(a), clamp(a, lo, hi). Division by zero gives 0 and sqrt of a negative gives 0, on the GPU and the CPU.
+// Bands read as 0..1 (8-bit samples / 255).
+// Without images a 4-band scene (blue, green, red, near infrared) is generated. TIFFs contribute all their
+// 8-bit samples as bands, other images their RGB channels, in command-line order. Without --expr the first
+// preset the bands allow is shown, or b1 if none does.
+// Usage: band_math [image ...] [--expr "(b4-b3)/(b4+b3)"] [--export out.tif [--level L]] [--benchmark]
+// Keys: WASD pan, Q/E zoom, 1-5 preset expressions, R stretch the ramp to the statistics, T statistics of the
+//       level on screen, K cycle kernel set, P prefetch.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <cctype>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <tiffio.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+const int tileSize = 256;
+
+// Level of Detail (LOD) bias, typically in the range -0.5 to 0.5
+float lodBias = 0.0f;
+
+// Generated scene: samples per edge and land cover patch size (samples)
+const int generatedSize = 4096;
+const int patchSize = 96;
+
+// Loader threads, GPU tile cache budget (tiles) and upload throttle (tiles per frame)
+const int loaderThreadCount = 2;
+const size_t gpuTileBudget = 256;
+const int maxUploadsPerFrame = 8;
+
+// Prediction: how far ahead the camera path is extrapolated, and the sampling step along it (seconds)
+const float predictionHorizon = 0.6f;
+const float predictionStep = 0.1f;
+// Time constant of the velocity smoothing (seconds)
+const float velocitySmoothing = 0.15f;
+// Zoom rates below this (ln(scale) per second) are treated as "not zooming"
+const float zoomRateThreshold = 0.05f;
+
+// Priority weights: seconds-equivalent cost of one level away from the current LOD / of one half view extent
+const float levelWeight = 0.5f;
+const float distanceWeight = 0.1f;
+
+// Bands a source may have (texture array layers) and registers a compiled expression may use
+const int maxBands = 16;
+const int maxRegisters = 16;
+// Samples per kernel block: maxRegisters blocks of floats stay in L1
+const int blockSize = 256;
+
+// Statistics: automatic level sample budget, histogram bins, percentiles of the automatic stretch
+const long long statsSampleBudget = 4 << 20;
+const int histogramBins = 1024;
+const float stretchLow = 0.02f, stretchHigh = 0.98f;
+
+// Compute threads; 0 uses one per hardware thread
+const int computeThreadCount = 0;
+
+// Benchmark repetitions; the best run counts
+const int benchmarkRuns = 5;
+
+// Keys 1-5
+const char* presetExpressions[] = {
+    "(b4-b3)/(b4+b3)",                      // NDVI
+    "(b2-b4)/(b2+b4)",                      // NDWI (McFeeters)
+    "2.5*(b4-b3)/(b4+6*b3-7.5*b1+1)",       // EVI
+    "((b4-b3)/(b4+b3) > 0.4) * b4",         // NIR where vegetation is dense
+    "sqrt(b1*b1 + b2*b2 + b3*b3) / sqrt(3)" // brightness
+};
+const int presetCount = 5;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+int resolveThreadCount() {
+    if (computeThreadCount > 0)
+        return computeThreadCount;
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Runs task(i) for i in [0, count) on up to threadCount threads (the caller is one of them)
+template <typename Task>
+void parallelFor(int count, int threadCount, const Task& task) {
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for (int i = next++; i < count; i = next++)
+            task(i);
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < std::min(threadCount, count); ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Expression language. Expressions parse into a node list (constant subexpressions folded on the way), which
+// compiles to a GLSL function and to a register bytecode for the CPU kernels.
+// ---------------------------------------------------------------------------------------------------------
+
+enum class BandOp : uint8_t { Band, Constant, Add, Subtract, Multiply, Divide, Min, Max, Less, Greater, Negate, Abs, Sqrt };
+
+// 8-bit band samples to 0..1
+const float sampleScale = 1.0f / 255.0f;
+
+// The reference semantics, shared by constant folding and the scalar kernel: safe division and square root,
+// comparisons as 1 or 0, min and max as plain selects (what the SIMD instructions do)
+inline float applyScalarOp(BandOp op, float a, float b) {
+    switch (op) {
+    case BandOp::Add: return a + b;
+    case BandOp::Subtract: return a - b;
+    case BandOp::Multiply: return a * b;
+    case BandOp::Divide: return b == 0.0f ? 0.0f : a / b;
+    case BandOp::Min: return a < b ? a : b;
+    case BandOp::Max: return a > b ? a : b;
+    case BandOp::Less: return a < b ? 1.0f : 0.0f;
+    case BandOp::Greater: return a > b ? 1.0f : 0.0f;
+    case BandOp::Negate: return -a;
+    case BandOp::Abs: return std::fabs(a);
+    case BandOp::Sqrt: return std::sqrt(a > 0.0f ? a : 0.0f);
+    default: return 0.0f;
+    }
+}
+
+inline bool isUnaryOp(BandOp op) { return op == BandOp::Negate || op == BandOp::Abs || op == BandOp::Sqrt; }
+
+struct ExpressionNode {
+    BandOp op = BandOp::Constant;
+    int band = 0;            // Band: zero-based band index
+    float constant = 0.0f;   // Constant
+    int a = -1, b = -1;      // operand nodes
+};
+
+// Recursive descent, lowest precedence first:
+//   comparison := additive (('<' | '>') additive)?
+//   additive   := term (('+' | '-') term)*
+//   term       := unary (('*' | '/') unary)*
+//   unary      := '-' unary | primary
+//   primary    := number | 'b' digits | name '(' comparison (',' comparison)* ')' | '(' comparison ')'
+class ExpressionParser {
+public:
+    ExpressionParser(const std::string& source, int bandCount, std::vector<ExpressionNode>& nodes)
+        : m_source(source), m_bandCount(bandCount), m_nodes(nodes) {}
+
+    // Root node, or -1 with the error set
+    int parse(std::string& error) {
+        int root = comparison();
+        skipSpace();
+        if (root >= 0 && m_position < m_source.size())
+            fail("unexpected '" + std::string(1, m_source[m_position]) + "'");
+        if (!m_error.empty()) {
+            error = m_error;
+            return -1;
+        }
+        return root;
+    }
+
+private:
+    const std::string& m_source;
+    int m_bandCount;
+    std::vector<ExpressionNode>& m_nodes;
+    size_t m_position = 0;
+    std::string m_error;
+
+    int fail(const std::string& message) {
+        if (m_error.empty())
+            m_error = message + " at column " + std::to_string(m_position + 1);
+        return -1;
+    }
+
+    void skipSpace() {
+        while (m_position < m_source.size() && std::isspace(static_cast<unsigned char>(m_source[m_position])))
+            ++m_position;
+    }
+
+    bool accept(char c) {
+        skipSpace();
+        if (m_position < m_source.size() && m_source[m_position] == c) {
+            ++m_position;
+            return true;
+        }
+        return false;
+    }
+
+    // Operations on constants are folded here, with the same semantics the kernels use
+    int makeNode(BandOp op, int a, int b = -1) {
+        if (a < 0 || (!isUnaryOp(op) && b < 0))
+            return -1;
+        if (m_nodes[a].op == BandOp::Constant && (isUnaryOp(op) || m_nodes[b].op == BandOp::Constant))
+            return makeConstant(applyScalarOp(op, m_nodes[a].constant, isUnaryOp(op) ? 0.0f : m_nodes[b].constant));
+        ExpressionNode node;
+        node.op = op;
+        node.a = a;
+        node.b = b;
+        m_nodes.push_back(node);
+        return static_cast<int>(m_nodes.size()) - 1;
+    }
+
+    int makeConstant(float value) {
+        if (!std::isfinite(value))
+            return fail("constant out of range");
+        ExpressionNode node;
+        node.constant = value;
+        m_nodes.push_back(node);
+        return static_cast<int>(m_nodes.size()) - 1;
+    }
+
+    int comparison() {
+        int left = additive();
+        if (accept('<'))
+            return makeNode(BandOp::Less, left, additive());
+        if (accept('>'))
+            return makeNode(BandOp::Greater, left, additive());
+        return left;
+    }
+
+    int additive() {
+        int left = term();
+        while (left >= 0) {
+            if (accept('+'))
+                left = makeNode(BandOp::Add, left, term());
+            else if (accept('-'))
+                left = makeNode(BandOp::Subtract, left, term());
+            else
+                break;
+        }
+        return left;
+    }
+
+    int term() {
+        int left = unary();
+        while (left >= 0) {
+            if (accept('*'))
+                left = makeNode(BandOp::Multiply, left, unary());
+            else if (accept('/'))
+                left = makeNode(BandOp::Divide, left, unary());
+            else
+                break;
+        }
+        return left;
+    }
+
+    int unary() {
+        if (accept('-'))
+            return makeNode(BandOp::Negate, unary());
+        return primary();
+    }
+
+    int primary() {
+        skipSpace();
+        if (m_position >= m_source.size())
+            return fail("unexpected end of expression");
+
+        if (accept('(')) {
+            int inner = comparison();
+            if (inner >= 0 && !accept(')'))
+                return fail("expected ')'");
+            return inner;
+        }
+
+        char c = m_source[m_position];
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            const char* start = m_source.c_str() + m_position;
+            char* end = nullptr;
+            float value = std::strtof(start, &end);
+            if (end == start)
+                return fail("bad number");
+            m_position += end - start;
+            return makeConstant(value);
+        }
+
+        if (!std::isalpha(static_cast<unsigned char>(c)))
+            return fail("unexpected '" + std::string(1, c) + "'");
+        size_t start = m_position;
+        while (m_position < m_source.size() && std::isalnum(static_cast<unsigned char>(m_source[m_position])))
+            ++m_position;
+        std::string name = m_source.substr(start, m_position - start);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+        if (name.size() > 1 && name[0] == 'b' && std::all_of(name.begin() + 1, name.end(), ::isdigit)) {
+            int band = std::atoi(name.c_str() + 1);
+            if (band < 1 || band > m_bandCount) {
+                m_position = start;
+                return fail("no band " + name + " (the source has " + std::to_string(m_bandCount) + ")");
+            }
+            ExpressionNode node;
+            node.op = BandOp::Band;
+            node.band = band - 1;
+            m_nodes.push_back(node);
+            return static_cast<int>(m_nodes.size()) - 1;
+        }
+
+        int argumentCount = name == "clamp" ? 3 : (name == "min" || name == "max") ? 2 : (name == "abs" || name == "sqrt") ? 1 : 0;
+        if (argumentCount == 0) {
+            m_position = start;
+            return fail("unknown name '" + name + "'");
+        }
+        if (!accept('('))
+            return fail("expected '(' after " + name);
+        int arguments[3] = { -1, -1, -1 };
+        for (int i = 0; i < argumentCount; ++i) {
+            if (i > 0 && !accept(','))
+                return fail(name + " takes " + std::to_string(argumentCount) + " arguments");
+            arguments[i] = comparison();
+            if (arguments[i] < 0)
+                return -1;
+        }
+        if (!accept(')'))
+            return fail("expected ')' after the arguments of " + name);
+
+        if (name == "min")
+            return makeNode(BandOp::Min, arguments[0], arguments[1]);
+        if (name == "max")
+            return makeNode(BandOp::Max, arguments[0], arguments[1]);
+        if (name == "abs")
+            return makeNode(BandOp::Abs, arguments[0]);
+        if (name == "sqrt")
+            return makeNode(BandOp::Sqrt, arguments[0]);
+        return makeNode(BandOp::Min, makeNode(BandOp::Max, arguments[0], arguments[1]), arguments[2]);
+    }
+};
+
+// One bytecode step over a block of samples: target = op(a, b), or a band load / constant fill
+struct BandInstruction {
+    BandOp op = BandOp::Constant;
+    int target = 0, a = 0, b = 0;
+    int band = 0;
+    float constant = 0.0f;
+};
+
+// A compiled expression: GLSL for display, bytecode for the CPU kernels
+class BandExpression {
+public:
+    bool compile(const std::string& source, int bandCount, std::string& error) {
+        std::vector<ExpressionNode> nodes;
+        ExpressionParser parser(source, bandCount, nodes);
+        int root = parser.parse(error);
+        if (root < 0)
+            return false;
+
+        // Registers: operands are freed as soon as they are consumed, and the operand needing more registers
+        // is evaluated first (Sethi-Ullman), so deep expressions stay within maxRegisters
+        std::vector<BandInstruction> program;
+        std::vector<int> freeRegisters;
+        int registerCount = 0;
+        std::vector<int> need(nodes.size(), 0);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            const ExpressionNode& node = nodes[i];
+            if (node.op == BandOp::Band || node.op == BandOp::Constant)
+                need[i] = 1;
+            else if (isUnaryOp(node.op))
+                need[i] = need[node.a];
+            else
+                need[i] = need[node.a] == need[node.b] ? need[node.a] + 1 : std::max(need[node.a], need[node.b]);
+        }
+        if (need[root] > maxRegisters) {
+            error = "expression needs " + std::to_string(need[root]) + " registers, at most " + std::to_string(maxRegisters);
+            return false;
+        }
+
+        auto allocate = [&]() {
+            if (!freeRegisters.empty()) {
+                int r = freeRegisters.back();
+                freeRegisters.pop_back();
+                return r;
+            }
+            return registerCount++;
+        };
+        std::function<int(int)> emit = [&](int index) -> int {
+            const ExpressionNode& node = nodes[index];
+            BandInstruction instruction;
+            instruction.op = node.op;
+            if (node.op == BandOp::Band || node.op == BandOp::Constant) {
+                instruction.band = node.band;
+                instruction.constant = node.constant;
+            } else if (isUnaryOp(node.op)) {
+                instruction.a = emit(node.a);
+                freeRegisters.push_back(instruction.a);
+            } else {
+                bool leftFirst = need[node.a] >= need[node.b];
+                int first = emit(leftFirst ? node.a : node.b);
+                int second = emit(leftFirst ? node.b : node.a);
+                instruction.a = leftFirst ? first : second;
+                instruction.b = leftFirst ? second : first;
+                freeRegisters.push_back(second);
+                freeRegisters.push_back(first);
+            }
+            instruction.target = allocate();
+            program.push_back(instruction);
+            return instruction.target;
+        };
+        m_result = emit(root);
+        m_program = std::move(program);
+        m_registerCount = registerCount;
+
+        m_usedBands.assign(bandCount, false);
+        for (const ExpressionNode& node : nodes)
+            if (node.op == BandOp::Band)
+                m_usedBands[node.band] = true;
+        m_glsl = "float bandMath()\n{\n";
+        for (int band = 0; band < bandCount; ++band)
+            if (m_usedBands[band])
+                m_glsl += "    float b" + std::to_string(band + 1) + " = texture(bands, vec3(texCoord, " + std::to_string(band) + ".0)).r;\n";
+        m_glsl += "    return " + glsl(nodes, root) + ";\n}\n";
+        m_source = source;
+        return true;
+    }
+
+    const std::string& source() const { return m_source; }
+    // float bandMath(), sampling the sampler2DArray `bands` at `texCoord`
+    const std::string& glslFunction() const { return m_glsl; }
+    const std::vector<BandInstruction>& program() const { return m_program; }
+    int registerCount() const { return m_registerCount; }
+    int resultRegister() const { return m_result; }
+    bool usesBand(int band) const { return m_usedBands[band]; }
+
+private:
+    std::string m_source;
+    std::string m_glsl;
+    std::vector<BandInstruction> m_program;
+    std::vector<bool> m_usedBands;
+    int m_registerCount = 0;
+    int m_result = 0;
+
+    static std::string glsl(const std::vector<ExpressionNode>& nodes, int index) {
+        const ExpressionNode& node = nodes[index];
+        switch (node.op) {
+        case BandOp::Band: return "b" + std::to_string(node.band + 1);
+        case BandOp::Constant: {
+            char text[32];
+            snprintf(text, sizeof(text), "%.9g", node.constant);
+            std::string literal = text;
+            if (literal.find_first_of(".eE") == std::string::npos)
+                literal += ".0";
+            return "(" + literal + ")";
+        }
+        case BandOp::Add: return "(" + glsl(nodes, node.a) + " + " + glsl(nodes, node.b) + ")";
+        case BandOp::Subtract: return "(" + glsl(nodes, node.a) + " - " + glsl(nodes, node.b) + ")";
+        case BandOp::Multiply: return "(" + glsl(nodes, node.a) + " * " + glsl(nodes, node.b) + ")";
+        case BandOp::Divide: return "bmDiv(" + glsl(nodes, node.a) + ", " + glsl(nodes, node.b) + ")";
+        case BandOp::Min: return "bmMin(" + glsl(nodes, node.a) + ", " + glsl(nodes, node.b) + ")";
+        case BandOp::Max: return "bmMax(" + glsl(nodes, node.a) + ", " + glsl(nodes, node.b) + ")";
+        case BandOp::Less: return "bmLess(" + glsl(nodes, node.a) + ", " + glsl(nodes, node.b) + ")";
+        case BandOp::Greater: return "bmGreater(" + glsl(nodes, node.a) + ", " + glsl(nodes, node.b) + ")";
+        case BandOp::Negate: return "(-" + glsl(nodes, node.a) + ")";
+        case BandOp::Abs: return "abs(" + glsl(nodes, node.a) + ")";
+        case BandOp::Sqrt: return "bmSqrt(" + glsl(nodes, node.a) + ")";
+        }
+        return "0.0";
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------
+// Band-math kernels: one bytecode instruction over samples [begin, count) of a block. Every SIMD kernel
+// computes applyScalarOp operation for operation (masked division, selects for min / max), so all kernel sets
+// give the same values.
+// ---------------------------------------------------------------------------------------------------------
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BAND_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BAND_TARGET(isa)
+#else
+#define BAND_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__aarch64__)
+#define BAND_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+struct BandMathKernels {
+    const char* name;
+    // registers[r] points at blockSize floats; bands[n] at the block's 8-bit samples of band n
+    void (*apply)(const BandInstruction& instruction, float* const* registers, const uint8_t* const* bands, size_t begin, size_t count);
+};
+
+void applyScalar(const BandInstruction& instruction, float* const* registers, const uint8_t* const* bands, size_t begin, size_t count) {
+    float* dst = registers[instruction.target];
+    if (instruction.op == BandOp::Band) {
+        const uint8_t* src = bands[instruction.band];
+        for (size_t i = begin; i < count; ++i)
+            dst[i] = static_cast<float>(src[i]) * sampleScale;
+        return;
+    }
+    if (instruction.op == BandOp::Constant) {
+        std::fill(dst + begin, dst + count, instruction.constant);
+        return;
+    }
+    const float* a = registers[instruction.a];
+    const float* b = registers[instruction.b];
+    for (size_t i = begin; i < count; ++i)
+        dst[i] = applyScalarOp(instruction.op, a[i], b[i]);
+}
+
+const BandMathKernels scalarBandMathKernels = { "scalar", applyScalar };
+
+#if BAND_KERNELS_X86
+
+BAND_TARGET("sse2") void applySse(const BandInstruction& instruction, float* const* registers, const uint8_t* const* bands, size_t begin, size_t count) {
+    float* dst = registers[instruction.target];
+    const float* a = registers[instruction.a];
+    const float* b = registers[instruction.b];
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), sign = _mm_set1_ps(-0.0f);
+    size_t i = begin;
+    switch (instruction.op) {
+    case BandOp::Band: {
+        const uint8_t* src = bands[instruction.band];
+        const __m128 scale = _mm_set1_ps(sampleScale);
+        const __m128i zeroBytes = _mm_setzero_si128();
+        for (; i + 16 <= count; i += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i low = _mm_unpacklo_epi8(bytes, zeroBytes), high = _mm_unpackhi_epi8(bytes, zeroBytes);
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zeroBytes)), scale));
+            _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zeroBytes)), scale));
+            _mm_storeu_ps(dst + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zeroBytes)), scale));
+            _mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zeroBytes)), scale));
+        }
+        break;
+    }
+    case BandOp::Constant: {
+        const __m128 value = _mm_set1_ps(instruction.constant);
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, value);
+        break;
+    }
+    case BandOp::Add:
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        break;
+    case BandOp::Subtract:
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        break;
+    case BandOp::Multiply:
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        break;
+    case BandOp::Divide:
+        for (; i + 4 <= count; i += 4) {
+            __m128 divisor = _mm_loadu_ps(b + i);
+            __m128 quotient = _mm_div_ps(_mm_loadu_ps(a + i), divisor);
+            _mm_storeu_ps(dst + i, _mm_andnot_ps(_mm_cmpeq_ps(divisor, zero), quotient));
+        }
+        break;
+    case BandOp::Min:
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_min_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        break;
+    case BandOp::Max:
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_max_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        break;
+    case BandOp::Less:
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)), one));
+        break;
+    case BandOp::Greater:
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_and_ps(_mm_cmpgt_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)), one));
+        break;
+    case BandOp::Negate:
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_xor_ps(_mm_loadu_ps(a + i), sign));
+        break;
+    case BandOp::Abs:
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_andnot_ps(sign, _mm_loadu_ps(a + i)));
+        break;
+    case BandOp::Sqrt:
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_sqrt_ps(_mm_max_ps(_mm_loadu_ps(a + i), zero)));
+        break;
+    }
+    applyScalar(instruction, registers, bands, i, count);
+}
+
+BAND_TARGET("avx2") void applyAvx2(const BandInstruction& instruction, float* const* registers, const uint8_t* const* bands, size_t begin, size_t count) {
+    float* dst = registers[instruction.target];
+    const float* a = registers[instruction.a];
+    const float* b = registers[instruction.b];
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), sign = _mm256_set1_ps(-0.0f);
+    size_t i = begin;
+    switch (instruction.op) {
+    case BandOp::Band: {
+        const uint8_t* src = bands[instruction.band];
+        const __m256 scale = _mm256_set1_ps(sampleScale);
+        for (; i + 8 <= count; i += 8) {
+            __m256i words = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)));
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(words), scale));
+        }
+        break;
+    }
+    case BandOp::Constant: {
+        const __m256 value = _mm256_set1_ps(instruction.constant);
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, value);
+        break;
+    }
+    case BandOp::Add:
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        break;
+    case BandOp::Subtract:
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        break;
+    case BandOp::Multiply:
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        break;
+    case BandOp::Divide:
+        for (; i + 8 <= count; i += 8) {
+            __m256 divisor = _mm256_loadu_ps(b + i);
+            __m256 quotient = _mm256_div_ps(_mm256_loadu_ps(a + i), divisor);
+            _mm256_storeu_ps(dst + i, _mm256_andnot_ps(_mm256_cmp_ps(divisor, zero, _CMP_EQ_OQ), quotient));
+        }
+        break;
+    case BandOp::Min:
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_min_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        break;
+    case BandOp::Max:
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_max_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        break;
+    case BandOp::Less:
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), _CMP_LT_OQ), one));
+        break;
+    case BandOp::Greater:
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), _CMP_GT_OQ), one));
+        break;
+    case BandOp::Negate:
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_xor_ps(_mm256_loadu_ps(a + i), sign));
+        break;
+    case BandOp::Abs:
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_andnot_ps(sign, _mm256_loadu_ps(a + i)));
+        break;
+    case BandOp::Sqrt:
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_sqrt_ps(_mm256_max_ps(_mm256_loadu_ps(a + i), zero)));
+        break;
+    }
+    applyScalar(instruction, registers, bands, i, count);
+}
+
+const BandMathKernels sseBandMathKernels = { "sse2", applySse };
+const BandMathKernels avx2BandMathKernels = { "avx2", applyAvx2 };
+
+#elif BAND_KERNELS_NEON
+
+// NEON min / max / max(x, 0) pick -0 over +0, so they are written as the selects the scalar code does
+void applyNeon(const BandInstruction& instruction, float* const* registers, const uint8_t* const* bands, size_t begin, size_t count) {
+    float* dst = registers[instruction.target];
+    const float* a = registers[instruction.a];
+    const float* b = registers[instruction.b];
+    const float32x4_t zero = vdupq_n_f32(0.0f), one = vdupq_n_f32(1.0f);
+    size_t i = begin;
+    switch (instruction.op) {
+    case BandOp::Band: {
+        const uint8_t* src = bands[instruction.band];
+        const float32x4_t scale = vdupq_n_f32(sampleScale);
+        for (; i + 8 <= count; i += 8) {
+            uint16x8_t words = vmovl_u8(vld1_u8(src + i));
+            vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(words))), scale));
+            vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(words))), scale));
+        }
+        break;
+    }
+    case BandOp::Constant: {
+        const float32x4_t value = vdupq_n_f32(instruction.constant);
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(dst + i, value);
+        break;
+    }
+    case BandOp::Add:
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(dst + i, vaddq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+        break;
+    case BandOp::Subtract:
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(dst + i, vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+        break;
+    case BandOp::Multiply:
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(dst + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+        break;
+    case BandOp::Divide:
+        for (; i + 4 <= count; i += 4) {
+            float32x4_t divisor = vld1q_f32(b + i);
+            float32x4_t quotient = vdivq_f32(vld1q_f32(a + i), divisor);
+            vst1q_f32(dst + i, vbslq_f32(vceqq_f32(divisor, zero), zero, quotient));
+        }
+        break;
+    case BandOp::Min:
+        for (; i + 4 <= count; i += 4) {
+            float32x4_t x = vld1q_f32(a + i), y = vld1q_f32(b + i);
+            vst1q_f32(dst + i, vbslq_f32(vcltq_f32(x, y), x, y));
+        }
+        break;
+    case BandOp::Max:
+        for (; i + 4 <= count; i += 4) {
+            float32x4_t x = vld1q_f32(a + i), y = vld1q_f32(b + i);
+            vst1q_f32(dst + i, vbslq_f32(vcgtq_f32(x, y), x, y));
+        }
+        break;
+    case BandOp::Less:
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(dst + i, vbslq_f32(vcltq_f32(vld1q_f32(a + i), vld1q_f32(b + i)), one, zero));
+        break;
+    case BandOp::Greater:
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(dst + i, vbslq_f32(vcgtq_f32(vld1q_f32(a + i), vld1q_f32(b + i)), one, zero));
+        break;
+    case BandOp::Negate:
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(dst + i, vnegq_f32(vld1q_f32(a + i)));
+        break;
+    case BandOp::Abs:
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(dst + i, vabsq_f32(vld1q_f32(a + i)));
+        break;
+    case BandOp::Sqrt:
+        for (; i + 4 <= count; i += 4) {
+            float32x4_t x = vld1q_f32(a + i);
+            vst1q_f32(dst + i, vsqrtq_f32(vbslq_f32(vcgtq_f32(x, zero), x, zero)));
+        }
+        break;
+    }
+    applyScalar(instruction, registers, bands, i, count);
+}
+
+const BandMathKernels neonBandMathKernels = { "neon", applyNeon };
+
+#endif
+
+// Scalar first, widest last
+std::vector<const BandMathKernels*> supportedBandMathKernels() {
+    std::vector<const BandMathKernels*> sets = { &scalarBandMathKernels };
+#if BAND_KERNELS_X86
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    bool avx2 = osAvx && (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    bool sse2 = __builtin_cpu_supports("sse2");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (sse2)
+        sets.push_back(&sseBandMathKernels);
+    if (avx2)
+        sets.push_back(&avx2BandMathKernels);
+#elif BAND_KERNELS_NEON
+    sets.push_back(&neonBandMathKernels);
+#endif
+    return sets;
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Band pyramid and the tile pipeline
+// ---------------------------------------------------------------------------------------------------------
+
+// Identifies one tile of the pyramid
+struct TileKey {
+    int level = 0, x = 0, y = 0;
+
+    uint64_t packed() const {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+    }
+    TileKey parent() const {
+        TileKey p;
+        p.level = level + 1;
+        p.x = x / 2;
+        p.y = y / 2;
+        return p;
+    }
+};
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f), velocity(0.0f, 0.0f), zoomRate(0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    void zoomBy(float factor) {
+        scale *= factor;
+    }
+
+    // Measures how fast offset and scale changed since the last call, smoothed exponentially
+    void updateMotion(double now) {
+        if (lastTime < 0.0) {
+            lastTime = now;
+            lastOffset = offset;
+            lastScale = scale;
+            return;
+        }
+        float dt = static_cast<float>(now - lastTime);
+        if (dt <= 0.0f)
+            return;
+
+        glm::vec2 instantVelocity = (offset - lastOffset) / dt;
+        float instantZoomRate = std::log(scale / lastScale) / dt;
+        float alpha = 1.0f - std::exp(-dt / velocitySmoothing);
+        velocity += (instantVelocity - velocity) * alpha;
+        zoomRate += (instantZoomRate - zoomRate) * alpha;
+
+        lastTime = now;
+        lastOffset = offset;
+        lastScale = scale;
+    }
+
+    // Camera extrapolated t seconds ahead along the current pan/zoom motion
+    Camera predicted(float t) const {
+        Camera c = *this;
+        c.offset = offset + velocity * t;
+        c.scale = scale * std::exp(zoomRate * t);
+        return c;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    glm::vec2 getCenter() const { return -offset; }
+    float getScale() const { return scale; }
+    float getZoomRate() const { return zoomRate; }
+    glm::vec2 getVelocity() const { return velocity; }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    glm::vec2 velocity;   // world units per second (of offset)
+    float zoomRate;       // d ln(scale) / dt
+    double lastTime = -1.0;
+    glm::vec2 lastOffset;
+    float lastScale = 1.0f;
+    GLuint ubo = 0;
+};
+
+// Bands of one raster, row-major 8-bit samples with row 0 at the top
+struct BandImage {
+    int width = 0, height = 0;
+    std::vector<std::string> names;
+    std::vector<std::vector<uint8_t>> bands;
+};
+
+// Appends the bands of one file: every 8-bit sample of a stripped TIFF, the RGB channels of other images.
+// All files must share the size of the first.
+bool loadBands(const std::string& path, BandImage& image) {
+    std::string stem = std::filesystem::path(path).stem().string();
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    int width = 0, height = 0, channels = 0;
+    std::vector<std::vector<uint8_t>> bands;
+    if (extension == ".tif" || extension == ".tiff") {
+        TIFF* tif = TIFFOpen(path.c_str(), "r");
+        if (!tif)
+            return false;
+        uint32_t tiffWidth = 0, tiffHeight = 0;
+        uint16_t samplesPerPixel = 1, bitsPerSample = 8, planarConfig = PLANARCONFIG_CONTIG;
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &tiffWidth);
+        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &tiffHeight);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bitsPerSample);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_PLANARCONFIG, &planarConfig);
+        if (bitsPerSample != 8 || planarConfig != PLANARCONFIG_CONTIG || TIFFIsTiled(tif)) {
+            TIFFClose(tif);
+            std::cerr << "Band TIFF must be 8-bit, interleaved and stripped: " << path << std::endl;
+            return false;
+        }
+        width = static_cast<int>(tiffWidth);
+        height = static_cast<int>(tiffHeight);
+        channels = samplesPerPixel;
+        bands.assign(channels, std::vector<uint8_t>(static_cast<size_t>(width) * height));
+        std::vector<unsigned char> row(TIFFScanlineSize(tif));
+        for (int y = 0; y < height; ++y) {
+            if (TIFFReadScanline(tif, row.data(), y, 0) < 0) {
+                TIFFClose(tif);
+                return false;
+            }
+            for (int band = 0; band < channels; ++band)
+                for (int x = 0; x < width; ++x)
+                    bands[band][static_cast<size_t>(y) * width + x] = row[static_cast<size_t>(x) * channels + band];
+        }
+        TIFFClose(tif);
+    } else {
+        unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb);
+        if (!data)
+            return false;
+        channels = 3;
+        bands.assign(channels, std::vector<uint8_t>(static_cast<size_t>(width) * height));
+        for (size_t i = 0; i < bands[0].size(); ++i)
+            for (int band = 0; band < channels; ++band)
+                bands[band][i] = data[i * 3 + band];
+        stbi_image_free(data);
+    }
+
+    if (!image.bands.empty() && (width != image.width || height != image.height)) {
+        std::cerr << path << " is " << width << " x " << height << ", the first source " << image.width << " x " << image.height << std::endl;
+        return false;
+    }
+    if (image.bands.size() + bands.size() > static_cast<size_t>(maxBands)) {
+        std::cerr << "More than " << maxBands << " bands" << std::endl;
+        return false;
+    }
+    image.width = width;
+    image.height = height;
+    for (int band = 0; band < channels; ++band) {
+        image.names.push_back(stem + ":" + std::to_string(band + 1));
+        image.bands.push_back(std::move(bands[band]));
+    }
+    printf("Bands %s: %d x %d, %d bands\n", path.c_str(), width, height, channels);
+    return true;
+}
+
+// Hash of a lattice point to [0, 1)
+inline float latticeValue(int x, int y, uint32_t seed) {
+    uint32_t h = static_cast<uint32_t>(x) * 0x8da6b343u ^ static_cast<uint32_t>(y) * 0xd8163841u ^ seed * 0xcb1ab31fu;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return (h & 0xffffff) / 16777216.0f;
+}
+
+// Smoothly interpolated lattice noise in [0, 1) with lattice spacing `cell`
+inline float valueNoise(float x, float y, float cell, uint32_t seed) {
+    float fx = x / cell, fy = y / cell;
+    int ix = static_cast<int>(std::floor(fx)), iy = static_cast<int>(std::floor(fy));
+    float tx = fx - ix, ty = fy - iy;
+    tx = tx * tx * (3.0f - 2.0f * tx);
+    ty = ty * ty * (3.0f - 2.0f * ty);
+    float top = latticeValue(ix, iy, seed) + (latticeValue(ix + 1, iy, seed) - latticeValue(ix, iy, seed)) * tx;
+    float bottom = latticeValue(ix, iy + 1, seed) + (latticeValue(ix + 1, iy + 1, seed) - latticeValue(ix, iy + 1, seed)) * tx;
+    return top + (bottom - top) * ty;
+}
+
+// Land cover scene in blue, green, red and near infrared: lakes, then fields of patchSize samples of dense
+// vegetation, sparse vegetation, bare soil or built-up land, each with some texture
+void generateScene(int size, BandImage& image) {
+    // Reflectance per class and band (blue, green, red, near infrared); 8-bit samples cover 0..0.5
+    const float reflectance[5][4] = {
+        { 0.06f, 0.07f, 0.04f, 0.02f },   // water
+        { 0.03f, 0.08f, 0.04f, 0.50f },   // dense vegetation
+        { 0.06f, 0.10f, 0.09f, 0.32f },   // sparse vegetation
+        { 0.10f, 0.15f, 0.21f, 0.27f },   // bare soil
+        { 0.17f, 0.18f, 0.20f, 0.23f },   // built-up
+    };
+    image.width = image.height = size;
+    image.names = { "blue", "green", "red", "nir" };
+    image.bands.assign(4, std::vector<uint8_t>(static_cast<size_t>(size) * size));
+
+    parallelFor(size, resolveThreadCount(), [&](int y) {
+        for (int x = 0; x < size; ++x) {
+            float lake = 0.65f * valueNoise(x, y, 700.0f, 1) + 0.35f * valueNoise(x, y, 230.0f, 2);
+            int landCover = 0;
+            if (lake > 0.3f) {
+                // Field edges wander a little instead of following the lattice
+                float wx = x + (valueNoise(x, y, 60.0f, 3) - 0.5f) * patchSize * 0.5f;
+                float wy = y + (valueNoise(x, y, 60.0f, 4) - 0.5f) * patchSize * 0.5f;
+                float pick = latticeValue(static_cast<int>(std::floor(wx / patchSize)), static_cast<int>(std::floor(wy / patchSize)), 5);
+                landCover = pick < 0.35f ? 1 : pick < 0.65f ? 2 : pick < 0.85f ? 3 : 4;
+            }
+            float texture = 0.8f + 0.4f * valueNoise(x, y, 6.0f, 6);
+            size_t index = static_cast<size_t>(y) * size + x;
+            for (int band = 0; band < 4; ++band)
+                image.bands[band][index] = static_cast<uint8_t>(std::min(255.0f, reflectance[landCover][band] * texture * 510.0f + 0.5f));
+        }
+    });
+    printf("Generated scene: %d x %d, bands blue, green, red, nir\n", size, size);
+}
+
+// Full-resolution bands plus their reduced levels, cut into tiles on demand.
+// World mapping keeps the aspect ratio: x spans [-1, 1], y spans [-h/w, h/w], row 0 at the top.
+class BandPyramid {
+public:
+    void build(BandImage&& image) {
+        m_names = std::move(image.names);
+        Level base;
+        base.width = image.width;
+        base.height = image.height;
+        base.bands = std::move(image.bands);
+        m_levels.push_back(std::move(base));
+
+        // Halve until the whole level fits in one tile
+        while (m_levels.back().width > tileSize || m_levels.back().height > tileSize)
+            m_levels.push_back(downsample(m_levels.back()));
+
+        printf("Size: %d x %d, %d bands, levels: %d, tile size: %d\n", levelWidth(0), levelHeight(0), bandCount(), levelCount(), tileSize);
+        for (int band = 0; band < bandCount(); ++band)
+            printf("  b%d: %s\n", band + 1, m_names[band].c_str());
+    }
+
+    int bandCount() const { return static_cast<int>(m_levels[0].bands.size()); }
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    int levelWidth(int level) const { return m_levels[level].width; }
+    int levelHeight(int level) const { return m_levels[level].height; }
+    int tilesX(int level) const { return (levelWidth(level) + tileSize - 1) / tileSize; }
+    int tilesY(int level) const { return (levelHeight(level) + tileSize - 1) / tileSize; }
+
+    const uint8_t* row(int level, int band, int y) const {
+        return m_levels[level].bands[band].data() + static_cast<size_t>(y) * m_levels[level].width;
+    }
+
+    bool isValid(const TileKey& key) const {
+        return key.level >= 0 && key.level < levelCount() &&
+               key.x >= 0 && key.x < tilesX(key.level) && key.y >= 0 && key.y < tilesY(key.level);
+    }
+
+    // Copies one tile out of its level, band after band (thread-safe, read-only)
+    void readTile(const TileKey& key, std::vector<uint8_t>& planes, int& width, int& height) const {
+        const Level& level = m_levels[key.level];
+        width = std::min(tileSize, level.width - key.x * tileSize);
+        height = std::min(tileSize, level.height - key.y * tileSize);
+        planes.resize(static_cast<size_t>(width) * height * bandCount());
+        uint8_t* dst = planes.data();
+        for (int band = 0; band < bandCount(); ++band) {
+            for (int y = 0; y < height; ++y, dst += width)
+                memcpy(dst, row(key.level, band, key.y * tileSize + y) + static_cast<size_t>(key.x) * tileSize, width);
+        }
+    }
+
+    // World units per level-0 pixel
+    float worldPerPixel() const { return 2.0f / m_levels[0].width; }
+
+    // World-space rectangle of a tile (min.x, min.y, max.x, max.y)
+    glm::vec4 tileRect(const TileKey& key) const {
+        int width0 = m_levels[0].width, height0 = m_levels[0].height;
+        int px0 = std::min(key.x * tileSize << key.level, width0);
+        int py0 = std::min(key.y * tileSize << key.level, height0);
+        int px1 = std::min((key.x + 1) * tileSize << key.level, width0);
+        int py1 = std::min((key.y + 1) * tileSize << key.level, height0);
+        float p = worldPerPixel();
+        float top = height0 * p * 0.5f;
+        return glm::vec4(px0 * p - 1.0f, top - py1 * p, px1 * p - 1.0f, top - py0 * p);
+    }
+
+    // Level whose texel density best matches the screen for this camera
+    int selectLevel(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        float texelsPerScreenPixel = 1.0f / (worldPerPixel() * screenPixelsPerWorld);
+        int level = static_cast<int>(std::floor(std::log2(std::max(texelsPerScreenPixel, 1e-6f)) + lodBias));
+        return std::max(0, std::min(level, levelCount() - 1));
+    }
+
+    // Continuous level (before flooring), used to predict level switches
+    float levelPosition(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        return std::log2(1.0f / (worldPerPixel() * screenPixelsPerWorld)) + lodBias;
+    }
+
+    // Range of tiles of a level that intersect a world rectangle; false if none
+    bool tileRange(int level, const glm::vec4& rect, int& x0, int& y0, int& x1, int& y1) const {
+        float p = worldPerPixel() * static_cast<float>(1 << level) * tileSize;  // world size of one tile
+        float top = m_levels[0].height * worldPerPixel() * 0.5f;
+        x0 = std::max(0, static_cast<int>(std::floor((rect.x + 1.0f) / p)));
+        x1 = std::min(tilesX(level) - 1, static_cast<int>(std::floor((rect.z + 1.0f) / p)));
+        y0 = std::max(0, static_cast<int>(std::floor((top - rect.w) / p)));
+        y1 = std::min(tilesY(level) - 1, static_cast<int>(std::floor((top - rect.y) / p)));
+        return x0 <= x1 && y0 <= y1;
+    }
+
+private:
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<std::vector<uint8_t>> bands;
+    };
+    std::vector<Level> m_levels;
+    std::vector<std::string> m_names;
+
+    // 2x2 box filter, every band in parallel
+    static Level downsample(const Level& src) {
+        Level dst;
+        dst.width = (src.width + 1) / 2;
+        dst.height = (src.height + 1) / 2;
+        dst.bands.resize(src.bands.size());
+        parallelFor(static_cast<int>(src.bands.size()), resolveThreadCount(), [&](int band) {
+            const std::vector<uint8_t>& in = src.bands[band];
+            std::vector<uint8_t>& out = dst.bands[band];
+            out.resize(static_cast<size_t>(dst.width) * dst.height);
+            for (int y = 0; y < dst.height; ++y) {
+                const uint8_t* row0 = in.data() + static_cast<size_t>(2 * y) * src.width;
+                const uint8_t* row1 = in.data() + static_cast<size_t>(std::min(2 * y + 1, src.height - 1)) * src.width;
+                for (int x = 0; x < dst.width; ++x) {
+                    int sx0 = 2 * x, sx1 = std::min(2 * x + 1, src.width - 1);
+                    out[static_cast<size_t>(y) * dst.width + x] = static_cast<uint8_t>((row0[sx0] + row0[sx1] + row1[sx0] + row1[sx1] + 2) / 4);
+                }
+            }
+        });
+        return dst;
+    }
+};
+
+// One tile wanted by the renderer or the prefetcher; lower priority values are served first
+struct TileRequest {
+    TileKey key;
+    float priority = 0.0f;
+};
+
+struct LoadedTile {
+    TileKey key;
+    int width = 0, height = 0, bandCount = 0;
+    std::vector<uint8_t> planes;   // width x height samples per band, band after band
+};
+
+// Scheduler between the renderer and the decoders.
+// - Duplicates merge: a key requested several times in a frame, or again while pending or in flight, is
+//   one piece of work that keeps the best priority it was given.
+// - Ordering: pending work is kept sorted by priority, workers always take the most urgent tile.
+// - Cancellation: every frame submits the complete set of tiles it still wants; pending requests missing
+//   from that set are dropped before any decoder picks them up.
+class TileRequestQueue {
+public:
+    struct Stats {
+        long long submitted = 0;   // requests received, duplicates included
+        long long merged = 0;      // requests folded into an existing entry
+        long long cancelled = 0;   // pending requests dropped as no longer wanted
+        long long started = 0;     // requests handed to a decoder
+    };
+
+    // Replaces the wanted set for this frame (requests may contain duplicates)
+    void submitFrame(const std::vector<TileRequest>& requests) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+
+        for (const TileRequest& request : requests) {
+            ++m_stats.submitted;
+            uint64_t id = request.key.packed();
+            auto it = m_entries.find(id);
+            if (it == m_entries.end()) {
+                Entry entry;
+                entry.key = request.key;
+                entry.priority = request.priority;
+                entry.generation = m_generation;
+                m_entries.emplace(id, entry);
+                m_order.insert(std::make_pair(request.priority, id));
+                continue;
+            }
+
+            ++m_stats.merged;
+            Entry& entry = it->second;
+            if (entry.state == State::InFlight)
+                continue;
+            // First sighting this frame takes the new priority; later duplicates only improve it
+            float priority = entry.generation == m_generation ? std::min(entry.priority, request.priority) : request.priority;
+            if (priority != entry.priority) {
+                m_order.erase(std::make_pair(entry.priority, id));
+                entry.priority = priority;
+                m_order.insert(std::make_pair(priority, id));
+            }
+            entry.generation = m_generation;
+        }
+
+        // Everything still pending but not asked for this frame is no longer visible or predicted
+        for (auto it = m_order.begin(); it != m_order.end();) {
+            Entry& entry = m_entries[it->second];
+            if (entry.generation != m_generation) {
+                m_entries.erase(it->second);
+                it = m_order.erase(it);
+                ++m_stats.cancelled;
+            }
+            else {
+                ++it;
+            }
+        }
+
+        m_wakeup.notify_all();
+    }
+
+    // Blocks until there is work; returns false on shutdown
+    bool pop(TileKey& key) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeup.wait(lock, [this] { return m_shutdown || !m_order.empty(); });
+        if (m_shutdown)
+            return false;
+        uint64_t id = m_order.begin()->second;
+        m_order.erase(m_order.begin());
+        Entry& entry = m_entries[id];
+        entry.state = State::InFlight;
+        key = entry.key;
+        ++m_stats.started;
+        return true;
+    }
+
+    // The tile reached the cache; later requests for it are the cache's business
+    void delivered(const TileKey& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.erase(key.packed());
+    }
+
+    void shutdown() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+        m_wakeup.notify_all();
+    }
+
+    size_t pendingCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_order.size();
+    }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    enum class State { Pending, InFlight };
+    struct Entry {
+        TileKey key;
+        State state = State::Pending;
+        float priority = 0.0f;
+        uint64_t generation = 0;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::unordered_map<uint64_t, Entry> m_entries;    // pending and in-flight
+    std::set<std::pair<float, uint64_t>> m_order;     // pending only, most urgent first
+    uint64_t m_generation = 0;
+    bool m_shutdown = false;
+    Stats m_stats;
+};
+
+// Loader threads pulling from the request queue
+class TileLoaderPool {
+public:
+    void start(const BandPyramid* pyramid, TileRequestQueue* queue) {
+        m_pyramid = pyramid;
+        m_queue = queue;
+        for (int i = 0; i < loaderThreadCount; ++i)
+            m_threads.emplace_back(&TileLoaderPool::workerThread, this);
+    }
+
+    std::vector<LoadedTile> takeCompleted(int maxCount) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<LoadedTile> result;
+        while (!m_completed.empty() && static_cast<int>(result.size()) < maxCount) {
+            result.push_back(std::move(m_completed.front()));
+            m_completed.pop_front();
+        }
+        return result;
+    }
+
+    void stop() {
+        m_queue->shutdown();
+        for (std::thread& thread : m_threads)
+            thread.join();
+        m_threads.clear();
+    }
+
+private:
+    const BandPyramid* m_pyramid = nullptr;
+    TileRequestQueue* m_queue = nullptr;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::deque<LoadedTile> m_completed;
+
+    void workerThread() {
+        TileKey key;
+        while (m_queue->pop(key)) {
+            LoadedTile tile;
+            tile.key = key;
+            tile.bandCount = m_pyramid->bandCount();
+            m_pyramid->readTile(key, tile.planes, tile.width, tile.height);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed.push_back(std::move(tile));
+        }
+    }
+};
+
+// GPU-resident band tiles, evicted least-recently-used once over budget
+class TileCache {
+public:
+    struct Entry {
+        GLuint texture = 0;
+        int width = 0, height = 0;
+        int lastUsedFrame = 0;
+        bool drawn = false;
+    };
+
+    void upload(const LoadedTile& tile, int frame) {
+        Entry entry;
+        entry.width = tile.width;
+        entry.height = tile.height;
+        entry.lastUsedFrame = frame;
+
+        // One layer per band; the fragment shader reads every band the expression uses at the same texel
+        glGenTextures(1, &entry.texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, entry.texture);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8, tile.width, tile.height, tile.bandCount, 0, GL_RED, GL_UNSIGNED_BYTE, tile.planes.data());
+
+        m_entries[tile.key.packed()] = entry;
+        ++m_uploads;
+    }
+
+    Entry* find(const TileKey& key) {
+        auto it = m_entries.find(key.packed());
+        return it == m_entries.end() ? nullptr : &it->second;
+    }
+
+    bool contains(const TileKey& key) const { return m_entries.count(key.packed()) != 0; }
+
+    void evict(int currentFrame) {
+        if (m_entries.size() <= gpuTileBudget)
+            return;
+        std::vector<std::pair<int, uint64_t>> candidates;
+        for (const auto& item : m_entries)
+            if (item.second.lastUsedFrame < currentFrame)
+                candidates.emplace_back(item.second.lastUsedFrame, item.first);
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& candidate : candidates) {
+            if (m_entries.size() <= gpuTileBudget)
+                break;
+            Entry& victim = m_entries[candidate.second];
+            if (!victim.drawn)
+                ++m_unusedEvictions;
+            glDeleteTextures(1, &victim.texture);
+            m_entries.erase(candidate.second);
+        }
+    }
+
+    size_t size() const { return m_entries.size(); }
+    int getUploads() const { return m_uploads; }
+    int getUnusedEvictions() const { return m_unusedEvictions; }
+
+    void destroy() {
+        for (auto& item : m_entries)
+            glDeleteTextures(1, &item.second.texture);
+        m_entries.clear();
+    }
+
+private:
+    std::unordered_map<uint64_t, Entry> m_entries;
+    int m_uploads = 0;
+    int m_unusedEvictions = 0;   // decoded and uploaded, but evicted before ever being drawn
+};
+
+// Emits requests for the visible tiles and for the predicted camera path (duplicates are left to the queue).
+// priority = predicted seconds until visible + levelWeight * levels away from the current level
+//          + distanceWeight * distance from the view center (in half view extents)
+class Prefetcher {
+public:
+    bool enabled = true;
+
+    void collect(const Camera& camera, const BandPyramid& pyramid, const TileCache& cache,
+                 int framebufferWidth, int framebufferHeight, std::vector<TileRequest>& requests) {
+        requests.clear();
+        int currentLevel = pyramid.selectLevel(camera, framebufferWidth, framebufferHeight);
+
+        float horizon = enabled ? predictionHorizon : 0.0f;
+        for (float t = 0.0f; t <= horizon + 1e-4f; t += predictionStep) {
+            Camera future = camera.predicted(t);
+            int level = pyramid.selectLevel(future, framebufferWidth, framebufferHeight);
+            addRect(pyramid, cache, future, level, currentLevel, t, requests);
+        }
+
+        float zoomRate = camera.getZoomRate();
+        if (enabled && std::fabs(zoomRate) > zoomRateThreshold) {
+            float position = pyramid.levelPosition(camera, framebufferWidth, framebufferHeight);
+            float levelsPerSecond = zoomRate / std::log(2.0f);
+            int nextLevel = zoomRate > 0.0f ? currentLevel - 1 : currentLevel + 1;
+            float distanceToSwitch = zoomRate > 0.0f ? position - std::floor(position) : std::ceil(position) - position;
+            float timeToSwitch = distanceToSwitch / std::fabs(levelsPerSecond);
+            if (nextLevel >= 0 && nextLevel < pyramid.levelCount())
+                addRect(pyramid, cache, camera, nextLevel, currentLevel, timeToSwitch, requests);
+        }
+    }
+
+private:
+    void addRect(const BandPyramid& pyramid, const TileCache& cache, const Camera& view, int level, int currentLevel,
+                 float t, std::vector<TileRequest>& requests) {
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, view.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glm::vec2 center = view.getCenter();
+        float halfExtent = 1.0f / view.getScale();
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                if (cache.contains(key))
+                    continue;
+
+                glm::vec4 r = pyramid.tileRect(key);
+                glm::vec2 tileCenter((r.x + r.z) * 0.5f, (r.y + r.w) * 0.5f);
+                TileRequest request;
+                request.key = key;
+                request.priority = t + levelWeight * std::abs(level - currentLevel) +
+                                   distanceWeight * glm::length(tileCenter - center) / halfExtent;
+                requests.push_back(request);
+            }
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------
+// CPU evaluation: statistics, export and the benchmark
+// ---------------------------------------------------------------------------------------------------------
+
+// Runs a compiled expression over runs of samples, blockSize at a time so the registers stay in L1.
+// Owns its registers: one per thread.
+class BandEvaluator {
+public:
+    BandEvaluator(const BandExpression& expression, const BandMathKernels& kernels)
+        : m_expression(expression), m_kernels(kernels), m_storage(static_cast<size_t>(maxRegisters) * blockSize) {
+        for (int r = 0; r < maxRegisters; ++r)
+            m_registers[r] = m_storage.data() + static_cast<size_t>(r) * blockSize;
+    }
+
+    // bands[n] points at count samples of band n
+    void evaluate(const uint8_t* const* bands, int bandCount, float* out, size_t count) {
+        const uint8_t* blockBands[maxBands];
+        for (size_t start = 0; start < count; start += blockSize) {
+            size_t n = std::min(static_cast<size_t>(blockSize), count - start);
+            for (int band = 0; band < bandCount; ++band)
+                blockBands[band] = bands[band] + start;
+            for (const BandInstruction& instruction : m_expression.program())
+                m_kernels.apply(instruction, m_registers, blockBands, 0, n);
+            memcpy(out + start, m_registers[m_expression.resultRegister()], n * sizeof(float));
+        }
+    }
+
+    void evaluateRow(const BandPyramid& pyramid, int level, int y, float* out) {
+        const uint8_t* bands[maxBands];
+        for (int band = 0; band < pyramid.bandCount(); ++band)
+            bands[band] = pyramid.row(level, band, y);
+        evaluate(bands, pyramid.bandCount(), out, pyramid.levelWidth(level));
+    }
+
+private:
+    const BandExpression& m_expression;
+    const BandMathKernels& m_kernels;
+    std::vector<float> m_storage;
+    float* m_registers[maxRegisters];
+};
+
+// Rows per parallel task
+const int rowsPerTask = 16;
+
+struct BandStatistics {
+    int level = 0;
+    long long count = 0;       // finite values; everything below is over these
+    long long nonFinite = 0;   // infinities and NaNs from overflowing expressions
+    double minimum = 0.0, maximum = 0.0, mean = 0.0, deviation = 0.0;
+    float low = 0.0f, high = 1.0f;   // stretchLow and stretchHigh percentiles
+    double milliseconds = 0.0;
+};
+
+// First level with at most statsSampleBudget samples
+int statisticsLevel(const BandPyramid& pyramid) {
+    int level = 0;
+    while (level + 1 < pyramid.levelCount() && static_cast<long long>(pyramid.levelWidth(level)) * pyramid.levelHeight(level) > statsSampleBudget)
+        ++level;
+    return level;
+}
+
+// Two passes over a level, row chunks in parallel: range and moments, then a histogram over the range for the
+// percentiles. Values are recomputed in the second pass rather than stored. Non-finite values (an expression
+// can overflow) are counted apart and left out of both passes.
+BandStatistics computeStatistics(const BandPyramid& pyramid, const BandExpression& expression, const BandMathKernels& kernels, int level, int threadCount) {
+    auto start = std::chrono::steady_clock::now();
+    int width = pyramid.levelWidth(level), height = pyramid.levelHeight(level);
+    int taskCount = (height + rowsPerTask - 1) / rowsPerTask;
+
+    struct Partial {
+        double minimum = 1e300, maximum = -1e300, sum = 0.0, sumSquares = 0.0;
+        long long count = 0, nonFinite = 0;
+        std::vector<long long> histogram;
+    };
+    std::vector<Partial> partials(taskCount);
+    parallelFor(taskCount, threadCount, [&](int task) {
+        BandEvaluator evaluator(expression, kernels);
+        std::vector<float> values(width);
+        Partial& partial = partials[task];
+        for (int y = task * rowsPerTask; y < std::min(height, (task + 1) * rowsPerTask); ++y) {
+            evaluator.evaluateRow(pyramid, level, y, values.data());
+            for (float value : values) {
+                if (!std::isfinite(value)) {
+                    ++partial.nonFinite;
+                    continue;
+                }
+                ++partial.count;
+                partial.minimum = std::min(partial.minimum, static_cast<double>(value));
+                partial.maximum = std::max(partial.maximum, static_cast<double>(value));
+                partial.sum += value;
+                partial.sumSquares += static_cast<double>(value) * value;
+            }
+        }
+    });
+
+    BandStatistics stats;
+    stats.level = level;
+    stats.minimum = 1e300;
+    stats.maximum = -1e300;
+    double sum = 0.0, sumSquares = 0.0;
+    for (const Partial& partial : partials) {
+        stats.count += partial.count;
+        stats.nonFinite += partial.nonFinite;
+        stats.minimum = std::min(stats.minimum, partial.minimum);
+        stats.maximum = std::max(stats.maximum, partial.maximum);
+        sum += partial.sum;
+        sumSquares += partial.sumSquares;
+    }
+    if (stats.count == 0) {
+        stats.minimum = stats.maximum = 0.0;
+    } else {
+        stats.mean = sum / stats.count;
+        stats.deviation = std::sqrt(std::max(0.0, sumSquares / stats.count - stats.mean * stats.mean));
+    }
+
+    // An infinite range (finite values near the float limits) is treated like an empty one
+    double range = stats.maximum - stats.minimum;
+    if (range > 0.0 && std::isfinite(range)) {
+        double binScale = histogramBins / range;
+        parallelFor(taskCount, threadCount, [&](int task) {
+            BandEvaluator evaluator(expression, kernels);
+            std::vector<float> values(width);
+            std::vector<long long>& histogram = partials[task].histogram;
+            histogram.assign(histogramBins, 0);
+            for (int y = task * rowsPerTask; y < std::min(height, (task + 1) * rowsPerTask); ++y) {
+                evaluator.evaluateRow(pyramid, level, y, values.data());
+                for (float value : values) {
+                    if (!std::isfinite(value))
+                        continue;
+                    double bin = (value - stats.minimum) * binScale;
+                    ++histogram[bin <= 0.0 ? 0 : bin >= histogramBins - 1 ? histogramBins - 1 : static_cast<int>(bin)];
+                }
+            }
+        });
+
+        std::vector<long long> histogram(histogramBins, 0);
+        for (const Partial& partial : partials)
+            for (int bin = 0; bin < histogramBins; ++bin)
+                histogram[bin] += partial.histogram[bin];
+        long long lowCount = static_cast<long long>(stretchLow * stats.count), highCount = static_cast<long long>(stretchHigh * stats.count);
+        long long cumulative = 0;
+        int lowBin = 0, highBin = histogramBins - 1;
+        for (int bin = 0; bin < histogramBins; ++bin) {
+            if (cumulative <= lowCount)
+                lowBin = bin;
+            cumulative += histogram[bin];
+            if (cumulative >= highCount) {
+                highBin = bin;
+                break;
+            }
+        }
+        stats.low = static_cast<float>(stats.minimum + lowBin / binScale);
+        stats.high = static_cast<float>(stats.minimum + (highBin + 1) / binScale);
+    } else {
+        stats.low = static_cast<float>(stats.minimum);
+        stats.high = static_cast<float>(stats.minimum + 1.0);
+    }
+    stats.milliseconds = millisecondsSince(start);
+    return stats;
+}
+
+// Streams a level to a single-band float32 TIFF a strip of tileSize rows at a time; the strip's rows are
+// computed in parallel, then written in order
+bool exportLevel(const std::string& path, const BandPyramid& pyramid, const BandExpression& expression, const BandMathKernels& kernels,
+                 int level, int threadCount) {
+    auto start = std::chrono::steady_clock::now();
+    int width = pyramid.levelWidth(level), height = pyramid.levelHeight(level);
+    TIFF* tif = TIFFOpen(path.c_str(), "w");
+    if (!tif) {
+        std::cerr << "Failed to create " << path << std::endl;
+        return false;
+    }
+    TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, static_cast<uint32_t>(width));
+    TIFFSetField(tif, TIFFTAG_IMAGELENGTH, static_cast<uint32_t>(height));
+    TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, 1);
+    TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, 32);
+    TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_IEEEFP);
+    TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
+    TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+    TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, static_cast<uint32_t>(tileSize));
+
+    std::vector<float> strip(static_cast<size_t>(width) * tileSize);
+    for (int y0 = 0; y0 < height; y0 += tileSize) {
+        int rows = std::min(tileSize, height - y0);
+        int taskCount = (rows + rowsPerTask - 1) / rowsPerTask;
+        parallelFor(taskCount, threadCount, [&](int task) {
+            BandEvaluator evaluator(expression, kernels);
+            for (int row = task * rowsPerTask; row < std::min(rows, (task + 1) * rowsPerTask); ++row)
+                evaluator.evaluateRow(pyramid, level, y0 + row, strip.data() + static_cast<size_t>(row) * width);
+        });
+        for (int row = 0; row < rows; ++row) {
+            if (TIFFWriteScanline(tif, strip.data() + static_cast<size_t>(row) * width, y0 + row, 0) < 0) {
+                TIFFClose(tif);
+                std::cerr << "Failed to write " << path << std::endl;
+                return false;
+            }
+        }
+    }
+    TIFFClose(tif);
+    printf("Exported level %d (%d x %d) of %s to %s in %.1f ms\n", level, width, height, expression.source().c_str(), path.c_str(),
+           millisecondsSince(start));
+    return true;
+}
+
+// Best time of benchmarkRuns calls
+template <typename Run>
+double bestMilliseconds(const Run& run) {
+    double best = 1e30;
+    for (int i = 0; i < benchmarkRuns; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, millisecondsSince(start));
+    }
+    return best;
+}
+
+// Every preset over level 0 with every kernel set, on one thread and on all of them; each row's values are
+// hashed and compared against the scalar kernels
+void runBenchmark(const BandPyramid& pyramid) {
+    int width = pyramid.levelWidth(0), height = pyramid.levelHeight(0);
+    double megasamples = static_cast<double>(width) * height / 1e6;
+    int threadCount = resolveThreadCount();
+    int taskCount = (height + rowsPerTask - 1) / rowsPerTask;
+    printf("%d x %d, %d bands, %d threads; Msamples/s, best of %d runs\n", width, height, pyramid.bandCount(), threadCount, benchmarkRuns);
+
+    std::vector<int> threadCounts = { 1 };
+    if (threadCount > 1)
+        threadCounts.push_back(threadCount);
+    for (int preset = 0; preset < presetCount; ++preset) {
+        BandExpression expression;
+        std::string error;
+        if (!expression.compile(presetExpressions[preset], pyramid.bandCount(), error)) {
+            printf("  %s: %s\n", presetExpressions[preset], error.c_str());
+            continue;
+        }
+        printf("  %s (%zu instructions, %d registers)\n", expression.source().c_str(), expression.program().size(), expression.registerCount());
+
+        std::vector<uint64_t> reference(taskCount), hashes(taskCount);
+        double scalarRate = 0.0;
+        for (const BandMathKernels* kernels : supportedBandMathKernels()) {
+            bool isScalar = kernels == &scalarBandMathKernels;
+            std::vector<uint64_t>& hashOut = isScalar ? reference : hashes;
+            for (int threads : threadCounts) {
+                double ms = bestMilliseconds([&]() {
+                    parallelFor(taskCount, threads, [&](int task) {
+                        BandEvaluator evaluator(expression, *kernels);
+                        std::vector<float> values(width);
+                        uint64_t hash = 1469598103934665603ull;
+                        for (int y = task * rowsPerTask; y < std::min(height, (task + 1) * rowsPerTask); ++y) {
+                            evaluator.evaluateRow(pyramid, 0, y, values.data());
+                            for (float value : values) {
+                                uint32_t bits;
+                                memcpy(&bits, &value, sizeof(bits));
+                                hash = (hash ^ bits) * 1099511628211ull;
+                            }
+                        }
+                        hashOut[task] = hash;
+                    });
+                });
+                double rate = megasamples * 1000.0 / ms;
+                if (isScalar && threads == 1)
+                    scalarRate = rate;
+                printf("    %-8s %2d th %10.0f  (%.1fx scalar)\n", kernels->name, threads, rate, rate / scalarRate);
+            }
+            if (!isScalar) {
+                int differing = 0;
+                for (int task = 0; task < taskCount; ++task)
+                    differing += hashes[task] != reference[task];
+                printf("    %-8s row chunks differing from scalar: %d\n", kernels->name, differing);
+            }
+        }
+    }
+}
+
+// Draws each visible tile through the current expression's program, from the tile's own bands or the matching
+// part of the nearest resident ancestor. One program per expression, built on first use and kept, so
+// switching back and forth recompiles nothing; tiles are shared by every program.
+class BandMathRenderer {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 tileRect;  // world x0, y0, x1, y1
+uniform vec4 uvRect;    // u0, v0 (top-left), u1, v1 (bottom-right)
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(tileRect.xw, tileRect.zy, corner), 0.0, 1.0);
+    texCoord = mix(uvRect.xy, uvRect.zw, corner);
+}
+)";
+
+    // The compiled expression goes between these two; the bm* helpers have the CPU kernels' semantics
+    const char* fragmentHeaderSource = R"(#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2DArray bands;
+uniform vec2 valueRange;  // values at the two ends of the ramp
+
+float bmDiv(float a, float b) { return b == 0.0 ? 0.0 : a / b; }
+float bmMin(float a, float b) { return a < b ? a : b; }
+float bmMax(float a, float b) { return a > b ? a : b; }
+float bmLess(float a, float b) { return a < b ? 1.0 : 0.0; }
+float bmGreater(float a, float b) { return a > b ? 1.0 : 0.0; }
+float bmSqrt(float a) { return sqrt(a > 0.0 ? a : 0.0); }
+
+)";
+
+    const char* fragmentMainSource = R"(
+// Five-stop perceptual ramp, dark purple to yellow
+vec3 ramp(float t)
+{
+    const vec3 stops[5] = vec3[5](vec3(0.267, 0.005, 0.329), vec3(0.229, 0.322, 0.546), vec3(0.128, 0.567, 0.551),
+                                  vec3(0.369, 0.789, 0.383), vec3(0.993, 0.906, 0.144));
+    float position = t * 4.0;
+    int i = min(int(position), 3);
+    return mix(stops[i], stops[i + 1], position - float(i));
+}
+
+void main()
+{
+    float t = clamp((bandMath() - valueRange.x) / (valueRange.y - valueRange.x), 0.0, 1.0);
+    FragColor = vec4(ramp(t), 1.0);
+}
+)";
+    GLuint VAO;
+    glm::vec2 valueRange = glm::vec2(-1.0f, 1.0f);
+    int holes = 0;
+
+    void init() {
+        // Corners come from gl_VertexID; the VAO only has to exist
+        glGenVertexArrays(1, &VAO);
+    }
+
+    void setExpression(const BandExpression& expression, Camera* camera) {
+        auto it = m_programs.find(expression.source());
+        if (it == m_programs.end()) {
+            std::string fragmentSource = fragmentHeaderSource + expression.glslFunction() + fragmentMainSource;
+            Program program;
+            program.id = createCameraShaderProgram(vertexShaderSource, fragmentSource.c_str());
+            camera->attachProgram(program.id);
+            program.tileRectLoc = glGetUniformLocation(program.id, "tileRect");
+            program.uvRectLoc = glGetUniformLocation(program.id, "uvRect");
+            program.valueRangeLoc = glGetUniformLocation(program.id, "valueRange");
+            glUseProgram(program.id);
+            glUniform1i(glGetUniformLocation(program.id, "bands"), 0);
+            it = m_programs.emplace(expression.source(), program).first;
+        }
+        m_current = &it->second;
+    }
+
+    size_t programCount() const { return m_programs.size(); }
+
+    void render(const Camera& camera, const BandPyramid& pyramid, TileCache& cache, int level, int frame) {
+        holes = 0;
+        int x0, y0, x1, y1;
+        if (!m_current || !pyramid.tileRange(level, camera.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glUseProgram(m_current->id);
+        glUniform2f(m_current->valueRangeLoc, valueRange.x, valueRange.y);
+        glBindVertexArray(VAO);
+        glActiveTexture(GL_TEXTURE0);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                glm::vec4 rect = pyramid.tileRect(key);
+
+                // Walk up until a resident ancestor covers this tile
+                TileKey source = key;
+                TileCache::Entry* entry = cache.find(source);
+                if (!entry)
+                    ++holes;
+                while (!entry && source.level + 1 < pyramid.levelCount()) {
+                    source = source.parent();
+                    entry = cache.find(source);
+                }
+                if (!entry)
+                    continue;
+                entry->lastUsedFrame = frame;
+                entry->drawn = true;
+
+                // Part of the source tile covered by this tile, in the source's texel space
+                glm::vec4 sourceRect = pyramid.tileRect(source);
+                float u0 = (rect.x - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float u1 = (rect.z - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float v0 = (sourceRect.w - rect.w) / (sourceRect.w - sourceRect.y);
+                float v1 = (sourceRect.w - rect.y) / (sourceRect.w - sourceRect.y);
+
+                glBindTexture(GL_TEXTURE_2D_ARRAY, entry->texture);
+                glUniform4f(m_current->tileRectLoc, rect.x, rect.y, rect.z, rect.w);
+                glUniform4f(m_current->uvRectLoc, u0, v0, u1, v1);
+                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            }
+        }
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        for (auto& item : m_programs)
+            glDeleteProgram(item.second.id);
+        m_programs.clear();
+        m_current = nullptr;
+    }
+
+private:
+    struct Program {
+        GLuint id = 0;
+        GLint tileRectLoc = -1, uvRectLoc = -1, valueRangeLoc = -1;
+    };
+    std::unordered_map<std::string, Program> m_programs;
+    Program* m_current = nullptr;
+};
+
+void printStatistics(const BandStatistics& stats, const BandPyramid& pyramid, const BandMathKernels& kernels) {
+    printf("Statistics of level %d (%d x %d, %lld finite samples, %lld not, %s kernels, %.1f ms): min %.4g max %.4g mean %.4g std %.4g, %.0f%%-%.0f%% %.4g to %.4g\n",
+           stats.level, pyramid.levelWidth(stats.level), pyramid.levelHeight(stats.level), stats.count, stats.nonFinite, kernels.name,
+           stats.milliseconds, stats.minimum, stats.maximum, stats.mean, stats.deviation, stretchLow * 100.0f, stretchHigh * 100.0f, stats.low, stats.high);
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> imagePaths;
+    std::string expressionSource;
+    std::string exportPath;
+    int exportLevelIndex = -1;
+    bool benchmark = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--benchmark")
+            benchmark = true;
+        else if (arg == "--expr" && i + 1 < argc)
+            expressionSource = argv[++i];
+        else if (arg == "--export" && i + 1 < argc)
+            exportPath = argv[++i];
+        else if (arg == "--level" && i + 1 < argc)
+            exportLevelIndex = std::atoi(argv[++i]);
+        else
+            imagePaths.push_back(arg);
+    }
+
+    BandImage image;
+    if (imagePaths.empty())
+        generateScene(generatedSize, image);
+    for (const std::string& path : imagePaths) {
+        if (!loadBands(path, image)) {
+            std::cerr << "Failed to load bands from " << path << std::endl;
+            return -1;
+        }
+    }
+    BandPyramid pyramid;
+    pyramid.build(std::move(image));
+
+    std::vector<const BandMathKernels*> kernelSets = supportedBandMathKernels();
+    size_t kernelIndex = kernelSets.size() - 1;
+    int threadCount = resolveThreadCount();
+
+    // Without --expr: the first preset the source has the bands for (an RGB image has no b4), else b1
+    BandExpression expression;
+    std::string error;
+    if (expressionSource.empty()) {
+        for (int preset = 0; preset < presetCount && expressionSource.empty(); ++preset)
+            if (expression.compile(presetExpressions[preset], pyramid.bandCount(), error))
+                expressionSource = presetExpressions[preset];
+        if (expressionSource.empty())
+            expressionSource = "b1";
+    }
+    if (!expression.compile(expressionSource, pyramid.bandCount(), error)) {
+        std::cerr << "Expression \"" << expressionSource << "\": " << error << std::endl;
+        return -1;
+    }
+    printf("Expression %s: %zu instructions, %d registers\n%s", expression.source().c_str(), expression.program().size(),
+           expression.registerCount(), expression.glslFunction().c_str());
+
+    if (benchmark) {
+        runBenchmark(pyramid);
+        return 0;
+    }
+    if (!exportPath.empty()) {
+        int level = exportLevelIndex >= 0 ? std::min(exportLevelIndex, pyramid.levelCount() - 1) : 0;
+        return exportLevel(exportPath, pyramid, expression, *kernelSets[kernelIndex], level, threadCount) ? 0 : -1;
+    }
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    TileRequestQueue queue;
+    TileLoaderPool loaders;
+    loaders.start(&pyramid, &queue);
+    TileCache cache;
+    Prefetcher prefetcher;
+    BandMathRenderer renderer;
+    renderer.init();
+    renderer.setExpression(expression, &camera);
+
+    // The ramp starts stretched over the statistics of the reduced level
+    BandStatistics stats = computeStatistics(pyramid, expression, *kernelSets[kernelIndex], statisticsLevel(pyramid), threadCount);
+    printStatistics(stats, pyramid, *kernelSets[kernelIndex]);
+    renderer.valueRange = glm::vec2(stats.low, stats.high);
+
+    std::vector<TileRequest> requests;
+    bool presetKeyDown[presetCount] = {};
+    bool prefetchKeyDown = false, stretchKeyDown = false, statsKeyDown = false, kernelKeyDown = false;
+    int frame = 0;
+    double lastTitleTime = glfwGetTime();
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+        int level = pyramid.selectLevel(camera, width, height);
+
+        // 1-5: switch expression; only the program changes, the cached band tiles stay
+        for (int preset = 0; preset < presetCount; ++preset) {
+            bool presetKeyPressed = glfwGetKey(window, GLFW_KEY_1 + preset) == GLFW_PRESS;
+            if (presetKeyPressed && !presetKeyDown[preset]) {
+                BandExpression next;
+                if (!next.compile(presetExpressions[preset], pyramid.bandCount(), error)) {
+                    std::cerr << "Expression \"" << presetExpressions[preset] << "\": " << error << std::endl;
+                } else {
+                    expression = next;
+                    renderer.setExpression(expression, &camera);
+                    stats = computeStatistics(pyramid, expression, *kernelSets[kernelIndex], statisticsLevel(pyramid), threadCount);
+                    printStatistics(stats, pyramid, *kernelSets[kernelIndex]);
+                    renderer.valueRange = glm::vec2(stats.low, stats.high);
+                }
+            }
+            presetKeyDown[preset] = presetKeyPressed;
+        }
+
+        // T: statistics of the level on screen; R: stretch the ramp to the latest statistics
+        bool statsKeyPressed = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+        if (statsKeyPressed && !statsKeyDown) {
+            stats = computeStatistics(pyramid, expression, *kernelSets[kernelIndex], level, threadCount);
+            printStatistics(stats, pyramid, *kernelSets[kernelIndex]);
+        }
+        statsKeyDown = statsKeyPressed;
+
+        bool stretchKeyPressed = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+        if (stretchKeyPressed && !stretchKeyDown)
+            renderer.valueRange = glm::vec2(stats.low, stats.high);
+        stretchKeyDown = stretchKeyPressed;
+
+        bool kernelKeyPressed = glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS;
+        if (kernelKeyPressed && !kernelKeyDown)
+            kernelIndex = (kernelIndex + 1) % kernelSets.size();
+        kernelKeyDown = kernelKeyPressed;
+
+        bool prefetchKeyPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+        if (prefetchKeyPressed && !prefetchKeyDown)
+            prefetcher.enabled = !prefetcher.enabled;
+        prefetchKeyDown = prefetchKeyPressed;
+
+        camera.updateMotion(glfwGetTime());
+
+        // The whole wanted set goes to the queue every frame; whatever it no longer contains is cancelled
+        prefetcher.collect(camera, pyramid, cache, width, height, requests);
+        queue.submitFrame(requests);
+
+        for (const LoadedTile& tile : loaders.takeCompleted(maxUploadsPerFrame)) {
+            cache.upload(tile, frame);
+            queue.delivered(tile.key);
+        }
+
+        camera.publish(width, height);
+        renderer.render(camera, pyramid, cache, level, frame);
+        cache.evict(frame);
+
+        double now = glfwGetTime();
+        if (now - lastTitleTime > 0.5) {
+            char title[320];
+            snprintf(title, sizeof(title), "OpenGL - %s | level %d | ramp %.3f to %.3f | mean %.3f (level %d) | %s kernels | pending %zu, holes %d",
+                     expression.source().c_str(), level, renderer.valueRange.x, renderer.valueRange.y, stats.mean, stats.level,
+                     kernelSets[kernelIndex]->name, queue.pendingCount(), renderer.holes);
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    printf("Frames: %d, programs built: %zu, tile uploads: %d\n", frame, renderer.programCount(), cache.getUploads());
+
+    loaders.stop();
+    renderer.destroy();
+    cache.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,1209 @@
+// multi-threaded JPEG decoding with libjpeg(-turbo)
+// stb_image decodes a JPEG on one core, which takes seconds for 200+ MP aerial images. This decoder splits
+// the work across all cores in one of two ways:
+//  - restart segments: if the file has restart markers (DRI) that fall on MCU row boundaries, the entropy
+//    coded scan is cut at those markers into independent bands. Each band is wrapped in a copy of the
+//    headers (with the frame height patched and its RSTn markers renumbered) and decoded by its own
+//    libjpeg instance straight into its rows of the output image.
+//  - parallel IDCT: otherwise (no restart markers, progressive files) one thread runs the entropy decoder
+//    with jpeg_read_coefficients, then all threads dequantize, inverse-transform, upsample and colour
+//    convert MCU rows in parallel. YCbCr -> RGBA uses SSE2 / AVX2 / NEON kernels with a scalar reference.
+//    Entropy decoding stays serial here and is most of libjpeg-turbo's time on sequential files, so this
+//    path pays off mainly for progressive files; writing restart markers when the imagery is produced
+//    (e.g. cjpeg -restart 1) is what makes a sequential file decode in parallel.
+// Both paths decode at 1/2, 1/4 and 1/8 scale by DCT scaling (an N x N inverse transform of the lowest
+// coefficients) instead of decoding the full image and downsampling, which is what coarse pyramid levels
+// need. Colour spaces other than YCbCr, RGB and grayscale go through a single-threaded libjpeg decode.
+// Usage: jpeg_parallel [image.jpg ...]     viewer; N cycles images, 1-4 select scale 1/1..1/8, P cycles path
+//        jpeg_parallel --benchmark [image.jpg ...]   MP/s of each path and scale against stb_image
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <csetjmp>
+#include <numeric>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <cstddef> // jpeglib.h expects size_t and FILE to be declared
+#include <cstdio>
+#include <jpeglib.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+// Sample images cycled with N
+const char* sampleImagePaths[] = {
+    "src/textures/assets/test.jpg",
+};
+
+// Decoder threads; 0 uses one per hardware thread
+const int decoderThreadCount = 0;
+
+// Restart segments handed out per thread, so threads that finish early pick up the remainder
+const int segmentsPerThread = 4;
+
+// Benchmark repetitions; the best run counts
+const int benchmarkRuns = 5;
+
+// Scale denominators selected with keys 1-4
+const int scaleDenominators[] = { 1, 2, 4, 8 };
+
+int resolveThreadCount() {
+    if (decoderThreadCount > 0)
+        return decoderThreadCount;
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+struct RgbaImage {
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;
+};
+
+// Runs task(i) for i in [0, count) on up to threadCount threads (the caller is one of them)
+template <typename Task>
+void parallelFor(int count, int threadCount, const Task& task) {
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for (int i = next++; i < count; i = next++)
+            task(i);
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < std::min(threadCount, count); ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// YCbCr -> RGBA colour conversion. JFIF coefficients in Q14 fixed point; the SIMD kernels compute exactly the
+// scalar formula, so every kernel set gives identical pixels.
+// ---------------------------------------------------------------------------------------------------------
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PIXEL_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define PIXEL_TARGET(isa)
+#else
+#define PIXEL_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define PIXEL_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// R = Y + 1.402 Cr, G = Y - 0.34414 Cb - 0.71414 Cr, B = Y + 1.772 Cb (Cb, Cr centred on 0), times 2^14
+const int crToR = 22970;
+const int cbToG = -5638;
+const int crToG = -11700;
+const int cbToB = 29032;
+const int colorRound = 1 << 13;
+
+struct ColorKernels {
+    const char* name;
+    void (*ycbcrToRgba)(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, uint8_t* dst, size_t count);
+};
+
+inline uint8_t clampSample(int value) {
+    return static_cast<uint8_t>(std::min(255, std::max(0, value)));
+}
+
+void ycbcrToRgbaScalar(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i, dst += 4) {
+        int luma = y[i], blue = cb[i] - 128, red = cr[i] - 128;
+        dst[0] = clampSample(luma + ((red * crToR + colorRound) >> 14));
+        dst[1] = clampSample(luma + ((blue * cbToG + red * crToG + colorRound) >> 14));
+        dst[2] = clampSample(luma + ((blue * cbToB + colorRound) >> 14));
+        dst[3] = 255;
+    }
+}
+
+const ColorKernels scalarColorKernels = { "scalar", ycbcrToRgbaScalar };
+
+#if PIXEL_KERNELS_X86
+
+// Each product term is a pmaddwd of (sample, 1) or (Cb, Cr) pairs, which folds the rounding constant in
+inline uint32_t packPair(int low, int high) {
+    return (static_cast<uint32_t>(high) << 16) | (static_cast<uint32_t>(low) & 0xFFFF);
+}
+
+// 8 pixels per iteration
+PIXEL_TARGET("sse2") void ycbcrToRgbaSse(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, uint8_t* dst, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i center = _mm_set1_epi16(128);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i red = _mm_set1_epi32(static_cast<int>(packPair(crToR, colorRound)));
+    const __m128i green = _mm_set1_epi32(static_cast<int>(packPair(cbToG, crToG)));
+    const __m128i blue = _mm_set1_epi32(static_cast<int>(packPair(cbToB, colorRound)));
+    const __m128i round = _mm_set1_epi32(colorRound);
+    const __m128i alpha = _mm_set1_epi8(-1);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, dst += 32) {
+        __m128i y16 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + i)), zero);
+        __m128i cb16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cb + i)), zero), center);
+        __m128i cr16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cr + i)), zero), center);
+
+        __m128i rLo = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(cr16, one), red), 14);
+        __m128i rHi = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(cr16, one), red), 14);
+        __m128i gLo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(cb16, cr16), green), round), 14);
+        __m128i gHi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(cb16, cr16), green), round), 14);
+        __m128i bLo = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(cb16, one), blue), 14);
+        __m128i bHi = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(cb16, one), blue), 14);
+
+        __m128i r8 = _mm_packus_epi16(_mm_add_epi16(y16, _mm_packs_epi32(rLo, rHi)), zero);
+        __m128i g8 = _mm_packus_epi16(_mm_add_epi16(y16, _mm_packs_epi32(gLo, gHi)), zero);
+        __m128i b8 = _mm_packus_epi16(_mm_add_epi16(y16, _mm_packs_epi32(bLo, bHi)), zero);
+        __m128i rg = _mm_unpacklo_epi8(r8, g8);
+        __m128i ba = _mm_unpacklo_epi8(b8, alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi16(rg, ba));
+    }
+    ycbcrToRgbaScalar(y + i, cb + i, cr + i, dst, count - i);
+}
+
+// 16 pixels per iteration; the in-lane unpack/pack pairs keep pixel order, only the final store crosses lanes
+PIXEL_TARGET("avx2") void ycbcrToRgbaAvx2(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, uint8_t* dst, size_t count) {
+    const __m256i center = _mm256_set1_epi16(128);
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i red = _mm256_set1_epi32(static_cast<int>(packPair(crToR, colorRound)));
+    const __m256i green = _mm256_set1_epi32(static_cast<int>(packPair(cbToG, crToG)));
+    const __m256i blue = _mm256_set1_epi32(static_cast<int>(packPair(cbToB, colorRound)));
+    const __m256i round = _mm256_set1_epi32(colorRound);
+    const __m256i maxSample = _mm256_set1_epi16(255);
+    const __m256i alpha = _mm256_set1_epi16(static_cast<short>(0xFF00));
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16, dst += 64) {
+        __m256i y16 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+        __m256i cb16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cb + i))), center);
+        __m256i cr16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cr + i))), center);
+
+        __m256i rLo = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(cr16, one), red), 14);
+        __m256i rHi = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(cr16, one), red), 14);
+        __m256i gLo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(cb16, cr16), green), round), 14);
+        __m256i gHi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(cb16, cr16), green), round), 14);
+        __m256i bLo = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(cb16, one), blue), 14);
+        __m256i bHi = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(cb16, one), blue), 14);
+
+        __m256i r16 = _mm256_min_epi16(_mm256_max_epi16(_mm256_add_epi16(y16, _mm256_packs_epi32(rLo, rHi)), zero), maxSample);
+        __m256i g16 = _mm256_min_epi16(_mm256_max_epi16(_mm256_add_epi16(y16, _mm256_packs_epi32(gLo, gHi)), zero), maxSample);
+        __m256i b16 = _mm256_min_epi16(_mm256_max_epi16(_mm256_add_epi16(y16, _mm256_packs_epi32(bLo, bHi)), zero), maxSample);
+        __m256i rg = _mm256_or_si256(r16, _mm256_slli_epi16(g16, 8));
+        __m256i ba = _mm256_or_si256(b16, alpha);
+        __m256i lo = _mm256_unpacklo_epi16(rg, ba);
+        __m256i hi = _mm256_unpackhi_epi16(rg, ba);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    ycbcrToRgbaSse(y + i, cb + i, cr + i, dst, count - i);
+}
+
+const ColorKernels sseColorKernels = { "sse2", ycbcrToRgbaSse };
+const ColorKernels avx2ColorKernels = { "avx2", ycbcrToRgbaAvx2 };
+
+#elif PIXEL_KERNELS_NEON
+
+// 8 pixels per iteration; vst4 interleaves the planes into RGBA
+void ycbcrToRgbaNeon(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, uint8_t* dst, size_t count) {
+    const int16x8_t center = vdupq_n_s16(128);
+    const int32x4_t round = vdupq_n_s32(colorRound);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, dst += 32) {
+        int16x8_t y16 = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + i)));
+        int16x8_t cb16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(cb + i))), center);
+        int16x8_t cr16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(cr + i))), center);
+        int32x4_t rLo = vmlal_n_s16(round, vget_low_s16(cr16), crToR);
+        int32x4_t rHi = vmlal_n_s16(round, vget_high_s16(cr16), crToR);
+        int32x4_t gLo = vmlal_n_s16(vmlal_n_s16(round, vget_low_s16(cb16), cbToG), vget_low_s16(cr16), crToG);
+        int32x4_t gHi = vmlal_n_s16(vmlal_n_s16(round, vget_high_s16(cb16), cbToG), vget_high_s16(cr16), crToG);
+        int32x4_t bLo = vmlal_n_s16(round, vget_low_s16(cb16), cbToB);
+        int32x4_t bHi = vmlal_n_s16(round, vget_high_s16(cb16), cbToB);
+        uint8x8x4_t rgba;
+        rgba.val[0] = vqmovun_s16(vaddq_s16(y16, vcombine_s16(vshrn_n_s32(rLo, 14), vshrn_n_s32(rHi, 14))));
+        rgba.val[1] = vqmovun_s16(vaddq_s16(y16, vcombine_s16(vshrn_n_s32(gLo, 14), vshrn_n_s32(gHi, 14))));
+        rgba.val[2] = vqmovun_s16(vaddq_s16(y16, vcombine_s16(vshrn_n_s32(bLo, 14), vshrn_n_s32(bHi, 14))));
+        rgba.val[3] = vdup_n_u8(255);
+        vst4_u8(dst, rgba);
+    }
+    ycbcrToRgbaScalar(y + i, cb + i, cr + i, dst, count - i);
+}
+
+const ColorKernels neonColorKernels = { "neon", ycbcrToRgbaNeon };
+
+#endif
+
+// Scalar first, widest last
+std::vector<const ColorKernels*> supportedColorKernels() {
+    std::vector<const ColorKernels*> sets = { &scalarColorKernels };
+#if PIXEL_KERNELS_X86
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    bool avx2 = osAvx && (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    bool sse2 = __builtin_cpu_supports("sse2");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (sse2)
+        sets.push_back(&sseColorKernels);
+    if (avx2)
+        sets.push_back(&avx2ColorKernels);
+#elif PIXEL_KERNELS_NEON
+    sets.push_back(&neonColorKernels);
+#endif
+    return sets;
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// libjpeg plumbing
+// ---------------------------------------------------------------------------------------------------------
+
+// libjpeg reports fatal errors through error_exit, which must not return: jump back to the decode call.
+// Everything with a destructor in the decode functions is constructed before their setjmp.
+struct JpegErrorManager {
+    jpeg_error_mgr base;
+    jmp_buf jump;
+    char message[JMSG_LENGTH_MAX];
+};
+
+void jpegErrorExit(j_common_ptr cinfo) {
+    JpegErrorManager* error = reinterpret_cast<JpegErrorManager*>(cinfo->err);
+    (*cinfo->err->format_message)(cinfo, error->message);
+    longjmp(error->jump, 1);
+}
+
+// Warnings (corrupt data, bad restart markers) are only counted, in err->num_warnings
+void jpegOutputMessage(j_common_ptr) {}
+
+struct JpegDecompressor {
+    jpeg_decompress_struct cinfo;
+    JpegErrorManager error;
+
+    JpegDecompressor() {
+        cinfo.err = jpeg_std_error(&error.base);
+        error.base.error_exit = jpegErrorExit;
+        error.base.output_message = jpegOutputMessage;
+        error.message[0] = '\0';
+        jpeg_create_decompress(&cinfo);
+    }
+    JpegDecompressor(const JpegDecompressor&) = delete;
+    JpegDecompressor& operator=(const JpegDecompressor&) = delete;
+    ~JpegDecompressor() { jpeg_destroy_decompress(&cinfo); }
+};
+
+// In-place CMYK to RGBA. Adobe files, where nearly all CMYK JPEGs come from, store the inks inverted.
+void cmykToRgba(uint8_t* pixels, size_t count, bool inverted) {
+    for (size_t i = 0; i < count; ++i, pixels += 4) {
+        int k = inverted ? pixels[3] : 255 - pixels[3];
+        for (int c = 0; c < 3; ++c) {
+            int ink = inverted ? pixels[c] : 255 - pixels[c];
+            pixels[c] = static_cast<uint8_t>((ink * k + 127) / 255);
+        }
+        pixels[3] = 255;
+    }
+}
+
+// Decodes a complete JPEG stream with libjpeg at 1/scaleDenom scale. The first skipRows output rows are
+// decoded and dropped, the next ones go to dst until maxRows rows are written.
+bool decodeJpegStream(const uint8_t* data, size_t size, int scaleDenom, int skipRows, uint8_t* dst, size_t dstStride, int maxRows, long* warnings) {
+    JpegDecompressor jpeg;
+    std::vector<uint8_t> skipped;
+    if (setjmp(jpeg.error.jump)) {
+        std::cerr << "JPEG decode failed: " << jpeg.error.message << std::endl;
+        return false;
+    }
+    jpeg_mem_src(&jpeg.cinfo, data, static_cast<unsigned long>(size));
+    jpeg_read_header(&jpeg.cinfo, TRUE);
+    jpeg.cinfo.scale_num = 1;
+    jpeg.cinfo.scale_denom = scaleDenom;
+    // libjpeg cannot convert CMYK or YCCK to RGBA; those are decoded as CMYK, 4 bytes a pixel like RGBA, and
+    // converted in place
+    bool cmyk = jpeg.cinfo.jpeg_color_space == JCS_CMYK || jpeg.cinfo.jpeg_color_space == JCS_YCCK;
+    jpeg.cinfo.out_color_space = cmyk ? JCS_CMYK : JCS_EXT_RGBA;
+    jpeg_start_decompress(&jpeg.cinfo);
+    skipped.resize(static_cast<size_t>(jpeg.cinfo.output_width) * 4);
+    int endRow = std::min(static_cast<int>(jpeg.cinfo.output_height), skipRows + maxRows);
+    while (static_cast<int>(jpeg.cinfo.output_scanline) < endRow) {
+        int row = static_cast<int>(jpeg.cinfo.output_scanline);
+        JSAMPROW target = row < skipRows ? skipped.data() : dst + (row - skipRows) * dstStride;
+        jpeg_read_scanlines(&jpeg.cinfo, &target, 1);
+        if (cmyk && row >= skipRows)
+            cmykToRgba(target, jpeg.cinfo.output_width, jpeg.cinfo.saw_Adobe_marker);
+    }
+    jpeg_abort_decompress(&jpeg.cinfo);
+    if (warnings)
+        *warnings += jpeg.error.base.num_warnings;
+    return true;
+}
+
+// Output size libjpeg produces for a 1/scaleDenom decode
+int scaledSize(int size, int scaleDenom) {
+    return (size + scaleDenom - 1) / scaleDenom;
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Stream layout: where the entropy coded scan and its restart markers are
+// ---------------------------------------------------------------------------------------------------------
+
+struct JpegLayout {
+    int width = 0, height = 0;
+    int mcuWidth = 8, mcuHeight = 8;         // pixels
+    int restartInterval = 0;                 // MCUs between restart markers, 0 = none
+    bool singleScan = false;                 // sequential Huffman frame with one scan over all components
+    std::vector<uint8_t> header;             // SOI, tables, SOF, DRI and SOS; APPn and COM dropped
+    size_t heightField = 0;                  // offset of the frame height inside header
+    size_t scanBegin = 0, scanEnd = 0;       // entropy coded data, file offsets
+    std::vector<size_t> restartMarkers;      // file offsets of the RSTn markers, in order
+
+    int mcusPerRow() const { return (width + mcuWidth - 1) / mcuWidth; }
+    int mcuRows() const { return (height + mcuHeight - 1) / mcuHeight; }
+};
+
+inline int readBigEndian16(const uint8_t* p) {
+    return (p[0] << 8) | p[1];
+}
+
+bool parseJpegLayout(const uint8_t* data, size_t size, JpegLayout& layout) {
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8)
+        return false;
+    layout.header.assign(data, data + 2);
+    int frameComponents = 0;
+    bool sequential = false;
+    size_t pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF)
+            return false;
+        uint8_t marker = data[pos + 1];
+        if (marker == 0xFF) {
+            ++pos;
+            continue;
+        }
+        size_t length = static_cast<size_t>(readBigEndian16(data + pos + 2));
+        if (length < 2 || pos + 2 + length > size)
+            return false;
+        const uint8_t* segment = data + pos + 4;
+        bool keep = !((marker >= 0xE0 && marker <= 0xEF && marker != 0xEE) || marker == 0xFE);
+
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            if (length < 8)
+                return false;
+            sequential = marker == 0xC0 || marker == 0xC1;
+            layout.height = readBigEndian16(segment + 1);
+            layout.width = readBigEndian16(segment + 3);
+            frameComponents = segment[5];
+            layout.heightField = layout.header.size() + 5;
+            int maxH = 1, maxV = 1;
+            for (int c = 0; c < frameComponents && 8 + 3 * c <= static_cast<int>(length); ++c) {
+                maxH = std::max(maxH, segment[7 + 3 * c] >> 4);
+                maxV = std::max(maxV, segment[7 + 3 * c] & 15);
+            }
+            layout.mcuWidth = frameComponents > 1 ? 8 * maxH : 8;
+            layout.mcuHeight = frameComponents > 1 ? 8 * maxV : 8;
+        } else if (marker == 0xDD && length >= 4) {
+            layout.restartInterval = readBigEndian16(segment);
+        }
+        if (keep)
+            layout.header.insert(layout.header.end(), data + pos, data + pos + 2 + length);
+        pos += 2 + length;
+
+        if (marker == 0xDA) {
+            int scanComponents = segment[0];
+            layout.scanBegin = pos;
+            // Find the end of the scan and every restart marker in it; FF00 is a stuffed data byte
+            size_t i = pos;
+            while (true) {
+                const void* found = memchr(data + i, 0xFF, size - i);
+                if (!found || static_cast<const uint8_t*>(found) + 1 >= data + size)
+                    return false;
+                i = static_cast<const uint8_t*>(found) - data;
+                uint8_t next = data[i + 1];
+                if (next == 0x00 || next == 0xFF) {
+                    i += next == 0x00 ? 2 : 1;
+                } else if (next >= 0xD0 && next <= 0xD7) {
+                    layout.restartMarkers.push_back(i);
+                    i += 2;
+                } else {
+                    break;
+                }
+            }
+            layout.scanEnd = i;
+            layout.singleScan = sequential && scanComponents == frameComponents && layout.height > 0 &&
+                                data[i + 1] == 0xD9;
+            return layout.width > 0;
+        }
+    }
+    return false;
+}
+
+// Restart segments can be used if every restart interval is complete and some of them start on MCU rows
+bool canSplitAtRestarts(const JpegLayout& layout) {
+    if (!layout.singleScan || layout.restartInterval == 0)
+        return false;
+    long long totalMcus = static_cast<long long>(layout.mcusPerRow()) * layout.mcuRows();
+    long long intervals = (totalMcus + layout.restartInterval - 1) / layout.restartInterval;
+    return static_cast<long long>(layout.restartMarkers.size()) == intervals - 1;
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Parallel paths
+// ---------------------------------------------------------------------------------------------------------
+
+enum class JpegPath { Auto, RestartSegments, ParallelIdct, Serial };
+
+const char* jpegPathName(JpegPath path) {
+    switch (path) {
+    case JpegPath::Auto: return "auto";
+    case JpegPath::RestartSegments: return "restart segments";
+    case JpegPath::ParallelIdct: return "parallel IDCT";
+    case JpegPath::Serial: return "single thread";
+    }
+    return "";
+}
+
+struct JpegDecodeInfo {
+    JpegPath path = JpegPath::Serial;
+    int tasks = 0;             // restart segments or MCU rows processed in parallel
+    double entropyMs = 0.0;    // serial entropy decoding before the parallel IDCT
+    long warnings = 0;
+};
+
+bool decodeRestartSegments(const uint8_t* data, const JpegLayout& layout, int scaleDenom, int threadCount, RgbaImage& image, JpegDecodeInfo& info) {
+    // Restart boundaries coincide with MCU row starts every rowStep rows
+    int mcusPerRow = layout.mcusPerRow(), mcuRows = layout.mcuRows();
+    int rowStep = layout.restartInterval / std::gcd(layout.restartInterval, mcusPerRow);
+    int targetSegments = threadCount * segmentsPerThread;
+    int rowsPerSegment = (mcuRows + targetSegments - 1) / targetSegments;
+    rowsPerSegment = std::max(rowStep, (rowsPerSegment + rowStep - 1) / rowStep * rowStep);
+    int segments = (mcuRows + rowsPerSegment - 1) / rowsPerSegment;
+    if (segments < 2)
+        return false;
+
+    int intervals = static_cast<int>(layout.restartMarkers.size()) + 1;
+    size_t stride = static_cast<size_t>(image.width) * 4;
+    std::atomic<bool> ok(true);
+    std::atomic<long> warnings(0);
+    parallelFor(segments, threadCount, [&](int segment) {
+        // With vertically subsampled chroma libjpeg's upsampler reads the chroma rows above and below, so
+        // the segment is decoded with one restart step of context on each side to match a whole-file decode
+        int firstRow = segment * rowsPerSegment;
+        int endRow = std::min(mcuRows, firstRow + rowsPerSegment);
+        int ownFirstRow = firstRow;
+        int ownEndRow = endRow;
+        if (layout.mcuHeight > 8) {
+            firstRow = std::max(0, firstRow - rowStep);
+            endRow = std::min(mcuRows, endRow + rowStep);
+        }
+        int firstInterval = static_cast<int>(static_cast<long long>(firstRow) * mcusPerRow / layout.restartInterval);
+        int endInterval = endRow == mcuRows ? intervals : static_cast<int>(static_cast<long long>(endRow) * mcusPerRow / layout.restartInterval);
+        size_t begin = firstInterval == 0 ? layout.scanBegin : layout.restartMarkers[firstInterval - 1] + 2;
+        size_t end = endInterval == intervals ? layout.scanEnd : layout.restartMarkers[endInterval - 1];
+
+        // Standalone stream: headers with this band's height, its scan data with RST0.. renumbered, EOI
+        std::vector<uint8_t> stream(layout.header);
+        int firstPixelRow = firstRow * layout.mcuHeight;
+        int height = std::min(layout.height, endRow * layout.mcuHeight) - firstPixelRow;
+        stream[layout.heightField] = static_cast<uint8_t>(height >> 8);
+        stream[layout.heightField + 1] = static_cast<uint8_t>(height);
+        size_t scanOffset = stream.size();
+        stream.insert(stream.end(), data + begin, data + end);
+        for (int interval = firstInterval; interval + 1 < endInterval; ++interval)
+            stream[scanOffset + layout.restartMarkers[interval] - begin + 1] = static_cast<uint8_t>(0xD0 + ((interval - firstInterval) & 7));
+        stream.push_back(0xFF);
+        stream.push_back(0xD9);
+
+        int firstOutputRow = ownFirstRow * layout.mcuHeight / scaleDenom;
+        int endOutputRow = std::min(image.height, ownEndRow * layout.mcuHeight / scaleDenom);
+        long segmentWarnings = 0;
+        if (!decodeJpegStream(stream.data(), stream.size(), scaleDenom, firstOutputRow - firstPixelRow / scaleDenom,
+                              image.pixels.data() + firstOutputRow * stride, stride, endOutputRow - firstOutputRow, &segmentWarnings))
+            ok = false;
+        warnings += segmentWarnings;
+    });
+    info.path = JpegPath::RestartSegments;
+    info.tasks = segments;
+    info.warnings = warnings;
+    return ok;
+}
+
+// Scaled inverse DCT basis: basis[n][u * n + x] = c(u) cos((2x + 1) u pi / 2n), c(0) = 1 / (2 sqrt 2),
+// c(u) = 1/2. An n-point transform of the lowest n x n coefficients of an 8 x 8 block reconstructs the block
+// downscaled by 8 / n; with these factors n = 8 is the standard JPEG IDCT.
+struct IdctBasis {
+    float basis[9][64];
+
+    IdctBasis() {
+        for (int n = 1; n <= 8; n *= 2)
+            for (int u = 0; u < n; ++u)
+                for (int x = 0; x < n; ++x)
+                    basis[n][u * n + x] = static_cast<float>((u == 0 ? 0.5 / std::sqrt(2.0) : 0.5) * std::cos((2 * x + 1) * u * 3.14159265358979323846 / (2 * n)));
+    }
+};
+
+const IdctBasis idctBasis;
+
+// Dequantizes and inverse-transforms one block into an n x n tile of samples. Both passes are sums of basis
+// rows scaled by one value, so the inner loops vectorize; coefficient rows that are all zero (most of the
+// high frequency ones) are skipped as a whole, without a branch per coefficient.
+template <int N>
+void inverseDct(const JCOEF* coefficients, const float* quant, uint8_t* out, size_t stride) {
+    const float* basis = idctBasis.basis[N];
+    float rows[N][N];
+    bool rowUsed[N];
+    for (int v = 0; v < N; ++v) {
+        const JCOEF* row = coefficients + v * 8;
+        uint64_t bits[2];
+        memcpy(bits, row, sizeof(bits));
+        rowUsed[v] = (bits[0] | bits[1]) != 0;
+        if (!rowUsed[v])
+            continue;
+        for (int x = 0; x < N; ++x)
+            rows[v][x] = 0.0f;
+        for (int u = 0; u < N; ++u) {
+            float value = row[u] * quant[v * 8 + u];
+            for (int x = 0; x < N; ++x)
+                rows[v][x] += value * basis[u * N + x];
+        }
+    }
+    float samples[N][N];
+    for (int y = 0; y < N; ++y)
+        for (int x = 0; x < N; ++x)
+            samples[y][x] = 128.5f;
+    for (int v = 0; v < N; ++v) {
+        if (!rowUsed[v])
+            continue;
+        for (int y = 0; y < N; ++y) {
+            float weight = basis[v * N + y];
+            for (int x = 0; x < N; ++x)
+                samples[y][x] += weight * rows[v][x];
+        }
+    }
+    for (int y = 0; y < N; ++y)
+        for (int x = 0; x < N; ++x)
+            out[y * stride + x] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, samples[y][x])));
+}
+
+#if PIXEL_KERNELS_X86
+
+// Full size IDCT with the same arithmetic on four columns per register; the float -> byte conversion
+// truncates and saturates exactly like the scalar clamp
+PIXEL_TARGET("sse2") void inverseDct8Sse(const JCOEF* coefficients, const float* quant, uint8_t* out, size_t stride) {
+    const float* basis = idctBasis.basis[8];
+    __m128 samples[8][2];
+    for (int y = 0; y < 8; ++y)
+        samples[y][0] = samples[y][1] = _mm_set1_ps(128.5f);
+    for (int v = 0; v < 8; ++v) {
+        __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefficients + v * 8));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(row, _mm_setzero_si128())) == 0xFFFF)
+            continue;
+        __m128 values[2] = {
+            _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(row, row), 16)), _mm_loadu_ps(quant + v * 8)),
+            _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(row, row), 16)), _mm_loadu_ps(quant + v * 8 + 4)),
+        };
+        __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+        for (int u = 0; u < 8; ++u) {
+            __m128 value = _mm_set1_ps(reinterpret_cast<const float*>(&values[u >> 2])[u & 3]);
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(value, _mm_loadu_ps(basis + u * 8)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(value, _mm_loadu_ps(basis + u * 8 + 4)));
+        }
+        for (int y = 0; y < 8; ++y) {
+            __m128 weight = _mm_set1_ps(basis[v * 8 + y]);
+            samples[y][0] = _mm_add_ps(samples[y][0], _mm_mul_ps(weight, sum0));
+            samples[y][1] = _mm_add_ps(samples[y][1], _mm_mul_ps(weight, sum1));
+        }
+    }
+    for (int y = 0; y < 8; ++y) {
+        __m128i words = _mm_packs_epi32(_mm_cvttps_epi32(samples[y][0]), _mm_cvttps_epi32(samples[y][1]));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + y * stride), _mm_packus_epi16(words, words));
+    }
+}
+
+#endif
+
+enum class JpegColor { YCbCr, Grayscale, Rgb };
+
+// Coefficients gathered from jpeg_read_coefficients; the virtual arrays live entirely in memory, so the
+// block row pointers stay valid for the worker threads until the decompressor is finished
+struct CoefficientImage {
+    struct Component {
+        int h = 1, v = 1;
+        int widthInBlocks = 0, heightInBlocks = 0;
+        float quant[64];
+        std::vector<JBLOCKROW> blockRows;
+    };
+    std::vector<Component> components;
+    JpegColor color = JpegColor::YCbCr;
+    int maxH = 1, maxV = 1;
+    int blockSize = 8;          // 8 / scale denominator
+    int mcuRows = 0;
+};
+
+// IDCT, upsampling and colour conversion of one MCU row into its output rows. Chroma is upsampled by
+// replication, so rows never need samples from a neighbouring MCU row.
+void decodeCoefficientRow(const CoefficientImage& coefficients, int mcuRow, int scaleDenom, const ColorKernels& colors, RgbaImage& image) {
+    thread_local std::vector<uint8_t> planes[3];
+    thread_local std::vector<uint8_t> upsampled[3];
+    int n = coefficients.blockSize;
+    const uint8_t* rows[3] = {};
+    int planeWidths[3] = {};
+
+    for (size_t c = 0; c < coefficients.components.size(); ++c) {
+        const CoefficientImage::Component& component = coefficients.components[c];
+        int planeWidth = component.widthInBlocks * n;
+        planeWidths[c] = planeWidth;
+        planes[c].resize(static_cast<size_t>(planeWidth) * component.v * n);
+        int firstBlockRow = mcuRow * component.v;
+        int endBlockRow = std::min(firstBlockRow + component.v, component.heightInBlocks);
+        for (int blockRow = firstBlockRow; blockRow < endBlockRow; ++blockRow) {
+            JBLOCKROW blocks = component.blockRows[blockRow];
+            uint8_t* out = planes[c].data() + static_cast<size_t>(blockRow - firstBlockRow) * n * planeWidth;
+            for (int bx = 0; bx < component.widthInBlocks; ++bx, out += n) {
+                switch (n) {
+#if PIXEL_KERNELS_X86
+                case 8: inverseDct8Sse(blocks[bx], component.quant, out, planeWidth); break;
+#else
+                case 8: inverseDct<8>(blocks[bx], component.quant, out, planeWidth); break;
+#endif
+                case 4: inverseDct<4>(blocks[bx], component.quant, out, planeWidth); break;
+                case 2: inverseDct<2>(blocks[bx], component.quant, out, planeWidth); break;
+                default: inverseDct<1>(blocks[bx], component.quant, out, planeWidth); break;
+                }
+            }
+        }
+    }
+
+    int mcuOutputRows = 8 * coefficients.maxV / scaleDenom;
+    int firstY = mcuRow * mcuOutputRows;
+    int endY = std::min(image.height, firstY + mcuOutputRows);
+    for (int y = firstY; y < endY; ++y) {
+        for (size_t c = 0; c < coefficients.components.size(); ++c) {
+            const CoefficientImage::Component& component = coefficients.components[c];
+            int planeRow = y * component.v / coefficients.maxV - mcuRow * component.v * n;
+            const uint8_t* src = planes[c].data() + static_cast<size_t>(planeRow) * planeWidths[c];
+            if (component.h == coefficients.maxH) {
+                rows[c] = src;
+                continue;
+            }
+            upsampled[c].resize(image.width);
+            uint8_t* dst = upsampled[c].data();
+            if (component.h * 2 == coefficients.maxH) {
+                for (int x = 0; x < image.width; ++x)
+                    dst[x] = src[x >> 1];
+            } else {
+                for (int x = 0; x < image.width; ++x)
+                    dst[x] = src[x * component.h / coefficients.maxH];
+            }
+            rows[c] = dst;
+        }
+        uint8_t* dst = image.pixels.data() + static_cast<size_t>(y) * image.width * 4;
+        if (coefficients.color == JpegColor::YCbCr) {
+            colors.ycbcrToRgba(rows[0], rows[1], rows[2], dst, image.width);
+        } else {
+            bool gray = coefficients.color == JpegColor::Grayscale;
+            for (int x = 0; x < image.width; ++x, dst += 4) {
+                dst[0] = rows[0][x];
+                dst[1] = gray ? rows[0][x] : rows[1][x];
+                dst[2] = gray ? rows[0][x] : rows[2][x];
+                dst[3] = 255;
+            }
+        }
+    }
+}
+
+// Returns false without touching the image if the colour space is not handled here (CMYK, YCCK); the
+// serial decode converts those
+bool decodeParallelIdct(const uint8_t* data, size_t size, int scaleDenom, int threadCount, const ColorKernels& colors, RgbaImage& image, JpegDecodeInfo& info) {
+    JpegDecompressor jpeg;
+    CoefficientImage coefficients;
+    if (setjmp(jpeg.error.jump)) {
+        std::cerr << "JPEG decode failed: " << jpeg.error.message << std::endl;
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    jpeg_mem_src(&jpeg.cinfo, data, static_cast<unsigned long>(size));
+    jpeg_read_header(&jpeg.cinfo, TRUE);
+    jpeg_decompress_struct& cinfo = jpeg.cinfo;
+    if (cinfo.jpeg_color_space == JCS_YCbCr && cinfo.num_components == 3)
+        coefficients.color = JpegColor::YCbCr;
+    else if (cinfo.jpeg_color_space == JCS_RGB && cinfo.num_components == 3)
+        coefficients.color = JpegColor::Rgb;
+    else if (cinfo.jpeg_color_space == JCS_GRAYSCALE && cinfo.num_components == 1)
+        coefficients.color = JpegColor::Grayscale;
+    else
+        return false;
+
+    jvirt_barray_ptr* arrays = jpeg_read_coefficients(&cinfo);
+    info.entropyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    coefficients.maxH = cinfo.max_h_samp_factor;
+    coefficients.maxV = cinfo.max_v_samp_factor;
+    coefficients.blockSize = 8 / scaleDenom;
+    coefficients.mcuRows = (static_cast<int>(cinfo.image_height) + 8 * coefficients.maxV - 1) / (8 * coefficients.maxV);
+    coefficients.components.resize(cinfo.num_components);
+    for (int c = 0; c < cinfo.num_components; ++c) {
+        const jpeg_component_info& componentInfo = cinfo.comp_info[c];
+        CoefficientImage::Component& component = coefficients.components[c];
+        component.h = componentInfo.h_samp_factor;
+        component.v = componentInfo.v_samp_factor;
+        component.widthInBlocks = static_cast<int>(componentInfo.width_in_blocks);
+        component.heightInBlocks = static_cast<int>(componentInfo.height_in_blocks);
+        for (int k = 0; k < 64; ++k)
+            component.quant[k] = componentInfo.quant_table ? componentInfo.quant_table->quantval[k] : 1.0f;
+        for (int row = 0; row < component.heightInBlocks; row += component.v) {
+            JBLOCKARRAY blocks = (*cinfo.mem->access_virt_barray)(reinterpret_cast<j_common_ptr>(&cinfo), arrays[c], row, component.v, FALSE);
+            for (int i = 0; i < component.v && row + i < component.heightInBlocks; ++i)
+                component.blockRows.push_back(blocks[i]);
+        }
+    }
+
+    parallelFor(coefficients.mcuRows, threadCount, [&](int mcuRow) {
+        decodeCoefficientRow(coefficients, mcuRow, scaleDenom, colors, image);
+    });
+    info.path = JpegPath::ParallelIdct;
+    info.tasks = coefficients.mcuRows;
+    info.warnings = jpeg.error.base.num_warnings;
+    jpeg_finish_decompress(&cinfo);
+    return true;
+}
+
+// Decodes a JPEG file held in memory at 1/scaleDenom (1, 2, 4 or 8) scale into top-down RGBA
+bool decodeJpeg(const std::vector<uint8_t>& file, JpegPath path, int scaleDenom, int threadCount, const ColorKernels& colors, RgbaImage& image, JpegDecodeInfo& info) {
+    JpegLayout layout;
+    if (!parseJpegLayout(file.data(), file.size(), layout))
+        return false;
+    info = JpegDecodeInfo();
+    image.width = scaledSize(layout.width, scaleDenom);
+    image.height = scaledSize(layout.height, scaleDenom);
+    image.pixels.resize(static_cast<size_t>(image.width) * image.height * 4);
+
+    if (path == JpegPath::Auto && threadCount == 1)
+        path = JpegPath::Serial;
+    else if (path == JpegPath::Auto)
+        path = canSplitAtRestarts(layout) ? JpegPath::RestartSegments : JpegPath::ParallelIdct;
+    if (path == JpegPath::RestartSegments && canSplitAtRestarts(layout) &&
+        decodeRestartSegments(file.data(), layout, scaleDenom, threadCount, image, info))
+        return true;
+    if (path != JpegPath::Serial && decodeParallelIdct(file.data(), file.size(), scaleDenom, threadCount, colors, image, info))
+        return true;
+    info.path = JpegPath::Serial;
+    info.tasks = 1;
+    return decodeJpegStream(file.data(), file.size(), scaleDenom, 0, image.pixels.data(), static_cast<size_t>(image.width) * 4, image.height, &info.warnings);
+}
+
+bool readFile(const std::string& path, std::vector<uint8_t>& bytes) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    in.seekg(0, std::ios::end);
+    bytes.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0, std::ios::beg);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(bytes.data()), bytes.size()));
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Best time of benchmarkRuns calls
+template <typename Decode>
+double bestMilliseconds(const Decode& decode) {
+    double best = 1e30;
+    for (int run = 0; run < benchmarkRuns; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        if (!decode())
+            return -1.0;
+        best = std::min(best, millisecondsSince(start));
+    }
+    return best;
+}
+
+void runBenchmark(const std::vector<std::string>& paths) {
+    int threadCount = resolveThreadCount();
+    std::vector<const ColorKernels*> kernelSets = supportedColorKernels();
+    const ColorKernels& colors = *kernelSets.back();
+    printf("%d threads, colour kernels: %s; MP/s of source pixels, best of %d runs\n", threadCount, colors.name, benchmarkRuns);
+
+    for (const std::string& path : paths) {
+        std::vector<uint8_t> file;
+        JpegLayout layout;
+        if (!readFile(path, file) || !parseJpegLayout(file.data(), file.size(), layout)) {
+            std::cerr << "Failed to read JPEG " << path << std::endl;
+            continue;
+        }
+        double megapixels = static_cast<double>(layout.width) * layout.height / 1e6;
+        printf("\n%s: %d x %d, restart interval %d, %zu restart markers%s\n", path.c_str(), layout.width, layout.height,
+               layout.restartInterval, layout.restartMarkers.size(), canSplitAtRestarts(layout) ? "" : " (not splittable)");
+        printf("  %-18s %12s %12s %12s %12s\n", "decoder", "1/1", "1/2", "1/4", "1/8");
+
+        // stb has no scaled decode: every pyramid level costs a full decode
+        double stbMs = bestMilliseconds([&]() {
+            int width, height, channels;
+            unsigned char* pixels = stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &channels, STBI_rgb_alpha);
+            stbi_image_free(pixels);
+            return pixels != nullptr;
+        });
+        printf("  %-18s %12.1f %12s %12s %12s\n", "stb_image", stbMs > 0 ? megapixels * 1000.0 / stbMs : 0.0, "-", "-", "-");
+
+        const JpegPath decodePaths[] = { JpegPath::Serial, JpegPath::RestartSegments, JpegPath::ParallelIdct };
+        for (JpegPath decodePath : decodePaths) {
+            if (decodePath == JpegPath::RestartSegments && !canSplitAtRestarts(layout))
+                continue;
+            printf("  %-18s", jpegPathName(decodePath));
+            for (int scaleDenom : scaleDenominators) {
+                RgbaImage image;
+                JpegDecodeInfo info;
+                double ms = bestMilliseconds([&]() {
+                    return decodeJpeg(file, decodePath, scaleDenom, threadCount, colors, image, info) && info.path == decodePath;
+                });
+                if (ms > 0)
+                    printf(" %12.1f", megapixels * 1000.0 / ms);
+                else
+                    printf(" %12s", "-");
+            }
+            printf("\n");
+        }
+
+        JpegDecodeInfo info;
+        RgbaImage image;
+        if (decodeJpeg(file, JpegPath::ParallelIdct, 1, threadCount, colors, image, info))
+            printf("  parallel IDCT: entropy decoding %.1f ms of the total, %d MCU rows\n", info.entropyMs, info.tasks);
+    }
+
+    // Colour conversion alone, one 4096 pixel row at a time over 16 MP
+    const size_t rowPixels = 4096, rowCount = 4096;
+    std::vector<uint8_t> luma(rowPixels), blue(rowPixels), red(rowPixels), rgba(rowPixels * 4);
+    for (size_t i = 0; i < rowPixels; ++i) {
+        luma[i] = static_cast<uint8_t>(i * 7);
+        blue[i] = static_cast<uint8_t>(i * 13 + 5);
+        red[i] = static_cast<uint8_t>(i * 29 + 11);
+    }
+    printf("\nYCbCr -> RGBA, one thread:");
+    for (const ColorKernels* kernels : kernelSets) {
+        double ms = bestMilliseconds([&]() {
+            for (size_t row = 0; row < rowCount; ++row)
+                kernels->ycbcrToRgba(luma.data(), blue.data(), red.data(), rgba.data(), rowPixels);
+            return true;
+        });
+        printf(" %s %.0f MP/s", kernels->name, rowPixels * rowCount / 1e3 / ms);
+    }
+    printf("\n");
+}
+
+class Camera {
+public:
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f;  // Adjusted sensitivity
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+};
+
+class Texture {
+public:
+    // Vertex Shader Source
+    const char* vertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTex;
+
+out vec2 texCoord;
+
+uniform mat4 model;
+
+void main()
+{
+    gl_Position = model * vec4(aPos, 0.0, 1.0);
+    texCoord = aTex;
+}
+)";
+
+    // Fragment Shader Source
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+    GLuint shaderProgram;
+    GLint modelLoc;
+    GLuint VAO, VBO;
+    GLuint textureID = 0;
+    Camera* m_camera = nullptr;
+
+    void init(Camera* camera) {
+        m_camera = camera;
+        shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+        modelLoc = glGetUniformLocation(shaderProgram, "model");
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, 16 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    // Decoded images are top-down RGBA at any scale
+    void upload(const RgbaImage& image) {
+        float aspectRatio = static_cast<float>(image.width) / image.height;
+        float vertices[] = {
+            // Positions            // Texture Coords
+            -1.0f, -1.0f / aspectRatio,  0.0f, 1.0f,
+             1.0f, -1.0f / aspectRatio,  1.0f, 1.0f,
+            -1.0f,  1.0f / aspectRatio,  0.0f, 0.0f,
+             1.0f,  1.0f / aspectRatio,  1.0f, 0.0f
+        };
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    // Function to compile shaders
+    GLuint compileShader(GLenum type, const char* source) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        GLint success;
+        GLchar infoLog[512];
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+            std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+        }
+        return shader;
+    }
+
+    // Function to create shader program
+    GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource) {
+        GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+        GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, fragmentShader);
+        glLinkProgram(program);
+
+        GLint success;
+        GLchar infoLog[512];
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(program, 512, nullptr, infoLog);
+            std::cerr << "Program Linking Error: " << infoLog << std::endl;
+        }
+
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        return program;
+    }
+
+    void render() {
+        glUseProgram(shaderProgram);
+        glm::mat4 model = m_camera->getTransform();
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+
+        glBindVertexArray(VAO);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteProgram(shaderProgram);
+        glDeleteTextures(1, &textureID);
+    }
+};
+
+int main(int argc, char** argv) {
+    std::vector<std::string> imagePaths(std::begin(sampleImagePaths), std::end(sampleImagePaths));
+    bool benchmark = argc > 1 && std::string(argv[1]) == "--benchmark";
+    int firstPath = benchmark ? 2 : 1;
+    if (argc > firstPath)
+        imagePaths.assign(argv + firstPath, argv + argc);
+    if (benchmark) {
+        runBenchmark(imagePaths);
+        return 0;
+    }
+
+    int threadCount = resolveThreadCount();
+    const ColorKernels& colors = *supportedColorKernels().back();
+    printf("Decoder threads: %d, colour kernels: %s\n", threadCount, colors.name);
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    Camera camera;
+    Texture texture;
+    texture.init(&camera);
+
+    const JpegPath decodePaths[] = { JpegPath::Auto, JpegPath::RestartSegments, JpegPath::ParallelIdct, JpegPath::Serial };
+    const int scaleKeys[] = { GLFW_KEY_1, GLFW_KEY_2, GLFW_KEY_3, GLFW_KEY_4 };
+    std::vector<uint8_t> file;
+    size_t imageIndex = 0;
+    int pathIndex = 0;
+    int scaleIndex = 0;
+    bool reloadFile = true;
+    bool redecode = true;
+    bool nextKeyDown = false;
+    bool pathKeyDown = false;
+    double stbMs = 0.0;
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        const std::string& path = imagePaths[imageIndex];
+        if (reloadFile) {
+            if (!readFile(path, file))
+                std::cerr << "Failed to read " << path << std::endl;
+            auto start = std::chrono::steady_clock::now();
+            int width, height, channels;
+            unsigned char* pixels = stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &channels, STBI_rgb_alpha);
+            stbMs = millisecondsSince(start);
+            stbi_image_free(pixels);
+            reloadFile = false;
+            redecode = true;
+        }
+        if (redecode) {
+            RgbaImage image;
+            JpegDecodeInfo info;
+            auto start = std::chrono::steady_clock::now();
+            bool ok = decodeJpeg(file, decodePaths[pathIndex], scaleDenominators[scaleIndex], threadCount, colors, image, info);
+            double decodeMs = millisecondsSince(start);
+            if (ok) {
+                texture.upload(image);
+                char title[200];
+                snprintf(title, sizeof(title), "OpenGL - %s 1/%d, %d x %d, %s (%d tasks): %.1f ms, stb full decode %.1f ms",
+                         path.c_str(), scaleDenominators[scaleIndex], image.width, image.height, jpegPathName(info.path),
+                         info.tasks, decodeMs, stbMs);
+                glfwSetWindowTitle(window, title);
+                printf("%s\n", title + 9);
+            } else {
+                std::cerr << "Failed to decode " << path << std::endl;
+            }
+            redecode = false;
+        }
+
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool nextKeyPressed = glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS;
+        if (nextKeyPressed && !nextKeyDown) {
+            imageIndex = (imageIndex + 1) % imagePaths.size();
+            reloadFile = true;
+        }
+        nextKeyDown = nextKeyPressed;
+
+        bool pathKeyPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+        if (pathKeyPressed && !pathKeyDown) {
+            pathIndex = (pathIndex + 1) % 4;
+            redecode = true;
+        }
+        pathKeyDown = pathKeyPressed;
+
+        for (int i = 0; i < 4; ++i) {
+            if (glfwGetKey(window, scaleKeys[i]) == GLFW_PRESS && scaleIndex != i) {
+                scaleIndex = i;
+                redecode = true;
+            }
+        }
+
+        texture.render();
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    texture.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
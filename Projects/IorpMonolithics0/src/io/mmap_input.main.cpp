@@ -0,0 +1,701 @@
+// memory-mapped input for stb_image and libtiff
+// Source files are mapped read-only instead of being read through stdio: stb decodes straight from the
+// mapping with stbi_load_from_memory, and libtiff reads through TIFFClientOpen with read/seek/map procs over
+// the same view (so uncompressed strips are copied once, from the page cache to the image). The kernel
+// does the I/O with read-ahead, reopening a file that is still cached costs no I/O at all, and a
+// MappingCache hands the same mapping to every decoder thread that asks for the file. Multi-strip TIFFs are
+// decoded by several threads at once, each with its own TIFF handle over the shared mapping.
+// Usage: mmap_input [image ...]     viewer; N cycles the images, the title compares stdio and mapped decode
+//        mmap_input --benchmark     per-file and multi-threaded decode times, stdio vs mapped
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <filesystem>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <tiffio.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+// Sample images cycled with N
+const char* sampleImagePaths[] = {
+    "src/textures/assets/test_nb.png",
+    "src/textures/assets/test.jpg",
+    "src/textures/assets/test.tif",
+};
+
+// Decoder threads: strip-parallel TIFF decode and the multi-threaded benchmark
+const int decoderThreadCount = 4;
+
+// Benchmark repetitions per file
+const int benchmarkRuns = 10;
+
+// Read-only view of a whole file. Pages are faulted in by the kernel on first touch (with sequential
+// read-ahead requested); the view may be read by any number of threads at once.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+            close();
+            return false;
+        }
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping) {
+            close();
+            return false;
+        }
+        m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!m_data) {
+            close();
+            return false;
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+#if _WIN32_WINNT >= 0x0602
+        // Windows 8+: start reading the whole view in the background
+        WIN32_MEMORY_RANGE_ENTRY range = { const_cast<unsigned char*>(m_data), m_size };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);   // the mapping keeps the file referenced
+        if (data == MAP_FAILED)
+            return false;
+        m_data = static_cast<const unsigned char*>(data);
+        m_size = static_cast<size_t>(info.st_size);
+        // Decoders walk the file front to back: read ahead aggressively and start now
+        madvise(data, m_size, MADV_SEQUENTIAL);
+        madvise(data, m_size, MADV_WILLNEED);
+#endif
+        m_path = path;
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = INVALID_HANDLE_VALUE;
+#else
+        if (m_data)
+            munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    const unsigned char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    const std::string& path() const { return m_path; }
+
+private:
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+    std::string m_path;
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#endif
+};
+
+// One mapping per file, shared by every thread that opens it while it is alive
+class MappingCache {
+public:
+    std::shared_ptr<const MappedFile> open(const std::string& path) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::weak_ptr<const MappedFile>& slot = m_files[path];
+        if (std::shared_ptr<const MappedFile> file = slot.lock()) {
+            ++m_shared;
+            return file;
+        }
+        std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+        if (!file->open(path))
+            return nullptr;
+        slot = file;
+        ++m_mapped;
+        return file;
+    }
+
+    int getMapped() const { return m_mapped; }
+    int getShared() const { return m_shared; }
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::weak_ptr<const MappedFile>> m_files;
+    std::atomic<int> m_mapped{ 0 };   // mappings created
+    std::atomic<int> m_shared{ 0 };   // opens served by an existing mapping
+};
+
+// libtiff client procs over a mapping; each TIFF handle has its own position, the bytes are shared
+struct TiffMemoryStream {
+    const MappedFile* file = nullptr;
+    toff_t position = 0;
+};
+
+tmsize_t tiffMemoryRead(thandle_t handle, void* buffer, tmsize_t size) {
+    TiffMemoryStream* stream = static_cast<TiffMemoryStream*>(handle);
+    toff_t available = stream->position < stream->file->size() ? stream->file->size() - stream->position : 0;
+    toff_t count = std::min<toff_t>(static_cast<toff_t>(size), available);
+    memcpy(buffer, stream->file->data() + stream->position, static_cast<size_t>(count));
+    stream->position += count;
+    return static_cast<tmsize_t>(count);
+}
+
+tmsize_t tiffMemoryWrite(thandle_t, void*, tmsize_t) {
+    return 0;   // read-only
+}
+
+toff_t tiffMemorySeek(thandle_t handle, toff_t offset, int whence) {
+    TiffMemoryStream* stream = static_cast<TiffMemoryStream*>(handle);
+    if (whence == SEEK_CUR)
+        offset += stream->position;
+    else if (whence == SEEK_END)
+        offset += stream->file->size();
+    stream->position = offset;
+    return offset;
+}
+
+int tiffMemoryClose(thandle_t) {
+    return 0;   // the mapping outlives the handle
+}
+
+toff_t tiffMemorySize(thandle_t handle) {
+    return static_cast<TiffMemoryStream*>(handle)->file->size();
+}
+
+// Lets libtiff address strips in place instead of reading them through tiffMemoryRead
+int tiffMemoryMap(thandle_t handle, void** base, toff_t* size) {
+    TiffMemoryStream* stream = static_cast<TiffMemoryStream*>(handle);
+    *base = const_cast<unsigned char*>(stream->file->data());
+    *size = stream->file->size();
+    return 1;
+}
+
+void tiffMemoryUnmap(thandle_t, void*, toff_t) {
+}
+
+TIFF* openMappedTiff(const MappedFile& file, TiffMemoryStream& stream) {
+    stream.file = &file;
+    stream.position = 0;
+    return TIFFClientOpen(file.path().c_str(), "r", &stream, tiffMemoryRead, tiffMemoryWrite, tiffMemorySeek,
+                          tiffMemoryClose, tiffMemorySize, tiffMemoryMap, tiffMemoryUnmap);
+}
+
+// Decoded image: 8-bit RGBA, row 0 at the top
+struct RgbaImage {
+    int width = 0, height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+bool isTiffPath(const std::string& path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".tif" || extension == ".tiff";
+}
+
+bool decodeStbMapped(const MappedFile& file, RgbaImage& image) {
+    int nrChannels;
+    unsigned char* data = stbi_load_from_memory(file.data(), static_cast<int>(file.size()),
+                                                &image.width, &image.height, &nrChannels, STBI_rgb_alpha);
+    if (!data)
+        return false;
+    image.pixels.assign(data, data + static_cast<size_t>(image.width) * image.height * 4);
+    stbi_image_free(data);
+    return true;
+}
+
+// Contiguous 8-bit RGB(A) TIFFs with several strips are split across threads by strip; each thread opens its
+// own handle over the shared mapping. Everything else goes through libtiff's RGBA interface on one thread.
+bool decodeTiffMapped(const MappedFile& file, RgbaImage& image, int threadCount) {
+    TiffMemoryStream stream;
+    TIFF* tif = openMappedTiff(file, stream);
+    if (!tif)
+        return false;
+
+    uint32_t width = 0, height = 0, rowsPerStrip = 0;
+    uint16_t bitsPerSample = 8, samplesPerPixel = 1, planarConfig = PLANARCONFIG_CONTIG, photometric = 0;
+    TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+    TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bitsPerSample);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_PLANARCONFIG, &planarConfig);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
+    TIFFGetField(tif, TIFFTAG_PHOTOMETRIC, &photometric);
+    image.width = static_cast<int>(width);
+    image.height = static_cast<int>(height);
+    image.pixels.resize(static_cast<size_t>(width) * height * 4);
+
+    tstrip_t stripCount = TIFFIsTiled(tif) ? 0 : TIFFNumberOfStrips(tif);
+    bool stripParallel = photometric == PHOTOMETRIC_RGB && planarConfig == PLANARCONFIG_CONTIG && bitsPerSample == 8 &&
+                         (samplesPerPixel == 3 || samplesPerPixel == 4) && stripCount > 1 && threadCount > 1;
+    if (!stripParallel) {
+        bool ok = TIFFReadRGBAImageOriented(tif, width, height, reinterpret_cast<uint32_t*>(image.pixels.data()), ORIENTATION_TOPLEFT, 0) != 0;
+        TIFFClose(tif);
+        return ok;
+    }
+
+    // Alpha as libtiff's RGBA interface delivers it, so both paths give the same pixels: unassociated alpha is
+    // premultiplied into the colour, any other fourth sample is taken as associated alpha and copied
+    uint16_t extraCount = 0;
+    uint16_t* extraTypes = nullptr;
+    TIFFGetFieldDefaulted(tif, TIFFTAG_EXTRASAMPLES, &extraCount, &extraTypes);
+    bool hasAlpha = samplesPerPixel == 4;
+    bool premultiply = hasAlpha && extraCount > 0 && extraTypes[0] == EXTRASAMPLE_UNASSALPHA;
+    TIFFClose(tif);
+
+    std::atomic<bool> ok{ true };
+    auto decodeStrips = [&](int thread) {
+        TiffMemoryStream threadStream;
+        TIFF* threadTif = openMappedTiff(file, threadStream);
+        if (!threadTif) {
+            ok = false;
+            return;
+        }
+        std::vector<uint8_t> strip(static_cast<size_t>(TIFFStripSize(threadTif)));
+        for (tstrip_t s = static_cast<tstrip_t>(thread); s < stripCount; s += static_cast<tstrip_t>(threadCount)) {
+            if (TIFFReadEncodedStrip(threadTif, s, strip.data(), static_cast<tmsize_t>(strip.size())) < 0) {
+                ok = false;
+                break;
+            }
+            uint32_t row0 = s * rowsPerStrip;
+            uint32_t rows = std::min(rowsPerStrip, height - row0);
+            const uint8_t* src = strip.data();
+            uint8_t* dst = image.pixels.data() + static_cast<size_t>(row0) * width * 4;
+            for (size_t i = 0; i < static_cast<size_t>(rows) * width; ++i, src += samplesPerPixel, dst += 4) {
+                uint8_t alpha = hasAlpha ? src[3] : 255;
+                if (premultiply) {
+                    // Same rounding as libtiff's unassociated-to-associated table
+                    dst[0] = static_cast<uint8_t>((src[0] * alpha + 127) / 255);
+                    dst[1] = static_cast<uint8_t>((src[1] * alpha + 127) / 255);
+                    dst[2] = static_cast<uint8_t>((src[2] * alpha + 127) / 255);
+                } else {
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                }
+                dst[3] = alpha;
+            }
+        }
+        TIFFClose(threadTif);
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+        threads.emplace_back(decodeStrips, t);
+    for (std::thread& thread : threads)
+        thread.join();
+    return ok;
+}
+
+bool decodeMapped(const MappedFile& file, RgbaImage& image, int threadCount) {
+    return isTiffPath(file.path()) ? decodeTiffMapped(file, image, threadCount) : decodeStbMapped(file, image);
+}
+
+// Baseline: the loaders as they were, reading through stdio
+bool decodeStdio(const std::string& path, RgbaImage& image) {
+    if (isTiffPath(path)) {
+        TIFF* tif = TIFFOpen(path.c_str(), "r");
+        if (!tif)
+            return false;
+        uint32_t width = 0, height = 0;
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+        image.width = static_cast<int>(width);
+        image.height = static_cast<int>(height);
+        image.pixels.resize(static_cast<size_t>(width) * height * 4);
+        bool ok = TIFFReadRGBAImageOriented(tif, width, height, reinterpret_cast<uint32_t*>(image.pixels.data()), ORIENTATION_TOPLEFT, 0) != 0;
+        TIFFClose(tif);
+        return ok;
+    }
+    int nrChannels;
+    unsigned char* data = stbi_load(path.c_str(), &image.width, &image.height, &nrChannels, STBI_rgb_alpha);
+    if (!data)
+        return false;
+    image.pixels.assign(data, data + static_cast<size_t>(image.width) * image.height * 4);
+    stbi_image_free(data);
+    return true;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void runBenchmark(const std::vector<std::string>& paths) {
+    MappingCache mappings;
+    // stdio and "mapped" both decode on one thread, so their difference is the mapping alone; the last column
+    // adds strip-parallel decoding of multi-strip TIFFs on top of the mapping
+    printf("Per file, average of %d decodes (ms):\n", benchmarkRuns);
+    std::string parallelColumn = "mapped x" + std::to_string(decoderThreadCount);
+    printf("  %-40s %10s %10s %12s\n", "file", "stdio", "mapped", parallelColumn.c_str());
+    for (const std::string& path : paths) {
+        RgbaImage image;
+        auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < benchmarkRuns; ++run)
+            decodeStdio(path, image);
+        double stdioMs = millisecondsSince(start) / benchmarkRuns;
+
+        auto timeMapped = [&](int threadCount) {
+            auto mappedStart = std::chrono::steady_clock::now();
+            for (int run = 0; run < benchmarkRuns; ++run) {
+                std::shared_ptr<const MappedFile> file = mappings.open(path);
+                if (file)
+                    decodeMapped(*file, image, threadCount);
+            }
+            return millisecondsSince(mappedStart) / benchmarkRuns;
+        };
+        double mappedMs = timeMapped(1);
+        double parallelMs = timeMapped(decoderThreadCount);
+        printf("  %-40s %10.2f %10.2f %12.2f\n", path.c_str(), stdioMs, mappedMs, parallelMs);
+    }
+
+    // Every thread decodes every file; with mappings the threads share one view per file
+    auto runThreads = [&](bool mapped) {
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < decoderThreadCount; ++t) {
+            threads.emplace_back([&]() {
+                RgbaImage image;
+                for (int run = 0; run < benchmarkRuns; ++run) {
+                    for (const std::string& path : paths) {
+                        if (!mapped) {
+                            decodeStdio(path, image);
+                        } else if (std::shared_ptr<const MappedFile> file = mappings.open(path)) {
+                            decodeMapped(*file, image, 1);
+                        }
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+        return millisecondsSince(start);
+    };
+    double stdioMs = runThreads(false);
+    double mappedMs = runThreads(true);
+    printf("%d threads x %d runs x %zu files: stdio %.1f ms, mapped %.1f ms\n",
+           decoderThreadCount, benchmarkRuns, paths.size(), stdioMs, mappedMs);
+    printf("Mappings created: %d, opens served by an existing mapping: %d\n", mappings.getMapped(), mappings.getShared());
+}
+
+class Camera {
+public:
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f;  // Adjusted sensitivity
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+};
+
+class Texture {
+public:
+    // Vertex Shader Source
+    const char* vertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTex;
+
+out vec2 texCoord;
+
+uniform mat4 model;
+
+void main()
+{
+    gl_Position = model * vec4(aPos, 0.0, 1.0);
+    texCoord = aTex;
+}
+)";
+
+    // Fragment Shader Source
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+    GLuint shaderProgram;
+    GLint modelLoc;
+    GLuint VAO, VBO;
+    GLuint textureID = 0;
+    Camera* m_camera = nullptr;
+
+    void init(Camera* camera) {
+        m_camera = camera;
+        shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+        modelLoc = glGetUniformLocation(shaderProgram, "model");
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, 16 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    // Every loader delivers top-down rows, so all formats share the same texture coordinates
+    void upload(const RgbaImage& image) {
+        float aspectRatio = static_cast<float>(image.width) / image.height;
+        float vertices[] = {
+            // Positions            // Texture Coords
+            -1.0f, -1.0f / aspectRatio,  0.0f, 1.0f,
+             1.0f, -1.0f / aspectRatio,  1.0f, 1.0f,
+            -1.0f,  1.0f / aspectRatio,  0.0f, 0.0f,
+             1.0f,  1.0f / aspectRatio,  1.0f, 0.0f
+        };
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    // Function to compile shaders
+    GLuint compileShader(GLenum type, const char* source) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        GLint success;
+        GLchar infoLog[512];
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+            std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+        }
+        return shader;
+    }
+
+    // Function to create shader program
+    GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource) {
+        GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+        GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, fragmentShader);
+        glLinkProgram(program);
+
+        GLint success;
+        GLchar infoLog[512];
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(program, 512, nullptr, infoLog);
+            std::cerr << "Program Linking Error: " << infoLog << std::endl;
+        }
+
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        return program;
+    }
+
+    void render() {
+        glUseProgram(shaderProgram);
+        glm::mat4 model = m_camera->getTransform();
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+
+        glBindVertexArray(VAO);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteProgram(shaderProgram);
+        glDeleteTextures(1, &textureID);
+    }
+};
+
+int main(int argc, char** argv) {
+    std::vector<std::string> imagePaths(std::begin(sampleImagePaths), std::end(sampleImagePaths));
+    bool benchmark = argc > 1 && std::string(argv[1]) == "--benchmark";
+    int firstPath = benchmark ? 2 : 1;
+    if (argc > firstPath)
+        imagePaths.assign(argv + firstPath, argv + argc);
+    if (benchmark) {
+        runBenchmark(imagePaths);
+        return 0;
+    }
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    Camera camera;
+    Texture texture;
+    texture.init(&camera);
+
+    MappingCache mappings;
+    std::shared_ptr<const MappedFile> currentFile;
+    size_t imageIndex = 0;
+    bool reload = true;
+    bool nextKeyDown = false;
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        if (reload) {
+            const std::string& path = imagePaths[imageIndex];
+            RgbaImage stdioImage, image;
+            auto start = std::chrono::steady_clock::now();
+            bool stdioOk = decodeStdio(path, stdioImage);
+            double stdioMs = millisecondsSince(start);
+
+            start = std::chrono::steady_clock::now();
+            currentFile = mappings.open(path);
+            bool ok = currentFile && decodeMapped(*currentFile, image, decoderThreadCount);
+            double mappedMs = millisecondsSince(start);
+
+            if (ok) {
+                texture.upload(image);
+                char title[200];
+                snprintf(title, sizeof(title), "OpenGL - %s, %d x %d, decode: stdio %.1f ms%s, mapped x%d %.1f ms",
+                         path.c_str(), image.width, image.height, stdioMs, stdioOk ? "" : " (failed)", decoderThreadCount, mappedMs);
+                glfwSetWindowTitle(window, title);
+                printf("%s\n", title + 9);
+            } else {
+                std::cerr << "Failed to load texture " << path << std::endl;
+            }
+            reload = false;
+        }
+
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool nextKeyPressed = glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS;
+        if (nextKeyPressed && !nextKeyDown) {
+            imageIndex = (imageIndex + 1) % imagePaths.size();
+            reload = true;
+        }
+        nextKeyDown = nextKeyPressed;
+
+        texture.render();
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    texture.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,1188 @@
+// layer stack: several rasters on one tile grid, composited in a single pass per tile
+// Every layer is a tile pyramid of its own, but all of them share the first layer's grid (the others are
+// resampled to its size on load) and therefore one LOD selection and one tile walk:
+//   - the prefetcher walks the visible cells once and requests each cell for every visible layer
+//   - the renderer draws each cell once; its fragment shader samples one tile texture per layer (up to
+//     maxLayers, one texture unit each) and blends them bottom to top with per-layer opacity and blend mode
+//     (Normal, Multiply, Screen, Overlay, Add, Difference), so N layers cost neither N passes over the
+//     screen nor N draws per tile
+//   - a layer missing its tile borrows the matching part of its nearest resident ancestor, per layer
+//   - layers beneath an opaque Normal layer at full opacity are not sampled at all
+// The "Layer Visibility" panel (ImGui) toggles, fades, reorders and sets the blend mode of each layer.
+// Usage: layer_composite [image ...]   Keys: WASD pan, Q/E zoom, Z zoom sweep, P prefetch, 1-8 toggle layers.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <imgui.h>
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_opengl3.h>
+
+#include <cstdio> // Include for printf
+
+const int tileSize = 128;
+
+// Level of Detail (LOD) bias, typically in the range -0.5 to 0.5
+float lodBias = 0.0f;
+
+// Loader configuration: worker count and an artificial per-tile cost standing in for a slow decoder/disk
+const int loaderThreadCount = 2;
+const int simulatedDecodeMs = 15;
+
+// Layers a composite draw can sample (the shader's MAX_LAYERS)
+const int maxLayers = 8;
+
+// GPU tile cache budget (tiles, all layers together) and upload throttle (tiles per frame)
+const size_t gpuTileBudget = 512;
+const int maxUploadsPerFrame = 8;
+
+// Prediction: how far ahead the camera path is extrapolated, and the sampling step along it (seconds)
+const float predictionHorizon = 0.6f;
+const float predictionStep = 0.1f;
+// Time constant of the velocity smoothing (seconds)
+const float velocitySmoothing = 0.15f;
+// Zoom rates below this (ln(scale) per second) are treated as "not zooming"
+const float zoomRateThreshold = 0.05f;
+
+// Priority weights: seconds-equivalent cost of one level away from the current LOD / of one half view extent
+const float levelWeight = 0.5f;
+const float distanceWeight = 0.1f;
+
+// Z key: zoom in by this many levels over this many frames
+const int zoomSweepLevels = 5;
+const int zoomSweepFrames = 30;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+// Identifies one tile of one layer
+struct TileKey {
+    int layer = 0, level = 0, x = 0, y = 0;
+
+    uint64_t packed() const {
+        return (static_cast<uint64_t>(layer) << 56) | (static_cast<uint64_t>(level) << 48) |
+               (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+    }
+    TileKey parent() const {
+        TileKey p;
+        p.layer = layer;
+        p.level = level + 1;
+        p.x = x / 2;
+        p.y = y / 2;
+        return p;
+    }
+};
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f), velocity(0.0f, 0.0f), zoomRate(0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    void zoomBy(float factor) {
+        scale *= factor;
+    }
+
+    // Measures how fast offset and scale changed since the last call, smoothed exponentially
+    void updateMotion(double now) {
+        if (lastTime < 0.0) {
+            lastTime = now;
+            lastOffset = offset;
+            lastScale = scale;
+            return;
+        }
+        float dt = static_cast<float>(now - lastTime);
+        if (dt <= 0.0f)
+            return;
+
+        glm::vec2 instantVelocity = (offset - lastOffset) / dt;
+        float instantZoomRate = std::log(scale / lastScale) / dt;
+        float alpha = 1.0f - std::exp(-dt / velocitySmoothing);
+        velocity += (instantVelocity - velocity) * alpha;
+        zoomRate += (instantZoomRate - zoomRate) * alpha;
+
+        lastTime = now;
+        lastOffset = offset;
+        lastScale = scale;
+    }
+
+    // Camera extrapolated t seconds ahead along the current pan/zoom motion
+    Camera predicted(float t) const {
+        Camera c = *this;
+        c.offset = offset + velocity * t;
+        c.scale = scale * std::exp(zoomRate * t);
+        return c;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    glm::vec2 getCenter() const { return -offset; }
+    float getScale() const { return scale; }
+    float getZoomRate() const { return zoomRate; }
+    glm::vec2 getVelocity() const { return velocity; }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    glm::vec2 velocity;   // world units per second (of offset)
+    float zoomRate;       // d ln(scale) / dt
+    double lastTime = -1.0;
+    glm::vec2 lastOffset;
+    float lastScale = 1.0f;
+    GLuint ubo = 0;
+};
+
+// Full-resolution image plus its reduced levels, cut into tiles on demand.
+// Given a grid size, the image is first resampled to it so its tiles line up with the other layers'.
+// World mapping keeps the aspect ratio: x spans [-1, 1], y spans [-h/w, h/w], row 0 at the top.
+class TilePyramid {
+public:
+    bool load(const std::string& imagePath, int gridWidth = 0, int gridHeight = 0) {
+        int width, height, nrChannels;
+        unsigned char* data = stbi_load(imagePath.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha);
+        if (!data) {
+            std::cerr << "Failed to load texture" << std::endl;
+            return false;
+        }
+
+        Level base;
+        base.width = width;
+        base.height = height;
+        base.pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(data);
+        if (gridWidth > 0 && (gridWidth != width || gridHeight != height)) {
+            printf("%s: resampled from %d x %d\n", imagePath.c_str(), width, height);
+            base = resample(base, gridWidth, gridHeight);
+        }
+        m_levels.push_back(std::move(base));
+
+        // Halve until the whole level fits in one tile
+        while (m_levels.back().width > tileSize || m_levels.back().height > tileSize)
+            m_levels.push_back(downsample(m_levels.back()));
+
+        printf("Image size: %d x %d, levels: %d, tile size: %d\n", levelWidth(0), levelHeight(0), levelCount(), tileSize);
+        for (int level = 0; level < levelCount(); ++level)
+            printf("  level %d: %d x %d, %d x %d tiles\n", level, levelWidth(level), levelHeight(level), tilesX(level), tilesY(level));
+        return true;
+    }
+
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    int levelWidth(int level) const { return m_levels[level].width; }
+    int levelHeight(int level) const { return m_levels[level].height; }
+    int tilesX(int level) const { return (levelWidth(level) + tileSize - 1) / tileSize; }
+    int tilesY(int level) const { return (levelHeight(level) + tileSize - 1) / tileSize; }
+
+    bool isValid(const TileKey& key) const {
+        return key.level >= 0 && key.level < levelCount() &&
+               key.x >= 0 && key.x < tilesX(key.level) && key.y >= 0 && key.y < tilesY(key.level);
+    }
+
+    // Copies one tile out of its level; stands in for a real tile decoder (thread-safe, read-only)
+    void readTile(const TileKey& key, std::vector<unsigned char>& pixels, int& width, int& height) const {
+        const Level& level = m_levels[key.level];
+        width = std::min(tileSize, level.width - key.x * tileSize);
+        height = std::min(tileSize, level.height - key.y * tileSize);
+        pixels.resize(static_cast<size_t>(width) * height * 4);
+        for (int row = 0; row < height; ++row) {
+            const unsigned char* src = level.pixels.data() +
+                ((static_cast<size_t>(key.y) * tileSize + row) * level.width + static_cast<size_t>(key.x) * tileSize) * 4;
+            memcpy(pixels.data() + static_cast<size_t>(row) * width * 4, src, static_cast<size_t>(width) * 4);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(simulatedDecodeMs));
+    }
+
+    // World units per level-0 pixel
+    float worldPerPixel() const { return 2.0f / m_levels[0].width; }
+
+    // World-space rectangle of a tile (min.x, min.y, max.x, max.y)
+    glm::vec4 tileRect(const TileKey& key) const {
+        int width0 = m_levels[0].width, height0 = m_levels[0].height;
+        int px0 = std::min(key.x * tileSize << key.level, width0);
+        int py0 = std::min(key.y * tileSize << key.level, height0);
+        int px1 = std::min((key.x + 1) * tileSize << key.level, width0);
+        int py1 = std::min((key.y + 1) * tileSize << key.level, height0);
+        float p = worldPerPixel();
+        float top = height0 * p * 0.5f;
+        return glm::vec4(px0 * p - 1.0f, top - py1 * p, px1 * p - 1.0f, top - py0 * p);
+    }
+
+    // Level whose texel density best matches the screen for this camera
+    int selectLevel(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        float texelsPerScreenPixel = 1.0f / (worldPerPixel() * screenPixelsPerWorld);
+        int level = static_cast<int>(std::floor(std::log2(std::max(texelsPerScreenPixel, 1e-6f)) + lodBias));
+        return std::max(0, std::min(level, levelCount() - 1));
+    }
+
+    // Continuous level (before flooring), used to predict level switches
+    float levelPosition(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        return std::log2(1.0f / (worldPerPixel() * screenPixelsPerWorld)) + lodBias;
+    }
+
+    // Range of tiles of a level that intersect a world rectangle; false if none
+    bool tileRange(int level, const glm::vec4& rect, int& x0, int& y0, int& x1, int& y1) const {
+        float p = worldPerPixel() * static_cast<float>(1 << level) * tileSize;  // world size of one tile
+        float top = m_levels[0].height * worldPerPixel() * 0.5f;
+        x0 = std::max(0, static_cast<int>(std::floor((rect.x + 1.0f) / p)));
+        x1 = std::min(tilesX(level) - 1, static_cast<int>(std::floor((rect.z + 1.0f) / p)));
+        y0 = std::max(0, static_cast<int>(std::floor((top - rect.w) / p)));
+        y1 = std::min(tilesY(level) - 1, static_cast<int>(std::floor((top - rect.y) / p)));
+        return x0 <= x1 && y0 <= y1;
+    }
+
+private:
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<unsigned char> pixels;
+    };
+    std::vector<Level> m_levels;
+
+    static Level downsample(const Level& src) {
+        Level dst;
+        dst.width = (src.width + 1) / 2;
+        dst.height = (src.height + 1) / 2;
+        dst.pixels.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+        for (int y = 0; y < dst.height; ++y) {
+            int sy0 = 2 * y, sy1 = std::min(2 * y + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x) {
+                int sx0 = 2 * x, sx1 = std::min(2 * x + 1, src.width - 1);
+                for (int c = 0; c < 4; ++c) {
+                    int sum = src.pixels[(static_cast<size_t>(sy0) * src.width + sx0) * 4 + c] +
+                              src.pixels[(static_cast<size_t>(sy0) * src.width + sx1) * 4 + c] +
+                              src.pixels[(static_cast<size_t>(sy1) * src.width + sx0) * 4 + c] +
+                              src.pixels[(static_cast<size_t>(sy1) * src.width + sx1) * 4 + c];
+                    dst.pixels[(static_cast<size_t>(y) * dst.width + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+        return dst;
+    }
+
+    // Bilinear, pixel centers aligned
+    static Level resample(const Level& src, int width, int height) {
+        Level dst;
+        dst.width = width;
+        dst.height = height;
+        dst.pixels.resize(static_cast<size_t>(width) * height * 4);
+        for (int y = 0; y < height; ++y) {
+            float sy = std::max(0.0f, (y + 0.5f) * src.height / height - 0.5f);
+            int y0 = std::min(static_cast<int>(sy), src.height - 1), y1 = std::min(y0 + 1, src.height - 1);
+            float fy = sy - y0;
+            for (int x = 0; x < width; ++x) {
+                float sx = std::max(0.0f, (x + 0.5f) * src.width / width - 0.5f);
+                int x0 = std::min(static_cast<int>(sx), src.width - 1), x1 = std::min(x0 + 1, src.width - 1);
+                float fx = sx - x0;
+                for (int c = 0; c < 4; ++c) {
+                    float top = src.pixels[(static_cast<size_t>(y0) * src.width + x0) * 4 + c] * (1.0f - fx) +
+                                src.pixels[(static_cast<size_t>(y0) * src.width + x1) * 4 + c] * fx;
+                    float bottom = src.pixels[(static_cast<size_t>(y1) * src.width + x0) * 4 + c] * (1.0f - fx) +
+                                   src.pixels[(static_cast<size_t>(y1) * src.width + x1) * 4 + c] * fx;
+                    dst.pixels[(static_cast<size_t>(y) * width + x) * 4 + c] =
+                        static_cast<unsigned char>(top * (1.0f - fy) + bottom * fy + 0.5f);
+                }
+            }
+        }
+        return dst;
+    }
+};
+
+// How a layer combines with the layers below it (separable blend modes of the W3C compositing spec)
+enum class BlendMode { Normal, Multiply, Screen, Overlay, Add, Difference };
+
+const char* blendModeNames[] = { "Normal", "Multiply", "Screen", "Overlay", "Add", "Difference" };
+const int blendModeCount = static_cast<int>(sizeof(blendModeNames) / sizeof(blendModeNames[0]));
+
+// One raster of the stack with its compositing settings
+struct Layer {
+    std::string name;
+    TilePyramid pyramid;
+    bool visible = true;
+    float opacity = 1.0f;
+    BlendMode blend = BlendMode::Normal;
+};
+
+// Rasters sharing one tile grid and one LOD selection: the first layer defines the grid, the others are
+// resampled to its size when loaded. TileKey::layer indexes m_layers; the drawing order is kept apart so the
+// panel can reorder layers without invalidating any cached tile.
+class LayerStack {
+public:
+    bool add(const std::string& path) {
+        if (layerCount() == maxLayers) {
+            std::cerr << "At most " << maxLayers << " layers, ignoring " << path << std::endl;
+            return false;
+        }
+        Layer layer;
+        layer.name = std::filesystem::path(path).filename().string();
+        int gridWidth = m_layers.empty() ? 0 : grid().levelWidth(0);
+        int gridHeight = m_layers.empty() ? 0 : grid().levelHeight(0);
+        if (!layer.pyramid.load(path, gridWidth, gridHeight))
+            return false;
+        // Everything above the base starts half transparent, so the stack is visible as a stack
+        if (!m_layers.empty())
+            layer.opacity = 0.5f;
+        m_order.push_back(layerCount());
+        m_layers.push_back(std::move(layer));
+        return true;
+    }
+
+    int layerCount() const { return static_cast<int>(m_layers.size()); }
+    Layer& layer(int index) { return m_layers[index]; }
+    const Layer& layer(int index) const { return m_layers[index]; }
+    const TilePyramid& grid() const { return m_layers[0].pyramid; }
+
+    // Layer indices bottom to top
+    const std::vector<int>& order() const { return m_order; }
+
+    // Swaps the layer at a drawing position with the one above it
+    void raise(int position) {
+        if (position + 1 < static_cast<int>(m_order.size()))
+            std::swap(m_order[position], m_order[position + 1]);
+    }
+
+    // Visible layers with any opacity, bottom to top
+    void collectVisible(std::vector<int>& visible) const {
+        visible.clear();
+        for (int index : m_order)
+            if (m_layers[index].visible && m_layers[index].opacity > 0.0f)
+                visible.push_back(index);
+    }
+
+private:
+    std::vector<Layer> m_layers;
+    std::vector<int> m_order;
+};
+
+// One tile wanted by the renderer or the prefetcher; lower priority values are served first
+struct TileRequest {
+    TileKey key;
+    float priority = 0.0f;
+};
+
+struct LoadedTile {
+    TileKey key;
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;
+    bool opaque = false;   // every alpha is 255
+};
+
+// Scheduler between the renderer and the decoders.
+// - Duplicates merge: a key requested several times in a frame, or again while pending or in flight, is
+//   one piece of work that keeps the best priority it was given.
+// - Ordering: pending work is kept sorted by priority, workers always take the most urgent tile.
+// - Cancellation: every frame submits the complete set of tiles it still wants; pending requests missing
+//   from that set are dropped before any decoder picks them up.
+class TileRequestQueue {
+public:
+    struct Stats {
+        long long submitted = 0;   // requests received, duplicates included
+        long long merged = 0;      // requests folded into an existing entry
+        long long cancelled = 0;   // pending requests dropped as no longer wanted
+        long long started = 0;     // requests handed to a decoder
+    };
+
+    // Replaces the wanted set for this frame (requests may contain duplicates)
+    void submitFrame(const std::vector<TileRequest>& requests) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+
+        for (const TileRequest& request : requests) {
+            ++m_stats.submitted;
+            uint64_t id = request.key.packed();
+            auto it = m_entries.find(id);
+            if (it == m_entries.end()) {
+                Entry entry;
+                entry.key = request.key;
+                entry.priority = request.priority;
+                entry.generation = m_generation;
+                m_entries.emplace(id, entry);
+                m_order.insert(std::make_pair(request.priority, id));
+                continue;
+            }
+
+            ++m_stats.merged;
+            Entry& entry = it->second;
+            if (entry.state == State::InFlight)
+                continue;
+            // First sighting this frame takes the new priority; later duplicates only improve it
+            float priority = entry.generation == m_generation ? std::min(entry.priority, request.priority) : request.priority;
+            if (priority != entry.priority) {
+                m_order.erase(std::make_pair(entry.priority, id));
+                entry.priority = priority;
+                m_order.insert(std::make_pair(priority, id));
+            }
+            entry.generation = m_generation;
+        }
+
+        // Everything still pending but not asked for this frame is no longer visible or predicted
+        for (auto it = m_order.begin(); it != m_order.end();) {
+            Entry& entry = m_entries[it->second];
+            if (entry.generation != m_generation) {
+                m_entries.erase(it->second);
+                it = m_order.erase(it);
+                ++m_stats.cancelled;
+            }
+            else {
+                ++it;
+            }
+        }
+
+        m_wakeup.notify_all();
+    }
+
+    // Blocks until there is work; returns false on shutdown
+    bool pop(TileKey& key) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeup.wait(lock, [this] { return m_shutdown || !m_order.empty(); });
+        if (m_shutdown)
+            return false;
+        uint64_t id = m_order.begin()->second;
+        m_order.erase(m_order.begin());
+        Entry& entry = m_entries[id];
+        entry.state = State::InFlight;
+        key = entry.key;
+        ++m_stats.started;
+        return true;
+    }
+
+    // The tile reached the cache; later requests for it are the cache's business
+    void delivered(const TileKey& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.erase(key.packed());
+    }
+
+    void shutdown() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+        m_wakeup.notify_all();
+    }
+
+    size_t pendingCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_order.size();
+    }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    enum class State { Pending, InFlight };
+    struct Entry {
+        TileKey key;
+        State state = State::Pending;
+        float priority = 0.0f;
+        uint64_t generation = 0;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::unordered_map<uint64_t, Entry> m_entries;    // pending and in-flight
+    std::set<std::pair<float, uint64_t>> m_order;     // pending only, most urgent first
+    uint64_t m_generation = 0;
+    bool m_shutdown = false;
+    Stats m_stats;
+};
+
+// Decoder threads pulling from the request queue; the key's layer selects the pyramid to read
+class TileLoaderPool {
+public:
+    void start(const LayerStack* stack, TileRequestQueue* queue) {
+        m_stack = stack;
+        m_queue = queue;
+        for (int i = 0; i < loaderThreadCount; ++i)
+            m_threads.emplace_back(&TileLoaderPool::workerThread, this);
+    }
+
+    std::vector<LoadedTile> takeCompleted(int maxCount) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<LoadedTile> result;
+        while (!m_completed.empty() && static_cast<int>(result.size()) < maxCount) {
+            result.push_back(std::move(m_completed.front()));
+            m_completed.pop_front();
+        }
+        return result;
+    }
+
+    void stop() {
+        m_queue->shutdown();
+        for (std::thread& thread : m_threads)
+            thread.join();
+        m_threads.clear();
+    }
+
+private:
+    const LayerStack* m_stack = nullptr;
+    TileRequestQueue* m_queue = nullptr;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::deque<LoadedTile> m_completed;
+
+    void workerThread() {
+        TileKey key;
+        while (m_queue->pop(key)) {
+            LoadedTile tile;
+            tile.key = key;
+            m_stack->layer(key.layer).pyramid.readTile(key, tile.pixels, tile.width, tile.height);
+            tile.opaque = true;
+            for (size_t i = 3; i < tile.pixels.size() && tile.opaque; i += 4)
+                tile.opaque = tile.pixels[i] == 255;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed.push_back(std::move(tile));
+        }
+    }
+};
+
+// GPU-resident tiles of all layers, evicted least-recently-used once over budget
+class TileCache {
+public:
+    struct Entry {
+        GLuint texture = 0;
+        int width = 0, height = 0;
+        int lastUsedFrame = 0;
+        bool drawn = false;
+        bool opaque = false;
+    };
+
+    void upload(const LoadedTile& tile, int frame) {
+        Entry entry;
+        entry.width = tile.width;
+        entry.height = tile.height;
+        entry.lastUsedFrame = frame;
+        entry.opaque = tile.opaque;
+
+        glGenTextures(1, &entry.texture);
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tile.width, tile.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, tile.pixels.data());
+
+        m_entries[tile.key.packed()] = entry;
+        ++m_uploads;
+    }
+
+    Entry* find(const TileKey& key) {
+        auto it = m_entries.find(key.packed());
+        return it == m_entries.end() ? nullptr : &it->second;
+    }
+
+    bool contains(const TileKey& key) const { return m_entries.count(key.packed()) != 0; }
+
+    void evict(int currentFrame) {
+        if (m_entries.size() <= gpuTileBudget)
+            return;
+        std::vector<std::pair<int, uint64_t>> candidates;
+        for (const auto& item : m_entries)
+            if (item.second.lastUsedFrame < currentFrame)
+                candidates.emplace_back(item.second.lastUsedFrame, item.first);
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& candidate : candidates) {
+            if (m_entries.size() <= gpuTileBudget)
+                break;
+            Entry& victim = m_entries[candidate.second];
+            if (!victim.drawn)
+                ++m_unusedEvictions;
+            glDeleteTextures(1, &victim.texture);
+            m_entries.erase(candidate.second);
+        }
+    }
+
+    size_t size() const { return m_entries.size(); }
+    int getUploads() const { return m_uploads; }
+    int getUnusedEvictions() const { return m_unusedEvictions; }
+
+    void destroy() {
+        for (auto& item : m_entries)
+            glDeleteTextures(1, &item.second.texture);
+        m_entries.clear();
+    }
+
+private:
+    std::unordered_map<uint64_t, Entry> m_entries;
+    int m_uploads = 0;
+    int m_unusedEvictions = 0;   // decoded and uploaded, but evicted before ever being drawn
+};
+
+// Emits requests for the visible tiles and for the predicted camera path (duplicates are left to the queue).
+// The grid is walked once; every cell is requested for each visible layer.
+// priority = predicted seconds until visible + levelWeight * levels away from the current level
+//          + distanceWeight * distance from the view center (in half view extents)
+class Prefetcher {
+public:
+    bool enabled = true;
+
+    void collect(const Camera& camera, const TilePyramid& grid, const TileCache& cache, const std::vector<int>& layers,
+                 int framebufferWidth, int framebufferHeight, std::vector<TileRequest>& requests) {
+        requests.clear();
+        int currentLevel = grid.selectLevel(camera, framebufferWidth, framebufferHeight);
+
+        float horizon = enabled ? predictionHorizon : 0.0f;
+        for (float t = 0.0f; t <= horizon + 1e-4f; t += predictionStep) {
+            Camera future = camera.predicted(t);
+            int level = grid.selectLevel(future, framebufferWidth, framebufferHeight);
+            addRect(grid, cache, layers, future, level, currentLevel, t, requests);
+        }
+
+        float zoomRate = camera.getZoomRate();
+        if (enabled && std::fabs(zoomRate) > zoomRateThreshold) {
+            float position = grid.levelPosition(camera, framebufferWidth, framebufferHeight);
+            float levelsPerSecond = zoomRate / std::log(2.0f);
+            int nextLevel = zoomRate > 0.0f ? currentLevel - 1 : currentLevel + 1;
+            float distanceToSwitch = zoomRate > 0.0f ? position - std::floor(position) : std::ceil(position) - position;
+            float timeToSwitch = distanceToSwitch / std::fabs(levelsPerSecond);
+            if (nextLevel >= 0 && nextLevel < grid.levelCount())
+                addRect(grid, cache, layers, camera, nextLevel, currentLevel, timeToSwitch, requests);
+        }
+    }
+
+private:
+    void addRect(const TilePyramid& grid, const TileCache& cache, const std::vector<int>& layers, const Camera& view,
+                 int level, int currentLevel, float t, std::vector<TileRequest>& requests) {
+        int x0, y0, x1, y1;
+        if (!grid.tileRange(level, view.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glm::vec2 center = view.getCenter();
+        float halfExtent = 1.0f / view.getScale();
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                glm::vec4 r = grid.tileRect(key);
+                glm::vec2 tileCenter((r.x + r.z) * 0.5f, (r.y + r.w) * 0.5f);
+                float priority = t + levelWeight * std::abs(level - currentLevel) +
+                                 distanceWeight * glm::length(tileCenter - center) / halfExtent;
+
+                for (int layer : layers) {
+                    key.layer = layer;
+                    if (cache.contains(key))
+                        continue;
+                    TileRequest request;
+                    request.key = key;
+                    request.priority = priority;
+                    requests.push_back(request);
+                }
+            }
+        }
+    }
+};
+
+// Composites every visible layer of a grid cell in one draw: the fragment shader samples one tile texture
+// per layer (the layer's own tile, or the matching part of its nearest resident ancestor) and blends them
+// bottom to top. Layers beneath an opaque Normal layer at full opacity are left out of the draw entirely.
+class CompositeRenderer {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 tileRect;  // world x0, y0, x1, y1
+
+out vec2 corner;        // (0, 0) top-left to (1, 1) bottom-right of the cell
+
+void main()
+{
+    corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(tileRect.xw, tileRect.zy, corner), 0.0, 1.0);
+}
+)";
+
+    // Sampler arrays may only be indexed with constant expressions in GLSL 3.30, hence the unrolled LAYER();
+    // the macro stays on one line because 3.30 has no line continuation
+    const char* fragmentShaderSource = R"(
+#version 330 core
+#define MAX_LAYERS 8
+out vec4 FragColor;
+
+in vec2 corner;
+
+uniform sampler2D layerTextures[MAX_LAYERS];
+uniform vec4 uvRects[MAX_LAYERS];       // u0, v0 (top-left), u1, v1 (bottom-right) of the cell in each texture
+uniform float opacities[MAX_LAYERS];
+uniform int blendModes[MAX_LAYERS];
+uniform int layerCount;
+
+vec3 blend(int mode, vec3 backdrop, vec3 source)
+{
+    if (mode == 1) return backdrop * source;                                   // Multiply
+    if (mode == 2) return backdrop + source - backdrop * source;               // Screen
+    if (mode == 3) return mix(2.0 * backdrop * source,                         // Overlay
+                              1.0 - 2.0 * (1.0 - backdrop) * (1.0 - source), step(0.5, backdrop));
+    if (mode == 4) return min(backdrop + source, 1.0);                         // Add
+    if (mode == 5) return abs(backdrop - source);                              // Difference
+    return source;                                                             // Normal
+}
+
+// Source over a premultiplied result: where there is no backdrop the layer shows unblended
+vec4 composite(vec4 result, vec4 source, float opacity, int mode)
+{
+    float alpha = source.a * opacity;
+    vec3 backdrop = result.a > 0.0 ? result.rgb / result.a : vec3(0.0);
+    vec3 color = mix(source.rgb, blend(mode, backdrop, source.rgb), result.a);
+    return vec4(color * alpha + result.rgb * (1.0 - alpha), alpha + result.a * (1.0 - alpha));
+}
+
+#define LAYER(i) if (i < layerCount) result = composite(result, texture(layerTextures[i], mix(uvRects[i].xy, uvRects[i].zw, corner)), opacities[i], blendModes[i]);
+
+void main()
+{
+    vec4 result = vec4(0.0);
+    LAYER(0) LAYER(1) LAYER(2) LAYER(3) LAYER(4) LAYER(5) LAYER(6) LAYER(7)
+    FragColor = result.a > 0.0 ? vec4(result.rgb / result.a, result.a) : vec4(0.0);
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO;
+    GLint tileRectLoc, uvRectsLoc, opacitiesLoc, blendModesLoc, layerCountLoc;
+
+    // Per frame: cell draws, tile textures sampled, layer tiles left out under an opaque layer, layer tiles
+    // with nothing resident to draw from
+    int draws = 0;
+    int samples = 0;
+    int occluded = 0;
+    int holes = 0;
+
+    void init(Camera* camera) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        tileRectLoc = glGetUniformLocation(shaderProgram, "tileRect");
+        uvRectsLoc = glGetUniformLocation(shaderProgram, "uvRects");
+        opacitiesLoc = glGetUniformLocation(shaderProgram, "opacities");
+        blendModesLoc = glGetUniformLocation(shaderProgram, "blendModes");
+        layerCountLoc = glGetUniformLocation(shaderProgram, "layerCount");
+
+        // Layer i of a draw always samples texture unit i
+        GLint units[maxLayers];
+        for (int i = 0; i < maxLayers; ++i)
+            units[i] = i;
+        glUseProgram(shaderProgram);
+        glUniform1iv(glGetUniformLocation(shaderProgram, "layerTextures"), maxLayers, units);
+        glUseProgram(0);
+
+        // Corners come from gl_VertexID; the VAO only has to exist
+        glGenVertexArrays(1, &VAO);
+    }
+
+    void render(const Camera& camera, LayerStack& stack, const std::vector<int>& visible, TileCache& cache, int level, int frame) {
+        draws = samples = occluded = holes = 0;
+        const TilePyramid& grid = stack.grid();
+        int x0, y0, x1, y1;
+        if (visible.empty() || !grid.tileRange(level, camera.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                glm::vec4 rect = grid.tileRect(key);
+
+                // Top down, so collection can stop at the first layer that hides everything beneath it
+                int count = 0;
+                for (int i = static_cast<int>(visible.size()) - 1; i >= 0; --i) {
+                    const Layer& layer = stack.layer(visible[i]);
+                    key.layer = visible[i];
+
+                    // Walk up until a resident ancestor covers this tile
+                    TileKey source = key;
+                    TileCache::Entry* entry = cache.find(source);
+                    if (!entry)
+                        ++holes;
+                    while (!entry && source.level + 1 < grid.levelCount()) {
+                        source = source.parent();
+                        entry = cache.find(source);
+                    }
+                    if (!entry)
+                        continue;
+                    entry->lastUsedFrame = frame;
+                    entry->drawn = true;
+
+                    // Part of the source tile covered by this cell, in the source's texel space
+                    glm::vec4 sourceRect = grid.tileRect(source);
+                    m_uvRects[count] = glm::vec4((rect.x - sourceRect.x) / (sourceRect.z - sourceRect.x),
+                                                 (sourceRect.w - rect.w) / (sourceRect.w - sourceRect.y),
+                                                 (rect.z - sourceRect.x) / (sourceRect.z - sourceRect.x),
+                                                 (sourceRect.w - rect.y) / (sourceRect.w - sourceRect.y));
+                    m_textures[count] = entry->texture;
+                    m_opacities[count] = layer.opacity;
+                    m_blendModes[count] = static_cast<GLint>(layer.blend);
+                    ++count;
+
+                    if (entry->opaque && layer.blend == BlendMode::Normal && layer.opacity >= 1.0f) {
+                        occluded += i;
+                        break;
+                    }
+                }
+                if (count == 0)
+                    continue;
+
+                // Collected top down, drawn bottom up
+                std::reverse(m_uvRects, m_uvRects + count);
+                std::reverse(m_textures, m_textures + count);
+                std::reverse(m_opacities, m_opacities + count);
+                std::reverse(m_blendModes, m_blendModes + count);
+                for (int i = 0; i < count; ++i) {
+                    glActiveTexture(GL_TEXTURE0 + i);
+                    glBindTexture(GL_TEXTURE_2D, m_textures[i]);
+                }
+                glUniform4f(tileRectLoc, rect.x, rect.y, rect.z, rect.w);
+                glUniform4fv(uvRectsLoc, count, glm::value_ptr(m_uvRects[0]));
+                glUniform1fv(opacitiesLoc, count, m_opacities);
+                glUniform1iv(blendModesLoc, count, m_blendModes);
+                glUniform1i(layerCountLoc, count);
+                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+                ++draws;
+                samples += count;
+            }
+        }
+        glActiveTexture(GL_TEXTURE0);
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+    }
+
+private:
+    glm::vec4 m_uvRects[maxLayers];
+    GLuint m_textures[maxLayers];
+    GLfloat m_opacities[maxLayers];
+    GLint m_blendModes[maxLayers];
+};
+
+// "Layer Visibility" panel: per layer, top of the stack first, a visibility checkbox, opacity, blend mode
+// and a button moving it up the stack
+void drawLayerPanel(LayerStack& stack) {
+    ImGui::Begin("Layer Visibility");
+    const std::vector<int>& order = stack.order();
+    for (int position = static_cast<int>(order.size()) - 1; position >= 0; --position) {
+        Layer& layer = stack.layer(order[position]);
+        ImGui::PushID(order[position]);
+        ImGui::Checkbox(layer.name.c_str(), &layer.visible);
+        if (position + 1 < static_cast<int>(order.size())) {
+            ImGui::SameLine();
+            if (ImGui::ArrowButton("raise", ImGuiDir_Up))
+                stack.raise(position);
+        }
+        ImGui::SliderFloat("opacity", &layer.opacity, 0.0f, 1.0f);
+        int blend = static_cast<int>(layer.blend);
+        if (ImGui::Combo("blend", &blend, blendModeNames, blendModeCount))
+            layer.blend = static_cast<BlendMode>(blend);
+        ImGui::Separator();
+        ImGui::PopID();
+    }
+    ImGui::End();
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> imagePaths;
+    for (int i = 1; i < argc; ++i)
+        imagePaths.push_back(argv[i]);
+    if (imagePaths.empty())
+        imagePaths = { "src/textures/assets/test_nb.png", "src/textures/assets/pop_cat.png", "src/textures/assets/test.png" };
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 330 core");
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    LayerStack stack;
+    for (const std::string& path : imagePaths)
+        stack.add(path);
+    if (stack.layerCount() == 0) {
+        glfwTerminate();
+        return -1;
+    }
+    const TilePyramid& grid = stack.grid();
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    TileRequestQueue queue;
+    TileLoaderPool loaders;
+    loaders.start(&stack, &queue);
+    TileCache cache;
+    Prefetcher prefetcher;
+    CompositeRenderer renderer;
+    renderer.init(&camera);
+
+    std::vector<TileRequest> requests;
+    std::vector<int> visible;
+    bool prefetchKeyDown = false;
+    bool sweepKeyDown = false;
+    bool layerKeyDown[maxLayers] = {};
+    int sweepFramesLeft = 0;
+    float sweepFactor = 1.0f;
+    int frame = 0;
+    long long totalDraws = 0, totalSamples = 0, totalOccluded = 0;
+    double lastTitleTime = glfwGetTime();
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+        drawLayerPanel(stack);
+
+        // Keys go to the panel while one of its widgets has focus
+        if (!ImGui::GetIO().WantCaptureKeyboard) {
+            camera.processKeyboardInput(window);
+
+            bool prefetchKeyPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+            if (prefetchKeyPressed && !prefetchKeyDown)
+                prefetcher.enabled = !prefetcher.enabled;
+            prefetchKeyDown = prefetchKeyPressed;
+
+            // Z: zoom in through zoomSweepLevels levels in zoomSweepFrames frames
+            bool sweepKeyPressed = glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS;
+            if (sweepKeyPressed && !sweepKeyDown && sweepFramesLeft == 0) {
+                int levels = std::min(zoomSweepLevels, grid.selectLevel(camera, width, height));
+                sweepFactor = std::pow(2.0f, static_cast<float>(levels) / zoomSweepFrames);
+                sweepFramesLeft = zoomSweepFrames;
+            }
+            sweepKeyDown = sweepKeyPressed;
+
+            // 1-8: toggle the layer loaded in that position
+            for (int i = 0; i < stack.layerCount(); ++i) {
+                bool layerKeyPressed = glfwGetKey(window, GLFW_KEY_1 + i) == GLFW_PRESS;
+                if (layerKeyPressed && !layerKeyDown[i])
+                    stack.layer(i).visible = !stack.layer(i).visible;
+                layerKeyDown[i] = layerKeyPressed;
+            }
+        }
+        if (sweepFramesLeft > 0) {
+            camera.zoomBy(sweepFactor);
+            --sweepFramesLeft;
+        }
+
+        camera.updateMotion(glfwGetTime());
+
+        // Hidden layers are neither requested nor drawn; their resident tiles age out of the cache
+        stack.collectVisible(visible);
+
+        // The whole wanted set goes to the queue every frame; whatever it no longer contains is cancelled
+        prefetcher.collect(camera, grid, cache, visible, width, height, requests);
+        queue.submitFrame(requests);
+
+        for (const LoadedTile& tile : loaders.takeCompleted(maxUploadsPerFrame)) {
+            cache.upload(tile, frame);
+            queue.delivered(tile.key);
+        }
+
+        int level = grid.selectLevel(camera, width, height);
+        camera.publish(width, height);
+        renderer.render(camera, stack, visible, cache, level, frame);
+        cache.evict(frame);
+        totalDraws += renderer.draws;
+        totalSamples += renderer.samples;
+        totalOccluded += renderer.occluded;
+
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+        double now = glfwGetTime();
+        if (now - lastTitleTime > 0.5) {
+            char title[200];
+            snprintf(title, sizeof(title), "OpenGL - level %d | %zu of %d layers in one pass: %d draws, %d tile samples, %d occluded, %d holes | pending %zu",
+                     level, visible.size(), stack.layerCount(), renderer.draws, renderer.samples, renderer.occluded, renderer.holes,
+                     queue.pendingCount());
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    TileRequestQueue::Stats stats = queue.getStats();
+    printf("Requests submitted: %lld, merged: %lld, cancelled: %lld, decoded: %lld\n",
+           stats.submitted, stats.merged, stats.cancelled, stats.started);
+    printf("Tile uploads: %d, evicted without being drawn: %d\n", cache.getUploads(), cache.getUnusedEvictions());
+    if (frame > 0)
+        printf("Per frame: %.1f composite draws, %.1f tile samples, %.1f layer tiles skipped under opaque layers\n",
+               static_cast<double>(totalDraws) / frame, static_cast<double>(totalSamples) / frame, static_cast<double>(totalOccluded) / frame);
+
+    loaders.stop();
+    renderer.destroy();
+    cache.destroy();
+    camera.destroy();
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,881 @@
+// pixel format conversion kernels shared by the PNG, JPEG and TIFF loaders
+// One table of kernels covers RGB -> RGBA expansion, channel swizzles, straight -> premultiplied alpha,
+// 16 -> 8 bit scaling and row flipping, each with a scalar reference and SSSE3 / AVX2 / NEON versions that
+// are bit-identical to it. The loaders decode in the file's native layout (stb_image without forced
+// channels, libtiff scanlines) and do all format work through the table, so every image reaches the GPU as
+// top-down, premultiplied 8-bit RGBA. TIFFs are no longer drawn with flipped V coordinates.
+// Usage: pixel_convert [image]       viewer; N cycles the sample images, K toggles scalar/SIMD kernels
+//        pixel_convert --benchmark   compares every supported kernel set against the scalar path
+#include <iostream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <tiffio.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+// Sample images cycled with N
+const char* sampleImagePaths[] = {
+    "src/textures/assets/test_nb.png",
+    "src/textures/assets/test.jpg",
+    "src/textures/assets/test.tif",
+};
+
+// Benchmark buffer size (pixels per side) and repetitions; the best run counts
+const int benchmarkSize = 2048;
+const int benchmarkRuns = 5;
+
+// ---------------------------------------------------------------------------------------------------------
+// Pixel format kernels. Every kernel has a scalar reference and SSE (SSSE3), AVX2 and NEON versions that
+// produce bit-identical results; selectPixelKernels() picks the widest one the CPU supports at run time.
+// ---------------------------------------------------------------------------------------------------------
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PIXEL_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define PIXEL_TARGET(isa)
+#else
+#define PIXEL_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define PIXEL_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Kernel table; counts are in pixels unless noted otherwise
+struct PixelKernels {
+    const char* name;
+    // RGB -> RGBA with opaque alpha
+    void (*rgbToRgba)(const uint8_t* src, uint8_t* dst, size_t count);
+    // dst[i].c = src[i].order[c], e.g. {2, 1, 0, 3} for BGRA <-> RGBA; src and dst may alias
+    void (*swizzleRgba)(const uint8_t* src, uint8_t* dst, size_t count, const uint8_t order[4]);
+    // Straight -> premultiplied alpha, in place: c = round(c * a / 255)
+    void (*premultiplyAlpha)(uint8_t* pixels, size_t count);
+    // 16-bit -> 8-bit samples (count in samples): v8 = round(v16 / 257) = (v16 * 255 + 32895) >> 16
+    void (*scale16To8)(const uint16_t* src, uint8_t* dst, size_t count);
+    // Reverses the row order in place
+    void (*flipRows)(uint8_t* pixels, size_t rowBytes, size_t rows);
+};
+
+inline uint8_t premultiplyChannel(uint32_t c, uint32_t a) {
+    uint32_t t = c * a + 128;
+    return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+void rgbToRgbaScalar(const uint8_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i, src += 3, dst += 4) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 255;
+    }
+}
+
+void swizzleRgbaScalar(const uint8_t* src, uint8_t* dst, size_t count, const uint8_t order[4]) {
+    for (size_t i = 0; i < count; ++i, src += 4, dst += 4) {
+        uint8_t pixel[4] = { src[order[0]], src[order[1]], src[order[2]], src[order[3]] };
+        memcpy(dst, pixel, 4);
+    }
+}
+
+void premultiplyAlphaScalar(uint8_t* pixels, size_t count) {
+    for (size_t i = 0; i < count; ++i, pixels += 4) {
+        uint32_t a = pixels[3];
+        pixels[0] = premultiplyChannel(pixels[0], a);
+        pixels[1] = premultiplyChannel(pixels[1], a);
+        pixels[2] = premultiplyChannel(pixels[2], a);
+    }
+}
+
+void scale16To8Scalar(const uint16_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = static_cast<uint8_t>((static_cast<uint32_t>(src[i]) * 255 + 32895) >> 16);
+}
+
+void flipRowsScalar(uint8_t* pixels, size_t rowBytes, size_t rows) {
+    for (size_t top = 0, bottom = rows - 1; rows > 1 && top < bottom; ++top, --bottom)
+        std::swap_ranges(pixels + top * rowBytes, pixels + (top + 1) * rowBytes, pixels + bottom * rowBytes);
+}
+
+const PixelKernels scalarKernels = {
+    "scalar", rgbToRgbaScalar, swizzleRgbaScalar, premultiplyAlphaScalar, scale16To8Scalar, flipRowsScalar
+};
+
+#if PIXEL_KERNELS_X86
+
+// 16 pixels (48 bytes) per iteration: each 12-byte group is spread to 16 bytes with one pshufb
+PIXEL_TARGET("ssse3") void rgbToRgbaSse(const uint8_t* src, uint8_t* dst, size_t count) {
+    const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16, src += 48, dst += 64) {
+        __m128i in0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i in1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+        __m128i in2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+        __m128i p0 = _mm_shuffle_epi8(in0, spread);
+        __m128i p1 = _mm_shuffle_epi8(_mm_alignr_epi8(in1, in0, 12), spread);
+        __m128i p2 = _mm_shuffle_epi8(_mm_alignr_epi8(in2, in1, 8), spread);
+        __m128i p3 = _mm_shuffle_epi8(_mm_srli_si128(in2, 4), spread);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_or_si128(p0, alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_or_si128(p1, alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32), _mm_or_si128(p2, alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 48), _mm_or_si128(p3, alpha));
+    }
+    rgbToRgbaScalar(src, dst, count - i);
+}
+
+PIXEL_TARGET("ssse3") void swizzleRgbaSse(const uint8_t* src, uint8_t* dst, size_t count, const uint8_t order[4]) {
+    alignas(16) uint8_t mask[16];
+    for (int b = 0; b < 16; ++b)
+        mask[b] = static_cast<uint8_t>((b & ~3) + order[b & 3]);
+    const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, src += 16, dst += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi8(in, shuffle));
+    }
+    swizzleRgbaScalar(src, dst, count - i, order);
+}
+
+// Two pixels per 16-bit register half; t = c * a + 128, result = (t + (t >> 8)) >> 8, alpha kept as is
+PIXEL_TARGET("ssse3") void premultiplyAlphaSse(uint8_t* pixels, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, pixels += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+        __m128i lo = _mm_unpacklo_epi8(in, zero);
+        __m128i hi = _mm_unpackhi_epi8(in, zero);
+        __m128i alphaLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i alphaHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i tLo = _mm_add_epi16(_mm_mullo_epi16(lo, alphaLo), bias);
+        __m128i tHi = _mm_add_epi16(_mm_mullo_epi16(hi, alphaHi), bias);
+        tLo = _mm_srli_epi16(_mm_add_epi16(tLo, _mm_srli_epi16(tLo, 8)), 8);
+        tHi = _mm_srli_epi16(_mm_add_epi16(tHi, _mm_srli_epi16(tHi, 8)), 8);
+        __m128i out = _mm_packus_epi16(tLo, tHi);
+        out = _mm_or_si128(_mm_andnot_si128(alphaMask, out), _mm_and_si128(alphaMask, in));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), out);
+    }
+    premultiplyAlphaScalar(pixels, count - i);
+}
+
+// (v * 255 + 32895) >> 16 from the 16x16 -> 32 bit product halves: high half plus the carry out of the low half
+PIXEL_TARGET("ssse3") inline __m128i scale16To8Sse(__m128i v) {
+    const __m128i factor = _mm_set1_epi16(255);
+    const __m128i roundBias = _mm_set1_epi16(static_cast<short>(32895));
+    const __m128i signBit = _mm_set1_epi16(static_cast<short>(0x8000));
+    __m128i lo = _mm_mullo_epi16(v, factor);
+    __m128i hi = _mm_mulhi_epu16(v, factor);
+    __m128i sum = _mm_add_epi16(lo, roundBias);
+    // Unsigned sum < lo means the addition wrapped; compare with the sign bits flipped
+    __m128i carry = _mm_cmpgt_epi16(_mm_xor_si128(lo, signBit), _mm_xor_si128(sum, signBit));
+    return _mm_sub_epi16(hi, carry);
+}
+
+PIXEL_TARGET("ssse3") void scale16To8Sse(const uint16_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = scale16To8Sse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        __m128i b = scale16To8Sse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(a, b));
+    }
+    scale16To8Scalar(src + i, dst + i, count - i);
+}
+
+PIXEL_TARGET("ssse3") void flipRowsSse(uint8_t* pixels, size_t rowBytes, size_t rows) {
+    for (size_t top = 0, bottom = rows - 1; rows > 1 && top < bottom; ++top, --bottom) {
+        uint8_t* a = pixels + top * rowBytes;
+        uint8_t* b = pixels + bottom * rowBytes;
+        size_t x = 0;
+        for (; x + 16 <= rowBytes; x += 16) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + x));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + x));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(a + x), vb);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(b + x), va);
+        }
+        std::swap_ranges(a + x, a + rowBytes, b + x);
+    }
+}
+
+// AVX2 shuffles stay within 128-bit lanes, so 8 pixels are loaded as two 12-byte groups, one per lane
+PIXEL_TARGET("avx2") void rgbToRgbaAvx2(const uint8_t* src, uint8_t* dst, size_t count) {
+    const __m256i spread = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    size_t i = 0;
+    // Each group load reads 16 bytes for 12, so stop while at least 4 bytes of slack remain
+    for (; i + 10 <= count; i += 8, src += 24, dst += 32) {
+        __m256i in = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 12)), 1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_or_si256(_mm256_shuffle_epi8(in, spread), alpha));
+    }
+    rgbToRgbaSse(src, dst, count - i);
+}
+
+PIXEL_TARGET("avx2") void swizzleRgbaAvx2(const uint8_t* src, uint8_t* dst, size_t count, const uint8_t order[4]) {
+    alignas(32) uint8_t mask[32];
+    for (int b = 0; b < 32; ++b)
+        mask[b] = static_cast<uint8_t>((b & 12) + order[b & 3]);
+    const __m256i shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(mask));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, src += 32, dst += 32) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_shuffle_epi8(in, shuffle));
+    }
+    swizzleRgbaSse(src, dst, count - i, order);
+}
+
+PIXEL_TARGET("avx2") void premultiplyAlphaAvx2(uint8_t* pixels, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i bias = _mm256_set1_epi16(128);
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, pixels += 32) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels));
+        __m256i lo = _mm256_unpacklo_epi8(in, zero);
+        __m256i hi = _mm256_unpackhi_epi8(in, zero);
+        __m256i alphaLo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m256i alphaHi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m256i tLo = _mm256_add_epi16(_mm256_mullo_epi16(lo, alphaLo), bias);
+        __m256i tHi = _mm256_add_epi16(_mm256_mullo_epi16(hi, alphaHi), bias);
+        tLo = _mm256_srli_epi16(_mm256_add_epi16(tLo, _mm256_srli_epi16(tLo, 8)), 8);
+        tHi = _mm256_srli_epi16(_mm256_add_epi16(tHi, _mm256_srli_epi16(tHi, 8)), 8);
+        // unpack and pack both work per lane, so the pixel order survives the round trip
+        __m256i out = _mm256_packus_epi16(tLo, tHi);
+        out = _mm256_or_si256(_mm256_andnot_si256(alphaMask, out), _mm256_and_si256(alphaMask, in));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels), out);
+    }
+    premultiplyAlphaSse(pixels, count - i);
+}
+
+PIXEL_TARGET("avx2") inline __m256i scale16To8Avx2(__m256i v) {
+    const __m256i factor = _mm256_set1_epi16(255);
+    const __m256i roundBias = _mm256_set1_epi16(static_cast<short>(32895));
+    const __m256i signBit = _mm256_set1_epi16(static_cast<short>(0x8000));
+    __m256i lo = _mm256_mullo_epi16(v, factor);
+    __m256i hi = _mm256_mulhi_epu16(v, factor);
+    __m256i sum = _mm256_add_epi16(lo, roundBias);
+    __m256i carry = _mm256_cmpgt_epi16(_mm256_xor_si256(lo, signBit), _mm256_xor_si256(sum, signBit));
+    return _mm256_sub_epi16(hi, carry);
+}
+
+PIXEL_TARGET("avx2") void scale16To8Avx2(const uint16_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i a = scale16To8Avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+        __m256i b = scale16To8Avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 16)));
+        // packus interleaves the lanes (a0 b0 a1 b1); restore a0 a1 b0 b1
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    scale16To8Sse(src + i, dst + i, count - i);
+}
+
+PIXEL_TARGET("avx2") void flipRowsAvx2(uint8_t* pixels, size_t rowBytes, size_t rows) {
+    for (size_t top = 0, bottom = rows - 1; rows > 1 && top < bottom; ++top, --bottom) {
+        uint8_t* a = pixels + top * rowBytes;
+        uint8_t* b = pixels + bottom * rowBytes;
+        size_t x = 0;
+        for (; x + 32 <= rowBytes; x += 32) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + x));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + x));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + x), vb);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(b + x), va);
+        }
+        std::swap_ranges(a + x, a + rowBytes, b + x);
+    }
+}
+
+const PixelKernels sseKernels = {
+    "SSSE3", rgbToRgbaSse, swizzleRgbaSse, premultiplyAlphaSse, scale16To8Sse, flipRowsSse
+};
+const PixelKernels avx2Kernels = {
+    "AVX2", rgbToRgbaAvx2, swizzleRgbaAvx2, premultiplyAlphaAvx2, scale16To8Avx2, flipRowsAvx2
+};
+
+#endif // PIXEL_KERNELS_X86
+
+#if PIXEL_KERNELS_NEON
+
+// De-interleaving loads/stores do the channel work: 16 pixels per iteration
+void rgbToRgbaNeon(const uint8_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16, src += 48, dst += 64) {
+        uint8x16x3_t in = vld3q_u8(src);
+        uint8x16x4_t out;
+        out.val[0] = in.val[0];
+        out.val[1] = in.val[1];
+        out.val[2] = in.val[2];
+        out.val[3] = vdupq_n_u8(255);
+        vst4q_u8(dst, out);
+    }
+    rgbToRgbaScalar(src, dst, count - i);
+}
+
+void swizzleRgbaNeon(const uint8_t* src, uint8_t* dst, size_t count, const uint8_t order[4]) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16, src += 64, dst += 64) {
+        uint8x16x4_t in = vld4q_u8(src);
+        uint8x16x4_t out;
+        for (int c = 0; c < 4; ++c)
+            out.val[c] = in.val[order[c]];
+        vst4q_u8(dst, out);
+    }
+    swizzleRgbaScalar(src, dst, count - i, order);
+}
+
+void premultiplyAlphaNeon(uint8_t* pixels, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16, pixels += 64) {
+        uint8x16x4_t px = vld4q_u8(pixels);
+        for (int c = 0; c < 3; ++c) {
+            uint16x8_t lo = vaddq_u16(vmull_u8(vget_low_u8(px.val[c]), vget_low_u8(px.val[3])), vdupq_n_u16(128));
+            uint16x8_t hi = vaddq_u16(vmull_u8(vget_high_u8(px.val[c]), vget_high_u8(px.val[3])), vdupq_n_u16(128));
+            px.val[c] = vcombine_u8(vshrn_n_u16(vaddq_u16(lo, vshrq_n_u16(lo, 8)), 8),
+                                    vshrn_n_u16(vaddq_u16(hi, vshrq_n_u16(hi, 8)), 8));
+        }
+        vst4q_u8(pixels, px);
+    }
+    premultiplyAlphaScalar(pixels, count - i);
+}
+
+void scale16To8Neon(const uint16_t* src, uint8_t* dst, size_t count) {
+    const uint32x4_t roundBias = vdupq_n_u32(32895);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t v = vld1q_u16(src + i);
+        uint32x4_t lo = vmlal_u16(roundBias, vget_low_u16(v), vdup_n_u16(255));
+        uint32x4_t hi = vmlal_u16(roundBias, vget_high_u16(v), vdup_n_u16(255));
+        uint16x8_t scaled = vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16));
+        vst1_u8(dst + i, vmovn_u16(scaled));
+    }
+    scale16To8Scalar(src + i, dst + i, count - i);
+}
+
+void flipRowsNeon(uint8_t* pixels, size_t rowBytes, size_t rows) {
+    for (size_t top = 0, bottom = rows - 1; rows > 1 && top < bottom; ++top, --bottom) {
+        uint8_t* a = pixels + top * rowBytes;
+        uint8_t* b = pixels + bottom * rowBytes;
+        size_t x = 0;
+        for (; x + 16 <= rowBytes; x += 16) {
+            uint8x16_t va = vld1q_u8(a + x);
+            uint8x16_t vb = vld1q_u8(b + x);
+            vst1q_u8(a + x, vb);
+            vst1q_u8(b + x, va);
+        }
+        std::swap_ranges(a + x, a + rowBytes, b + x);
+    }
+}
+
+const PixelKernels neonKernels = {
+    "NEON", rgbToRgbaNeon, swizzleRgbaNeon, premultiplyAlphaNeon, scale16To8Neon, flipRowsNeon
+};
+
+#endif // PIXEL_KERNELS_NEON
+
+// Kernel sets the running CPU supports, scalar first and widest last (NEON is baseline on AArch64)
+std::vector<const PixelKernels*> supportedPixelKernels() {
+    std::vector<const PixelKernels*> sets = { &scalarKernels };
+#if PIXEL_KERNELS_X86
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool ssse3 = (info[2] & (1 << 9)) != 0;
+    bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    bool avx2 = osAvx && (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    bool ssse3 = __builtin_cpu_supports("ssse3");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (ssse3)
+        sets.push_back(&sseKernels);
+    if (ssse3 && avx2)
+        sets.push_back(&avx2Kernels);
+#elif PIXEL_KERNELS_NEON
+    sets.push_back(&neonKernels);
+#endif
+    return sets;
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Loaders
+// ---------------------------------------------------------------------------------------------------------
+
+// Decoded image: 8-bit RGBA, row 0 at the top, premultiplied alpha
+struct RgbaImage {
+    int width = 0, height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+bool isTiffPath(const std::string& path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".tif" || extension == ".tiff";
+}
+
+bool isBigEndianHost() {
+    const uint16_t probe = 1;
+    return *reinterpret_cast<const uint8_t*>(&probe) == 0;
+}
+
+// Widens decoded 8-bit pixels with 1-4 channels to RGBA
+void expandToRgba(const PixelKernels& kernels, const uint8_t* src, int channels, uint8_t* dst, size_t count) {
+    if (channels == 4) {
+        memcpy(dst, src, count * 4);
+    } else if (channels == 3) {
+        kernels.rgbToRgba(src, dst, count);
+    } else {
+        // Gray and gray + alpha are rare in this data; no kernel for them
+        for (size_t i = 0; i < count; ++i, src += channels, dst += 4) {
+            dst[0] = dst[1] = dst[2] = src[0];
+            dst[3] = channels == 2 ? src[1] : 255;
+        }
+    }
+}
+
+// PNG / JPEG through stb_image in the file's own channel count and bit depth
+bool loadWithStb(const std::string& path, const PixelKernels& kernels, RgbaImage& image) {
+    int width, height, channels;
+    if (stbi_is_16_bit(path.c_str())) {
+        stbi_us* data = stbi_load_16(path.c_str(), &width, &height, &channels, 0);
+        if (!data)
+            return false;
+        std::vector<uint8_t> samples(static_cast<size_t>(width) * height * channels);
+        kernels.scale16To8(data, samples.data(), samples.size());
+        stbi_image_free(data);
+        image.pixels.resize(static_cast<size_t>(width) * height * 4);
+        expandToRgba(kernels, samples.data(), channels, image.pixels.data(), static_cast<size_t>(width) * height);
+    } else {
+        stbi_uc* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+        if (!data)
+            return false;
+        image.pixels.resize(static_cast<size_t>(width) * height * 4);
+        expandToRgba(kernels, data, channels, image.pixels.data(), static_cast<size_t>(width) * height);
+        stbi_image_free(data);
+    }
+    image.width = width;
+    image.height = height;
+    kernels.premultiplyAlpha(image.pixels.data(), image.pixels.size() / 4);
+    return true;
+}
+
+// Strip-organized contiguous RGB(A) TIFFs, 8 or 16 bit, are read scanline by scanline (top-down) and converted
+// with the kernels. Anything else (palette, YCbCr, tiled, planar, ...) goes through libtiff's RGBA interface,
+// which returns bottom-up ABGR words with associated alpha; the kernels swizzle and flip that instead.
+bool loadWithTiff(const std::string& path, const PixelKernels& kernels, RgbaImage& image) {
+    TIFF* tif = TIFFOpen(path.c_str(), "r");
+    if (!tif)
+        return false;
+
+    uint32_t width = 0, height = 0;
+    uint16_t bitsPerSample = 8, samplesPerPixel = 1, planarConfig = PLANARCONFIG_CONTIG, photometric = 0;
+    uint16_t extraCount = 0;
+    uint16_t* extraTypes = nullptr;
+    TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+    TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bitsPerSample);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_PLANARCONFIG, &planarConfig);
+    TIFFGetField(tif, TIFFTAG_PHOTOMETRIC, &photometric);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_EXTRASAMPLES, &extraCount, &extraTypes);
+    bool associatedAlpha = extraCount > 0 && extraTypes[0] == EXTRASAMPLE_ASSOCALPHA;
+
+    image.width = static_cast<int>(width);
+    image.height = static_cast<int>(height);
+    image.pixels.resize(static_cast<size_t>(width) * height * 4);
+
+    bool ok = true;
+    if (photometric == PHOTOMETRIC_RGB && planarConfig == PLANARCONFIG_CONTIG && !TIFFIsTiled(tif) &&
+        (samplesPerPixel == 3 || samplesPerPixel == 4) && (bitsPerSample == 8 || bitsPerSample == 16)) {
+        std::vector<uint8_t> scanline(static_cast<size_t>(TIFFScanlineSize(tif)));
+        std::vector<uint8_t> samples(static_cast<size_t>(width) * samplesPerPixel);
+        for (uint32_t row = 0; row < height && ok; ++row) {
+            ok = TIFFReadScanline(tif, scanline.data(), row, 0) >= 0;
+            const uint8_t* src = scanline.data();
+            if (bitsPerSample == 16) {
+                kernels.scale16To8(reinterpret_cast<const uint16_t*>(scanline.data()), samples.data(), samples.size());
+                src = samples.data();
+            }
+            expandToRgba(kernels, src, samplesPerPixel, image.pixels.data() + static_cast<size_t>(row) * width * 4, width);
+        }
+        if (!associatedAlpha)
+            kernels.premultiplyAlpha(image.pixels.data(), static_cast<size_t>(width) * height);
+    } else {
+        ok = TIFFReadRGBAImage(tif, width, height, reinterpret_cast<uint32_t*>(image.pixels.data()), 0) != 0;
+        // ABGR words are R, G, B, A bytes on little-endian hosts and A, B, G, R on big-endian ones
+        if (isBigEndianHost()) {
+            const uint8_t reverse[4] = { 3, 2, 1, 0 };
+            kernels.swizzleRgba(image.pixels.data(), image.pixels.data(), static_cast<size_t>(width) * height, reverse);
+        }
+        kernels.flipRows(image.pixels.data(), static_cast<size_t>(width) * 4, height);
+    }
+
+    TIFFClose(tif);
+    return ok;
+}
+
+bool loadImage(const std::string& path, const PixelKernels& kernels, RgbaImage& image) {
+    return isTiffPath(path) ? loadWithTiff(path, kernels, image) : loadWithStb(path, kernels, image);
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Benchmark
+// ---------------------------------------------------------------------------------------------------------
+
+// Best-of-N throughput of one kernel in megabytes of output per second
+template <typename Kernel>
+double measureThroughput(Kernel kernel, size_t outputBytes) {
+    double best = 1e30;
+    for (int run = 0; run < benchmarkRuns; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        kernel();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, seconds);
+    }
+    return outputBytes / best / 1.0e6;
+}
+
+void runBenchmark() {
+    const size_t count = static_cast<size_t>(benchmarkSize) * benchmarkSize;
+    const uint8_t bgra[4] = { 2, 1, 0, 3 };
+
+    // Deterministic pseudo-random input
+    std::vector<uint8_t> rgb(count * 3), rgba(count * 4);
+    std::vector<uint16_t> wide(count * 4);
+    uint32_t seed = 12345;
+    for (uint8_t& v : rgb) v = static_cast<uint8_t>((seed = seed * 1664525u + 1013904223u) >> 24);
+    for (uint8_t& v : rgba) v = static_cast<uint8_t>((seed = seed * 1664525u + 1013904223u) >> 24);
+    for (uint16_t& v : wide) v = static_cast<uint16_t>((seed = seed * 1664525u + 1013904223u) >> 16);
+
+    std::vector<const PixelKernels*> sets = supportedPixelKernels();
+    std::vector<std::vector<uint8_t>> reference(5);
+    printf("%d x %d pixels, best of %d runs, MB/s of output\n", benchmarkSize, benchmarkSize, benchmarkRuns);
+    printf("%-8s %12s %12s %12s %12s %12s\n", "kernels", "rgbToRgba", "swizzle", "premultiply", "16->8", "flipRows");
+
+    for (const PixelKernels* set : sets) {
+        std::vector<uint8_t> out(count * 4), work(count * 4);
+        std::vector<std::vector<uint8_t>> results;
+        double mbps[5];
+
+        mbps[0] = measureThroughput([&]() { set->rgbToRgba(rgb.data(), out.data(), count); }, count * 4);
+        results.push_back(out);
+        mbps[1] = measureThroughput([&]() { set->swizzleRgba(rgba.data(), out.data(), count, bgra); }, count * 4);
+        results.push_back(out);
+        // In-place kernels restart from the same input on every run
+        mbps[2] = measureThroughput([&]() { work = rgba; set->premultiplyAlpha(work.data(), count); }, count * 4);
+        results.push_back(work);
+        mbps[3] = measureThroughput([&]() { set->scale16To8(wide.data(), out.data(), count * 4); }, count * 4);
+        results.push_back(out);
+        mbps[4] = measureThroughput([&]() { work = rgba; set->flipRows(work.data(), static_cast<size_t>(benchmarkSize) * 4, benchmarkSize); }, count * 4);
+        results.push_back(work);
+
+        printf("%-8s %12.0f %12.0f %12.0f %12.0f %12.0f\n", set->name, mbps[0], mbps[1], mbps[2], mbps[3], mbps[4]);
+        if (set == &scalarKernels) {
+            reference = results;
+        } else {
+            for (size_t k = 0; k < results.size(); ++k)
+                if (results[k] != reference[k])
+                    printf("  MISMATCH: %s kernel %zu differs from scalar\n", set->name, k);
+        }
+    }
+    printf("(premultiply and flipRows include copying the input back, which is the same for every set)\n");
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Viewer
+// ---------------------------------------------------------------------------------------------------------
+
+class Camera {
+public:
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f;  // Adjusted sensitivity
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+};
+
+class Texture {
+public:
+    // Vertex Shader Source
+    const char* vertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTex;
+
+out vec2 texCoord;
+
+uniform mat4 model;
+
+void main()
+{
+    gl_Position = model * vec4(aPos, 0.0, 1.0);
+    texCoord = aTex;
+}
+)";
+
+    // Fragment Shader Source
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+    GLuint shaderProgram;
+    GLint modelLoc;
+    GLuint VAO, VBO;
+    GLuint textureID = 0;
+    Camera* m_camera = nullptr;
+
+    void init(Camera* camera) {
+        m_camera = camera;
+        shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+        modelLoc = glGetUniformLocation(shaderProgram, "model");
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, 16 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    // Every loader delivers top-down rows, so all formats share the same texture coordinates
+    void upload(const RgbaImage& image) {
+        float aspectRatio = static_cast<float>(image.width) / image.height;
+        float vertices[] = {
+            // Positions            // Texture Coords
+            -1.0f, -1.0f / aspectRatio,  0.0f, 1.0f,
+             1.0f, -1.0f / aspectRatio,  1.0f, 1.0f,
+            -1.0f,  1.0f / aspectRatio,  0.0f, 0.0f,
+             1.0f,  1.0f / aspectRatio,  1.0f, 0.0f
+        };
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    // Function to compile shaders
+    GLuint compileShader(GLenum type, const char* source) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        GLint success;
+        GLchar infoLog[512];
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+            std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+        }
+        return shader;
+    }
+
+    // Function to create shader program
+    GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource) {
+        GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+        GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, fragmentShader);
+        glLinkProgram(program);
+
+        GLint success;
+        GLchar infoLog[512];
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(program, 512, nullptr, infoLog);
+            std::cerr << "Program Linking Error: " << infoLog << std::endl;
+        }
+
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        return program;
+    }
+
+    void render() {
+        glUseProgram(shaderProgram);
+        glm::mat4 model = m_camera->getTransform();
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+
+        glBindVertexArray(VAO);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteProgram(shaderProgram);
+        glDeleteTextures(1, &textureID);
+    }
+};
+
+int main(int argc, char** argv) {
+    std::vector<std::string> imagePaths(std::begin(sampleImagePaths), std::end(sampleImagePaths));
+    if (argc > 1 && std::string(argv[1]) == "--benchmark") {
+        runBenchmark();
+        return 0;
+    }
+    if (argc > 1)
+        imagePaths.assign(argv + 1, argv + argc);
+
+    const PixelKernels* simdKernels = supportedPixelKernels().back();
+    printf("Pixel kernels: %s\n", simdKernels->name);
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    // Images arrive premultiplied
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    Camera camera;
+    Texture texture;
+    texture.init(&camera);
+
+    size_t imageIndex = 0;
+    bool useSimd = true;
+    bool reload = true;
+    bool nextKeyDown = false, kernelKeyDown = false;
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        if (reload) {
+            const PixelKernels& kernels = useSimd ? *simdKernels : scalarKernels;
+            RgbaImage image;
+            auto start = std::chrono::steady_clock::now();
+            if (loadImage(imagePaths[imageIndex], kernels, image)) {
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                texture.upload(image);
+                char title[200];
+                snprintf(title, sizeof(title), "OpenGL - %s, %d x %d, loaded in %.1f ms with %s kernels",
+                         imagePaths[imageIndex].c_str(), image.width, image.height, ms, kernels.name);
+                glfwSetWindowTitle(window, title);
+                printf("%s\n", title + 9);
+            } else {
+                std::cerr << "Failed to load texture " << imagePaths[imageIndex] << std::endl;
+            }
+            reload = false;
+        }
+
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool nextKeyPressed = glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS;
+        if (nextKeyPressed && !nextKeyDown) {
+            imageIndex = (imageIndex + 1) % imagePaths.size();
+            reload = true;
+        }
+        nextKeyDown = nextKeyPressed;
+
+        bool kernelKeyPressed = glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS;
+        if (kernelKeyPressed && !kernelKeyDown) {
+            useSimd = !useSimd;
+            reload = true;
+        }
+        kernelKeyDown = kernelKeyPressed;
+
+        texture.render();
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    texture.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
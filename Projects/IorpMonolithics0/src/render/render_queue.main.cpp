@@ -0,0 +1,915 @@
+// render queue: draw packets sorted by a 64-bit key and issued with redundant state changes skipped
+// Renderers no longer bind their own program, vertex array and texture and draw on the spot. They submit
+// DrawPackets to a RenderQueue, and flush() issues the whole frame at once:
+//   - every packet gets a 64-bit sort key: pass first, then program, texture and vertex array, then depth
+//     (front to back). Passes that blend order-dependently put depth right after the pass instead (back to
+//     front), so state is only grouped among packets at the same depth.
+//   - issuing keeps a shadow of the GL state (program, vertex array, texture, blend state and each program's
+//     packet uniforms) and skips every call that would not change it
+//   - each flush counts the state changes it made, and replays the frame without GL to count what the other
+//     three modes (submission order, no elimination) would have cost
+// The scene is a raster cut into tiles, a hillshade multiplied over it from DEM tiles and three translucent
+// vector layers, submitted cell by cell the way a per-tile renderer draws. The "Render Queue" panel (ImGui,
+// drawn after the flush, outside the queue) switches sorting and elimination and shows the counts.
+// Usage: render_queue [image]   Keys: WASD pan, Q/E zoom, O toggles sorting, R toggles redundant-state elimination.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <imgui.h>
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_opengl3.h>
+
+#include <cstdio> // Include for printf
+
+// Raster cells (pixels of the image per cell); every layer of the scene uses the same grid
+const int tileSize = 64;
+
+// DEM texels per cell (plus a one-texel apron for the hillshade gradient) and vertical exaggeration
+const int demTileSize = 32;
+const float demExaggeration = 6.0f;
+const float shadeStrength = 0.6f;
+
+// Shapes per cell in each vector layer
+const int parcelsPerCell = 6;
+const int buildingsPerCell = 10;
+const int markersPerCell = 3;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    GLuint ubo = 0;
+};
+
+// Passes, in the order they are drawn
+enum class RenderPass : uint8_t { Opaque, Shade, Overlay };
+const int renderPassCount = 3;
+
+// Fixed-function state of a pass. depthOrdered passes blend in an order-dependent way, so their packets are
+// drawn back to front and state is only grouped among packets at the same depth.
+struct PassState {
+    const char* name;
+    bool blend;
+    GLenum sourceFactor, destinationFactor;
+    bool depthOrdered;
+};
+
+const PassState passStates[renderPassCount] = {
+    { "opaque", false, GL_ONE, GL_ZERO, false },
+    { "shade", true, GL_DST_COLOR, GL_ZERO, false },                      // multiply: any order gives the same result
+    { "overlay", true, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, true },
+};
+
+// One draw with everything it needs bound. Programs read their per-draw values from "uniform vec4
+// packetData[2]" and sample texture unit 0; texture 0 means the program samples nothing.
+struct DrawPacket {
+    RenderPass pass = RenderPass::Opaque;
+    GLuint program = 0;
+    GLuint vertexArray = 0;
+    GLuint texture = 0;
+    float depth = 0.0f;           // 0 = nearest, 1 = farthest
+    GLenum mode = GL_TRIANGLE_STRIP;
+    GLint first = 0;              // first vertex, or first index when indexed
+    GLsizei count = 0;
+    bool indexed = false;         // GL_UNSIGNED_INT indices from the vertex array's element buffer
+    glm::vec4 data[2];
+};
+
+// Collects a frame of draw packets and issues them sorted by key, with redundant state changes skipped.
+// Key layout, most significant bits first:
+//   state-sorted passes:  pass:4 | program:8 | texture:16 | vertex array:12 | depth:24 (front to back)
+//   depth-ordered passes: pass:4 | depth:24 (back to front) | program:8 | texture:16 | vertex array:12
+// Programs, textures and vertex arrays are numbered densely in order of first use. A number that overflows its
+// field wraps; that costs some grouping, never a wrong draw, since the packet itself carries the real objects.
+class RenderQueue {
+public:
+    struct Stats {
+        int packets = 0;
+        int draws = 0;
+        int programChanges = 0;
+        int vertexArrayChanges = 0;
+        int textureChanges = 0;
+        int blendChanges = 0;
+        int uniformUploads = 0;
+
+        int stateChanges() const {
+            return programChanges + vertexArrayChanges + textureChanges + blendChanges + uniformUploads;
+        }
+    };
+
+    bool sorted = true;
+    bool eliminateRedundant = true;
+
+    void submit(const DrawPacket& packet) {
+        m_entries.emplace_back(makeKey(packet), static_cast<uint32_t>(m_packets.size()));
+        m_packets.push_back(packet);
+    }
+
+    // Issues the frame in the current mode, counts what the other modes would have cost and empties the queue.
+    // The GL state is treated as unknown on entry: whatever ran since the last flush may have changed it.
+    void flush() {
+        m_submitted = m_entries;
+        std::sort(m_entries.begin(), m_entries.end());
+
+        for (int sortedMode = 0; sortedMode < 2; ++sortedMode)
+            for (int eliminateMode = 0; eliminateMode < 2; ++eliminateMode)
+                if (sortedMode != static_cast<int>(sorted) || eliminateMode != static_cast<int>(eliminateRedundant))
+                    m_modeStats[sortedMode][eliminateMode] = replay(sortedMode ? m_entries : m_submitted, eliminateMode != 0, false);
+
+        glActiveTexture(GL_TEXTURE0);
+        m_stats = replay(sorted ? m_entries : m_submitted, eliminateRedundant, true);
+        m_modeStats[sorted][eliminateRedundant] = m_stats;
+
+        m_packets.clear();
+        m_entries.clear();
+    }
+
+    // What the last flush did, and what each mode would have done with the same packets
+    const Stats& stats() const { return m_stats; }
+    const Stats& modeStats(bool sortedMode, bool eliminateMode) const { return m_modeStats[sortedMode][eliminateMode]; }
+
+private:
+    // (key, submission index): ties keep submission order
+    typedef std::pair<uint64_t, uint32_t> Entry;
+
+    struct ProgramSlot {
+        GLint dataLocation = -1;
+        glm::vec4 lastData[2];
+        bool dataValid = false;
+    };
+
+    std::vector<DrawPacket> m_packets;
+    std::vector<Entry> m_entries;
+    std::vector<Entry> m_submitted;
+    std::unordered_map<GLuint, uint32_t> m_programNumbers, m_textureNumbers, m_vertexArrayNumbers;
+    std::vector<ProgramSlot> m_programs;
+    Stats m_stats;
+    Stats m_modeStats[2][2];
+
+    static uint32_t numberOf(std::unordered_map<GLuint, uint32_t>& numbers, GLuint object) {
+        auto it = numbers.find(object);
+        if (it != numbers.end())
+            return it->second;
+        uint32_t number = static_cast<uint32_t>(numbers.size());
+        numbers.emplace(object, number);
+        return number;
+    }
+
+    uint32_t programNumber(GLuint program) {
+        auto it = m_programNumbers.find(program);
+        if (it != m_programNumbers.end())
+            return it->second;
+        uint32_t number = numberOf(m_programNumbers, program);
+        ProgramSlot slot;
+        slot.dataLocation = glGetUniformLocation(program, "packetData");
+        m_programs.push_back(slot);
+        return number;
+    }
+
+    uint64_t makeKey(const DrawPacket& packet) {
+        uint64_t pass = static_cast<uint64_t>(packet.pass) & 0xf;
+        uint64_t program = programNumber(packet.program) & 0xff;
+        uint64_t texture = numberOf(m_textureNumbers, packet.texture) & 0xffff;
+        uint64_t vertexArray = numberOf(m_vertexArrayNumbers, packet.vertexArray) & 0xfff;
+        uint64_t depth = static_cast<uint64_t>(std::max(0.0f, std::min(packet.depth, 1.0f)) * 0xffffff);
+        if (passStates[static_cast<int>(packet.pass)].depthOrdered)
+            return pass << 60 | (0xffffff - depth) << 36 | program << 28 | texture << 12 | vertexArray;
+        return pass << 60 | program << 52 | texture << 36 | vertexArray << 24 | depth;
+    }
+
+    // Walks the packets in the given order with a shadow of the GL state. Without elimination every packet
+    // binds everything, as a renderer that draws on the spot does. With issue false nothing reaches GL.
+    Stats replay(const std::vector<Entry>& order, bool eliminate, bool issue) {
+        Stats stats;
+        stats.packets = static_cast<int>(order.size());
+        const GLuint unknown = ~0u;
+        GLuint program = unknown, vertexArray = unknown, texture = unknown;
+        int blendPass = -1;
+        for (ProgramSlot& slot : m_programs)
+            slot.dataValid = false;
+
+        for (const Entry& entry : order) {
+            const DrawPacket& packet = m_packets[entry.second];
+            int pass = static_cast<int>(packet.pass);
+            const PassState& state = passStates[pass];
+
+            bool blendDiffers = blendPass < 0 || passStates[blendPass].blend != state.blend ||
+                                (state.blend && (passStates[blendPass].sourceFactor != state.sourceFactor ||
+                                                 passStates[blendPass].destinationFactor != state.destinationFactor));
+            if (!eliminate || blendDiffers) {
+                if (issue) {
+                    if (state.blend) {
+                        glEnable(GL_BLEND);
+                        glBlendFunc(state.sourceFactor, state.destinationFactor);
+                    } else {
+                        glDisable(GL_BLEND);
+                    }
+                }
+                blendPass = pass;
+                ++stats.blendChanges;
+            }
+
+            if (!eliminate || packet.program != program) {
+                if (issue)
+                    glUseProgram(packet.program);
+                program = packet.program;
+                ++stats.programChanges;
+            }
+
+            if (!eliminate || packet.vertexArray != vertexArray) {
+                if (issue)
+                    glBindVertexArray(packet.vertexArray);
+                vertexArray = packet.vertexArray;
+                ++stats.vertexArrayChanges;
+            }
+
+            // A packet that samples nothing leaves whatever texture is bound
+            if (!eliminate || (packet.texture != 0 && packet.texture != texture)) {
+                if (issue)
+                    glBindTexture(GL_TEXTURE_2D, packet.texture);
+                texture = packet.texture;
+                ++stats.textureChanges;
+            }
+
+            // Uniforms belong to the program object, so each program remembers the values it last received
+            ProgramSlot& slot = m_programs[m_programNumbers[packet.program]];
+            if (slot.dataLocation >= 0 &&
+                (!eliminate || !slot.dataValid || memcmp(slot.lastData, packet.data, sizeof(packet.data)) != 0)) {
+                if (issue)
+                    glUniform4fv(slot.dataLocation, 2, glm::value_ptr(packet.data[0]));
+                memcpy(slot.lastData, packet.data, sizeof(packet.data));
+                slot.dataValid = true;
+                ++stats.uniformUploads;
+            }
+
+            if (issue) {
+                if (packet.indexed)
+                    glDrawElements(packet.mode, packet.count, GL_UNSIGNED_INT, reinterpret_cast<const void*>(static_cast<uintptr_t>(packet.first) * sizeof(uint32_t)));
+                else
+                    glDrawArrays(packet.mode, packet.first, packet.count);
+            }
+            ++stats.draws;
+        }
+
+        if (issue)
+            glBindVertexArray(0);
+        return stats;
+    }
+};
+
+// The cells every layer of the scene is cut into: the image's tiles, with the tile pyramid's world mapping
+// (x spans [-1, 1], y spans [-h/w, h/w], row 0 at the top)
+struct CellGrid {
+    int width = 0, height = 0;      // image pixels
+    int cellsX = 0, cellsY = 0;
+
+    void init(int imageWidth, int imageHeight) {
+        width = imageWidth;
+        height = imageHeight;
+        cellsX = (width + tileSize - 1) / tileSize;
+        cellsY = (height + tileSize - 1) / tileSize;
+    }
+
+    int cellCount() const { return cellsX * cellsY; }
+
+    // World-space rectangle of a cell (min.x, min.y, max.x, max.y)
+    glm::vec4 cellRect(int cell) const {
+        int x = cell % cellsX, y = cell / cellsX;
+        float p = 2.0f / width;
+        float top = height * p * 0.5f;
+        int px0 = x * tileSize, py0 = y * tileSize;
+        int px1 = std::min(px0 + tileSize, width), py1 = std::min(py0 + tileSize, height);
+        return glm::vec4(px0 * p - 1.0f, top - py1 * p, px1 * p - 1.0f, top - py0 * p);
+    }
+
+    // Cells intersecting a world rectangle, row by row
+    void visibleCells(const glm::vec4& rect, std::vector<int>& cells) const {
+        cells.clear();
+        float p = 2.0f / width * tileSize;
+        float top = height * (2.0f / width) * 0.5f;
+        int x0 = std::max(0, static_cast<int>(std::floor((rect.x + 1.0f) / p)));
+        int x1 = std::min(cellsX - 1, static_cast<int>(std::floor((rect.z + 1.0f) / p)));
+        int y0 = std::max(0, static_cast<int>(std::floor((top - rect.w) / p)));
+        int y1 = std::min(cellsY - 1, static_cast<int>(std::floor((top - rect.y) / p)));
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x)
+                cells.push_back(y * cellsX + x);
+    }
+};
+
+// Quad corners come from gl_VertexID; shared by the raster and shade programs
+const char* cellVertexShaderSource = R"(
+uniform vec4 packetData[2];   // world x0, y0, x1, y1; then the program's own values
+
+out vec2 corner;
+
+void main()
+{
+    corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(packetData[0].xw, packetData[0].zy, corner), 0.0, 1.0);
+}
+)";
+
+// The image cut into one texture per cell
+class RasterLayer {
+public:
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 corner;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = vec4(texture(tex0, corner).rgb, 1.0);
+}
+)";
+    GLuint shaderProgram = 0;
+    GLuint VAO = 0;
+    bool visible = true;
+
+    bool init(Camera* camera, const std::string& imagePath, CellGrid& grid) {
+        int width, height, nrChannels;
+        unsigned char* data = stbi_load(imagePath.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha);
+        if (!data) {
+            std::cerr << "Failed to load texture" << std::endl;
+            return false;
+        }
+        grid.init(width, height);
+
+        std::vector<unsigned char> pixels;
+        m_textures.resize(grid.cellCount());
+        for (int cell = 0; cell < grid.cellCount(); ++cell) {
+            int x0 = (cell % grid.cellsX) * tileSize, y0 = (cell / grid.cellsX) * tileSize;
+            int w = std::min(tileSize, width - x0), h = std::min(tileSize, height - y0);
+            pixels.resize(static_cast<size_t>(w) * h * 4);
+            for (int row = 0; row < h; ++row)
+                memcpy(pixels.data() + static_cast<size_t>(row) * w * 4,
+                       data + (static_cast<size_t>(y0 + row) * width + x0) * 4, static_cast<size_t>(w) * 4);
+            m_textures[cell] = createTexture(w, h, GL_RGBA8, GL_RGBA, pixels.data());
+        }
+        stbi_image_free(data);
+
+        shaderProgram = createCameraShaderProgram(cellVertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        // Corners come from gl_VertexID; the VAO only has to exist
+        glGenVertexArrays(1, &VAO);
+        printf("Image size: %d x %d, %d x %d cells of %d pixels\n", width, height, grid.cellsX, grid.cellsY, tileSize);
+        return true;
+    }
+
+    void submit(const CellGrid& grid, int cell, RenderQueue& queue) const {
+        if (!visible)
+            return;
+        DrawPacket packet;
+        packet.pass = RenderPass::Opaque;
+        packet.program = shaderProgram;
+        packet.vertexArray = VAO;
+        packet.texture = m_textures[cell];
+        packet.count = 4;
+        packet.data[0] = grid.cellRect(cell);
+        queue.submit(packet);
+    }
+
+    void destroy() {
+        glDeleteTextures(static_cast<GLsizei>(m_textures.size()), m_textures.data());
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+    }
+
+    static GLuint createTexture(int width, int height, GLint internalFormat, GLenum format, const void* pixels) {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+        return texture;
+    }
+
+private:
+    std::vector<GLuint> m_textures;
+};
+
+// Smooth pseudo-random terrain: a few octaves of value noise over world coordinates
+float terrainHeight(float x, float y) {
+    auto lattice = [](int ix, int iy) {
+        uint32_t h = static_cast<uint32_t>(ix) * 374761393u + static_cast<uint32_t>(iy) * 668265263u;
+        h = (h ^ (h >> 13)) * 1274126177u;
+        return static_cast<float>((h ^ (h >> 16)) & 0xffff) / 65535.0f;
+    };
+    float height = 0.0f, amplitude = 0.5f, frequency = 4.0f;
+    for (int octave = 0; octave < 5; ++octave) {
+        float fx = x * frequency, fy = y * frequency;
+        int ix = static_cast<int>(std::floor(fx)), iy = static_cast<int>(std::floor(fy));
+        float tx = fx - ix, ty = fy - iy;
+        tx = tx * tx * (3.0f - 2.0f * tx);
+        ty = ty * ty * (3.0f - 2.0f * ty);
+        float top = lattice(ix, iy) + (lattice(ix + 1, iy) - lattice(ix, iy)) * tx;
+        float bottom = lattice(ix, iy + 1) + (lattice(ix + 1, iy + 1) - lattice(ix, iy + 1)) * tx;
+        height += amplitude * (top + (bottom - top) * ty);
+        amplitude *= 0.5f;
+        frequency *= 2.0f;
+    }
+    return height;
+}
+
+// Hillshade multiplied over the raster, computed in the fragment shader from one DEM texture per cell.
+// Each DEM tile carries a one-texel apron from its neighbours, so the gradient is continuous across cells.
+class TerrainShade {
+public:
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 corner;
+
+uniform sampler2D tex0;
+uniform vec4 packetData[2];   // tile rect; apron inset (uv), exaggeration, strength, unused
+
+void main()
+{
+    vec2 uv = mix(vec2(packetData[1].x), vec2(1.0 - packetData[1].x), corner);
+    vec2 texel = 1.0 / vec2(textureSize(tex0, 0));
+    float left = texture(tex0, uv - vec2(texel.x, 0.0)).r;
+    float right = texture(tex0, uv + vec2(texel.x, 0.0)).r;
+    float up = texture(tex0, uv - vec2(0.0, texel.y)).r;
+    float down = texture(tex0, uv + vec2(0.0, texel.y)).r;
+    vec3 normal = normalize(vec3((left - right) * packetData[1].y, (down - up) * packetData[1].y, 0.2));
+    float shade = max(dot(normal, normalize(vec3(-1.0, 1.0, 1.0))), 0.0);
+    FragColor = vec4(mix(vec3(1.0), vec3(shade * 1.4), packetData[1].z), 1.0);
+}
+)";
+    GLuint shaderProgram = 0;
+    GLuint VAO = 0;
+    bool visible = true;
+
+    void init(Camera* camera, const CellGrid& grid) {
+        int size = demTileSize + 2;
+        std::vector<unsigned char> heights(static_cast<size_t>(size) * size);
+        m_textures.resize(grid.cellCount());
+        for (int cell = 0; cell < grid.cellCount(); ++cell) {
+            glm::vec4 rect = grid.cellRect(cell);
+            float stepX = (rect.z - rect.x) / demTileSize, stepY = (rect.w - rect.y) / demTileSize;
+            for (int row = 0; row < size; ++row) {
+                for (int column = 0; column < size; ++column) {
+                    float x = rect.x + (column - 0.5f) * stepX;
+                    float y = rect.w - (row - 0.5f) * stepY;
+                    heights[static_cast<size_t>(row) * size + column] = static_cast<unsigned char>(std::min(255.0f, terrainHeight(x, y) * 255.0f));
+                }
+            }
+            m_textures[cell] = RasterLayer::createTexture(size, size, GL_R8, GL_RED, heights.data());
+        }
+
+        shaderProgram = createCameraShaderProgram(cellVertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        glGenVertexArrays(1, &VAO);
+    }
+
+    void submit(const CellGrid& grid, int cell, RenderQueue& queue) const {
+        if (!visible)
+            return;
+        DrawPacket packet;
+        packet.pass = RenderPass::Shade;
+        packet.program = shaderProgram;
+        packet.vertexArray = VAO;
+        packet.texture = m_textures[cell];
+        packet.count = 4;
+        packet.data[0] = grid.cellRect(cell);
+        packet.data[1] = glm::vec4(1.0f / (demTileSize + 2), demExaggeration, shadeStrength, 0.0f);
+        queue.submit(packet);
+    }
+
+    void destroy() {
+        glDeleteTextures(static_cast<GLsizei>(m_textures.size()), m_textures.data());
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+    }
+
+private:
+    std::vector<GLuint> m_textures;
+};
+
+// Translucent polygons of one vector layer in one vertex array, kept as one index range per cell
+class VectorLayer {
+public:
+    const char* vertexShaderSource = R"(
+layout (location = 0) in vec2 aPos;
+
+void main()
+{
+    gl_Position = viewProjection * vec4(aPos, 0.0, 1.0);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+uniform vec4 packetData[2];   // fill colour, unused
+
+void main()
+{
+    FragColor = packetData[0];
+}
+)";
+    std::string name;
+    glm::vec4 color;
+    float depth = 0.0f;
+    bool visible = true;
+    GLuint VAO = 0, VBO = 0, EBO = 0;
+
+    // shapesPerCell regular polygons with `sides` corners and a radius around `size` of a cell, per cell.
+    // All layers share one program; it is created by the first layer and passed to the others.
+    void init(Camera* camera, GLuint sharedProgram, const CellGrid& grid, const std::string& layerName, glm::vec4 fill,
+              float layerDepth, int shapesPerCell, int sides, float size, uint32_t seed) {
+        name = layerName;
+        color = fill;
+        depth = layerDepth;
+        m_program = sharedProgram;
+        if (m_program == 0) {
+            m_program = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+            camera->attachProgram(m_program);
+            m_ownsProgram = true;
+        }
+
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<glm::vec2> vertices;
+        std::vector<uint32_t> indices;
+        m_cellRanges.resize(grid.cellCount());
+        for (int cell = 0; cell < grid.cellCount(); ++cell) {
+            glm::vec4 rect = grid.cellRect(cell);
+            float extent = std::min(rect.z - rect.x, rect.w - rect.y);
+            m_cellRanges[cell].first = static_cast<GLint>(indices.size());
+            for (int shape = 0; shape < shapesPerCell; ++shape) {
+                float cx = rect.x + (rect.z - rect.x) * unit(random);
+                float cy = rect.y + (rect.w - rect.y) * unit(random);
+                float radius = extent * size * (0.5f + unit(random));
+                float rotation = unit(random) * 6.2831853f;
+                uint32_t center = static_cast<uint32_t>(vertices.size());
+                for (int corner = 0; corner < sides; ++corner) {
+                    float angle = rotation + 6.2831853f * corner / sides;
+                    vertices.push_back(glm::vec2(cx + radius * std::cos(angle), cy + radius * std::sin(angle)));
+                }
+                for (int corner = 1; corner + 1 < sides; ++corner) {
+                    indices.push_back(center);
+                    indices.push_back(center + corner);
+                    indices.push_back(center + corner + 1);
+                }
+            }
+            m_cellRanges[cell].second = static_cast<GLsizei>(indices.size()) - m_cellRanges[cell].first;
+        }
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+    }
+
+    GLuint program() const { return m_program; }
+
+    void submit(int cell, RenderQueue& queue) const {
+        if (!visible || m_cellRanges[cell].second == 0)
+            return;
+        DrawPacket packet;
+        packet.pass = RenderPass::Overlay;
+        packet.program = m_program;
+        packet.vertexArray = VAO;
+        packet.depth = depth;
+        packet.mode = GL_TRIANGLES;
+        packet.first = m_cellRanges[cell].first;
+        packet.count = m_cellRanges[cell].second;
+        packet.indexed = true;
+        packet.data[0] = color;
+        queue.submit(packet);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        if (m_ownsProgram)
+            glDeleteProgram(m_program);
+    }
+
+private:
+    GLuint m_program = 0;
+    bool m_ownsProgram = false;
+    std::vector<std::pair<GLint, GLsizei>> m_cellRanges;   // first index, index count
+};
+
+// "Render Queue" panel: the mode switches, the layers, and the state changes of the last frame in every mode
+void drawQueuePanel(RenderQueue& queue, RasterLayer& raster, TerrainShade& shade, std::vector<VectorLayer>& vectors) {
+    ImGui::Begin("Render Queue");
+    ImGui::Checkbox("sort by key", &queue.sorted);
+    ImGui::Checkbox("skip redundant state", &queue.eliminateRedundant);
+    ImGui::Separator();
+    ImGui::Checkbox("raster", &raster.visible);
+    ImGui::Checkbox("hillshade", &shade.visible);
+    for (VectorLayer& layer : vectors)
+        ImGui::Checkbox(layer.name.c_str(), &layer.visible);
+    ImGui::Separator();
+    ImGui::Text("%d packets", queue.stats().packets);
+    ImGui::Text("%-22s %6s %6s %6s %6s %6s %7s", "", "prog", "vao", "tex", "blend", "unif", "total");
+    for (int sortedMode = 1; sortedMode >= 0; --sortedMode) {
+        for (int eliminateMode = 1; eliminateMode >= 0; --eliminateMode) {
+            const RenderQueue::Stats& stats = queue.modeStats(sortedMode != 0, eliminateMode != 0);
+            char label[32];
+            snprintf(label, sizeof(label), "%s%s, %s", sortedMode == static_cast<int>(queue.sorted) && eliminateMode == static_cast<int>(queue.eliminateRedundant) ? "> " : "  ",
+                     sortedMode ? "sorted" : "submitted", eliminateMode ? "skipping" : "all");
+            ImGui::Text("%-22s %6d %6d %6d %6d %6d %7d", label, stats.programChanges, stats.vertexArrayChanges, stats.textureChanges,
+                        stats.blendChanges, stats.uniformUploads, stats.stateChanges());
+        }
+    }
+    ImGui::End();
+}
+
+int main(int argc, char** argv) {
+    std::string imagePath = argc > 1 ? argv[1] : "src/textures/assets/test_nb.png";
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    // No vsync, so the title shows what the frame really costs
+    glfwSwapInterval(0);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 330 core");
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    CellGrid grid;
+    RasterLayer raster;
+    if (!raster.init(&camera, imagePath, grid)) {
+        glfwTerminate();
+        return -1;
+    }
+    TerrainShade shade;
+    shade.init(&camera, grid);
+
+    // Back to front: parcels under buildings under markers
+    std::vector<VectorLayer> vectors(3);
+    vectors[0].init(&camera, 0, grid, "parcels", glm::vec4(0.9f, 0.6f, 0.2f, 0.35f), 0.9f, parcelsPerCell, 4, 0.25f, 11);
+    vectors[1].init(&camera, vectors[0].program(), grid, "buildings", glm::vec4(0.8f, 0.2f, 0.3f, 0.6f), 0.5f, buildingsPerCell, 4, 0.06f, 12);
+    vectors[2].init(&camera, vectors[0].program(), grid, "markers", glm::vec4(0.2f, 0.5f, 1.0f, 0.8f), 0.1f, markersPerCell, 6, 0.05f, 13);
+
+    RenderQueue queue;
+    std::vector<int> cells;
+    bool sortKeyDown = false, redundantKeyDown = false;
+    int frame = 0;
+    int framesSinceTitle = 0;
+    long long totalChanges = 0, totalPackets = 0;
+    double lastTitleTime = glfwGetTime();
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+        drawQueuePanel(queue, raster, shade, vectors);
+
+        // Keys go to the panel while one of its widgets has focus
+        if (!ImGui::GetIO().WantCaptureKeyboard) {
+            camera.processKeyboardInput(window);
+
+            bool sortKeyPressed = glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS;
+            if (sortKeyPressed && !sortKeyDown)
+                queue.sorted = !queue.sorted;
+            sortKeyDown = sortKeyPressed;
+
+            bool redundantKeyPressed = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+            if (redundantKeyPressed && !redundantKeyDown)
+                queue.eliminateRedundant = !queue.eliminateRedundant;
+            redundantKeyDown = redundantKeyPressed;
+        }
+
+        camera.publish(width, height);
+
+        // Cell by cell, every layer submits its part; the queue decides the order
+        grid.visibleCells(camera.getVisibleRect(), cells);
+        for (int cell : cells) {
+            raster.submit(grid, cell, queue);
+            shade.submit(grid, cell, queue);
+            for (const VectorLayer& layer : vectors)
+                layer.submit(cell, queue);
+        }
+        queue.flush();
+        totalChanges += queue.stats().stateChanges();
+        totalPackets += queue.stats().packets;
+
+        // ImGui sets and restores its own state; the next flush assumes nothing about what it left bound
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+        ++framesSinceTitle;
+        double now = glfwGetTime();
+        if (now - lastTitleTime > 0.5) {
+            const RenderQueue::Stats& stats = queue.stats();
+            char title[256];
+            snprintf(title, sizeof(title), "OpenGL - %s, %s | %d packets: %d programs, %d vertex arrays, %d textures, %d blend, %d uniforms | %.2f ms/frame",
+                     queue.sorted ? "sorted" : "submission order", queue.eliminateRedundant ? "redundant state skipped" : "all state set",
+                     stats.packets, stats.programChanges, stats.vertexArrayChanges, stats.textureChanges, stats.blendChanges,
+                     stats.uniformUploads, 1000.0 * (now - lastTitleTime) / framesSinceTitle);
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+            framesSinceTitle = 0;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    if (frame > 0)
+        printf("Frames: %d, per frame: %.1f packets, %.1f state changes\n", frame,
+               static_cast<double>(totalPackets) / frame, static_cast<double>(totalChanges) / frame);
+
+    for (VectorLayer& layer : vectors)
+        layer.destroy();
+    shade.destroy();
+    raster.destroy();
+    camera.destroy();
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,929 @@
+// continuous-LOD terrain (CDLOD) over a DEM cut into a pyramid of height tiles
+// The DEM is decimated into levels (every other sample, so a vertex shared by two levels reads the same
+// height from either) and cut into tiles of tileSize + 1 samples; each quadtree node is one tile of one
+// level. Every frame:
+//   - nodes are selected top down by distance: a node is split while the camera is within the range of
+//     the finer level, ranges doubling per level and derived from a screen-space error in pixels, so the
+//     triangle count follows what the screen can resolve and not the DEM resolution
+//   - nodes outside the view frustum (boxes from each tile's height range) are dropped during selection
+//   - all nodes draw the same grid mesh; the vertex shader reads heights from the node's R32F tile and
+//     morphs odd vertices onto the coarser grid as they approach the end of the node's range, so
+//     neighbouring levels meet without cracks and level changes do not pop
+//   - height tiles are uploaded on demand (nearest first, maxUploadsPerFrame per frame) and evicted
+//     least-recently-used; a node whose children are not resident yet draws their area itself
+// Without a DEM file a diamond-square terrain is generated. A single-band TIFF (8-bit unsigned, 16-bit integer
+// or 32-bit float) is read as elevations; any other image is read as grey levels scaled to --height-scale metres.
+// Usage: terrain_cdlod [dem] [--spacing metres] [--height-scale metres]
+// Keys: WASD move, Q/E down/up, arrows look, Shift faster, [ ] pixel error, X wireframe, M morphing.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <random>
+#include <filesystem>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <tiffio.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+// Height samples per tile edge (plus one shared with the next tile) and grid quads per node edge
+const int tileSize = 128;
+const int gridResolution = 64;
+
+// Generated terrain: 2^n + 1 samples per edge, metres between samples, height range in metres
+const int generatedSize = 4097;
+const float defaultSpacing = 30.0f;
+const float generatedHeight = 2500.0f;
+
+// Height tile cache budget (tiles) and upload throttle (tiles per frame)
+const size_t heightTileBudget = 1024;
+const int maxUploadsPerFrame = 16;
+
+// Largest allowed screen-space size of a grid quad (pixels), adjustable with [ and ]
+const float defaultPixelError = 4.0f;
+// Fraction of each level's range over which its vertices morph into the next level
+const float morphRatio = 0.3f;
+
+// Camera: vertical field of view (degrees) and clip planes (metres)
+const float fieldOfView = 60.0f;
+const float nearPlane = 5.0f;
+const float farPlane = 400000.0f;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 cameraPosition;  // world x, y (up), z, unused
+    vec4 viewport;        // x, y, width, height in pixels
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+// Identifies one height tile, which is also one quadtree node
+struct TileKey {
+    int level = 0, x = 0, y = 0;
+
+    uint64_t packed() const {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+    }
+    TileKey child(int index) const {
+        TileKey c;
+        c.level = level - 1;
+        c.x = x * 2 + (index & 1);
+        c.y = y * 2 + (index >> 1);
+        return c;
+    }
+};
+
+// Free-flying camera over the terrain; y is up, the DEM lies in the x-z plane
+class TerrainCamera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 cameraPosition;
+        glm::vec4 viewport;
+    };
+
+    glm::vec3 position = glm::vec3(0.0f);
+    float yaw = 0.0f;     // radians, 0 looks along +x
+    float pitch = -0.3f;  // radians, negative looks down
+
+    void processKeyboardInput(GLFWwindow* window, float dt) {
+        // Faster the higher above the ground, so both close-ups and continent-wide flights work
+        float speed = std::max(100.0f, std::fabs(position.y) * 0.5f) * dt;
+        if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+            speed *= 5.0f;
+        glm::vec3 forward(std::cos(yaw), 0.0f, std::sin(yaw));
+        glm::vec3 right(-std::sin(yaw), 0.0f, std::cos(yaw));
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            position += forward * speed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            position -= forward * speed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            position -= right * speed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            position += right * speed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            position.y -= speed;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            position.y += speed;
+
+        float turn = 1.2f * dt;
+        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+            yaw -= turn;
+        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+            yaw += turn;
+        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+            pitch = std::min(pitch + turn, 1.5f);
+        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+            pitch = std::max(pitch - turn, -1.5f);
+    }
+
+    glm::mat4 getViewProjection(int framebufferWidth, int framebufferHeight) const {
+        glm::vec3 direction(std::cos(pitch) * std::cos(yaw), std::sin(pitch), std::cos(pitch) * std::sin(yaw));
+        glm::mat4 view = glm::lookAt(position, position + direction, glm::vec3(0.0f, 1.0f, 0.0f));
+        float aspect = static_cast<float>(framebufferWidth) / std::max(framebufferHeight, 1);
+        return glm::perspective(glm::radians(fieldOfView), aspect, nearPlane, farPlane) * view;
+    }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getViewProjection(framebufferWidth, framebufferHeight);
+        data.cameraPosition = glm::vec4(position, 0.0f);
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    GLuint ubo = 0;
+};
+
+// Six planes (ax + by + cz + d >= 0 inside) taken from a view-projection matrix
+struct Frustum {
+    glm::vec4 planes[6];
+
+    explicit Frustum(const glm::mat4& m) {
+        for (int i = 0; i < 3; ++i) {
+            planes[i * 2] = glm::vec4(m[0][3] + m[0][i], m[1][3] + m[1][i], m[2][3] + m[2][i], m[3][3] + m[3][i]);
+            planes[i * 2 + 1] = glm::vec4(m[0][3] - m[0][i], m[1][3] - m[1][i], m[2][3] - m[2][i], m[3][3] - m[3][i]);
+        }
+    }
+
+    // False only if the box lies entirely outside one plane
+    bool intersects(const glm::vec3& boxMin, const glm::vec3& boxMax) const {
+        for (const glm::vec4& p : planes) {
+            glm::vec3 farthest(p.x >= 0.0f ? boxMax.x : boxMin.x, p.y >= 0.0f ? boxMax.y : boxMin.y, p.z >= 0.0f ? boxMax.z : boxMin.z);
+            if (p.x * farthest.x + p.y * farthest.y + p.z * farthest.z + p.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+};
+
+// Elevations of a DEM, row-major, metres
+struct HeightGrid {
+    int width = 0, height = 0;
+    std::vector<float> samples;
+
+    float at(int x, int y) const {
+        x = std::max(0, std::min(x, width - 1));
+        y = std::max(0, std::min(y, height - 1));
+        return samples[static_cast<size_t>(y) * width + x];
+    }
+};
+
+// Single-band TIFF as elevations; other images as grey levels scaled to heightScale
+bool loadDem(const std::string& path, float heightScale, HeightGrid& grid) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".tif" || extension == ".tiff") {
+        TIFF* tif = TIFFOpen(path.c_str(), "r");
+        if (!tif)
+            return false;
+        uint32_t width = 0, height = 0;
+        uint16_t samplesPerPixel = 1, bitsPerSample = 8, sampleFormat = SAMPLEFORMAT_UINT;
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bitsPerSample);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLEFORMAT, &sampleFormat);
+        bool supportedSamples = (bitsPerSample == 32 && sampleFormat == SAMPLEFORMAT_IEEEFP) ||
+                                (bitsPerSample == 16 && (sampleFormat == SAMPLEFORMAT_INT || sampleFormat == SAMPLEFORMAT_UINT)) ||
+                                (bitsPerSample == 8 && sampleFormat == SAMPLEFORMAT_UINT);
+        if (samplesPerPixel == 1 && !TIFFIsTiled(tif) && supportedSamples) {
+            grid.width = static_cast<int>(width);
+            grid.height = static_cast<int>(height);
+            grid.samples.resize(static_cast<size_t>(width) * height);
+            std::vector<unsigned char> row(TIFFScanlineSize(tif));
+            for (uint32_t y = 0; y < height; ++y) {
+                if (TIFFReadScanline(tif, row.data(), y, 0) < 0) {
+                    TIFFClose(tif);
+                    return false;
+                }
+                float* out = grid.samples.data() + static_cast<size_t>(y) * width;
+                for (uint32_t x = 0; x < width; ++x) {
+                    if (bitsPerSample == 32 && sampleFormat == SAMPLEFORMAT_IEEEFP)
+                        memcpy(&out[x], &row[x * 4], 4);
+                    else if (bitsPerSample == 16 && sampleFormat == SAMPLEFORMAT_INT)
+                        out[x] = reinterpret_cast<const int16_t*>(row.data())[x];
+                    else if (bitsPerSample == 16)
+                        out[x] = reinterpret_cast<const uint16_t*>(row.data())[x];
+                    else
+                        out[x] = row[x] * heightScale / 255.0f;
+                }
+            }
+            TIFFClose(tif);
+            printf("DEM %s: %u x %u, %u-bit %s elevations\n", path.c_str(), width, height, bitsPerSample,
+                   sampleFormat == SAMPLEFORMAT_IEEEFP ? "float" : "integer");
+            return true;
+        }
+        TIFFClose(tif);
+        std::cerr << "DEM TIFF must be single-band, stripped, and 8-bit unsigned, 16-bit integer or 32-bit float: " << path << std::endl;
+        return false;
+    }
+
+    int width, height, nrChannels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, STBI_grey);
+    if (!data)
+        return false;
+    grid.width = width;
+    grid.height = height;
+    grid.samples.resize(static_cast<size_t>(width) * height);
+    for (size_t i = 0; i < grid.samples.size(); ++i)
+        grid.samples[i] = data[i] * heightScale / 255.0f;
+    stbi_image_free(data);
+    printf("DEM %s: %d x %d grey levels, 0 to %.0f m\n", path.c_str(), width, height, heightScale);
+    return true;
+}
+
+// Diamond-square fractal terrain of size x size samples (size = 2^n + 1)
+void generateDem(int size, float heightRange, HeightGrid& grid) {
+    grid.width = grid.height = size;
+    grid.samples.assign(static_cast<size_t>(size) * size, 0.0f);
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+    auto at = [&](int x, int y) -> float& { return grid.samples[static_cast<size_t>(y) * size + x]; };
+
+    float amplitude = heightRange;
+    for (int step = size - 1; step > 1; step /= 2, amplitude *= 0.52f) {
+        int half = step / 2;
+        for (int y = half; y < size; y += step)
+            for (int x = half; x < size; x += step)
+                at(x, y) = (at(x - half, y - half) + at(x + half, y - half) + at(x - half, y + half) + at(x + half, y + half)) * 0.25f +
+                           offset(random) * amplitude;
+        for (int y = 0; y < size; y += half) {
+            for (int x = (y / half) % 2 == 0 ? half : 0; x < size; x += step) {
+                float sum = 0.0f;
+                int count = 0;
+                if (x >= half) { sum += at(x - half, y); ++count; }
+                if (x + half < size) { sum += at(x + half, y); ++count; }
+                if (y >= half) { sum += at(x, y - half); ++count; }
+                if (y + half < size) { sum += at(x, y + half); ++count; }
+                at(x, y) = sum / count + offset(random) * amplitude;
+            }
+        }
+    }
+    // Sea level at the lowest point
+    float lowest = *std::min_element(grid.samples.begin(), grid.samples.end());
+    for (float& sample : grid.samples)
+        sample -= lowest;
+    printf("Generated DEM: %d x %d (diamond-square)\n", size, size);
+}
+
+// The DEM and its decimated levels, cut into tiles of tileSize + 1 samples. Level l keeps every 2^l-th
+// sample of level 0, so heights on a coarse vertex are exact at every finer level too.
+class HeightPyramid {
+public:
+    void build(HeightGrid&& base, float spacing) {
+        m_spacing = spacing;
+        m_levels.clear();
+        m_levels.push_back(std::move(base));
+        while (m_levels.back().width > tileSize + 1 || m_levels.back().height > tileSize + 1) {
+            const HeightGrid& finer = m_levels.back();
+            HeightGrid coarser;
+            // Odd sizes keep their last sample; even sizes gain one clamped sample past the edge
+            coarser.width = finer.width / 2 + 1;
+            coarser.height = finer.height / 2 + 1;
+            coarser.samples.resize(static_cast<size_t>(coarser.width) * coarser.height);
+            for (int y = 0; y < coarser.height; ++y)
+                for (int x = 0; x < coarser.width; ++x)
+                    coarser.samples[static_cast<size_t>(y) * coarser.width + x] = finer.at(x * 2, y * 2);
+            m_levels.push_back(std::move(coarser));
+        }
+
+        // Height range of every tile, for the node boxes
+        m_ranges.resize(m_levels.size());
+        for (int level = 0; level < levelCount(); ++level) {
+            m_ranges[level].resize(static_cast<size_t>(tilesX(level)) * tilesY(level));
+            for (int ty = 0; ty < tilesY(level); ++ty) {
+                for (int tx = 0; tx < tilesX(level); ++tx) {
+                    glm::vec2 range(1e30f, -1e30f);
+                    for (int y = ty * tileSize; y <= std::min((ty + 1) * tileSize, levelHeight(level) - 1); ++y) {
+                        for (int x = tx * tileSize; x <= std::min((tx + 1) * tileSize, levelWidth(level) - 1); ++x) {
+                            float h = m_levels[level].at(x, y);
+                            range.x = std::min(range.x, h);
+                            range.y = std::max(range.y, h);
+                        }
+                    }
+                    m_ranges[level][static_cast<size_t>(ty) * tilesX(level) + tx] = range;
+                }
+            }
+        }
+        printf("Height pyramid: %d levels, %d x %d top tiles, spacing %.1f m, %.0f x %.0f km\n", levelCount(),
+               tilesX(levelCount() - 1), tilesY(levelCount() - 1), spacing,
+               (levelWidth(0) - 1) * spacing / 1000.0f, (levelHeight(0) - 1) * spacing / 1000.0f);
+    }
+
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    int levelWidth(int level) const { return m_levels[level].width; }
+    int levelHeight(int level) const { return m_levels[level].height; }
+    int tilesX(int level) const { return std::max(1, (levelWidth(level) - 1 + tileSize - 1) / tileSize); }
+    int tilesY(int level) const { return std::max(1, (levelHeight(level) - 1 + tileSize - 1) / tileSize); }
+    float spacing() const { return m_spacing; }
+
+    bool isValid(const TileKey& key) const {
+        return key.level >= 0 && key.level < levelCount() &&
+               key.x >= 0 && key.x < tilesX(key.level) && key.y >= 0 && key.y < tilesY(key.level);
+    }
+
+    // World size of a node's edge at a level (metres)
+    float nodeSize(int level) const { return tileSize * m_spacing * static_cast<float>(1 << level); }
+
+    // World-space box of a node: x-z from its footprint (clipped to the DEM), y from its tile's heights
+    void nodeBox(const TileKey& key, glm::vec3& boxMin, glm::vec3& boxMax) const {
+        float size = nodeSize(key.level);
+        float maxX = (levelWidth(0) - 1) * m_spacing, maxZ = (levelHeight(0) - 1) * m_spacing;
+        glm::vec2 range = m_ranges[key.level][static_cast<size_t>(key.y) * tilesX(key.level) + key.x];
+        boxMin = glm::vec3(key.x * size, range.x, key.y * size);
+        boxMax = glm::vec3(std::min((key.x + 1) * size, maxX), range.y, std::min((key.y + 1) * size, maxZ));
+    }
+
+    // Heights of one tile, tileSize + 1 samples square, edge samples repeated past the DEM border
+    void readTile(const TileKey& key, std::vector<float>& heights) const {
+        const HeightGrid& level = m_levels[key.level];
+        heights.resize(static_cast<size_t>(tileSize + 1) * (tileSize + 1));
+        for (int y = 0; y <= tileSize; ++y)
+            for (int x = 0; x <= tileSize; ++x)
+                heights[static_cast<size_t>(y) * (tileSize + 1) + x] = level.at(key.x * tileSize + x, key.y * tileSize + y);
+    }
+
+    // Height at a world position (nearest sample of level 0)
+    float heightAt(float worldX, float worldZ) const {
+        return m_levels[0].at(static_cast<int>(std::lround(worldX / m_spacing)), static_cast<int>(std::lround(worldZ / m_spacing)));
+    }
+
+private:
+    std::vector<HeightGrid> m_levels;
+    std::vector<std::vector<glm::vec2>> m_ranges;   // per level and tile: lowest, highest
+    float m_spacing = 1.0f;
+};
+
+// GPU-resident height tiles (R32F), evicted least-recently-used once over budget
+class HeightTileCache {
+public:
+    struct Entry {
+        GLuint texture = 0;
+        int lastUsedFrame = 0;
+    };
+
+    void upload(const TileKey& key, const std::vector<float>& heights, int frame) {
+        Entry entry;
+        entry.lastUsedFrame = frame;
+        glGenTextures(1, &entry.texture);
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, tileSize + 1, tileSize + 1, 0, GL_RED, GL_FLOAT, heights.data());
+
+        m_entries[key.packed()] = entry;
+        ++m_uploads;
+    }
+
+    Entry* find(const TileKey& key) {
+        auto it = m_entries.find(key.packed());
+        return it == m_entries.end() ? nullptr : &it->second;
+    }
+
+    void evict(int currentFrame) {
+        if (m_entries.size() <= heightTileBudget)
+            return;
+        std::vector<std::pair<int, uint64_t>> candidates;
+        for (const auto& item : m_entries)
+            if (item.second.lastUsedFrame < currentFrame)
+                candidates.emplace_back(item.second.lastUsedFrame, item.first);
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& candidate : candidates) {
+            if (m_entries.size() <= heightTileBudget)
+                break;
+            glDeleteTextures(1, &m_entries[candidate.second].texture);
+            m_entries.erase(candidate.second);
+        }
+    }
+
+    size_t size() const { return m_entries.size(); }
+    int getUploads() const { return m_uploads; }
+
+    void destroy() {
+        for (auto& item : m_entries)
+            glDeleteTextures(1, &item.second.texture);
+        m_entries.clear();
+    }
+
+private:
+    std::unordered_map<uint64_t, Entry> m_entries;
+    int m_uploads = 0;
+};
+
+// One node picked for drawing: the whole node, or some of its quadrants (bit i = child i) when only those
+// children are out of their own range or not resident yet
+struct SelectedNode {
+    TileKey key;
+    GLuint texture = 0;
+    int quadrants = 0xF;
+};
+
+// CDLOD quadtree selection. Level l is used up to distance ranges[l] from the camera; a node is split when
+// part of it lies within ranges[l - 1]. ranges[0] keeps a grid quad below pixelError pixels on screen, and
+// ranges double per level like the quad size does.
+class TerrainSelector {
+public:
+    float pixelError = defaultPixelError;
+    std::vector<float> ranges;
+
+    // Nodes wanted but not resident, coarsest and nearest first
+    std::vector<std::pair<float, TileKey>> missing;
+    int culled = 0;
+
+    void updateRanges(const HeightPyramid& pyramid, int framebufferHeight) {
+        float pixelsPerRadian = framebufferHeight / (2.0f * std::tan(glm::radians(fieldOfView) * 0.5f));
+        float quadSize0 = pyramid.nodeSize(0) / gridResolution;
+        // Within ranges[0] a level-0 quad is at least pixelError pixels. A level l+1 node next to a level l node
+        // has vertices up to ranges[l] + a level-l node diagonal from the camera, and those must not have started
+        // morphing yet, or the two sides of the edge disagree and crack: morphing starts at
+        // (2 - morphRatio) * ranges[l], so ranges[l] >= diagonal / (1 - morphRatio). It also keeps neighbouring
+        // nodes at most one level apart.
+        float minimumRange0 = pyramid.nodeSize(0) * std::sqrt(2.0f) / (1.0f - morphRatio);
+        float range0 = std::max(quadSize0 * pixelsPerRadian / pixelError, minimumRange0);
+        ranges.resize(pyramid.levelCount());
+        for (int level = 0; level < pyramid.levelCount(); ++level)
+            ranges[level] = range0 * static_cast<float>(1 << level);
+        ranges.back() = farPlane;
+    }
+
+    void select(const HeightPyramid& pyramid, HeightTileCache& cache, const glm::vec3& eye, const Frustum& frustum,
+                int frame, std::vector<SelectedNode>& selected) {
+        selected.clear();
+        missing.clear();
+        culled = 0;
+        int top = pyramid.levelCount() - 1;
+        for (int y = 0; y < pyramid.tilesY(top); ++y) {
+            for (int x = 0; x < pyramid.tilesX(top); ++x) {
+                TileKey key;
+                key.level = top;
+                key.x = x;
+                key.y = y;
+                selectNode(pyramid, cache, key, eye, frustum, frame, selected);
+            }
+        }
+        std::sort(missing.begin(), missing.end(),
+                  [](const std::pair<float, TileKey>& a, const std::pair<float, TileKey>& b) { return a.first < b.first; });
+    }
+
+private:
+    static float distanceToBox(const glm::vec3& p, const glm::vec3& boxMin, const glm::vec3& boxMax) {
+        glm::vec3 d(std::max(std::max(boxMin.x - p.x, 0.0f), p.x - boxMax.x),
+                    std::max(std::max(boxMin.y - p.y, 0.0f), p.y - boxMax.y),
+                    std::max(std::max(boxMin.z - p.z, 0.0f), p.z - boxMax.z));
+        return std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+    }
+
+    // Returns false if the node lies beyond its level's range, so the parent has to cover its area
+    bool selectNode(const HeightPyramid& pyramid, HeightTileCache& cache, const TileKey& key, const glm::vec3& eye,
+                    const Frustum& frustum, int frame, std::vector<SelectedNode>& selected) {
+        glm::vec3 boxMin, boxMax;
+        pyramid.nodeBox(key, boxMin, boxMax);
+        float distance = distanceToBox(eye, boxMin, boxMax);
+        if (distance > ranges[key.level])
+            return false;
+        if (!frustum.intersects(boxMin, boxMax)) {
+            ++culled;
+            return true;   // handled: nothing of it is visible
+        }
+
+        HeightTileCache::Entry* entry = cache.find(key);
+        if (!entry) {
+            missing.emplace_back(key.level * -1e9f + distance, key);
+            return true;   // the parent draws this area meanwhile; with no parent it stays empty
+        }
+        entry->lastUsedFrame = frame;
+
+        SelectedNode node;
+        node.key = key;
+        node.texture = entry->texture;
+        if (key.level > 0 && distance <= ranges[key.level - 1]) {
+            node.quadrants = 0;
+            for (int i = 0; i < 4; ++i) {
+                TileKey child = key.child(i);
+                if (!pyramid.isValid(child))
+                    continue;
+                bool childResident = cache.find(child) != nullptr;
+                if (!childResident || !selectNode(pyramid, cache, child, eye, frustum, frame, selected)) {
+                    if (!childResident) {
+                        glm::vec3 childMin, childMax;
+                        pyramid.nodeBox(child, childMin, childMax);
+                        missing.emplace_back(child.level * -1e9f + distanceToBox(eye, childMin, childMax), child);
+                    }
+                    node.quadrants |= 1 << i;
+                }
+            }
+            if (node.quadrants == 0)
+                return true;
+        }
+        selected.push_back(node);
+        return true;
+    }
+};
+
+// Draws selected nodes with one shared grid mesh; heights come from each node's tile in the vertex shader
+class TerrainRenderer {
+public:
+    const char* vertexShaderSource = R"(
+layout (location = 0) in vec2 gridPosition;   // integer grid coordinates, 0 to gridResolution
+
+uniform sampler2D heights;
+uniform vec2 nodeOrigin;    // world x, z of the node's corner
+uniform float quadSize;     // world size of one grid quad at the node's level
+uniform vec2 morphRange;    // distances where morphing into the coarser level starts and ends
+uniform float samplesPerQuad;
+uniform float tileSamples;  // samples per tile edge, tileSize + 1
+
+out vec3 worldPosition;
+out vec3 normal;
+
+float heightAt(vec2 grid)
+{
+    return textureLod(heights, (grid * samplesPerQuad + 0.5) / tileSamples, 0.0).r;
+}
+
+void main()
+{
+    vec2 world = nodeOrigin + gridPosition * quadSize;
+    float height = heightAt(gridPosition);
+    float distance = length(vec3(world.x, height, world.y) - cameraPosition.xyz);
+    float morph = clamp((distance - morphRange.x) / (morphRange.y - morphRange.x), 0.0, 1.0);
+
+    // Odd vertices slide onto their even neighbour, which turns this grid into the coarser level's
+    vec2 grid = gridPosition - mod(gridPosition, 2.0) * morph;
+    world = nodeOrigin + grid * quadSize;
+    height = heightAt(grid);
+
+    float dx = heightAt(grid + vec2(1.0, 0.0)) - heightAt(grid - vec2(1.0, 0.0));
+    float dz = heightAt(grid + vec2(0.0, 1.0)) - heightAt(grid - vec2(0.0, 1.0));
+    normal = normalize(vec3(-dx, 2.0 * quadSize, -dz));
+    worldPosition = vec3(world.x, height, world.y);
+    gl_Position = viewProjection * vec4(worldPosition, 1.0);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec3 worldPosition;
+in vec3 normal;
+
+uniform vec2 heightRange;   // lowest, highest elevation of the DEM
+
+void main()
+{
+    float t = clamp((worldPosition.y - heightRange.x) / max(heightRange.y - heightRange.x, 1.0), 0.0, 1.0);
+    vec3 low = vec3(0.22, 0.42, 0.20), mid = vec3(0.52, 0.45, 0.33), high = vec3(0.95, 0.95, 0.97);
+    vec3 albedo = t < 0.6 ? mix(low, mid, t / 0.6) : mix(mid, high, (t - 0.6) / 0.4);
+    vec3 sun = normalize(vec3(0.5, 0.7, 0.3));
+    float light = 0.25 + 0.75 * max(dot(normalize(normal), sun), 0.0);
+    FragColor = vec4(albedo * light, 1.0);
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO, VBO, EBO;
+    GLint nodeOriginLoc, quadSizeLoc, morphRangeLoc, samplesPerQuadLoc, tileSamplesLoc, heightRangeLoc;
+    bool morphing = true;
+    int triangles = 0;
+
+    void init(TerrainCamera* camera) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        nodeOriginLoc = glGetUniformLocation(shaderProgram, "nodeOrigin");
+        quadSizeLoc = glGetUniformLocation(shaderProgram, "quadSize");
+        morphRangeLoc = glGetUniformLocation(shaderProgram, "morphRange");
+        samplesPerQuadLoc = glGetUniformLocation(shaderProgram, "samplesPerQuad");
+        tileSamplesLoc = glGetUniformLocation(shaderProgram, "tileSamples");
+        heightRangeLoc = glGetUniformLocation(shaderProgram, "heightRange");
+
+        // Grid vertices, then triangles grouped by quadrant so a quadrant is one contiguous index range
+        std::vector<float> vertices;
+        for (int y = 0; y <= gridResolution; ++y) {
+            for (int x = 0; x <= gridResolution; ++x) {
+                vertices.push_back(static_cast<float>(x));
+                vertices.push_back(static_cast<float>(y));
+            }
+        }
+        std::vector<GLuint> indices;
+        int half = gridResolution / 2;
+        for (int quadrant = 0; quadrant < 4; ++quadrant) {
+            int x0 = (quadrant & 1) * half, y0 = (quadrant >> 1) * half;
+            for (int y = y0; y < y0 + half; ++y) {
+                for (int x = x0; x < x0 + half; ++x) {
+                    GLuint i = static_cast<GLuint>(y * (gridResolution + 1) + x);
+                    GLuint below = i + gridResolution + 1;
+                    indices.insert(indices.end(), { i, below, i + 1, i + 1, below, below + 1 });
+                }
+            }
+        }
+        m_quadrantIndices = static_cast<int>(indices.size() / 4);
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+    }
+
+    void render(const HeightPyramid& pyramid, const TerrainSelector& selector, const std::vector<SelectedNode>& nodes,
+                const glm::vec2& heightRange) {
+        triangles = 0;
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        glActiveTexture(GL_TEXTURE0);
+        glUniform1f(samplesPerQuadLoc, static_cast<float>(tileSize) / gridResolution);
+        glUniform1f(tileSamplesLoc, static_cast<float>(tileSize + 1));
+        glUniform2f(heightRangeLoc, heightRange.x, heightRange.y);
+        for (const SelectedNode& node : nodes) {
+            int level = node.key.level;
+            float size = pyramid.nodeSize(level);
+            float rangeEnd = selector.ranges[level];
+            float rangeStart = level > 0 ? selector.ranges[level - 1] : 0.0f;
+            float morphStart = rangeEnd - (rangeEnd - rangeStart) * morphRatio;
+
+            glBindTexture(GL_TEXTURE_2D, node.texture);
+            glUniform2f(nodeOriginLoc, node.key.x * size, node.key.y * size);
+            glUniform1f(quadSizeLoc, size / gridResolution);
+            // Morphing off: a range nothing reaches
+            if (morphing)
+                glUniform2f(morphRangeLoc, morphStart, rangeEnd);
+            else
+                glUniform2f(morphRangeLoc, 2.0f * farPlane, 3.0f * farPlane);
+
+            if (node.quadrants == 0xF) {
+                glDrawElements(GL_TRIANGLES, 4 * m_quadrantIndices, GL_UNSIGNED_INT, (void*)0);
+                triangles += 4 * m_quadrantIndices / 3;
+                continue;
+            }
+            for (int i = 0; i < 4; ++i) {
+                if (!(node.quadrants & (1 << i)))
+                    continue;
+                glDrawElements(GL_TRIANGLES, m_quadrantIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_quadrantIndices * i));
+                triangles += m_quadrantIndices / 3;
+            }
+        }
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        glDeleteProgram(shaderProgram);
+    }
+
+private:
+    int m_quadrantIndices = 0;
+};
+
+int main(int argc, char** argv) {
+    std::string demPath;
+    float spacing = defaultSpacing;
+    float heightScale = 1000.0f;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--spacing" && i + 1 < argc)
+            spacing = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--height-scale" && i + 1 < argc)
+            heightScale = static_cast<float>(std::atof(argv[++i]));
+        else
+            demPath = arg;
+    }
+
+    HeightGrid dem;
+    if (demPath.empty()) {
+        generateDem(generatedSize, generatedHeight, dem);
+    } else if (!loadDem(demPath, heightScale, dem)) {
+        std::cerr << "Failed to load DEM " << demPath << std::endl;
+        return -1;
+    }
+    auto extremes = std::minmax_element(dem.samples.begin(), dem.samples.end());
+    glm::vec2 heightRange(*extremes.first, *extremes.second);
+    HeightPyramid pyramid;
+    pyramid.build(std::move(dem), spacing);
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(1200, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glFrontFace(GL_CCW);
+
+    // Start over the middle of the DEM, above its highest point, looking across it
+    TerrainCamera camera;
+    float extentX = (pyramid.levelWidth(0) - 1) * spacing, extentZ = (pyramid.levelHeight(0) - 1) * spacing;
+    camera.position = glm::vec3(extentX * 0.5f, heightRange.y + 0.05f * std::max(extentX, extentZ), extentZ * 0.1f);
+    camera.yaw = glm::radians(90.0f);
+    camera.initUniformBuffer();
+
+    HeightTileCache cache;
+    TerrainSelector selector;
+    TerrainRenderer renderer;
+    renderer.init(&camera);
+
+    std::vector<SelectedNode> selected;
+    std::vector<float> heights;
+    bool wireframeKeyDown = false, morphKeyDown = false, errorDownKeyDown = false, errorUpKeyDown = false;
+    bool wireframe = false;
+    int frame = 0;
+    long long totalTriangles = 0;
+    int maxTriangles = 0;
+    double lastTime = glfwGetTime();
+    double lastTitleTime = lastTime;
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClearColor(0.55f, 0.70f, 0.90f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        double now = glfwGetTime();
+        camera.processKeyboardInput(window, static_cast<float>(now - lastTime));
+        lastTime = now;
+        // Keep the camera above the ground
+        camera.position.y = std::max(camera.position.y, pyramid.heightAt(camera.position.x, camera.position.z) + 2.0f * nearPlane);
+
+        bool wireframeKeyPressed = glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS;
+        if (wireframeKeyPressed && !wireframeKeyDown)
+            wireframe = !wireframe;
+        wireframeKeyDown = wireframeKeyPressed;
+
+        bool morphKeyPressed = glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS;
+        if (morphKeyPressed && !morphKeyDown)
+            renderer.morphing = !renderer.morphing;
+        morphKeyDown = morphKeyPressed;
+
+        // [ ]: finer or coarser screen-space error
+        bool errorDownKeyPressed = glfwGetKey(window, GLFW_KEY_LEFT_BRACKET) == GLFW_PRESS;
+        if (errorDownKeyPressed && !errorDownKeyDown)
+            selector.pixelError = std::max(0.5f, selector.pixelError * 0.5f);
+        errorDownKeyDown = errorDownKeyPressed;
+        bool errorUpKeyPressed = glfwGetKey(window, GLFW_KEY_RIGHT_BRACKET) == GLFW_PRESS;
+        if (errorUpKeyPressed && !errorUpKeyDown)
+            selector.pixelError = std::min(64.0f, selector.pixelError * 2.0f);
+        errorUpKeyDown = errorUpKeyPressed;
+
+        Frustum frustum(camera.getViewProjection(width, height));
+        selector.updateRanges(pyramid, height);
+        selector.select(pyramid, cache, camera.position, frustum, frame, selected);
+
+        // Missing tiles come in coarsest and nearest first; the selection uses them from the next frame on
+        int uploads = 0;
+        for (const auto& request : selector.missing) {
+            if (uploads == maxUploadsPerFrame)
+                break;
+            if (cache.find(request.second))
+                continue;
+            pyramid.readTile(request.second, heights);
+            cache.upload(request.second, heights, frame);
+            ++uploads;
+        }
+
+        camera.publish(width, height);
+        glPolygonMode(GL_FRONT_AND_BACK, wireframe ? GL_LINE : GL_FILL);
+        renderer.render(pyramid, selector, selected, heightRange);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        cache.evict(frame);
+        totalTriangles += renderer.triangles;
+        maxTriangles = std::max(maxTriangles, renderer.triangles);
+
+        if (now - lastTitleTime > 0.5) {
+            char title[256];
+            snprintf(title, sizeof(title), "OpenGL - %zu nodes, %d culled, %.2fM triangles | pixel error %.1f, morphing %s | %zu height tiles resident, %zu missing",
+                     selected.size(), selector.culled, renderer.triangles / 1e6, selector.pixelError, renderer.morphing ? "on" : "off",
+                     cache.size(), selector.missing.size());
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    if (frame > 0)
+        printf("Triangles per frame: %.0f average, %d peak; DEM level 0 would be %.1fM\n", static_cast<double>(totalTriangles) / frame,
+               maxTriangles, 2.0 * (pyramid.levelWidth(0) - 1) * (pyramid.levelHeight(0) - 1) / 1e6);
+    printf("Height tile uploads: %d\n", cache.getUploads());
+
+    renderer.destroy();
+    cache.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,1490 @@
+// hillshade, slope and aspect computed from DEM tiles by vectorized kernels on all cores
+// The DEM is kept as a pyramid of elevation levels cut into tiles. Derived products are made in two steps:
+//   - gradients: Horn's 3x3 operator over each tile plus a one-sample halo read from the neighbouring tiles
+//     (edge samples repeated at the DEM border), so products are continuous across tile seams. Gradients do
+//     not depend on any display parameter and are cached per tile on the CPU.
+//   - products: hillshade (sun azimuth, altitude, z-factor), slope (z-factor) and aspect are evaluated from
+//     the cached gradients into 8-bit tiles and cached on the GPU per (tile, parameters), with the sun angles
+//     rounded to sunStepDegrees so nearby settings share results.
+// Both steps run as scalar / SSE2 / AVX2 / NEON kernels (the widest one the CPU supports), parallelized
+// across tiles. Only visible tiles are computed, at most maxTilesPerFrame per frame; until a visible tile has
+// its product for the current parameters, the most recent one it has is drawn instead. Turning the sun only
+// re-runs the shading step on the visible tiles, which takes a few milliseconds per frame.
+// Usage: terrain_hillshade [dem] [--spacing metres] [--height-scale metres]
+//        terrain_hillshade --benchmark [dem]   Mpx/s of each kernel set on one thread and on all threads
+// Keys: WASD pan, Q/E zoom, 1-3 hillshade / slope / aspect, arrows sun azimuth / altitude, R rotate the sun,
+//       [ ] z-factor, K cycle kernel set.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <random>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <tiffio.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+// Samples per tile edge
+const int tileSize = 256;
+
+// Level of Detail (LOD) bias, typically in the range -0.5 to 0.5
+const float lodBias = 0.0f;
+
+// Generated terrain: 2^n + 1 samples per edge, metres between samples, height range in metres
+const int generatedSize = 4097;
+const float defaultSpacing = 30.0f;
+const float generatedHeight = 2500.0f;
+
+// Compute threads; 0 uses one per hardware thread
+const int computeThreadCount = 0;
+// Visible tiles computed per frame at most
+const int maxTilesPerFrame = 48;
+
+// CPU gradient cache budget and GPU product cache budget (tiles)
+const size_t gradientTileBudget = 256;
+const size_t productTileBudget = 768;
+
+// Sun angles are rounded to this step (degrees) before shading and in the cache key
+const float sunStepDegrees = 0.5f;
+// Sun speed for the arrow keys and for R (degrees per second)
+const float sunTurnRate = 60.0f;
+
+// Gradients (rise over run) below this count as flat and get no aspect
+const float flatGradient = 1e-4f;
+
+// Benchmark repetitions; the best run counts
+const int benchmarkRuns = 5;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+int resolveThreadCount() {
+    if (computeThreadCount > 0)
+        return computeThreadCount;
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Runs task(i) for i in [0, count) on up to threadCount threads (the caller is one of them)
+template <typename Task>
+void parallelFor(int count, int threadCount, const Task& task) {
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for (int i = next++; i < count; i = next++)
+            task(i);
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < std::min(threadCount, count); ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Terrain kernels. Gradients use Horn's operator, products are evaluated from the gradients; every SIMD
+// kernel computes the scalar formula operation for operation, so all kernel sets give the same samples.
+// ---------------------------------------------------------------------------------------------------------
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TERRAIN_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TERRAIN_TARGET(isa)
+#else
+#define TERRAIN_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__aarch64__)
+#define TERRAIN_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Display parameters resolved for the kernels; x is east, y is north, gradients are per metre
+struct ShadeParams {
+    float zFactor = 1.0f;
+    float sunX = 0.0f, sunY = 0.0f, sunZ = 1.0f;   // unit vector towards the sun
+};
+
+const float halfPi = 1.57079633f;
+const float twoPi = 6.28318531f;
+// Slope 0..90 degrees and aspect 0..360 degrees (1..255, 0 = flat) as 8-bit samples
+const float slopeScale = 255.0f / halfPi;
+const float aspectScale = 254.0f / twoPi;
+
+// atan(t) for t in [0, 1], |error| < 1e-5 rad (Abramowitz & Stegun 4.4.49)
+const float atanC0 = 0.9998660f;
+const float atanC1 = -0.3302995f;
+const float atanC2 = 0.1801410f;
+const float atanC3 = -0.0851330f;
+const float atanC4 = 0.0208351f;
+
+struct TerrainKernels {
+    const char* name;
+    // One output row from three input rows of count + 2 samples (left and right halo included);
+    // scale = 1 / (8 * cell size)
+    void (*gradientRow)(const float* above, const float* row, const float* below, float* dzdx, float* dzdy, size_t count, float scale);
+    void (*hillshade)(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params);
+    void (*slope)(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params);
+    void (*aspect)(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params);
+};
+
+inline float atanUnit(float t) {
+    float t2 = t * t;
+    return t * (atanC0 + t2 * (atanC1 + t2 * (atanC2 + t2 * (atanC3 + t2 * atanC4))));
+}
+
+inline uint8_t toSample(float value) {
+    return static_cast<uint8_t>(static_cast<int>(std::min(255.0f, std::max(0.0f, value)) + 0.5f));
+}
+
+// Rows run north to south, so dz/dy (northwards) is the row above minus the row below
+void gradientRowScalar(const float* above, const float* row, const float* below, float* dzdx, float* dzdy, size_t count, float scale) {
+    for (size_t i = 0; i < count; ++i) {
+        float east = (above[i + 2] + below[i + 2]) + (row[i + 2] + row[i + 2]);
+        float west = (above[i] + below[i]) + (row[i] + row[i]);
+        float north = (above[i] + above[i + 2]) + (above[i + 1] + above[i + 1]);
+        float south = (below[i] + below[i + 2]) + (below[i + 1] + below[i + 1]);
+        dzdx[i] = (east - west) * scale;
+        dzdy[i] = (north - south) * scale;
+    }
+}
+
+// Lambert term of the surface normal (-p, -q, 1) / |.| against the sun
+void hillshadeScalar(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params) {
+    for (size_t i = 0; i < count; ++i) {
+        float p = dzdx[i] * params.zFactor, q = dzdy[i] * params.zFactor;
+        float light = (params.sunZ - p * params.sunX) - q * params.sunY;
+        float length = std::sqrt((1.0f + p * p) + q * q);
+        dst[i] = toSample(light / length * 255.0f);
+    }
+}
+
+void slopeScalar(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params) {
+    for (size_t i = 0; i < count; ++i) {
+        float p = dzdx[i] * params.zFactor, q = dzdy[i] * params.zFactor;
+        float gradient = std::sqrt(p * p + q * q);
+        bool steep = gradient > 1.0f;
+        float angle = atanUnit(steep ? 1.0f / gradient : gradient);
+        dst[i] = toSample((steep ? halfPi - angle : angle) * slopeScale);
+    }
+}
+
+// Compass direction of the downhill slope, clockwise from north
+void aspectScalar(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams&) {
+    for (size_t i = 0; i < count; ++i) {
+        float east = -dzdx[i], north = -dzdy[i];
+        float absEast = std::fabs(east), absNorth = std::fabs(north);
+        float larger = std::max(absEast, absNorth), smaller = std::min(absEast, absNorth);
+        float angle = atanUnit(smaller / std::max(larger, flatGradient));
+        if (absEast > absNorth)
+            angle = halfPi - angle;
+        if (north < 0.0f)
+            angle = 2.0f * halfPi - angle;
+        if (east < 0.0f)
+            angle = twoPi - angle;
+        dst[i] = larger < flatGradient ? 0 : toSample(1.0f + angle * aspectScale);
+    }
+}
+
+const TerrainKernels scalarTerrainKernels = { "scalar", gradientRowScalar, hillshadeScalar, slopeScalar, aspectScalar };
+
+#if TERRAIN_KERNELS_X86
+
+// 4 samples to 4 bytes: clamp, round half up, saturate
+TERRAIN_TARGET("sse2") inline void storeSamplesSse(__m128 value, uint8_t* dst) {
+    value = _mm_add_ps(_mm_min_ps(_mm_set1_ps(255.0f), _mm_max_ps(_mm_setzero_ps(), value)), _mm_set1_ps(0.5f));
+    __m128i words = _mm_packs_epi32(_mm_cvttps_epi32(value), _mm_setzero_si128());
+    int bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+    memcpy(dst, &bytes, 4);
+}
+
+TERRAIN_TARGET("sse2") inline __m128 atanUnitSse(__m128 t) {
+    __m128 t2 = _mm_mul_ps(t, t);
+    __m128 poly = _mm_add_ps(_mm_set1_ps(atanC3), _mm_mul_ps(t2, _mm_set1_ps(atanC4)));
+    poly = _mm_add_ps(_mm_set1_ps(atanC2), _mm_mul_ps(t2, poly));
+    poly = _mm_add_ps(_mm_set1_ps(atanC1), _mm_mul_ps(t2, poly));
+    poly = _mm_add_ps(_mm_set1_ps(atanC0), _mm_mul_ps(t2, poly));
+    return _mm_mul_ps(t, poly);
+}
+
+TERRAIN_TARGET("sse2") inline __m128 selectSse(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+TERRAIN_TARGET("sse2") void gradientRowSse(const float* above, const float* row, const float* below, float* dzdx, float* dzdy, size_t count, float scale) {
+    const __m128 factor = _mm_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 a0 = _mm_loadu_ps(above + i), a1 = _mm_loadu_ps(above + i + 1), a2 = _mm_loadu_ps(above + i + 2);
+        __m128 r0 = _mm_loadu_ps(row + i), r2 = _mm_loadu_ps(row + i + 2);
+        __m128 b0 = _mm_loadu_ps(below + i), b1 = _mm_loadu_ps(below + i + 1), b2 = _mm_loadu_ps(below + i + 2);
+        __m128 east = _mm_add_ps(_mm_add_ps(a2, b2), _mm_add_ps(r2, r2));
+        __m128 west = _mm_add_ps(_mm_add_ps(a0, b0), _mm_add_ps(r0, r0));
+        __m128 north = _mm_add_ps(_mm_add_ps(a0, a2), _mm_add_ps(a1, a1));
+        __m128 south = _mm_add_ps(_mm_add_ps(b0, b2), _mm_add_ps(b1, b1));
+        _mm_storeu_ps(dzdx + i, _mm_mul_ps(_mm_sub_ps(east, west), factor));
+        _mm_storeu_ps(dzdy + i, _mm_mul_ps(_mm_sub_ps(north, south), factor));
+    }
+    gradientRowScalar(above + i, row + i, below + i, dzdx + i, dzdy + i, count - i, scale);
+}
+
+TERRAIN_TARGET("sse2") void hillshadeSse(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params) {
+    const __m128 z = _mm_set1_ps(params.zFactor);
+    const __m128 sunX = _mm_set1_ps(params.sunX), sunY = _mm_set1_ps(params.sunY), sunZ = _mm_set1_ps(params.sunZ);
+    const __m128 one = _mm_set1_ps(1.0f), full = _mm_set1_ps(255.0f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 p = _mm_mul_ps(_mm_loadu_ps(dzdx + i), z), q = _mm_mul_ps(_mm_loadu_ps(dzdy + i), z);
+        __m128 light = _mm_sub_ps(_mm_sub_ps(sunZ, _mm_mul_ps(p, sunX)), _mm_mul_ps(q, sunY));
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(one, _mm_mul_ps(p, p)), _mm_mul_ps(q, q)));
+        storeSamplesSse(_mm_mul_ps(_mm_div_ps(light, length), full), dst + i);
+    }
+    hillshadeScalar(dzdx + i, dzdy + i, dst + i, count - i, params);
+}
+
+TERRAIN_TARGET("sse2") void slopeSse(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params) {
+    const __m128 z = _mm_set1_ps(params.zFactor);
+    const __m128 one = _mm_set1_ps(1.0f), right = _mm_set1_ps(halfPi), scale = _mm_set1_ps(slopeScale);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 p = _mm_mul_ps(_mm_loadu_ps(dzdx + i), z), q = _mm_mul_ps(_mm_loadu_ps(dzdy + i), z);
+        __m128 gradient = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(p, p), _mm_mul_ps(q, q)));
+        __m128 steep = _mm_cmpgt_ps(gradient, one);
+        __m128 angle = atanUnitSse(selectSse(steep, _mm_div_ps(one, gradient), gradient));
+        storeSamplesSse(_mm_mul_ps(selectSse(steep, _mm_sub_ps(right, angle), angle), scale), dst + i);
+    }
+    slopeScalar(dzdx + i, dzdy + i, dst + i, count - i, params);
+}
+
+TERRAIN_TARGET("sse2") void aspectSse(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params) {
+    const __m128 signBit = _mm_set1_ps(-0.0f), zero = _mm_setzero_ps();
+    const __m128 flat = _mm_set1_ps(flatGradient), right = _mm_set1_ps(halfPi), straight = _mm_set1_ps(2.0f * halfPi);
+    const __m128 turn = _mm_set1_ps(twoPi), one = _mm_set1_ps(1.0f), scale = _mm_set1_ps(aspectScale);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 east = _mm_xor_ps(_mm_loadu_ps(dzdx + i), signBit), north = _mm_xor_ps(_mm_loadu_ps(dzdy + i), signBit);
+        __m128 absEast = _mm_andnot_ps(signBit, east), absNorth = _mm_andnot_ps(signBit, north);
+        __m128 larger = _mm_max_ps(absEast, absNorth), smaller = _mm_min_ps(absEast, absNorth);
+        __m128 angle = atanUnitSse(_mm_div_ps(smaller, _mm_max_ps(larger, flat)));
+        angle = selectSse(_mm_cmpgt_ps(absEast, absNorth), _mm_sub_ps(right, angle), angle);
+        angle = selectSse(_mm_cmplt_ps(north, zero), _mm_sub_ps(straight, angle), angle);
+        angle = selectSse(_mm_cmplt_ps(east, zero), _mm_sub_ps(turn, angle), angle);
+        __m128 value = _mm_add_ps(one, _mm_mul_ps(angle, scale));
+        storeSamplesSse(_mm_andnot_ps(_mm_cmplt_ps(larger, flat), value), dst + i);
+    }
+    aspectScalar(dzdx + i, dzdy + i, dst + i, count - i, params);
+}
+
+// 8 samples to 8 bytes
+TERRAIN_TARGET("avx2") inline void storeSamplesAvx2(__m256 value, uint8_t* dst) {
+    value = _mm256_add_ps(_mm256_min_ps(_mm256_set1_ps(255.0f), _mm256_max_ps(_mm256_setzero_ps(), value)), _mm256_set1_ps(0.5f));
+    __m256i ints = _mm256_cvttps_epi32(value);
+    __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(ints), _mm256_extracti128_si256(ints, 1));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(words, words));
+}
+
+TERRAIN_TARGET("avx2") inline __m256 atanUnitAvx2(__m256 t) {
+    __m256 t2 = _mm256_mul_ps(t, t);
+    __m256 poly = _mm256_add_ps(_mm256_set1_ps(atanC3), _mm256_mul_ps(t2, _mm256_set1_ps(atanC4)));
+    poly = _mm256_add_ps(_mm256_set1_ps(atanC2), _mm256_mul_ps(t2, poly));
+    poly = _mm256_add_ps(_mm256_set1_ps(atanC1), _mm256_mul_ps(t2, poly));
+    poly = _mm256_add_ps(_mm256_set1_ps(atanC0), _mm256_mul_ps(t2, poly));
+    return _mm256_mul_ps(t, poly);
+}
+
+TERRAIN_TARGET("avx2") void gradientRowAvx2(const float* above, const float* row, const float* below, float* dzdx, float* dzdy, size_t count, float scale) {
+    const __m256 factor = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 a0 = _mm256_loadu_ps(above + i), a1 = _mm256_loadu_ps(above + i + 1), a2 = _mm256_loadu_ps(above + i + 2);
+        __m256 r0 = _mm256_loadu_ps(row + i), r2 = _mm256_loadu_ps(row + i + 2);
+        __m256 b0 = _mm256_loadu_ps(below + i), b1 = _mm256_loadu_ps(below + i + 1), b2 = _mm256_loadu_ps(below + i + 2);
+        __m256 east = _mm256_add_ps(_mm256_add_ps(a2, b2), _mm256_add_ps(r2, r2));
+        __m256 west = _mm256_add_ps(_mm256_add_ps(a0, b0), _mm256_add_ps(r0, r0));
+        __m256 north = _mm256_add_ps(_mm256_add_ps(a0, a2), _mm256_add_ps(a1, a1));
+        __m256 south = _mm256_add_ps(_mm256_add_ps(b0, b2), _mm256_add_ps(b1, b1));
+        _mm256_storeu_ps(dzdx + i, _mm256_mul_ps(_mm256_sub_ps(east, west), factor));
+        _mm256_storeu_ps(dzdy + i, _mm256_mul_ps(_mm256_sub_ps(north, south), factor));
+    }
+    gradientRowScalar(above + i, row + i, below + i, dzdx + i, dzdy + i, count - i, scale);
+}
+
+TERRAIN_TARGET("avx2") void hillshadeAvx2(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params) {
+    const __m256 z = _mm256_set1_ps(params.zFactor);
+    const __m256 sunX = _mm256_set1_ps(params.sunX), sunY = _mm256_set1_ps(params.sunY), sunZ = _mm256_set1_ps(params.sunZ);
+    const __m256 one = _mm256_set1_ps(1.0f), full = _mm256_set1_ps(255.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 p = _mm256_mul_ps(_mm256_loadu_ps(dzdx + i), z), q = _mm256_mul_ps(_mm256_loadu_ps(dzdy + i), z);
+        __m256 light = _mm256_sub_ps(_mm256_sub_ps(sunZ, _mm256_mul_ps(p, sunX)), _mm256_mul_ps(q, sunY));
+        __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(one, _mm256_mul_ps(p, p)), _mm256_mul_ps(q, q)));
+        storeSamplesAvx2(_mm256_mul_ps(_mm256_div_ps(light, length), full), dst + i);
+    }
+    hillshadeScalar(dzdx + i, dzdy + i, dst + i, count - i, params);
+}
+
+TERRAIN_TARGET("avx2") void slopeAvx2(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params) {
+    const __m256 z = _mm256_set1_ps(params.zFactor);
+    const __m256 one = _mm256_set1_ps(1.0f), right = _mm256_set1_ps(halfPi), scale = _mm256_set1_ps(slopeScale);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 p = _mm256_mul_ps(_mm256_loadu_ps(dzdx + i), z), q = _mm256_mul_ps(_mm256_loadu_ps(dzdy + i), z);
+        __m256 gradient = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(p, p), _mm256_mul_ps(q, q)));
+        __m256 steep = _mm256_cmp_ps(gradient, one, _CMP_GT_OQ);
+        __m256 angle = atanUnitAvx2(_mm256_blendv_ps(gradient, _mm256_div_ps(one, gradient), steep));
+        storeSamplesAvx2(_mm256_mul_ps(_mm256_blendv_ps(angle, _mm256_sub_ps(right, angle), steep), scale), dst + i);
+    }
+    slopeScalar(dzdx + i, dzdy + i, dst + i, count - i, params);
+}
+
+TERRAIN_TARGET("avx2") void aspectAvx2(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params) {
+    const __m256 signBit = _mm256_set1_ps(-0.0f), zero = _mm256_setzero_ps();
+    const __m256 flat = _mm256_set1_ps(flatGradient), right = _mm256_set1_ps(halfPi), straight = _mm256_set1_ps(2.0f * halfPi);
+    const __m256 turn = _mm256_set1_ps(twoPi), one = _mm256_set1_ps(1.0f), scale = _mm256_set1_ps(aspectScale);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 east = _mm256_xor_ps(_mm256_loadu_ps(dzdx + i), signBit), north = _mm256_xor_ps(_mm256_loadu_ps(dzdy + i), signBit);
+        __m256 absEast = _mm256_andnot_ps(signBit, east), absNorth = _mm256_andnot_ps(signBit, north);
+        __m256 larger = _mm256_max_ps(absEast, absNorth), smaller = _mm256_min_ps(absEast, absNorth);
+        __m256 angle = atanUnitAvx2(_mm256_div_ps(smaller, _mm256_max_ps(larger, flat)));
+        angle = _mm256_blendv_ps(angle, _mm256_sub_ps(right, angle), _mm256_cmp_ps(absEast, absNorth, _CMP_GT_OQ));
+        angle = _mm256_blendv_ps(angle, _mm256_sub_ps(straight, angle), _mm256_cmp_ps(north, zero, _CMP_LT_OQ));
+        angle = _mm256_blendv_ps(angle, _mm256_sub_ps(turn, angle), _mm256_cmp_ps(east, zero, _CMP_LT_OQ));
+        __m256 value = _mm256_add_ps(one, _mm256_mul_ps(angle, scale));
+        storeSamplesAvx2(_mm256_andnot_ps(_mm256_cmp_ps(larger, flat, _CMP_LT_OQ), value), dst + i);
+    }
+    aspectScalar(dzdx + i, dzdy + i, dst + i, count - i, params);
+}
+
+const TerrainKernels sseTerrainKernels = { "sse2", gradientRowSse, hillshadeSse, slopeSse, aspectSse };
+const TerrainKernels avx2TerrainKernels = { "avx2", gradientRowAvx2, hillshadeAvx2, slopeAvx2, aspectAvx2 };
+
+#elif TERRAIN_KERNELS_NEON
+
+inline void storeSamplesNeon(float32x4_t value, uint8_t* dst) {
+    value = vaddq_f32(vminq_f32(vdupq_n_f32(255.0f), vmaxq_f32(vdupq_n_f32(0.0f), value)), vdupq_n_f32(0.5f));
+    int16x4_t words = vqmovn_s32(vcvtq_s32_f32(value));
+    uint8x8_t bytes = vqmovun_s16(vcombine_s16(words, words));
+    vst1_lane_u32(reinterpret_cast<uint32_t*>(dst), vreinterpret_u32_u8(bytes), 0);
+}
+
+inline float32x4_t atanUnitNeon(float32x4_t t) {
+    float32x4_t t2 = vmulq_f32(t, t);
+    float32x4_t poly = vaddq_f32(vdupq_n_f32(atanC3), vmulq_f32(t2, vdupq_n_f32(atanC4)));
+    poly = vaddq_f32(vdupq_n_f32(atanC2), vmulq_f32(t2, poly));
+    poly = vaddq_f32(vdupq_n_f32(atanC1), vmulq_f32(t2, poly));
+    poly = vaddq_f32(vdupq_n_f32(atanC0), vmulq_f32(t2, poly));
+    return vmulq_f32(t, poly);
+}
+
+void gradientRowNeon(const float* above, const float* row, const float* below, float* dzdx, float* dzdy, size_t count, float scale) {
+    const float32x4_t factor = vdupq_n_f32(scale);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t a0 = vld1q_f32(above + i), a1 = vld1q_f32(above + i + 1), a2 = vld1q_f32(above + i + 2);
+        float32x4_t r0 = vld1q_f32(row + i), r2 = vld1q_f32(row + i + 2);
+        float32x4_t b0 = vld1q_f32(below + i), b1 = vld1q_f32(below + i + 1), b2 = vld1q_f32(below + i + 2);
+        float32x4_t east = vaddq_f32(vaddq_f32(a2, b2), vaddq_f32(r2, r2));
+        float32x4_t west = vaddq_f32(vaddq_f32(a0, b0), vaddq_f32(r0, r0));
+        float32x4_t north = vaddq_f32(vaddq_f32(a0, a2), vaddq_f32(a1, a1));
+        float32x4_t south = vaddq_f32(vaddq_f32(b0, b2), vaddq_f32(b1, b1));
+        vst1q_f32(dzdx + i, vmulq_f32(vsubq_f32(east, west), factor));
+        vst1q_f32(dzdy + i, vmulq_f32(vsubq_f32(north, south), factor));
+    }
+    gradientRowScalar(above + i, row + i, below + i, dzdx + i, dzdy + i, count - i, scale);
+}
+
+void hillshadeNeon(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params) {
+    const float32x4_t z = vdupq_n_f32(params.zFactor);
+    const float32x4_t sunX = vdupq_n_f32(params.sunX), sunY = vdupq_n_f32(params.sunY), sunZ = vdupq_n_f32(params.sunZ);
+    const float32x4_t one = vdupq_n_f32(1.0f), full = vdupq_n_f32(255.0f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t p = vmulq_f32(vld1q_f32(dzdx + i), z), q = vmulq_f32(vld1q_f32(dzdy + i), z);
+        float32x4_t light = vsubq_f32(vsubq_f32(sunZ, vmulq_f32(p, sunX)), vmulq_f32(q, sunY));
+        float32x4_t length = vsqrtq_f32(vaddq_f32(vaddq_f32(one, vmulq_f32(p, p)), vmulq_f32(q, q)));
+        storeSamplesNeon(vmulq_f32(vdivq_f32(light, length), full), dst + i);
+    }
+    hillshadeScalar(dzdx + i, dzdy + i, dst + i, count - i, params);
+}
+
+void slopeNeon(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params) {
+    const float32x4_t z = vdupq_n_f32(params.zFactor);
+    const float32x4_t one = vdupq_n_f32(1.0f), right = vdupq_n_f32(halfPi), scale = vdupq_n_f32(slopeScale);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t p = vmulq_f32(vld1q_f32(dzdx + i), z), q = vmulq_f32(vld1q_f32(dzdy + i), z);
+        float32x4_t gradient = vsqrtq_f32(vaddq_f32(vmulq_f32(p, p), vmulq_f32(q, q)));
+        uint32x4_t steep = vcgtq_f32(gradient, one);
+        float32x4_t angle = atanUnitNeon(vbslq_f32(steep, vdivq_f32(one, gradient), gradient));
+        storeSamplesNeon(vmulq_f32(vbslq_f32(steep, vsubq_f32(right, angle), angle), scale), dst + i);
+    }
+    slopeScalar(dzdx + i, dzdy + i, dst + i, count - i, params);
+}
+
+void aspectNeon(const float* dzdx, const float* dzdy, uint8_t* dst, size_t count, const ShadeParams& params) {
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t flat = vdupq_n_f32(flatGradient), right = vdupq_n_f32(halfPi), straight = vdupq_n_f32(2.0f * halfPi);
+    const float32x4_t turn = vdupq_n_f32(twoPi), one = vdupq_n_f32(1.0f), scale = vdupq_n_f32(aspectScale);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t east = vnegq_f32(vld1q_f32(dzdx + i)), north = vnegq_f32(vld1q_f32(dzdy + i));
+        float32x4_t absEast = vabsq_f32(east), absNorth = vabsq_f32(north);
+        float32x4_t larger = vmaxq_f32(absEast, absNorth), smaller = vminq_f32(absEast, absNorth);
+        float32x4_t angle = atanUnitNeon(vdivq_f32(smaller, vmaxq_f32(larger, flat)));
+        angle = vbslq_f32(vcgtq_f32(absEast, absNorth), vsubq_f32(right, angle), angle);
+        angle = vbslq_f32(vcltq_f32(north, zero), vsubq_f32(straight, angle), angle);
+        angle = vbslq_f32(vcltq_f32(east, zero), vsubq_f32(turn, angle), angle);
+        float32x4_t value = vaddq_f32(one, vmulq_f32(angle, scale));
+        storeSamplesNeon(vbslq_f32(vcltq_f32(larger, flat), zero, value), dst + i);
+    }
+    aspectScalar(dzdx + i, dzdy + i, dst + i, count - i, params);
+}
+
+const TerrainKernels neonTerrainKernels = { "neon", gradientRowNeon, hillshadeNeon, slopeNeon, aspectNeon };
+
+#endif
+
+// Scalar first, widest last
+std::vector<const TerrainKernels*> supportedTerrainKernels() {
+    std::vector<const TerrainKernels*> sets = { &scalarTerrainKernels };
+#if TERRAIN_KERNELS_X86
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    bool avx2 = osAvx && (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    bool sse2 = __builtin_cpu_supports("sse2");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (sse2)
+        sets.push_back(&sseTerrainKernels);
+    if (avx2)
+        sets.push_back(&avx2TerrainKernels);
+#elif TERRAIN_KERNELS_NEON
+    sets.push_back(&neonTerrainKernels);
+#endif
+    return sets;
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Elevation data
+// ---------------------------------------------------------------------------------------------------------
+
+// Elevations of a DEM, row-major with row 0 to the north, metres
+struct HeightGrid {
+    int width = 0, height = 0;
+    std::vector<float> samples;
+
+    float at(int x, int y) const {
+        x = std::max(0, std::min(x, width - 1));
+        y = std::max(0, std::min(y, height - 1));
+        return samples[static_cast<size_t>(y) * width + x];
+    }
+};
+
+// Single-band TIFF as elevations; other images as grey levels scaled to heightScale
+bool loadDem(const std::string& path, float heightScale, HeightGrid& grid) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".tif" || extension == ".tiff") {
+        TIFF* tif = TIFFOpen(path.c_str(), "r");
+        if (!tif)
+            return false;
+        uint32_t width = 0, height = 0;
+        uint16_t samplesPerPixel = 1, bitsPerSample = 8, sampleFormat = SAMPLEFORMAT_UINT;
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bitsPerSample);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLEFORMAT, &sampleFormat);
+        bool supportedSamples = (bitsPerSample == 32 && sampleFormat == SAMPLEFORMAT_IEEEFP) ||
+                                (bitsPerSample == 16 && (sampleFormat == SAMPLEFORMAT_INT || sampleFormat == SAMPLEFORMAT_UINT)) ||
+                                (bitsPerSample == 8 && sampleFormat == SAMPLEFORMAT_UINT);
+        if (samplesPerPixel == 1 && !TIFFIsTiled(tif) && supportedSamples) {
+            grid.width = static_cast<int>(width);
+            grid.height = static_cast<int>(height);
+            grid.samples.resize(static_cast<size_t>(width) * height);
+            std::vector<unsigned char> row(TIFFScanlineSize(tif));
+            for (uint32_t y = 0; y < height; ++y) {
+                if (TIFFReadScanline(tif, row.data(), y, 0) < 0) {
+                    TIFFClose(tif);
+                    return false;
+                }
+                float* out = grid.samples.data() + static_cast<size_t>(y) * width;
+                for (uint32_t x = 0; x < width; ++x) {
+                    if (bitsPerSample == 32 && sampleFormat == SAMPLEFORMAT_IEEEFP)
+                        memcpy(&out[x], &row[x * 4], 4);
+                    else if (bitsPerSample == 16 && sampleFormat == SAMPLEFORMAT_INT)
+                        out[x] = reinterpret_cast<const int16_t*>(row.data())[x];
+                    else if (bitsPerSample == 16)
+                        out[x] = reinterpret_cast<const uint16_t*>(row.data())[x];
+                    else
+                        out[x] = row[x] * heightScale / 255.0f;
+                }
+            }
+            TIFFClose(tif);
+            printf("DEM %s: %u x %u, %u-bit %s elevations\n", path.c_str(), width, height, bitsPerSample,
+                   sampleFormat == SAMPLEFORMAT_IEEEFP ? "float" : "integer");
+            return true;
+        }
+        TIFFClose(tif);
+        std::cerr << "DEM TIFF must be single-band, stripped, and 8-bit unsigned, 16-bit integer or 32-bit float: " << path << std::endl;
+        return false;
+    }
+
+    int width, height, nrChannels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, STBI_grey);
+    if (!data)
+        return false;
+    grid.width = width;
+    grid.height = height;
+    grid.samples.resize(static_cast<size_t>(width) * height);
+    for (size_t i = 0; i < grid.samples.size(); ++i)
+        grid.samples[i] = data[i] * heightScale / 255.0f;
+    stbi_image_free(data);
+    printf("DEM %s: %d x %d grey levels, 0 to %.0f m\n", path.c_str(), width, height, heightScale);
+    return true;
+}
+
+// Diamond-square fractal terrain of size x size samples (size = 2^n + 1)
+void generateDem(int size, float heightRange, HeightGrid& grid) {
+    grid.width = grid.height = size;
+    grid.samples.assign(static_cast<size_t>(size) * size, 0.0f);
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+    auto at = [&](int x, int y) -> float& { return grid.samples[static_cast<size_t>(y) * size + x]; };
+
+    float amplitude = heightRange;
+    for (int step = size - 1; step > 1; step /= 2, amplitude *= 0.52f) {
+        int half = step / 2;
+        for (int y = half; y < size; y += step)
+            for (int x = half; x < size; x += step)
+                at(x, y) = (at(x - half, y - half) + at(x + half, y - half) + at(x - half, y + half) + at(x + half, y + half)) * 0.25f +
+                           offset(random) * amplitude;
+        for (int y = 0; y < size; y += half) {
+            for (int x = (y / half) % 2 == 0 ? half : 0; x < size; x += step) {
+                float sum = 0.0f;
+                int count = 0;
+                if (x >= half) { sum += at(x - half, y); ++count; }
+                if (x + half < size) { sum += at(x + half, y); ++count; }
+                if (y >= half) { sum += at(x, y - half); ++count; }
+                if (y + half < size) { sum += at(x, y + half); ++count; }
+                at(x, y) = sum / count + offset(random) * amplitude;
+            }
+        }
+    }
+    // Sea level at the lowest point
+    float lowest = *std::min_element(grid.samples.begin(), grid.samples.end());
+    for (float& sample : grid.samples)
+        sample -= lowest;
+    printf("Generated DEM: %d x %d (diamond-square)\n", size, size);
+}
+
+// Identifies one tile of the pyramid
+struct TileKey {
+    int level = 0, x = 0, y = 0;
+
+    uint64_t packed() const {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+    }
+    TileKey parent() const {
+        TileKey p;
+        p.level = level + 1;
+        p.x = x / 2;
+        p.y = y / 2;
+        return p;
+    }
+};
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    glm::vec2 getCenter() const { return -offset; }
+    float getScale() const { return scale; }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    GLuint ubo = 0;
+};
+
+// The DEM and its 2x2-averaged levels, cut into tiles.
+// World mapping keeps the aspect ratio: x spans [-1, 1], y spans [-h/w, h/w], row 0 at the top.
+class ElevationPyramid {
+public:
+    void build(HeightGrid&& base, float spacing) {
+        m_spacing = spacing;
+        m_levels.clear();
+        m_levels.push_back(std::move(base));
+        // Halve until the whole level fits in one tile
+        while (m_levels.back().width > tileSize || m_levels.back().height > tileSize)
+            m_levels.push_back(downsample(m_levels.back()));
+        printf("Elevation pyramid: %d levels, %d x %d tiles at level 0, spacing %.1f m\n", levelCount(), tilesX(0), tilesY(0), spacing);
+    }
+
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    int levelWidth(int level) const { return m_levels[level].width; }
+    int levelHeight(int level) const { return m_levels[level].height; }
+    int tilesX(int level) const { return (levelWidth(level) + tileSize - 1) / tileSize; }
+    int tilesY(int level) const { return (levelHeight(level) + tileSize - 1) / tileSize; }
+
+    // Ground distance between samples of a level (metres)
+    float cellSize(int level) const { return m_spacing * static_cast<float>(1 << level); }
+
+    bool isValid(const TileKey& key) const {
+        return key.level >= 0 && key.level < levelCount() &&
+               key.x >= 0 && key.x < tilesX(key.level) && key.y >= 0 && key.y < tilesY(key.level);
+    }
+
+    void tileExtent(const TileKey& key, int& width, int& height) const {
+        width = std::min(tileSize, levelWidth(key.level) - key.x * tileSize);
+        height = std::min(tileSize, levelHeight(key.level) - key.y * tileSize);
+    }
+
+    // Elevations of a tile with a one-sample border taken from its neighbours: (width + 2) x (height + 2)
+    void readHaloTile(const TileKey& key, std::vector<float>& samples) const {
+        const HeightGrid& level = m_levels[key.level];
+        int width, height;
+        tileExtent(key, width, height);
+        int x0 = key.x * tileSize - 1, y0 = key.y * tileSize - 1;
+        samples.resize(static_cast<size_t>(width + 2) * (height + 2));
+        for (int y = 0; y < height + 2; ++y) {
+            float* out = samples.data() + static_cast<size_t>(y) * (width + 2);
+            int sourceY = std::max(0, std::min(y0 + y, level.height - 1));
+            const float* in = level.samples.data() + static_cast<size_t>(sourceY) * level.width;
+            // Interior columns are one copy; only the halo columns can fall outside the level
+            int first = std::max(0, -x0), last = std::min(width + 2, level.width - x0);
+            for (int x = 0; x < first; ++x)
+                out[x] = in[0];
+            memcpy(out + first, in + x0 + first, sizeof(float) * (last - first));
+            for (int x = last; x < width + 2; ++x)
+                out[x] = in[level.width - 1];
+        }
+    }
+
+    // World units per level-0 sample
+    float worldPerPixel() const { return 2.0f / m_levels[0].width; }
+
+    // World-space rectangle of a tile (min.x, min.y, max.x, max.y)
+    glm::vec4 tileRect(const TileKey& key) const {
+        int width0 = m_levels[0].width, height0 = m_levels[0].height;
+        int px0 = std::min(key.x * tileSize << key.level, width0);
+        int py0 = std::min(key.y * tileSize << key.level, height0);
+        int px1 = std::min((key.x + 1) * tileSize << key.level, width0);
+        int py1 = std::min((key.y + 1) * tileSize << key.level, height0);
+        float p = worldPerPixel();
+        float top = height0 * p * 0.5f;
+        return glm::vec4(px0 * p - 1.0f, top - py1 * p, px1 * p - 1.0f, top - py0 * p);
+    }
+
+    // Level whose sample density best matches the screen for this camera
+    int selectLevel(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        float texelsPerScreenPixel = 1.0f / (worldPerPixel() * screenPixelsPerWorld);
+        int level = static_cast<int>(std::floor(std::log2(std::max(texelsPerScreenPixel, 1e-6f)) + lodBias));
+        return std::max(0, std::min(level, levelCount() - 1));
+    }
+
+    // Range of tiles of a level that intersect a world rectangle; false if none
+    bool tileRange(int level, const glm::vec4& rect, int& x0, int& y0, int& x1, int& y1) const {
+        float p = worldPerPixel() * static_cast<float>(1 << level) * tileSize;  // world size of one tile
+        float top = m_levels[0].height * worldPerPixel() * 0.5f;
+        x0 = std::max(0, static_cast<int>(std::floor((rect.x + 1.0f) / p)));
+        x1 = std::min(tilesX(level) - 1, static_cast<int>(std::floor((rect.z + 1.0f) / p)));
+        y0 = std::max(0, static_cast<int>(std::floor((top - rect.w) / p)));
+        y1 = std::min(tilesY(level) - 1, static_cast<int>(std::floor((top - rect.y) / p)));
+        return x0 <= x1 && y0 <= y1;
+    }
+
+private:
+    std::vector<HeightGrid> m_levels;
+    float m_spacing = 1.0f;
+
+    static HeightGrid downsample(const HeightGrid& src) {
+        HeightGrid dst;
+        dst.width = (src.width + 1) / 2;
+        dst.height = (src.height + 1) / 2;
+        dst.samples.resize(static_cast<size_t>(dst.width) * dst.height);
+        for (int y = 0; y < dst.height; ++y)
+            for (int x = 0; x < dst.width; ++x)
+                dst.samples[static_cast<size_t>(y) * dst.width + x] =
+                    (src.at(2 * x, 2 * y) + src.at(2 * x + 1, 2 * y) + src.at(2 * x, 2 * y + 1) + src.at(2 * x + 1, 2 * y + 1)) * 0.25f;
+        return dst;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------
+// Derived products
+// ---------------------------------------------------------------------------------------------------------
+
+enum class Product { Hillshade, Slope, Aspect };
+
+const char* productNames[] = { "hillshade", "slope", "aspect" };
+
+// What the user picked; key() identifies the resulting samples, so parameters a product ignores are left out
+struct ShadeSettings {
+    Product product = Product::Hillshade;
+    float azimuth = 315.0f;   // degrees clockwise from north
+    float altitude = 45.0f;   // degrees above the horizon
+    float zFactor = 1.0f;
+
+    int azimuthStep() const { return static_cast<int>(std::lround(azimuth / sunStepDegrees)) % static_cast<int>(360.0f / sunStepDegrees); }
+    int altitudeStep() const { return static_cast<int>(std::lround(altitude / sunStepDegrees)); }
+
+    // product (2 bits) | azimuth step (10) | altitude step (8) | z-factor in 1/16 (12)
+    uint32_t key() const {
+        uint32_t z = static_cast<uint32_t>(std::lround(zFactor * 16.0f)) & 0xFFF;
+        if (product == Product::Aspect)
+            return static_cast<uint32_t>(product);
+        if (product == Product::Slope)
+            return static_cast<uint32_t>(product) | (z << 20);
+        return static_cast<uint32_t>(product) | (static_cast<uint32_t>(azimuthStep()) << 2) |
+               (static_cast<uint32_t>(altitudeStep()) << 12) | (z << 20);
+    }
+
+    // Kernel parameters from the rounded values, so equal keys always mean equal samples
+    ShadeParams params() const {
+        ShadeParams p;
+        p.zFactor = std::lround(zFactor * 16.0f) / 16.0f;
+        float az = glm::radians(azimuthStep() * sunStepDegrees), alt = glm::radians(altitudeStep() * sunStepDegrees);
+        p.sunX = std::cos(alt) * std::sin(az);
+        p.sunY = std::cos(alt) * std::cos(az);
+        p.sunZ = std::sin(alt);
+        return p;
+    }
+};
+
+// Gradients of one tile, cached on the CPU since every product starts from them
+struct GradientTile {
+    int width = 0, height = 0;
+    std::vector<float> dzdx, dzdy;
+    int lastUsedFrame = 0;
+};
+
+class GradientCache {
+public:
+    GradientTile* find(const TileKey& key) {
+        auto it = m_tiles.find(key.packed());
+        return it == m_tiles.end() ? nullptr : &it->second;
+    }
+
+    // Entry to fill; map nodes stay put, so workers can write to it while other entries are added
+    GradientTile& insert(const TileKey& key, int frame) {
+        GradientTile& tile = m_tiles[key.packed()];
+        tile.lastUsedFrame = frame;
+        return tile;
+    }
+
+    void evict(int currentFrame) {
+        if (m_tiles.size() <= gradientTileBudget)
+            return;
+        std::vector<std::pair<int, uint64_t>> candidates;
+        for (const auto& item : m_tiles)
+            if (item.second.lastUsedFrame < currentFrame)
+                candidates.emplace_back(item.second.lastUsedFrame, item.first);
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& candidate : candidates) {
+            if (m_tiles.size() <= gradientTileBudget)
+                break;
+            m_tiles.erase(candidate.second);
+        }
+    }
+
+    size_t size() const { return m_tiles.size(); }
+
+private:
+    std::unordered_map<uint64_t, GradientTile> m_tiles;
+};
+
+// Product tiles (R8) on the GPU, one per (tile, settings key), evicted least-recently-used once over budget.
+// The most recent variant of every tile is remembered, to be drawn while the current one is computed.
+class ProductCache {
+public:
+    struct Entry {
+        GLuint texture = 0;
+        int lastUsedFrame = 0;
+        Product product = Product::Hillshade;
+    };
+
+    void upload(const TileKey& key, uint32_t settings, Product product, int width, int height, const uint8_t* samples, int frame) {
+        Entry entry;
+        entry.lastUsedFrame = frame;
+        entry.product = product;
+        glGenTextures(1, &entry.texture);
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, samples);
+
+        m_entries[{ key.packed(), settings }] = entry;
+        m_latest[key.packed()] = settings;
+        ++m_uploads;
+    }
+
+    Entry* find(const TileKey& key, uint32_t settings) {
+        auto it = m_entries.find({ key.packed(), settings });
+        return it == m_entries.end() ? nullptr : &it->second;
+    }
+
+    // The current variant, else the tile's most recent one (stale == true)
+    Entry* findBest(const TileKey& key, uint32_t settings, bool& stale) {
+        stale = false;
+        if (Entry* entry = find(key, settings))
+            return entry;
+        auto latest = m_latest.find(key.packed());
+        if (latest == m_latest.end())
+            return nullptr;
+        stale = true;
+        return find(key, latest->second);
+    }
+
+    void evict(int currentFrame) {
+        if (m_entries.size() <= productTileBudget)
+            return;
+        std::vector<std::pair<int, VariantKey>> candidates;
+        for (const auto& item : m_entries)
+            if (item.second.lastUsedFrame < currentFrame)
+                candidates.emplace_back(item.second.lastUsedFrame, item.first);
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const std::pair<int, VariantKey>& a, const std::pair<int, VariantKey>& b) { return a.first < b.first; });
+        for (const auto& candidate : candidates) {
+            if (m_entries.size() <= productTileBudget)
+                break;
+            auto it = m_entries.find(candidate.second);
+            glDeleteTextures(1, &it->second.texture);
+            m_entries.erase(it);
+            auto latest = m_latest.find(candidate.second.tile);
+            if (latest != m_latest.end() && latest->second == candidate.second.settings)
+                m_latest.erase(latest);
+        }
+    }
+
+    size_t size() const { return m_entries.size(); }
+    int getUploads() const { return m_uploads; }
+
+    void destroy() {
+        for (auto& item : m_entries)
+            glDeleteTextures(1, &item.second.texture);
+        m_entries.clear();
+        m_latest.clear();
+    }
+
+private:
+    struct VariantKey {
+        uint64_t tile;
+        uint32_t settings;
+        bool operator==(const VariantKey& other) const { return tile == other.tile && settings == other.settings; }
+    };
+    struct VariantHash {
+        size_t operator()(const VariantKey& key) const { return std::hash<uint64_t>()(key.tile * 0x9E3779B97F4A7C15ull ^ key.settings); }
+    };
+    std::unordered_map<VariantKey, Entry, VariantHash> m_entries;
+    std::unordered_map<uint64_t, uint32_t> m_latest;
+    int m_uploads = 0;
+};
+
+// Computes missing products for the visible tiles: gradients where the tile has none cached, then the
+// product kernel, each tile a task for the thread pool
+class TerrainProcessor {
+public:
+    struct Stats {
+        long long tiles = 0;       // product tiles computed
+        long long gradients = 0;   // gradient tiles computed
+        long long samples = 0;     // product samples computed
+        double milliseconds = 0.0;
+    };
+
+    const TerrainKernels* kernels = nullptr;
+    int threadCount = 1;
+    Stats frameStats, totalStats;
+
+    // Computes up to maxTilesPerFrame of the wanted tiles (in order) that lack the current product
+    void update(const ElevationPyramid& pyramid, GradientCache& gradients, ProductCache& products,
+                const std::vector<TileKey>& wanted, const ShadeSettings& settings, int frame) {
+        frameStats = Stats();
+        auto start = std::chrono::steady_clock::now();
+        uint32_t settingsKey = settings.key();
+        m_jobs.clear();
+        for (const TileKey& key : wanted) {
+            if (static_cast<int>(m_jobs.size()) == maxTilesPerFrame)
+                break;
+            if (products.find(key, settingsKey))
+                continue;
+            Job job;
+            job.key = key;
+            job.gradient = gradients.find(key);
+            job.computeGradient = job.gradient == nullptr;
+            if (job.computeGradient)
+                job.gradient = &gradients.insert(key, frame);
+            job.gradient->lastUsedFrame = frame;
+            m_jobs.push_back(job);
+        }
+        if (m_jobs.empty())
+            return;
+
+        ShadeParams params = settings.params();
+        parallelFor(static_cast<int>(m_jobs.size()), threadCount, [&](int index) {
+            Job& job = m_jobs[index];
+            if (job.computeGradient)
+                computeGradient(pyramid, job.key, *job.gradient);
+            computeProduct(*job.gradient, settings.product, params, job.samples);
+        });
+
+        for (Job& job : m_jobs) {
+            products.upload(job.key, settingsKey, settings.product, job.gradient->width, job.gradient->height, job.samples.data(), frame);
+            frameStats.tiles += 1;
+            frameStats.gradients += job.computeGradient ? 1 : 0;
+            frameStats.samples += static_cast<long long>(job.samples.size());
+        }
+        frameStats.milliseconds = millisecondsSince(start);
+        totalStats.tiles += frameStats.tiles;
+        totalStats.gradients += frameStats.gradients;
+        totalStats.samples += frameStats.samples;
+        totalStats.milliseconds += frameStats.milliseconds;
+    }
+
+    void computeGradient(const ElevationPyramid& pyramid, const TileKey& key, GradientTile& gradient) const {
+        std::vector<float> halo;
+        pyramid.readHaloTile(key, halo);
+        pyramid.tileExtent(key, gradient.width, gradient.height);
+        size_t stride = static_cast<size_t>(gradient.width) + 2;
+        gradient.dzdx.resize(static_cast<size_t>(gradient.width) * gradient.height);
+        gradient.dzdy.resize(gradient.dzdx.size());
+        float scale = 1.0f / (8.0f * pyramid.cellSize(key.level));
+        for (int y = 0; y < gradient.height; ++y) {
+            size_t out = static_cast<size_t>(y) * gradient.width;
+            kernels->gradientRow(halo.data() + y * stride, halo.data() + (y + 1) * stride, halo.data() + (y + 2) * stride,
+                                 gradient.dzdx.data() + out, gradient.dzdy.data() + out, gradient.width, scale);
+        }
+    }
+
+    void computeProduct(const GradientTile& gradient, Product product, const ShadeParams& params, std::vector<uint8_t>& samples) const {
+        samples.resize(gradient.dzdx.size());
+        auto kernel = product == Product::Hillshade ? kernels->hillshade : product == Product::Slope ? kernels->slope : kernels->aspect;
+        kernel(gradient.dzdx.data(), gradient.dzdy.data(), samples.data(), samples.size(), params);
+    }
+
+private:
+    struct Job {
+        TileKey key;
+        GradientTile* gradient = nullptr;
+        bool computeGradient = false;
+        std::vector<uint8_t> samples;
+    };
+    std::vector<Job> m_jobs;
+};
+
+// Visible tiles of a level, nearest to the view centre first
+void collectVisibleTiles(const Camera& camera, const ElevationPyramid& pyramid, int level, std::vector<TileKey>& tiles) {
+    tiles.clear();
+    int x0, y0, x1, y1;
+    if (!pyramid.tileRange(level, camera.getVisibleRect(), x0, y0, x1, y1))
+        return;
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            TileKey key;
+            key.level = level;
+            key.x = x;
+            key.y = y;
+            tiles.push_back(key);
+        }
+    }
+    glm::vec2 center = camera.getCenter();
+    auto distance = [&](const TileKey& key) {
+        glm::vec4 rect = pyramid.tileRect(key);
+        float dx = (rect.x + rect.z) * 0.5f - center.x, dy = (rect.y + rect.w) * 0.5f - center.y;
+        return dx * dx + dy * dy;
+    };
+    std::sort(tiles.begin(), tiles.end(), [&](const TileKey& a, const TileKey& b) { return distance(a) < distance(b); });
+}
+
+// Draws each visible tile's product, else the matching part of the nearest ancestor that has one
+class ProductRenderer {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 tileRect;  // world x0, y0, x1, y1
+uniform vec4 uvRect;    // u0, v0 (top-left), u1, v1 (bottom-right)
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(tileRect.xw, tileRect.zy, corner), 0.0, 1.0);
+    texCoord = mix(uvRect.xy, uvRect.zw, corner);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+uniform int product;    // 0 hillshade, 1 slope, 2 aspect
+
+vec3 hue(float h)
+{
+    return clamp(abs(mod(h * 6.0 + vec3(0.0, 4.0, 2.0), 6.0) - 3.0) - 1.0, 0.0, 1.0);
+}
+
+void main()
+{
+    float value = texture(tex0, texCoord).r;
+    if (product == 0) {
+        FragColor = vec4(vec3(value), 1.0);
+    } else if (product == 1) {
+        // 0 degrees green, 45 yellow, 90 red
+        vec3 gentle = vec3(0.1, 0.6, 0.2), moderate = vec3(1.0, 0.9, 0.2), steep = vec3(0.8, 0.1, 0.1);
+        FragColor = vec4(value < 0.5 ? mix(gentle, moderate, value * 2.0) : mix(moderate, steep, value * 2.0 - 1.0), 1.0);
+    } else {
+        // Compass hue wheel, flat areas grey
+        float samples = value * 255.0;
+        FragColor = samples < 0.5 ? vec4(vec3(0.5), 1.0) : vec4(hue((samples - 1.0) / 254.0), 1.0);
+    }
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO;
+    GLint tileRectLoc, uvRectLoc, productLoc;
+    int holes = 0;
+    int stale = 0;
+
+    void init(Camera* camera) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        tileRectLoc = glGetUniformLocation(shaderProgram, "tileRect");
+        uvRectLoc = glGetUniformLocation(shaderProgram, "uvRect");
+        productLoc = glGetUniformLocation(shaderProgram, "product");
+        // Corners come from gl_VertexID; the VAO only has to exist
+        glGenVertexArrays(1, &VAO);
+    }
+
+    void render(const ElevationPyramid& pyramid, ProductCache& cache, const std::vector<TileKey>& tiles, uint32_t settings, int frame) {
+        holes = 0;
+        stale = 0;
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        for (const TileKey& key : tiles) {
+            glm::vec4 rect = pyramid.tileRect(key);
+
+            // Walk up until some ancestor has a product for this area
+            TileKey source = key;
+            bool isStale = false;
+            ProductCache::Entry* entry = cache.findBest(source, settings, isStale);
+            if (!entry)
+                ++holes;
+            while (!entry && source.level + 1 < pyramid.levelCount()) {
+                source = source.parent();
+                entry = cache.findBest(source, settings, isStale);
+            }
+            if (!entry)
+                continue;
+            if (isStale)
+                ++stale;
+            entry->lastUsedFrame = frame;
+
+            // Part of the source tile covered by this tile, in the source's texel space
+            glm::vec4 sourceRect = pyramid.tileRect(source);
+            float u0 = (rect.x - sourceRect.x) / (sourceRect.z - sourceRect.x);
+            float u1 = (rect.z - sourceRect.x) / (sourceRect.z - sourceRect.x);
+            float v0 = (sourceRect.w - rect.w) / (sourceRect.w - sourceRect.y);
+            float v1 = (sourceRect.w - rect.y) / (sourceRect.w - sourceRect.y);
+
+            glBindTexture(GL_TEXTURE_2D, entry->texture);
+            glUniform1i(productLoc, static_cast<int>(entry->product));
+            glUniform4f(tileRectLoc, rect.x, rect.y, rect.z, rect.w);
+            glUniform4f(uvRectLoc, u0, v0, u1, v1);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        }
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+    }
+};
+
+// Best time of benchmarkRuns calls
+template <typename Run>
+double bestMilliseconds(const Run& run) {
+    double best = 1e30;
+    for (int i = 0; i < benchmarkRuns; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, millisecondsSince(start));
+    }
+    return best;
+}
+
+// Every level-0 tile through each kernel set, on one thread and on all of them; products are compared
+// against the scalar kernels
+void runBenchmark(const ElevationPyramid& pyramid) {
+    std::vector<TileKey> tiles;
+    for (int y = 0; y < pyramid.tilesY(0); ++y) {
+        for (int x = 0; x < pyramid.tilesX(0); ++x) {
+            TileKey key;
+            key.x = x;
+            key.y = y;
+            tiles.push_back(key);
+        }
+    }
+    double megasamples = static_cast<double>(pyramid.levelWidth(0)) * pyramid.levelHeight(0) / 1e6;
+    int threadCount = resolveThreadCount();
+    ShadeSettings settings;
+    ShadeParams params = settings.params();
+    printf("%zu tiles, %.1f Msamples, %d threads; Msamples/s, best of %d runs\n", tiles.size(), megasamples, threadCount, benchmarkRuns);
+    printf("  %-8s %8s %12s %12s %12s %12s\n", "kernels", "", "gradient", "hillshade", "slope", "aspect");
+
+    std::vector<GradientTile> reference(tiles.size()), gradients(tiles.size());
+    std::vector<std::vector<uint8_t>> referenceSamples(tiles.size() * 3), samples(tiles.size() * 3);
+    for (const TerrainKernels* kernels : supportedTerrainKernels()) {
+        TerrainProcessor processor;
+        processor.kernels = kernels;
+        bool isScalar = kernels == &scalarTerrainKernels;
+        std::vector<GradientTile>& gradientOut = isScalar ? reference : gradients;
+        std::vector<std::vector<uint8_t>>& samplesOut = isScalar ? referenceSamples : samples;
+
+        std::vector<int> threadCounts = { 1 };
+        if (threadCount > 1)
+            threadCounts.push_back(threadCount);
+        for (int threads : threadCounts) {
+            printf("  %-8s %5d th", kernels->name, threads);
+            double ms = bestMilliseconds([&]() {
+                parallelFor(static_cast<int>(tiles.size()), threads, [&](int i) { processor.computeGradient(pyramid, tiles[i], gradientOut[i]); });
+            });
+            printf(" %12.0f", megasamples * 1000.0 / ms);
+            for (int product = 0; product < 3; ++product) {
+                ms = bestMilliseconds([&]() {
+                    parallelFor(static_cast<int>(tiles.size()), threads, [&](int i) {
+                        processor.computeProduct(gradientOut[i], static_cast<Product>(product), params, samplesOut[i * 3 + product]);
+                    });
+                });
+                printf(" %12.0f", megasamples * 1000.0 / ms);
+            }
+            printf("\n");
+        }
+
+        if (isScalar)
+            continue;
+        long long gradientDiffs = 0, sampleDiffs = 0;
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            gradientDiffs += gradients[i].dzdx != reference[i].dzdx || gradients[i].dzdy != reference[i].dzdy;
+            for (int product = 0; product < 3; ++product)
+                sampleDiffs += samples[i * 3 + product] != referenceSamples[i * 3 + product];
+        }
+        printf("  %-8s tiles differing from scalar: %lld gradient, %lld product\n", kernels->name, gradientDiffs, sampleDiffs);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string demPath;
+    float spacing = defaultSpacing;
+    float heightScale = 1000.0f;
+    bool benchmark = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--benchmark")
+            benchmark = true;
+        else if (arg == "--spacing" && i + 1 < argc)
+            spacing = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--height-scale" && i + 1 < argc)
+            heightScale = static_cast<float>(std::atof(argv[++i]));
+        else
+            demPath = arg;
+    }
+
+    HeightGrid dem;
+    if (demPath.empty()) {
+        generateDem(generatedSize, generatedHeight, dem);
+    } else if (!loadDem(demPath, heightScale, dem)) {
+        std::cerr << "Failed to load DEM " << demPath << std::endl;
+        return -1;
+    }
+    ElevationPyramid pyramid;
+    pyramid.build(std::move(dem), spacing);
+
+    if (benchmark) {
+        runBenchmark(pyramid);
+        return 0;
+    }
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    std::vector<const TerrainKernels*> kernelSets = supportedTerrainKernels();
+    int kernelIndex = static_cast<int>(kernelSets.size()) - 1;
+    TerrainProcessor processor;
+    processor.kernels = kernelSets[kernelIndex];
+    processor.threadCount = resolveThreadCount();
+    printf("Terrain kernels: %s, %d threads\n", processor.kernels->name, processor.threadCount);
+
+    GradientCache gradients;
+    ProductCache products;
+    ProductRenderer renderer;
+    renderer.init(&camera);
+
+    ShadeSettings settings;
+    std::vector<TileKey> visible;
+    const int productKeys[] = { GLFW_KEY_1, GLFW_KEY_2, GLFW_KEY_3 };
+    bool rotateKeyDown = false, zDownKeyDown = false, zUpKeyDown = false, kernelKeyDown = false;
+    bool rotating = false;
+    int frame = 0;
+    double lastTime = glfwGetTime();
+    double lastTitleTime = lastTime;
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        double now = glfwGetTime();
+        float dt = static_cast<float>(now - lastTime);
+        lastTime = now;
+        camera.processKeyboardInput(window);
+
+        for (int i = 0; i < 3; ++i)
+            if (glfwGetKey(window, productKeys[i]) == GLFW_PRESS)
+                settings.product = static_cast<Product>(i);
+
+        // Arrows turn the sun, R keeps it turning
+        bool rotateKeyPressed = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+        if (rotateKeyPressed && !rotateKeyDown)
+            rotating = !rotating;
+        rotateKeyDown = rotateKeyPressed;
+        float turn = sunTurnRate * dt;
+        if (rotating || glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+            settings.azimuth += turn;
+        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+            settings.azimuth -= turn;
+        settings.azimuth = std::fmod(settings.azimuth + 360.0f, 360.0f);
+        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+            settings.altitude = std::min(90.0f, settings.altitude + turn);
+        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+            settings.altitude = std::max(0.0f, settings.altitude - turn);
+
+        // [ ]: halve or double the vertical exaggeration
+        bool zDownKeyPressed = glfwGetKey(window, GLFW_KEY_LEFT_BRACKET) == GLFW_PRESS;
+        if (zDownKeyPressed && !zDownKeyDown)
+            settings.zFactor = std::max(0.125f, settings.zFactor * 0.5f);
+        zDownKeyDown = zDownKeyPressed;
+        bool zUpKeyPressed = glfwGetKey(window, GLFW_KEY_RIGHT_BRACKET) == GLFW_PRESS;
+        if (zUpKeyPressed && !zUpKeyDown)
+            settings.zFactor = std::min(64.0f, settings.zFactor * 2.0f);
+        zUpKeyDown = zUpKeyPressed;
+
+        bool kernelKeyPressed = glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS;
+        if (kernelKeyPressed && !kernelKeyDown) {
+            kernelIndex = (kernelIndex + 1) % static_cast<int>(kernelSets.size());
+            processor.kernels = kernelSets[kernelIndex];
+        }
+        kernelKeyDown = kernelKeyPressed;
+
+        int level = pyramid.selectLevel(camera, width, height);
+        collectVisibleTiles(camera, pyramid, level, visible);
+        processor.update(pyramid, gradients, products, visible, settings, frame);
+
+        camera.publish(width, height);
+        renderer.render(pyramid, products, visible, settings.key(), frame);
+        products.evict(frame);
+        gradients.evict(frame);
+
+        if (now - lastTitleTime > 0.5) {
+            char title[256];
+            snprintf(title, sizeof(title), "OpenGL - %s, sun %.1f / %.1f deg, z x%.3g | level %d, %zu visible, %d stale | last frame: %lld tiles (%lld gradients) in %.1f ms, %s",
+                     productNames[static_cast<int>(settings.product)], settings.azimuthStep() * sunStepDegrees, settings.altitudeStep() * sunStepDegrees,
+                     settings.zFactor, level, visible.size(), renderer.stale, processor.frameStats.tiles, processor.frameStats.gradients,
+                     processor.frameStats.milliseconds, processor.kernels->name);
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    const TerrainProcessor::Stats& total = processor.totalStats;
+    printf("Product tiles computed: %lld (%lld gradient tiles), %.1f ms total, %.0f Msamples/s\n", total.tiles, total.gradients,
+           total.milliseconds, total.milliseconds > 0.0 ? total.samples / 1e3 / total.milliseconds : 0.0);
+    printf("Product uploads: %d, resident: %zu product tiles, %zu gradient tiles\n", products.getUploads(), products.size(), gradients.size());
+
+    renderer.destroy();
+    products.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
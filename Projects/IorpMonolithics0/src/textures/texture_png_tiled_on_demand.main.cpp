@@ -0,0 +1,731 @@
+// render tiled png on demand: event-driven frame scheduler with damage tracking
+// Instead of clearing and redrawing at vsync rate, the loop asks FrameScheduler whether anything is dirty.
+// When idle it blocks in glfwWaitEventsTimeout, so an untouched viewer uses no CPU and no GPU.
+// Sources of work: camera motion (full damage), a tile arriving from the loader thread (damage limited to
+// that tile's screen rectangle), key toggles and window resize/refresh.
+// The scene is rendered into an offscreen framebuffer that keeps its content between frames; only the
+// damaged rectangles are cleared and redrawn (scissored), then the result is blitted to the window.
+// Keys: WASD pan, Q/E zoom, G toggles the damage overlay.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+const int tileWidth = 256;
+const int tileHeight = 256;
+
+// How long the loop sleeps in glfwWaitEventsTimeout when nothing is dirty (seconds)
+const double idleTimeout = 0.5;
+// Simulated decode/transfer latency per tile, so tiles visibly arrive one after another
+const int tileArrivalDelayMs = 20;
+// Above this many damage rectangles they are collapsed into their bounding box
+const size_t maxDamageRects = 8;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+// Pixel rectangle in framebuffer coordinates (origin bottom-left, like glScissor)
+struct ScreenRect {
+    int x = 0, y = 0, width = 0, height = 0;
+
+    bool empty() const { return width <= 0 || height <= 0; }
+
+    ScreenRect united(const ScreenRect& other) const {
+        if (empty()) return other;
+        if (other.empty()) return *this;
+        ScreenRect r;
+        r.x = std::min(x, other.x);
+        r.y = std::min(y, other.y);
+        r.width = std::max(x + width, other.x + other.width) - r.x;
+        r.height = std::max(y + height, other.y + other.height) - r.y;
+        return r;
+    }
+
+    ScreenRect clipped(int maxWidth, int maxHeight) const {
+        ScreenRect r;
+        r.x = std::max(x, 0);
+        r.y = std::max(y, 0);
+        r.width = std::min(x + width, maxWidth) - r.x;
+        r.height = std::min(y + height, maxHeight) - r.y;
+        return r;
+    }
+
+    bool intersects(const ScreenRect& other) const {
+        return x < other.x + other.width && other.x < x + width &&
+               y < other.y + other.height && other.y < y + height;
+    }
+};
+
+// Decides when a frame is needed and which part of the screen it has to cover.
+// invalidate() may be called from any thread; it wakes the main loop with glfwPostEmptyEvent.
+class FrameScheduler {
+public:
+    void setFramebufferSize(int width, int height) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_width = width;
+        m_height = height;
+        m_fullDamage = true;
+    }
+
+    // Everything must be redrawn (camera moved, resize, mode change)
+    void invalidateAll() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_fullDamage = true;
+        }
+        glfwPostEmptyEvent();
+    }
+
+    // Only this rectangle changed (e.g. a tile arrived)
+    void invalidate(const ScreenRect& rect) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ScreenRect clipped = rect.clipped(m_width, m_height);
+            if (clipped.empty())
+                return;
+            // Merge into an overlapping rectangle, or collapse the list when it grows too long
+            for (ScreenRect& existing : m_damage) {
+                if (existing.intersects(clipped)) {
+                    existing = existing.united(clipped);
+                    clipped = ScreenRect();
+                    break;
+                }
+            }
+            if (!clipped.empty())
+                m_damage.push_back(clipped);
+            if (m_damage.size() > maxDamageRects) {
+                ScreenRect bounds;
+                for (const ScreenRect& r : m_damage)
+                    bounds = bounds.united(r);
+                m_damage.assign(1, bounds);
+            }
+        }
+        glfwPostEmptyEvent();
+    }
+
+    // Image is still correct but the window lost its content (expose); only a blit is needed
+    void requestPresent() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_presentOnly = true;
+    }
+
+    // Continuous input (held keys) keeps the loop polling instead of blocking
+    void setAnimating(bool animating) { m_animating = animating; }
+
+    // Blocks until there is something to do
+    void waitForWork() {
+        if (m_animating || hasWork()) {
+            glfwPollEvents();
+            return;
+        }
+        ++m_idleWaits;
+        glfwWaitEventsTimeout(idleTimeout);
+    }
+
+    bool hasWork() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_fullDamage || !m_damage.empty() || m_presentOnly;
+    }
+
+    // Returns the damage for this frame and resets it; full damage yields one framebuffer-sized rect
+    std::vector<ScreenRect> takeDamage(bool& presentOnly) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<ScreenRect> damage;
+        if (m_fullDamage) {
+            ScreenRect full;
+            full.width = m_width;
+            full.height = m_height;
+            damage.push_back(full);
+            ++m_fullFrames;
+        }
+        else if (!m_damage.empty()) {
+            damage.swap(m_damage);
+            ++m_partialFrames;
+        }
+        presentOnly = damage.empty() && m_presentOnly;
+        m_damage.clear();
+        m_fullDamage = false;
+        m_presentOnly = false;
+        return damage;
+    }
+
+    int getFullFrames() const { return m_fullFrames; }
+    int getPartialFrames() const { return m_partialFrames; }
+    int getIdleWaits() const { return m_idleWaits; }
+
+private:
+    std::mutex m_mutex;
+    std::vector<ScreenRect> m_damage;
+    bool m_fullDamage = true;
+    bool m_presentOnly = false;
+    bool m_animating = false;
+    int m_width = 0, m_height = 0;
+    int m_fullFrames = 0;
+    int m_partialFrames = 0;
+    int m_idleWaits = 0;
+};
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f) {}
+
+    // Returns true when the camera moved this frame
+    bool processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f;  // Adjusted sensitivity
+        glm::vec2 previousOffset = offset;
+        float previousScale = scale;
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+        return offset.x != previousOffset.x || offset.y != previousOffset.y || scale != previousScale;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // Projects a world-space rectangle (x0, y0, x1, y1) to framebuffer pixels, padded by one pixel
+    ScreenRect worldToScreen(const glm::vec4& rect, int framebufferWidth, int framebufferHeight) const {
+        float x0 = (scale * (rect.x + offset.x) + 1.0f) * 0.5f * framebufferWidth;
+        float y0 = (scale * (rect.y + offset.y) + 1.0f) * 0.5f * framebufferHeight;
+        float x1 = (scale * (rect.z + offset.x) + 1.0f) * 0.5f * framebufferWidth;
+        float y1 = (scale * (rect.w + offset.y) + 1.0f) * 0.5f * framebufferHeight;
+        ScreenRect r;
+        r.x = static_cast<int>(std::floor(x0)) - 1;
+        r.y = static_cast<int>(std::floor(y0)) - 1;
+        r.width = static_cast<int>(std::ceil(x1)) + 1 - r.x;
+        r.height = static_cast<int>(std::ceil(y1)) + 1 - r.y;
+        return r;
+    }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    GLuint ubo = 0;
+};
+
+// A decoded tile handed from the loader thread to the GL thread
+struct ArrivedTile {
+    int tileX, tileY;
+    int width, height;
+    std::vector<unsigned char> pixels;
+};
+
+class Texture {
+public:
+    const char* vertexShaderSource = R"(
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTex;
+
+out vec2 texCoord;
+
+void main()
+{
+    gl_Position = viewProjection * vec4(aPos, 0.0, 1.0);
+    texCoord = aTex;
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO, VBO, EBO;
+    GLuint textureID;
+    Camera* m_camera = nullptr;
+    FrameScheduler* m_scheduler = nullptr;
+    int imageWidth = 0, imageHeight = 0;
+    int numTilesX = 0, numTilesY = 0;
+    GLsizei indexCount = 0;
+    int tilesArrived = 0;
+
+    // Reads the header synchronously, then streams the tiles from a loader thread
+    bool init(Camera* camera, FrameScheduler* scheduler, const std::string& imagePath) {
+        m_camera = camera;
+        m_scheduler = scheduler;
+
+        int nrChannels;
+        if (!stbi_info(imagePath.c_str(), &imageWidth, &imageHeight, &nrChannels)) {
+            std::cerr << "Failed to load texture" << std::endl;
+            return false;
+        }
+
+        numTilesX = (imageWidth + tileWidth - 1) / tileWidth;
+        numTilesY = (imageHeight + tileHeight - 1) / tileHeight;
+
+        printf("Image size: %d x %d\n", imageWidth, imageHeight);
+        printf("Number of tiles (X x Y): %d x %d\n", numTilesX, numTilesY);
+
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        m_camera->attachProgram(shaderProgram);
+        buildGeometry();
+
+        // Storage for the full image; tiles are filled in as they arrive
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        std::vector<unsigned char> transparent(static_cast<size_t>(imageWidth) * imageHeight * 4, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, imageWidth, imageHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, transparent.data());
+
+        m_loaderRunning = true;
+        m_loader = std::thread(&Texture::loaderThread, this, imagePath);
+        return true;
+    }
+
+    // Uploads tiles delivered since the last call and reports their screen rectangles as damage
+    void uploadArrivedTiles(int framebufferWidth, int framebufferHeight) {
+        std::deque<ArrivedTile> arrived;
+        {
+            std::lock_guard<std::mutex> lock(m_arrivedMutex);
+            arrived.swap(m_arrived);
+        }
+        if (arrived.empty())
+            return;
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (const ArrivedTile& tile : arrived) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, tile.tileX * tileWidth, tile.tileY * tileHeight,
+                            tile.width, tile.height, GL_RGBA, GL_UNSIGNED_BYTE, tile.pixels.data());
+            m_scheduler->invalidate(m_camera->worldToScreen(tileRect(tile.tileX, tile.tileY), framebufferWidth, framebufferHeight));
+            ++tilesArrived;
+        }
+
+        // Once complete, switch to trilinear filtering; the look changes everywhere so redraw it all
+        if (tilesArrived == numTilesX * numTilesY) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            m_scheduler->invalidateAll();
+            printf("All %d tiles arrived\n", tilesArrived);
+        }
+    }
+
+    // World rectangle (minX, minY, maxX, maxY) where tile (tileX, tileY) is drawn. Tile rows count
+    // down from the top of the image, so row 0 sits at world y = 1.
+    glm::vec4 tileRect(int tileX, int tileY) const {
+        int xOffset = tileX * tileWidth;
+        int yOffset = tileY * tileHeight;
+        int currentTileWidth = std::min(tileWidth, imageWidth - xOffset);
+        int currentTileHeight = std::min(tileHeight, imageHeight - yOffset);
+        return glm::vec4(2.0f * xOffset / imageWidth - 1.0f,
+                         1.0f - 2.0f * (yOffset + currentTileHeight) / imageHeight,
+                         2.0f * (xOffset + currentTileWidth) / imageWidth - 1.0f,
+                         1.0f - 2.0f * yOffset / imageHeight);
+    }
+
+    void render() {
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        m_loaderRunning = false;
+        if (m_loader.joinable())
+            m_loader.join();
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        glDeleteProgram(shaderProgram);
+        glDeleteTextures(1, &textureID);
+    }
+
+private:
+    std::thread m_loader;
+    std::atomic<bool> m_loaderRunning{ false };
+    std::mutex m_arrivedMutex;
+    std::deque<ArrivedTile> m_arrived;
+
+    void buildGeometry() {
+        std::vector<float> vertices;
+        std::vector<GLuint> indices;
+        for (int tileY = 0; tileY < numTilesY; ++tileY) {
+            for (int tileX = 0; tileX < numTilesX; ++tileX) {
+                int xOffset = tileX * tileWidth;
+                int yOffset = tileY * tileHeight;
+                int currentTileWidth = std::min(tileWidth, imageWidth - xOffset);
+                int currentTileHeight = std::min(tileHeight, imageHeight - yOffset);
+
+                glm::vec4 r = tileRect(tileX, tileY);
+                float u0 = static_cast<float>(xOffset) / imageWidth;
+                float u1 = static_cast<float>(xOffset + currentTileWidth) / imageWidth;
+                // The texture holds image row 0 at v = 0; the bottom edge (r.y) takes the tile's last row
+                float v0 = static_cast<float>(yOffset + currentTileHeight) / imageHeight;
+                float v1 = static_cast<float>(yOffset) / imageHeight;
+
+                GLuint base = static_cast<GLuint>(vertices.size() / 4);
+                float quad[] = {
+                    r.x, r.y, u0, v0,
+                    r.x, r.w, u0, v1,
+                    r.z, r.w, u1, v1,
+                    r.z, r.y, u1, v0
+                };
+                vertices.insert(vertices.end(), quad, quad + 16);
+                GLuint quadIndices[] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+                indices.insert(indices.end(), quadIndices, quadIndices + 6);
+            }
+        }
+        indexCount = static_cast<GLsizei>(indices.size());
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+    }
+
+    // Decodes the image, then hands it over tile by tile; each hand-off wakes the main loop
+    void loaderThread(std::string imagePath) {
+        int width, height, nrChannels;
+        unsigned char* data = stbi_load(imagePath.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha);
+        if (!data) {
+            std::cerr << "Failed to load texture" << std::endl;
+            return;
+        }
+
+        for (int tileY = 0; tileY < numTilesY && m_loaderRunning; ++tileY) {
+            for (int tileX = 0; tileX < numTilesX && m_loaderRunning; ++tileX) {
+                ArrivedTile tile;
+                tile.tileX = tileX;
+                tile.tileY = tileY;
+                tile.width = std::min(tileWidth, width - tileX * tileWidth);
+                tile.height = std::min(tileHeight, height - tileY * tileHeight);
+                tile.pixels.resize(static_cast<size_t>(tile.width) * tile.height * 4);
+                for (int row = 0; row < tile.height; ++row) {
+                    const unsigned char* src = data + ((static_cast<size_t>(tileY) * tileHeight + row) * width + tileX * tileWidth) * 4;
+                    memcpy(tile.pixels.data() + static_cast<size_t>(row) * tile.width * 4, src, static_cast<size_t>(tile.width) * 4);
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(tileArrivalDelayMs));
+                {
+                    std::lock_guard<std::mutex> lock(m_arrivedMutex);
+                    m_arrived.push_back(std::move(tile));
+                }
+                glfwPostEmptyEvent();
+            }
+        }
+
+        stbi_image_free(data);
+    }
+};
+
+// Offscreen color target that keeps the previous frame, so damaged regions can be redrawn alone
+class RetainedFramebuffer {
+public:
+    GLuint fbo = 0;
+    GLuint colorTexture = 0;
+    int width = 0, height = 0;
+
+    void resize(int newWidth, int newHeight) {
+        if (newWidth == width && newHeight == height)
+            return;
+        destroy();
+        width = newWidth;
+        height = newHeight;
+
+        glGenTextures(1, &colorTexture);
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void present() {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void destroy() {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (colorTexture) glDeleteTextures(1, &colorTexture);
+        fbo = 0;
+        colorTexture = 0;
+    }
+};
+
+FrameScheduler* g_scheduler = nullptr;
+bool g_showDamage = false;
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    g_scheduler->setFramebufferSize(width, height);
+}
+
+void window_refresh_callback(GLFWwindow* window) {
+    g_scheduler->requestPresent();
+}
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (key == GLFW_KEY_G && action == GLFW_PRESS) {
+        g_showDamage = !g_showDamage;
+        g_scheduler->invalidateAll();
+    }
+}
+
+int main() {
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(1);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    FrameScheduler scheduler;
+    g_scheduler = &scheduler;
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
+    glfwSetKeyCallback(window, key_callback);
+
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    scheduler.setFramebufferSize(width, height);
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    Texture texture;
+    if (!texture.init(&camera, &scheduler, "src/textures/assets/test_nb.png")) {
+        glfwTerminate();
+        return -1;
+    }
+
+    RetainedFramebuffer target;
+    int damageColor = 0;
+
+    // Main loop: sleeps until something is dirty
+    while (!glfwWindowShouldClose(window)) {
+        scheduler.waitForWork();
+
+        glfwGetFramebufferSize(window, &width, &height);
+        if (width == 0 || height == 0) {
+            glfwWaitEvents(); // minimized: nothing can be seen, sleep until restored
+            continue;
+        }
+
+        bool moved = camera.processKeyboardInput(window);
+        scheduler.setAnimating(moved);
+        if (moved)
+            scheduler.invalidateAll();
+
+        texture.uploadArrivedTiles(width, height);
+
+        bool presentOnly = false;
+        std::vector<ScreenRect> damage = scheduler.takeDamage(presentOnly);
+        if (damage.empty() && !presentOnly)
+            continue;
+
+        target.resize(width, height);
+
+        if (!damage.empty()) {
+            camera.publish(width, height);
+
+            glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+            glViewport(0, 0, width, height);
+            glEnable(GL_SCISSOR_TEST);
+            for (const ScreenRect& rect : damage) {
+                ScreenRect r = rect.clipped(width, height);
+                if (r.empty())
+                    continue;
+                glScissor(r.x, r.y, r.width, r.height);
+
+                // Damage overlay: tint each redrawn region with a rotating color
+                if (g_showDamage) {
+                    float tint = 0.1f + 0.1f * (damageColor++ % 3);
+                    glClearColor(tint, 0.0f, 0.2f - tint * 0.5f, 1.0f);
+                }
+                else {
+                    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+                }
+                glClear(GL_COLOR_BUFFER_BIT);
+                texture.render();
+            }
+            glDisable(GL_SCISSOR_TEST);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+
+        target.present();
+        glfwSwapBuffers(window);
+
+        char title[128];
+        snprintf(title, sizeof(title), "OpenGL - full: %d, partial: %d, idle waits: %d",
+                 scheduler.getFullFrames(), scheduler.getPartialFrames(), scheduler.getIdleWaits());
+        glfwSetWindowTitle(window, title);
+    }
+
+    printf("Full frames: %d, partial frames: %d, idle waits: %d\n",
+           scheduler.getFullFrames(), scheduler.getPartialFrames(), scheduler.getIdleWaits());
+
+    texture.destroy();
+    target.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
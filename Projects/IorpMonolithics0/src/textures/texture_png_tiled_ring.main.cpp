@@ -0,0 +1,595 @@
+// render tiled png, all dynamic GPU data streamed through a persistently mapped ring buffer
+// RingBuffer wraps one immutable buffer (glBufferStorage, GL 4.4) that stays mapped with
+// GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT for the lifetime of the program. The buffer is split in
+// three regions; each frame writes into one region and fences it, and a region is only reused once the
+// GPU has signalled its fence. Nothing in the render loop calls glBufferData or glBufferSubData.
+// Per frame the ring carries: the camera block (uniforms), one instance record per visible tile
+// (instance data) and the outline of the visible tiles (vector geometry).
+// Keys: WASD pan, Q/E zoom, G toggles the tile outline.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+const int tileWidth = 256;
+const int tileHeight = 256;
+
+// Uniform buffer binding point reserved for the camera block, shared by all programs
+const GLuint cameraBindingPoint = 0;
+
+// Bytes available to one frame; the ring holds ringRegionCount of these
+const GLsizeiptr ringRegionSize = 4 * 1024 * 1024;
+const int ringRegionCount = 3;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 440 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+// Triple-buffered, persistently mapped stream buffer with per-region fences
+class RingBuffer {
+public:
+    struct Allocation {
+        void* ptr = nullptr;     // CPU write pointer (coherent, no flush needed)
+        GLintptr offset = 0;     // Byte offset inside buffer()
+        GLsizeiptr size = 0;
+    };
+
+    bool init(GLsizeiptr regionSize, int regionCount) {
+        if (!GLEW_ARB_buffer_storage) {
+            std::cerr << "GL_ARB_buffer_storage is not supported" << std::endl;
+            return false;
+        }
+
+        m_regionSize = regionSize;
+        m_regionCount = regionCount;
+        m_fences.assign(regionCount, nullptr);
+
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLsizeiptr totalSize = regionSize * regionCount;
+
+        glGenBuffers(1, &m_buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        glBufferStorage(GL_ARRAY_BUFFER, totalSize, nullptr, flags);
+        m_base = static_cast<uint8_t*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, totalSize, flags));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        if (!m_base) {
+            std::cerr << "Failed to map ring buffer" << std::endl;
+            return false;
+        }
+
+        GLint uniformAlignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+        m_uniformAlignment = uniformAlignment;
+
+        printf("Ring buffer: %d regions x %lld KB\n", regionCount, static_cast<long long>(regionSize / 1024));
+        return true;
+    }
+
+    // Moves to the next region, blocking only if the GPU is still reading it
+    void beginFrame() {
+        GLsync fence = m_fences[m_region];
+        if (fence) {
+            GLenum status = glClientWaitSync(fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) {
+                ++m_stallCount;
+                do {
+                    status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+                } while (status == GL_TIMEOUT_EXPIRED);
+            }
+            glDeleteSync(fence);
+            m_fences[m_region] = nullptr;
+        }
+        m_head = 0;
+    }
+
+    // Sub-allocates from the current region; returns an empty allocation when the region is full
+    Allocation allocate(GLsizeiptr size, GLsizeiptr alignment) {
+        Allocation allocation;
+        GLsizeiptr start = (m_head + alignment - 1) / alignment * alignment;
+        if (start + size > m_regionSize) {
+            ++m_overflowCount;
+            return allocation;
+        }
+
+        allocation.offset = m_region * m_regionSize + start;
+        allocation.ptr = m_base + allocation.offset;
+        allocation.size = size;
+        m_head = start + size;
+        m_peakBytes = std::max(m_peakBytes, m_head);
+        return allocation;
+    }
+
+    Allocation allocateUniform(GLsizeiptr size) {
+        return allocate(size, m_uniformAlignment);
+    }
+
+    // Fences everything issued from the current region and advances the ring
+    void endFrame() {
+        m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_region = (m_region + 1) % m_regionCount;
+    }
+
+    void destroy() {
+        for (GLsync fence : m_fences)
+            if (fence)
+                glDeleteSync(fence);
+        if (m_buffer) {
+            glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            glDeleteBuffers(1, &m_buffer);
+        }
+    }
+
+    GLuint buffer() const { return m_buffer; }
+    int getStallCount() const { return m_stallCount; }
+    int getOverflowCount() const { return m_overflowCount; }
+    GLsizeiptr getPeakBytes() const { return m_peakBytes; }
+
+private:
+    GLuint m_buffer = 0;
+    uint8_t* m_base = nullptr;
+    GLsizeiptr m_regionSize = 0;
+    int m_regionCount = 0;
+    int m_region = 0;
+    GLsizeiptr m_head = 0;
+    GLsizeiptr m_uniformAlignment = 256;
+    std::vector<GLsync> m_fences;
+    int m_stallCount = 0;
+    int m_overflowCount = 0;
+    GLsizeiptr m_peakBytes = 0;
+};
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f;  // Adjusted sensitivity
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    // Writes this frame's block into the ring and binds that range to the shared binding point
+    void publish(RingBuffer& ring, int framebufferWidth, int framebufferHeight) {
+        RingBuffer::Allocation allocation = ring.allocateUniform(sizeof(BlockData));
+        if (!allocation.ptr)
+            return;
+
+        BlockData* data = static_cast<BlockData*>(allocation.ptr);
+        data->viewProjection = getTransform();
+        data->viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data->cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBufferRange(GL_UNIFORM_BUFFER, cameraBindingPoint, ring.buffer(), allocation.offset, allocation.size);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+};
+
+class Texture {
+public:
+    // One unit quad per instance; the instance record places it and selects its texture window
+    const char* vertexShaderSource = R"(
+layout (location = 0) in vec4 aRect;    // instance: x0, y0, x1, y1 in world space
+layout (location = 1) in vec4 aUvRect;  // instance: u0, v0, u1, v1
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(aRect.xy, aRect.zw, corner), 0.0, 1.0);
+    texCoord = mix(aUvRect.xy, aUvRect.zw, corner);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 440 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+
+    struct TileInstance {
+        glm::vec4 rect;
+        glm::vec4 uvRect;
+    };
+
+    GLuint shaderProgram;
+    GLuint VAO;
+    GLuint textureID;
+    Camera* m_camera = nullptr;
+    RingBuffer* m_ring = nullptr;
+    int imageWidth, imageHeight;
+    int numTilesX, numTilesY;
+    int visibleTiles = 0;
+
+    void init(Camera* camera, RingBuffer* ring, const std::string& imagePath) {
+        m_camera = camera;
+        m_ring = ring;
+
+        int nrChannels;
+        unsigned char* data = stbi_load(imagePath.c_str(), &imageWidth, &imageHeight, &nrChannels, STBI_rgb_alpha);
+        if (!data) {
+            std::cerr << "Failed to load texture" << std::endl;
+            return;
+        }
+
+        numTilesX = (imageWidth + tileWidth - 1) / tileWidth;
+        numTilesY = (imageHeight + tileHeight - 1) / tileHeight;
+
+        printf("Image size: %d x %d\n", imageWidth, imageHeight);
+        printf("Number of tiles (X x Y): %d x %d\n", numTilesX, numTilesY);
+
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        m_camera->attachProgram(shaderProgram);
+
+        // The VAO reads instance attributes straight out of the ring buffer
+        glGenVertexArrays(1, &VAO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_ring->buffer());
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TileInstance), (void*)0);
+        glVertexAttribDivisor(0, 1);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(TileInstance), (void*)offsetof(TileInstance, uvRect));
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, imageWidth, imageHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        stbi_image_free(data);
+    }
+
+    // World-space rectangle of a tile, shared with the outline overlay
+    glm::vec4 tileRect(int tileX, int tileY) const {
+        int xOffset = tileX * tileWidth;
+        int yOffset = tileY * tileHeight;
+        int currentTileWidth = std::min(tileWidth, imageWidth - xOffset);
+        int currentTileHeight = std::min(tileHeight, imageHeight - yOffset);
+        return glm::vec4(2.0f * xOffset / imageWidth - 1.0f,
+                         2.0f * yOffset / imageHeight - 1.0f,
+                         2.0f * (xOffset + currentTileWidth) / imageWidth - 1.0f,
+                         2.0f * (yOffset + currentTileHeight) / imageHeight - 1.0f);
+    }
+
+    bool isTileVisible(const glm::vec4& rect, const glm::vec4& view) const {
+        return rect.z > view.x && rect.x < view.z && rect.w > view.y && rect.y < view.w;
+    }
+
+    void render() {
+        glm::vec4 view = m_camera->getVisibleRect();
+
+        // Write one instance per visible tile directly into mapped memory
+        GLsizeiptr maxBytes = static_cast<GLsizeiptr>(numTilesX) * numTilesY * sizeof(TileInstance);
+        RingBuffer::Allocation allocation = m_ring->allocate(maxBytes, sizeof(TileInstance));
+        if (!allocation.ptr)
+            return;
+
+        TileInstance* instances = static_cast<TileInstance*>(allocation.ptr);
+        visibleTiles = 0;
+        for (int tileY = 0; tileY < numTilesY; ++tileY) {
+            for (int tileX = 0; tileX < numTilesX; ++tileX) {
+                glm::vec4 rect = tileRect(tileX, tileY);
+                if (!isTileVisible(rect, view))
+                    continue;
+
+                int xOffset = tileX * tileWidth;
+                int yOffset = tileY * tileHeight;
+                int currentTileWidth = std::min(tileWidth, imageWidth - xOffset);
+                int currentTileHeight = std::min(tileHeight, imageHeight - yOffset);
+
+                TileInstance& instance = instances[visibleTiles++];
+                instance.rect = rect;
+                instance.uvRect = glm::vec4(static_cast<float>(xOffset) / imageWidth,
+                                            1.0f - static_cast<float>(yOffset) / imageHeight,
+                                            static_cast<float>(xOffset + currentTileWidth) / imageWidth,
+                                            1.0f - static_cast<float>(yOffset + currentTileHeight) / imageHeight);
+            }
+        }
+        if (visibleTiles == 0)
+            return;
+
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+
+        // baseInstance selects this frame's records without touching the VAO
+        GLuint baseInstance = static_cast<GLuint>(allocation.offset / sizeof(TileInstance));
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, visibleTiles, baseInstance);
+
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+        glDeleteTextures(1, &textureID);
+    }
+};
+
+// Outlines the visible tiles; the line list is regenerated into the ring every frame
+class TileOutline {
+public:
+    const char* vertexShaderSource = R"(
+layout (location = 0) in vec2 aPos;
+
+void main()
+{
+    gl_Position = viewProjection * vec4(aPos, 0.0, 1.0);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 440 core
+out vec4 FragColor;
+
+uniform vec4 lineColor;
+
+void main()
+{
+    FragColor = lineColor;
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO;
+    RingBuffer* m_ring = nullptr;
+
+    void init(Camera* camera, RingBuffer* ring) {
+        m_ring = ring;
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+
+        glGenVertexArrays(1, &VAO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_ring->buffer());
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+
+        glUseProgram(shaderProgram);
+        glUniform4f(glGetUniformLocation(shaderProgram, "lineColor"), 1.0f, 1.0f, 0.0f, 0.6f);
+        glUseProgram(0);
+    }
+
+    void render(const Texture& texture, const Camera& camera) {
+        glm::vec4 view = camera.getVisibleRect();
+
+        // 4 line segments (8 vertices) per tile
+        const GLsizeiptr vertexSize = 2 * sizeof(float);
+        GLsizeiptr maxBytes = static_cast<GLsizeiptr>(texture.numTilesX) * texture.numTilesY * 8 * vertexSize;
+        RingBuffer::Allocation allocation = m_ring->allocate(maxBytes, vertexSize);
+        if (!allocation.ptr)
+            return;
+
+        float* out = static_cast<float*>(allocation.ptr);
+        GLsizei vertexCount = 0;
+        for (int tileY = 0; tileY < texture.numTilesY; ++tileY) {
+            for (int tileX = 0; tileX < texture.numTilesX; ++tileX) {
+                glm::vec4 r = texture.tileRect(tileX, tileY);
+                if (!texture.isTileVisible(r, view))
+                    continue;
+                float segments[] = {
+                    r.x, r.y, r.z, r.y,
+                    r.z, r.y, r.z, r.w,
+                    r.z, r.w, r.x, r.w,
+                    r.x, r.w, r.x, r.y
+                };
+                memcpy(out + vertexCount * 2, segments, sizeof(segments));
+                vertexCount += 8;
+            }
+        }
+        if (vertexCount == 0)
+            return;
+
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        glDrawArrays(GL_LINES, static_cast<GLint>(allocation.offset / vertexSize), vertexCount);
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+    }
+};
+
+int main() {
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    // Persistent mapping needs GL 4.4 (or ARB_buffer_storage)
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    glewExperimental = GL_TRUE;
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    RingBuffer ring;
+    if (!ring.init(ringRegionSize, ringRegionCount)) {
+        glfwTerminate();
+        return -1;
+    }
+
+    Camera camera;
+    Texture texture;
+    texture.init(&camera, &ring, "src/textures/assets/test_nb.png");
+
+    TileOutline outline;
+    outline.init(&camera, &ring);
+
+    bool showOutline = false;
+    bool outlineKeyDown = false;
+    int frameCount = 0;
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool outlineKeyPressed = glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS;
+        if (outlineKeyPressed && !outlineKeyDown)
+            showOutline = !showOutline;
+        outlineKeyDown = outlineKeyPressed;
+
+        ring.beginFrame();
+
+        camera.publish(ring, width, height);
+        texture.render();
+        if (showOutline)
+            outline.render(texture, camera);
+
+        ring.endFrame();
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frameCount;
+    }
+
+    printf("Frames: %d, ring stalls: %d, overflows: %d, peak bytes per frame: %lld\n",
+           frameCount, ring.getStallCount(), ring.getOverflowCount(), static_cast<long long>(ring.getPeakBytes()));
+
+    outline.destroy();
+    texture.destroy();
+    ring.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,463 @@
+// render tiled png, camera published once per frame through a uniform buffer
+// The Camera owns a std140 uniform block bound to a fixed binding point. Every program that declares
+// the "CameraBlock" reads view/projection from it, so drawing a tile no longer uploads a matrix.
+// The tile quads are static and built once in init(); render() issues no uniform or buffer uploads.
+// Keys: WASD pan, Q/E zoom, G toggles the tile grid overlay (a second program sharing the same block).
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+const int tileWidth = 256;
+const int tileHeight = 256;
+
+// Uniform buffer binding point reserved for the camera block, shared by all programs
+const GLuint cameraBindingPoint = 0;
+
+// GLSL declaration of the camera block, prepended to every vertex shader that needs the camera
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+// Links a program whose vertex shader is "#version" + camera block + body
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+class Camera {
+public:
+    // Mirrors CameraBlock with std140 layout: mat4 = 4 x vec4, vec4 aligned to 16 bytes
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f;  // Adjusted sensitivity
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // Allocates the uniform buffer and attaches it to the shared binding point
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    // Connects a program's CameraBlock to the shared binding point (once, after linking)
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    // Uploads the camera state once per frame; skipped when nothing has changed
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        if (published && memcmp(&data, &lastPublished, sizeof(BlockData)) == 0)
+            return;
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        lastPublished = data;
+        published = true;
+        ++uploadCount;
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+    int getUploadCount() const { return uploadCount; }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    GLuint ubo = 0;
+    BlockData lastPublished;
+    bool published = false;
+    int uploadCount = 0;
+};
+
+class Texture {
+public:
+    // Vertex Shader Body (camera block is prepended by createCameraShaderProgram)
+    const char* vertexShaderSource = R"(
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTex;
+
+out vec2 texCoord;
+
+void main()
+{
+    gl_Position = viewProjection * vec4(aPos, 0.0, 1.0);
+    texCoord = aTex;
+}
+)";
+
+    // Fragment Shader Source
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO, VBO, EBO;
+    GLuint textureID;
+    Camera* m_camera = nullptr;
+    int imageWidth, imageHeight;
+    int numTilesX, numTilesY;
+    GLsizei indexCount = 0;
+
+    void init(Camera* camera, const std::string& imagePath) {
+        m_camera = camera;
+
+        // Load image using stb_image
+        int nrChannels;
+        unsigned char* data = stbi_load(imagePath.c_str(), &imageWidth, &imageHeight, &nrChannels, STBI_rgb_alpha);
+        if (!data) {
+            std::cerr << "Failed to load texture" << std::endl;
+            return;
+        }
+
+        numTilesX = (imageWidth + tileWidth - 1) / tileWidth;
+        numTilesY = (imageHeight + tileHeight - 1) / tileHeight;
+
+        printf("Image size: %d x %d\n", imageWidth, imageHeight);
+        printf("Number of tiles (X x Y): %d x %d\n", numTilesX, numTilesY);
+
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        m_camera->attachProgram(shaderProgram);
+
+        // Build every tile quad once: the image spans [-1, 1] and the camera block places it
+        std::vector<float> vertices;
+        std::vector<GLuint> indices;
+        vertices.reserve(numTilesX * numTilesY * 16);
+        indices.reserve(numTilesX * numTilesY * 6);
+        for (int tileY = 0; tileY < numTilesY; ++tileY) {
+            for (int tileX = 0; tileX < numTilesX; ++tileX) {
+                int xOffset = tileX * tileWidth;
+                int yOffset = tileY * tileHeight;
+                int currentTileWidth = std::min(tileWidth, imageWidth - xOffset);
+                int currentTileHeight = std::min(tileHeight, imageHeight - yOffset);
+
+                float x0 = 2.0f * xOffset / imageWidth - 1.0f;
+                float y0 = 2.0f * yOffset / imageHeight - 1.0f;
+                float x1 = 2.0f * (xOffset + currentTileWidth) / imageWidth - 1.0f;
+                float y1 = 2.0f * (yOffset + currentTileHeight) / imageHeight - 1.0f;
+                float u0 = static_cast<float>(xOffset) / imageWidth;
+                float u1 = static_cast<float>(xOffset + currentTileWidth) / imageWidth;
+                float v0 = 1.0f - static_cast<float>(yOffset) / imageHeight;
+                float v1 = 1.0f - static_cast<float>(yOffset + currentTileHeight) / imageHeight;
+
+                GLuint base = static_cast<GLuint>(vertices.size() / 4);
+                float quad[] = {
+                    // Positions  // Texture Coords
+                    x0, y0,       u0, v0,
+                    x0, y1,       u0, v1,
+                    x1, y1,       u1, v1,
+                    x1, y0,       u1, v0
+                };
+                vertices.insert(vertices.end(), quad, quad + 16);
+                GLuint quadIndices[] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+                indices.insert(indices.end(), quadIndices, quadIndices + 6);
+            }
+        }
+        indexCount = static_cast<GLsizei>(indices.size());
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+
+        glBindVertexArray(VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0); // Position
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float))); // Texture Coordinate
+        glEnableVertexAttribArray(1);
+
+        glBindVertexArray(0);
+
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, imageWidth, imageHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        stbi_image_free(data);
+    }
+
+    void render() {
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+
+        // All tiles share one texture and static geometry, so they go out in a single draw
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        glDeleteProgram(shaderProgram);
+        glDeleteTextures(1, &textureID);
+    }
+};
+
+// Draws the tile borders with a second program that reads the same CameraBlock
+class TileGrid {
+public:
+    const char* vertexShaderSource = R"(
+layout (location = 0) in vec2 aPos;
+
+void main()
+{
+    gl_Position = viewProjection * vec4(aPos, 0.0, 1.0);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+uniform vec4 lineColor;
+
+void main()
+{
+    FragColor = lineColor;
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO, VBO;
+    GLsizei vertexCount = 0;
+
+    void init(Camera* camera, const Texture& texture) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+
+        // Vertical and horizontal lines at every tile boundary
+        std::vector<float> lines;
+        for (int tileX = 0; tileX <= texture.numTilesX; ++tileX) {
+            float x = 2.0f * std::min(tileX * tileWidth, texture.imageWidth) / texture.imageWidth - 1.0f;
+            float segment[] = { x, -1.0f, x, 1.0f };
+            lines.insert(lines.end(), segment, segment + 4);
+        }
+        for (int tileY = 0; tileY <= texture.numTilesY; ++tileY) {
+            float y = 2.0f * std::min(tileY * tileHeight, texture.imageHeight) / texture.imageHeight - 1.0f;
+            float segment[] = { -1.0f, y, 1.0f, y };
+            lines.insert(lines.end(), segment, segment + 4);
+        }
+        vertexCount = static_cast<GLsizei>(lines.size() / 2);
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, lines.size() * sizeof(float), lines.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+
+        // The color never changes, so it is set once here rather than per frame
+        glUseProgram(shaderProgram);
+        glUniform4f(glGetUniformLocation(shaderProgram, "lineColor"), 1.0f, 1.0f, 0.0f, 0.6f);
+        glUseProgram(0);
+    }
+
+    void render() {
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        glDrawArrays(GL_LINES, 0, vertexCount);
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteProgram(shaderProgram);
+    }
+};
+
+int main() {
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    // Set GLFW options
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    // Create window
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    // Initialize GLEW
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    // Enable blending for transparency
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    Texture texture;
+    texture.init(&camera, "src/textures/assets/test_nb.png");
+
+    TileGrid grid;
+    grid.init(&camera, texture);
+
+    bool showGrid = false;
+    bool gridKeyDown = false;
+    int frameCount = 0;
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool gridKeyPressed = glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS;
+        if (gridKeyPressed && !gridKeyDown)
+            showGrid = !showGrid;
+        gridKeyDown = gridKeyPressed;
+
+        // One upload per frame, consumed by every program below
+        camera.publish(width, height);
+
+        texture.render();
+        if (showGrid)
+            grid.render();
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frameCount;
+    }
+
+    printf("Frames: %d, camera uploads: %d\n", frameCount, camera.getUploadCount());
+
+    grid.destroy();
+    texture.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
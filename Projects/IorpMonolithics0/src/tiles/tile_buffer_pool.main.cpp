@@ -0,0 +1,1222 @@
+// tiled pyramid viewer with pooled tile buffers and per-thread scratch arenas for the decoders
+// Tiles are stored PNG-compressed and decoded on demand, so streaming does real decode work. Without help
+// every decoded tile costs several heap allocations (stb's temporaries, its output image, the tile's pixel
+// buffer) that are freed again a frame later. Here:
+//   - TileBufferPool hands out fixed-size, 64-byte aligned slabs for tile pixels and takes them back after
+//     upload; slabs are recycled through a free list instead of going back to the heap
+//   - each decoder thread owns a ScratchArena; stb_image allocates through it (STBI_MALLOC / STBI_REALLOC /
+//     STBI_FREE) and the arena is reset after every tile, so its chunks are reused for the next decode
+//   - a TIFF source is read with TIFFReadRGBAImageOriented into arena memory (libtiff has no allocator hook;
+//     the raster it is given is by far its largest allocation)
+// M switches both off for comparison; the title shows allocations avoided and peak bytes held.
+// Usage: tile_buffer_pool [image]   Keys: WASD pan, Q/E zoom, Z zoom sweep, P prefetch, M pool/arenas on/off.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <tiffio.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+// stb_image allocates through the calling thread's scratch arena, if it has one (defined below)
+void* scratchMalloc(size_t size);
+void* scratchRealloc(void* pointer, size_t size);
+void scratchFree(void* pointer);
+#define STBI_MALLOC(size) scratchMalloc(size)
+#define STBI_REALLOC(pointer, size) scratchRealloc(pointer, size)
+#define STBI_FREE(pointer) scratchFree(pointer)
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+const int tileSize = 128;
+
+// Level of Detail (LOD) bias, typically in the range -0.5 to 0.5
+float lodBias = 0.0f;
+
+// Loader configuration: decoder thread count
+const int loaderThreadCount = 2;
+
+// GPU tile cache budget (tiles) and upload throttle (tiles per frame)
+const size_t gpuTileBudget = 192;
+const int maxUploadsPerFrame = 8;
+
+// Prediction: how far ahead the camera path is extrapolated, and the sampling step along it (seconds)
+const float predictionHorizon = 0.6f;
+const float predictionStep = 0.1f;
+// Time constant of the velocity smoothing (seconds)
+const float velocitySmoothing = 0.15f;
+// Zoom rates below this (ln(scale) per second) are treated as "not zooming"
+const float zoomRateThreshold = 0.05f;
+
+// Priority weights: seconds-equivalent cost of one level away from the current LOD / of one half view extent
+const float levelWeight = 0.5f;
+const float distanceWeight = 0.1f;
+
+// Z key: zoom in by this many levels over this many frames
+const int zoomSweepLevels = 5;
+const int zoomSweepFrames = 30;
+
+// Scratch arena chunk size; one PNG tile decode fits in a single chunk
+const size_t scratchChunkSize = 256 * 1024;
+
+// Slab alignment, enough for any SIMD load and for cache-line separation
+const size_t slabAlignment = 64;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+// Identifies one tile of the pyramid
+struct TileKey {
+    int level = 0, x = 0, y = 0;
+
+    uint64_t packed() const {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+    }
+    TileKey parent() const {
+        TileKey p;
+        p.level = level + 1;
+        p.x = x / 2;
+        p.y = y / 2;
+        return p;
+    }
+};
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f), velocity(0.0f, 0.0f), zoomRate(0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    void zoomBy(float factor) {
+        scale *= factor;
+    }
+
+    // Measures how fast offset and scale changed since the last call, smoothed exponentially
+    void updateMotion(double now) {
+        if (lastTime < 0.0) {
+            lastTime = now;
+            lastOffset = offset;
+            lastScale = scale;
+            return;
+        }
+        float dt = static_cast<float>(now - lastTime);
+        if (dt <= 0.0f)
+            return;
+
+        glm::vec2 instantVelocity = (offset - lastOffset) / dt;
+        float instantZoomRate = std::log(scale / lastScale) / dt;
+        float alpha = 1.0f - std::exp(-dt / velocitySmoothing);
+        velocity += (instantVelocity - velocity) * alpha;
+        zoomRate += (instantZoomRate - zoomRate) * alpha;
+
+        lastTime = now;
+        lastOffset = offset;
+        lastScale = scale;
+    }
+
+    // Camera extrapolated t seconds ahead along the current pan/zoom motion
+    Camera predicted(float t) const {
+        Camera c = *this;
+        c.offset = offset + velocity * t;
+        c.scale = scale * std::exp(zoomRate * t);
+        return c;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    glm::vec2 getCenter() const { return -offset; }
+    float getScale() const { return scale; }
+    float getZoomRate() const { return zoomRate; }
+    glm::vec2 getVelocity() const { return velocity; }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    glm::vec2 velocity;   // world units per second (of offset)
+    float zoomRate;       // d ln(scale) / dt
+    double lastTime = -1.0;
+    glm::vec2 lastOffset;
+    float lastScale = 1.0f;
+    GLuint ubo = 0;
+};
+
+// Allocation counters shared by all threads
+struct AllocationStats {
+    std::atomic<long long> slabAllocations{ 0 };   // tile buffers taken from the heap
+    std::atomic<long long> slabReuses{ 0 };        // tile buffers served from the free list
+    std::atomic<long long> scratchServed{ 0 };     // stb allocations served by an arena
+    std::atomic<long long> scratchChunks{ 0 };     // arena chunks taken from the heap
+    std::atomic<long long> heapFallbacks{ 0 };     // stb allocations that went to the heap (no arena)
+    std::atomic<size_t> scratchPeakBytes{ 0 };     // largest capacity any single arena reached
+};
+
+AllocationStats allocationStats;
+
+void* alignedAllocate(size_t size, size_t alignment) {
+#ifdef _MSC_VER
+    return _aligned_malloc(size, alignment);
+#else
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void alignedFree(void* pointer) {
+#ifdef _MSC_VER
+    _aligned_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+
+// Fixed-size, aligned slabs for tile pixels, recycled through a free list instead of being returned to the heap.
+// With enabled == false every acquire/release goes to the heap, as a plain std::vector per tile would.
+class TileBufferPool {
+public:
+    std::atomic<bool> enabled{ true };
+
+    void init(size_t slabBytes) {
+        m_slabBytes = slabBytes;
+    }
+
+    unsigned char* acquire() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (enabled && !m_free.empty()) {
+                unsigned char* slab = m_free.back();
+                m_free.pop_back();
+                ++allocationStats.slabReuses;
+                return slab;
+            }
+            m_heldBytes += m_slabBytes;
+            m_peakBytes = std::max(m_peakBytes, m_heldBytes);
+        }
+        ++allocationStats.slabAllocations;
+        return static_cast<unsigned char*>(alignedAllocate(m_slabBytes, slabAlignment));
+    }
+
+    void release(unsigned char* slab) {
+        if (!slab)
+            return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (enabled) {
+            m_free.push_back(slab);
+        } else {
+            alignedFree(slab);
+            m_heldBytes -= m_slabBytes;
+        }
+    }
+
+    // Returns the idle slabs to the heap (after switching the pool off, or at exit)
+    void trim() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (unsigned char* slab : m_free)
+            alignedFree(slab);
+        m_heldBytes -= m_free.size() * m_slabBytes;
+        m_free.clear();
+    }
+
+    size_t getSlabBytes() const { return m_slabBytes; }
+    size_t getPeakBytes() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_peakBytes;
+    }
+
+    void destroy() { trim(); }
+
+private:
+    std::mutex m_mutex;
+    std::vector<unsigned char*> m_free;
+    size_t m_slabBytes = 0;
+    size_t m_heldBytes = 0;   // slabs alive: free plus handed out
+    size_t m_peakBytes = 0;
+};
+
+// Bump allocator for one thread's decoder temporaries. Individual frees are no-ops; reset() releases everything
+// at once and keeps the chunks for the next decode. Each block carries its size so realloc can copy it.
+class ScratchArena {
+public:
+    ScratchArena() = default;
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    ~ScratchArena() {
+        for (Chunk& chunk : m_chunks)
+            alignedFree(chunk.data);
+    }
+
+    void* allocate(size_t size) {
+        size_t needed = headerSize + ((size + headerSize - 1) & ~(headerSize - 1));
+        while (m_current < m_chunks.size() && m_chunks[m_current].used + needed > m_chunks[m_current].size)
+            ++m_current;
+        if (m_current == m_chunks.size()) {
+            Chunk chunk;
+            chunk.size = std::max(scratchChunkSize, needed);
+            chunk.data = static_cast<unsigned char*>(alignedAllocate(chunk.size, headerSize));
+            m_chunks.push_back(chunk);
+            m_capacity += chunk.size;
+            ++allocationStats.scratchChunks;
+            size_t peak = allocationStats.scratchPeakBytes;
+            while (m_capacity > peak && !allocationStats.scratchPeakBytes.compare_exchange_weak(peak, m_capacity)) {
+            }
+        }
+
+        Chunk& chunk = m_chunks[m_current];
+        unsigned char* block = chunk.data + chunk.used;
+        chunk.used += needed;
+        *reinterpret_cast<size_t*>(block) = size;
+        ++allocationStats.scratchServed;
+        return block + headerSize;
+    }
+
+    void* reallocate(void* pointer, size_t size) {
+        if (!pointer)
+            return allocate(size);
+        size_t oldSize = *reinterpret_cast<size_t*>(static_cast<unsigned char*>(pointer) - headerSize);
+        if (size <= oldSize)
+            return pointer;
+        void* grown = allocate(size);
+        memcpy(grown, pointer, oldSize);
+        return grown;
+    }
+
+    void reset() {
+        for (Chunk& chunk : m_chunks)
+            chunk.used = 0;
+        m_current = 0;
+    }
+
+private:
+    static const size_t headerSize = 16;   // keeps blocks 16-byte aligned
+    struct Chunk {
+        unsigned char* data = nullptr;
+        size_t size = 0;
+        size_t used = 0;
+    };
+    std::vector<Chunk> m_chunks;
+    size_t m_current = 0;
+    size_t m_capacity = 0;
+};
+
+// Arena the current thread's stb allocations go to; null means the heap
+thread_local ScratchArena* currentScratchArena = nullptr;
+
+void* scratchMalloc(size_t size) {
+    if (currentScratchArena)
+        return currentScratchArena->allocate(size);
+    ++allocationStats.heapFallbacks;
+    return std::malloc(size);
+}
+
+void* scratchRealloc(void* pointer, size_t size) {
+    if (currentScratchArena)
+        return currentScratchArena->reallocate(pointer, size);
+    ++allocationStats.heapFallbacks;
+    return std::realloc(pointer, size);
+}
+
+void scratchFree(void* pointer) {
+    if (!currentScratchArena)
+        std::free(pointer);
+}
+
+// Routes the current thread's stb allocations to an arena (or to the heap for arena == nullptr) and resets
+// the arena when the scope ends; nothing allocated inside may be used after that
+class ScratchScope {
+public:
+    explicit ScratchScope(ScratchArena* arena) : m_previous(currentScratchArena), m_arena(arena) {
+        currentScratchArena = arena;
+    }
+    ~ScratchScope() {
+        currentScratchArena = m_previous;
+        if (m_arena)
+            m_arena->reset();
+    }
+
+private:
+    ScratchArena* m_previous;
+    ScratchArena* m_arena;
+};
+
+// Image plus its reduced levels, each tile kept PNG-compressed and decoded when requested.
+// World mapping keeps the aspect ratio: x spans [-1, 1], y spans [-h/w, h/w], row 0 at the top.
+class TilePyramid {
+public:
+    bool load(const std::string& imagePath) {
+        // The full-size decode is the biggest temporary of all; it lives in an arena that dies with this scope
+        ScratchArena arena;
+        ScratchScope scope(&arena);
+
+        int width, height;
+        unsigned char* data = decodeImage(imagePath, arena, width, height);
+        if (!data) {
+            std::cerr << "Failed to load texture" << std::endl;
+            return false;
+        }
+
+        std::vector<unsigned char> pixels(data, data + static_cast<size_t>(width) * height * 4);
+        size_t encodedBytes = 0;
+        for (;;) {
+            Level level;
+            level.width = width;
+            level.height = height;
+            encodeTiles(pixels, level);
+            for (const std::vector<unsigned char>& tile : level.tiles)
+                encodedBytes += tile.size();
+            m_levels.push_back(std::move(level));
+
+            // Halve until the whole level fits in one tile
+            if (width <= tileSize && height <= tileSize)
+                break;
+            int halfWidth = (width + 1) / 2, halfHeight = (height + 1) / 2;
+            std::vector<unsigned char> half;
+            downsample(pixels, width, height, half, halfWidth, halfHeight);
+            pixels.swap(half);
+            width = halfWidth;
+            height = halfHeight;
+        }
+
+        printf("Image size: %d x %d, levels: %d, tile size: %d, PNG tiles: %.2f MB\n",
+               levelWidth(0), levelHeight(0), levelCount(), tileSize, encodedBytes / 1048576.0);
+        return true;
+    }
+
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    int levelWidth(int level) const { return m_levels[level].width; }
+    int levelHeight(int level) const { return m_levels[level].height; }
+    int tilesX(int level) const { return (levelWidth(level) + tileSize - 1) / tileSize; }
+    int tilesY(int level) const { return (levelHeight(level) + tileSize - 1) / tileSize; }
+
+    bool isValid(const TileKey& key) const {
+        return key.level >= 0 && key.level < levelCount() &&
+               key.x >= 0 && key.x < tilesX(key.level) && key.y >= 0 && key.y < tilesY(key.level);
+    }
+
+    // Decodes one tile into a caller-provided buffer of at least tileSize * tileSize * 4 bytes (thread-safe).
+    // stb's temporaries and output go to the calling thread's scratch arena, if it has one.
+    void readTile(const TileKey& key, unsigned char* pixels, int& width, int& height) const {
+        const Level& level = m_levels[key.level];
+        const std::vector<unsigned char>& encoded = level.tiles[static_cast<size_t>(key.y) * tilesX(key.level) + key.x];
+        width = std::min(tileSize, level.width - key.x * tileSize);
+        height = std::min(tileSize, level.height - key.y * tileSize);
+
+        int decodedWidth, decodedHeight, nrChannels;
+        unsigned char* data = stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()),
+                                                    &decodedWidth, &decodedHeight, &nrChannels, STBI_rgb_alpha);
+        if (!data || decodedWidth != width || decodedHeight != height) {
+            memset(pixels, 0, static_cast<size_t>(width) * height * 4);
+        } else {
+            memcpy(pixels, data, static_cast<size_t>(width) * height * 4);
+        }
+        stbi_image_free(data);
+    }
+
+    // World units per level-0 pixel
+    float worldPerPixel() const { return 2.0f / m_levels[0].width; }
+
+    // World-space rectangle of a tile (min.x, min.y, max.x, max.y)
+    glm::vec4 tileRect(const TileKey& key) const {
+        int width0 = m_levels[0].width, height0 = m_levels[0].height;
+        int px0 = std::min(key.x * tileSize << key.level, width0);
+        int py0 = std::min(key.y * tileSize << key.level, height0);
+        int px1 = std::min((key.x + 1) * tileSize << key.level, width0);
+        int py1 = std::min((key.y + 1) * tileSize << key.level, height0);
+        float p = worldPerPixel();
+        float top = height0 * p * 0.5f;
+        return glm::vec4(px0 * p - 1.0f, top - py1 * p, px1 * p - 1.0f, top - py0 * p);
+    }
+
+    // Level whose texel density best matches the screen for this camera
+    int selectLevel(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        float texelsPerScreenPixel = 1.0f / (worldPerPixel() * screenPixelsPerWorld);
+        int level = static_cast<int>(std::floor(std::log2(std::max(texelsPerScreenPixel, 1e-6f)) + lodBias));
+        return std::max(0, std::min(level, levelCount() - 1));
+    }
+
+    // Continuous level (before flooring), used to predict level switches
+    float levelPosition(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        return std::log2(1.0f / (worldPerPixel() * screenPixelsPerWorld)) + lodBias;
+    }
+
+    // Range of tiles of a level that intersect a world rectangle; false if none
+    bool tileRange(int level, const glm::vec4& rect, int& x0, int& y0, int& x1, int& y1) const {
+        float p = worldPerPixel() * static_cast<float>(1 << level) * tileSize;  // world size of one tile
+        float top = m_levels[0].height * worldPerPixel() * 0.5f;
+        x0 = std::max(0, static_cast<int>(std::floor((rect.x + 1.0f) / p)));
+        x1 = std::min(tilesX(level) - 1, static_cast<int>(std::floor((rect.z + 1.0f) / p)));
+        y0 = std::max(0, static_cast<int>(std::floor((top - rect.w) / p)));
+        y1 = std::min(tilesY(level) - 1, static_cast<int>(std::floor((top - rect.y) / p)));
+        return x0 <= x1 && y0 <= y1;
+    }
+
+private:
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<std::vector<unsigned char>> tiles;   // PNG bytes, row-major
+    };
+    std::vector<Level> m_levels;
+
+    // RGBA decode into the given arena: stb allocates there through the hooks; libtiff cannot be hooked,
+    // so it is handed an arena raster instead of allocating its own
+    static unsigned char* decodeImage(const std::string& path, ScratchArena& arena, int& width, int& height) {
+        std::string extension = std::filesystem::path(path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (extension == ".tif" || extension == ".tiff") {
+            TIFF* tif = TIFFOpen(path.c_str(), "r");
+            if (!tif)
+                return nullptr;
+            uint32_t w = 0, h = 0;
+            TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &w);
+            TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &h);
+            uint32_t* raster = static_cast<uint32_t*>(arena.allocate(static_cast<size_t>(w) * h * 4));
+            bool ok = TIFFReadRGBAImageOriented(tif, w, h, raster, ORIENTATION_TOPLEFT, 0) != 0;
+            TIFFClose(tif);
+            width = static_cast<int>(w);
+            height = static_cast<int>(h);
+            return ok ? reinterpret_cast<unsigned char*>(raster) : nullptr;
+        }
+        int nrChannels;
+        return stbi_load(path.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha);
+    }
+
+    static void appendBytes(void* context, void* data, int size) {
+        std::vector<unsigned char>* out = static_cast<std::vector<unsigned char>*>(context);
+        out->insert(out->end(), static_cast<unsigned char*>(data), static_cast<unsigned char*>(data) + size);
+    }
+
+    static void encodeTiles(const std::vector<unsigned char>& pixels, Level& level) {
+        int countX = (level.width + tileSize - 1) / tileSize;
+        int countY = (level.height + tileSize - 1) / tileSize;
+        level.tiles.resize(static_cast<size_t>(countX) * countY);
+        for (int ty = 0; ty < countY; ++ty) {
+            for (int tx = 0; tx < countX; ++tx) {
+                int width = std::min(tileSize, level.width - tx * tileSize);
+                int height = std::min(tileSize, level.height - ty * tileSize);
+                const unsigned char* origin = pixels.data() +
+                    (static_cast<size_t>(ty) * tileSize * level.width + static_cast<size_t>(tx) * tileSize) * 4;
+                stbi_write_png_to_func(appendBytes, &level.tiles[static_cast<size_t>(ty) * countX + tx],
+                                       width, height, 4, origin, level.width * 4);
+            }
+        }
+    }
+
+    static void downsample(const std::vector<unsigned char>& src, int srcWidth, int srcHeight,
+                           std::vector<unsigned char>& dst, int dstWidth, int dstHeight) {
+        dst.resize(static_cast<size_t>(dstWidth) * dstHeight * 4);
+        for (int y = 0; y < dstHeight; ++y) {
+            int sy0 = 2 * y, sy1 = std::min(2 * y + 1, srcHeight - 1);
+            for (int x = 0; x < dstWidth; ++x) {
+                int sx0 = 2 * x, sx1 = std::min(2 * x + 1, srcWidth - 1);
+                for (int c = 0; c < 4; ++c) {
+                    int sum = src[(static_cast<size_t>(sy0) * srcWidth + sx0) * 4 + c] +
+                              src[(static_cast<size_t>(sy0) * srcWidth + sx1) * 4 + c] +
+                              src[(static_cast<size_t>(sy1) * srcWidth + sx0) * 4 + c] +
+                              src[(static_cast<size_t>(sy1) * srcWidth + sx1) * 4 + c];
+                    dst[(static_cast<size_t>(y) * dstWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+};
+
+// One tile wanted by the renderer or the prefetcher; lower priority values are served first
+struct TileRequest {
+    TileKey key;
+    float priority = 0.0f;
+};
+
+// Decoded tile; pixels is a TileBufferPool slab, tightly packed (width * 4 bytes per row)
+struct LoadedTile {
+    TileKey key;
+    int width = 0, height = 0;
+    unsigned char* pixels = nullptr;
+};
+
+// Scheduler between the renderer and the decoders.
+// - Duplicates merge: a key requested several times in a frame, or again while pending or in flight, is
+//   one piece of work that keeps the best priority it was given.
+// - Ordering: pending work is kept sorted by priority, workers always take the most urgent tile.
+// - Cancellation: every frame submits the complete set of tiles it still wants; pending requests missing
+//   from that set are dropped before any decoder picks them up.
+class TileRequestQueue {
+public:
+    struct Stats {
+        long long submitted = 0;   // requests received, duplicates included
+        long long merged = 0;      // requests folded into an existing entry
+        long long cancelled = 0;   // pending requests dropped as no longer wanted
+        long long started = 0;     // requests handed to a decoder
+    };
+
+    // Replaces the wanted set for this frame (requests may contain duplicates)
+    void submitFrame(const std::vector<TileRequest>& requests) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+
+        for (const TileRequest& request : requests) {
+            ++m_stats.submitted;
+            uint64_t id = request.key.packed();
+            auto it = m_entries.find(id);
+            if (it == m_entries.end()) {
+                Entry entry;
+                entry.key = request.key;
+                entry.priority = request.priority;
+                entry.generation = m_generation;
+                m_entries.emplace(id, entry);
+                m_order.insert(std::make_pair(request.priority, id));
+                continue;
+            }
+
+            ++m_stats.merged;
+            Entry& entry = it->second;
+            if (entry.state == State::InFlight)
+                continue;
+            // First sighting this frame takes the new priority; later duplicates only improve it
+            float priority = entry.generation == m_generation ? std::min(entry.priority, request.priority) : request.priority;
+            if (priority != entry.priority) {
+                m_order.erase(std::make_pair(entry.priority, id));
+                entry.priority = priority;
+                m_order.insert(std::make_pair(priority, id));
+            }
+            entry.generation = m_generation;
+        }
+
+        // Everything still pending but not asked for this frame is no longer visible or predicted
+        for (auto it = m_order.begin(); it != m_order.end();) {
+            Entry& entry = m_entries[it->second];
+            if (entry.generation != m_generation) {
+                m_entries.erase(it->second);
+                it = m_order.erase(it);
+                ++m_stats.cancelled;
+            }
+            else {
+                ++it;
+            }
+        }
+
+        m_wakeup.notify_all();
+    }
+
+    // Blocks until there is work; returns false on shutdown
+    bool pop(TileKey& key) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeup.wait(lock, [this] { return m_shutdown || !m_order.empty(); });
+        if (m_shutdown)
+            return false;
+        uint64_t id = m_order.begin()->second;
+        m_order.erase(m_order.begin());
+        Entry& entry = m_entries[id];
+        entry.state = State::InFlight;
+        key = entry.key;
+        ++m_stats.started;
+        return true;
+    }
+
+    // The tile reached the cache; later requests for it are the cache's business
+    void delivered(const TileKey& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.erase(key.packed());
+    }
+
+    void shutdown() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+        m_wakeup.notify_all();
+    }
+
+    size_t pendingCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_order.size();
+    }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    enum class State { Pending, InFlight };
+    struct Entry {
+        TileKey key;
+        State state = State::Pending;
+        float priority = 0.0f;
+        uint64_t generation = 0;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::unordered_map<uint64_t, Entry> m_entries;    // pending and in-flight
+    std::set<std::pair<float, uint64_t>> m_order;     // pending only, most urgent first
+    uint64_t m_generation = 0;
+    bool m_shutdown = false;
+    Stats m_stats;
+};
+
+// Decoder threads pulling from the request queue; each owns a scratch arena for the decoder's temporaries
+class TileLoaderPool {
+public:
+    void start(const TilePyramid* pyramid, TileRequestQueue* queue, TileBufferPool* buffers) {
+        m_pyramid = pyramid;
+        m_queue = queue;
+        m_buffers = buffers;
+        for (int i = 0; i < loaderThreadCount; ++i)
+            m_threads.emplace_back(&TileLoaderPool::workerThread, this);
+    }
+
+    std::vector<LoadedTile> takeCompleted(int maxCount) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<LoadedTile> result;
+        while (!m_completed.empty() && static_cast<int>(result.size()) < maxCount) {
+            result.push_back(m_completed.front());
+            m_completed.pop_front();
+        }
+        return result;
+    }
+
+    void stop() {
+        m_queue->shutdown();
+        for (std::thread& thread : m_threads)
+            thread.join();
+        m_threads.clear();
+        for (const LoadedTile& tile : m_completed)
+            m_buffers->release(tile.pixels);
+        m_completed.clear();
+    }
+
+private:
+    const TilePyramid* m_pyramid = nullptr;
+    TileRequestQueue* m_queue = nullptr;
+    TileBufferPool* m_buffers = nullptr;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::deque<LoadedTile> m_completed;
+
+    void workerThread() {
+        ScratchArena arena;
+        TileKey key;
+        while (m_queue->pop(key)) {
+            LoadedTile tile;
+            tile.key = key;
+            tile.pixels = m_buffers->acquire();
+            {
+                // Everything stb allocates for this tile is dropped when the scope closes
+                ScratchScope scope(m_buffers->enabled ? &arena : nullptr);
+                m_pyramid->readTile(key, tile.pixels, tile.width, tile.height);
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed.push_back(tile);
+        }
+    }
+};
+
+// GPU-resident tiles, evicted least-recently-used once over budget
+class TileCache {
+public:
+    struct Entry {
+        GLuint texture = 0;
+        int width = 0, height = 0;
+        int lastUsedFrame = 0;
+        bool drawn = false;
+    };
+
+    void upload(const LoadedTile& tile, int frame) {
+        Entry entry;
+        entry.width = tile.width;
+        entry.height = tile.height;
+        entry.lastUsedFrame = frame;
+
+        glGenTextures(1, &entry.texture);
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tile.width, tile.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, tile.pixels);
+
+        m_entries[tile.key.packed()] = entry;
+        ++m_uploads;
+    }
+
+    Entry* find(const TileKey& key) {
+        auto it = m_entries.find(key.packed());
+        return it == m_entries.end() ? nullptr : &it->second;
+    }
+
+    bool contains(const TileKey& key) const { return m_entries.count(key.packed()) != 0; }
+
+    void evict(int currentFrame) {
+        if (m_entries.size() <= gpuTileBudget)
+            return;
+        std::vector<std::pair<int, uint64_t>> candidates;
+        for (const auto& item : m_entries)
+            if (item.second.lastUsedFrame < currentFrame)
+                candidates.emplace_back(item.second.lastUsedFrame, item.first);
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& candidate : candidates) {
+            if (m_entries.size() <= gpuTileBudget)
+                break;
+            Entry& victim = m_entries[candidate.second];
+            if (!victim.drawn)
+                ++m_unusedEvictions;
+            glDeleteTextures(1, &victim.texture);
+            m_entries.erase(candidate.second);
+        }
+    }
+
+    size_t size() const { return m_entries.size(); }
+    int getUploads() const { return m_uploads; }
+    int getUnusedEvictions() const { return m_unusedEvictions; }
+
+    void destroy() {
+        for (auto& item : m_entries)
+            glDeleteTextures(1, &item.second.texture);
+        m_entries.clear();
+    }
+
+private:
+    std::unordered_map<uint64_t, Entry> m_entries;
+    int m_uploads = 0;
+    int m_unusedEvictions = 0;   // decoded and uploaded, but evicted before ever being drawn
+};
+
+// Emits requests for the visible tiles and for the predicted camera path (duplicates are left to the queue).
+// priority = predicted seconds until visible + levelWeight * levels away from the current level
+//          + distanceWeight * distance from the view center (in half view extents)
+class Prefetcher {
+public:
+    bool enabled = true;
+
+    void collect(const Camera& camera, const TilePyramid& pyramid, const TileCache& cache,
+                 int framebufferWidth, int framebufferHeight, std::vector<TileRequest>& requests) {
+        requests.clear();
+        int currentLevel = pyramid.selectLevel(camera, framebufferWidth, framebufferHeight);
+
+        float horizon = enabled ? predictionHorizon : 0.0f;
+        for (float t = 0.0f; t <= horizon + 1e-4f; t += predictionStep) {
+            Camera future = camera.predicted(t);
+            int level = pyramid.selectLevel(future, framebufferWidth, framebufferHeight);
+            addRect(pyramid, cache, future, level, currentLevel, t, requests);
+        }
+
+        float zoomRate = camera.getZoomRate();
+        if (enabled && std::fabs(zoomRate) > zoomRateThreshold) {
+            float position = pyramid.levelPosition(camera, framebufferWidth, framebufferHeight);
+            float levelsPerSecond = zoomRate / std::log(2.0f);
+            int nextLevel = zoomRate > 0.0f ? currentLevel - 1 : currentLevel + 1;
+            float distanceToSwitch = zoomRate > 0.0f ? position - std::floor(position) : std::ceil(position) - position;
+            float timeToSwitch = distanceToSwitch / std::fabs(levelsPerSecond);
+            if (nextLevel >= 0 && nextLevel < pyramid.levelCount())
+                addRect(pyramid, cache, camera, nextLevel, currentLevel, timeToSwitch, requests);
+        }
+    }
+
+private:
+    void addRect(const TilePyramid& pyramid, const TileCache& cache, const Camera& view, int level, int currentLevel,
+                 float t, std::vector<TileRequest>& requests) {
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, view.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glm::vec2 center = view.getCenter();
+        float halfExtent = 1.0f / view.getScale();
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                if (cache.contains(key))
+                    continue;
+
+                glm::vec4 r = pyramid.tileRect(key);
+                glm::vec2 tileCenter((r.x + r.z) * 0.5f, (r.y + r.w) * 0.5f);
+                TileRequest request;
+                request.key = key;
+                request.priority = t + levelWeight * std::abs(level - currentLevel) +
+                                   distanceWeight * glm::length(tileCenter - center) / halfExtent;
+                requests.push_back(request);
+            }
+        }
+    }
+};
+
+// Draws each visible tile from its own texture, or the matching part of the nearest resident ancestor
+class TileRenderer {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 tileRect;  // world x0, y0, x1, y1
+uniform vec4 uvRect;    // u0, v0 (top-left), u1, v1 (bottom-right)
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(tileRect.xw, tileRect.zy, corner), 0.0, 1.0);
+    texCoord = mix(uvRect.xy, uvRect.zw, corner);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO;
+    GLint tileRectLoc, uvRectLoc;
+    int holes = 0;
+
+    void init(Camera* camera) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        tileRectLoc = glGetUniformLocation(shaderProgram, "tileRect");
+        uvRectLoc = glGetUniformLocation(shaderProgram, "uvRect");
+        // Corners come from gl_VertexID; the VAO only has to exist
+        glGenVertexArrays(1, &VAO);
+    }
+
+    void render(const Camera& camera, const TilePyramid& pyramid, TileCache& cache, int level, int frame) {
+        holes = 0;
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, camera.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                glm::vec4 rect = pyramid.tileRect(key);
+
+                // Walk up until a resident ancestor covers this tile
+                TileKey source = key;
+                TileCache::Entry* entry = cache.find(source);
+                if (!entry)
+                    ++holes;
+                while (!entry && source.level + 1 < pyramid.levelCount()) {
+                    source = source.parent();
+                    entry = cache.find(source);
+                }
+                if (!entry)
+                    continue;
+                entry->lastUsedFrame = frame;
+                entry->drawn = true;
+
+                // Part of the source tile covered by this tile, in the source's texel space
+                glm::vec4 sourceRect = pyramid.tileRect(source);
+                float u0 = (rect.x - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float u1 = (rect.z - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float v0 = (sourceRect.w - rect.w) / (sourceRect.w - sourceRect.y);
+                float v1 = (sourceRect.w - rect.y) / (sourceRect.w - sourceRect.y);
+
+                glBindTexture(GL_TEXTURE_2D, entry->texture);
+                glUniform4f(tileRectLoc, rect.x, rect.y, rect.z, rect.w);
+                glUniform4f(uvRectLoc, u0, v0, u1, v1);
+                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            }
+        }
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+    }
+};
+int main(int argc, char** argv) {
+    std::string imagePath = argc > 1 ? argv[1] : "src/textures/assets/test_nb.png";
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    TilePyramid pyramid;
+    if (!pyramid.load(imagePath)) {
+        glfwTerminate();
+        return -1;
+    }
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    TileBufferPool buffers;
+    buffers.init(static_cast<size_t>(tileSize) * tileSize * 4);
+
+    TileRequestQueue queue;
+    TileLoaderPool loaders;
+    loaders.start(&pyramid, &queue, &buffers);
+    TileCache cache;
+    Prefetcher prefetcher;
+    TileRenderer renderer;
+    renderer.init(&camera);
+
+    std::vector<TileRequest> requests;
+    bool prefetchKeyDown = false;
+    bool sweepKeyDown = false;
+    bool recycleKeyDown = false;
+    int sweepFramesLeft = 0;
+    float sweepFactor = 1.0f;
+    int frame = 0;
+    double lastTitleTime = glfwGetTime();
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool prefetchKeyPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+        if (prefetchKeyPressed && !prefetchKeyDown)
+            prefetcher.enabled = !prefetcher.enabled;
+        prefetchKeyDown = prefetchKeyPressed;
+
+        // Z: zoom in through zoomSweepLevels levels in zoomSweepFrames frames
+        bool sweepKeyPressed = glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS;
+        if (sweepKeyPressed && !sweepKeyDown && sweepFramesLeft == 0) {
+            int levels = std::min(zoomSweepLevels, pyramid.selectLevel(camera, width, height));
+            sweepFactor = std::pow(2.0f, static_cast<float>(levels) / zoomSweepFrames);
+            sweepFramesLeft = zoomSweepFrames;
+        }
+        sweepKeyDown = sweepKeyPressed;
+        if (sweepFramesLeft > 0) {
+            camera.zoomBy(sweepFactor);
+            --sweepFramesLeft;
+        }
+
+        // M: pool and arenas off (every buffer from the heap) or back on
+        bool recycleKeyPressed = glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS;
+        if (recycleKeyPressed && !recycleKeyDown) {
+            buffers.enabled = !buffers.enabled;
+            if (!buffers.enabled)
+                buffers.trim();
+        }
+        recycleKeyDown = recycleKeyPressed;
+
+        camera.updateMotion(glfwGetTime());
+
+        // The whole wanted set goes to the queue every frame; whatever it no longer contains is cancelled
+        prefetcher.collect(camera, pyramid, cache, width, height, requests);
+        queue.submitFrame(requests);
+
+        for (const LoadedTile& tile : loaders.takeCompleted(maxUploadsPerFrame)) {
+            cache.upload(tile, frame);
+            buffers.release(tile.pixels);
+            queue.delivered(tile.key);
+        }
+
+        int level = pyramid.selectLevel(camera, width, height);
+        camera.publish(width, height);
+        renderer.render(camera, pyramid, cache, level, frame);
+        cache.evict(frame);
+
+        double now = glfwGetTime();
+        if (now - lastTitleTime > 0.5) {
+            char title[256];
+            snprintf(title, sizeof(title), "OpenGL - %s, level %d, slabs: %lld heap / %lld reused, peak %zu KB | stb: %lld arena / %lld heap, arena peak %zu KB",
+                     buffers.enabled ? "pool + arenas" : "heap only", level,
+                     allocationStats.slabAllocations.load(), allocationStats.slabReuses.load(), buffers.getPeakBytes() / 1024,
+                     allocationStats.scratchServed.load(), allocationStats.heapFallbacks.load(), allocationStats.scratchPeakBytes.load() / 1024);
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    TileRequestQueue::Stats stats = queue.getStats();
+    printf("Requests submitted: %lld, merged: %lld, cancelled: %lld, decoded: %lld\n",
+           stats.submitted, stats.merged, stats.cancelled, stats.started);
+    printf("Tile uploads: %d, evicted without being drawn: %d\n", cache.getUploads(), cache.getUnusedEvictions());
+    // Heap allocations avoided: slab reuses, plus arena-served stb allocations minus the chunks the arenas took
+    printf("Tile slabs: %lld from the heap, %lld reused; peak held %.2f MB\n",
+           allocationStats.slabAllocations.load(), allocationStats.slabReuses.load(), buffers.getPeakBytes() / 1048576.0);
+    printf("stb allocations: %lld served by arenas (%lld arena chunks), %lld from the heap; arena peak %.2f MB\n",
+           allocationStats.scratchServed.load(), allocationStats.scratchChunks.load(), allocationStats.heapFallbacks.load(),
+           allocationStats.scratchPeakBytes.load() / 1048576.0);
+    printf("Heap allocations avoided: %lld\n", allocationStats.slabReuses.load() + allocationStats.scratchServed.load() -
+                                               allocationStats.scratchChunks.load());
+
+    loaders.stop();
+    buffers.destroy();
+    renderer.destroy();
+    cache.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
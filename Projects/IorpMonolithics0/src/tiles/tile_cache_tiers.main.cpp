@@ -0,0 +1,1608 @@
+// tiled pyramid viewer with a two-tier tile cache: GPU textures backed by a compressed CPU RAM tier
+// A tile the GPU cache evicts is usually wanted again soon (panning back, zooming out and in again), and
+// without a second tier that means another read and PNG decode of the source. Here:
+//   - the loaders decode a source tile once and also encode it with a fast lossless codec (LZ4 over the
+//     Up-filtered rows by default, QOI or raw selectable); the encoded copy rides along with the texture
+//   - when the GPU tier evicts a tile, its encoded copy moves into the CPU tier, an LRU under its own RAM
+//     budget; the two tiers are exclusive, so a tile's bytes are counted in one of them only
+//   - a request for a tile the CPU tier holds never reaches the loaders: the main thread decodes it straight
+//     back to RGBA and uploads it (at most maxRefillsPerFrame per frame), and the entry moves back up
+// Each tier keeps its own hit statistics: the GPU tier per visible tile drawn, the CPU tier per tile that
+// had to be brought back to the GPU (refilled from RAM or decoded from the source).
+// T switches the CPU tier off for comparison; the title shows both tiers' hit rates.
+// Usage: tile_cache_tiers [image] [--tier-codec raw|png|qoi|lz4]   Keys: WASD pan, Q/E zoom, Z zoom sweep, P prefetch, T CPU tier.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <list>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <tiffio.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+// Lossless encodings for tiles, both at the source and in the CPU tier
+enum class TileCodec { Raw, Png, Qoi, Lz4 };
+
+const int tileSize = 128;
+
+// Level of Detail (LOD) bias, typically in the range -0.5 to 0.5
+float lodBias = 0.0f;
+
+// Loader configuration: decoder thread count
+const int loaderThreadCount = 2;
+
+// GPU tile cache budget (tiles) and upload throttle (tiles per frame)
+const size_t gpuTileBudget = 192;
+const int maxUploadsPerFrame = 8;
+
+// CPU tier budget (bytes of encoded tiles) and how many tiles it may refill per frame
+const size_t cpuTierBudgetBytes = 64 * 1024 * 1024;
+const int maxRefillsPerFrame = 16;
+
+// Prediction: how far ahead the camera path is extrapolated, and the sampling step along it (seconds)
+const float predictionHorizon = 0.6f;
+const float predictionStep = 0.1f;
+// Time constant of the velocity smoothing (seconds)
+const float velocitySmoothing = 0.15f;
+// Zoom rates below this (ln(scale) per second) are treated as "not zooming"
+const float zoomRateThreshold = 0.05f;
+
+// Priority weights: seconds-equivalent cost of one level away from the current LOD / of one half view extent
+const float levelWeight = 0.5f;
+const float distanceWeight = 0.1f;
+
+// Z key: zoom in by this many levels over this many frames
+const int zoomSweepLevels = 5;
+const int zoomSweepFrames = 30;
+
+// Codec of the pyramid's own tiles, standing in for the image files a real viewer would read from disk
+const TileCodec sourceCodec = TileCodec::Png;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+// Identifies one tile of the pyramid
+struct TileKey {
+    int level = 0, x = 0, y = 0;
+
+    uint64_t packed() const {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+    }
+    static TileKey fromPacked(uint64_t id) {
+        TileKey key;
+        key.level = static_cast<int>(id >> 48);
+        key.y = static_cast<int>((id >> 24) & 0xFFFFFF);
+        key.x = static_cast<int>(id & 0xFFFFFF);
+        return key;
+    }
+    TileKey parent() const {
+        TileKey p;
+        p.level = level + 1;
+        p.x = x / 2;
+        p.y = y / 2;
+        return p;
+    }
+};
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f), velocity(0.0f, 0.0f), zoomRate(0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    void zoomBy(float factor) {
+        scale *= factor;
+    }
+
+    // Measures how fast offset and scale changed since the last call, smoothed exponentially
+    void updateMotion(double now) {
+        if (lastTime < 0.0) {
+            lastTime = now;
+            lastOffset = offset;
+            lastScale = scale;
+            return;
+        }
+        float dt = static_cast<float>(now - lastTime);
+        if (dt <= 0.0f)
+            return;
+
+        glm::vec2 instantVelocity = (offset - lastOffset) / dt;
+        float instantZoomRate = std::log(scale / lastScale) / dt;
+        float alpha = 1.0f - std::exp(-dt / velocitySmoothing);
+        velocity += (instantVelocity - velocity) * alpha;
+        zoomRate += (instantZoomRate - zoomRate) * alpha;
+
+        lastTime = now;
+        lastOffset = offset;
+        lastScale = scale;
+    }
+
+    // Camera extrapolated t seconds ahead along the current pan/zoom motion
+    Camera predicted(float t) const {
+        Camera c = *this;
+        c.offset = offset + velocity * t;
+        c.scale = scale * std::exp(zoomRate * t);
+        return c;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    glm::vec2 getCenter() const { return -offset; }
+    float getScale() const { return scale; }
+    float getZoomRate() const { return zoomRate; }
+    glm::vec2 getVelocity() const { return velocity; }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    glm::vec2 velocity;   // world units per second (of offset)
+    float zoomRate;       // d ln(scale) / dt
+    double lastTime = -1.0;
+    glm::vec2 lastOffset;
+    float lastScale = 1.0f;
+    GLuint ubo = 0;
+};
+
+const TileCodec tileCodecs[] = { TileCodec::Raw, TileCodec::Png, TileCodec::Qoi, TileCodec::Lz4 };
+
+const char* tileCodecName(TileCodec codec) {
+    switch (codec) {
+    case TileCodec::Raw: return "raw";
+    case TileCodec::Png: return "png";
+    case TileCodec::Qoi: return "qoi";
+    case TileCodec::Lz4: return "lz4";
+    }
+    return "?";
+}
+
+bool parseTileCodec(const std::string& name, TileCodec& codec) {
+    for (TileCodec candidate : tileCodecs) {
+        if (name == tileCodecName(candidate)) {
+            codec = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// QOI: every pixel is a run of the previous pixel, a reference into a 64-entry table of recently seen
+// colours, a small delta from the previous pixel, or a literal. Tiles are complete .qoi streams.
+const unsigned char qoiOpIndex = 0x00;   // 00iiiiii
+const unsigned char qoiOpDiff = 0x40;    // 01rrggbb, each delta in [-2, 1]
+const unsigned char qoiOpLuma = 0x80;    // 10gggggg rrrrbbbb, green delta in [-32, 31], red/blue relative to it in [-8, 7]
+const unsigned char qoiOpRun = 0xC0;     // 11llllll, run of 1..62 previous pixels
+const unsigned char qoiOpRgb = 0xFE;
+const unsigned char qoiOpRgba = 0xFF;
+const size_t qoiHeaderSize = 14;
+const unsigned char qoiEndMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+struct QoiPixel {
+    unsigned char r = 0, g = 0, b = 0, a = 255;
+
+    bool operator==(const QoiPixel& other) const { return r == other.r && g == other.g && b == other.b && a == other.a; }
+    int hash() const { return (r * 3 + g * 5 + b * 7 + a * 11) & 63; }
+};
+
+void writeBigEndian32(unsigned char* p, uint32_t value) {
+    p[0] = static_cast<unsigned char>(value >> 24);
+    p[1] = static_cast<unsigned char>(value >> 16);
+    p[2] = static_cast<unsigned char>(value >> 8);
+    p[3] = static_cast<unsigned char>(value);
+}
+
+uint32_t readBigEndian32(const unsigned char* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+void encodeQoi(const unsigned char* origin, int width, int height, size_t stride, std::vector<unsigned char>& out) {
+    // Worst case is one RGBA op (5 bytes) per pixel
+    out.resize(qoiHeaderSize + static_cast<size_t>(width) * height * 5 + sizeof(qoiEndMarker));
+    unsigned char* p = out.data();
+    memcpy(p, "qoif", 4);
+    writeBigEndian32(p + 4, static_cast<uint32_t>(width));
+    writeBigEndian32(p + 8, static_cast<uint32_t>(height));
+    p[12] = 4;   // RGBA
+    p[13] = 0;   // sRGB with linear alpha
+    p += qoiHeaderSize;
+
+    QoiPixel index[64] = {};
+    QoiPixel previous;
+    int run = 0;
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* row = origin + y * stride;
+        for (int x = 0; x < width; ++x, row += 4) {
+            QoiPixel pixel;
+            pixel.r = row[0];
+            pixel.g = row[1];
+            pixel.b = row[2];
+            pixel.a = row[3];
+            if (pixel == previous) {
+                if (++run == 62) {
+                    *p++ = static_cast<unsigned char>(qoiOpRun | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0) {
+                *p++ = static_cast<unsigned char>(qoiOpRun | (run - 1));
+                run = 0;
+            }
+
+            int slot = pixel.hash();
+            if (index[slot] == pixel) {
+                *p++ = static_cast<unsigned char>(qoiOpIndex | slot);
+            } else {
+                index[slot] = pixel;
+                if (pixel.a != previous.a) {
+                    *p++ = qoiOpRgba;
+                    *p++ = pixel.r;
+                    *p++ = pixel.g;
+                    *p++ = pixel.b;
+                    *p++ = pixel.a;
+                } else {
+                    int dr = static_cast<signed char>(pixel.r - previous.r);
+                    int dg = static_cast<signed char>(pixel.g - previous.g);
+                    int db = static_cast<signed char>(pixel.b - previous.b);
+                    int drg = dr - dg, dbg = db - dg;
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        *p++ = static_cast<unsigned char>(qoiOpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                    } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                        *p++ = static_cast<unsigned char>(qoiOpLuma | (dg + 32));
+                        *p++ = static_cast<unsigned char>((drg + 8) << 4 | (dbg + 8));
+                    } else {
+                        *p++ = qoiOpRgb;
+                        *p++ = pixel.r;
+                        *p++ = pixel.g;
+                        *p++ = pixel.b;
+                    }
+                }
+            }
+            previous = pixel;
+        }
+    }
+    if (run > 0)
+        *p++ = static_cast<unsigned char>(qoiOpRun | (run - 1));
+    memcpy(p, qoiEndMarker, sizeof(qoiEndMarker));
+    p += sizeof(qoiEndMarker);
+    out.resize(p - out.data());
+}
+
+// Decodes into width * 4 byte rows; malformed input fails instead of reading or writing out of bounds
+bool decodeQoi(const unsigned char* data, size_t size, int width, int height, unsigned char* pixels) {
+    if (size < qoiHeaderSize + sizeof(qoiEndMarker) || memcmp(data, "qoif", 4) != 0 ||
+        readBigEndian32(data + 4) != static_cast<uint32_t>(width) || readBigEndian32(data + 8) != static_cast<uint32_t>(height))
+        return false;
+    const unsigned char* p = data + qoiHeaderSize;
+    // Ops are at most 5 bytes and the 8-byte end marker follows the last one, so an op that starts before
+    // the marker can be read whole without further checks
+    const unsigned char* end = data + size - sizeof(qoiEndMarker);
+
+    // Only ops that produce a new colour write the table: an index op's colour already sits in its slot,
+    // and a run repeats the previous pixel
+    QoiPixel index[64] = {};
+    QoiPixel pixel;
+    unsigned char* out = pixels;
+    unsigned char* outEnd = pixels + static_cast<size_t>(width) * height * 4;
+    while (out < outEnd) {
+        if (p >= end)
+            return false;
+        unsigned char op = *p++;
+        if (op < qoiOpDiff) {
+            pixel = index[op];
+        } else if (op < qoiOpLuma) {
+            pixel.r += ((op >> 4) & 3) - 2;
+            pixel.g += ((op >> 2) & 3) - 2;
+            pixel.b += (op & 3) - 2;
+            index[pixel.hash()] = pixel;
+        } else if (op < qoiOpRun) {
+            int dg = (op & 63) - 32;
+            unsigned char second = *p++;
+            pixel.r += dg - 8 + (second >> 4);
+            pixel.g += dg;
+            pixel.b += dg - 8 + (second & 15);
+            index[pixel.hash()] = pixel;
+        } else if (op == qoiOpRgb) {
+            pixel.r = p[0];
+            pixel.g = p[1];
+            pixel.b = p[2];
+            p += 3;
+            index[pixel.hash()] = pixel;
+        } else if (op == qoiOpRgba) {
+            pixel.r = p[0];
+            pixel.g = p[1];
+            pixel.b = p[2];
+            pixel.a = p[3];
+            p += 4;
+            index[pixel.hash()] = pixel;
+        } else {
+            size_t run = std::min<size_t>((op & 63) + 1, (outEnd - out) / 4);
+            for (size_t i = 0; i < run; ++i, out += 4)
+                memcpy(out, &pixel, 4);
+            continue;
+        }
+        memcpy(out, &pixel, 4);
+        out += 4;
+    }
+    return true;
+}
+
+// LZ4 block: sequences of literals followed by a back reference, byte aligned and without an entropy coder,
+// so decoding is mostly memcpy. The compressor is greedy with a single hash probe per position.
+const int lzMinMatch = 4;
+const int lzHashBits = 12;
+const size_t lzLastLiterals = 5;   // a block always ends in at least 5 literals
+const size_t lzMatchSafeEnd = 12;  // and no match starts in its last 12 bytes
+
+uint32_t lzHash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - lzHashBits);
+}
+
+uint32_t load32(const unsigned char* p) {
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+void writeLz4Length(unsigned char*& op, size_t length) {
+    for (; length >= 255; length -= 255)
+        *op++ = 255;
+    *op++ = static_cast<unsigned char>(length);
+}
+
+void compressLz4(const unsigned char* src, size_t size, std::vector<unsigned char>& out) {
+    out.resize(size + size / 255 + 16);
+    unsigned char* op = out.data();
+    const unsigned char* ip = src;
+    const unsigned char* anchor = src;
+    const unsigned char* end = src + size;
+    uint32_t table[1 << lzHashBits] = {};
+
+    if (size > lzMatchSafeEnd) {
+        const unsigned char* matchLimit = end - lzMatchSafeEnd;
+        while (ip < matchLimit) {
+            uint32_t sequence = load32(ip);
+            uint32_t& slot = table[lzHash(sequence)];
+            const unsigned char* match = src + slot;
+            slot = static_cast<uint32_t>(ip - src);
+            if (match >= ip || ip - match > 65535 || load32(match) != sequence) {
+                ++ip;
+                continue;
+            }
+            // Extend the match forwards; it may not reach into the last literals
+            const unsigned char* matchEnd = ip + lzMinMatch;
+            const unsigned char* ref = match + lzMinMatch;
+            while (matchEnd < end - lzLastLiterals && *matchEnd == *ref) {
+                ++matchEnd;
+                ++ref;
+            }
+            size_t literals = ip - anchor;
+            size_t matchLength = matchEnd - ip - lzMinMatch;
+            unsigned char* token = op++;
+            *token = static_cast<unsigned char>((std::min<size_t>(literals, 15) << 4) | std::min<size_t>(matchLength, 15));
+            if (literals >= 15)
+                writeLz4Length(op, literals - 15);
+            memcpy(op, anchor, literals);
+            op += literals;
+            uint16_t offset = static_cast<uint16_t>(ip - match);
+            *op++ = static_cast<unsigned char>(offset);
+            *op++ = static_cast<unsigned char>(offset >> 8);
+            if (matchLength >= 15)
+                writeLz4Length(op, matchLength - 15);
+            ip = anchor = matchEnd;
+        }
+    }
+    size_t literals = end - anchor;
+    *op++ = static_cast<unsigned char>(std::min<size_t>(literals, 15) << 4);
+    if (literals >= 15)
+        writeLz4Length(op, literals - 15);
+    memcpy(op, anchor, literals);
+    op += literals;
+    out.resize(op - out.data());
+}
+
+// Decompresses exactly size bytes into dst; malformed input fails without reading or writing out of bounds
+bool decompressLz4(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t size) {
+    const unsigned char* ip = src;
+    const unsigned char* ipEnd = src + srcSize;
+    unsigned char* op = dst;
+    unsigned char* opEnd = dst + size;
+    while (ip < ipEnd) {
+        unsigned token = *ip++;
+        size_t literals = token >> 4;
+        if (literals == 15) {
+            unsigned char extra;
+            do {
+                if (ip >= ipEnd)
+                    return false;
+                extra = *ip++;
+                literals += extra;
+            } while (extra == 255);
+        }
+        if (literals > static_cast<size_t>(ipEnd - ip) || literals > static_cast<size_t>(opEnd - op))
+            return false;
+        // Short literal runs are the common case: one fixed 16-byte copy when both buffers have room
+        if (literals <= 16 && ipEnd - ip >= 16 && opEnd - op >= 16)
+            memcpy(op, ip, 16);
+        else
+            memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+        if (ip == ipEnd)
+            break;   // last sequence: literals only
+
+        if (ipEnd - ip < 2)
+            return false;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t matchLength = token & 15;
+        if (matchLength == 15) {
+            unsigned char extra;
+            do {
+                if (ip >= ipEnd)
+                    return false;
+                extra = *ip++;
+                matchLength += extra;
+            } while (extra == 255);
+        }
+        matchLength += lzMinMatch;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst) || matchLength > static_cast<size_t>(opEnd - op))
+            return false;
+        const unsigned char* match = op - offset;
+        // Copies in 16-byte chunks that may run up to 15 bytes past the match (the next sequence overwrites
+        // them) but never past the output; whatever the chunks leave over is copied byte by byte
+        size_t room = opEnd - op;
+        size_t i = 0;
+        if (room >= 32) {
+            size_t limit = std::min(matchLength, room - 16);
+            if (offset >= 16) {
+                for (; i < limit; i += 16)
+                    memcpy(op + i, match + i, 16);
+            } else {
+                // A short offset repeats a pattern: build its first 16 bytes (8 at a time if the offset allows,
+                // else one at a time), then store that block at multiples of the offset close to 16 bytes apart
+                // without reading back any fresh store
+                static const unsigned char step[16] = { 0, 16, 16, 15, 16, 15, 12, 14, 16, 9, 10, 11, 12, 13, 14, 15 };
+                if (offset >= 8) {
+                    memcpy(op, match, 8);
+                    memcpy(op + 8, match + 8, 8);
+                } else {
+                    for (; i < 16; ++i)
+                        op[i] = match[i];
+                }
+                unsigned char pattern[16];
+                memcpy(pattern, op, 16);
+                for (i = step[offset]; i < limit; i += step[offset])
+                    memcpy(op + i, pattern, 16);
+            }
+        }
+        for (; i < matchLength; ++i)
+            op[i] = match[i];
+        op += matchLength;
+    }
+    return op == opEnd;
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TILE_FILTER_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define TILE_FILTER_NEON 1
+#include <arm_neon.h>
+#endif
+
+// PNG's Up filter: every row after the first stores its difference to the row above, which turns smooth
+// gradients and repeated rows into runs of small or zero bytes that LZ4 can match.
+// subtract == false adds instead, which undoes the filter in place when the rows are visited top to bottom.
+void applyUpFilter(const unsigned char* row, const unsigned char* above, unsigned char* out, size_t bytes, bool subtract) {
+    size_t i = 0;
+#if defined(TILE_FILTER_SSE2)
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(above + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), subtract ? _mm_sub_epi8(a, b) : _mm_add_epi8(a, b));
+    }
+#elif defined(TILE_FILTER_NEON)
+    for (; i + 16 <= bytes; i += 16) {
+        uint8x16_t a = vld1q_u8(row + i);
+        uint8x16_t b = vld1q_u8(above + i);
+        vst1q_u8(out + i, subtract ? vsubq_u8(a, b) : vaddq_u8(a, b));
+    }
+#endif
+    for (; i < bytes; ++i)
+        out[i] = static_cast<unsigned char>(subtract ? row[i] - above[i] : row[i] + above[i]);
+}
+
+void filterUp(const unsigned char* origin, int width, int height, size_t stride, unsigned char* filtered) {
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    memcpy(filtered, origin, rowBytes);
+    for (int y = 1; y < height; ++y)
+        applyUpFilter(origin + y * stride, origin + (y - 1) * stride, filtered + y * rowBytes, rowBytes, true);
+}
+
+void unfilterUp(unsigned char* pixels, int width, int height) {
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    for (int y = 1; y < height; ++y)
+        applyUpFilter(pixels + y * rowBytes, pixels + (y - 1) * rowBytes, pixels + y * rowBytes, rowBytes, false);
+}
+
+void appendBytes(void* context, void* data, int size) {
+    std::vector<unsigned char>* out = static_cast<std::vector<unsigned char>*>(context);
+    out->insert(out->end(), static_cast<unsigned char*>(data), static_cast<unsigned char*>(data) + size);
+}
+
+// Encodes a width x height RGBA block whose rows are stride bytes apart
+void encodeTile(TileCodec codec, const unsigned char* origin, int width, int height, size_t stride,
+                std::vector<unsigned char>& out) {
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    out.clear();
+    switch (codec) {
+    case TileCodec::Raw:
+        out.resize(rowBytes * height);
+        for (int y = 0; y < height; ++y)
+            memcpy(out.data() + y * rowBytes, origin + y * stride, rowBytes);
+        break;
+    case TileCodec::Png:
+        stbi_write_png_to_func(appendBytes, &out, width, height, 4, origin, static_cast<int>(stride));
+        break;
+    case TileCodec::Qoi:
+        encodeQoi(origin, width, height, stride, out);
+        break;
+    case TileCodec::Lz4: {
+        std::vector<unsigned char> filtered(rowBytes * height);
+        filterUp(origin, width, height, stride, filtered.data());
+        compressLz4(filtered.data(), filtered.size(), out);
+        break;
+    }
+    }
+}
+
+// Decodes a tile into width * 4 byte rows; false if the data does not decode to exactly that size
+bool decodeTile(TileCodec codec, const std::vector<unsigned char>& encoded, int width, int height, unsigned char* pixels) {
+    size_t bytes = static_cast<size_t>(width) * height * 4;
+    switch (codec) {
+    case TileCodec::Raw:
+        if (encoded.size() != bytes)
+            return false;
+        memcpy(pixels, encoded.data(), bytes);
+        return true;
+    case TileCodec::Png: {
+        int decodedWidth, decodedHeight, nrChannels;
+        unsigned char* data = stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()),
+                                                    &decodedWidth, &decodedHeight, &nrChannels, STBI_rgb_alpha);
+        bool ok = data && decodedWidth == width && decodedHeight == height;
+        if (ok)
+            memcpy(pixels, data, bytes);
+        stbi_image_free(data);
+        return ok;
+    }
+    case TileCodec::Qoi:
+        return decodeQoi(encoded.data(), encoded.size(), width, height, pixels);
+    case TileCodec::Lz4:
+        if (!decompressLz4(encoded.data(), encoded.size(), pixels, bytes))
+            return false;
+        unfilterUp(pixels, width, height);
+        return true;
+    }
+    return false;
+}
+
+// Tier statistics. GPU: visible tiles drawn from their own texture (hit) or not (miss, drawn from an ancestor
+// or left empty). CPU: tiles brought back to the GPU from the CPU tier (hit) or decoded from the source (miss).
+struct TierStats {
+    long long gpuHits = 0, gpuMisses = 0;
+    long long cpuHits = 0, cpuMisses = 0;
+    long long cpuEvictions = 0;       // encoded tiles dropped from the CPU tier over its budget
+    double refillMilliseconds = 0.0;  // CPU tier decode plus upload
+    double refillBytes = 0.0;         // RGBA bytes refilled
+};
+
+TierStats tierStats;
+
+// RGBA decode of a whole image; TIFFs go through libtiff, everything else through stb_image
+bool decodeImage(const std::string& path, std::vector<unsigned char>& pixels, int& width, int& height) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".tif" || extension == ".tiff") {
+        TIFF* tif = TIFFOpen(path.c_str(), "r");
+        if (!tif)
+            return false;
+        uint32_t w = 0, h = 0;
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &w);
+        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &h);
+        pixels.resize(static_cast<size_t>(w) * h * 4);
+        bool ok = TIFFReadRGBAImageOriented(tif, w, h, reinterpret_cast<uint32_t*>(pixels.data()), ORIENTATION_TOPLEFT, 0) != 0;
+        TIFFClose(tif);
+        width = static_cast<int>(w);
+        height = static_cast<int>(h);
+        return ok;
+    }
+    int nrChannels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha);
+    if (!data)
+        return false;
+    pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(data);
+    return true;
+}
+
+// Image plus its reduced levels, each tile stored in the source codec and decoded when requested.
+// World mapping keeps the aspect ratio: x spans [-1, 1], y spans [-h/w, h/w], row 0 at the top.
+class TilePyramid {
+public:
+    bool load(const std::string& imagePath) {
+        int width, height;
+        std::vector<unsigned char> pixels;
+        if (!decodeImage(imagePath, pixels, width, height)) {
+            std::cerr << "Failed to load texture" << std::endl;
+            return false;
+        }
+
+        for (;;) {
+            Level level;
+            level.width = width;
+            level.height = height;
+            encodeTiles(pixels, level);
+            m_levels.push_back(std::move(level));
+
+            // Halve until the whole level fits in one tile
+            if (width <= tileSize && height <= tileSize)
+                break;
+            int halfWidth = (width + 1) / 2, halfHeight = (height + 1) / 2;
+            std::vector<unsigned char> half;
+            downsample(pixels, width, height, half, halfWidth, halfHeight);
+            pixels.swap(half);
+            width = halfWidth;
+            height = halfHeight;
+        }
+
+        printf("Image size: %d x %d, levels: %d, tile size: %d, %s tiles: %.2f MB (%.1f%% of raw)\n",
+               levelWidth(0), levelHeight(0), levelCount(), tileSize, tileCodecName(sourceCodec),
+               storedBytes() / 1048576.0, 100.0 * storedBytes() / rawBytes());
+        return true;
+    }
+
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    int levelWidth(int level) const { return m_levels[level].width; }
+    int levelHeight(int level) const { return m_levels[level].height; }
+    int tilesX(int level) const { return (levelWidth(level) + tileSize - 1) / tileSize; }
+    int tilesY(int level) const { return (levelHeight(level) + tileSize - 1) / tileSize; }
+
+    bool isValid(const TileKey& key) const {
+        return key.level >= 0 && key.level < levelCount() &&
+               key.x >= 0 && key.x < tilesX(key.level) && key.y >= 0 && key.y < tilesY(key.level);
+    }
+
+    // Encoded size of all tiles, and the size they would take as plain RGBA
+    size_t storedBytes() const {
+        size_t bytes = 0;
+        for (const Level& level : m_levels)
+            for (const std::vector<unsigned char>& tile : level.tiles)
+                bytes += tile.size();
+        return bytes;
+    }
+
+    size_t rawBytes() const {
+        size_t bytes = 0;
+        for (const Level& level : m_levels)
+            bytes += static_cast<size_t>(level.width) * level.height * 4;
+        return bytes;
+    }
+
+    // Decodes one tile into a caller-provided buffer of at least tileSize * tileSize * 4 bytes (thread-safe)
+    void readTile(const TileKey& key, unsigned char* pixels, int& width, int& height) const {
+        const Level& level = m_levels[key.level];
+        const std::vector<unsigned char>& encoded = level.tiles[static_cast<size_t>(key.y) * tilesX(key.level) + key.x];
+        width = std::min(tileSize, level.width - key.x * tileSize);
+        height = std::min(tileSize, level.height - key.y * tileSize);
+
+        if (!decodeTile(sourceCodec, encoded, width, height, pixels))
+            memset(pixels, 0, static_cast<size_t>(width) * height * 4);
+    }
+
+    // World units per level-0 pixel
+    float worldPerPixel() const { return 2.0f / m_levels[0].width; }
+
+    // World-space rectangle of a tile (min.x, min.y, max.x, max.y)
+    glm::vec4 tileRect(const TileKey& key) const {
+        int width0 = m_levels[0].width, height0 = m_levels[0].height;
+        int px0 = std::min(key.x * tileSize << key.level, width0);
+        int py0 = std::min(key.y * tileSize << key.level, height0);
+        int px1 = std::min((key.x + 1) * tileSize << key.level, width0);
+        int py1 = std::min((key.y + 1) * tileSize << key.level, height0);
+        float p = worldPerPixel();
+        float top = height0 * p * 0.5f;
+        return glm::vec4(px0 * p - 1.0f, top - py1 * p, px1 * p - 1.0f, top - py0 * p);
+    }
+
+    // Level whose texel density best matches the screen for this camera
+    int selectLevel(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        float texelsPerScreenPixel = 1.0f / (worldPerPixel() * screenPixelsPerWorld);
+        int level = static_cast<int>(std::floor(std::log2(std::max(texelsPerScreenPixel, 1e-6f)) + lodBias));
+        return std::max(0, std::min(level, levelCount() - 1));
+    }
+
+    // Continuous level (before flooring), used to predict level switches
+    float levelPosition(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        return std::log2(1.0f / (worldPerPixel() * screenPixelsPerWorld)) + lodBias;
+    }
+
+    // Range of tiles of a level that intersect a world rectangle; false if none
+    bool tileRange(int level, const glm::vec4& rect, int& x0, int& y0, int& x1, int& y1) const {
+        float p = worldPerPixel() * static_cast<float>(1 << level) * tileSize;  // world size of one tile
+        float top = m_levels[0].height * worldPerPixel() * 0.5f;
+        x0 = std::max(0, static_cast<int>(std::floor((rect.x + 1.0f) / p)));
+        x1 = std::min(tilesX(level) - 1, static_cast<int>(std::floor((rect.z + 1.0f) / p)));
+        y0 = std::max(0, static_cast<int>(std::floor((top - rect.w) / p)));
+        y1 = std::min(tilesY(level) - 1, static_cast<int>(std::floor((top - rect.y) / p)));
+        return x0 <= x1 && y0 <= y1;
+    }
+
+private:
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<std::vector<unsigned char>> tiles;   // encoded bytes, row-major
+    };
+    std::vector<Level> m_levels;
+
+    void encodeTiles(const std::vector<unsigned char>& pixels, Level& level) const {
+        int countX = (level.width + tileSize - 1) / tileSize;
+        int countY = (level.height + tileSize - 1) / tileSize;
+        level.tiles.resize(static_cast<size_t>(countX) * countY);
+        for (int ty = 0; ty < countY; ++ty) {
+            for (int tx = 0; tx < countX; ++tx) {
+                int width = std::min(tileSize, level.width - tx * tileSize);
+                int height = std::min(tileSize, level.height - ty * tileSize);
+                const unsigned char* origin = pixels.data() +
+                    (static_cast<size_t>(ty) * tileSize * level.width + static_cast<size_t>(tx) * tileSize) * 4;
+                encodeTile(sourceCodec, origin, width, height, static_cast<size_t>(level.width) * 4,
+                           level.tiles[static_cast<size_t>(ty) * countX + tx]);
+            }
+        }
+    }
+
+    static void downsample(const std::vector<unsigned char>& src, int srcWidth, int srcHeight,
+                           std::vector<unsigned char>& dst, int dstWidth, int dstHeight) {
+        dst.resize(static_cast<size_t>(dstWidth) * dstHeight * 4);
+        for (int y = 0; y < dstHeight; ++y) {
+            int sy0 = 2 * y, sy1 = std::min(2 * y + 1, srcHeight - 1);
+            for (int x = 0; x < dstWidth; ++x) {
+                int sx0 = 2 * x, sx1 = std::min(2 * x + 1, srcWidth - 1);
+                for (int c = 0; c < 4; ++c) {
+                    int sum = src[(static_cast<size_t>(sy0) * srcWidth + sx0) * 4 + c] +
+                              src[(static_cast<size_t>(sy0) * srcWidth + sx1) * 4 + c] +
+                              src[(static_cast<size_t>(sy1) * srcWidth + sx0) * 4 + c] +
+                              src[(static_cast<size_t>(sy1) * srcWidth + sx1) * 4 + c];
+                    dst[(static_cast<size_t>(y) * dstWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+};
+
+// One tile wanted by the renderer or the prefetcher; lower priority values are served first
+struct TileRequest {
+    TileKey key;
+    float priority = 0.0f;
+};
+
+// Decoded tile, tightly packed (width * 4 bytes per row), plus its CPU tier encoding
+struct LoadedTile {
+    TileKey key;
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;
+    std::vector<unsigned char> encoded;
+};
+
+// Scheduler between the renderer and the decoders.
+// - Duplicates merge: a key requested several times in a frame, or again while pending or in flight, is
+//   one piece of work that keeps the best priority it was given.
+// - Ordering: pending work is kept sorted by priority, workers always take the most urgent tile.
+// - Cancellation: every frame submits the complete set of tiles it still wants; pending requests missing
+//   from that set are dropped before any decoder picks them up.
+class TileRequestQueue {
+public:
+    struct Stats {
+        long long submitted = 0;   // requests received, duplicates included
+        long long merged = 0;      // requests folded into an existing entry
+        long long cancelled = 0;   // pending requests dropped as no longer wanted
+        long long started = 0;     // requests handed to a decoder
+    };
+
+    // Replaces the wanted set for this frame (requests may contain duplicates)
+    void submitFrame(const std::vector<TileRequest>& requests) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+
+        for (const TileRequest& request : requests) {
+            ++m_stats.submitted;
+            uint64_t id = request.key.packed();
+            auto it = m_entries.find(id);
+            if (it == m_entries.end()) {
+                Entry entry;
+                entry.key = request.key;
+                entry.priority = request.priority;
+                entry.generation = m_generation;
+                m_entries.emplace(id, entry);
+                m_order.insert(std::make_pair(request.priority, id));
+                continue;
+            }
+
+            ++m_stats.merged;
+            Entry& entry = it->second;
+            if (entry.state == State::InFlight)
+                continue;
+            // First sighting this frame takes the new priority; later duplicates only improve it
+            float priority = entry.generation == m_generation ? std::min(entry.priority, request.priority) : request.priority;
+            if (priority != entry.priority) {
+                m_order.erase(std::make_pair(entry.priority, id));
+                entry.priority = priority;
+                m_order.insert(std::make_pair(priority, id));
+            }
+            entry.generation = m_generation;
+        }
+
+        // Everything still pending but not asked for this frame is no longer visible or predicted
+        for (auto it = m_order.begin(); it != m_order.end();) {
+            Entry& entry = m_entries[it->second];
+            if (entry.generation != m_generation) {
+                m_entries.erase(it->second);
+                it = m_order.erase(it);
+                ++m_stats.cancelled;
+            }
+            else {
+                ++it;
+            }
+        }
+
+        m_wakeup.notify_all();
+    }
+
+    // Blocks until there is work; returns false on shutdown
+    bool pop(TileKey& key) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeup.wait(lock, [this] { return m_shutdown || !m_order.empty(); });
+        if (m_shutdown)
+            return false;
+        uint64_t id = m_order.begin()->second;
+        m_order.erase(m_order.begin());
+        Entry& entry = m_entries[id];
+        entry.state = State::InFlight;
+        key = entry.key;
+        ++m_stats.started;
+        return true;
+    }
+
+    // The tile reached the cache; later requests for it are the cache's business
+    void delivered(const TileKey& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.erase(key.packed());
+    }
+
+    void shutdown() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+        m_wakeup.notify_all();
+    }
+
+    size_t pendingCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_order.size();
+    }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    enum class State { Pending, InFlight };
+    struct Entry {
+        TileKey key;
+        State state = State::Pending;
+        float priority = 0.0f;
+        uint64_t generation = 0;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::unordered_map<uint64_t, Entry> m_entries;    // pending and in-flight
+    std::set<std::pair<float, uint64_t>> m_order;     // pending only, most urgent first
+    uint64_t m_generation = 0;
+    bool m_shutdown = false;
+    Stats m_stats;
+};
+
+// Decoder threads pulling from the request queue; each tile is also encoded for the CPU tier here, off the
+// render thread, so an eviction later costs nothing but moving the bytes
+class TileLoaderPool {
+public:
+    void start(const TilePyramid* pyramid, TileRequestQueue* queue, TileCodec tierCodec) {
+        m_pyramid = pyramid;
+        m_queue = queue;
+        m_tierCodec = tierCodec;
+        for (int i = 0; i < loaderThreadCount; ++i)
+            m_threads.emplace_back(&TileLoaderPool::workerThread, this);
+    }
+
+    std::vector<LoadedTile> takeCompleted(int maxCount) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<LoadedTile> result;
+        while (!m_completed.empty() && static_cast<int>(result.size()) < maxCount) {
+            result.push_back(std::move(m_completed.front()));
+            m_completed.pop_front();
+        }
+        return result;
+    }
+
+    void stop() {
+        m_queue->shutdown();
+        for (std::thread& thread : m_threads)
+            thread.join();
+        m_threads.clear();
+        m_completed.clear();
+    }
+
+private:
+    const TilePyramid* m_pyramid = nullptr;
+    TileRequestQueue* m_queue = nullptr;
+    TileCodec m_tierCodec = TileCodec::Lz4;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::deque<LoadedTile> m_completed;
+
+    void workerThread() {
+        TileKey key;
+        while (m_queue->pop(key)) {
+            LoadedTile tile;
+            tile.key = key;
+            tile.pixels.resize(static_cast<size_t>(tileSize) * tileSize * 4);
+            m_pyramid->readTile(key, tile.pixels.data(), tile.width, tile.height);
+            encodeTile(m_tierCodec, tile.pixels.data(), tile.width, tile.height, static_cast<size_t>(tile.width) * 4, tile.encoded);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed.push_back(std::move(tile));
+        }
+    }
+};
+
+// CPU tier: encoded tiles the GPU tier evicted, least-recently-used first out once over cpuTierBudgetBytes
+class CompressedTileCache {
+public:
+    struct Entry {
+        int width = 0, height = 0;
+        std::vector<unsigned char> encoded;
+        std::list<uint64_t>::iterator position;   // in m_order, most recently inserted at the front
+    };
+
+    bool enabled = true;
+
+    void insert(const TileKey& key, int width, int height, std::vector<unsigned char>&& encoded) {
+        if (!enabled || encoded.empty())
+            return;
+        uint64_t id = key.packed();
+        erase(id);
+        m_order.push_front(id);
+        Entry& entry = m_entries[id];
+        entry.width = width;
+        entry.height = height;
+        entry.encoded = std::move(encoded);
+        entry.position = m_order.begin();
+        m_bytes += entry.encoded.size();
+
+        while (m_bytes > cpuTierBudgetBytes && !m_order.empty()) {
+            erase(m_order.back());
+            ++tierStats.cpuEvictions;
+        }
+    }
+
+    bool contains(const TileKey& key) const { return m_entries.count(key.packed()) != 0; }
+
+    // Removes a tile and hands over its encoding (the tiers are exclusive); false if it is not held
+    bool take(const TileKey& key, int& width, int& height, std::vector<unsigned char>& encoded) {
+        auto it = m_entries.find(key.packed());
+        if (it == m_entries.end())
+            return false;
+        width = it->second.width;
+        height = it->second.height;
+        encoded = std::move(it->second.encoded);
+        erase(key.packed());
+        return true;
+    }
+
+    void clear() {
+        m_entries.clear();
+        m_order.clear();
+        m_bytes = 0;
+    }
+
+    size_t size() const { return m_entries.size(); }
+    size_t bytes() const { return m_bytes; }
+
+private:
+    std::unordered_map<uint64_t, Entry> m_entries;
+    std::list<uint64_t> m_order;
+    size_t m_bytes = 0;
+
+    void erase(uint64_t id) {
+        auto it = m_entries.find(id);
+        if (it == m_entries.end())
+            return;
+        m_bytes -= it->second.encoded.size();
+        m_order.erase(it->second.position);
+        m_entries.erase(it);
+    }
+};
+
+// GPU tier: resident tiles, evicted least-recently-used once over budget. Each entry keeps the tile's CPU
+// tier encoding, which moves down a tier when the texture is deleted.
+class TileCache {
+public:
+    struct Entry {
+        GLuint texture = 0;
+        int width = 0, height = 0;
+        int lastUsedFrame = 0;
+        bool drawn = false;
+        std::vector<unsigned char> encoded;
+    };
+
+    void upload(LoadedTile& tile, int frame) {
+        Entry entry;
+        entry.width = tile.width;
+        entry.height = tile.height;
+        entry.lastUsedFrame = frame;
+        entry.encoded = std::move(tile.encoded);
+
+        glGenTextures(1, &entry.texture);
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tile.width, tile.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, tile.pixels.data());
+
+        Entry& slot = m_entries[tile.key.packed()];
+        if (slot.texture)
+            glDeleteTextures(1, &slot.texture);
+        slot = std::move(entry);
+        ++m_uploads;
+    }
+
+    Entry* find(const TileKey& key) {
+        auto it = m_entries.find(key.packed());
+        return it == m_entries.end() ? nullptr : &it->second;
+    }
+
+    bool contains(const TileKey& key) const { return m_entries.count(key.packed()) != 0; }
+
+    void evict(int currentFrame, CompressedTileCache& lowerTier) {
+        if (m_entries.size() <= gpuTileBudget)
+            return;
+        std::vector<std::pair<int, uint64_t>> candidates;
+        for (const auto& item : m_entries)
+            if (item.second.lastUsedFrame < currentFrame)
+                candidates.emplace_back(item.second.lastUsedFrame, item.first);
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& candidate : candidates) {
+            if (m_entries.size() <= gpuTileBudget)
+                break;
+            Entry& victim = m_entries[candidate.second];
+            if (!victim.drawn)
+                ++m_unusedEvictions;
+            glDeleteTextures(1, &victim.texture);
+            lowerTier.insert(TileKey::fromPacked(candidate.second), victim.width, victim.height, std::move(victim.encoded));
+            m_entries.erase(candidate.second);
+        }
+    }
+
+    size_t size() const { return m_entries.size(); }
+    int getUploads() const { return m_uploads; }
+    int getUnusedEvictions() const { return m_unusedEvictions; }
+
+    void destroy() {
+        for (auto& item : m_entries)
+            glDeleteTextures(1, &item.second.texture);
+        m_entries.clear();
+    }
+
+private:
+    std::unordered_map<uint64_t, Entry> m_entries;
+    int m_uploads = 0;
+    int m_unusedEvictions = 0;   // decoded and uploaded, but evicted before ever being drawn
+};
+
+// Emits requests for the visible tiles and for the predicted camera path (duplicates are left to the queue).
+// priority = predicted seconds until visible + levelWeight * levels away from the current level
+//          + distanceWeight * distance from the view center (in half view extents)
+class Prefetcher {
+public:
+    bool enabled = true;
+
+    void collect(const Camera& camera, const TilePyramid& pyramid, const TileCache& cache,
+                 int framebufferWidth, int framebufferHeight, std::vector<TileRequest>& requests) {
+        requests.clear();
+        int currentLevel = pyramid.selectLevel(camera, framebufferWidth, framebufferHeight);
+
+        float horizon = enabled ? predictionHorizon : 0.0f;
+        for (float t = 0.0f; t <= horizon + 1e-4f; t += predictionStep) {
+            Camera future = camera.predicted(t);
+            int level = pyramid.selectLevel(future, framebufferWidth, framebufferHeight);
+            addRect(pyramid, cache, future, level, currentLevel, t, requests);
+        }
+
+        float zoomRate = camera.getZoomRate();
+        if (enabled && std::fabs(zoomRate) > zoomRateThreshold) {
+            float position = pyramid.levelPosition(camera, framebufferWidth, framebufferHeight);
+            float levelsPerSecond = zoomRate / std::log(2.0f);
+            int nextLevel = zoomRate > 0.0f ? currentLevel - 1 : currentLevel + 1;
+            float distanceToSwitch = zoomRate > 0.0f ? position - std::floor(position) : std::ceil(position) - position;
+            float timeToSwitch = distanceToSwitch / std::fabs(levelsPerSecond);
+            if (nextLevel >= 0 && nextLevel < pyramid.levelCount())
+                addRect(pyramid, cache, camera, nextLevel, currentLevel, timeToSwitch, requests);
+        }
+    }
+
+private:
+    void addRect(const TilePyramid& pyramid, const TileCache& cache, const Camera& view, int level, int currentLevel,
+                 float t, std::vector<TileRequest>& requests) {
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, view.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glm::vec2 center = view.getCenter();
+        float halfExtent = 1.0f / view.getScale();
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                if (cache.contains(key))
+                    continue;
+
+                glm::vec4 r = pyramid.tileRect(key);
+                glm::vec2 tileCenter((r.x + r.z) * 0.5f, (r.y + r.w) * 0.5f);
+                TileRequest request;
+                request.key = key;
+                request.priority = t + levelWeight * std::abs(level - currentLevel) +
+                                   distanceWeight * glm::length(tileCenter - center) / halfExtent;
+                requests.push_back(request);
+            }
+        }
+    }
+};
+
+// Draws each visible tile from its own texture, or the matching part of the nearest resident ancestor
+class TileRenderer {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 tileRect;  // world x0, y0, x1, y1
+uniform vec4 uvRect;    // u0, v0 (top-left), u1, v1 (bottom-right)
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(tileRect.xw, tileRect.zy, corner), 0.0, 1.0);
+    texCoord = mix(uvRect.xy, uvRect.zw, corner);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO;
+    GLint tileRectLoc, uvRectLoc;
+    int holes = 0;
+
+    void init(Camera* camera) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        tileRectLoc = glGetUniformLocation(shaderProgram, "tileRect");
+        uvRectLoc = glGetUniformLocation(shaderProgram, "uvRect");
+        // Corners come from gl_VertexID; the VAO only has to exist
+        glGenVertexArrays(1, &VAO);
+    }
+
+    void render(const Camera& camera, const TilePyramid& pyramid, TileCache& cache, int level, int frame) {
+        holes = 0;
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, camera.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                glm::vec4 rect = pyramid.tileRect(key);
+
+                // Walk up until a resident ancestor covers this tile
+                TileKey source = key;
+                TileCache::Entry* entry = cache.find(source);
+                if (!entry) {
+                    ++holes;
+                    ++tierStats.gpuMisses;
+                } else {
+                    ++tierStats.gpuHits;
+                }
+                while (!entry && source.level + 1 < pyramid.levelCount()) {
+                    source = source.parent();
+                    entry = cache.find(source);
+                }
+                if (!entry)
+                    continue;
+                entry->lastUsedFrame = frame;
+                entry->drawn = true;
+
+                // Part of the source tile covered by this tile, in the source's texel space
+                glm::vec4 sourceRect = pyramid.tileRect(source);
+                float u0 = (rect.x - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float u1 = (rect.z - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float v0 = (sourceRect.w - rect.w) / (sourceRect.w - sourceRect.y);
+                float v1 = (sourceRect.w - rect.y) / (sourceRect.w - sourceRect.y);
+
+                glBindTexture(GL_TEXTURE_2D, entry->texture);
+                glUniform4f(tileRectLoc, rect.x, rect.y, rect.z, rect.w);
+                glUniform4f(uvRectLoc, u0, v0, u1, v1);
+                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            }
+        }
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+    }
+};
+
+double percentage(long long part, long long total) {
+    return total > 0 ? 100.0 * part / total : 0.0;
+}
+
+int main(int argc, char** argv) {
+    std::string imagePath = "src/textures/assets/test_nb.png";
+    TileCodec tierCodec = TileCodec::Lz4;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--tier-codec" && i + 1 < argc) {
+            if (!parseTileCodec(argv[++i], tierCodec)) {
+                std::cerr << "Unknown codec " << argv[i] << " (raw, png, qoi or lz4)" << std::endl;
+                return -1;
+            }
+        } else {
+            imagePath = arg;
+        }
+    }
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    TilePyramid pyramid;
+    if (!pyramid.load(imagePath)) {
+        glfwTerminate();
+        return -1;
+    }
+    printf("CPU tier: %s tiles, budget %.0f MB\n", tileCodecName(tierCodec), cpuTierBudgetBytes / 1048576.0);
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    TileRequestQueue queue;
+    TileLoaderPool loaders;
+    loaders.start(&pyramid, &queue, tierCodec);
+    TileCache cache;
+    CompressedTileCache cpuTier;
+    Prefetcher prefetcher;
+    TileRenderer renderer;
+    renderer.init(&camera);
+
+    std::vector<TileRequest> requests;
+    std::vector<TileRequest> loaderRequests;
+    LoadedTile refill;
+    bool prefetchKeyDown = false;
+    bool sweepKeyDown = false;
+    bool tierKeyDown = false;
+    int sweepFramesLeft = 0;
+    float sweepFactor = 1.0f;
+    int frame = 0;
+    double lastTitleTime = glfwGetTime();
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool prefetchKeyPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+        if (prefetchKeyPressed && !prefetchKeyDown)
+            prefetcher.enabled = !prefetcher.enabled;
+        prefetchKeyDown = prefetchKeyPressed;
+
+        // Z: zoom in through zoomSweepLevels levels in zoomSweepFrames frames
+        bool sweepKeyPressed = glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS;
+        if (sweepKeyPressed && !sweepKeyDown && sweepFramesLeft == 0) {
+            int levels = std::min(zoomSweepLevels, pyramid.selectLevel(camera, width, height));
+            sweepFactor = std::pow(2.0f, static_cast<float>(levels) / zoomSweepFrames);
+            sweepFramesLeft = zoomSweepFrames;
+        }
+        sweepKeyDown = sweepKeyPressed;
+        if (sweepFramesLeft > 0) {
+            camera.zoomBy(sweepFactor);
+            --sweepFramesLeft;
+        }
+
+        // T: CPU tier off (evicted tiles are dropped) or back on; the statistics start over
+        bool tierKeyPressed = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+        if (tierKeyPressed && !tierKeyDown) {
+            cpuTier.enabled = !cpuTier.enabled;
+            if (!cpuTier.enabled)
+                cpuTier.clear();
+            tierStats = TierStats();
+        }
+        tierKeyDown = tierKeyPressed;
+
+        camera.updateMotion(glfwGetTime());
+
+        // Wanted tiles the CPU tier holds are refilled here, most urgent first; only the others go to the
+        // loaders. The whole loader set is submitted every frame, whatever it no longer contains is cancelled.
+        prefetcher.collect(camera, pyramid, cache, width, height, requests);
+        std::stable_sort(requests.begin(), requests.end(),
+                         [](const TileRequest& a, const TileRequest& b) { return a.priority < b.priority; });
+        loaderRequests.clear();
+        int refills = 0;
+        for (const TileRequest& request : requests) {
+            if (cache.contains(request.key))
+                continue;   // a duplicate of a tile refilled a moment ago
+            if (!cpuTier.contains(request.key)) {
+                loaderRequests.push_back(request);
+                continue;
+            }
+            if (refills == maxRefillsPerFrame)
+                continue;   // stays in the CPU tier until a later frame
+            ++refills;
+
+            auto start = std::chrono::steady_clock::now();
+            refill.key = request.key;
+            cpuTier.take(request.key, refill.width, refill.height, refill.encoded);
+            refill.pixels.resize(static_cast<size_t>(refill.width) * refill.height * 4);
+            if (!decodeTile(tierCodec, refill.encoded, refill.width, refill.height, refill.pixels.data())) {
+                loaderRequests.push_back(request);
+                continue;
+            }
+            cache.upload(refill, frame);
+            tierStats.refillMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            tierStats.refillBytes += static_cast<double>(refill.pixels.size());
+            ++tierStats.cpuHits;
+        }
+        queue.submitFrame(loaderRequests);
+
+        for (LoadedTile& tile : loaders.takeCompleted(maxUploadsPerFrame)) {
+            cache.upload(tile, frame);
+            queue.delivered(tile.key);
+            ++tierStats.cpuMisses;
+        }
+
+        int level = pyramid.selectLevel(camera, width, height);
+        camera.publish(width, height);
+        renderer.render(camera, pyramid, cache, level, frame);
+        cache.evict(frame, cpuTier);
+
+        double now = glfwGetTime();
+        if (now - lastTitleTime > 0.5) {
+            char title[256];
+            snprintf(title, sizeof(title), "OpenGL - level %d | GPU tier: %zu tiles, hit %.1f%% | CPU tier %s: %zu tiles, %.1f MB, hit %.1f%%, refill %.0f us/tile",
+                     level, cache.size(), percentage(tierStats.gpuHits, tierStats.gpuHits + tierStats.gpuMisses),
+                     cpuTier.enabled ? tileCodecName(tierCodec) : "off", cpuTier.size(), cpuTier.bytes() / 1048576.0,
+                     percentage(tierStats.cpuHits, tierStats.cpuHits + tierStats.cpuMisses),
+                     tierStats.cpuHits > 0 ? tierStats.refillMilliseconds * 1000.0 / tierStats.cpuHits : 0.0);
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    TileRequestQueue::Stats stats = queue.getStats();
+    printf("Requests submitted: %lld, merged: %lld, cancelled: %lld, decoded: %lld\n",
+           stats.submitted, stats.merged, stats.cancelled, stats.started);
+    printf("Tile uploads: %d, evicted without being drawn: %d\n", cache.getUploads(), cache.getUnusedEvictions());
+    printf("GPU tier: %lld hits, %lld misses (%.1f%% hit rate)\n", tierStats.gpuHits, tierStats.gpuMisses,
+           percentage(tierStats.gpuHits, tierStats.gpuHits + tierStats.gpuMisses));
+    printf("CPU tier: %lld refills, %lld source decodes (%.1f%% hit rate), %lld dropped over budget, %zu tiles / %.2f MB held\n",
+           tierStats.cpuHits, tierStats.cpuMisses, percentage(tierStats.cpuHits, tierStats.cpuHits + tierStats.cpuMisses),
+           tierStats.cpuEvictions, cpuTier.size(), cpuTier.bytes() / 1048576.0);
+    if (tierStats.cpuHits > 0)
+        printf("Refill: %.1f us per tile, %.0f MB/s of RGBA including upload\n", tierStats.refillMilliseconds * 1000.0 / tierStats.cpuHits,
+               tierStats.refillBytes / 1048576.0 / (tierStats.refillMilliseconds / 1000.0));
+
+    loaders.stop();
+    renderer.destroy();
+    cache.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
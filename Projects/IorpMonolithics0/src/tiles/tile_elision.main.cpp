@@ -0,0 +1,1074 @@
+// tiled pyramid viewer that elides empty and uniform tiles
+// Every tile is classified once at load time as fully transparent, uniform color, opaque or mixed.
+// Transparent tiles are skipped entirely and uniform tiles are drawn as flat-color quads without a texture;
+// for both the pyramid keeps only the flag (and the color), so they are never stored, decoded or uploaded.
+// Opaque tiles and opaque flat quads are drawn with blending off; only mixed tiles are blended.
+// The console shows the class counts and pixel memory, the title shows per-frame draw counts.
+// Usage: tile_elision [image]   Keys: WASD pan, Q/E zoom, P toggles prefetching.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+const int tileSize = 128;
+
+// Level of Detail (LOD) bias, typically in the range -0.5 to 0.5
+float lodBias = 0.0f;
+
+// Loader configuration: worker count and an artificial per-tile cost standing in for a slow decoder/disk
+const int loaderThreadCount = 2;
+const int simulatedDecodeMs = 15;
+
+// GPU tile cache budget (tiles) and upload throttle (tiles per frame)
+const size_t gpuTileBudget = 192;
+const int maxUploadsPerFrame = 8;
+
+// Prediction: how far ahead the camera path is extrapolated, and the sampling step along it (seconds)
+const float predictionHorizon = 0.6f;
+const float predictionStep = 0.1f;
+// Time constant of the velocity smoothing (seconds)
+const float velocitySmoothing = 0.15f;
+// Zoom rates below this (ln(scale) per second) are treated as "not zooming"
+const float zoomRateThreshold = 0.05f;
+
+// Priority weights: seconds-equivalent cost of one level away from the current LOD / of one half view extent
+const float levelWeight = 0.5f;
+const float distanceWeight = 0.1f;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+// Identifies one tile of the pyramid
+struct TileKey {
+    int level = 0, x = 0, y = 0;
+
+    uint64_t packed() const {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+    }
+    TileKey parent() const {
+        TileKey p;
+        p.level = level + 1;
+        p.x = x / 2;
+        p.y = y / 2;
+        return p;
+    }
+};
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f), velocity(0.0f, 0.0f), zoomRate(0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    void zoomBy(float factor) {
+        scale *= factor;
+    }
+
+    // Measures how fast offset and scale changed since the last call, smoothed exponentially
+    void updateMotion(double now) {
+        if (lastTime < 0.0) {
+            lastTime = now;
+            lastOffset = offset;
+            lastScale = scale;
+            return;
+        }
+        float dt = static_cast<float>(now - lastTime);
+        if (dt <= 0.0f)
+            return;
+
+        glm::vec2 instantVelocity = (offset - lastOffset) / dt;
+        float instantZoomRate = std::log(scale / lastScale) / dt;
+        float alpha = 1.0f - std::exp(-dt / velocitySmoothing);
+        velocity += (instantVelocity - velocity) * alpha;
+        zoomRate += (instantZoomRate - zoomRate) * alpha;
+
+        lastTime = now;
+        lastOffset = offset;
+        lastScale = scale;
+    }
+
+    // Camera extrapolated t seconds ahead along the current pan/zoom motion
+    Camera predicted(float t) const {
+        Camera c = *this;
+        c.offset = offset + velocity * t;
+        c.scale = scale * std::exp(zoomRate * t);
+        return c;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    glm::vec2 getCenter() const { return -offset; }
+    float getScale() const { return scale; }
+    float getZoomRate() const { return zoomRate; }
+    glm::vec2 getVelocity() const { return velocity; }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    glm::vec2 velocity;   // world units per second (of offset)
+    float zoomRate;       // d ln(scale) / dt
+    double lastTime = -1.0;
+    glm::vec2 lastOffset;
+    float lastScale = 1.0f;
+    GLuint ubo = 0;
+};
+
+// How a tile's pixels are represented. Only Opaque and Mixed tiles keep pixels and need a texture;
+// Transparent tiles are never drawn and Uniform tiles are drawn as flat-color quads.
+enum class TileClass { Transparent, Uniform, Opaque, Mixed };
+
+const char* tileClassNames[] = { "transparent", "uniform", "opaque", "mixed" };
+
+struct TileInfo {
+    TileClass type = TileClass::Mixed;
+    glm::vec4 color = glm::vec4(0.0f);   // Uniform only, 0..1
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;   // Opaque and Mixed only
+};
+
+// Image plus its reduced levels, cut into tiles and classified once at load time.
+// World mapping keeps the aspect ratio: x spans [-1, 1], y spans [-h/w, h/w], row 0 at the top.
+class TilePyramid {
+public:
+    bool load(const std::string& imagePath) {
+        int width, height, nrChannels;
+        unsigned char* data = stbi_load(imagePath.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha);
+        if (!data) {
+            std::cerr << "Failed to load texture" << std::endl;
+            return false;
+        }
+
+        // Only the level being cut is kept dense; what stays resident is the per-tile representation
+        std::vector<unsigned char> dense(data, data + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(data);
+        for (;;) {
+            Level level;
+            level.width = width;
+            level.height = height;
+            cutTiles(dense, level);
+            m_levels.push_back(std::move(level));
+
+            // Halve until the whole level fits in one tile
+            if (width <= tileSize && height <= tileSize)
+                break;
+            int halfWidth = (width + 1) / 2, halfHeight = (height + 1) / 2;
+            std::vector<unsigned char> half;
+            downsample(dense, width, height, half, halfWidth, halfHeight);
+            dense.swap(half);
+            width = halfWidth;
+            height = halfHeight;
+        }
+
+        printf("Image size: %d x %d, levels: %d, tile size: %d\n", levelWidth(0), levelHeight(0), levelCount(), tileSize);
+        for (int type = 0; type < 4; ++type)
+            printf("  %s tiles: %d\n", tileClassNames[type], m_classCounts[type]);
+        printf("  pixel memory: %.2f MB stored, %.2f MB without elision\n", m_storedBytes / 1048576.0, m_denseBytes / 1048576.0);
+        return true;
+    }
+
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    int levelWidth(int level) const { return m_levels[level].width; }
+    int levelHeight(int level) const { return m_levels[level].height; }
+    int tilesX(int level) const { return (levelWidth(level) + tileSize - 1) / tileSize; }
+    int tilesY(int level) const { return (levelHeight(level) + tileSize - 1) / tileSize; }
+
+    bool isValid(const TileKey& key) const {
+        return key.level >= 0 && key.level < levelCount() &&
+               key.x >= 0 && key.x < tilesX(key.level) && key.y >= 0 && key.y < tilesY(key.level);
+    }
+
+    const TileInfo& tileInfo(const TileKey& key) const {
+        return m_levels[key.level].tiles[static_cast<size_t>(key.y) * tilesX(key.level) + key.x];
+    }
+
+    // Opaque and Mixed tiles go through the loader and the GPU cache; the others are drawn from their flag
+    bool needsTexture(const TileKey& key) const {
+        TileClass type = tileInfo(key).type;
+        return type == TileClass::Opaque || type == TileClass::Mixed;
+    }
+
+    // Copies one stored tile; stands in for a real tile decoder (thread-safe, read-only)
+    void readTile(const TileKey& key, std::vector<unsigned char>& pixels, int& width, int& height) const {
+        const TileInfo& info = tileInfo(key);
+        width = info.width;
+        height = info.height;
+        pixels = info.pixels;
+        std::this_thread::sleep_for(std::chrono::milliseconds(simulatedDecodeMs));
+    }
+
+    int getClassCount(TileClass type) const { return m_classCounts[static_cast<int>(type)]; }
+    size_t getStoredBytes() const { return m_storedBytes; }
+    size_t getDenseBytes() const { return m_denseBytes; }
+
+    // World units per level-0 pixel
+    float worldPerPixel() const { return 2.0f / m_levels[0].width; }
+
+    // World-space rectangle of a tile (min.x, min.y, max.x, max.y)
+    glm::vec4 tileRect(const TileKey& key) const {
+        int width0 = m_levels[0].width, height0 = m_levels[0].height;
+        int px0 = std::min(key.x * tileSize << key.level, width0);
+        int py0 = std::min(key.y * tileSize << key.level, height0);
+        int px1 = std::min((key.x + 1) * tileSize << key.level, width0);
+        int py1 = std::min((key.y + 1) * tileSize << key.level, height0);
+        float p = worldPerPixel();
+        float top = height0 * p * 0.5f;
+        return glm::vec4(px0 * p - 1.0f, top - py1 * p, px1 * p - 1.0f, top - py0 * p);
+    }
+
+    // Level whose texel density best matches the screen for this camera
+    int selectLevel(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        float texelsPerScreenPixel = 1.0f / (worldPerPixel() * screenPixelsPerWorld);
+        int level = static_cast<int>(std::floor(std::log2(std::max(texelsPerScreenPixel, 1e-6f)) + lodBias));
+        return std::max(0, std::min(level, levelCount() - 1));
+    }
+
+    // Continuous level (before flooring), used to predict level switches
+    float levelPosition(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        return std::log2(1.0f / (worldPerPixel() * screenPixelsPerWorld)) + lodBias;
+    }
+
+    // Range of tiles of a level that intersect a world rectangle; false if none
+    bool tileRange(int level, const glm::vec4& rect, int& x0, int& y0, int& x1, int& y1) const {
+        float p = worldPerPixel() * static_cast<float>(1 << level) * tileSize;  // world size of one tile
+        float top = m_levels[0].height * worldPerPixel() * 0.5f;
+        x0 = std::max(0, static_cast<int>(std::floor((rect.x + 1.0f) / p)));
+        x1 = std::min(tilesX(level) - 1, static_cast<int>(std::floor((rect.z + 1.0f) / p)));
+        y0 = std::max(0, static_cast<int>(std::floor((top - rect.w) / p)));
+        y1 = std::min(tilesY(level) - 1, static_cast<int>(std::floor((top - rect.y) / p)));
+        return x0 <= x1 && y0 <= y1;
+    }
+
+private:
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<TileInfo> tiles;   // row-major, tilesX * tilesY
+    };
+    std::vector<Level> m_levels;
+    int m_classCounts[4] = {};
+    size_t m_storedBytes = 0;
+    size_t m_denseBytes = 0;
+
+    void cutTiles(const std::vector<unsigned char>& dense, Level& level) {
+        int countX = (level.width + tileSize - 1) / tileSize;
+        int countY = (level.height + tileSize - 1) / tileSize;
+        level.tiles.resize(static_cast<size_t>(countX) * countY);
+        for (int ty = 0; ty < countY; ++ty) {
+            for (int tx = 0; tx < countX; ++tx) {
+                TileInfo& info = level.tiles[static_cast<size_t>(ty) * countX + tx];
+                info.width = std::min(tileSize, level.width - tx * tileSize);
+                info.height = std::min(tileSize, level.height - ty * tileSize);
+                info.pixels.resize(static_cast<size_t>(info.width) * info.height * 4);
+                for (int row = 0; row < info.height; ++row) {
+                    const unsigned char* src = dense.data() +
+                        ((static_cast<size_t>(ty) * tileSize + row) * level.width + static_cast<size_t>(tx) * tileSize) * 4;
+                    memcpy(info.pixels.data() + static_cast<size_t>(row) * info.width * 4, src, static_cast<size_t>(info.width) * 4);
+                }
+
+                classify(info);
+                ++m_classCounts[static_cast<int>(info.type)];
+                m_storedBytes += info.pixels.size();
+                m_denseBytes += static_cast<size_t>(info.width) * info.height * 4;
+            }
+        }
+    }
+
+    // Exact classification: any single differing texel makes a tile Opaque or Mixed
+    static void classify(TileInfo& info) {
+        const unsigned char* p = info.pixels.data();
+        size_t count = static_cast<size_t>(info.width) * info.height;
+        bool transparent = true, opaque = true, uniform = true;
+        for (size_t i = 0; i < count; ++i, p += 4) {
+            transparent = transparent && p[3] == 0;
+            opaque = opaque && p[3] == 255;
+            uniform = uniform && memcmp(p, info.pixels.data(), 4) == 0;
+            if (!transparent && !opaque && !uniform)
+                break;
+        }
+
+        if (transparent)
+            info.type = TileClass::Transparent;
+        else if (uniform)
+            info.type = TileClass::Uniform;
+        else
+            info.type = opaque ? TileClass::Opaque : TileClass::Mixed;
+
+        if (info.type == TileClass::Uniform) {
+            const unsigned char* c = info.pixels.data();
+            info.color = glm::vec4(c[0], c[1], c[2], c[3]) / 255.0f;
+        }
+        if (info.type == TileClass::Transparent || info.type == TileClass::Uniform)
+            std::vector<unsigned char>().swap(info.pixels);
+    }
+
+    static void downsample(const std::vector<unsigned char>& src, int srcWidth, int srcHeight,
+                           std::vector<unsigned char>& dst, int dstWidth, int dstHeight) {
+        dst.resize(static_cast<size_t>(dstWidth) * dstHeight * 4);
+        for (int y = 0; y < dstHeight; ++y) {
+            int sy0 = 2 * y, sy1 = std::min(2 * y + 1, srcHeight - 1);
+            for (int x = 0; x < dstWidth; ++x) {
+                int sx0 = 2 * x, sx1 = std::min(2 * x + 1, srcWidth - 1);
+                for (int c = 0; c < 4; ++c) {
+                    int sum = src[(static_cast<size_t>(sy0) * srcWidth + sx0) * 4 + c] +
+                              src[(static_cast<size_t>(sy0) * srcWidth + sx1) * 4 + c] +
+                              src[(static_cast<size_t>(sy1) * srcWidth + sx0) * 4 + c] +
+                              src[(static_cast<size_t>(sy1) * srcWidth + sx1) * 4 + c];
+                    dst[(static_cast<size_t>(y) * dstWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+};
+
+// One tile wanted by the renderer or the prefetcher; lower priority values are served first
+struct TileRequest {
+    TileKey key;
+    float priority = 0.0f;
+};
+
+struct LoadedTile {
+    TileKey key;
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;
+};
+
+// Scheduler between the renderer and the decoders.
+// - Duplicates merge: a key requested several times in a frame, or again while pending or in flight, is
+//   one piece of work that keeps the best priority it was given.
+// - Ordering: pending work is kept sorted by priority, workers always take the most urgent tile.
+// - Cancellation: every frame submits the complete set of tiles it still wants; pending requests missing
+//   from that set are dropped before any decoder picks them up.
+class TileRequestQueue {
+public:
+    struct Stats {
+        long long submitted = 0;   // requests received, duplicates included
+        long long merged = 0;      // requests folded into an existing entry
+        long long cancelled = 0;   // pending requests dropped as no longer wanted
+        long long started = 0;     // requests handed to a decoder
+    };
+
+    // Replaces the wanted set for this frame (requests may contain duplicates)
+    void submitFrame(const std::vector<TileRequest>& requests) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+
+        for (const TileRequest& request : requests) {
+            ++m_stats.submitted;
+            uint64_t id = request.key.packed();
+            auto it = m_entries.find(id);
+            if (it == m_entries.end()) {
+                Entry entry;
+                entry.key = request.key;
+                entry.priority = request.priority;
+                entry.generation = m_generation;
+                m_entries.emplace(id, entry);
+                m_order.insert(std::make_pair(request.priority, id));
+                continue;
+            }
+
+            ++m_stats.merged;
+            Entry& entry = it->second;
+            if (entry.state == State::InFlight)
+                continue;
+            // First sighting this frame takes the new priority; later duplicates only improve it
+            float priority = entry.generation == m_generation ? std::min(entry.priority, request.priority) : request.priority;
+            if (priority != entry.priority) {
+                m_order.erase(std::make_pair(entry.priority, id));
+                entry.priority = priority;
+                m_order.insert(std::make_pair(priority, id));
+            }
+            entry.generation = m_generation;
+        }
+
+        // Everything still pending but not asked for this frame is no longer visible or predicted
+        for (auto it = m_order.begin(); it != m_order.end();) {
+            Entry& entry = m_entries[it->second];
+            if (entry.generation != m_generation) {
+                m_entries.erase(it->second);
+                it = m_order.erase(it);
+                ++m_stats.cancelled;
+            }
+            else {
+                ++it;
+            }
+        }
+
+        m_wakeup.notify_all();
+    }
+
+    // Blocks until there is work; returns false on shutdown
+    bool pop(TileKey& key) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeup.wait(lock, [this] { return m_shutdown || !m_order.empty(); });
+        if (m_shutdown)
+            return false;
+        uint64_t id = m_order.begin()->second;
+        m_order.erase(m_order.begin());
+        Entry& entry = m_entries[id];
+        entry.state = State::InFlight;
+        key = entry.key;
+        ++m_stats.started;
+        return true;
+    }
+
+    // The tile reached the cache; later requests for it are the cache's business
+    void delivered(const TileKey& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.erase(key.packed());
+    }
+
+    void shutdown() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+        m_wakeup.notify_all();
+    }
+
+    size_t pendingCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_order.size();
+    }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    enum class State { Pending, InFlight };
+    struct Entry {
+        TileKey key;
+        State state = State::Pending;
+        float priority = 0.0f;
+        uint64_t generation = 0;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::unordered_map<uint64_t, Entry> m_entries;    // pending and in-flight
+    std::set<std::pair<float, uint64_t>> m_order;     // pending only, most urgent first
+    uint64_t m_generation = 0;
+    bool m_shutdown = false;
+    Stats m_stats;
+};
+
+// Decoder threads pulling from the request queue
+class TileLoaderPool {
+public:
+    void start(const TilePyramid* pyramid, TileRequestQueue* queue) {
+        m_pyramid = pyramid;
+        m_queue = queue;
+        for (int i = 0; i < loaderThreadCount; ++i)
+            m_threads.emplace_back(&TileLoaderPool::workerThread, this);
+    }
+
+    std::vector<LoadedTile> takeCompleted(int maxCount) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<LoadedTile> result;
+        while (!m_completed.empty() && static_cast<int>(result.size()) < maxCount) {
+            result.push_back(std::move(m_completed.front()));
+            m_completed.pop_front();
+        }
+        return result;
+    }
+
+    void stop() {
+        m_queue->shutdown();
+        for (std::thread& thread : m_threads)
+            thread.join();
+        m_threads.clear();
+    }
+
+private:
+    const TilePyramid* m_pyramid = nullptr;
+    TileRequestQueue* m_queue = nullptr;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::deque<LoadedTile> m_completed;
+
+    void workerThread() {
+        TileKey key;
+        while (m_queue->pop(key)) {
+            LoadedTile tile;
+            tile.key = key;
+            m_pyramid->readTile(key, tile.pixels, tile.width, tile.height);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed.push_back(std::move(tile));
+        }
+    }
+};
+
+// GPU-resident tiles, evicted least-recently-used once over budget
+class TileCache {
+public:
+    struct Entry {
+        GLuint texture = 0;
+        int width = 0, height = 0;
+        int lastUsedFrame = 0;
+        bool drawn = false;
+    };
+
+    void upload(const LoadedTile& tile, int frame) {
+        Entry entry;
+        entry.width = tile.width;
+        entry.height = tile.height;
+        entry.lastUsedFrame = frame;
+
+        glGenTextures(1, &entry.texture);
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tile.width, tile.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, tile.pixels.data());
+
+        m_entries[tile.key.packed()] = entry;
+        ++m_uploads;
+    }
+
+    Entry* find(const TileKey& key) {
+        auto it = m_entries.find(key.packed());
+        return it == m_entries.end() ? nullptr : &it->second;
+    }
+
+    bool contains(const TileKey& key) const { return m_entries.count(key.packed()) != 0; }
+
+    void evict(int currentFrame) {
+        if (m_entries.size() <= gpuTileBudget)
+            return;
+        std::vector<std::pair<int, uint64_t>> candidates;
+        for (const auto& item : m_entries)
+            if (item.second.lastUsedFrame < currentFrame)
+                candidates.emplace_back(item.second.lastUsedFrame, item.first);
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& candidate : candidates) {
+            if (m_entries.size() <= gpuTileBudget)
+                break;
+            Entry& victim = m_entries[candidate.second];
+            if (!victim.drawn)
+                ++m_unusedEvictions;
+            glDeleteTextures(1, &victim.texture);
+            m_entries.erase(candidate.second);
+        }
+    }
+
+    size_t size() const { return m_entries.size(); }
+    int getUploads() const { return m_uploads; }
+    int getUnusedEvictions() const { return m_unusedEvictions; }
+
+    void destroy() {
+        for (auto& item : m_entries)
+            glDeleteTextures(1, &item.second.texture);
+        m_entries.clear();
+    }
+
+private:
+    std::unordered_map<uint64_t, Entry> m_entries;
+    int m_uploads = 0;
+    int m_unusedEvictions = 0;   // decoded and uploaded, but evicted before ever being drawn
+};
+
+// Emits requests for the visible tiles and for the predicted camera path (duplicates are left to the queue).
+// priority = predicted seconds until visible + levelWeight * levels away from the current level
+//          + distanceWeight * distance from the view center (in half view extents)
+class Prefetcher {
+public:
+    bool enabled = true;
+
+    void collect(const Camera& camera, const TilePyramid& pyramid, const TileCache& cache,
+                 int framebufferWidth, int framebufferHeight, std::vector<TileRequest>& requests) {
+        requests.clear();
+        int currentLevel = pyramid.selectLevel(camera, framebufferWidth, framebufferHeight);
+
+        float horizon = enabled ? predictionHorizon : 0.0f;
+        for (float t = 0.0f; t <= horizon + 1e-4f; t += predictionStep) {
+            Camera future = camera.predicted(t);
+            int level = pyramid.selectLevel(future, framebufferWidth, framebufferHeight);
+            addRect(pyramid, cache, future, level, currentLevel, t, requests);
+        }
+
+        float zoomRate = camera.getZoomRate();
+        if (enabled && std::fabs(zoomRate) > zoomRateThreshold) {
+            float position = pyramid.levelPosition(camera, framebufferWidth, framebufferHeight);
+            float levelsPerSecond = zoomRate / std::log(2.0f);
+            int nextLevel = zoomRate > 0.0f ? currentLevel - 1 : currentLevel + 1;
+            float distanceToSwitch = zoomRate > 0.0f ? position - std::floor(position) : std::ceil(position) - position;
+            float timeToSwitch = distanceToSwitch / std::fabs(levelsPerSecond);
+            if (nextLevel >= 0 && nextLevel < pyramid.levelCount())
+                addRect(pyramid, cache, camera, nextLevel, currentLevel, timeToSwitch, requests);
+        }
+    }
+
+private:
+    void addRect(const TilePyramid& pyramid, const TileCache& cache, const Camera& view, int level, int currentLevel,
+                 float t, std::vector<TileRequest>& requests) {
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, view.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glm::vec2 center = view.getCenter();
+        float halfExtent = 1.0f / view.getScale();
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                if (!pyramid.needsTexture(key) || cache.contains(key))
+                    continue;
+
+                glm::vec4 r = pyramid.tileRect(key);
+                glm::vec2 tileCenter((r.x + r.z) * 0.5f, (r.y + r.w) * 0.5f);
+                TileRequest request;
+                request.key = key;
+                request.priority = t + levelWeight * std::abs(level - currentLevel) +
+                                   distanceWeight * glm::length(tileCenter - center) / halfExtent;
+                requests.push_back(request);
+            }
+        }
+    }
+};
+
+// Draws the visible tiles by class: transparent tiles are skipped, uniform tiles become flat-color quads,
+// and textured tiles come from their own texture or the matching part of the nearest resident ancestor.
+// Fully opaque quads are drawn with blending off; only the rest pay for blending.
+class TileRenderer {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 tileRect;  // world x0, y0, x1, y1
+uniform vec4 uvRect;    // u0, v0 (top-left), u1, v1 (bottom-right)
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(tileRect.xw, tileRect.zy, corner), 0.0, 1.0);
+    texCoord = mix(uvRect.xy, uvRect.zw, corner);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+
+    const char* flatVertexShaderSource = R"(
+uniform vec4 tileRect;  // world x0, y0, x1, y1
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(tileRect.xw, tileRect.zy, corner), 0.0, 1.0);
+}
+)";
+
+    const char* flatFragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+uniform vec4 color;
+
+void main()
+{
+    FragColor = color;
+}
+)";
+
+    // Per-frame draw statistics
+    struct Stats {
+        int textured = 0;
+        int flat = 0;
+        int blended = 0;
+        int skipped = 0;   // transparent tiles never drawn
+    };
+
+    GLuint shaderProgram, flatShaderProgram;
+    GLuint VAO;
+    GLint tileRectLoc, uvRectLoc, flatTileRectLoc, flatColorLoc;
+    int holes = 0;
+    Stats stats;
+
+    void init(Camera* camera) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        tileRectLoc = glGetUniformLocation(shaderProgram, "tileRect");
+        uvRectLoc = glGetUniformLocation(shaderProgram, "uvRect");
+
+        flatShaderProgram = createCameraShaderProgram(flatVertexShaderSource, flatFragmentShaderSource);
+        camera->attachProgram(flatShaderProgram);
+        flatTileRectLoc = glGetUniformLocation(flatShaderProgram, "tileRect");
+        flatColorLoc = glGetUniformLocation(flatShaderProgram, "color");
+
+        // Corners come from gl_VertexID; the VAO only has to exist
+        glGenVertexArrays(1, &VAO);
+    }
+
+    void render(const Camera& camera, const TilePyramid& pyramid, TileCache& cache, int level, int frame) {
+        holes = 0;
+        stats = Stats();
+        for (std::vector<DrawItem>& batch : m_batches)
+            batch.clear();
+
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, camera.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                glm::vec4 rect = pyramid.tileRect(key);
+
+                // Walk up until a tile that can be drawn covers this one: an elided tile is always "resident"
+                TileKey source = key;
+                TileCache::Entry* entry = nullptr;
+                bool found = false;
+                for (;;) {
+                    if (!pyramid.needsTexture(source)) {
+                        found = true;
+                        break;
+                    }
+                    entry = cache.find(source);
+                    if (entry) {
+                        found = true;
+                        break;
+                    }
+                    if (source.level == key.level)
+                        ++holes;
+                    if (source.level + 1 >= pyramid.levelCount())
+                        break;
+                    source = source.parent();
+                }
+                if (!found)
+                    continue;
+
+                const TileInfo& info = pyramid.tileInfo(source);
+                DrawItem item;
+                item.rect = rect;
+                if (info.type == TileClass::Transparent) {
+                    ++stats.skipped;
+                    continue;
+                }
+                if (info.type == TileClass::Uniform) {
+                    item.color = info.color;
+                    m_batches[(info.color.w < 1.0f ? 2 : 0) + 1].push_back(item);
+                    continue;
+                }
+
+                entry->lastUsedFrame = frame;
+                entry->drawn = true;
+
+                // Part of the source tile covered by this tile, in the source's texel space
+                glm::vec4 sourceRect = pyramid.tileRect(source);
+                item.uv = glm::vec4((rect.x - sourceRect.x) / (sourceRect.z - sourceRect.x),
+                                    (sourceRect.w - rect.w) / (sourceRect.w - sourceRect.y),
+                                    (rect.z - sourceRect.x) / (sourceRect.z - sourceRect.x),
+                                    (sourceRect.w - rect.y) / (sourceRect.w - sourceRect.y));
+                item.texture = entry->texture;
+                m_batches[info.type == TileClass::Mixed ? 2 : 0].push_back(item);
+            }
+        }
+
+        glBindVertexArray(VAO);
+        for (int batch = 0; batch < 4; ++batch) {
+            if (m_batches[batch].empty())
+                continue;
+            bool blended = batch >= 2;
+            bool flat = (batch & 1) != 0;
+            if (blended)
+                glEnable(GL_BLEND);
+            else
+                glDisable(GL_BLEND);
+            glUseProgram(flat ? flatShaderProgram : shaderProgram);
+
+            for (const DrawItem& item : m_batches[batch]) {
+                if (flat) {
+                    glUniform4f(flatTileRectLoc, item.rect.x, item.rect.y, item.rect.z, item.rect.w);
+                    glUniform4f(flatColorLoc, item.color.x, item.color.y, item.color.z, item.color.w);
+                    ++stats.flat;
+                } else {
+                    glBindTexture(GL_TEXTURE_2D, item.texture);
+                    glUniform4f(tileRectLoc, item.rect.x, item.rect.y, item.rect.z, item.rect.w);
+                    glUniform4f(uvRectLoc, item.uv.x, item.uv.y, item.uv.z, item.uv.w);
+                    ++stats.textured;
+                }
+                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            }
+            if (blended)
+                stats.blended += static_cast<int>(m_batches[batch].size());
+        }
+        glBindVertexArray(0);
+        glEnable(GL_BLEND);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+        glDeleteProgram(flatShaderProgram);
+    }
+
+private:
+    struct DrawItem {
+        glm::vec4 rect;
+        glm::vec4 uv;
+        glm::vec4 color;
+        GLuint texture = 0;
+    };
+    // Indexed by blended * 2 + flat, so each batch needs a single blend state and program
+    std::vector<DrawItem> m_batches[4];
+};
+
+int main(int argc, char** argv) {
+    std::string imagePath = argc > 1 ? argv[1] : "src/textures/assets/test_nb.png";
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    TilePyramid pyramid;
+    if (!pyramid.load(imagePath)) {
+        glfwTerminate();
+        return -1;
+    }
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    TileRequestQueue queue;
+    TileLoaderPool loaders;
+    loaders.start(&pyramid, &queue);
+    TileCache cache;
+    Prefetcher prefetcher;
+    TileRenderer renderer;
+    renderer.init(&camera);
+
+    std::vector<TileRequest> requests;
+    bool prefetchKeyDown = false;
+    int frame = 0;
+    double lastTitleTime = glfwGetTime();
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool prefetchKeyPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+        if (prefetchKeyPressed && !prefetchKeyDown)
+            prefetcher.enabled = !prefetcher.enabled;
+        prefetchKeyDown = prefetchKeyPressed;
+
+        camera.updateMotion(glfwGetTime());
+
+        prefetcher.collect(camera, pyramid, cache, width, height, requests);
+        queue.submitFrame(requests);
+
+        for (const LoadedTile& tile : loaders.takeCompleted(maxUploadsPerFrame)) {
+            cache.upload(tile, frame);
+            queue.delivered(tile.key);
+        }
+
+        int level = pyramid.selectLevel(camera, width, height);
+        camera.publish(width, height);
+        renderer.render(camera, pyramid, cache, level, frame);
+        cache.evict(frame);
+
+        double now = glfwGetTime();
+        if (now - lastTitleTime > 0.5) {
+            char title[200];
+            snprintf(title, sizeof(title), "OpenGL - level %d, textured %d, flat %d, skipped %d, blended %d, holes %d, resident %zu",
+                     level, renderer.stats.textured, renderer.stats.flat, renderer.stats.skipped, renderer.stats.blended,
+                     renderer.holes, cache.size());
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    printf("Tile uploads: %d (elided tiles never uploaded: %d)\n", cache.getUploads(),
+           pyramid.getClassCount(TileClass::Transparent) + pyramid.getClassCount(TileClass::Uniform));
+
+    loaders.stop();
+    renderer.destroy();
+    cache.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,1464 @@
+// virtual mosaic: a directory of image files viewed as one tiled pyramid, indexed by an R-tree
+// Opening the mosaic reads file headers only (libtiff's first directory, stbi_info), on several threads, plus
+// an optional world file per image, and bulk loads the footprints into a packed STR R-tree. No pixel is
+// decoded until a tile needs it:
+//   - each tile request queries the R-tree and reads only the sources that overlap the tile
+//   - decoded sources (with their halved levels) live in an LRU under decodedBudgetBytes; the smallest level
+//     of every source stays behind as a thumbnail, which serves zoomed-out tiles without any decode
+// So opening costs a header read per file, and memory follows what is on screen rather than the directory.
+// Images are placed by their world files (.pgw, .tfw, .jgw, ... or .wld) when all have one, otherwise in a
+// grid in file name order. --generate writes a directory of georeferenced test scenes first, by default
+// iorp_mosaic_scenes in the temp directory so the repository's assets stay untouched.
+// Usage: tile_mosaic [directory] [--generate count]   Keys: WASD pan, Q/E zoom, Z zoom sweep, P prefetch.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <chrono>
+#include <filesystem>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <tiffio.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+const int tileSize = 128;
+
+// Level of Detail (LOD) bias, typically in the range -0.5 to 0.5
+float lodBias = 0.0f;
+
+// Loader configuration: decoder thread count
+const int loaderThreadCount = 2;
+
+// Opening: threads reading headers; R-tree node capacity
+const unsigned probeThreadCount = 8;
+const size_t rtreeFanout = 16;
+
+// Decoded sources kept in memory (bytes, all levels), and the size a source's last level fits in; that level
+// is kept as a thumbnail when the source is evicted
+const size_t decodedBudgetBytes = 256 * 1024 * 1024;
+const int thumbnailSize = 64;
+
+// GPU tile cache budget (tiles) and upload throttle (tiles per frame)
+const size_t gpuTileBudget = 192;
+const int maxUploadsPerFrame = 8;
+
+// Prediction: how far ahead the camera path is extrapolated, and the sampling step along it (seconds)
+const float predictionHorizon = 0.6f;
+const float predictionStep = 0.1f;
+// Time constant of the velocity smoothing (seconds)
+const float velocitySmoothing = 0.15f;
+// Zoom rates below this (ln(scale) per second) are treated as "not zooming"
+const float zoomRateThreshold = 0.05f;
+
+// Priority weights: seconds-equivalent cost of one level away from the current LOD / of one half view extent
+const float levelWeight = 0.5f;
+const float distanceWeight = 0.1f;
+
+// Z key: zoom in by this many levels over this many frames
+const int zoomSweepLevels = 5;
+const int zoomSweepFrames = 30;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+// Identifies one tile of the pyramid
+struct TileKey {
+    int level = 0, x = 0, y = 0;
+
+    uint64_t packed() const {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+    }
+    TileKey parent() const {
+        TileKey p;
+        p.level = level + 1;
+        p.x = x / 2;
+        p.y = y / 2;
+        return p;
+    }
+};
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f), velocity(0.0f, 0.0f), zoomRate(0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    void zoomBy(float factor) {
+        scale *= factor;
+    }
+
+    // Measures how fast offset and scale changed since the last call, smoothed exponentially
+    void updateMotion(double now) {
+        if (lastTime < 0.0) {
+            lastTime = now;
+            lastOffset = offset;
+            lastScale = scale;
+            return;
+        }
+        float dt = static_cast<float>(now - lastTime);
+        if (dt <= 0.0f)
+            return;
+
+        glm::vec2 instantVelocity = (offset - lastOffset) / dt;
+        float instantZoomRate = std::log(scale / lastScale) / dt;
+        float alpha = 1.0f - std::exp(-dt / velocitySmoothing);
+        velocity += (instantVelocity - velocity) * alpha;
+        zoomRate += (instantZoomRate - zoomRate) * alpha;
+
+        lastTime = now;
+        lastOffset = offset;
+        lastScale = scale;
+    }
+
+    // Camera extrapolated t seconds ahead along the current pan/zoom motion
+    Camera predicted(float t) const {
+        Camera c = *this;
+        c.offset = offset + velocity * t;
+        c.scale = scale * std::exp(zoomRate * t);
+        return c;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    glm::vec2 getCenter() const { return -offset; }
+    float getScale() const { return scale; }
+    float getZoomRate() const { return zoomRate; }
+    glm::vec2 getVelocity() const { return velocity; }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    glm::vec2 velocity;   // world units per second (of offset)
+    float zoomRate;       // d ln(scale) / dt
+    double lastTime = -1.0;
+    glm::vec2 lastOffset;
+    float lastScale = 1.0f;
+    GLuint ubo = 0;
+};
+
+// RGBA decode of a whole image; TIFFs go through libtiff, everything else through stb_image
+bool decodeImage(const std::string& path, std::vector<unsigned char>& pixels, int& width, int& height) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".tif" || extension == ".tiff") {
+        TIFF* tif = TIFFOpen(path.c_str(), "r");
+        if (!tif)
+            return false;
+        uint32_t w = 0, h = 0;
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &w);
+        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &h);
+        pixels.resize(static_cast<size_t>(w) * h * 4);
+        bool ok = TIFFReadRGBAImageOriented(tif, w, h, reinterpret_cast<uint32_t*>(pixels.data()), ORIENTATION_TOPLEFT, 0) != 0;
+        TIFFClose(tif);
+        width = static_cast<int>(w);
+        height = static_cast<int>(h);
+        return ok;
+    }
+    int nrChannels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha);
+    if (!data)
+        return false;
+    pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(data);
+    return true;
+}
+
+// Image size from the file header alone: libtiff reads the first directory, stbi_info the format header
+bool probeImage(const std::string& path, int& width, int& height) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".tif" || extension == ".tiff") {
+        TIFF* tif = TIFFOpen(path.c_str(), "r");
+        if (!tif)
+            return false;
+        uint32_t w = 0, h = 0;
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &w);
+        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &h);
+        TIFFClose(tif);
+        width = static_cast<int>(w);
+        height = static_cast<int>(h);
+        return width > 0 && height > 0;
+    }
+    int components;
+    return stbi_info(path.c_str(), &width, &height, &components) != 0 && width > 0 && height > 0;
+}
+
+// ESRI world file next to an image: x pixel size, two rotation terms, y pixel size (negative for north up)
+// and the world position of the center of the top-left pixel. Tried as .pgw/.tfw/.jgw (first and last letter
+// of the extension + w), as the extension + w, and as .wld.
+struct WorldFile {
+    double pixelSizeX = 0.0, rotationY = 0.0, rotationX = 0.0, pixelSizeY = 0.0, originX = 0.0, originY = 0.0;
+};
+
+bool readWorldFile(const std::string& imagePath, WorldFile& world) {
+    std::filesystem::path path(imagePath);
+    std::string extension = path.extension().string();
+    std::vector<std::string> candidates;
+    if (extension.size() >= 3)
+        candidates.push_back(std::string(".") + extension[1] + extension.back() + "w");
+    candidates.push_back(extension + "w");
+    candidates.push_back(".wld");
+
+    for (const std::string& candidate : candidates) {
+        std::filesystem::path worldPath = path;
+        worldPath.replace_extension(candidate);
+        FILE* file = fopen(worldPath.string().c_str(), "r");
+        if (!file)
+            continue;
+        int read = fscanf(file, "%lf %lf %lf %lf %lf %lf", &world.pixelSizeX, &world.rotationY, &world.rotationX,
+                          &world.pixelSizeY, &world.originX, &world.originY);
+        fclose(file);
+        if (read != 6 || world.pixelSizeX <= 0.0 || world.pixelSizeY == 0.0)
+            return false;
+        if (world.rotationX != 0.0 || world.rotationY != 0.0) {
+            std::cerr << worldPath.string() << ": rotated world files are not supported" << std::endl;
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+// Static R-tree over rectangles (min.x, min.y, max.x, max.y), bulk loaded with Sort-Tile-Recursive: items are
+// sorted into vertical slices by center x, each slice by center y, and packed rtreeFanout to a node; the
+// nodes are grouped the same way level by level. Nodes of a level are contiguous and a node's children are
+// one contiguous range, so the tree is two flat arrays.
+class RTree {
+public:
+    void build(const std::vector<glm::dvec4>& boxes) {
+        m_nodes.clear();
+        m_items.resize(boxes.size());
+        for (size_t i = 0; i < boxes.size(); ++i)
+            m_items[i] = static_cast<int>(i);
+        m_boxes = boxes;
+        if (boxes.empty())
+            return;
+
+        // Leaves over the items
+        sortTiles(m_items, [&](int item) { return m_boxes[item]; });
+        for (size_t first = 0; first < m_items.size(); first += rtreeFanout) {
+            Node node;
+            node.first = static_cast<int>(first);
+            node.count = static_cast<int>(std::min<size_t>(rtreeFanout, m_items.size() - first));
+            node.box = m_boxes[m_items[first]];
+            for (int i = 1; i < node.count; ++i)
+                node.box = unite(node.box, m_boxes[m_items[first + i]]);
+            m_nodes.push_back(node);
+        }
+        m_leafCount = static_cast<int>(m_nodes.size());
+
+        // Upper levels until a single root remains
+        size_t levelBegin = 0;
+        while (m_nodes.size() - levelBegin > 1) {
+            size_t levelEnd = m_nodes.size();
+            std::vector<Node> level(m_nodes.begin() + levelBegin, m_nodes.end());
+            std::vector<int> order(level.size());
+            for (size_t i = 0; i < order.size(); ++i)
+                order[i] = static_cast<int>(i);
+            sortTiles(order, [&](int index) { return level[index].box; });
+            for (size_t i = 0; i < order.size(); ++i)
+                m_nodes[levelBegin + i] = level[order[i]];
+
+            for (size_t first = levelBegin; first < levelEnd; first += rtreeFanout) {
+                Node node;
+                node.first = static_cast<int>(first);
+                node.count = static_cast<int>(std::min<size_t>(rtreeFanout, levelEnd - first));
+                node.box = m_nodes[first].box;
+                for (int i = 1; i < node.count; ++i)
+                    node.box = unite(node.box, m_nodes[first + i].box);
+                m_nodes.push_back(node);
+            }
+            levelBegin = levelEnd;
+        }
+    }
+
+    // Appends the items whose box intersects rect, in item order
+    void query(const glm::dvec4& rect, std::vector<int>& result) const {
+        result.clear();
+        if (m_nodes.empty())
+            return;
+        // Depth-first; each level adds at most rtreeFanout - 1 entries, far below the stack size
+        int stack[256];
+        int depth = 0;
+        stack[depth++] = static_cast<int>(m_nodes.size()) - 1;
+        while (depth > 0) {
+            int nodeIndex = stack[--depth];
+            const Node& node = m_nodes[nodeIndex];
+            bool leaf = nodeIndex < m_leafCount;
+            for (int i = node.first; i < node.first + node.count; ++i) {
+                const glm::dvec4& box = leaf ? m_boxes[m_items[i]] : m_nodes[i].box;
+                if (!intersects(box, rect))
+                    continue;
+                if (leaf)
+                    result.push_back(m_items[i]);
+                else
+                    stack[depth++] = i;
+            }
+        }
+        std::sort(result.begin(), result.end());
+    }
+
+    size_t nodeCount() const { return m_nodes.size(); }
+
+private:
+    struct Node {
+        glm::dvec4 box;
+        int first = 0, count = 0;   // children: items m_items[first..] for a leaf, nodes m_nodes[first..] otherwise
+    };
+    std::vector<Node> m_nodes;      // leaves first, root last
+    std::vector<int> m_items;
+    std::vector<glm::dvec4> m_boxes;
+    int m_leafCount = 0;
+
+    static glm::dvec4 unite(const glm::dvec4& a, const glm::dvec4& b) {
+        return glm::dvec4(std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.z, b.z), std::max(a.w, b.w));
+    }
+
+    static bool intersects(const glm::dvec4& a, const glm::dvec4& b) {
+        return a.x < b.z && b.x < a.z && a.y < b.w && b.y < a.w;
+    }
+
+    // Orders entries for packing: ceil(sqrt(leaves)) slices by center x, each slice by center y
+    template <typename BoxOf>
+    static void sortTiles(std::vector<int>& entries, BoxOf boxOf) {
+        auto centerX = [&](int e) { glm::dvec4 b = boxOf(e); return b.x + b.z; };
+        auto centerY = [&](int e) { glm::dvec4 b = boxOf(e); return b.y + b.w; };
+        std::sort(entries.begin(), entries.end(), [&](int a, int b) { return centerX(a) < centerX(b); });
+        size_t nodes = (entries.size() + rtreeFanout - 1) / rtreeFanout;
+        size_t slices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nodes))));
+        size_t sliceSize = slices * rtreeFanout;
+        for (size_t first = 0; first < entries.size(); first += sliceSize) {
+            auto end = entries.begin() + std::min(first + sliceSize, entries.size());
+            std::sort(entries.begin() + first, end, [&](int a, int b) { return centerY(a) < centerY(b); });
+        }
+    }
+};
+
+// One image of the mosaic: where it lies (level-0 mosaic pixels) and how many mosaic pixels one of its own
+// pixels spans. Only the header has been read until a tile needs its pixels.
+struct MosaicSource {
+    std::string path;
+    int width = 0, height = 0;
+    glm::dvec4 footprint;   // x0, y0 (top-left), x1, y1
+    double scaleX = 1.0, scaleY = 1.0;
+};
+
+// Decoded pixels of a source plus its halved levels, down to one that fits in thumbnailSize
+struct DecodedSource {
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<unsigned char> pixels;
+    };
+    std::vector<Level> levels;
+
+    size_t bytes() const {
+        size_t total = 0;
+        for (const Level& level : levels)
+            total += level.pixels.size();
+        return total;
+    }
+};
+
+// Many image files presented as one tiled pyramid, VRT style. Opening reads headers only (in parallel) and
+// indexes the footprints in an R-tree; pixels are decoded when a tile overlapping the source is read:
+//   - placement: from world files when every source has one, otherwise a grid in file name order
+//   - routing: a tile queries the R-tree and reads only the sources that overlap it, later files on top
+//   - memory: decoded sources (with their reduced levels) live in an LRU under decodedBudgetBytes; the
+//     smallest level of each stays as a thumbnail after eviction, so zoomed-out tiles need no decode
+// World mapping keeps the aspect ratio: x spans [-1, 1], y spans [-h/w, h/w], row 0 at the top.
+class VirtualMosaic {
+public:
+    struct Stats {
+        std::atomic<long long> tilesRead{ 0 };
+        std::atomic<long long> sourcesRouted{ 0 };     // overlapping sources summed over all tiles read
+        std::atomic<long long> sourceDecodes{ 0 };
+        std::atomic<long long> thumbnailReads{ 0 };    // source reads served by a thumbnail
+        std::atomic<long long> evictions{ 0 };
+    };
+
+    bool open(const std::string& directory) {
+        auto start = std::chrono::steady_clock::now();
+        std::error_code error;
+        std::vector<std::string> paths;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            std::string extension = entry.path().extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+            if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg" || extension == ".jpeg" ||
+                                            extension == ".tif" || extension == ".tiff"))
+                paths.push_back(entry.path().string());
+        }
+        if (error || paths.empty()) {
+            std::cerr << "No images in " << directory << std::endl;
+            return false;
+        }
+        std::sort(paths.begin(), paths.end());
+
+        // Headers and world files, in parallel: with hundreds of files this is all open costs
+        std::vector<MosaicSource> probed(paths.size());
+        std::vector<WorldFile> worlds(paths.size());
+        std::vector<char> valid(paths.size(), 0), georeferenced(paths.size(), 0);
+        std::atomic<size_t> next{ 0 };
+        auto probeWorker = [&]() {
+            for (size_t i = next++; i < paths.size(); i = next++) {
+                probed[i].path = paths[i];
+                valid[i] = probeImage(paths[i], probed[i].width, probed[i].height);
+                georeferenced[i] = valid[i] && readWorldFile(paths[i], worlds[i]);
+            }
+        };
+        std::vector<std::thread> probers;
+        unsigned threadCount = std::max(1u, std::min(probeThreadCount, static_cast<unsigned>(paths.size())));
+        for (unsigned i = 0; i < threadCount; ++i)
+            probers.emplace_back(probeWorker);
+        for (std::thread& thread : probers)
+            thread.join();
+
+        bool allGeoreferenced = true;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            if (!valid[i]) {
+                std::cerr << "Skipping unreadable " << paths[i] << std::endl;
+                continue;
+            }
+            m_sources.push_back(probed[i]);
+            allGeoreferenced = allGeoreferenced && georeferenced[i];
+            if (georeferenced[i])
+                m_worlds.push_back(worlds[i]);
+        }
+        if (m_sources.empty())
+            return false;
+        if (allGeoreferenced)
+            placeByWorldFiles();
+        else
+            placeInGrid();
+
+        std::vector<glm::dvec4> footprints;
+        for (const MosaicSource& source : m_sources)
+            footprints.push_back(source.footprint);
+        m_index.build(footprints);
+        m_decoded.resize(m_sources.size());
+        m_thumbnails.resize(m_sources.size());
+
+        m_levelWidths.push_back(m_width);
+        m_levelHeights.push_back(m_height);
+        while (m_levelWidths.back() > tileSize || m_levelHeights.back() > tileSize) {
+            m_levelWidths.push_back((m_levelWidths.back() + 1) / 2);
+            m_levelHeights.push_back((m_levelHeights.back() + 1) / 2);
+        }
+
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        printf("Mosaic of %zu sources (%s), %d x %d pixels, levels: %d, tile size: %d, R-tree nodes: %zu\n",
+               m_sources.size(), allGeoreferenced ? "placed by world files" : "placed in a grid", m_width, m_height,
+               levelCount(), tileSize, m_index.nodeCount());
+        printf("Opened in %.1f ms, headers only\n", milliseconds);
+        return true;
+    }
+
+    int levelCount() const { return static_cast<int>(m_levelWidths.size()); }
+    int levelWidth(int level) const { return m_levelWidths[level]; }
+    int levelHeight(int level) const { return m_levelHeights[level]; }
+    int tilesX(int level) const { return (levelWidth(level) + tileSize - 1) / tileSize; }
+    int tilesY(int level) const { return (levelHeight(level) + tileSize - 1) / tileSize; }
+    int sourceCount() const { return static_cast<int>(m_sources.size()); }
+
+    bool isValid(const TileKey& key) const {
+        return key.level >= 0 && key.level < levelCount() &&
+               key.x >= 0 && key.x < tilesX(key.level) && key.y >= 0 && key.y < tilesY(key.level);
+    }
+
+    // Composes one tile from the sources overlapping it (thread-safe); empty areas stay transparent
+    void readTile(const TileKey& key, std::vector<unsigned char>& pixels, int& width, int& height) {
+        width = std::min(tileSize, levelWidth(key.level) - key.x * tileSize);
+        height = std::min(tileSize, levelHeight(key.level) - key.y * tileSize);
+        pixels.assign(static_cast<size_t>(width) * height * 4, 0);
+
+        // Tile in level-0 mosaic pixels
+        double step = static_cast<double>(1 << key.level);
+        glm::dvec4 rect(key.x * tileSize * step, key.y * tileSize * step,
+                        (key.x * tileSize + width) * step, (key.y * tileSize + height) * step);
+        std::vector<int> overlapping;
+        m_index.query(rect, overlapping);
+        ++m_stats.tilesRead;
+        m_stats.sourcesRouted += static_cast<long long>(overlapping.size());
+
+        for (int index : overlapping) {
+            const MosaicSource& source = m_sources[index];
+            // The source level whose pixels are closest to (not smaller than) this tile's pixels
+            double sourcePixelsPerTilePixel = step / std::max(source.scaleX, source.scaleY);
+            int wanted = std::max(0, static_cast<int>(std::floor(std::log2(std::max(sourcePixelsPerTilePixel, 1.0)))));
+            std::shared_ptr<const DecodedSource> decoded = acquire(index, wanted);
+            if (!decoded)
+                continue;
+            const DecodedSource::Level& level = decoded->levels[std::min(wanted, static_cast<int>(decoded->levels.size()) - 1)];
+            // Through the level's actual size: halving rounds up, and a thumbnail is a last level on its own
+            double levelScaleX = static_cast<double>(level.width) / source.width;
+            double levelScaleY = static_cast<double>(level.height) / source.height;
+
+            int x0 = std::max(0, static_cast<int>(std::floor((source.footprint.x - rect.x) / step)));
+            int x1 = std::min(width, static_cast<int>(std::ceil((source.footprint.z - rect.x) / step)));
+            int y0 = std::max(0, static_cast<int>(std::floor((source.footprint.y - rect.y) / step)));
+            int y1 = std::min(height, static_cast<int>(std::ceil((source.footprint.w - rect.y) / step)));
+            for (int y = y0; y < y1; ++y) {
+                double my = rect.y + (y + 0.5) * step;
+                int sy = static_cast<int>((my - source.footprint.y) / source.scaleY * levelScaleY);
+                if (sy < 0 || sy >= level.height)
+                    continue;
+                const unsigned char* row = level.pixels.data() + static_cast<size_t>(sy) * level.width * 4;
+                unsigned char* out = pixels.data() + static_cast<size_t>(y) * width * 4;
+                for (int x = x0; x < x1; ++x) {
+                    double mx = rect.x + (x + 0.5) * step;
+                    int sx = static_cast<int>((mx - source.footprint.x) / source.scaleX * levelScaleX);
+                    if (sx < 0 || sx >= level.width || row[sx * 4 + 3] == 0)
+                        continue;
+                    memcpy(out + x * 4, row + sx * 4, 4);
+                }
+            }
+        }
+    }
+
+    // World units per level-0 pixel
+    float worldPerPixel() const { return 2.0f / m_width; }
+
+    // World-space rectangle of a tile (min.x, min.y, max.x, max.y)
+    glm::vec4 tileRect(const TileKey& key) const {
+        int width0 = m_width, height0 = m_height;
+        int px0 = std::min(key.x * tileSize << key.level, width0);
+        int py0 = std::min(key.y * tileSize << key.level, height0);
+        int px1 = std::min((key.x + 1) * tileSize << key.level, width0);
+        int py1 = std::min((key.y + 1) * tileSize << key.level, height0);
+        float p = worldPerPixel();
+        float top = height0 * p * 0.5f;
+        return glm::vec4(px0 * p - 1.0f, top - py1 * p, px1 * p - 1.0f, top - py0 * p);
+    }
+
+    // Level whose texel density best matches the screen for this camera
+    int selectLevel(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        float texelsPerScreenPixel = 1.0f / (worldPerPixel() * screenPixelsPerWorld);
+        int level = static_cast<int>(std::floor(std::log2(std::max(texelsPerScreenPixel, 1e-6f)) + lodBias));
+        return std::max(0, std::min(level, levelCount() - 1));
+    }
+
+    // Continuous level (before flooring), used to predict level switches
+    float levelPosition(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        return std::log2(1.0f / (worldPerPixel() * screenPixelsPerWorld)) + lodBias;
+    }
+
+    // Range of tiles of a level that intersect a world rectangle; false if none
+    bool tileRange(int level, const glm::vec4& rect, int& x0, int& y0, int& x1, int& y1) const {
+        float p = worldPerPixel() * static_cast<float>(1 << level) * tileSize;  // world size of one tile
+        float top = m_height * worldPerPixel() * 0.5f;
+        x0 = std::max(0, static_cast<int>(std::floor((rect.x + 1.0f) / p)));
+        x1 = std::min(tilesX(level) - 1, static_cast<int>(std::floor((rect.z + 1.0f) / p)));
+        y0 = std::max(0, static_cast<int>(std::floor((top - rect.w) / p)));
+        y1 = std::min(tilesY(level) - 1, static_cast<int>(std::floor((top - rect.y) / p)));
+        return x0 <= x1 && y0 <= y1;
+    }
+
+    const Stats& getStats() const { return m_stats; }
+
+    // Decoded sources held right now and their size
+    size_t decodedCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_lru.size();
+    }
+    size_t decodedBytes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_decodedBytes;
+    }
+
+private:
+    std::vector<MosaicSource> m_sources;
+    std::vector<WorldFile> m_worlds;
+    RTree m_index;
+    int m_width = 0, m_height = 0;
+    std::vector<int> m_levelWidths, m_levelHeights;
+
+    // Decoded sources: m_decoded[i] while source i is in the LRU (m_lru, most recent at the front), and a
+    // future while some loader is decoding it so others wait instead of decoding it again
+    mutable std::mutex m_mutex;
+    std::vector<std::shared_future<std::shared_ptr<const DecodedSource>>> m_decoded;
+    std::vector<std::shared_ptr<const DecodedSource>> m_thumbnails;
+    std::list<int> m_lru;
+    std::unordered_map<int, std::list<int>::iterator> m_lruPositions;
+    size_t m_decodedBytes = 0;
+    Stats m_stats;
+
+    // Pixel sizes and origins from the world files; the finest pixel size becomes the mosaic's
+    void placeByWorldFiles() {
+        double pixelX = m_worlds[0].pixelSizeX, pixelY = std::fabs(m_worlds[0].pixelSizeY);
+        double left = 1e300, top = -1e300;
+        for (size_t i = 0; i < m_sources.size(); ++i) {
+            const WorldFile& world = m_worlds[i];
+            pixelX = std::min(pixelX, world.pixelSizeX);
+            pixelY = std::min(pixelY, std::fabs(world.pixelSizeY));
+            left = std::min(left, world.originX - world.pixelSizeX * 0.5);
+            top = std::max(top, world.originY + std::fabs(world.pixelSizeY) * 0.5);
+        }
+        double right = 0.0, bottom = 0.0;
+        for (size_t i = 0; i < m_sources.size(); ++i) {
+            MosaicSource& source = m_sources[i];
+            const WorldFile& world = m_worlds[i];
+            source.scaleX = world.pixelSizeX / pixelX;
+            source.scaleY = std::fabs(world.pixelSizeY) / pixelY;
+            double x0 = (world.originX - world.pixelSizeX * 0.5 - left) / pixelX;
+            double y0 = (top - (world.originY + std::fabs(world.pixelSizeY) * 0.5)) / pixelY;
+            source.footprint = glm::dvec4(x0, y0, x0 + source.width * source.scaleX, y0 + source.height * source.scaleY);
+            right = std::max(right, source.footprint.z);
+            bottom = std::max(bottom, source.footprint.w);
+        }
+        m_width = static_cast<int>(std::ceil(right - 1e-6));
+        m_height = static_cast<int>(std::ceil(bottom - 1e-6));
+    }
+
+    // Without georeferencing: a near-square grid in file name order, cells as large as the largest source
+    void placeInGrid() {
+        int cellWidth = 0, cellHeight = 0;
+        for (const MosaicSource& source : m_sources) {
+            cellWidth = std::max(cellWidth, source.width);
+            cellHeight = std::max(cellHeight, source.height);
+        }
+        int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(m_sources.size()))));
+        int rows = (static_cast<int>(m_sources.size()) + columns - 1) / columns;
+        for (size_t i = 0; i < m_sources.size(); ++i) {
+            MosaicSource& source = m_sources[i];
+            double x0 = static_cast<double>(i % columns) * cellWidth;
+            double y0 = static_cast<double>(i / columns) * cellHeight;
+            source.footprint = glm::dvec4(x0, y0, x0 + source.width, y0 + source.height);
+        }
+        m_width = columns * cellWidth;
+        m_height = rows * cellHeight;
+    }
+
+    // Pixels of a source for reading at level wanted: the thumbnail if that is fine enough, otherwise the
+    // decoded source, decoding it on a miss (one decode per source at a time) and trimming the LRU afterwards
+    std::shared_ptr<const DecodedSource> acquire(int index, int wanted) {
+        std::shared_future<std::shared_ptr<const DecodedSource>> pending;
+        std::promise<std::shared_ptr<const DecodedSource>> promise;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const std::shared_ptr<const DecodedSource>& thumbnail = m_thumbnails[index];
+            if (thumbnail && wanted >= thumbnailLevel(index)) {
+                ++m_stats.thumbnailReads;
+                return thumbnail;
+            }
+            if (m_decoded[index].valid()) {
+                pending = m_decoded[index];
+                auto position = m_lruPositions.find(index);
+                if (position != m_lruPositions.end())
+                    m_lru.splice(m_lru.begin(), m_lru, position->second);
+            } else {
+                m_decoded[index] = promise.get_future().share();
+            }
+        }
+        if (pending.valid())
+            return pending.get();
+
+        std::shared_ptr<DecodedSource> decoded = decode(m_sources[index]);
+        ++m_stats.sourceDecodes;
+        promise.set_value(decoded);
+
+        // A source that fails to decode keeps its empty result and is not tried again
+        if (!decoded)
+            return nullptr;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_thumbnails[index]) {
+            auto thumbnail = std::make_shared<DecodedSource>();
+            thumbnail->levels.push_back(decoded->levels.back());
+            m_thumbnails[index] = thumbnail;
+        }
+        // Decoded for a zoomed-out tile: from now on the thumbnail serves those, so the full levels go
+        if (wanted >= thumbnailLevel(index)) {
+            m_decoded[index] = std::shared_future<std::shared_ptr<const DecodedSource>>();
+            return decoded;
+        }
+        m_lru.push_front(index);
+        m_lruPositions[index] = m_lru.begin();
+        m_decodedBytes += decoded->bytes();
+        // Never the source just decoded: a budget smaller than one source still serves the tile
+        while (m_decodedBytes > decodedBudgetBytes && m_lru.size() > 1) {
+            int victim = m_lru.back();
+            m_lru.pop_back();
+            m_lruPositions.erase(victim);
+            m_decodedBytes -= m_decoded[victim].get()->bytes();
+            m_decoded[victim] = std::shared_future<std::shared_ptr<const DecodedSource>>();
+            ++m_stats.evictions;
+        }
+        return decoded;
+    }
+
+    // Level of a source the thumbnail corresponds to (its last level); the m_mutex holder calls this
+    int thumbnailLevel(int index) const {
+        const MosaicSource& source = m_sources[index];
+        int level = 0;
+        for (int w = source.width, h = source.height; w > thumbnailSize || h > thumbnailSize; ++level) {
+            w = (w + 1) / 2;
+            h = (h + 1) / 2;
+        }
+        return level;
+    }
+
+    static std::shared_ptr<DecodedSource> decode(const MosaicSource& source) {
+        DecodedSource::Level base;
+        if (!decodeImage(source.path, base.pixels, base.width, base.height)) {
+            std::cerr << "Failed to decode " << source.path << std::endl;
+            return nullptr;
+        }
+        if (base.width != source.width || base.height != source.height) {
+            std::cerr << source.path << " changed size since it was indexed" << std::endl;
+            return nullptr;
+        }
+        auto decoded = std::make_shared<DecodedSource>();
+        decoded->levels.push_back(std::move(base));
+        while (decoded->levels.back().width > thumbnailSize || decoded->levels.back().height > thumbnailSize)
+            decoded->levels.push_back(downsample(decoded->levels.back()));
+        return decoded;
+    }
+
+    static DecodedSource::Level downsample(const DecodedSource::Level& src) {
+        DecodedSource::Level dst;
+        dst.width = (src.width + 1) / 2;
+        dst.height = (src.height + 1) / 2;
+        dst.pixels.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+        for (int y = 0; y < dst.height; ++y) {
+            int sy0 = 2 * y, sy1 = std::min(2 * y + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x) {
+                int sx0 = 2 * x, sx1 = std::min(2 * x + 1, src.width - 1);
+                for (int c = 0; c < 4; ++c) {
+                    int sum = src.pixels[(static_cast<size_t>(sy0) * src.width + sx0) * 4 + c] +
+                              src.pixels[(static_cast<size_t>(sy0) * src.width + sx1) * 4 + c] +
+                              src.pixels[(static_cast<size_t>(sy1) * src.width + sx0) * 4 + c] +
+                              src.pixels[(static_cast<size_t>(sy1) * src.width + sx1) * 4 + c];
+                    dst.pixels[(static_cast<size_t>(y) * dst.width + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+        return dst;
+    }
+};
+
+// Writes count cut-outs of an image as PNG scenes with world files, overlapping by a few pixels, to try a
+// large mosaic without a directory of real scenes
+bool generateScenes(const std::string& imagePath, const std::string& directory, int count) {
+    std::vector<unsigned char> pixels;
+    int width, height;
+    if (!decodeImage(imagePath, pixels, width, height)) {
+        std::cerr << "Failed to load " << imagePath << std::endl;
+        return false;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    int sceneSize = 256;
+    std::vector<unsigned char> scene(static_cast<size_t>(sceneSize) * sceneSize * 4);
+    for (int i = 0; i < count; ++i) {
+        int column = i % columns, row = i / columns;
+        // Scenes step by sceneSize - 8 pixels; the source image repeats across the mosaic
+        int originX = column * (sceneSize - 8), originY = row * (sceneSize - 8);
+        for (int y = 0; y < sceneSize; ++y)
+            for (int x = 0; x < sceneSize; ++x)
+                memcpy(&scene[(static_cast<size_t>(y) * sceneSize + x) * 4],
+                       &pixels[(static_cast<size_t>((originY + y) % height) * width + (originX + x) % width) * 4], 4);
+
+        char name[64];
+        snprintf(name, sizeof(name), "scene_%05d", i);
+        std::string base = (std::filesystem::path(directory) / name).string();
+        if (!stbi_write_png((base + ".png").c_str(), sceneSize, sceneSize, 4, scene.data(), sceneSize * 4)) {
+            std::cerr << "Failed to write " << base << ".png" << std::endl;
+            return false;
+        }
+        // One world unit per pixel, y up, origin at the scene's top-left pixel center
+        FILE* world = fopen((base + ".pgw").c_str(), "w");
+        if (!world)
+            return false;
+        fprintf(world, "1.0\n0.0\n0.0\n-1.0\n%.1f\n%.1f\n", originX + 0.5, -(originY + 0.5));
+        fclose(world);
+    }
+    printf("Wrote %d scenes of %d x %d to %s\n", count, sceneSize, sceneSize, directory.c_str());
+    return true;
+}
+
+// One tile wanted by the renderer or the prefetcher; lower priority values are served first
+struct TileRequest {
+    TileKey key;
+    float priority = 0.0f;
+};
+
+struct LoadedTile {
+    TileKey key;
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;
+};
+
+// Scheduler between the renderer and the decoders.
+// - Duplicates merge: a key requested several times in a frame, or again while pending or in flight, is
+//   one piece of work that keeps the best priority it was given.
+// - Ordering: pending work is kept sorted by priority, workers always take the most urgent tile.
+// - Cancellation: every frame submits the complete set of tiles it still wants; pending requests missing
+//   from that set are dropped before any decoder picks them up.
+class TileRequestQueue {
+public:
+    struct Stats {
+        long long submitted = 0;   // requests received, duplicates included
+        long long merged = 0;      // requests folded into an existing entry
+        long long cancelled = 0;   // pending requests dropped as no longer wanted
+        long long started = 0;     // requests handed to a decoder
+    };
+
+    // Replaces the wanted set for this frame (requests may contain duplicates)
+    void submitFrame(const std::vector<TileRequest>& requests) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+
+        for (const TileRequest& request : requests) {
+            ++m_stats.submitted;
+            uint64_t id = request.key.packed();
+            auto it = m_entries.find(id);
+            if (it == m_entries.end()) {
+                Entry entry;
+                entry.key = request.key;
+                entry.priority = request.priority;
+                entry.generation = m_generation;
+                m_entries.emplace(id, entry);
+                m_order.insert(std::make_pair(request.priority, id));
+                continue;
+            }
+
+            ++m_stats.merged;
+            Entry& entry = it->second;
+            if (entry.state == State::InFlight)
+                continue;
+            // First sighting this frame takes the new priority; later duplicates only improve it
+            float priority = entry.generation == m_generation ? std::min(entry.priority, request.priority) : request.priority;
+            if (priority != entry.priority) {
+                m_order.erase(std::make_pair(entry.priority, id));
+                entry.priority = priority;
+                m_order.insert(std::make_pair(priority, id));
+            }
+            entry.generation = m_generation;
+        }
+
+        // Everything still pending but not asked for this frame is no longer visible or predicted
+        for (auto it = m_order.begin(); it != m_order.end();) {
+            Entry& entry = m_entries[it->second];
+            if (entry.generation != m_generation) {
+                m_entries.erase(it->second);
+                it = m_order.erase(it);
+                ++m_stats.cancelled;
+            }
+            else {
+                ++it;
+            }
+        }
+
+        m_wakeup.notify_all();
+    }
+
+    // Blocks until there is work; returns false on shutdown
+    bool pop(TileKey& key) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeup.wait(lock, [this] { return m_shutdown || !m_order.empty(); });
+        if (m_shutdown)
+            return false;
+        uint64_t id = m_order.begin()->second;
+        m_order.erase(m_order.begin());
+        Entry& entry = m_entries[id];
+        entry.state = State::InFlight;
+        key = entry.key;
+        ++m_stats.started;
+        return true;
+    }
+
+    // The tile reached the cache; later requests for it are the cache's business
+    void delivered(const TileKey& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.erase(key.packed());
+    }
+
+    void shutdown() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+        m_wakeup.notify_all();
+    }
+
+    size_t pendingCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_order.size();
+    }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    enum class State { Pending, InFlight };
+    struct Entry {
+        TileKey key;
+        State state = State::Pending;
+        float priority = 0.0f;
+        uint64_t generation = 0;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::unordered_map<uint64_t, Entry> m_entries;    // pending and in-flight
+    std::set<std::pair<float, uint64_t>> m_order;     // pending only, most urgent first
+    uint64_t m_generation = 0;
+    bool m_shutdown = false;
+    Stats m_stats;
+};
+
+// Decoder threads pulling from the request queue; each composes its tile from the overlapping sources
+class TileLoaderPool {
+public:
+    void start(VirtualMosaic* mosaic, TileRequestQueue* queue) {
+        m_mosaic = mosaic;
+        m_queue = queue;
+        for (int i = 0; i < loaderThreadCount; ++i)
+            m_threads.emplace_back(&TileLoaderPool::workerThread, this);
+    }
+
+    std::vector<LoadedTile> takeCompleted(int maxCount) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<LoadedTile> result;
+        while (!m_completed.empty() && static_cast<int>(result.size()) < maxCount) {
+            result.push_back(std::move(m_completed.front()));
+            m_completed.pop_front();
+        }
+        return result;
+    }
+
+    void stop() {
+        m_queue->shutdown();
+        for (std::thread& thread : m_threads)
+            thread.join();
+        m_threads.clear();
+    }
+
+private:
+    VirtualMosaic* m_mosaic = nullptr;
+    TileRequestQueue* m_queue = nullptr;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::deque<LoadedTile> m_completed;
+
+    void workerThread() {
+        TileKey key;
+        while (m_queue->pop(key)) {
+            LoadedTile tile;
+            tile.key = key;
+            m_mosaic->readTile(key, tile.pixels, tile.width, tile.height);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed.push_back(std::move(tile));
+        }
+    }
+};
+
+// GPU-resident tiles, evicted least-recently-used once over budget
+class TileCache {
+public:
+    struct Entry {
+        GLuint texture = 0;
+        int width = 0, height = 0;
+        int lastUsedFrame = 0;
+        bool drawn = false;
+    };
+
+    void upload(const LoadedTile& tile, int frame) {
+        Entry entry;
+        entry.width = tile.width;
+        entry.height = tile.height;
+        entry.lastUsedFrame = frame;
+
+        glGenTextures(1, &entry.texture);
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tile.width, tile.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, tile.pixels.data());
+
+        m_entries[tile.key.packed()] = entry;
+        ++m_uploads;
+    }
+
+    Entry* find(const TileKey& key) {
+        auto it = m_entries.find(key.packed());
+        return it == m_entries.end() ? nullptr : &it->second;
+    }
+
+    bool contains(const TileKey& key) const { return m_entries.count(key.packed()) != 0; }
+
+    void evict(int currentFrame) {
+        if (m_entries.size() <= gpuTileBudget)
+            return;
+        std::vector<std::pair<int, uint64_t>> candidates;
+        for (const auto& item : m_entries)
+            if (item.second.lastUsedFrame < currentFrame)
+                candidates.emplace_back(item.second.lastUsedFrame, item.first);
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& candidate : candidates) {
+            if (m_entries.size() <= gpuTileBudget)
+                break;
+            Entry& victim = m_entries[candidate.second];
+            if (!victim.drawn)
+                ++m_unusedEvictions;
+            glDeleteTextures(1, &victim.texture);
+            m_entries.erase(candidate.second);
+        }
+    }
+
+    size_t size() const { return m_entries.size(); }
+    int getUploads() const { return m_uploads; }
+    int getUnusedEvictions() const { return m_unusedEvictions; }
+
+    void destroy() {
+        for (auto& item : m_entries)
+            glDeleteTextures(1, &item.second.texture);
+        m_entries.clear();
+    }
+
+private:
+    std::unordered_map<uint64_t, Entry> m_entries;
+    int m_uploads = 0;
+    int m_unusedEvictions = 0;   // decoded and uploaded, but evicted before ever being drawn
+};
+
+// Emits requests for the visible tiles and for the predicted camera path (duplicates are left to the queue).
+// priority = predicted seconds until visible + levelWeight * levels away from the current level
+//          + distanceWeight * distance from the view center (in half view extents)
+class Prefetcher {
+public:
+    bool enabled = true;
+
+    void collect(const Camera& camera, const VirtualMosaic& pyramid, const TileCache& cache,
+                 int framebufferWidth, int framebufferHeight, std::vector<TileRequest>& requests) {
+        requests.clear();
+        int currentLevel = pyramid.selectLevel(camera, framebufferWidth, framebufferHeight);
+
+        float horizon = enabled ? predictionHorizon : 0.0f;
+        for (float t = 0.0f; t <= horizon + 1e-4f; t += predictionStep) {
+            Camera future = camera.predicted(t);
+            int level = pyramid.selectLevel(future, framebufferWidth, framebufferHeight);
+            addRect(pyramid, cache, future, level, currentLevel, t, requests);
+        }
+
+        float zoomRate = camera.getZoomRate();
+        if (enabled && std::fabs(zoomRate) > zoomRateThreshold) {
+            float position = pyramid.levelPosition(camera, framebufferWidth, framebufferHeight);
+            float levelsPerSecond = zoomRate / std::log(2.0f);
+            int nextLevel = zoomRate > 0.0f ? currentLevel - 1 : currentLevel + 1;
+            float distanceToSwitch = zoomRate > 0.0f ? position - std::floor(position) : std::ceil(position) - position;
+            float timeToSwitch = distanceToSwitch / std::fabs(levelsPerSecond);
+            if (nextLevel >= 0 && nextLevel < pyramid.levelCount())
+                addRect(pyramid, cache, camera, nextLevel, currentLevel, timeToSwitch, requests);
+        }
+    }
+
+private:
+    void addRect(const VirtualMosaic& pyramid, const TileCache& cache, const Camera& view, int level, int currentLevel,
+                 float t, std::vector<TileRequest>& requests) {
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, view.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glm::vec2 center = view.getCenter();
+        float halfExtent = 1.0f / view.getScale();
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                if (cache.contains(key))
+                    continue;
+
+                glm::vec4 r = pyramid.tileRect(key);
+                glm::vec2 tileCenter((r.x + r.z) * 0.5f, (r.y + r.w) * 0.5f);
+                TileRequest request;
+                request.key = key;
+                request.priority = t + levelWeight * std::abs(level - currentLevel) +
+                                   distanceWeight * glm::length(tileCenter - center) / halfExtent;
+                requests.push_back(request);
+            }
+        }
+    }
+};
+
+// Draws each visible tile from its own texture, or the matching part of the nearest resident ancestor
+class TileRenderer {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 tileRect;  // world x0, y0, x1, y1
+uniform vec4 uvRect;    // u0, v0 (top-left), u1, v1 (bottom-right)
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(tileRect.xw, tileRect.zy, corner), 0.0, 1.0);
+    texCoord = mix(uvRect.xy, uvRect.zw, corner);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO;
+    GLint tileRectLoc, uvRectLoc;
+    int holes = 0;
+
+    void init(Camera* camera) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        tileRectLoc = glGetUniformLocation(shaderProgram, "tileRect");
+        uvRectLoc = glGetUniformLocation(shaderProgram, "uvRect");
+        // Corners come from gl_VertexID; the VAO only has to exist
+        glGenVertexArrays(1, &VAO);
+    }
+
+    void render(const Camera& camera, const VirtualMosaic& pyramid, TileCache& cache, int level, int frame) {
+        holes = 0;
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, camera.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                glm::vec4 rect = pyramid.tileRect(key);
+
+                // Walk up until a resident ancestor covers this tile
+                TileKey source = key;
+                TileCache::Entry* entry = cache.find(source);
+                if (!entry)
+                    ++holes;
+                while (!entry && source.level + 1 < pyramid.levelCount()) {
+                    source = source.parent();
+                    entry = cache.find(source);
+                }
+                if (!entry)
+                    continue;
+                entry->lastUsedFrame = frame;
+                entry->drawn = true;
+
+                // Part of the source tile covered by this tile, in the source's texel space
+                glm::vec4 sourceRect = pyramid.tileRect(source);
+                float u0 = (rect.x - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float u1 = (rect.z - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float v0 = (sourceRect.w - rect.w) / (sourceRect.w - sourceRect.y);
+                float v1 = (sourceRect.w - rect.y) / (sourceRect.w - sourceRect.y);
+
+                glBindTexture(GL_TEXTURE_2D, entry->texture);
+                glUniform4f(tileRectLoc, rect.x, rect.y, rect.z, rect.w);
+                glUniform4f(uvRectLoc, u0, v0, u1, v1);
+                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            }
+        }
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+    }
+};
+
+int main(int argc, char** argv) {
+    std::string directory;
+    int generateCount = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--generate" && i + 1 < argc)
+            generateCount = std::atoi(argv[++i]);
+        else
+            directory = arg;
+    }
+    if (directory.empty())
+        directory = generateCount > 0 ? (std::filesystem::temp_directory_path() / "iorp_mosaic_scenes").string() : "src/textures/assets";
+    if (generateCount > 0 && !generateScenes("src/textures/assets/test_nb.png", directory, generateCount))
+        return -1;
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    VirtualMosaic pyramid;
+    if (!pyramid.open(directory)) {
+        glfwTerminate();
+        return -1;
+    }
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    TileRequestQueue queue;
+    TileLoaderPool loaders;
+    loaders.start(&pyramid, &queue);
+    TileCache cache;
+    Prefetcher prefetcher;
+    TileRenderer renderer;
+    renderer.init(&camera);
+
+    std::vector<TileRequest> requests;
+    bool prefetchKeyDown = false;
+    bool sweepKeyDown = false;
+    int sweepFramesLeft = 0;
+    float sweepFactor = 1.0f;
+    int frame = 0;
+    double lastTitleTime = glfwGetTime();
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool prefetchKeyPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+        if (prefetchKeyPressed && !prefetchKeyDown)
+            prefetcher.enabled = !prefetcher.enabled;
+        prefetchKeyDown = prefetchKeyPressed;
+
+        // Z: zoom in through zoomSweepLevels levels in zoomSweepFrames frames
+        bool sweepKeyPressed = glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS;
+        if (sweepKeyPressed && !sweepKeyDown && sweepFramesLeft == 0) {
+            int levels = std::min(zoomSweepLevels, pyramid.selectLevel(camera, width, height));
+            sweepFactor = std::pow(2.0f, static_cast<float>(levels) / zoomSweepFrames);
+            sweepFramesLeft = zoomSweepFrames;
+        }
+        sweepKeyDown = sweepKeyPressed;
+        if (sweepFramesLeft > 0) {
+            camera.zoomBy(sweepFactor);
+            --sweepFramesLeft;
+        }
+
+        camera.updateMotion(glfwGetTime());
+
+        // The whole wanted set goes to the queue every frame; whatever it no longer contains is cancelled
+        prefetcher.collect(camera, pyramid, cache, width, height, requests);
+        queue.submitFrame(requests);
+
+        for (const LoadedTile& tile : loaders.takeCompleted(maxUploadsPerFrame)) {
+            cache.upload(tile, frame);
+            queue.delivered(tile.key);
+        }
+
+        int level = pyramid.selectLevel(camera, width, height);
+        camera.publish(width, height);
+        renderer.render(camera, pyramid, cache, level, frame);
+        cache.evict(frame);
+
+        double now = glfwGetTime();
+        if (now - lastTitleTime > 0.5) {
+            const VirtualMosaic::Stats& mosaicStats = pyramid.getStats();
+            long long tilesRead = mosaicStats.tilesRead;
+            char title[256];
+            snprintf(title, sizeof(title), "OpenGL - level %d | %d sources, %zu decoded (%.0f MB), %lld decodes, %.1f sources per tile | pending %zu, holes %d",
+                     level, pyramid.sourceCount(), pyramid.decodedCount(), pyramid.decodedBytes() / 1048576.0,
+                     mosaicStats.sourceDecodes.load(), tilesRead > 0 ? static_cast<double>(mosaicStats.sourcesRouted) / tilesRead : 0.0,
+                     queue.pendingCount(), renderer.holes);
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    TileRequestQueue::Stats stats = queue.getStats();
+    printf("Requests submitted: %lld, merged: %lld, cancelled: %lld, decoded: %lld\n",
+           stats.submitted, stats.merged, stats.cancelled, stats.started);
+    printf("Tile uploads: %d, evicted without being drawn: %d\n", cache.getUploads(), cache.getUnusedEvictions());
+    const VirtualMosaic::Stats& mosaicStats = pyramid.getStats();
+    printf("Mosaic: %lld tiles read from %lld overlapping sources, %lld source decodes, %lld thumbnail reads, %lld evictions\n",
+           mosaicStats.tilesRead.load(), mosaicStats.sourcesRouted.load(), mosaicStats.sourceDecodes.load(),
+           mosaicStats.thumbnailReads.load(), mosaicStats.evictions.load());
+
+    loaders.stop();
+    renderer.destroy();
+    cache.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,1123 @@
+// several views of one tiled pyramid in one window, fed by one tile cache and one loader pool
+// A View is a viewport of the window with its own Camera. Each camera keeps square pixels (x spans the
+// viewport's aspect ratio) and picks its own level from its own viewport size, so a small overview and a
+// large detail view over the same image draw different levels at the same time. Per frame:
+//   - every view collects the tiles it wants (visible plus predicted), and the lists go to the request queue
+//     as one wanted set, so a tile wanted by two views is one request, decoded once
+//   - completed tiles are uploaded once into the shared GPU cache, and every view draws from the same texture;
+//     a tile drawn by any view this frame is safe from eviction
+//   - each view is drawn into its viewport (scissored), and shows the frames of the views zoomed in further
+// Two layouts: side by side (two equal views) and overview+detail (an inset overview over a full-window
+// detail view). The title shows the tiles wanted by several views and the textures drawn in several views.
+// Usage: tile_multi_view [image]
+// Keys: WASD pan, Q/E zoom (active view), Tab next view, V side by side / overview+detail, R reset view, P prefetch.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+const int tileSize = 128;
+
+// Level of Detail (LOD) bias, typically in the range -0.5 to 0.5
+float lodBias = 0.0f;
+
+// Loader configuration: worker count and an artificial per-tile cost standing in for a slow decoder/disk
+const int loaderThreadCount = 2;
+const int simulatedDecodeMs = 15;
+
+// GPU tile cache budget (tiles, shared by all views) and upload throttle (tiles per frame)
+const size_t gpuTileBudget = 320;
+const int maxUploadsPerFrame = 8;
+
+// Prediction: how far ahead the camera path is extrapolated, and the sampling step along it (seconds)
+const float predictionHorizon = 0.6f;
+const float predictionStep = 0.1f;
+// Time constant of the velocity smoothing (seconds)
+const float velocitySmoothing = 0.15f;
+// Zoom rates below this (ln(scale) per second) are treated as "not zooming"
+const float zoomRateThreshold = 0.05f;
+
+// Priority weights: seconds-equivalent cost of one level away from the current LOD / of one half view extent
+const float levelWeight = 0.5f;
+const float distanceWeight = 0.1f;
+
+// Overview+detail: inset size (share of the shorter framebuffer side) and its distance from the corner (pixels)
+const float overviewShare = 0.3f;
+const int overviewMargin = 12;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+// Identifies one tile of the pyramid
+struct TileKey {
+    int level = 0, x = 0, y = 0;
+
+    uint64_t packed() const {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+    }
+    TileKey parent() const {
+        TileKey p;
+        p.level = level + 1;
+        p.x = x / 2;
+        p.y = y / 2;
+        return p;
+    }
+};
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f), velocity(0.0f, 0.0f), zoomRate(0.0f), viewport(0, 0, 1, 1) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    // Back to the whole image, at rest
+    void reset() {
+        scale = 1.0f;
+        offset = glm::vec2(0.0f);
+        velocity = glm::vec2(0.0f);
+        zoomRate = 0.0f;
+        lastTime = -1.0;
+    }
+
+    // Measures how fast offset and scale changed since the last call, smoothed exponentially
+    void updateMotion(double now) {
+        if (lastTime < 0.0) {
+            lastTime = now;
+            lastOffset = offset;
+            lastScale = scale;
+            return;
+        }
+        float dt = static_cast<float>(now - lastTime);
+        if (dt <= 0.0f)
+            return;
+
+        glm::vec2 instantVelocity = (offset - lastOffset) / dt;
+        float instantZoomRate = std::log(scale / lastScale) / dt;
+        float alpha = 1.0f - std::exp(-dt / velocitySmoothing);
+        velocity += (instantVelocity - velocity) * alpha;
+        zoomRate += (instantZoomRate - zoomRate) * alpha;
+
+        lastTime = now;
+        lastOffset = offset;
+        lastScale = scale;
+    }
+
+    // Camera extrapolated t seconds ahead along the current pan/zoom motion
+    Camera predicted(float t) const {
+        Camera c = *this;
+        c.offset = offset + velocity * t;
+        c.scale = scale * std::exp(zoomRate * t);
+        return c;
+    }
+
+    // Framebuffer rectangle this camera draws into (x, y from the bottom left, width, height in pixels)
+    void setViewport(int x, int y, int width, int height) {
+        viewport = glm::ivec4(x, y, std::max(width, 1), std::max(height, 1));
+    }
+
+    glm::ivec4 getViewport() const { return viewport; }
+    float getAspect() const { return static_cast<float>(viewport.z) / static_cast<float>(viewport.w); }
+
+    // y spans [-1, 1] / scale and x as much more as the viewport is wider, so pixels stay square in any viewport
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale / getAspect(), scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the viewport (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        float halfWidth = getAspect() / scale, halfHeight = 1.0f / scale;
+        return glm::vec4(-halfWidth - offset.x, -halfHeight - offset.y, halfWidth - offset.x, halfHeight - offset.y);
+    }
+
+    glm::vec2 getCenter() const { return -offset; }
+    float getScale() const { return scale; }
+    float getZoomRate() const { return zoomRate; }
+    glm::vec2 getVelocity() const { return velocity; }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    // Every camera has its own buffer on the shared binding point; the one published last is what shaders see
+    void publish() {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(viewport);
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    glm::vec2 velocity;   // world units per second (of offset)
+    float zoomRate;       // d ln(scale) / dt
+    double lastTime = -1.0;
+    glm::vec2 lastOffset;
+    float lastScale = 1.0f;
+    glm::ivec4 viewport;
+    GLuint ubo = 0;
+};
+
+// Full-resolution image plus its reduced levels, cut into tiles on demand.
+// World mapping keeps the aspect ratio: x spans [-1, 1], y spans [-h/w, h/w], row 0 at the top.
+class TilePyramid {
+public:
+    bool load(const std::string& imagePath) {
+        int width, height, nrChannels;
+        unsigned char* data = stbi_load(imagePath.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha);
+        if (!data) {
+            std::cerr << "Failed to load texture" << std::endl;
+            return false;
+        }
+
+        Level base;
+        base.width = width;
+        base.height = height;
+        base.pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(data);
+        m_levels.push_back(std::move(base));
+
+        // Halve until the whole level fits in one tile
+        while (m_levels.back().width > tileSize || m_levels.back().height > tileSize)
+            m_levels.push_back(downsample(m_levels.back()));
+
+        printf("Image size: %d x %d, levels: %d, tile size: %d\n", width, height, levelCount(), tileSize);
+        for (int level = 0; level < levelCount(); ++level)
+            printf("  level %d: %d x %d, %d x %d tiles\n", level, levelWidth(level), levelHeight(level), tilesX(level), tilesY(level));
+        return true;
+    }
+
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    int levelWidth(int level) const { return m_levels[level].width; }
+    int levelHeight(int level) const { return m_levels[level].height; }
+    int tilesX(int level) const { return (levelWidth(level) + tileSize - 1) / tileSize; }
+    int tilesY(int level) const { return (levelHeight(level) + tileSize - 1) / tileSize; }
+
+    bool isValid(const TileKey& key) const {
+        return key.level >= 0 && key.level < levelCount() &&
+               key.x >= 0 && key.x < tilesX(key.level) && key.y >= 0 && key.y < tilesY(key.level);
+    }
+
+    // Copies one tile out of its level; stands in for a real tile decoder (thread-safe, read-only)
+    void readTile(const TileKey& key, std::vector<unsigned char>& pixels, int& width, int& height) const {
+        const Level& level = m_levels[key.level];
+        width = std::min(tileSize, level.width - key.x * tileSize);
+        height = std::min(tileSize, level.height - key.y * tileSize);
+        pixels.resize(static_cast<size_t>(width) * height * 4);
+        for (int row = 0; row < height; ++row) {
+            const unsigned char* src = level.pixels.data() +
+                ((static_cast<size_t>(key.y) * tileSize + row) * level.width + static_cast<size_t>(key.x) * tileSize) * 4;
+            memcpy(pixels.data() + static_cast<size_t>(row) * width * 4, src, static_cast<size_t>(width) * 4);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(simulatedDecodeMs));
+    }
+
+    // World units per level-0 pixel
+    float worldPerPixel() const { return 2.0f / m_levels[0].width; }
+
+    // World-space rectangle of a tile (min.x, min.y, max.x, max.y)
+    glm::vec4 tileRect(const TileKey& key) const {
+        int width0 = m_levels[0].width, height0 = m_levels[0].height;
+        int px0 = std::min(key.x * tileSize << key.level, width0);
+        int py0 = std::min(key.y * tileSize << key.level, height0);
+        int px1 = std::min((key.x + 1) * tileSize << key.level, width0);
+        int py1 = std::min((key.y + 1) * tileSize << key.level, height0);
+        float p = worldPerPixel();
+        float top = height0 * p * 0.5f;
+        return glm::vec4(px0 * p - 1.0f, top - py1 * p, px1 * p - 1.0f, top - py0 * p);
+    }
+
+    // Level whose texel density best matches the camera's viewport. Pixels are square, so the density is the
+    // same along both axes and the viewport height alone decides it.
+    int selectLevel(const Camera& camera) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * camera.getViewport().w;
+        float texelsPerScreenPixel = 1.0f / (worldPerPixel() * screenPixelsPerWorld);
+        int level = static_cast<int>(std::floor(std::log2(std::max(texelsPerScreenPixel, 1e-6f)) + lodBias));
+        return std::max(0, std::min(level, levelCount() - 1));
+    }
+
+    // Continuous level (before flooring), used to predict level switches
+    float levelPosition(const Camera& camera) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * camera.getViewport().w;
+        return std::log2(1.0f / (worldPerPixel() * screenPixelsPerWorld)) + lodBias;
+    }
+
+    // Range of tiles of a level that intersect a world rectangle; false if none
+    bool tileRange(int level, const glm::vec4& rect, int& x0, int& y0, int& x1, int& y1) const {
+        float p = worldPerPixel() * static_cast<float>(1 << level) * tileSize;  // world size of one tile
+        float top = m_levels[0].height * worldPerPixel() * 0.5f;
+        x0 = std::max(0, static_cast<int>(std::floor((rect.x + 1.0f) / p)));
+        x1 = std::min(tilesX(level) - 1, static_cast<int>(std::floor((rect.z + 1.0f) / p)));
+        y0 = std::max(0, static_cast<int>(std::floor((top - rect.w) / p)));
+        y1 = std::min(tilesY(level) - 1, static_cast<int>(std::floor((top - rect.y) / p)));
+        return x0 <= x1 && y0 <= y1;
+    }
+
+private:
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<unsigned char> pixels;
+    };
+    std::vector<Level> m_levels;
+
+    static Level downsample(const Level& src) {
+        Level dst;
+        dst.width = (src.width + 1) / 2;
+        dst.height = (src.height + 1) / 2;
+        dst.pixels.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+        for (int y = 0; y < dst.height; ++y) {
+            int sy0 = 2 * y, sy1 = std::min(2 * y + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x) {
+                int sx0 = 2 * x, sx1 = std::min(2 * x + 1, src.width - 1);
+                for (int c = 0; c < 4; ++c) {
+                    int sum = src.pixels[(static_cast<size_t>(sy0) * src.width + sx0) * 4 + c] +
+                              src.pixels[(static_cast<size_t>(sy0) * src.width + sx1) * 4 + c] +
+                              src.pixels[(static_cast<size_t>(sy1) * src.width + sx0) * 4 + c] +
+                              src.pixels[(static_cast<size_t>(sy1) * src.width + sx1) * 4 + c];
+                    dst.pixels[(static_cast<size_t>(y) * dst.width + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+        return dst;
+    }
+};
+
+// One tile wanted by the renderer or the prefetcher; lower priority values are served first
+struct TileRequest {
+    TileKey key;
+    float priority = 0.0f;
+};
+
+struct LoadedTile {
+    TileKey key;
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;
+};
+
+// Scheduler between the renderer and the decoders.
+// - Duplicates merge: a key requested several times in a frame, or again while pending or in flight, is
+//   one piece of work that keeps the best priority it was given.
+// - Ordering: pending work is kept sorted by priority, workers always take the most urgent tile.
+// - Cancellation: every frame submits the complete set of tiles it still wants; pending requests missing
+//   from that set are dropped before any decoder picks them up.
+class TileRequestQueue {
+public:
+    struct Stats {
+        long long submitted = 0;   // requests received, duplicates included
+        long long merged = 0;      // requests folded into an existing entry
+        long long cancelled = 0;   // pending requests dropped as no longer wanted
+        long long started = 0;     // requests handed to a decoder
+    };
+
+    // Replaces the wanted set for this frame (requests may contain duplicates)
+    void submitFrame(const std::vector<TileRequest>& requests) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+
+        for (const TileRequest& request : requests) {
+            ++m_stats.submitted;
+            uint64_t id = request.key.packed();
+            auto it = m_entries.find(id);
+            if (it == m_entries.end()) {
+                Entry entry;
+                entry.key = request.key;
+                entry.priority = request.priority;
+                entry.generation = m_generation;
+                m_entries.emplace(id, entry);
+                m_order.insert(std::make_pair(request.priority, id));
+                continue;
+            }
+
+            ++m_stats.merged;
+            Entry& entry = it->second;
+            if (entry.state == State::InFlight)
+                continue;
+            // First sighting this frame takes the new priority; later duplicates only improve it
+            float priority = entry.generation == m_generation ? std::min(entry.priority, request.priority) : request.priority;
+            if (priority != entry.priority) {
+                m_order.erase(std::make_pair(entry.priority, id));
+                entry.priority = priority;
+                m_order.insert(std::make_pair(priority, id));
+            }
+            entry.generation = m_generation;
+        }
+
+        // Everything still pending but not asked for this frame is no longer visible or predicted
+        for (auto it = m_order.begin(); it != m_order.end();) {
+            Entry& entry = m_entries[it->second];
+            if (entry.generation != m_generation) {
+                m_entries.erase(it->second);
+                it = m_order.erase(it);
+                ++m_stats.cancelled;
+            }
+            else {
+                ++it;
+            }
+        }
+
+        m_wakeup.notify_all();
+    }
+
+    // Blocks until there is work; returns false on shutdown
+    bool pop(TileKey& key) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeup.wait(lock, [this] { return m_shutdown || !m_order.empty(); });
+        if (m_shutdown)
+            return false;
+        uint64_t id = m_order.begin()->second;
+        m_order.erase(m_order.begin());
+        Entry& entry = m_entries[id];
+        entry.state = State::InFlight;
+        key = entry.key;
+        ++m_stats.started;
+        return true;
+    }
+
+    // The tile reached the cache; later requests for it are the cache's business
+    void delivered(const TileKey& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.erase(key.packed());
+    }
+
+    void shutdown() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+        m_wakeup.notify_all();
+    }
+
+    size_t pendingCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_order.size();
+    }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    enum class State { Pending, InFlight };
+    struct Entry {
+        TileKey key;
+        State state = State::Pending;
+        float priority = 0.0f;
+        uint64_t generation = 0;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::unordered_map<uint64_t, Entry> m_entries;    // pending and in-flight
+    std::set<std::pair<float, uint64_t>> m_order;     // pending only, most urgent first
+    uint64_t m_generation = 0;
+    bool m_shutdown = false;
+    Stats m_stats;
+};
+
+// Decoder threads pulling from the request queue
+class TileLoaderPool {
+public:
+    void start(const TilePyramid* pyramid, TileRequestQueue* queue) {
+        m_pyramid = pyramid;
+        m_queue = queue;
+        for (int i = 0; i < loaderThreadCount; ++i)
+            m_threads.emplace_back(&TileLoaderPool::workerThread, this);
+    }
+
+    std::vector<LoadedTile> takeCompleted(int maxCount) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<LoadedTile> result;
+        while (!m_completed.empty() && static_cast<int>(result.size()) < maxCount) {
+            result.push_back(std::move(m_completed.front()));
+            m_completed.pop_front();
+        }
+        return result;
+    }
+
+    void stop() {
+        m_queue->shutdown();
+        for (std::thread& thread : m_threads)
+            thread.join();
+        m_threads.clear();
+    }
+
+private:
+    const TilePyramid* m_pyramid = nullptr;
+    TileRequestQueue* m_queue = nullptr;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::deque<LoadedTile> m_completed;
+
+    void workerThread() {
+        TileKey key;
+        while (m_queue->pop(key)) {
+            LoadedTile tile;
+            tile.key = key;
+            m_pyramid->readTile(key, tile.pixels, tile.width, tile.height);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed.push_back(std::move(tile));
+        }
+    }
+};
+
+// GPU-resident tiles shared by all views, evicted least-recently-used once over budget
+class TileCache {
+public:
+    struct Entry {
+        GLuint texture = 0;
+        int width = 0, height = 0;
+        int lastUsedFrame = 0;
+        bool drawn = false;
+        uint32_t viewMask = 0;   // views that drew this tile in lastUsedFrame, one bit each
+
+        void touch(int frame, uint32_t viewBit) {
+            if (lastUsedFrame != frame)
+                viewMask = 0;
+            lastUsedFrame = frame;
+            viewMask |= viewBit;
+            drawn = true;
+        }
+    };
+
+    void upload(const LoadedTile& tile, int frame) {
+        Entry entry;
+        entry.width = tile.width;
+        entry.height = tile.height;
+        entry.lastUsedFrame = frame;
+
+        glGenTextures(1, &entry.texture);
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tile.width, tile.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, tile.pixels.data());
+
+        m_entries[tile.key.packed()] = entry;
+        ++m_uploads;
+    }
+
+    Entry* find(const TileKey& key) {
+        auto it = m_entries.find(key.packed());
+        return it == m_entries.end() ? nullptr : &it->second;
+    }
+
+    bool contains(const TileKey& key) const { return m_entries.count(key.packed()) != 0; }
+
+    // Only tiles no view drew this frame are candidates
+    void evict(int currentFrame) {
+        if (m_entries.size() <= gpuTileBudget)
+            return;
+        std::vector<std::pair<int, uint64_t>> candidates;
+        for (const auto& item : m_entries)
+            if (item.second.lastUsedFrame < currentFrame)
+                candidates.emplace_back(item.second.lastUsedFrame, item.first);
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& candidate : candidates) {
+            if (m_entries.size() <= gpuTileBudget)
+                break;
+            Entry& victim = m_entries[candidate.second];
+            if (!victim.drawn)
+                ++m_unusedEvictions;
+            glDeleteTextures(1, &victim.texture);
+            m_entries.erase(candidate.second);
+        }
+    }
+
+    // Textures drawn by more than one view this frame
+    int sharedCount(int frame) const {
+        int count = 0;
+        for (const auto& item : m_entries)
+            if (item.second.lastUsedFrame == frame && (item.second.viewMask & (item.second.viewMask - 1)) != 0)
+                ++count;
+        return count;
+    }
+
+    size_t size() const { return m_entries.size(); }
+    int getUploads() const { return m_uploads; }
+    int getUnusedEvictions() const { return m_unusedEvictions; }
+
+    void destroy() {
+        for (auto& item : m_entries)
+            glDeleteTextures(1, &item.second.texture);
+        m_entries.clear();
+    }
+
+private:
+    std::unordered_map<uint64_t, Entry> m_entries;
+    int m_uploads = 0;
+    int m_unusedEvictions = 0;   // decoded and uploaded, but evicted before ever being drawn
+};
+
+// Emits requests for one camera's visible tiles and for its predicted path (duplicates are left to the queue).
+// priority = predicted seconds until visible + levelWeight * levels away from the current level
+//          + distanceWeight * distance from the view center (in half view extents)
+class Prefetcher {
+public:
+    bool enabled = true;
+
+    void collect(const Camera& camera, const TilePyramid& pyramid, const TileCache& cache, std::vector<TileRequest>& requests) {
+        requests.clear();
+        int currentLevel = pyramid.selectLevel(camera);
+
+        float horizon = enabled ? predictionHorizon : 0.0f;
+        for (float t = 0.0f; t <= horizon + 1e-4f; t += predictionStep) {
+            Camera future = camera.predicted(t);
+            int level = pyramid.selectLevel(future);
+            addRect(pyramid, cache, future, level, currentLevel, t, requests);
+        }
+
+        float zoomRate = camera.getZoomRate();
+        if (enabled && std::fabs(zoomRate) > zoomRateThreshold) {
+            float position = pyramid.levelPosition(camera);
+            float levelsPerSecond = zoomRate / std::log(2.0f);
+            int nextLevel = zoomRate > 0.0f ? currentLevel - 1 : currentLevel + 1;
+            float distanceToSwitch = zoomRate > 0.0f ? position - std::floor(position) : std::ceil(position) - position;
+            float timeToSwitch = distanceToSwitch / std::fabs(levelsPerSecond);
+            if (nextLevel >= 0 && nextLevel < pyramid.levelCount())
+                addRect(pyramid, cache, camera, nextLevel, currentLevel, timeToSwitch, requests);
+        }
+    }
+
+private:
+    void addRect(const TilePyramid& pyramid, const TileCache& cache, const Camera& view, int level, int currentLevel,
+                 float t, std::vector<TileRequest>& requests) {
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, view.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glm::vec2 center = view.getCenter();
+        float halfExtent = 1.0f / view.getScale();
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                if (cache.contains(key))
+                    continue;
+
+                glm::vec4 r = pyramid.tileRect(key);
+                glm::vec2 tileCenter((r.x + r.z) * 0.5f, (r.y + r.w) * 0.5f);
+                TileRequest request;
+                request.key = key;
+                request.priority = t + levelWeight * std::abs(level - currentLevel) +
+                                   distanceWeight * glm::length(tileCenter - center) / halfExtent;
+                requests.push_back(request);
+            }
+        }
+    }
+};
+
+// Draws each visible tile from its own texture, or the matching part of the nearest resident ancestor
+class TileRenderer {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 tileRect;  // world x0, y0, x1, y1
+uniform vec4 uvRect;    // u0, v0 (top-left), u1, v1 (bottom-right)
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(tileRect.xw, tileRect.zy, corner), 0.0, 1.0);
+    texCoord = mix(uvRect.xy, uvRect.zw, corner);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO;
+    GLint tileRectLoc, uvRectLoc;
+
+    void init(Camera* camera) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        tileRectLoc = glGetUniformLocation(shaderProgram, "tileRect");
+        uvRectLoc = glGetUniformLocation(shaderProgram, "uvRect");
+        // Corners come from gl_VertexID; the VAO only has to exist
+        glGenVertexArrays(1, &VAO);
+    }
+
+    // Draws one view (its camera already published); returns the tiles that had no texture of their own
+    int render(const Camera& camera, const TilePyramid& pyramid, TileCache& cache, int level, int frame, uint32_t viewBit) {
+        int holes = 0;
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, camera.getVisibleRect(), x0, y0, x1, y1))
+            return holes;
+
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                glm::vec4 rect = pyramid.tileRect(key);
+
+                // Walk up until a resident ancestor covers this tile
+                TileKey source = key;
+                TileCache::Entry* entry = cache.find(source);
+                if (!entry)
+                    ++holes;
+                while (!entry && source.level + 1 < pyramid.levelCount()) {
+                    source = source.parent();
+                    entry = cache.find(source);
+                }
+                if (!entry)
+                    continue;
+                entry->touch(frame, viewBit);
+
+                // Part of the source tile covered by this tile, in the source's texel space
+                glm::vec4 sourceRect = pyramid.tileRect(source);
+                float u0 = (rect.x - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float u1 = (rect.z - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float v0 = (sourceRect.w - rect.w) / (sourceRect.w - sourceRect.y);
+                float v1 = (sourceRect.w - rect.y) / (sourceRect.w - sourceRect.y);
+
+                glBindTexture(GL_TEXTURE_2D, entry->texture);
+                glUniform4f(tileRectLoc, rect.x, rect.y, rect.z, rect.w);
+                glUniform4f(uvRectLoc, u0, v0, u1, v1);
+                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            }
+        }
+        glBindVertexArray(0);
+        return holes;
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+    }
+};
+
+// Outlines a world rectangle, used to show where other views are looking
+class FrameRenderer {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 frameRect;  // world x0, y0, x1, y1
+
+void main()
+{
+    vec2 corner = vec2(float(gl_VertexID == 1 || gl_VertexID == 2), float(gl_VertexID >= 2));
+    gl_Position = viewProjection * vec4(mix(frameRect.xy, frameRect.zw, corner), 0.0, 1.0);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+uniform vec3 frameColor;
+
+void main()
+{
+    FragColor = vec4(frameColor, 1.0);
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO;
+    GLint frameRectLoc, frameColorLoc;
+
+    void init(Camera* camera) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        frameRectLoc = glGetUniformLocation(shaderProgram, "frameRect");
+        frameColorLoc = glGetUniformLocation(shaderProgram, "frameColor");
+        glGenVertexArrays(1, &VAO);
+    }
+
+    void render(const glm::vec4& rect, const glm::vec3& color) {
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        glUniform4f(frameRectLoc, rect.x, rect.y, rect.z, rect.w);
+        glUniform3f(frameColorLoc, color.x, color.y, color.z);
+        glDrawArrays(GL_LINE_LOOP, 0, 4);
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+    }
+};
+
+// One viewport of the window looking at the pyramid through its own camera
+struct View {
+    const char* name = "";
+    Camera camera;
+    glm::vec3 background = glm::vec3(0.0f);
+    glm::vec3 frameColor = glm::vec3(1.0f);
+    int level = 0;   // level drawn last frame
+    int holes = 0;   // tiles drawn from an ancestor last frame
+};
+
+enum class ViewLayout { SideBySide, OverviewDetail };
+
+// The views of the window. They share everything but their cameras: one request queue, loader pool and
+// tile cache serve all of them, and the views only decide where in the framebuffer each one draws.
+class ViewSet {
+public:
+    std::vector<View> views;
+    ViewLayout layout = ViewLayout::SideBySide;
+    int active = 0;   // view driven by the keyboard
+
+    void init() {
+        views.resize(2);
+        views[0].frameColor = glm::vec3(1.0f, 0.8f, 0.2f);
+        views[1].frameColor = glm::vec3(0.2f, 0.8f, 1.0f);
+        for (View& view : views)
+            view.camera.initUniformBuffer();
+        setLayout(ViewLayout::SideBySide);
+    }
+
+    // Side by side: two equal views. Overview+detail: view 0 fills the window and view 1 is a small
+    // overview of the whole image on top of it.
+    void setLayout(ViewLayout newLayout) {
+        layout = newLayout;
+        if (layout == ViewLayout::SideBySide) {
+            views[0].name = "left";
+            views[1].name = "right";
+            views[1].background = glm::vec3(0.0f);
+        } else {
+            views[0].name = "detail";
+            views[1].name = "overview";
+            views[1].background = glm::vec3(0.12f);
+            views[1].camera.reset();
+            active = 0;
+        }
+    }
+
+    // Viewport rectangles for the current framebuffer size
+    void arrange(int width, int height) {
+        if (layout == ViewLayout::SideBySide) {
+            views[0].camera.setViewport(0, 0, width / 2, height);
+            views[1].camera.setViewport(width / 2, 0, width - width / 2, height);
+        } else {
+            int size = static_cast<int>(overviewShare * std::min(width, height));
+            views[0].camera.setViewport(0, 0, width, height);
+            views[1].camera.setViewport(width - size - overviewMargin, height - size - overviewMargin, size, size);
+        }
+    }
+
+    void updateMotion(double now) {
+        for (View& view : views)
+            view.camera.updateMotion(now);
+    }
+
+    // Every view's wanted tiles in one list; the queue merges the duplicates, so a tile wanted by several views
+    // is decoded once. Returns how many of this frame's tiles were wanted by more than one view.
+    size_t collectRequests(Prefetcher& prefetcher, const TilePyramid& pyramid, const TileCache& cache,
+                           std::vector<TileRequest>& requests) {
+        requests.clear();
+        m_requestViews.clear();
+        for (size_t i = 0; i < views.size(); ++i) {
+            prefetcher.collect(views[i].camera, pyramid, cache, m_viewRequests);
+            for (const TileRequest& request : m_viewRequests)
+                m_requestViews[request.key.packed()] |= 1u << i;
+            requests.insert(requests.end(), m_viewRequests.begin(), m_viewRequests.end());
+        }
+
+        size_t shared = 0;
+        for (const auto& item : m_requestViews) {
+            if ((item.second & (item.second - 1)) != 0) {
+                ++shared;
+                m_sharedKeys.insert(item.first);
+            }
+        }
+        return shared;
+    }
+
+    // Each view into its own scissored viewport, with the frames of the views zoomed in further than it
+    void render(const TilePyramid& pyramid, TileCache& cache, TileRenderer& tiles, FrameRenderer& frames, int frame) {
+        glEnable(GL_SCISSOR_TEST);
+        for (size_t i = 0; i < views.size(); ++i) {
+            View& view = views[i];
+            glm::ivec4 viewport = view.camera.getViewport();
+            glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+            glScissor(viewport.x, viewport.y, viewport.z, viewport.w);
+            glClearColor(view.background.x, view.background.y, view.background.z, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            view.level = pyramid.selectLevel(view.camera);
+            view.camera.publish();
+            view.holes = tiles.render(view.camera, pyramid, cache, view.level, frame, 1u << i);
+
+            for (const View& other : views)
+                if (&other != &view && other.camera.getScale() > view.camera.getScale())
+                    frames.render(other.camera.getVisibleRect(), other.frameColor);
+        }
+        glDisable(GL_SCISSOR_TEST);
+    }
+
+    // Distinct tiles that were ever wanted by several views at once
+    size_t sharedKeyCount() const { return m_sharedKeys.size(); }
+
+    void destroy() {
+        for (View& view : views)
+            view.camera.destroy();
+    }
+
+private:
+    std::vector<TileRequest> m_viewRequests;
+    std::unordered_map<uint64_t, uint32_t> m_requestViews;   // key -> views that want it this frame
+    std::unordered_set<uint64_t> m_sharedKeys;
+};
+
+int main(int argc, char** argv) {
+    std::string imagePath = argc > 1 ? argv[1] : "src/textures/assets/test_nb.png";
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(1600, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    TilePyramid pyramid;
+    if (!pyramid.load(imagePath)) {
+        glfwTerminate();
+        return -1;
+    }
+
+    ViewSet viewSet;
+    viewSet.init();
+
+    TileRequestQueue queue;
+    TileLoaderPool loaders;
+    loaders.start(&pyramid, &queue);
+    TileCache cache;
+    Prefetcher prefetcher;
+    TileRenderer renderer;
+    renderer.init(&viewSet.views[0].camera);
+    FrameRenderer frames;
+    frames.init(&viewSet.views[0].camera);
+
+    std::vector<TileRequest> requests;
+    bool prefetchKeyDown = false, nextViewKeyDown = false, layoutKeyDown = false, resetKeyDown = false;
+    size_t sharedRequests = 0;
+    int frame = 0;
+    double lastTitleTime = glfwGetTime();
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        viewSet.arrange(width, height);
+
+        bool prefetchKeyPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+        if (prefetchKeyPressed && !prefetchKeyDown)
+            prefetcher.enabled = !prefetcher.enabled;
+        prefetchKeyDown = prefetchKeyPressed;
+
+        bool nextViewKeyPressed = glfwGetKey(window, GLFW_KEY_TAB) == GLFW_PRESS;
+        if (nextViewKeyPressed && !nextViewKeyDown)
+            viewSet.active = (viewSet.active + 1) % static_cast<int>(viewSet.views.size());
+        nextViewKeyDown = nextViewKeyPressed;
+
+        bool layoutKeyPressed = glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS;
+        if (layoutKeyPressed && !layoutKeyDown)
+            viewSet.setLayout(viewSet.layout == ViewLayout::SideBySide ? ViewLayout::OverviewDetail : ViewLayout::SideBySide);
+        layoutKeyDown = layoutKeyPressed;
+
+        bool resetKeyPressed = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+        if (resetKeyPressed && !resetKeyDown)
+            viewSet.views[viewSet.active].camera.reset();
+        resetKeyDown = resetKeyPressed;
+
+        viewSet.views[viewSet.active].camera.processKeyboardInput(window);
+        viewSet.updateMotion(glfwGetTime());
+
+        // One wanted set for all views; whatever no view wants any more is cancelled
+        sharedRequests = viewSet.collectRequests(prefetcher, pyramid, cache, requests);
+        queue.submitFrame(requests);
+
+        for (const LoadedTile& tile : loaders.takeCompleted(maxUploadsPerFrame)) {
+            cache.upload(tile, frame);
+            queue.delivered(tile.key);
+        }
+
+        viewSet.render(pyramid, cache, renderer, frames, frame);
+        cache.evict(frame);
+
+        double now = glfwGetTime();
+        if (now - lastTitleTime > 0.5) {
+            const View& first = viewSet.views[0];
+            const View& second = viewSet.views[1];
+            TileRequestQueue::Stats stats = queue.getStats();
+            char title[256];
+            snprintf(title, sizeof(title), "OpenGL - active: %s | %s level %d, %d holes | %s level %d, %d holes | pending %zu, %zu wanted by both, decoded %lld | %zu textures, %d drawn in both",
+                     viewSet.views[viewSet.active].name, first.name, first.level, first.holes, second.name, second.level, second.holes,
+                     queue.pendingCount(), sharedRequests, stats.started, cache.size(), cache.sharedCount(frame));
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    TileRequestQueue::Stats stats = queue.getStats();
+    printf("Requests submitted: %lld, merged: %lld, cancelled: %lld, decoded: %lld\n",
+           stats.submitted, stats.merged, stats.cancelled, stats.started);
+    printf("Tiles wanted by both views at once: %zu, each decoded and uploaded once\n", viewSet.sharedKeyCount());
+    printf("Tile uploads: %d, evicted without being drawn: %d\n", cache.getUploads(), cache.getUnusedEvictions());
+
+    loaders.stop();
+    frames.destroy();
+    renderer.destroy();
+    cache.destroy();
+    viewSet.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
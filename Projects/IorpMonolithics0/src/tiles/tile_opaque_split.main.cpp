@@ -0,0 +1,777 @@
+// stacked tile layers drawn as an opaque pass followed by a translucent pass
+// Every tile of every layer is classified once at load time (transparent, uniform, opaque, mixed). Each
+// frame the visible tiles are sorted into two lists:
+//   - opaque: fully opaque tiles of fully opaque layers; drawn first with blending off and depth writes on,
+//     top layer first (front to back), so anything they cover in lower layers fails the depth test early
+//   - translucent: everything else; drawn afterwards with blending on and depth writes off, bottom layer
+//     first (back to front), and still rejected wherever an opaque tile lies above
+// Transparent tiles are dropped. B switches to the baseline (every tile blended, no depth test) for
+// comparison; the title shows the fragments each pass wrote (occlusion queries) and the GPU frame time.
+// Usage: tile_opaque_split [image ...]   (bottom layer first)
+// Keys: WASD pan, Q/E zoom, B baseline, T top layer opacity 100%/60%.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+const int tileSize = 128;
+
+// Level of Detail (LOD) bias, typically in the range -0.5 to 0.5
+float lodBias = 0.0f;
+
+// Default stack when no images are given, bottom first
+const char* defaultLayerPaths[] = {
+    "src/textures/assets/test.png",
+    "src/textures/assets/test_nb.png",
+    "src/textures/assets/pop_cat.png",
+};
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+// Identifies one tile of the pyramid
+struct TileKey {
+    int level = 0, x = 0, y = 0;
+
+    uint64_t packed() const {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+    }
+    TileKey parent() const {
+        TileKey p;
+        p.level = level + 1;
+        p.x = x / 2;
+        p.y = y / 2;
+        return p;
+    }
+};
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera() : scale(1.0f), offset(0.0f, 0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    float getScale() const { return scale; }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    GLuint ubo = 0;
+};
+
+// How a tile's pixels are represented. Only Opaque and Mixed tiles keep pixels and need a texture;
+// Transparent tiles are never drawn and Uniform tiles are drawn as flat-color quads.
+enum class TileClass { Transparent, Uniform, Opaque, Mixed };
+
+const char* tileClassNames[] = { "transparent", "uniform", "opaque", "mixed" };
+
+struct TileInfo {
+    TileClass type = TileClass::Mixed;
+    glm::vec4 color = glm::vec4(0.0f);   // Uniform only, 0..1
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;   // Opaque and Mixed only
+};
+
+// Image plus its reduced levels, cut into tiles and classified once at load time.
+// World mapping keeps the aspect ratio: x spans [-1, 1], y spans [-h/w, h/w], row 0 at the top.
+class TilePyramid {
+public:
+    bool load(const std::string& imagePath) {
+        int width, height, nrChannels;
+        unsigned char* data = stbi_load(imagePath.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha);
+        if (!data) {
+            std::cerr << "Failed to load texture" << std::endl;
+            return false;
+        }
+
+        // Only the level being cut is kept dense; what stays resident is the per-tile representation
+        std::vector<unsigned char> dense(data, data + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(data);
+        for (;;) {
+            Level level;
+            level.width = width;
+            level.height = height;
+            cutTiles(dense, level);
+            m_levels.push_back(std::move(level));
+
+            // Halve until the whole level fits in one tile
+            if (width <= tileSize && height <= tileSize)
+                break;
+            int halfWidth = (width + 1) / 2, halfHeight = (height + 1) / 2;
+            std::vector<unsigned char> half;
+            downsample(dense, width, height, half, halfWidth, halfHeight);
+            dense.swap(half);
+            width = halfWidth;
+            height = halfHeight;
+        }
+
+        printf("Image size: %d x %d, levels: %d, tile size: %d\n", levelWidth(0), levelHeight(0), levelCount(), tileSize);
+        for (int type = 0; type < 4; ++type)
+            printf("  %s tiles: %d\n", tileClassNames[type], m_classCounts[type]);
+        printf("  pixel memory: %.2f MB stored, %.2f MB without elision\n", m_storedBytes / 1048576.0, m_denseBytes / 1048576.0);
+        return true;
+    }
+
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    int levelWidth(int level) const { return m_levels[level].width; }
+    int levelHeight(int level) const { return m_levels[level].height; }
+    int tilesX(int level) const { return (levelWidth(level) + tileSize - 1) / tileSize; }
+    int tilesY(int level) const { return (levelHeight(level) + tileSize - 1) / tileSize; }
+
+    bool isValid(const TileKey& key) const {
+        return key.level >= 0 && key.level < levelCount() &&
+               key.x >= 0 && key.x < tilesX(key.level) && key.y >= 0 && key.y < tilesY(key.level);
+    }
+
+    const TileInfo& tileInfo(const TileKey& key) const {
+        return m_levels[key.level].tiles[static_cast<size_t>(key.y) * tilesX(key.level) + key.x];
+    }
+
+    // Only Opaque and Mixed tiles get a texture
+    bool needsTexture(const TileKey& key) const {
+        TileClass type = tileInfo(key).type;
+        return type == TileClass::Opaque || type == TileClass::Mixed;
+    }
+
+    int getClassCount(TileClass type) const { return m_classCounts[static_cast<int>(type)]; }
+    size_t getStoredBytes() const { return m_storedBytes; }
+    size_t getDenseBytes() const { return m_denseBytes; }
+
+    // World units per level-0 pixel
+    float worldPerPixel() const { return 2.0f / m_levels[0].width; }
+
+    // World-space rectangle of a tile (min.x, min.y, max.x, max.y)
+    glm::vec4 tileRect(const TileKey& key) const {
+        int width0 = m_levels[0].width, height0 = m_levels[0].height;
+        int px0 = std::min(key.x * tileSize << key.level, width0);
+        int py0 = std::min(key.y * tileSize << key.level, height0);
+        int px1 = std::min((key.x + 1) * tileSize << key.level, width0);
+        int py1 = std::min((key.y + 1) * tileSize << key.level, height0);
+        float p = worldPerPixel();
+        float top = height0 * p * 0.5f;
+        return glm::vec4(px0 * p - 1.0f, top - py1 * p, px1 * p - 1.0f, top - py0 * p);
+    }
+
+    // Level whose texel density best matches the screen when one pyramid unit spans screenScale clip units
+    int selectLevel(float screenScale, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = screenScale * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        float texelsPerScreenPixel = 1.0f / (worldPerPixel() * screenPixelsPerWorld);
+        int level = static_cast<int>(std::floor(std::log2(std::max(texelsPerScreenPixel, 1e-6f)) + lodBias));
+        return std::max(0, std::min(level, levelCount() - 1));
+    }
+
+    // Range of tiles of a level that intersect a world rectangle; false if none
+    bool tileRange(int level, const glm::vec4& rect, int& x0, int& y0, int& x1, int& y1) const {
+        float p = worldPerPixel() * static_cast<float>(1 << level) * tileSize;  // world size of one tile
+        float top = m_levels[0].height * worldPerPixel() * 0.5f;
+        x0 = std::max(0, static_cast<int>(std::floor((rect.x + 1.0f) / p)));
+        x1 = std::min(tilesX(level) - 1, static_cast<int>(std::floor((rect.z + 1.0f) / p)));
+        y0 = std::max(0, static_cast<int>(std::floor((top - rect.w) / p)));
+        y1 = std::min(tilesY(level) - 1, static_cast<int>(std::floor((top - rect.y) / p)));
+        return x0 <= x1 && y0 <= y1;
+    }
+
+private:
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<TileInfo> tiles;   // row-major, tilesX * tilesY
+    };
+    std::vector<Level> m_levels;
+    int m_classCounts[4] = {};
+    size_t m_storedBytes = 0;
+    size_t m_denseBytes = 0;
+
+    void cutTiles(const std::vector<unsigned char>& dense, Level& level) {
+        int countX = (level.width + tileSize - 1) / tileSize;
+        int countY = (level.height + tileSize - 1) / tileSize;
+        level.tiles.resize(static_cast<size_t>(countX) * countY);
+        for (int ty = 0; ty < countY; ++ty) {
+            for (int tx = 0; tx < countX; ++tx) {
+                TileInfo& info = level.tiles[static_cast<size_t>(ty) * countX + tx];
+                info.width = std::min(tileSize, level.width - tx * tileSize);
+                info.height = std::min(tileSize, level.height - ty * tileSize);
+                info.pixels.resize(static_cast<size_t>(info.width) * info.height * 4);
+                for (int row = 0; row < info.height; ++row) {
+                    const unsigned char* src = dense.data() +
+                        ((static_cast<size_t>(ty) * tileSize + row) * level.width + static_cast<size_t>(tx) * tileSize) * 4;
+                    memcpy(info.pixels.data() + static_cast<size_t>(row) * info.width * 4, src, static_cast<size_t>(info.width) * 4);
+                }
+
+                classify(info);
+                ++m_classCounts[static_cast<int>(info.type)];
+                m_storedBytes += info.pixels.size();
+                m_denseBytes += static_cast<size_t>(info.width) * info.height * 4;
+            }
+        }
+    }
+
+    // Exact classification: any single differing texel makes a tile Opaque or Mixed
+    static void classify(TileInfo& info) {
+        const unsigned char* p = info.pixels.data();
+        size_t count = static_cast<size_t>(info.width) * info.height;
+        bool transparent = true, opaque = true, uniform = true;
+        for (size_t i = 0; i < count; ++i, p += 4) {
+            transparent = transparent && p[3] == 0;
+            opaque = opaque && p[3] == 255;
+            uniform = uniform && memcmp(p, info.pixels.data(), 4) == 0;
+            if (!transparent && !opaque && !uniform)
+                break;
+        }
+
+        if (transparent)
+            info.type = TileClass::Transparent;
+        else if (uniform)
+            info.type = TileClass::Uniform;
+        else
+            info.type = opaque ? TileClass::Opaque : TileClass::Mixed;
+
+        if (info.type == TileClass::Uniform) {
+            const unsigned char* c = info.pixels.data();
+            info.color = glm::vec4(c[0], c[1], c[2], c[3]) / 255.0f;
+        }
+        if (info.type == TileClass::Transparent || info.type == TileClass::Uniform)
+            std::vector<unsigned char>().swap(info.pixels);
+    }
+
+    static void downsample(const std::vector<unsigned char>& src, int srcWidth, int srcHeight,
+                           std::vector<unsigned char>& dst, int dstWidth, int dstHeight) {
+        dst.resize(static_cast<size_t>(dstWidth) * dstHeight * 4);
+        for (int y = 0; y < dstHeight; ++y) {
+            int sy0 = 2 * y, sy1 = std::min(2 * y + 1, srcHeight - 1);
+            for (int x = 0; x < dstWidth; ++x) {
+                int sx0 = 2 * x, sx1 = std::min(2 * x + 1, srcWidth - 1);
+                for (int c = 0; c < 4; ++c) {
+                    int sum = src[(static_cast<size_t>(sy0) * srcWidth + sx0) * 4 + c] +
+                              src[(static_cast<size_t>(sy0) * srcWidth + sx1) * 4 + c] +
+                              src[(static_cast<size_t>(sy1) * srcWidth + sx0) * 4 + c] +
+                              src[(static_cast<size_t>(sy1) * srcWidth + sx1) * 4 + c];
+                    dst[(static_cast<size_t>(y) * dstWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+};
+
+// One image of the stack: its pyramid, a texture per stored tile (uploaded at load time) and its placement.
+// A layer-local point p lands at p * scale + offset in world space.
+class TileLayer {
+public:
+    TilePyramid pyramid;
+    std::vector<std::vector<GLuint>> textures;   // [level][tile], 0 for elided tiles
+    glm::vec2 offset = glm::vec2(0.0f);
+    float scale = 1.0f;
+    float opacity = 1.0f;
+
+    bool load(const std::string& imagePath) {
+        if (!pyramid.load(imagePath))
+            return false;
+
+        textures.resize(pyramid.levelCount());
+        for (int level = 0; level < pyramid.levelCount(); ++level) {
+            textures[level].assign(static_cast<size_t>(pyramid.tilesX(level)) * pyramid.tilesY(level), 0);
+            for (int y = 0; y < pyramid.tilesY(level); ++y) {
+                for (int x = 0; x < pyramid.tilesX(level); ++x) {
+                    TileKey key;
+                    key.level = level;
+                    key.x = x;
+                    key.y = y;
+                    if (!pyramid.needsTexture(key))
+                        continue;
+                    const TileInfo& info = pyramid.tileInfo(key);
+                    GLuint& texture = textures[level][static_cast<size_t>(y) * pyramid.tilesX(level) + x];
+                    glGenTextures(1, &texture);
+                    glBindTexture(GL_TEXTURE_2D, texture);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, info.width, info.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, info.pixels.data());
+                }
+            }
+        }
+        return true;
+    }
+
+    GLuint texture(const TileKey& key) const {
+        return textures[key.level][static_cast<size_t>(key.y) * pyramid.tilesX(key.level) + key.x];
+    }
+
+    // World rectangle -> layer-local rectangle and back
+    glm::vec4 toLocal(const glm::vec4& rect) const {
+        return glm::vec4((rect.x - offset.x) / scale, (rect.y - offset.y) / scale,
+                         (rect.z - offset.x) / scale, (rect.w - offset.y) / scale);
+    }
+    glm::vec4 toWorld(const glm::vec4& rect) const {
+        return glm::vec4(rect.x * scale + offset.x, rect.y * scale + offset.y,
+                         rect.z * scale + offset.x, rect.w * scale + offset.y);
+    }
+
+    void destroy() {
+        for (std::vector<GLuint>& level : textures)
+            for (GLuint texture : level)
+                if (texture)
+                    glDeleteTextures(1, &texture);
+        textures.clear();
+    }
+};
+
+// Occlusion (fragments written) and timer queries, read back two frames later so the CPU never waits
+class FrameQueries {
+public:
+    GLuint opaqueSamples = 0, translucentSamples = 0;
+    double gpuMilliseconds = 0.0;
+
+    void init() {
+        for (Set& set : m_sets)
+            glGenQueries(3, set.ids);
+    }
+
+    // Collects the results of the set about to be reused
+    void beginFrame(int frame) {
+        m_current = frame % 2;
+        Set& set = m_sets[m_current];
+        if (set.issued) {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectuiv(set.ids[0], GL_QUERY_RESULT, &opaqueSamples);
+            glGetQueryObjectuiv(set.ids[1], GL_QUERY_RESULT, &translucentSamples);
+            glGetQueryObjectui64v(set.ids[2], GL_QUERY_RESULT, &elapsed);
+            gpuMilliseconds = elapsed / 1.0e6;
+        }
+        set.issued = true;
+        glBeginQuery(GL_TIME_ELAPSED, set.ids[2]);
+    }
+
+    void beginPass(int pass) { glBeginQuery(GL_SAMPLES_PASSED, m_sets[m_current].ids[pass]); }
+    void endPass() { glEndQuery(GL_SAMPLES_PASSED); }
+    void endFrame() { glEndQuery(GL_TIME_ELAPSED); }
+
+    void destroy() {
+        for (Set& set : m_sets)
+            glDeleteQueries(3, set.ids);
+    }
+
+private:
+    struct Set {
+        GLuint ids[3] = {};   // opaque samples, translucent samples, elapsed time
+        bool issued = false;
+    };
+    Set m_sets[2];
+    int m_current = 0;
+};
+
+// Sorts the visible tiles of all layers into an opaque and a translucent list and draws them in two passes.
+// Uniform tiles sample a 1x1 white texture tinted with their color, so every tile goes through one program.
+class LayerRenderer {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 tileRect;  // world x0, y0, x1, y1
+uniform vec4 uvRect;    // u0, v0 (top-left), u1, v1 (bottom-right)
+uniform float depth;    // per layer, top layer nearest
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(tileRect.xw, tileRect.zy, corner), 0.0, 1.0);
+    gl_Position.z = depth;
+    texCoord = mix(uvRect.xy, uvRect.zw, corner);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+uniform vec4 tint;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord) * tint;
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO;
+    GLuint whiteTexture;
+    GLint tileRectLoc, uvRectLoc, depthLoc, tintLoc;
+    bool baseline = false;
+    int opaqueDraws = 0, translucentDraws = 0;
+
+    void init(Camera* camera) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        tileRectLoc = glGetUniformLocation(shaderProgram, "tileRect");
+        uvRectLoc = glGetUniformLocation(shaderProgram, "uvRect");
+        depthLoc = glGetUniformLocation(shaderProgram, "depth");
+        tintLoc = glGetUniformLocation(shaderProgram, "tint");
+        // Corners come from gl_VertexID; the VAO only has to exist
+        glGenVertexArrays(1, &VAO);
+
+        const unsigned char white[4] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        m_queries.init();
+    }
+
+    void render(const Camera& camera, const std::vector<TileLayer>& layers, int framebufferWidth, int framebufferHeight, int frame) {
+        m_opaque.clear();
+        m_translucent.clear();
+        for (size_t i = 0; i < layers.size(); ++i)
+            collect(camera, layers[i], static_cast<int>(i), static_cast<int>(layers.size()), framebufferWidth, framebufferHeight);
+        opaqueDraws = static_cast<int>(m_opaque.size());
+        translucentDraws = static_cast<int>(m_translucent.size());
+
+        // Opaque: front to back (top layer first). Translucent: back to front (bottom layer first).
+        std::stable_sort(m_opaque.begin(), m_opaque.end(),
+                         [](const DrawItem& a, const DrawItem& b) { return a.layer > b.layer; });
+        std::stable_sort(m_translucent.begin(), m_translucent.end(),
+                         [](const DrawItem& a, const DrawItem& b) { return a.layer < b.layer; });
+
+        m_queries.beginFrame(frame);
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        if (baseline) {
+            // Everything blended in layer order, as a single global GL_BLEND would do
+            std::vector<DrawItem> all(m_translucent);
+            all.insert(all.end(), m_opaque.begin(), m_opaque.end());
+            std::stable_sort(all.begin(), all.end(),
+                             [](const DrawItem& a, const DrawItem& b) { return a.layer < b.layer; });
+            glDisable(GL_DEPTH_TEST);
+            glEnable(GL_BLEND);
+            m_queries.beginPass(0);
+            m_queries.endPass();
+            m_queries.beginPass(1);
+            draw(all);
+            m_queries.endPass();
+        } else {
+            glEnable(GL_DEPTH_TEST);
+            glDepthFunc(GL_LESS);
+
+            glDisable(GL_BLEND);
+            glDepthMask(GL_TRUE);
+            m_queries.beginPass(0);
+            draw(m_opaque);
+            m_queries.endPass();
+
+            glEnable(GL_BLEND);
+            glDepthMask(GL_FALSE);
+            m_queries.beginPass(1);
+            draw(m_translucent);
+            m_queries.endPass();
+
+            glDepthMask(GL_TRUE);
+            glDisable(GL_DEPTH_TEST);
+        }
+        glBindVertexArray(0);
+        m_queries.endFrame();
+    }
+
+    GLuint getOpaqueSamples() const { return m_queries.opaqueSamples; }
+    GLuint getTranslucentSamples() const { return m_queries.translucentSamples; }
+    double getGpuMilliseconds() const { return m_queries.gpuMilliseconds; }
+
+    void destroy() {
+        m_queries.destroy();
+        glDeleteTextures(1, &whiteTexture);
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+    }
+
+private:
+    struct DrawItem {
+        glm::vec4 rect;
+        glm::vec4 uv;
+        glm::vec4 tint;
+        GLuint texture = 0;
+        float depth = 0.0f;
+        int layer = 0;
+    };
+    std::vector<DrawItem> m_opaque, m_translucent;
+    FrameQueries m_queries;
+
+    void collect(const Camera& camera, const TileLayer& layer, int index, int layerCount,
+                 int framebufferWidth, int framebufferHeight) {
+        const TilePyramid& pyramid = layer.pyramid;
+        int level = pyramid.selectLevel(camera.getScale() * layer.scale, framebufferWidth, framebufferHeight);
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, layer.toLocal(camera.getVisibleRect()), x0, y0, x1, y1))
+            return;
+
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                const TileInfo& info = pyramid.tileInfo(key);
+                if (info.type == TileClass::Transparent || layer.opacity <= 0.0f)
+                    continue;
+
+                DrawItem item;
+                item.rect = layer.toWorld(pyramid.tileRect(key));
+                item.uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+                item.layer = index;
+                item.depth = 1.0f - 2.0f * (index + 1) / (layerCount + 1);
+                if (info.type == TileClass::Uniform) {
+                    item.texture = whiteTexture;
+                    item.tint = info.color;
+                } else {
+                    item.texture = layer.texture(key);
+                    item.tint = glm::vec4(1.0f);
+                }
+                item.tint.w *= layer.opacity;
+
+                bool opaque = item.tint.w >= 1.0f && info.type != TileClass::Mixed;
+                (opaque ? m_opaque : m_translucent).push_back(item);
+            }
+        }
+    }
+
+    void draw(const std::vector<DrawItem>& items) {
+        for (const DrawItem& item : items) {
+            glBindTexture(GL_TEXTURE_2D, item.texture);
+            glUniform4f(tileRectLoc, item.rect.x, item.rect.y, item.rect.z, item.rect.w);
+            glUniform4f(uvRectLoc, item.uv.x, item.uv.y, item.uv.z, item.uv.w);
+            glUniform4f(tintLoc, item.tint.x, item.tint.y, item.tint.z, item.tint.w);
+            glUniform1f(depthLoc, item.depth);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    std::vector<std::string> layerPaths;
+    for (int i = 1; i < argc; ++i)
+        layerPaths.push_back(argv[i]);
+    if (layerPaths.empty())
+        layerPaths.assign(std::begin(defaultLayerPaths), std::end(defaultLayerPaths));
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_DEPTH_BITS, 24);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    // Blending is a per-pass state now, not a global one
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Each layer above the base is smaller and shifted so the stack overlaps only partly
+    std::vector<TileLayer> layers(layerPaths.size());
+    for (size_t i = 0; i < layers.size(); ++i) {
+        if (!layers[i].load(layerPaths[i])) {
+            glfwTerminate();
+            return -1;
+        }
+        layers[i].scale = std::pow(0.8f, static_cast<float>(i));
+        layers[i].offset = glm::vec2((i % 2 ? 0.15f : -0.15f) * i, -0.1f * i);
+    }
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    LayerRenderer renderer;
+    renderer.init(&camera);
+
+    bool baselineKeyDown = false;
+    bool opacityKeyDown = false;
+    int frame = 0;
+    double lastTitleTime = glfwGetTime();
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool baselineKeyPressed = glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS;
+        if (baselineKeyPressed && !baselineKeyDown)
+            renderer.baseline = !renderer.baseline;
+        baselineKeyDown = baselineKeyPressed;
+
+        // T: a translucent top layer moves all of its tiles to the translucent list
+        bool opacityKeyPressed = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+        if (opacityKeyPressed && !opacityKeyDown)
+            layers.back().opacity = layers.back().opacity < 1.0f ? 1.0f : 0.6f;
+        opacityKeyDown = opacityKeyPressed;
+
+        camera.publish(width, height);
+        renderer.render(camera, layers, width, height, frame);
+
+        double now = glfwGetTime();
+        if (now - lastTitleTime > 0.5) {
+            char title[200];
+            snprintf(title, sizeof(title), "OpenGL - %s, opaque %d tiles / %u fragments, translucent %d tiles / %u fragments, GPU %.2f ms",
+                     renderer.baseline ? "baseline (all blended)" : "opaque/translucent split",
+                     renderer.opaqueDraws, renderer.getOpaqueSamples(), renderer.translucentDraws,
+                     renderer.getTranslucentSamples(), renderer.getGpuMilliseconds());
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    renderer.destroy();
+    for (TileLayer& layer : layers)
+        layer.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
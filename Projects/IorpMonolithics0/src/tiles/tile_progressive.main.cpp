@@ -0,0 +1,1265 @@
+// tiled pyramid viewer that shows a coarse overview first and refines it in place
+// Opening a file only reads its header, so the tile grid is known immediately. A low-resolution overview is
+// then taken from the cheapest source available: an overview cached in the temp directory by a previous run
+// (the pyramid level closest to overviewMaxSize), the reduced-resolution directory of a TIFF,
+// or the EXIF thumbnail of a JPEG. It is drawn for every tile whose ancestors are not resident yet, while the
+// full decode runs in the background and finer tiles replace coarse ones as they arrive.
+// Time-to-first-pixel (file open to the first frame on screen) and time-to-full-resolution are printed and
+// shown in the title.
+// Usage: tile_progressive [image]   Keys: WASD pan, Q/E zoom, P toggles prefetching.
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cctype>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <tiffio.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+const int tileSize = 128;
+
+// Level of Detail (LOD) bias, typically in the range -0.5 to 0.5
+float lodBias = 0.0f;
+
+// Loader configuration: worker count and an artificial per-tile cost standing in for a slow decoder/disk
+const int loaderThreadCount = 2;
+const int simulatedDecodeMs = 15;
+
+// GPU tile cache budget (tiles) and upload throttle (tiles per frame)
+const size_t gpuTileBudget = 192;
+const int maxUploadsPerFrame = 8;
+
+// Prediction: how far ahead the camera path is extrapolated, and the sampling step along it (seconds)
+const float predictionHorizon = 0.6f;
+const float predictionStep = 0.1f;
+// Time constant of the velocity smoothing (seconds)
+const float velocitySmoothing = 0.15f;
+// Zoom rates below this (ln(scale) per second) are treated as "not zooming"
+const float zoomRateThreshold = 0.05f;
+
+// Priority weights: seconds-equivalent cost of one level away from the current LOD / of one half view extent
+const float levelWeight = 0.5f;
+const float distanceWeight = 0.1f;
+
+// Overview size: the cached overview is at most overviewMaxSize pixels on a side; embedded TIFF overviews
+// narrower than overviewMinSize are too blurry to be worth showing
+const int overviewMaxSize = 512;
+const int overviewMinSize = 64;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+// Identifies one tile of the pyramid
+struct TileKey {
+    int level = 0, x = 0, y = 0;
+
+    uint64_t packed() const {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+    }
+    TileKey parent() const {
+        TileKey p;
+        p.level = level + 1;
+        p.x = x / 2;
+        p.y = y / 2;
+        return p;
+    }
+};
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f), velocity(0.0f, 0.0f), zoomRate(0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    void zoomBy(float factor) {
+        scale *= factor;
+    }
+
+    // Measures how fast offset and scale changed since the last call, smoothed exponentially
+    void updateMotion(double now) {
+        if (lastTime < 0.0) {
+            lastTime = now;
+            lastOffset = offset;
+            lastScale = scale;
+            return;
+        }
+        float dt = static_cast<float>(now - lastTime);
+        if (dt <= 0.0f)
+            return;
+
+        glm::vec2 instantVelocity = (offset - lastOffset) / dt;
+        float instantZoomRate = std::log(scale / lastScale) / dt;
+        float alpha = 1.0f - std::exp(-dt / velocitySmoothing);
+        velocity += (instantVelocity - velocity) * alpha;
+        zoomRate += (instantZoomRate - zoomRate) * alpha;
+
+        lastTime = now;
+        lastOffset = offset;
+        lastScale = scale;
+    }
+
+    // Camera extrapolated t seconds ahead along the current pan/zoom motion
+    Camera predicted(float t) const {
+        Camera c = *this;
+        c.offset = offset + velocity * t;
+        c.scale = scale * std::exp(zoomRate * t);
+        return c;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    glm::vec2 getCenter() const { return -offset; }
+    float getScale() const { return scale; }
+    float getZoomRate() const { return zoomRate; }
+    glm::vec2 getVelocity() const { return velocity; }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    glm::vec2 velocity;   // world units per second (of offset)
+    float zoomRate;       // d ln(scale) / dt
+    double lastTime = -1.0;
+    glm::vec2 lastOffset;
+    float lastScale = 1.0f;
+    GLuint ubo = 0;
+};
+
+// Image pixels for the full decode: stb for PNG/JPEG, libtiff (top-left oriented RGBA) for TIFF
+bool isTiffPath(const std::string& path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".tif" || extension == ".tiff";
+}
+
+bool readImageSize(const std::string& path, int& width, int& height) {
+    if (isTiffPath(path)) {
+        TIFF* tif = TIFFOpen(path.c_str(), "r");
+        if (!tif)
+            return false;
+        uint32_t w = 0, h = 0;
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &w);
+        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &h);
+        TIFFClose(tif);
+        width = static_cast<int>(w);
+        height = static_cast<int>(h);
+        return width > 0 && height > 0;
+    }
+    int nrChannels;
+    return stbi_info(path.c_str(), &width, &height, &nrChannels) != 0;
+}
+
+bool decodeImage(const std::string& path, std::vector<unsigned char>& pixels, int& width, int& height) {
+    if (isTiffPath(path)) {
+        TIFF* tif = TIFFOpen(path.c_str(), "r");
+        if (!tif)
+            return false;
+        uint32_t w = 0, h = 0;
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &w);
+        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &h);
+        pixels.resize(static_cast<size_t>(w) * h * 4);
+        // Packed ABGR words are R, G, B, A bytes in memory on little-endian hosts
+        bool ok = TIFFReadRGBAImageOriented(tif, w, h, reinterpret_cast<uint32_t*>(pixels.data()), ORIENTATION_TOPLEFT, 0) != 0;
+        TIFFClose(tif);
+        width = static_cast<int>(w);
+        height = static_cast<int>(h);
+        return ok;
+    }
+
+    int nrChannels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha);
+    if (!data)
+        return false;
+    pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(data);
+    return true;
+}
+
+// Pyramid geometry is known as soon as the header has been read; the pixels arrive later from decode(),
+// which runs on a background thread. World mapping keeps the aspect ratio: x spans [-1, 1],
+// y spans [-h/w, h/w], row 0 at the top.
+class TilePyramid {
+public:
+    bool open(const std::string& imagePath) {
+        m_path = imagePath;
+        int width, height;
+        if (!readImageSize(imagePath, width, height)) {
+            std::cerr << "Failed to load texture" << std::endl;
+            return false;
+        }
+
+        m_levels.clear();
+        Level level;
+        level.width = width;
+        level.height = height;
+        m_levels.push_back(level);
+        // Level sizes follow from the header alone: halve until the whole level fits in one tile
+        while (m_levels.back().width > tileSize || m_levels.back().height > tileSize) {
+            level.width = (m_levels.back().width + 1) / 2;
+            level.height = (m_levels.back().height + 1) / 2;
+            m_levels.push_back(level);
+        }
+
+        printf("Image size: %d x %d, levels: %d, tile size: %d\n", width, height, levelCount(), tileSize);
+        return true;
+    }
+
+    // Full decode and level generation; readTile() may be used once isReady() turns true
+    bool decode() {
+        int width, height;
+        if (!decodeImage(m_path, m_levels[0].pixels, width, height)) {
+            std::cerr << "Failed to decode " << m_path << std::endl;
+            return false;
+        }
+        for (size_t level = 1; level < m_levels.size(); ++level)
+            downsample(m_levels[level - 1], m_levels[level]);
+        m_ready = true;
+        return true;
+    }
+
+    bool isReady() const { return m_ready; }
+
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    int levelWidth(int level) const { return m_levels[level].width; }
+    int levelHeight(int level) const { return m_levels[level].height; }
+    int tilesX(int level) const { return (levelWidth(level) + tileSize - 1) / tileSize; }
+    int tilesY(int level) const { return (levelHeight(level) + tileSize - 1) / tileSize; }
+    const std::vector<unsigned char>& levelPixels(int level) const { return m_levels[level].pixels; }
+
+    bool isValid(const TileKey& key) const {
+        return key.level >= 0 && key.level < levelCount() &&
+               key.x >= 0 && key.x < tilesX(key.level) && key.y >= 0 && key.y < tilesY(key.level);
+    }
+
+    // Finest level no larger than maxSize on either side, used as the cached overview
+    int overviewLevel(int maxSize) const {
+        for (int level = 0; level < levelCount(); ++level)
+            if (levelWidth(level) <= maxSize && levelHeight(level) <= maxSize)
+                return level;
+        return levelCount() - 1;
+    }
+
+    // Copies one tile out of its level; stands in for a real tile decoder (thread-safe, read-only)
+    void readTile(const TileKey& key, std::vector<unsigned char>& pixels, int& width, int& height) const {
+        const Level& level = m_levels[key.level];
+        width = std::min(tileSize, level.width - key.x * tileSize);
+        height = std::min(tileSize, level.height - key.y * tileSize);
+        pixels.resize(static_cast<size_t>(width) * height * 4);
+        for (int row = 0; row < height; ++row) {
+            const unsigned char* src = level.pixels.data() +
+                ((static_cast<size_t>(key.y) * tileSize + row) * level.width + static_cast<size_t>(key.x) * tileSize) * 4;
+            memcpy(pixels.data() + static_cast<size_t>(row) * width * 4, src, static_cast<size_t>(width) * 4);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(simulatedDecodeMs));
+    }
+
+    // World units per level-0 pixel, and the world y of image row 0
+    float worldPerPixel() const { return 2.0f / m_levels[0].width; }
+    float worldTop() const { return m_levels[0].height * worldPerPixel() * 0.5f; }
+
+    // World-space rectangle of a tile (min.x, min.y, max.x, max.y)
+    glm::vec4 tileRect(const TileKey& key) const {
+        int width0 = m_levels[0].width, height0 = m_levels[0].height;
+        int px0 = std::min(key.x * tileSize << key.level, width0);
+        int py0 = std::min(key.y * tileSize << key.level, height0);
+        int px1 = std::min((key.x + 1) * tileSize << key.level, width0);
+        int py1 = std::min((key.y + 1) * tileSize << key.level, height0);
+        float p = worldPerPixel();
+        float top = worldTop();
+        return glm::vec4(px0 * p - 1.0f, top - py1 * p, px1 * p - 1.0f, top - py0 * p);
+    }
+
+    // Level whose texel density best matches the screen for this camera
+    int selectLevel(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        float texelsPerScreenPixel = 1.0f / (worldPerPixel() * screenPixelsPerWorld);
+        int level = static_cast<int>(std::floor(std::log2(std::max(texelsPerScreenPixel, 1e-6f)) + lodBias));
+        return std::max(0, std::min(level, levelCount() - 1));
+    }
+
+    // Continuous level (before flooring), used to predict level switches
+    float levelPosition(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        return std::log2(1.0f / (worldPerPixel() * screenPixelsPerWorld)) + lodBias;
+    }
+
+    // Range of tiles of a level that intersect a world rectangle; false if none
+    bool tileRange(int level, const glm::vec4& rect, int& x0, int& y0, int& x1, int& y1) const {
+        float p = worldPerPixel() * static_cast<float>(1 << level) * tileSize;  // world size of one tile
+        float top = worldTop();
+        x0 = std::max(0, static_cast<int>(std::floor((rect.x + 1.0f) / p)));
+        x1 = std::min(tilesX(level) - 1, static_cast<int>(std::floor((rect.z + 1.0f) / p)));
+        y0 = std::max(0, static_cast<int>(std::floor((top - rect.w) / p)));
+        y1 = std::min(tilesY(level) - 1, static_cast<int>(std::floor((top - rect.y) / p)));
+        return x0 <= x1 && y0 <= y1;
+    }
+
+private:
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<unsigned char> pixels;
+    };
+    std::string m_path;
+    std::vector<Level> m_levels;
+    std::atomic<bool> m_ready{ false };
+
+    static void downsample(const Level& src, Level& dst) {
+        dst.pixels.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+        for (int y = 0; y < dst.height; ++y) {
+            int sy0 = 2 * y, sy1 = std::min(2 * y + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x) {
+                int sx0 = 2 * x, sx1 = std::min(2 * x + 1, src.width - 1);
+                for (int c = 0; c < 4; ++c) {
+                    int sum = src.pixels[(static_cast<size_t>(sy0) * src.width + sx0) * 4 + c] +
+                              src.pixels[(static_cast<size_t>(sy0) * src.width + sx1) * 4 + c] +
+                              src.pixels[(static_cast<size_t>(sy1) * src.width + sx0) * 4 + c] +
+                              src.pixels[(static_cast<size_t>(sy1) * src.width + sx1) * 4 + c];
+                    dst.pixels[(static_cast<size_t>(y) * dst.width + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+};
+
+// Low-resolution stand-in for the whole image, available long before the full decode
+struct OverviewImage {
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;   // RGBA, row 0 at the top
+    std::string source;
+};
+
+// Cached overview: "OVR1", source size, source mtime, width, height, RGBA pixels. Written after the first
+// full decode from the pyramid level closest to overviewMaxSize.
+bool sourceStamp(const std::string& imagePath, uint64_t& size, int64_t& time) {
+    std::error_code ec;
+    size = std::filesystem::file_size(imagePath, ec);
+    if (ec)
+        return false;
+    time = static_cast<int64_t>(std::filesystem::last_write_time(imagePath, ec).time_since_epoch().count());
+    return !ec;
+}
+
+// Lives in the temp directory, named by an FNV-1a hash of the absolute image path, size and mtime, so
+// image folders stay untouched and an edited image gets a fresh entry
+std::string overviewCachePath(const std::string& imagePath, uint64_t size, int64_t time) {
+    std::error_code ec;
+    std::string absolutePath = std::filesystem::absolute(imagePath, ec).string();
+    if (ec)
+        absolutePath = imagePath;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](const void* data, size_t length) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < length; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    };
+    mix(absolutePath.data(), absolutePath.size());
+    mix(&size, sizeof(size));
+    mix(&time, sizeof(time));
+
+    char name[64];
+    snprintf(name, sizeof(name), "iorp_overview_%016llx.ovr", static_cast<unsigned long long>(hash));
+    std::filesystem::path directory = std::filesystem::temp_directory_path(ec);
+    return ec ? std::string() : (directory / name).string();
+}
+
+bool readCachedOverview(const std::string& imagePath, OverviewImage& overview) {
+    uint64_t size;
+    int64_t time;
+    if (!sourceStamp(imagePath, size, time))
+        return false;
+
+    std::ifstream file(overviewCachePath(imagePath, size, time), std::ios::binary);
+    if (!file)
+        return false;
+    char magic[4];
+    uint64_t cachedSize;
+    int64_t cachedTime;
+    int32_t width, height;
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(&cachedSize), sizeof(cachedSize));
+    file.read(reinterpret_cast<char*>(&cachedTime), sizeof(cachedTime));
+    file.read(reinterpret_cast<char*>(&width), sizeof(width));
+    file.read(reinterpret_cast<char*>(&height), sizeof(height));
+    if (!file || memcmp(magic, "OVR1", 4) != 0 || cachedSize != size || cachedTime != time)
+        return false;
+    // The writer never stores more than overviewMaxSize on a side; anything else is a damaged file
+    if (width <= 0 || height <= 0 || width > overviewMaxSize || height > overviewMaxSize)
+        return false;
+
+    overview.width = width;
+    overview.height = height;
+    overview.pixels.resize(static_cast<size_t>(width) * height * 4);
+    file.read(reinterpret_cast<char*>(overview.pixels.data()), overview.pixels.size());
+    overview.source = "cached overview";
+    return static_cast<bool>(file);
+}
+
+void writeCachedOverview(const std::string& imagePath, const OverviewImage& overview) {
+    uint64_t size;
+    int64_t time;
+    if (!sourceStamp(imagePath, size, time))
+        return;
+
+    std::ofstream file(overviewCachePath(imagePath, size, time), std::ios::binary);
+    if (!file)
+        return;
+    int32_t width = overview.width, height = overview.height;
+    file.write("OVR1", 4);
+    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    file.write(reinterpret_cast<const char*>(&time), sizeof(time));
+    file.write(reinterpret_cast<const char*>(&width), sizeof(width));
+    file.write(reinterpret_cast<const char*>(&height), sizeof(height));
+    file.write(reinterpret_cast<const char*>(overview.pixels.data()), overview.pixels.size());
+}
+
+// TIFF: smallest reduced-resolution directory (internal overview) that is still at least overviewMinSize wide
+bool readTiffOverview(const std::string& imagePath, OverviewImage& overview) {
+    TIFF* tif = TIFFOpen(imagePath.c_str(), "r");
+    if (!tif)
+        return false;
+
+    int bestDirectory = -1;
+    uint32_t bestWidth = 0;
+    int directory = 0;
+    do {
+        uint32_t subfileType = 0, width = 0;
+        TIFFGetField(tif, TIFFTAG_SUBFILETYPE, &subfileType);
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+        if ((subfileType & FILETYPE_REDUCEDIMAGE) && width >= static_cast<uint32_t>(overviewMinSize) &&
+            (bestDirectory < 0 || width < bestWidth)) {
+            bestDirectory = directory;
+            bestWidth = width;
+        }
+        ++directory;
+    } while (TIFFReadDirectory(tif));
+
+    bool ok = false;
+    if (bestDirectory >= 0 && TIFFSetDirectory(tif, static_cast<tdir_t>(bestDirectory))) {
+        uint32_t w = 0, h = 0;
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &w);
+        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &h);
+        overview.pixels.resize(static_cast<size_t>(w) * h * 4);
+        ok = TIFFReadRGBAImageOriented(tif, w, h, reinterpret_cast<uint32_t*>(overview.pixels.data()), ORIENTATION_TOPLEFT, 0) != 0;
+        overview.width = static_cast<int>(w);
+        overview.height = static_cast<int>(h);
+        overview.source = "TIFF overview";
+    }
+    TIFFClose(tif);
+    return ok;
+}
+
+// JPEG: thumbnail embedded in the EXIF APP1 segment (IFD1 JPEGInterchangeFormat / Length)
+bool readExifThumbnail(const std::string& imagePath, OverviewImage& overview) {
+    std::ifstream file(imagePath, std::ios::binary);
+    if (!file)
+        return false;
+    // The APP1 segment is limited to 64 KB and comes right after SOI
+    std::vector<unsigned char> head(70 * 1024);
+    file.read(reinterpret_cast<char*>(head.data()), head.size());
+    head.resize(static_cast<size_t>(file.gcount()));
+    if (head.size() < 4 || head[0] != 0xFF || head[1] != 0xD8)
+        return false;
+
+    size_t pos = 2;
+    while (pos + 4 <= head.size() && head[pos] == 0xFF) {
+        unsigned char marker = head[pos + 1];
+        size_t length = (static_cast<size_t>(head[pos + 2]) << 8) | head[pos + 3];
+        if (marker == 0xDA || marker == 0xD9)
+            break; // start of scan: no EXIF before the image data
+        if (marker == 0xE1 && pos + 2 + length <= head.size() && length > 8 && memcmp(&head[pos + 4], "Exif\0\0", 6) == 0) {
+            const unsigned char* tiff = &head[pos + 10];
+            size_t tiffSize = length - 8;
+            bool little = tiff[0] == 'I';
+            auto read16 = [&](size_t at) -> uint32_t {
+                if (at + 2 > tiffSize) return 0;
+                return little ? (tiff[at] | tiff[at + 1] << 8) : (tiff[at] << 8 | tiff[at + 1]);
+            };
+            auto read32 = [&](size_t at) -> uint32_t {
+                if (at + 4 > tiffSize) return 0;
+                return little ? (tiff[at] | tiff[at + 1] << 8 | tiff[at + 2] << 16 | static_cast<uint32_t>(tiff[at + 3]) << 24)
+                              : (static_cast<uint32_t>(tiff[at]) << 24 | tiff[at + 1] << 16 | tiff[at + 2] << 8 | tiff[at + 3]);
+            };
+
+            // Skip IFD0 to reach IFD1, which describes the thumbnail
+            uint32_t ifd0 = read32(4);
+            uint32_t ifd1 = read32(ifd0 + 2 + read16(ifd0) * 12);
+            if (ifd1 == 0 || ifd1 >= tiffSize)
+                return false;
+            uint32_t offset = 0, size = 0;
+            uint32_t entries = read16(ifd1);
+            for (uint32_t i = 0; i < entries; ++i) {
+                size_t entry = ifd1 + 2 + i * 12;
+                uint32_t tag = read16(entry);
+                if (tag == 0x0201) offset = read32(entry + 8);
+                if (tag == 0x0202) size = read32(entry + 8);
+            }
+            if (offset == 0 || size == 0 || offset > tiffSize || size > tiffSize - offset)
+                return false;
+
+            int width, height, nrChannels;
+            unsigned char* data = stbi_load_from_memory(tiff + offset, static_cast<int>(size), &width, &height, &nrChannels, STBI_rgb_alpha);
+            if (!data)
+                return false;
+            overview.width = width;
+            overview.height = height;
+            overview.pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+            overview.source = "EXIF thumbnail";
+            stbi_image_free(data);
+            return true;
+        }
+        pos += 2 + length;
+    }
+    return false;
+}
+
+// Cheapest available overview, in order: cached pyramid level, embedded TIFF overview, EXIF thumbnail
+bool loadOverview(const std::string& imagePath, OverviewImage& overview) {
+    if (readCachedOverview(imagePath, overview))
+        return true;
+    if (isTiffPath(imagePath))
+        return readTiffOverview(imagePath, overview);
+    return readExifThumbnail(imagePath, overview);
+}
+
+// One tile wanted by the renderer or the prefetcher; lower priority values are served first
+struct TileRequest {
+    TileKey key;
+    float priority = 0.0f;
+};
+
+struct LoadedTile {
+    TileKey key;
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;
+};
+
+// Scheduler between the renderer and the decoders.
+// - Duplicates merge: a key requested several times in a frame, or again while pending or in flight, is
+//   one piece of work that keeps the best priority it was given.
+// - Ordering: pending work is kept sorted by priority, workers always take the most urgent tile.
+// - Cancellation: every frame submits the complete set of tiles it still wants; pending requests missing
+//   from that set are dropped before any decoder picks them up.
+class TileRequestQueue {
+public:
+    struct Stats {
+        long long submitted = 0;   // requests received, duplicates included
+        long long merged = 0;      // requests folded into an existing entry
+        long long cancelled = 0;   // pending requests dropped as no longer wanted
+        long long started = 0;     // requests handed to a decoder
+    };
+
+    // Replaces the wanted set for this frame (requests may contain duplicates)
+    void submitFrame(const std::vector<TileRequest>& requests) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+
+        for (const TileRequest& request : requests) {
+            ++m_stats.submitted;
+            uint64_t id = request.key.packed();
+            auto it = m_entries.find(id);
+            if (it == m_entries.end()) {
+                Entry entry;
+                entry.key = request.key;
+                entry.priority = request.priority;
+                entry.generation = m_generation;
+                m_entries.emplace(id, entry);
+                m_order.insert(std::make_pair(request.priority, id));
+                continue;
+            }
+
+            ++m_stats.merged;
+            Entry& entry = it->second;
+            if (entry.state == State::InFlight)
+                continue;
+            // First sighting this frame takes the new priority; later duplicates only improve it
+            float priority = entry.generation == m_generation ? std::min(entry.priority, request.priority) : request.priority;
+            if (priority != entry.priority) {
+                m_order.erase(std::make_pair(entry.priority, id));
+                entry.priority = priority;
+                m_order.insert(std::make_pair(priority, id));
+            }
+            entry.generation = m_generation;
+        }
+
+        // Everything still pending but not asked for this frame is no longer visible or predicted
+        for (auto it = m_order.begin(); it != m_order.end();) {
+            Entry& entry = m_entries[it->second];
+            if (entry.generation != m_generation) {
+                m_entries.erase(it->second);
+                it = m_order.erase(it);
+                ++m_stats.cancelled;
+            }
+            else {
+                ++it;
+            }
+        }
+
+        m_wakeup.notify_all();
+    }
+
+    // Blocks until there is work; returns false on shutdown
+    bool pop(TileKey& key) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeup.wait(lock, [this] { return m_shutdown || !m_order.empty(); });
+        if (m_shutdown)
+            return false;
+        uint64_t id = m_order.begin()->second;
+        m_order.erase(m_order.begin());
+        Entry& entry = m_entries[id];
+        entry.state = State::InFlight;
+        key = entry.key;
+        ++m_stats.started;
+        return true;
+    }
+
+    // The tile reached the cache; later requests for it are the cache's business
+    void delivered(const TileKey& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.erase(key.packed());
+    }
+
+    void shutdown() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+        m_wakeup.notify_all();
+    }
+
+    size_t pendingCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_order.size();
+    }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    enum class State { Pending, InFlight };
+    struct Entry {
+        TileKey key;
+        State state = State::Pending;
+        float priority = 0.0f;
+        uint64_t generation = 0;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::unordered_map<uint64_t, Entry> m_entries;    // pending and in-flight
+    std::set<std::pair<float, uint64_t>> m_order;     // pending only, most urgent first
+    uint64_t m_generation = 0;
+    bool m_shutdown = false;
+    Stats m_stats;
+};
+
+// Decoder threads pulling from the request queue
+class TileLoaderPool {
+public:
+    void start(const TilePyramid* pyramid, TileRequestQueue* queue) {
+        m_pyramid = pyramid;
+        m_queue = queue;
+        for (int i = 0; i < loaderThreadCount; ++i)
+            m_threads.emplace_back(&TileLoaderPool::workerThread, this);
+    }
+
+    std::vector<LoadedTile> takeCompleted(int maxCount) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<LoadedTile> result;
+        while (!m_completed.empty() && static_cast<int>(result.size()) < maxCount) {
+            result.push_back(std::move(m_completed.front()));
+            m_completed.pop_front();
+        }
+        return result;
+    }
+
+    void stop() {
+        m_queue->shutdown();
+        for (std::thread& thread : m_threads)
+            thread.join();
+        m_threads.clear();
+    }
+
+private:
+    const TilePyramid* m_pyramid = nullptr;
+    TileRequestQueue* m_queue = nullptr;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::deque<LoadedTile> m_completed;
+
+    void workerThread() {
+        TileKey key;
+        while (m_queue->pop(key)) {
+            LoadedTile tile;
+            tile.key = key;
+            m_pyramid->readTile(key, tile.pixels, tile.width, tile.height);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed.push_back(std::move(tile));
+        }
+    }
+};
+
+// GPU-resident tiles, evicted least-recently-used once over budget
+class TileCache {
+public:
+    struct Entry {
+        GLuint texture = 0;
+        int width = 0, height = 0;
+        int lastUsedFrame = 0;
+        bool drawn = false;
+    };
+
+    void upload(const LoadedTile& tile, int frame) {
+        Entry entry;
+        entry.width = tile.width;
+        entry.height = tile.height;
+        entry.lastUsedFrame = frame;
+
+        glGenTextures(1, &entry.texture);
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tile.width, tile.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, tile.pixels.data());
+
+        m_entries[tile.key.packed()] = entry;
+        ++m_uploads;
+    }
+
+    Entry* find(const TileKey& key) {
+        auto it = m_entries.find(key.packed());
+        return it == m_entries.end() ? nullptr : &it->second;
+    }
+
+    bool contains(const TileKey& key) const { return m_entries.count(key.packed()) != 0; }
+
+    void evict(int currentFrame) {
+        if (m_entries.size() <= gpuTileBudget)
+            return;
+        std::vector<std::pair<int, uint64_t>> candidates;
+        for (const auto& item : m_entries)
+            if (item.second.lastUsedFrame < currentFrame)
+                candidates.emplace_back(item.second.lastUsedFrame, item.first);
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& candidate : candidates) {
+            if (m_entries.size() <= gpuTileBudget)
+                break;
+            Entry& victim = m_entries[candidate.second];
+            if (!victim.drawn)
+                ++m_unusedEvictions;
+            glDeleteTextures(1, &victim.texture);
+            m_entries.erase(candidate.second);
+        }
+    }
+
+    size_t size() const { return m_entries.size(); }
+    int getUploads() const { return m_uploads; }
+    int getUnusedEvictions() const { return m_unusedEvictions; }
+
+    void destroy() {
+        for (auto& item : m_entries)
+            glDeleteTextures(1, &item.second.texture);
+        m_entries.clear();
+    }
+
+private:
+    std::unordered_map<uint64_t, Entry> m_entries;
+    int m_uploads = 0;
+    int m_unusedEvictions = 0;   // decoded and uploaded, but evicted before ever being drawn
+};
+
+// Emits requests for the visible tiles and for the predicted camera path (duplicates are left to the queue).
+// priority = predicted seconds until visible + levelWeight * levels away from the current level
+//          + distanceWeight * distance from the view center (in half view extents)
+class Prefetcher {
+public:
+    bool enabled = true;
+
+    void collect(const Camera& camera, const TilePyramid& pyramid, const TileCache& cache,
+                 int framebufferWidth, int framebufferHeight, std::vector<TileRequest>& requests) {
+        requests.clear();
+        int currentLevel = pyramid.selectLevel(camera, framebufferWidth, framebufferHeight);
+
+        float horizon = enabled ? predictionHorizon : 0.0f;
+        for (float t = 0.0f; t <= horizon + 1e-4f; t += predictionStep) {
+            Camera future = camera.predicted(t);
+            int level = pyramid.selectLevel(future, framebufferWidth, framebufferHeight);
+            addRect(pyramid, cache, future, level, currentLevel, t, requests);
+        }
+
+        float zoomRate = camera.getZoomRate();
+        if (enabled && std::fabs(zoomRate) > zoomRateThreshold) {
+            float position = pyramid.levelPosition(camera, framebufferWidth, framebufferHeight);
+            float levelsPerSecond = zoomRate / std::log(2.0f);
+            int nextLevel = zoomRate > 0.0f ? currentLevel - 1 : currentLevel + 1;
+            float distanceToSwitch = zoomRate > 0.0f ? position - std::floor(position) : std::ceil(position) - position;
+            float timeToSwitch = distanceToSwitch / std::fabs(levelsPerSecond);
+            if (nextLevel >= 0 && nextLevel < pyramid.levelCount())
+                addRect(pyramid, cache, camera, nextLevel, currentLevel, timeToSwitch, requests);
+        }
+    }
+
+private:
+    void addRect(const TilePyramid& pyramid, const TileCache& cache, const Camera& view, int level, int currentLevel,
+                 float t, std::vector<TileRequest>& requests) {
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, view.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glm::vec2 center = view.getCenter();
+        float halfExtent = 1.0f / view.getScale();
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                if (cache.contains(key))
+                    continue;
+
+                glm::vec4 r = pyramid.tileRect(key);
+                glm::vec2 tileCenter((r.x + r.z) * 0.5f, (r.y + r.w) * 0.5f);
+                TileRequest request;
+                request.key = key;
+                request.priority = t + levelWeight * std::abs(level - currentLevel) +
+                                   distanceWeight * glm::length(tileCenter - center) / halfExtent;
+                requests.push_back(request);
+            }
+        }
+    }
+};
+
+// GPU copy of the overview image; covers the whole image extent
+class OverviewTexture {
+public:
+    GLuint texture = 0;
+    std::string source;
+
+    void upload(const OverviewImage& overview) {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, overview.width, overview.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, overview.pixels.data());
+        source = overview.source;
+        printf("Overview: %s, %d x %d\n", source.c_str(), overview.width, overview.height);
+    }
+
+    bool isValid() const { return texture != 0; }
+
+    void destroy() {
+        if (texture)
+            glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+};
+
+// Draws each visible tile from its own texture, the matching part of the nearest resident ancestor,
+// or, while no ancestor is resident yet, the matching part of the overview
+class TileRenderer {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 tileRect;  // world x0, y0, x1, y1
+uniform vec4 uvRect;    // u0, v0 (top-left), u1, v1 (bottom-right)
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(tileRect.xw, tileRect.zy, corner), 0.0, 1.0);
+    texCoord = mix(uvRect.xy, uvRect.zw, corner);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO;
+    GLint tileRectLoc, uvRectLoc;
+    int holes = 0;
+    int overviewDraws = 0;
+    int draws = 0;
+
+    void init(Camera* camera) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        tileRectLoc = glGetUniformLocation(shaderProgram, "tileRect");
+        uvRectLoc = glGetUniformLocation(shaderProgram, "uvRect");
+        // Corners come from gl_VertexID; the VAO only has to exist
+        glGenVertexArrays(1, &VAO);
+    }
+
+    void render(const Camera& camera, const TilePyramid& pyramid, TileCache& cache, const OverviewTexture& overview, int level, int frame) {
+        holes = 0;
+        overviewDraws = 0;
+        draws = 0;
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, camera.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        // Whole image extent, for mapping tiles into the overview
+        TileKey root;
+        root.level = pyramid.levelCount() - 1;
+        glm::vec4 imageRect = pyramid.tileRect(root);
+
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                glm::vec4 rect = pyramid.tileRect(key);
+
+                // Walk up until a resident ancestor covers this tile
+                TileKey source = key;
+                TileCache::Entry* entry = cache.find(source);
+                if (!entry)
+                    ++holes;
+                while (!entry && source.level + 1 < pyramid.levelCount()) {
+                    source = source.parent();
+                    entry = cache.find(source);
+                }
+
+                GLuint texture;
+                glm::vec4 sourceRect;
+                if (entry) {
+                    entry->lastUsedFrame = frame;
+                    entry->drawn = true;
+                    texture = entry->texture;
+                    sourceRect = pyramid.tileRect(source);
+                } else if (overview.isValid()) {
+                    ++overviewDraws;
+                    texture = overview.texture;
+                    sourceRect = imageRect;
+                } else {
+                    continue;
+                }
+
+                // Part of the source covered by this tile, in the source's texel space
+                float u0 = (rect.x - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float u1 = (rect.z - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float v0 = (sourceRect.w - rect.w) / (sourceRect.w - sourceRect.y);
+                float v1 = (sourceRect.w - rect.y) / (sourceRect.w - sourceRect.y);
+
+                glBindTexture(GL_TEXTURE_2D, texture);
+                glUniform4f(tileRectLoc, rect.x, rect.y, rect.z, rect.w);
+                glUniform4f(uvRectLoc, u0, v0, u1, v1);
+                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+                ++draws;
+            }
+        }
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+    }
+};
+
+int main(int argc, char** argv) {
+    std::string imagePath = argc > 1 ? argv[1] : "src/textures/assets/test_nb.png";
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Time-to-first-pixel is measured from here: opening the file
+    double openTime = glfwGetTime();
+
+    TilePyramid pyramid;
+    if (!pyramid.open(imagePath)) {
+        glfwTerminate();
+        return -1;
+    }
+
+    OverviewImage overviewImage;
+    OverviewTexture overview;
+    if (loadOverview(imagePath, overviewImage))
+        overview.upload(overviewImage);
+    bool overviewCached = overviewImage.source == "cached overview";
+
+    // Full decode in the background; the first decode also caches an overview for next time
+    std::thread decodeThread([&pyramid, imagePath, overviewCached]() {
+        if (!pyramid.decode() || overviewCached)
+            return;
+        OverviewImage cached;
+        int level = pyramid.overviewLevel(overviewMaxSize);
+        cached.width = pyramid.levelWidth(level);
+        cached.height = pyramid.levelHeight(level);
+        cached.pixels = pyramid.levelPixels(level);
+        writeCachedOverview(imagePath, cached);
+    });
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    TileRequestQueue queue;
+    TileLoaderPool loaders;
+    bool loadersStarted = false;
+    TileCache cache;
+    Prefetcher prefetcher;
+    TileRenderer renderer;
+    renderer.init(&camera);
+
+    std::vector<TileRequest> requests;
+    bool prefetchKeyDown = false;
+    double firstPixelTime = -1.0;
+    double fullResolutionTime = -1.0;
+    std::string firstPixelSource;
+    int frame = 0;
+    double lastTitleTime = glfwGetTime();
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool prefetchKeyPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+        if (prefetchKeyPressed && !prefetchKeyDown)
+            prefetcher.enabled = !prefetcher.enabled;
+        prefetchKeyDown = prefetchKeyPressed;
+
+        camera.updateMotion(glfwGetTime());
+
+        // Tiles can only be cut once the full decode is done; until then the overview carries the view
+        if (!loadersStarted && pyramid.isReady()) {
+            loaders.start(&pyramid, &queue);
+            loadersStarted = true;
+        }
+        if (loadersStarted) {
+            prefetcher.collect(camera, pyramid, cache, width, height, requests);
+            queue.submitFrame(requests);
+
+            for (const LoadedTile& tile : loaders.takeCompleted(maxUploadsPerFrame)) {
+                cache.upload(tile, frame);
+                queue.delivered(tile.key);
+            }
+        }
+
+        int level = pyramid.selectLevel(camera, width, height);
+        camera.publish(width, height);
+        renderer.render(camera, pyramid, cache, overview, level, frame);
+        cache.evict(frame);
+
+        glfwSwapBuffers(window);
+
+        if (firstPixelTime < 0.0 && renderer.draws > 0) {
+            // Wait for the frame to actually reach the screen before stopping the clock
+            glFinish();
+            firstPixelTime = glfwGetTime() - openTime;
+            firstPixelSource = renderer.overviewDraws > 0 ? overview.source : "pyramid tiles";
+            printf("Time to first pixel: %.1f ms (%s)\n", firstPixelTime * 1000.0, firstPixelSource.c_str());
+        }
+        if (fullResolutionTime < 0.0 && pyramid.isReady() && renderer.draws > 0 && renderer.holes == 0) {
+            fullResolutionTime = glfwGetTime() - openTime;
+            printf("Time to full resolution: %.1f ms\n", fullResolutionTime * 1000.0);
+        }
+
+        double now = glfwGetTime();
+        if (now - lastTitleTime > 0.5) {
+            char firstPixel[64] = "-", fullResolution[32] = "-";
+            if (firstPixelTime >= 0.0)
+                snprintf(firstPixel, sizeof(firstPixel), "%.1f ms (%s)", firstPixelTime * 1000.0, firstPixelSource.c_str());
+            if (fullResolutionTime >= 0.0)
+                snprintf(fullResolution, sizeof(fullResolution), "%.1f ms", fullResolutionTime * 1000.0);
+            char title[200];
+            snprintf(title, sizeof(title), "OpenGL - level %d, first pixel %s, full resolution %s, holes %d, from overview %d",
+                     level, firstPixel, fullResolution, renderer.holes, renderer.overviewDraws);
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+        }
+
+        glfwPollEvents();
+        ++frame;
+    }
+
+    decodeThread.join();
+    if (loadersStarted)
+        loaders.stop();
+    renderer.destroy();
+    overview.destroy();
+    cache.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,1415 @@
+// tiled pyramid viewer whose decoded tiles are shared with every other viewer on the host
+// Several viewers open on the same imagery (side-by-side comparisons, a second window on another monitor)
+// each decode the same tiles. Here the decoded RGBA tiles go into a named shared-memory segment instead:
+//   - the first viewer creates the segment, later ones attach to it by name; the last one to exit removes it
+//   - before decoding, a loader looks the tile up in the segment without taking any lock and pins the slot
+//     on a hit; the main thread uploads straight from shared memory and unpins
+//   - a tile decoded after a miss is published to the segment; when a tile's ways are full an unpinned slot
+//     is recycled by a clock (second chance) sweep, so tiles any viewer keeps using stay resident
+// Tiles are matched by image identity (absolute path, size, modification time) and tile key, so viewers on
+// different images share the segment without mixing their tiles up.
+// Run two or more instances on the same image; the title shows the attached viewers, slot use and the hit
+// rate of this viewer next to that of all viewers together.
+// Usage: tile_shared_cache [image] [--segment name] [--no-shared]   Keys: WASD pan, Q/E zoom, Z zoom sweep, P prefetch.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <cstdlib>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <tiffio.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+const int tileSize = 128;
+
+// Level of Detail (LOD) bias, typically in the range -0.5 to 0.5
+float lodBias = 0.0f;
+
+// Loader configuration: decoder thread count
+const int loaderThreadCount = 2;
+
+// GPU tile cache budget (tiles) and upload throttle (tiles per frame)
+const size_t gpuTileBudget = 192;
+const int maxUploadsPerFrame = 8;
+
+// Shared cache: slots (one tile each, 64 KB at 128 x 128), how many of them a tile may occupy, default name
+const uint32_t sharedCacheSlots = 2048;
+const uint32_t sharedCacheWays = 8;
+const char* defaultSegmentName = "iorp_tiles";
+
+// Prediction: how far ahead the camera path is extrapolated, and the sampling step along it (seconds)
+const float predictionHorizon = 0.6f;
+const float predictionStep = 0.1f;
+// Time constant of the velocity smoothing (seconds)
+const float velocitySmoothing = 0.15f;
+// Zoom rates below this (ln(scale) per second) are treated as "not zooming"
+const float zoomRateThreshold = 0.05f;
+
+// Priority weights: seconds-equivalent cost of one level away from the current LOD / of one half view extent
+const float levelWeight = 0.5f;
+const float distanceWeight = 0.1f;
+
+// Z key: zoom in by this many levels over this many frames
+const int zoomSweepLevels = 5;
+const int zoomSweepFrames = 30;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+// Identifies one tile of the pyramid
+struct TileKey {
+    int level = 0, x = 0, y = 0;
+
+    uint64_t packed() const {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+    }
+    TileKey parent() const {
+        TileKey p;
+        p.level = level + 1;
+        p.x = x / 2;
+        p.y = y / 2;
+        return p;
+    }
+};
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f), velocity(0.0f, 0.0f), zoomRate(0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    void zoomBy(float factor) {
+        scale *= factor;
+    }
+
+    // Measures how fast offset and scale changed since the last call, smoothed exponentially
+    void updateMotion(double now) {
+        if (lastTime < 0.0) {
+            lastTime = now;
+            lastOffset = offset;
+            lastScale = scale;
+            return;
+        }
+        float dt = static_cast<float>(now - lastTime);
+        if (dt <= 0.0f)
+            return;
+
+        glm::vec2 instantVelocity = (offset - lastOffset) / dt;
+        float instantZoomRate = std::log(scale / lastScale) / dt;
+        float alpha = 1.0f - std::exp(-dt / velocitySmoothing);
+        velocity += (instantVelocity - velocity) * alpha;
+        zoomRate += (instantZoomRate - zoomRate) * alpha;
+
+        lastTime = now;
+        lastOffset = offset;
+        lastScale = scale;
+    }
+
+    // Camera extrapolated t seconds ahead along the current pan/zoom motion
+    Camera predicted(float t) const {
+        Camera c = *this;
+        c.offset = offset + velocity * t;
+        c.scale = scale * std::exp(zoomRate * t);
+        return c;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    glm::vec2 getCenter() const { return -offset; }
+    float getScale() const { return scale; }
+    float getZoomRate() const { return zoomRate; }
+    glm::vec2 getVelocity() const { return velocity; }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    glm::vec2 velocity;   // world units per second (of offset)
+    float zoomRate;       // d ln(scale) / dt
+    double lastTime = -1.0;
+    glm::vec2 lastOffset;
+    float lastScale = 1.0f;
+    GLuint ubo = 0;
+};
+
+// Shared-memory tile cache. Layout of the segment: a header, then slotCount slots of slotBytes each, every
+// slot a SharedSlot followed by one tile of RGBA pixels. All cross-process state is lock-free atomics, so
+// the layout only works with address-free atomics of these sizes.
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free");
+
+const uint32_t sharedCacheMagic = 0x49545343;   // "ITSC"
+const uint32_t sharedCacheVersion = 1;
+
+// Slot state: 0 empty, slotWriting while one process fills it, otherwise 1 + the number of pins
+const uint32_t slotEmpty = 0;
+const uint32_t slotReady = 1;
+const uint32_t slotWriting = 0x80000000u;
+
+struct SharedCacheHeader {
+    std::atomic<uint32_t> magic;          // sharedCacheMagic once the creating process has filled in the rest
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotBytes;
+    std::atomic<uint32_t> attached;       // processes mapping the segment right now
+    std::atomic<uint64_t> hits;           // counters summed over every process that ever attached
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> inserts;
+    std::atomic<uint64_t> evictions;
+};
+
+struct SharedSlot {
+    std::atomic<uint32_t> state;
+    std::atomic<uint32_t> referenced;     // clock bit: set on every hit, cleared as the eviction hand passes
+    std::atomic<uint64_t> dataset;        // identifies the image (datasetId)
+    std::atomic<uint64_t> tile;           // TileKey::packed()
+    int32_t width;
+    int32_t height;
+};
+
+const size_t sharedHeaderBytes = (sizeof(SharedCacheHeader) + 63) / 64 * 64;
+const size_t sharedSlotHeaderBytes = (sizeof(SharedSlot) + 63) / 64 * 64;
+
+// Identifies an image across processes: absolute path, size and modification time
+uint64_t datasetId(const std::string& path) {
+    std::error_code error;
+    std::string identity = std::filesystem::absolute(path, error).string();
+    identity += '|' + std::to_string(std::filesystem::file_size(path, error));
+    identity += '|' + std::to_string(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+    uint64_t hash = 14695981039346656037ull;   // FNV-1a
+    for (unsigned char c : identity)
+        hash = (hash ^ c) * 1099511628211ull;
+    return hash;
+}
+
+// Tile cache in a named shared-memory segment (POSIX shm_open, or a named file mapping on Windows) that every
+// viewer on the host attaches to, so a tile decoded by one process is served to all of them.
+//   - set-associative: a tile can live in any of the sharedCacheWays slots after its hash; lookups probe
+//     those slots without taking any lock
+//   - pins: a hit increments the slot's reference count, and a slot is only ever reclaimed from the
+//     unpinned ready state, so pixels stay valid until the holder unpins them (from any thread)
+//   - eviction: a clock (second chance) over the slot's ways; a hit sets the referenced bit, the hand clears
+//     it once before the slot may go
+// A process that dies while holding a pin or writing a slot leaves that slot unusable until the segment is
+// recreated; the last process to detach removes the segment.
+class SharedTileCache {
+public:
+    struct Stats {
+        long long hits = 0, misses = 0, inserts = 0, evictions = 0;
+        long long full = 0;   // inserts dropped because every way was pinned or being written
+    };
+
+    SharedTileCache() = default;
+    SharedTileCache(const SharedTileCache&) = delete;
+    SharedTileCache& operator=(const SharedTileCache&) = delete;
+    ~SharedTileCache() { detach(); }
+
+    // Creates the segment or attaches to the one another viewer created with the same name
+    bool attach(const std::string& name, uint32_t slotCount) {
+        detach();
+        uint32_t slotBytes = static_cast<uint32_t>(sharedSlotHeaderBytes + static_cast<size_t>(tileSize) * tileSize * 4);
+        size_t size = sharedHeaderBytes + static_cast<size_t>(slotCount) * slotBytes;
+        bool creator = false;
+#ifdef _WIN32
+        std::string mappingName = "Local\\" + name;
+        m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                       static_cast<DWORD>(size & 0xFFFFFFFFu), mappingName.c_str());
+        if (!m_mapping)
+            return false;
+        creator = GetLastError() != ERROR_ALREADY_EXISTS;
+        void* data = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        MEMORY_BASIC_INFORMATION region;
+        if (!data || VirtualQuery(data, &region, sizeof(region)) == 0 || region.RegionSize < size) {
+            if (data)
+                std::cerr << "Shared tile cache " << name << " exists with a different size" << std::endl;
+            m_base = static_cast<unsigned char*>(data);
+            unmap();
+            return false;
+        }
+#else
+        std::string segmentName = "/" + name;
+        int fd = shm_open(segmentName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            creator = true;
+            if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+                ::close(fd);
+                shm_unlink(segmentName.c_str());
+                return false;
+            }
+        } else {
+            if (errno != EEXIST)
+                return false;
+            fd = shm_open(segmentName.c_str(), O_RDWR, 0600);
+            if (fd < 0)
+                return false;
+            // The creator may not have sized the segment yet
+            struct stat info;
+            for (int attempt = 0; attempt < 200 && (fstat(fd, &info) != 0 || info.st_size == 0); ++attempt)
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if (static_cast<size_t>(info.st_size) != size) {
+                std::cerr << "Shared tile cache " << name << " exists with a different size" << std::endl;
+                ::close(fd);
+                return false;
+            }
+        }
+        void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);   // the mapping keeps the segment referenced
+        if (data == MAP_FAILED) {
+            if (creator)
+                shm_unlink(segmentName.c_str());
+            return false;
+        }
+        m_segmentName = segmentName;
+#endif
+        m_base = static_cast<unsigned char*>(data);
+        m_size = size;
+        m_header = reinterpret_cast<SharedCacheHeader*>(m_base);
+
+        // A new segment is zero-filled, which is every slot empty; only the header needs writing
+        if (creator) {
+            m_header->version = sharedCacheVersion;
+            m_header->slotCount = slotCount;
+            m_header->slotBytes = slotBytes;
+            m_header->magic.store(sharedCacheMagic, std::memory_order_release);
+        } else {
+            for (int attempt = 0; attempt < 200 && m_header->magic.load(std::memory_order_acquire) != sharedCacheMagic; ++attempt)
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if (m_header->magic.load(std::memory_order_acquire) != sharedCacheMagic || m_header->version != sharedCacheVersion ||
+                m_header->slotCount != slotCount || m_header->slotBytes != slotBytes) {
+                std::cerr << "Shared tile cache " << name << " has an incompatible layout" << std::endl;
+                unmap();
+                return false;
+            }
+        }
+        m_header->attached.fetch_add(1);
+        m_slotCount = slotCount;
+        m_slotBytes = slotBytes;
+        printf("Shared tile cache %s: %s, %u slots, %.1f MB, %u processes attached\n", name.c_str(),
+               creator ? "created" : "attached", slotCount, size / 1048576.0, m_header->attached.load());
+        return true;
+    }
+
+    void detach() {
+        if (!m_header)
+            return;
+        bool last = m_header->attached.fetch_sub(1) == 1;
+        unmap();
+#ifndef _WIN32
+        // Windows removes a named mapping with its last handle; a POSIX segment outlives its processes
+        if (last)
+            shm_unlink(m_segmentName.c_str());
+#else
+        (void)last;
+#endif
+    }
+
+    bool isAttached() const { return m_header != nullptr; }
+
+    // Pins the slot holding a tile; returns its index, or -1 on a miss. Lock-free.
+    int pin(uint64_t dataset, const TileKey& key) {
+        uint64_t tile = key.packed();
+        uint32_t first = firstWay(dataset, tile);
+        for (uint32_t way = 0; way < sharedCacheWays; ++way) {
+            uint32_t index = (first + way) % m_slotCount;
+            SharedSlot& slot = *slotAt(index);
+            uint32_t state = slot.state.load(std::memory_order_acquire);
+            if (state == slotEmpty || (state & slotWriting) ||
+                slot.dataset.load(std::memory_order_relaxed) != dataset || slot.tile.load(std::memory_order_relaxed) != tile)
+                continue;
+            // Pin, unless the slot is being reclaimed in the meantime
+            while (state != slotEmpty && !(state & slotWriting) &&
+                   !slot.state.compare_exchange_weak(state, state + 1, std::memory_order_acquire)) {
+            }
+            if (state == slotEmpty || (state & slotWriting))
+                continue;
+            // It may have been refilled with another tile between the key check and the pin
+            if (slot.dataset.load(std::memory_order_relaxed) != dataset || slot.tile.load(std::memory_order_relaxed) != tile) {
+                unpin(static_cast<int>(index));
+                continue;
+            }
+            slot.referenced.store(1, std::memory_order_relaxed);
+            ++m_stats.hits;
+            m_header->hits.fetch_add(1, std::memory_order_relaxed);
+            return static_cast<int>(index);
+        }
+        ++m_stats.misses;
+        m_header->misses.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+
+    void unpin(int index) {
+        slotAt(static_cast<uint32_t>(index))->state.fetch_sub(1, std::memory_order_release);
+    }
+
+    // Pixels and size of a pinned slot
+    const unsigned char* pixels(int index) const {
+        return reinterpret_cast<const unsigned char*>(slotAt(static_cast<uint32_t>(index))) + sharedSlotHeaderBytes;
+    }
+    int width(int index) const { return slotAt(static_cast<uint32_t>(index))->width; }
+    int height(int index) const { return slotAt(static_cast<uint32_t>(index))->height; }
+
+    // Publishes a decoded tile (width * 4 byte rows). Claims an empty way if there is one, otherwise the
+    // first unpinned way the clock hand finds unreferenced. Gives up if every way is pinned or being written.
+    void insert(uint64_t dataset, const TileKey& key, const unsigned char* data, int width, int height) {
+        uint64_t tile = key.packed();
+        uint32_t first = firstWay(dataset, tile);
+        for (uint32_t way = 0; way < sharedCacheWays; ++way) {
+            SharedSlot& slot = *slotAt((first + way) % m_slotCount);
+            uint32_t state = slot.state.load(std::memory_order_acquire);
+            if (state != slotEmpty && !(state & slotWriting) &&
+                slot.dataset.load(std::memory_order_relaxed) == dataset && slot.tile.load(std::memory_order_relaxed) == tile)
+                return;   // another process got there first
+        }
+
+        int claimed = -1;
+        bool evicted = false;
+        // Two sweeps: the first may only clear referenced bits that the second then finds clear
+        for (uint32_t step = 0; step < 2 * sharedCacheWays && claimed < 0; ++step) {
+            uint32_t index = (first + step % sharedCacheWays) % m_slotCount;
+            SharedSlot& slot = *slotAt(index);
+            uint32_t state = slot.state.load(std::memory_order_acquire);
+            if (state == slotEmpty) {
+                if (slot.state.compare_exchange_strong(state, slotWriting, std::memory_order_acquire))
+                    claimed = static_cast<int>(index);
+            } else if (state == slotReady) {
+                if (slot.referenced.exchange(0, std::memory_order_relaxed) != 0)
+                    continue;
+                if (slot.state.compare_exchange_strong(state, slotWriting, std::memory_order_acquire)) {
+                    claimed = static_cast<int>(index);
+                    evicted = true;
+                }
+            }
+        }
+        if (claimed < 0) {
+            ++m_stats.full;
+            return;
+        }
+
+        SharedSlot& slot = *slotAt(static_cast<uint32_t>(claimed));
+        slot.dataset.store(dataset, std::memory_order_relaxed);
+        slot.tile.store(tile, std::memory_order_relaxed);
+        slot.width = width;
+        slot.height = height;
+        memcpy(reinterpret_cast<unsigned char*>(&slot) + sharedSlotHeaderBytes, data, static_cast<size_t>(width) * height * 4);
+        slot.referenced.store(1, std::memory_order_relaxed);
+        slot.state.store(slotReady, std::memory_order_release);
+
+        ++m_stats.inserts;
+        m_header->inserts.fetch_add(1, std::memory_order_relaxed);
+        if (evicted) {
+            ++m_stats.evictions;
+            m_header->evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Stats getStats() const {
+        Stats stats;
+        stats.hits = m_stats.hits;
+        stats.misses = m_stats.misses;
+        stats.inserts = m_stats.inserts;
+        stats.evictions = m_stats.evictions;
+        stats.full = m_stats.full;
+        return stats;
+    }
+
+    // Counters of all processes together
+    Stats getSegmentStats() const {
+        Stats stats;
+        stats.hits = static_cast<long long>(m_header->hits.load());
+        stats.misses = static_cast<long long>(m_header->misses.load());
+        stats.inserts = static_cast<long long>(m_header->inserts.load());
+        stats.evictions = static_cast<long long>(m_header->evictions.load());
+        return stats;
+    }
+
+    uint32_t attachedProcesses() const { return m_header->attached.load(); }
+    uint32_t slotCount() const { return m_slotCount; }
+
+    uint32_t usedSlots() const {
+        uint32_t used = 0;
+        for (uint32_t i = 0; i < m_slotCount; ++i)
+            used += slotAt(i)->state.load(std::memory_order_relaxed) != slotEmpty;
+        return used;
+    }
+
+private:
+    struct LocalStats {
+        std::atomic<long long> hits{ 0 }, misses{ 0 }, inserts{ 0 }, evictions{ 0 }, full{ 0 };
+    };
+
+    unsigned char* m_base = nullptr;
+    size_t m_size = 0;
+    SharedCacheHeader* m_header = nullptr;
+    uint32_t m_slotCount = 0;
+    uint32_t m_slotBytes = 0;
+    LocalStats m_stats;
+#ifdef _WIN32
+    HANDLE m_mapping = nullptr;
+#else
+    std::string m_segmentName;
+#endif
+
+    SharedSlot* slotAt(uint32_t index) const {
+        return reinterpret_cast<SharedSlot*>(m_base + sharedHeaderBytes + static_cast<size_t>(index) * m_slotBytes);
+    }
+
+    uint32_t firstWay(uint64_t dataset, uint64_t tile) const {
+        uint64_t hash = (dataset ^ (tile * 0x9E3779B97F4A7C15ull)) * 0xFF51AFD7ED558CCDull;
+        return static_cast<uint32_t>((hash ^ (hash >> 32)) % m_slotCount);
+    }
+
+    void unmap() {
+#ifdef _WIN32
+        if (m_base)
+            UnmapViewOfFile(m_base);
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        m_mapping = nullptr;
+#else
+        if (m_base)
+            munmap(m_base, m_size);
+#endif
+        m_base = nullptr;
+        m_header = nullptr;
+        m_size = 0;
+    }
+};
+
+void appendBytes(void* context, void* data, int size) {
+    std::vector<unsigned char>* out = static_cast<std::vector<unsigned char>*>(context);
+    out->insert(out->end(), static_cast<unsigned char*>(data), static_cast<unsigned char*>(data) + size);
+}
+
+// RGBA decode of a whole image; TIFFs go through libtiff, everything else through stb_image
+bool decodeImage(const std::string& path, std::vector<unsigned char>& pixels, int& width, int& height) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".tif" || extension == ".tiff") {
+        TIFF* tif = TIFFOpen(path.c_str(), "r");
+        if (!tif)
+            return false;
+        uint32_t w = 0, h = 0;
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &w);
+        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &h);
+        pixels.resize(static_cast<size_t>(w) * h * 4);
+        bool ok = TIFFReadRGBAImageOriented(tif, w, h, reinterpret_cast<uint32_t*>(pixels.data()), ORIENTATION_TOPLEFT, 0) != 0;
+        TIFFClose(tif);
+        width = static_cast<int>(w);
+        height = static_cast<int>(h);
+        return ok;
+    }
+    int nrChannels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha);
+    if (!data)
+        return false;
+    pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(data);
+    return true;
+}
+
+// Image plus its reduced levels, each tile stored as PNG and decoded when requested.
+// World mapping keeps the aspect ratio: x spans [-1, 1], y spans [-h/w, h/w], row 0 at the top.
+class TilePyramid {
+public:
+    bool load(const std::string& imagePath) {
+        int width, height;
+        std::vector<unsigned char> pixels;
+        if (!decodeImage(imagePath, pixels, width, height)) {
+            std::cerr << "Failed to load texture" << std::endl;
+            return false;
+        }
+
+        for (;;) {
+            Level level;
+            level.width = width;
+            level.height = height;
+            encodeTiles(pixels, level);
+            m_levels.push_back(std::move(level));
+
+            // Halve until the whole level fits in one tile
+            if (width <= tileSize && height <= tileSize)
+                break;
+            int halfWidth = (width + 1) / 2, halfHeight = (height + 1) / 2;
+            std::vector<unsigned char> half;
+            downsample(pixels, width, height, half, halfWidth, halfHeight);
+            pixels.swap(half);
+            width = halfWidth;
+            height = halfHeight;
+        }
+
+        printf("Image size: %d x %d, levels: %d, tile size: %d, %s tiles: %.2f MB (%.1f%% of raw)\n",
+               levelWidth(0), levelHeight(0), levelCount(), tileSize, "PNG",
+               storedBytes() / 1048576.0, 100.0 * storedBytes() / rawBytes());
+        return true;
+    }
+
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    int levelWidth(int level) const { return m_levels[level].width; }
+    int levelHeight(int level) const { return m_levels[level].height; }
+    int tilesX(int level) const { return (levelWidth(level) + tileSize - 1) / tileSize; }
+    int tilesY(int level) const { return (levelHeight(level) + tileSize - 1) / tileSize; }
+
+    bool isValid(const TileKey& key) const {
+        return key.level >= 0 && key.level < levelCount() &&
+               key.x >= 0 && key.x < tilesX(key.level) && key.y >= 0 && key.y < tilesY(key.level);
+    }
+
+    // Encoded size of all tiles, and the size they would take as plain RGBA
+    size_t storedBytes() const {
+        size_t bytes = 0;
+        for (const Level& level : m_levels)
+            for (const std::vector<unsigned char>& tile : level.tiles)
+                bytes += tile.size();
+        return bytes;
+    }
+
+    size_t rawBytes() const {
+        size_t bytes = 0;
+        for (const Level& level : m_levels)
+            bytes += static_cast<size_t>(level.width) * level.height * 4;
+        return bytes;
+    }
+
+    // Decodes one tile into a caller-provided buffer of at least tileSize * tileSize * 4 bytes (thread-safe)
+    void readTile(const TileKey& key, unsigned char* pixels, int& width, int& height) const {
+        const Level& level = m_levels[key.level];
+        const std::vector<unsigned char>& encoded = level.tiles[static_cast<size_t>(key.y) * tilesX(key.level) + key.x];
+        width = std::min(tileSize, level.width - key.x * tileSize);
+        height = std::min(tileSize, level.height - key.y * tileSize);
+
+        int decodedWidth = 0, decodedHeight = 0, channels = 0;
+        unsigned char* decoded = stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()),
+                                                       &decodedWidth, &decodedHeight, &channels, 4);
+        if (decoded && decodedWidth == width && decodedHeight == height)
+            memcpy(pixels, decoded, static_cast<size_t>(width) * height * 4);
+        else
+            memset(pixels, 0, static_cast<size_t>(width) * height * 4);
+        stbi_image_free(decoded);
+    }
+
+    // World units per level-0 pixel
+    float worldPerPixel() const { return 2.0f / m_levels[0].width; }
+
+    // World-space rectangle of a tile (min.x, min.y, max.x, max.y)
+    glm::vec4 tileRect(const TileKey& key) const {
+        int width0 = m_levels[0].width, height0 = m_levels[0].height;
+        int px0 = std::min(key.x * tileSize << key.level, width0);
+        int py0 = std::min(key.y * tileSize << key.level, height0);
+        int px1 = std::min((key.x + 1) * tileSize << key.level, width0);
+        int py1 = std::min((key.y + 1) * tileSize << key.level, height0);
+        float p = worldPerPixel();
+        float top = height0 * p * 0.5f;
+        return glm::vec4(px0 * p - 1.0f, top - py1 * p, px1 * p - 1.0f, top - py0 * p);
+    }
+
+    // Level whose texel density best matches the screen for this camera
+    int selectLevel(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        float texelsPerScreenPixel = 1.0f / (worldPerPixel() * screenPixelsPerWorld);
+        int level = static_cast<int>(std::floor(std::log2(std::max(texelsPerScreenPixel, 1e-6f)) + lodBias));
+        return std::max(0, std::min(level, levelCount() - 1));
+    }
+
+    // Continuous level (before flooring), used to predict level switches
+    float levelPosition(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        return std::log2(1.0f / (worldPerPixel() * screenPixelsPerWorld)) + lodBias;
+    }
+
+    // Range of tiles of a level that intersect a world rectangle; false if none
+    bool tileRange(int level, const glm::vec4& rect, int& x0, int& y0, int& x1, int& y1) const {
+        float p = worldPerPixel() * static_cast<float>(1 << level) * tileSize;  // world size of one tile
+        float top = m_levels[0].height * worldPerPixel() * 0.5f;
+        x0 = std::max(0, static_cast<int>(std::floor((rect.x + 1.0f) / p)));
+        x1 = std::min(tilesX(level) - 1, static_cast<int>(std::floor((rect.z + 1.0f) / p)));
+        y0 = std::max(0, static_cast<int>(std::floor((top - rect.w) / p)));
+        y1 = std::min(tilesY(level) - 1, static_cast<int>(std::floor((top - rect.y) / p)));
+        return x0 <= x1 && y0 <= y1;
+    }
+
+private:
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<std::vector<unsigned char>> tiles;   // encoded bytes, row-major
+    };
+    std::vector<Level> m_levels;
+
+    void encodeTiles(const std::vector<unsigned char>& pixels, Level& level) const {
+        int countX = (level.width + tileSize - 1) / tileSize;
+        int countY = (level.height + tileSize - 1) / tileSize;
+        level.tiles.resize(static_cast<size_t>(countX) * countY);
+        for (int ty = 0; ty < countY; ++ty) {
+            for (int tx = 0; tx < countX; ++tx) {
+                int width = std::min(tileSize, level.width - tx * tileSize);
+                int height = std::min(tileSize, level.height - ty * tileSize);
+                const unsigned char* origin = pixels.data() +
+                    (static_cast<size_t>(ty) * tileSize * level.width + static_cast<size_t>(tx) * tileSize) * 4;
+                stbi_write_png_to_func(appendBytes, &level.tiles[static_cast<size_t>(ty) * countX + tx],
+                                       width, height, 4, origin, level.width * 4);
+            }
+        }
+    }
+
+    static void downsample(const std::vector<unsigned char>& src, int srcWidth, int srcHeight,
+                           std::vector<unsigned char>& dst, int dstWidth, int dstHeight) {
+        dst.resize(static_cast<size_t>(dstWidth) * dstHeight * 4);
+        for (int y = 0; y < dstHeight; ++y) {
+            int sy0 = 2 * y, sy1 = std::min(2 * y + 1, srcHeight - 1);
+            for (int x = 0; x < dstWidth; ++x) {
+                int sx0 = 2 * x, sx1 = std::min(2 * x + 1, srcWidth - 1);
+                for (int c = 0; c < 4; ++c) {
+                    int sum = src[(static_cast<size_t>(sy0) * srcWidth + sx0) * 4 + c] +
+                              src[(static_cast<size_t>(sy0) * srcWidth + sx1) * 4 + c] +
+                              src[(static_cast<size_t>(sy1) * srcWidth + sx0) * 4 + c] +
+                              src[(static_cast<size_t>(sy1) * srcWidth + sx1) * 4 + c];
+                    dst[(static_cast<size_t>(y) * dstWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+};
+
+// One tile wanted by the renderer or the prefetcher; lower priority values are served first
+struct TileRequest {
+    TileKey key;
+    float priority = 0.0f;
+};
+
+// Decoded tile, tightly packed (width * 4 bytes per row), or a pinned slot of the shared cache holding it
+struct LoadedTile {
+    TileKey key;
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;
+    int sharedSlot = -1;
+};
+
+// Scheduler between the renderer and the decoders.
+// - Duplicates merge: a key requested several times in a frame, or again while pending or in flight, is
+//   one piece of work that keeps the best priority it was given.
+// - Ordering: pending work is kept sorted by priority, workers always take the most urgent tile.
+// - Cancellation: every frame submits the complete set of tiles it still wants; pending requests missing
+//   from that set are dropped before any decoder picks them up.
+class TileRequestQueue {
+public:
+    struct Stats {
+        long long submitted = 0;   // requests received, duplicates included
+        long long merged = 0;      // requests folded into an existing entry
+        long long cancelled = 0;   // pending requests dropped as no longer wanted
+        long long started = 0;     // requests handed to a decoder
+    };
+
+    // Replaces the wanted set for this frame (requests may contain duplicates)
+    void submitFrame(const std::vector<TileRequest>& requests) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+
+        for (const TileRequest& request : requests) {
+            ++m_stats.submitted;
+            uint64_t id = request.key.packed();
+            auto it = m_entries.find(id);
+            if (it == m_entries.end()) {
+                Entry entry;
+                entry.key = request.key;
+                entry.priority = request.priority;
+                entry.generation = m_generation;
+                m_entries.emplace(id, entry);
+                m_order.insert(std::make_pair(request.priority, id));
+                continue;
+            }
+
+            ++m_stats.merged;
+            Entry& entry = it->second;
+            if (entry.state == State::InFlight)
+                continue;
+            // First sighting this frame takes the new priority; later duplicates only improve it
+            float priority = entry.generation == m_generation ? std::min(entry.priority, request.priority) : request.priority;
+            if (priority != entry.priority) {
+                m_order.erase(std::make_pair(entry.priority, id));
+                entry.priority = priority;
+                m_order.insert(std::make_pair(priority, id));
+            }
+            entry.generation = m_generation;
+        }
+
+        // Everything still pending but not asked for this frame is no longer visible or predicted
+        for (auto it = m_order.begin(); it != m_order.end();) {
+            Entry& entry = m_entries[it->second];
+            if (entry.generation != m_generation) {
+                m_entries.erase(it->second);
+                it = m_order.erase(it);
+                ++m_stats.cancelled;
+            }
+            else {
+                ++it;
+            }
+        }
+
+        m_wakeup.notify_all();
+    }
+
+    // Blocks until there is work; returns false on shutdown
+    bool pop(TileKey& key) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeup.wait(lock, [this] { return m_shutdown || !m_order.empty(); });
+        if (m_shutdown)
+            return false;
+        uint64_t id = m_order.begin()->second;
+        m_order.erase(m_order.begin());
+        Entry& entry = m_entries[id];
+        entry.state = State::InFlight;
+        key = entry.key;
+        ++m_stats.started;
+        return true;
+    }
+
+    // The tile reached the cache; later requests for it are the cache's business
+    void delivered(const TileKey& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.erase(key.packed());
+    }
+
+    void shutdown() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+        m_wakeup.notify_all();
+    }
+
+    size_t pendingCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_order.size();
+    }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    enum class State { Pending, InFlight };
+    struct Entry {
+        TileKey key;
+        State state = State::Pending;
+        float priority = 0.0f;
+        uint64_t generation = 0;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::unordered_map<uint64_t, Entry> m_entries;    // pending and in-flight
+    std::set<std::pair<float, uint64_t>> m_order;     // pending only, most urgent first
+    uint64_t m_generation = 0;
+    bool m_shutdown = false;
+    Stats m_stats;
+};
+
+// Decoder threads pulling from the request queue. With a shared cache attached, a tile another viewer has
+// already decoded comes back pinned in shared memory instead of being decoded again; a tile decoded here is
+// published for the others.
+class TileLoaderPool {
+public:
+    void start(const TilePyramid* pyramid, TileRequestQueue* queue, SharedTileCache* shared, uint64_t dataset) {
+        m_pyramid = pyramid;
+        m_queue = queue;
+        m_shared = shared;
+        m_dataset = dataset;
+        for (int i = 0; i < loaderThreadCount; ++i)
+            m_threads.emplace_back(&TileLoaderPool::workerThread, this);
+    }
+
+    std::vector<LoadedTile> takeCompleted(int maxCount) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<LoadedTile> result;
+        while (!m_completed.empty() && static_cast<int>(result.size()) < maxCount) {
+            result.push_back(std::move(m_completed.front()));
+            m_completed.pop_front();
+        }
+        return result;
+    }
+
+    void stop() {
+        m_queue->shutdown();
+        for (std::thread& thread : m_threads)
+            thread.join();
+        m_threads.clear();
+        for (const LoadedTile& tile : m_completed)
+            if (tile.sharedSlot >= 0)
+                m_shared->unpin(tile.sharedSlot);
+        m_completed.clear();
+    }
+
+private:
+    const TilePyramid* m_pyramid = nullptr;
+    TileRequestQueue* m_queue = nullptr;
+    SharedTileCache* m_shared = nullptr;
+    uint64_t m_dataset = 0;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::deque<LoadedTile> m_completed;
+
+    void workerThread() {
+        TileKey key;
+        while (m_queue->pop(key)) {
+            LoadedTile tile;
+            tile.key = key;
+            if (m_shared->isAttached())
+                tile.sharedSlot = m_shared->pin(m_dataset, key);
+            if (tile.sharedSlot >= 0) {
+                // Stays pinned until the main thread has uploaded it
+                tile.width = m_shared->width(tile.sharedSlot);
+                tile.height = m_shared->height(tile.sharedSlot);
+            } else {
+                tile.pixels.resize(static_cast<size_t>(tileSize) * tileSize * 4);
+                m_pyramid->readTile(key, tile.pixels.data(), tile.width, tile.height);
+                if (m_shared->isAttached())
+                    m_shared->insert(m_dataset, key, tile.pixels.data(), tile.width, tile.height);
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed.push_back(std::move(tile));
+        }
+    }
+};
+
+// GPU-resident tiles, evicted least-recently-used once over budget
+class TileCache {
+public:
+    struct Entry {
+        GLuint texture = 0;
+        int width = 0, height = 0;
+        int lastUsedFrame = 0;
+        bool drawn = false;
+    };
+
+    void upload(const TileKey& key, int width, int height, const unsigned char* pixels, int frame) {
+        Entry entry;
+        entry.width = width;
+        entry.height = height;
+        entry.lastUsedFrame = frame;
+
+        glGenTextures(1, &entry.texture);
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+        m_entries[key.packed()] = entry;
+        ++m_uploads;
+    }
+
+    Entry* find(const TileKey& key) {
+        auto it = m_entries.find(key.packed());
+        return it == m_entries.end() ? nullptr : &it->second;
+    }
+
+    bool contains(const TileKey& key) const { return m_entries.count(key.packed()) != 0; }
+
+    void evict(int currentFrame) {
+        if (m_entries.size() <= gpuTileBudget)
+            return;
+        std::vector<std::pair<int, uint64_t>> candidates;
+        for (const auto& item : m_entries)
+            if (item.second.lastUsedFrame < currentFrame)
+                candidates.emplace_back(item.second.lastUsedFrame, item.first);
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& candidate : candidates) {
+            if (m_entries.size() <= gpuTileBudget)
+                break;
+            Entry& victim = m_entries[candidate.second];
+            if (!victim.drawn)
+                ++m_unusedEvictions;
+            glDeleteTextures(1, &victim.texture);
+            m_entries.erase(candidate.second);
+        }
+    }
+
+    size_t size() const { return m_entries.size(); }
+    int getUploads() const { return m_uploads; }
+    int getUnusedEvictions() const { return m_unusedEvictions; }
+
+    void destroy() {
+        for (auto& item : m_entries)
+            glDeleteTextures(1, &item.second.texture);
+        m_entries.clear();
+    }
+
+private:
+    std::unordered_map<uint64_t, Entry> m_entries;
+    int m_uploads = 0;
+    int m_unusedEvictions = 0;   // decoded and uploaded, but evicted before ever being drawn
+};
+
+// Emits requests for the visible tiles and for the predicted camera path (duplicates are left to the queue).
+// priority = predicted seconds until visible + levelWeight * levels away from the current level
+//          + distanceWeight * distance from the view center (in half view extents)
+class Prefetcher {
+public:
+    bool enabled = true;
+
+    void collect(const Camera& camera, const TilePyramid& pyramid, const TileCache& cache,
+                 int framebufferWidth, int framebufferHeight, std::vector<TileRequest>& requests) {
+        requests.clear();
+        int currentLevel = pyramid.selectLevel(camera, framebufferWidth, framebufferHeight);
+
+        float horizon = enabled ? predictionHorizon : 0.0f;
+        for (float t = 0.0f; t <= horizon + 1e-4f; t += predictionStep) {
+            Camera future = camera.predicted(t);
+            int level = pyramid.selectLevel(future, framebufferWidth, framebufferHeight);
+            addRect(pyramid, cache, future, level, currentLevel, t, requests);
+        }
+
+        float zoomRate = camera.getZoomRate();
+        if (enabled && std::fabs(zoomRate) > zoomRateThreshold) {
+            float position = pyramid.levelPosition(camera, framebufferWidth, framebufferHeight);
+            float levelsPerSecond = zoomRate / std::log(2.0f);
+            int nextLevel = zoomRate > 0.0f ? currentLevel - 1 : currentLevel + 1;
+            float distanceToSwitch = zoomRate > 0.0f ? position - std::floor(position) : std::ceil(position) - position;
+            float timeToSwitch = distanceToSwitch / std::fabs(levelsPerSecond);
+            if (nextLevel >= 0 && nextLevel < pyramid.levelCount())
+                addRect(pyramid, cache, camera, nextLevel, currentLevel, timeToSwitch, requests);
+        }
+    }
+
+private:
+    void addRect(const TilePyramid& pyramid, const TileCache& cache, const Camera& view, int level, int currentLevel,
+                 float t, std::vector<TileRequest>& requests) {
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, view.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glm::vec2 center = view.getCenter();
+        float halfExtent = 1.0f / view.getScale();
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                if (cache.contains(key))
+                    continue;
+
+                glm::vec4 r = pyramid.tileRect(key);
+                glm::vec2 tileCenter((r.x + r.z) * 0.5f, (r.y + r.w) * 0.5f);
+                TileRequest request;
+                request.key = key;
+                request.priority = t + levelWeight * std::abs(level - currentLevel) +
+                                   distanceWeight * glm::length(tileCenter - center) / halfExtent;
+                requests.push_back(request);
+            }
+        }
+    }
+};
+
+// Draws each visible tile from its own texture, or the matching part of the nearest resident ancestor
+class TileRenderer {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 tileRect;  // world x0, y0, x1, y1
+uniform vec4 uvRect;    // u0, v0 (top-left), u1, v1 (bottom-right)
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(tileRect.xw, tileRect.zy, corner), 0.0, 1.0);
+    texCoord = mix(uvRect.xy, uvRect.zw, corner);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO;
+    GLint tileRectLoc, uvRectLoc;
+    int holes = 0;
+
+    void init(Camera* camera) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        tileRectLoc = glGetUniformLocation(shaderProgram, "tileRect");
+        uvRectLoc = glGetUniformLocation(shaderProgram, "uvRect");
+        // Corners come from gl_VertexID; the VAO only has to exist
+        glGenVertexArrays(1, &VAO);
+    }
+
+    void render(const Camera& camera, const TilePyramid& pyramid, TileCache& cache, int level, int frame) {
+        holes = 0;
+        int x0, y0, x1, y1;
+        if (!pyramid.tileRange(level, camera.getVisibleRect(), x0, y0, x1, y1))
+            return;
+
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                TileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                glm::vec4 rect = pyramid.tileRect(key);
+
+                // Walk up until a resident ancestor covers this tile
+                TileKey source = key;
+                TileCache::Entry* entry = cache.find(source);
+                if (!entry)
+                    ++holes;
+                while (!entry && source.level + 1 < pyramid.levelCount()) {
+                    source = source.parent();
+                    entry = cache.find(source);
+                }
+                if (!entry)
+                    continue;
+                entry->lastUsedFrame = frame;
+                entry->drawn = true;
+
+                // Part of the source tile covered by this tile, in the source's texel space
+                glm::vec4 sourceRect = pyramid.tileRect(source);
+                float u0 = (rect.x - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float u1 = (rect.z - sourceRect.x) / (sourceRect.z - sourceRect.x);
+                float v0 = (sourceRect.w - rect.w) / (sourceRect.w - sourceRect.y);
+                float v1 = (sourceRect.w - rect.y) / (sourceRect.w - sourceRect.y);
+
+                glBindTexture(GL_TEXTURE_2D, entry->texture);
+                glUniform4f(tileRectLoc, rect.x, rect.y, rect.z, rect.w);
+                glUniform4f(uvRectLoc, u0, v0, u1, v1);
+                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            }
+        }
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteProgram(shaderProgram);
+    }
+};
+
+double percentage(long long part, long long total) {
+    return total > 0 ? 100.0 * part / total : 0.0;
+}
+
+int main(int argc, char** argv) {
+    std::string imagePath = "src/textures/assets/test_nb.png";
+    std::string segmentName = defaultSegmentName;
+    bool useSharedCache = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--no-shared")
+            useSharedCache = false;
+        else if (arg == "--segment" && i + 1 < argc)
+            segmentName = argv[++i];
+        else
+            imagePath = arg;
+    }
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    TilePyramid pyramid;
+    if (!pyramid.load(imagePath)) {
+        glfwTerminate();
+        return -1;
+    }
+
+    // Without the segment the viewer still works, every tile is then decoded privately
+    SharedTileCache shared;
+    if (useSharedCache && !shared.attach(segmentName, sharedCacheSlots))
+        std::cerr << "Shared tile cache unavailable, decoding privately" << std::endl;
+    uint64_t dataset = datasetId(imagePath);
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    TileRequestQueue queue;
+    TileLoaderPool loaders;
+    loaders.start(&pyramid, &queue, &shared, dataset);
+    TileCache cache;
+    Prefetcher prefetcher;
+    TileRenderer renderer;
+    renderer.init(&camera);
+
+    std::vector<TileRequest> requests;
+    bool prefetchKeyDown = false;
+    bool sweepKeyDown = false;
+    int sweepFramesLeft = 0;
+    float sweepFactor = 1.0f;
+    int frame = 0;
+    long long decodedHere = 0;
+    double lastTitleTime = glfwGetTime();
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool prefetchKeyPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+        if (prefetchKeyPressed && !prefetchKeyDown)
+            prefetcher.enabled = !prefetcher.enabled;
+        prefetchKeyDown = prefetchKeyPressed;
+
+        // Z: zoom in through zoomSweepLevels levels in zoomSweepFrames frames
+        bool sweepKeyPressed = glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS;
+        if (sweepKeyPressed && !sweepKeyDown && sweepFramesLeft == 0) {
+            int levels = std::min(zoomSweepLevels, pyramid.selectLevel(camera, width, height));
+            sweepFactor = std::pow(2.0f, static_cast<float>(levels) / zoomSweepFrames);
+            sweepFramesLeft = zoomSweepFrames;
+        }
+        sweepKeyDown = sweepKeyPressed;
+        if (sweepFramesLeft > 0) {
+            camera.zoomBy(sweepFactor);
+            --sweepFramesLeft;
+        }
+
+        camera.updateMotion(glfwGetTime());
+
+        // The whole wanted set goes to the queue every frame; whatever it no longer contains is cancelled
+        prefetcher.collect(camera, pyramid, cache, width, height, requests);
+        queue.submitFrame(requests);
+
+        // Shared hits are uploaded straight from the segment and unpinned afterwards
+        for (const LoadedTile& tile : loaders.takeCompleted(maxUploadsPerFrame)) {
+            if (tile.sharedSlot >= 0) {
+                cache.upload(tile.key, tile.width, tile.height, shared.pixels(tile.sharedSlot), frame);
+                shared.unpin(tile.sharedSlot);
+            } else {
+                cache.upload(tile.key, tile.width, tile.height, tile.pixels.data(), frame);
+                ++decodedHere;
+            }
+            queue.delivered(tile.key);
+        }
+
+        int level = pyramid.selectLevel(camera, width, height);
+        camera.publish(width, height);
+        renderer.render(camera, pyramid, cache, level, frame);
+        cache.evict(frame);
+
+        double now = glfwGetTime();
+        if (now - lastTitleTime > 0.5) {
+            char title[256];
+            if (shared.isAttached()) {
+                SharedTileCache::Stats local = shared.getStats();
+                SharedTileCache::Stats all = shared.getSegmentStats();
+                snprintf(title, sizeof(title), "OpenGL - level %d | shared cache: %u viewers, %u / %u slots | hits %.1f%% here, %.1f%% all viewers | decoded here: %lld",
+                         level, shared.attachedProcesses(), shared.usedSlots(), shared.slotCount(),
+                         percentage(local.hits, local.hits + local.misses), percentage(all.hits, all.hits + all.misses), decodedHere);
+            } else {
+                snprintf(title, sizeof(title), "OpenGL - level %d | private decoding: %lld tiles", level, decodedHere);
+            }
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    TileRequestQueue::Stats stats = queue.getStats();
+    printf("Requests submitted: %lld, merged: %lld, cancelled: %lld, decoded: %lld\n",
+           stats.submitted, stats.merged, stats.cancelled, stats.started);
+    printf("Tile uploads: %d, evicted without being drawn: %d\n", cache.getUploads(), cache.getUnusedEvictions());
+
+    loaders.stop();
+    if (shared.isAttached()) {
+        SharedTileCache::Stats local = shared.getStats();
+        SharedTileCache::Stats all = shared.getSegmentStats();
+        printf("Shared cache, this viewer: %lld hits, %lld misses (%.1f%%), %lld tiles published, %lld evictions, %lld dropped (ways pinned)\n",
+               local.hits, local.misses, percentage(local.hits, local.hits + local.misses), local.inserts, local.evictions, local.full);
+        printf("Shared cache, all viewers: %lld hits, %lld misses (%.1f%%), %lld tiles published, %lld evictions\n",
+               all.hits, all.misses, percentage(all.hits, all.hits + all.misses), all.inserts, all.evictions);
+        shared.detach();
+    }
+    renderer.destroy();
+    cache.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
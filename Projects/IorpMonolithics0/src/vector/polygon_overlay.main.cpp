@@ -0,0 +1,1341 @@
+// batched polygon overlay: hundreds of thousands of parcels over a raster in a few draw calls
+// Polygons (outer ring plus holes) are triangulated once by ear clipping, in parallel across features, and
+// the triangles are cached on disk keyed by a hash of the geometry, so later runs skip triangulation. All
+// features then live in one shared vertex buffer with two index buffers (fill triangles, outline lines):
+//   - features are ordered by a coarse grid of spatial chunks, so each chunk is one contiguous index range
+//     per buffer and a frame is one glMultiDrawElements over the visible chunks per pass
+//   - every vertex carries its feature index; fill colour and alpha come from a per-feature style buffer
+//     (RGBA8 texture buffer), so restyling rewrites 4 bytes per feature and never touches geometry
+// Without a GeoJSON file a city of parcels is generated (--parcels N), with shared jittered edges and some
+// courtyards as holes. GeoJSON Polygon / MultiPolygon coordinates are read as planar and fitted to the view.
+// Usage: polygon_overlay [features.geojson] [--parcels N] [--raster image]
+// Keys: WASD pan, Q/E zoom, F fill, O outlines, C cycle colour scheme, B raster.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+// Generated city: parcel count, parcels per block edge (streets between blocks), share with a courtyard
+const int defaultParcelCount = 300000;
+const int parcelsPerBlock = 4;
+const float courtyardShare = 0.05f;
+
+// Triangulation threads (0 = one per hardware thread) and features per task
+const int triangulationThreadCount = 0;
+const int featuresPerTask = 2048;
+
+// Spatial chunks per world edge; one chunk is one draw of a multi-draw call
+const int chunkGrid = 32;
+
+// Land-use classes of the generated parcels, and fill opacity over the raster
+const int categoryCount = 8;
+const float fillOpacity = 0.55f;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+int resolveThreadCount() {
+    if (triangulationThreadCount > 0)
+        return triangulationThreadCount;
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Runs task(i) for i in [0, count) on up to threadCount threads (the caller is one of them)
+template <typename Task>
+void parallelFor(int count, int threadCount, const Task& task) {
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for (int i = next++; i < count; i = next++)
+            task(i);
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < std::min(threadCount, count); ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    float getScale() const { return scale; }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    GLuint ubo = 0;
+};
+
+// ---------------------------------------------------------------------------------------------------------
+// Features
+// ---------------------------------------------------------------------------------------------------------
+
+// Polygons in flat arrays: feature f owns rings [featureRings[f], featureRings[f + 1]), ring r owns points
+// [ringPoints[r], ringPoints[r + 1]). The first ring of a feature is its outer boundary, the others are holes;
+// rings are open (the first point is not repeated).
+struct FeatureSet {
+    std::vector<glm::vec2> points;
+    std::vector<uint32_t> ringPoints = { 0 };
+    std::vector<uint32_t> featureRings = { 0 };
+    std::vector<uint8_t> categories;
+
+    size_t featureCount() const { return featureRings.size() - 1; }
+    uint32_t firstPoint(size_t feature) const { return ringPoints[featureRings[feature]]; }
+    uint32_t pointCount(size_t feature) const { return ringPoints[featureRings[feature + 1]] - firstPoint(feature); }
+
+    void addRing(const std::vector<glm::vec2>& ring) {
+        points.insert(points.end(), ring.begin(), ring.end());
+        ringPoints.push_back(static_cast<uint32_t>(points.size()));
+    }
+    void endFeature(uint8_t category) {
+        featureRings.push_back(static_cast<uint32_t>(ringPoints.size() - 1));
+        categories.push_back(category);
+    }
+
+    // Bounding box of a feature (min.x, min.y, max.x, max.y)
+    glm::vec4 bounds(size_t feature) const {
+        glm::vec4 box(1e30f, 1e30f, -1e30f, -1e30f);
+        for (uint32_t i = firstPoint(feature), end = i + pointCount(feature); i < end; ++i) {
+            box.x = std::min(box.x, points[i].x);
+            box.y = std::min(box.y, points[i].y);
+            box.z = std::max(box.z, points[i].x);
+            box.w = std::max(box.w, points[i].y);
+        }
+        return box;
+    }
+};
+
+// Hash of coordinates and ring structure, the key of the triangulation cache (FNV-1a)
+uint64_t geometryHash(const FeatureSet& features) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    };
+    mix(features.points.data(), features.points.size() * sizeof(glm::vec2));
+    mix(features.ringPoints.data(), features.ringPoints.size() * sizeof(uint32_t));
+    mix(features.featureRings.data(), features.featureRings.size() * sizeof(uint32_t));
+    return hash;
+}
+
+// Deterministic noise in [0, 1) from a lattice coordinate, so neighbouring parcels agree on shared points
+float latticeNoise(int x, int y, int salt) {
+    uint32_t h = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u ^ static_cast<uint32_t>(salt) * 83492791u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return (h & 0xFFFFFF) / 16777216.0f;
+}
+
+// A square city of blocks of parcelsPerBlock^2 parcels separated by streets. Corners inside a block are
+// jittered and parcel edges get 0-3 extra points; both are derived from lattice coordinates, so every edge
+// has exactly the same points in the two parcels sharing it.
+void generateParcels(int parcelCount, FeatureSet& features) {
+    int perSide = std::max(parcelsPerBlock, static_cast<int>(std::ceil(std::sqrt(static_cast<float>(parcelCount)))));
+    perSide = (perSide + parcelsPerBlock - 1) / parcelsPerBlock * parcelsPerBlock;
+    int blocks = perSide / parcelsPerBlock;
+    // World [-1, 1]: each block is parcelsPerBlock cells plus a street of 0.6 cells
+    float cell = 2.0f / (perSide + blocks * 0.6f);
+    float street = 0.6f * cell;
+
+    // Lattice corner (i, j) as seen from the parcels of block (bi, bj): corners on the block edge belong to
+    // that block, so neighbouring blocks never share them and the streets stay open
+    auto corner = [&](int bi, int bj, int i, int j) {
+        int li = i - bi * parcelsPerBlock, lj = j - bj * parcelsPerBlock;
+        glm::vec2 p(-1.0f + street * 0.5f + bi * (parcelsPerBlock * cell + street) + li * cell,
+                    -1.0f + street * 0.5f + bj * (parcelsPerBlock * cell + street) + lj * cell);
+        // Block outlines stay straight along the streets
+        if (li > 0 && li < parcelsPerBlock)
+            p.x += (latticeNoise(i, j, 1) - 0.5f) * 0.35f * cell;
+        if (lj > 0 && lj < parcelsPerBlock)
+            p.y += (latticeNoise(i, j, 2) - 0.5f) * 0.35f * cell;
+        return p;
+    };
+    // Points strictly between corner (i0, j0) and its neighbour along one axis, in that direction
+    auto edgePoints = [&](int bi, int bj, int i0, int j0, bool alongX, std::vector<glm::vec2>& out) {
+        int i1 = alongX ? i0 + 1 : i0, j1 = alongX ? j0 : j0 + 1;
+        glm::vec2 a = corner(bi, bj, i0, j0), b = corner(bi, bj, i1, j1);
+        int salt = alongX ? 3 : 4;
+        int extra = static_cast<int>(latticeNoise(i0, j0, salt) * 4.0f);
+        bool onStreet = alongX ? (j0 % parcelsPerBlock == 0) : (i0 % parcelsPerBlock == 0);
+        glm::vec2 normal(-(b.y - a.y), b.x - a.x);
+        for (int k = 1; k <= extra; ++k) {
+            float t = static_cast<float>(k) / (extra + 1);
+            float bend = onStreet ? 0.0f : (latticeNoise(i0 * 4 + k, j0, salt + 2) - 0.5f) * 0.15f;
+            out.push_back(a + (b - a) * t + normal * bend);
+        }
+    };
+
+    int count = std::min(parcelCount, perSide * perSide);
+    std::vector<glm::vec2> ring, edge;
+    for (int n = 0; n < count; ++n) {
+        int i = n % perSide, j = n / perSide;
+        int bi = i / parcelsPerBlock, bj = j / parcelsPerBlock;
+        // Counter-clockwise: bottom, right, top (reversed), left (reversed)
+        ring.clear();
+        ring.push_back(corner(bi, bj, i, j));
+        edgePoints(bi, bj, i, j, true, ring);
+        ring.push_back(corner(bi, bj, i + 1, j));
+        edgePoints(bi, bj, i + 1, j, false, ring);
+        ring.push_back(corner(bi, bj, i + 1, j + 1));
+        edge.clear();
+        edgePoints(bi, bj, i, j + 1, true, edge);
+        ring.insert(ring.end(), edge.rbegin(), edge.rend());
+        ring.push_back(corner(bi, bj, i, j + 1));
+        edge.clear();
+        edgePoints(bi, bj, i, j, false, edge);
+        ring.insert(ring.end(), edge.rbegin(), edge.rend());
+        features.addRing(ring);
+
+        if (latticeNoise(i, j, 7) < courtyardShare) {
+            // Clockwise square in the middle third of the parcel
+            glm::vec2 lo = corner(bi, bj, i, j) * (2.0f / 3.0f) + corner(bi, bj, i + 1, j + 1) * (1.0f / 3.0f);
+            glm::vec2 hi = corner(bi, bj, i, j) * (1.0f / 3.0f) + corner(bi, bj, i + 1, j + 1) * (2.0f / 3.0f);
+            features.addRing({ lo, glm::vec2(lo.x, hi.y), hi, glm::vec2(hi.x, lo.y) });
+        }
+        features.endFeature(static_cast<uint8_t>(latticeNoise(i / 2, j / 2, 9) * categoryCount));
+    }
+    printf("Generated %d parcels in %d x %d blocks, %zu points\n", count, blocks, blocks, features.points.size());
+}
+
+// Polygon and MultiPolygon geometries of a GeoJSON file, one feature per polygon, fitted to x in [-1, 1].
+// Only "coordinates" arrays are parsed; coordinate nesting depth tells the geometry type, other types are
+// skipped.
+bool loadGeoJson(const std::string& path, FeatureSet& features) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+
+    std::vector<glm::dvec2> points;
+    std::vector<uint32_t> ringEnds, polygonEnds;   // into points / ringEnds
+    size_t pos = 0;
+    while ((pos = text.find("\"coordinates\"", pos)) != std::string::npos) {
+        pos = text.find('[', pos);
+        if (pos == std::string::npos)
+            break;
+        int numberDepth = 0;
+        for (size_t p = pos; p < text.size() && (text[p] == '[' || isspace(static_cast<unsigned char>(text[p]))); ++p)
+            numberDepth += text[p] == '[';
+        int depth = 0;
+        std::vector<double> values;
+        do {
+            char c = text[pos];
+            if (c == '[') {
+                ++depth;
+                ++pos;
+            } else if (c == ']') {
+                if (depth == numberDepth && values.size() >= 2)
+                    points.push_back(glm::dvec2(values[0], values[1]));
+                else if (depth == numberDepth - 1 && (numberDepth == 3 || numberDepth == 4))
+                    ringEnds.push_back(static_cast<uint32_t>(points.size()));
+                else if (depth == numberDepth - 2 && (numberDepth == 3 || numberDepth == 4))
+                    polygonEnds.push_back(static_cast<uint32_t>(ringEnds.size()));
+                values.clear();
+                --depth;
+                ++pos;
+            } else if (c == '-' || c == '+' || c == '.' || isdigit(static_cast<unsigned char>(c))) {
+                char* end = nullptr;
+                values.push_back(std::strtod(text.c_str() + pos, &end));
+                pos = end - text.c_str();
+            } else {
+                ++pos;
+            }
+        } while (depth > 0 && pos < text.size());
+        // Points and lines leave no rings behind; drop what they added
+        if (numberDepth < 3) {
+            size_t kept = ringEnds.empty() ? 0 : ringEnds.back();
+            points.resize(kept);
+        }
+    }
+    if (polygonEnds.empty())
+        return false;
+
+    glm::dvec2 lo(1e300, 1e300), hi(-1e300, -1e300);
+    for (const glm::dvec2& p : points) {
+        lo.x = std::min(lo.x, p.x);
+        lo.y = std::min(lo.y, p.y);
+        hi.x = std::max(hi.x, p.x);
+        hi.y = std::max(hi.y, p.y);
+    }
+    double scale = 2.0 / std::max(hi.x - lo.x, 1e-12);
+    glm::dvec2 center((lo.x + hi.x) * 0.5, (lo.y + hi.y) * 0.5);
+
+    std::vector<glm::vec2> ring;
+    uint32_t ringStart = 0, ringIndex = 0;
+    for (size_t polygon = 0; polygon < polygonEnds.size(); ++polygon) {
+        for (; ringIndex < polygonEnds[polygon]; ++ringIndex) {
+            uint32_t ringEnd = ringEnds[ringIndex];
+            // GeoJSON closes rings by repeating the first point
+            uint32_t last = ringEnd;
+            if (last - ringStart > 1 && points[last - 1].x == points[ringStart].x && points[last - 1].y == points[ringStart].y)
+                --last;
+            ring.clear();
+            for (uint32_t i = ringStart; i < last; ++i)
+                ring.push_back(glm::vec2(static_cast<float>((points[i].x - center.x) * scale), static_cast<float>((points[i].y - center.y) * scale)));
+            if (ring.size() >= 3)
+                features.addRing(ring);
+            ringStart = ringEnd;
+        }
+        if (features.ringPoints.size() - 1 > features.featureRings.back())
+            features.endFeature(static_cast<uint8_t>(polygon % categoryCount));
+    }
+    printf("GeoJSON %s: %zu polygons, %zu points\n", path.c_str(), features.featureCount(), features.points.size());
+    return features.featureCount() > 0;
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Triangulation
+// ---------------------------------------------------------------------------------------------------------
+
+// Ear clipping with holes after Mapbox's earcut: holes are joined to the outer ring through bridge edges, then
+// ears are cut from the resulting single ring. When no ear is left, points are filtered, local
+// self-intersections are cured and finally the ring is split along a valid diagonal, so malformed input still
+// yields triangles. No z-order hashing: features here are parcels of tens of points.
+// One Triangulator per thread; its node pool is reused from feature to feature.
+class Triangulator {
+public:
+    // triangles receives point indices relative to the feature's first point
+    void triangulate(const FeatureSet& features, size_t feature, std::vector<uint32_t>& triangles) {
+        triangles.clear();
+        uint32_t firstRing = features.featureRings[feature], endRing = features.featureRings[feature + 1];
+        uint32_t base = features.ringPoints[firstRing];
+        m_nodes.clear();
+        m_nodes.reserve(4 * static_cast<size_t>(features.ringPoints[endRing] - base) + 16);
+
+        Node* outer = linkedList(features, firstRing, base, true);
+        if (!outer || outer->next == outer->prev)
+            return;
+        if (endRing - firstRing > 1)
+            outer = eliminateHoles(features, firstRing + 1, endRing, base, outer);
+        earcutLinked(outer, triangles, 0);
+    }
+
+private:
+    struct Node {
+        uint32_t i;
+        double x, y;
+        Node* prev = nullptr;
+        Node* next = nullptr;
+        bool steiner = false;
+    };
+    // Reserved up front for every node a feature can need, so node pointers stay valid
+    std::vector<Node> m_nodes;
+
+    Node* insertNode(uint32_t i, double x, double y, Node* last) {
+        m_nodes.push_back(Node());
+        Node* p = &m_nodes.back();
+        p->i = i;
+        p->x = x;
+        p->y = y;
+        if (!last) {
+            p->prev = p;
+            p->next = p;
+        } else {
+            p->next = last->next;
+            p->prev = last;
+            last->next->prev = p;
+            last->next = p;
+        }
+        return p;
+    }
+
+    static void removeNode(Node* p) {
+        p->next->prev = p->prev;
+        p->prev->next = p->next;
+    }
+
+    static double area(const Node* p, const Node* q, const Node* r) {
+        return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+    }
+    static bool equals(const Node* a, const Node* b) { return a->x == b->x && a->y == b->y; }
+    static int sign(double v) { return v > 0.0 ? 1 : v < 0.0 ? -1 : 0; }
+
+    static bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py) {
+        return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+               (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+               (bx - px) * (cy - py) >= (cx - px) * (by - py);
+    }
+
+    static bool onSegment(const Node* p, const Node* q, const Node* r) {
+        return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) && q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+    }
+
+    static bool intersects(const Node* p1, const Node* q1, const Node* p2, const Node* q2) {
+        int o1 = sign(area(p1, q1, p2)), o2 = sign(area(p1, q1, q2)), o3 = sign(area(p2, q2, p1)), o4 = sign(area(p2, q2, q1));
+        if (o1 != o2 && o3 != o4)
+            return true;
+        return (o1 == 0 && onSegment(p1, p2, q1)) || (o2 == 0 && onSegment(p1, q2, q1)) ||
+               (o3 == 0 && onSegment(p2, p1, q2)) || (o4 == 0 && onSegment(p2, q1, q2));
+    }
+
+    static bool intersectsPolygon(const Node* a, const Node* b) {
+        const Node* p = a;
+        do {
+            if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i && intersects(p, p->next, a, b))
+                return true;
+            p = p->next;
+        } while (p != a);
+        return false;
+    }
+
+    static bool locallyInside(const Node* a, const Node* b) {
+        return area(a->prev, a, a->next) < 0 ? area(a, b, a->next) >= 0 && area(a, a->prev, b) >= 0
+                                              : area(a, b, a->prev) < 0 || area(a, a->next, b) < 0;
+    }
+
+    static bool middleInside(const Node* a, const Node* b) {
+        const Node* p = a;
+        bool inside = false;
+        double px = (a->x + b->x) / 2, py = (a->y + b->y) / 2;
+        do {
+            if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
+                (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
+                inside = !inside;
+            p = p->next;
+        } while (p != a);
+        return inside;
+    }
+
+    static bool isValidDiagonal(const Node* a, const Node* b) {
+        return a->next->i != b->i && a->prev->i != b->i && !intersectsPolygon(a, b) &&
+               ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) && (area(a->prev, a, b->prev) != 0 || area(a, b->prev, b) != 0)) ||
+                (equals(a, b) && area(a->prev, a, a->next) > 0 && area(b->prev, b, b->next) > 0));
+    }
+
+    // Ring in the winding the ear test expects (clockwise for the outer ring in earcut's convention)
+    Node* linkedList(const FeatureSet& features, uint32_t ring, uint32_t base, bool clockwise) {
+        uint32_t start = features.ringPoints[ring], end = features.ringPoints[ring + 1];
+        double sum = 0.0;
+        for (uint32_t i = start, j = end - 1; i < end; j = i++)
+            sum += (static_cast<double>(features.points[j].x) - features.points[i].x) * (static_cast<double>(features.points[i].y) + features.points[j].y);
+        Node* last = nullptr;
+        if (clockwise == (sum > 0.0)) {
+            for (uint32_t i = start; i < end; ++i)
+                last = insertNode(i - base, features.points[i].x, features.points[i].y, last);
+        } else {
+            for (uint32_t i = end; i-- > start;)
+                last = insertNode(i - base, features.points[i].x, features.points[i].y, last);
+        }
+        if (last && equals(last, last->next)) {
+            removeNode(last);
+            last = last->next;
+        }
+        return last;
+    }
+
+    // Removes duplicate and collinear points
+    static Node* filterPoints(Node* start, Node* end = nullptr) {
+        if (!start)
+            return start;
+        if (!end)
+            end = start;
+        Node* p = start;
+        bool again;
+        do {
+            again = false;
+            if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0)) {
+                removeNode(p);
+                p = end = p->prev;
+                if (p == p->next)
+                    break;
+                again = true;
+            } else {
+                p = p->next;
+            }
+        } while (again || p != end);
+        return end;
+    }
+
+    static bool isEar(const Node* ear) {
+        const Node* a = ear->prev;
+        const Node* b = ear;
+        const Node* c = ear->next;
+        if (area(a, b, c) >= 0)
+            return false;   // reflex
+        double x0 = std::min(a->x, std::min(b->x, c->x)), y0 = std::min(a->y, std::min(b->y, c->y));
+        double x1 = std::max(a->x, std::max(b->x, c->x)), y1 = std::max(a->y, std::max(b->y, c->y));
+        for (const Node* p = c->next; p != a; p = p->next) {
+            if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+                pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) && area(p->prev, p, p->next) >= 0)
+                return false;
+        }
+        return true;
+    }
+
+    static void emit(std::vector<uint32_t>& triangles, const Node* a, const Node* b, const Node* c) {
+        triangles.push_back(a->i);
+        triangles.push_back(b->i);
+        triangles.push_back(c->i);
+    }
+
+    void earcutLinked(Node* ear, std::vector<uint32_t>& triangles, int pass) {
+        if (!ear)
+            return;
+        Node* stop = ear;
+        while (ear->prev != ear->next) {
+            Node* prev = ear->prev;
+            Node* next = ear->next;
+            if (isEar(ear)) {
+                emit(triangles, prev, ear, next);
+                removeNode(ear);
+                ear = next->next;
+                stop = next->next;
+                continue;
+            }
+            ear = next;
+            if (ear == stop) {
+                if (pass == 0) {
+                    earcutLinked(filterPoints(ear), triangles, 1);
+                } else if (pass == 1) {
+                    ear = cureLocalIntersections(filterPoints(ear), triangles);
+                    earcutLinked(ear, triangles, 2);
+                } else {
+                    splitEarcut(ear, triangles);
+                }
+                break;
+            }
+        }
+    }
+
+    static Node* cureLocalIntersections(Node* start, std::vector<uint32_t>& triangles) {
+        Node* p = start;
+        do {
+            Node* a = p->prev;
+            Node* b = p->next->next;
+            if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a)) {
+                emit(triangles, a, p, b);
+                removeNode(p);
+                removeNode(p->next);
+                p = start = b;
+            }
+            p = p->next;
+        } while (p != start);
+        return filterPoints(p);
+    }
+
+    void splitEarcut(Node* start, std::vector<uint32_t>& triangles) {
+        Node* a = start;
+        do {
+            for (Node* b = a->next->next; b != a->prev; b = b->next) {
+                if (a->i != b->i && isValidDiagonal(a, b)) {
+                    Node* c = splitPolygon(a, b);
+                    a = filterPoints(a, a->next);
+                    c = filterPoints(c, c->next);
+                    earcutLinked(a, triangles, 0);
+                    earcutLinked(c, triangles, 0);
+                    return;
+                }
+            }
+            a = a->next;
+        } while (a != start);
+    }
+
+    // Links a and b with a two-way edge; returns the copy of b on the split-off ring
+    Node* splitPolygon(Node* a, Node* b) {
+        Node* a2 = insertNode(a->i, a->x, a->y, nullptr);
+        Node* b2 = insertNode(b->i, b->x, b->y, nullptr);
+        Node* an = a->next;
+        Node* bp = b->prev;
+        a->next = b;
+        b->prev = a;
+        a2->next = an;
+        an->prev = a2;
+        b2->next = a2;
+        a2->prev = b2;
+        bp->next = b2;
+        b2->prev = bp;
+        return b2;
+    }
+
+    static Node* getLeftmost(Node* start) {
+        Node* p = start;
+        Node* leftmost = start;
+        do {
+            if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y))
+                leftmost = p;
+            p = p->next;
+        } while (p != start);
+        return leftmost;
+    }
+
+    static bool sectorContainsSector(const Node* m, const Node* p) {
+        return area(m->prev, m, p->prev) < 0 && area(p->next, m, m->next) < 0;
+    }
+
+    // Outer-ring point that the hole's leftmost point can see: the nearest edge hit by a ray to the left,
+    // then the reflex point inside that triangle with the smallest angle to the ray
+    static Node* findHoleBridge(Node* hole, Node* outerNode) {
+        Node* p = outerNode;
+        double hx = hole->x, hy = hole->y, qx = -1e300;
+        Node* m = nullptr;
+        do {
+            if (hy <= p->y && hy >= p->next->y && p->next->y != p->y) {
+                double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+                if (x <= hx && x > qx) {
+                    qx = x;
+                    m = p->x < p->next->x ? p : p->next;
+                    if (x == hx)
+                        return m;
+                }
+            }
+            p = p->next;
+        } while (p != outerNode);
+        if (!m)
+            return nullptr;
+
+        Node* stop = m;
+        double mx = m->x, my = m->y, tanMin = 1e300;
+        p = m;
+        do {
+            if (hx >= p->x && p->x >= mx && hx != p->x &&
+                pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y)) {
+                double tan = std::fabs(hy - p->y) / (hx - p->x);
+                if (locallyInside(p, hole) &&
+                    (tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p)))))) {
+                    m = p;
+                    tanMin = tan;
+                }
+            }
+            p = p->next;
+        } while (p != stop);
+        return m;
+    }
+
+    Node* eliminateHoles(const FeatureSet& features, uint32_t firstHole, uint32_t endRing, uint32_t base, Node* outerNode) {
+        std::vector<Node*> queue;
+        for (uint32_t ring = firstHole; ring < endRing; ++ring) {
+            Node* list = linkedList(features, ring, base, false);
+            if (!list)
+                continue;
+            if (list == list->next)
+                list->steiner = true;
+            queue.push_back(getLeftmost(list));
+        }
+        std::sort(queue.begin(), queue.end(), [](const Node* a, const Node* b) { return a->x < b->x; });
+        for (Node* hole : queue) {
+            Node* bridge = findHoleBridge(hole, outerNode);
+            if (!bridge)
+                continue;
+            Node* bridgeReverse = splitPolygon(bridge, hole);
+            filterPoints(bridgeReverse, bridgeReverse->next);
+            outerNode = filterPoints(bridge, bridge->next);
+        }
+        return outerNode;
+    }
+};
+
+// Triangles of every feature, relative to the feature's first point
+struct Triangulation {
+    std::vector<uint32_t> featureIndices = { 0 };   // feature f owns indices [featureIndices[f], featureIndices[f + 1])
+    std::vector<uint32_t> indices;
+};
+
+void triangulateAll(const FeatureSet& features, int threadCount, Triangulation& result) {
+    size_t featureCount = features.featureCount();
+    int taskCount = static_cast<int>((featureCount + featuresPerTask - 1) / featuresPerTask);
+    std::vector<std::vector<uint32_t>> taskIndices(taskCount), taskCounts(taskCount);
+    parallelFor(taskCount, threadCount, [&](int task) {
+        Triangulator triangulator;
+        std::vector<uint32_t> triangles;
+        size_t end = std::min(featureCount, static_cast<size_t>(task + 1) * featuresPerTask);
+        for (size_t f = static_cast<size_t>(task) * featuresPerTask; f < end; ++f) {
+            triangulator.triangulate(features, f, triangles);
+            taskIndices[task].insert(taskIndices[task].end(), triangles.begin(), triangles.end());
+            taskCounts[task].push_back(static_cast<uint32_t>(triangles.size()));
+        }
+    });
+    result.featureIndices.assign(1, 0);
+    result.indices.clear();
+    for (int task = 0; task < taskCount; ++task) {
+        for (uint32_t count : taskCounts[task])
+            result.featureIndices.push_back(result.featureIndices.back() + count);
+        result.indices.insert(result.indices.end(), taskIndices[task].begin(), taskIndices[task].end());
+    }
+}
+
+// Triangulations on disk, named by geometry hash: magic, hash, feature count, per-feature offsets, indices
+const char triangulationMagic[8] = { 'I', 'O', 'R', 'P', 'T', 'R', 'I', '1' };
+
+std::string triangulationCachePath(uint64_t hash) {
+    char name[64];
+    snprintf(name, sizeof(name), "iorp_triangles_%016llx.bin", static_cast<unsigned long long>(hash));
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// The cache sits under a predictable name in the shared temp directory, so nothing read from it is trusted:
+// the sizes must match the file, the feature offsets must rise from 0 to the index count in whole triangles,
+// and every index must name a point of its own feature. Any mismatch means triangulating again.
+bool loadTriangulation(const std::string& path, uint64_t hash, const FeatureSet& features, Triangulation& result) {
+    size_t featureCount = features.featureCount();
+    std::error_code error;
+    uint64_t fileSize = std::filesystem::file_size(path, error);
+    if (error)
+        return false;
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    char magic[8];
+    uint64_t storedHash = 0, storedCount = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&storedHash), sizeof(storedHash));
+    in.read(reinterpret_cast<char*>(&storedCount), sizeof(storedCount));
+    if (!in || memcmp(magic, triangulationMagic, sizeof(magic)) != 0 || storedHash != hash || storedCount != featureCount)
+        return false;
+    uint64_t headerBytes = sizeof(magic) + sizeof(storedHash) + sizeof(storedCount);
+    uint64_t offsetBytes = (static_cast<uint64_t>(featureCount) + 1) * sizeof(uint32_t);
+    if (fileSize < headerBytes + offsetBytes)
+        return false;
+    result.featureIndices.resize(featureCount + 1);
+    in.read(reinterpret_cast<char*>(result.featureIndices.data()), result.featureIndices.size() * sizeof(uint32_t));
+    if (!in || result.featureIndices[0] != 0 || fileSize != headerBytes + offsetBytes + static_cast<uint64_t>(result.featureIndices.back()) * sizeof(uint32_t))
+        return false;
+    for (size_t f = 0; f < featureCount; ++f)
+        if (result.featureIndices[f + 1] < result.featureIndices[f] || (result.featureIndices[f + 1] - result.featureIndices[f]) % 3 != 0)
+            return false;
+    result.indices.resize(result.featureIndices.back());
+    in.read(reinterpret_cast<char*>(result.indices.data()), result.indices.size() * sizeof(uint32_t));
+    if (!in)
+        return false;
+    for (size_t f = 0; f < featureCount; ++f) {
+        uint32_t pointCount = features.pointCount(f);
+        for (uint32_t i = result.featureIndices[f]; i < result.featureIndices[f + 1]; ++i)
+            if (result.indices[i] >= pointCount)
+                return false;
+    }
+    return true;
+}
+
+void saveTriangulation(const std::string& path, uint64_t hash, const Triangulation& triangulation) {
+    // Written aside and renamed, so a concurrent run never reads half a file
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary);
+        uint64_t count = triangulation.featureIndices.size() - 1;
+        out.write(triangulationMagic, sizeof(triangulationMagic));
+        out.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char*>(triangulation.featureIndices.data()), triangulation.featureIndices.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(triangulation.indices.data()), triangulation.indices.size() * sizeof(uint32_t));
+        if (!out) {
+            std::cerr << "Failed to write triangulation cache " << temporary << std::endl;
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error)
+        std::cerr << "Failed to write triangulation cache " << path << ": " << error.message() << std::endl;
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Drawing
+// ---------------------------------------------------------------------------------------------------------
+
+enum class ColorScheme { Category, Area, Random };
+
+const char* colorSchemeNames[] = { "land use", "area", "random" };
+
+// RGBA8 fill per feature
+void computeStyles(const FeatureSet& features, ColorScheme scheme, std::vector<uint32_t>& styles) {
+    static const uint8_t palette[categoryCount][3] = {
+        { 230, 85, 13 }, { 49, 130, 189 }, { 49, 163, 84 }, { 253, 208, 162 },
+        { 158, 154, 200 }, { 255, 237, 111 }, { 188, 128, 189 }, { 141, 211, 199 },
+    };
+    auto pack = [](float r, float g, float b) {
+        uint32_t alpha = static_cast<uint32_t>(fillOpacity * 255.0f + 0.5f);
+        return static_cast<uint32_t>(r) | (static_cast<uint32_t>(g) << 8) | (static_cast<uint32_t>(b) << 16) | (alpha << 24);
+    };
+    styles.resize(features.featureCount());
+    for (size_t f = 0; f < features.featureCount(); ++f) {
+        if (scheme == ColorScheme::Category) {
+            const uint8_t* c = palette[features.categories[f] % categoryCount];
+            styles[f] = pack(c[0], c[1], c[2]);
+        } else if (scheme == ColorScheme::Area) {
+            glm::vec4 box = features.bounds(f);
+            float area = (box.z - box.x) * (box.w - box.y);
+            float t = std::min(1.0f, std::max(0.0f, (std::log10(std::max(area, 1e-12f)) + 6.0f) / 3.0f));
+            styles[f] = pack(255.0f * t, 80.0f, 255.0f * (1.0f - t));
+        } else {
+            uint32_t h = static_cast<uint32_t>(f) * 2654435761u;
+            styles[f] = pack(static_cast<float>(h & 0xFF), static_cast<float>((h >> 8) & 0xFF), static_cast<float>((h >> 16) & 0xFF));
+        }
+    }
+}
+
+// All features in one vertex buffer and two index buffers, grouped by spatial chunk
+class PolygonOverlay {
+public:
+    const char* vertexShaderSource = R"(
+layout (location = 0) in vec2 position;
+layout (location = 1) in uint feature;
+
+uniform samplerBuffer styles;   // RGBA8 per feature
+uniform int outlinePass;
+
+out vec4 color;
+
+void main()
+{
+    vec4 style = texelFetch(styles, int(feature));
+    color = outlinePass != 0 ? vec4(style.rgb * 0.45, style.a > 0.0 ? 1.0 : 0.0) : style;
+    gl_Position = viewProjection * vec4(position, 0.0, 1.0);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec4 color;
+
+void main()
+{
+    if (color.a == 0.0)
+        discard;
+    FragColor = color;
+}
+)";
+    GLuint shaderProgram;
+    GLuint VAO, VBO, fillEBO, outlineEBO, styleBuffer, styleTexture;
+    GLint stylesLoc, outlinePassLoc;
+    bool showFill = true, showOutlines = true;
+    int drawCalls = 0, visibleChunks = 0;
+    long long trianglesDrawn = 0;
+
+    void init(Camera* camera, const FeatureSet& features, const Triangulation& triangulation, const std::vector<uint32_t>& styles) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        stylesLoc = glGetUniformLocation(shaderProgram, "styles");
+        outlinePassLoc = glGetUniformLocation(shaderProgram, "outlinePass");
+
+        // Features ordered by chunk (the chunk holding their bounding box centre)
+        size_t featureCount = features.featureCount();
+        std::vector<uint32_t> chunkOf(featureCount), order(featureCount);
+        m_chunks.assign(chunkGrid * chunkGrid, Chunk());
+        glm::vec4 world(1e30f, 1e30f, -1e30f, -1e30f);
+        std::vector<glm::vec4> bounds(featureCount);
+        for (size_t f = 0; f < featureCount; ++f) {
+            bounds[f] = features.bounds(f);
+            world = glm::vec4(std::min(world.x, bounds[f].x), std::min(world.y, bounds[f].y), std::max(world.z, bounds[f].z), std::max(world.w, bounds[f].w));
+        }
+        for (size_t f = 0; f < featureCount; ++f) {
+            float cx = (bounds[f].x + bounds[f].z) * 0.5f, cy = (bounds[f].y + bounds[f].w) * 0.5f;
+            int gx = std::min(chunkGrid - 1, static_cast<int>((cx - world.x) / std::max(world.z - world.x, 1e-12f) * chunkGrid));
+            int gy = std::min(chunkGrid - 1, static_cast<int>((cy - world.y) / std::max(world.w - world.y, 1e-12f) * chunkGrid));
+            chunkOf[f] = static_cast<uint32_t>(gy * chunkGrid + gx);
+            order[f] = static_cast<uint32_t>(f);
+        }
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return chunkOf[a] < chunkOf[b]; });
+
+        // Vertices stay in feature order (their feature index selects the style); indices go chunk by chunk
+        std::vector<Vertex> vertices(features.points.size());
+        for (size_t f = 0; f < featureCount; ++f)
+            for (uint32_t i = features.firstPoint(f), end = i + features.pointCount(f); i < end; ++i)
+                vertices[i] = Vertex{ features.points[i], static_cast<uint32_t>(f) };
+        std::vector<uint32_t> fill, outline;
+        fill.reserve(triangulation.indices.size());
+        outline.reserve(features.points.size() * 2);
+        for (uint32_t f : order) {
+            Chunk& chunk = m_chunks[chunkOf[f]];
+            if (chunk.fillCount == 0 && chunk.outlineCount == 0) {
+                chunk.fillFirst = fill.size();
+                chunk.outlineFirst = outline.size();
+                chunk.bounds = bounds[f];
+            }
+            chunk.bounds = glm::vec4(std::min(chunk.bounds.x, bounds[f].x), std::min(chunk.bounds.y, bounds[f].y),
+                                     std::max(chunk.bounds.z, bounds[f].z), std::max(chunk.bounds.w, bounds[f].w));
+            uint32_t base = features.firstPoint(f);
+            for (uint32_t i = triangulation.featureIndices[f]; i < triangulation.featureIndices[f + 1]; ++i)
+                fill.push_back(base + triangulation.indices[i]);
+            for (uint32_t ring = features.featureRings[f]; ring < features.featureRings[f + 1]; ++ring) {
+                uint32_t start = features.ringPoints[ring], end = features.ringPoints[ring + 1];
+                for (uint32_t i = start; i < end; ++i) {
+                    outline.push_back(i);
+                    outline.push_back(i + 1 < end ? i + 1 : start);
+                }
+            }
+            chunk.fillCount = fill.size() - chunk.fillFirst;
+            chunk.outlineCount = outline.size() - chunk.outlineFirst;
+        }
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &fillEBO);
+        glGenBuffers(1, &outlineEBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+        glEnableVertexAttribArray(0);
+        glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(Vertex), (void*)offsetof(Vertex, feature));
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, fillEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, fill.size() * sizeof(uint32_t), fill.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, outlineEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, outline.size() * sizeof(uint32_t), outline.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        glGenBuffers(1, &styleBuffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, styleBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, styles.size() * sizeof(uint32_t), styles.data(), GL_DYNAMIC_DRAW);
+        glGenTextures(1, &styleTexture);
+        glBindTexture(GL_TEXTURE_BUFFER, styleTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA8, styleBuffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        size_t used = std::count_if(m_chunks.begin(), m_chunks.end(), [](const Chunk& c) { return c.fillCount + c.outlineCount > 0; });
+        printf("Overlay: %zu vertices, %zu triangles, %zu outline segments in %zu chunks, %.1f MB of buffers\n",
+               vertices.size(), fill.size() / 3, outline.size() / 2, used,
+               (vertices.size() * sizeof(Vertex) + (fill.size() + outline.size()) * sizeof(uint32_t) + styles.size() * sizeof(uint32_t)) / 1048576.0);
+    }
+
+    // Replaces the styles of features [first, first + count)
+    void updateStyles(const uint32_t* styles, size_t first, size_t count) {
+        glBindBuffer(GL_TEXTURE_BUFFER, styleBuffer);
+        glBufferSubData(GL_TEXTURE_BUFFER, first * sizeof(uint32_t), count * sizeof(uint32_t), styles);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void render(const Camera& camera) {
+        drawCalls = 0;
+        visibleChunks = 0;
+        trianglesDrawn = 0;
+        glm::vec4 view = camera.getVisibleRect();
+        m_fillCounts.clear();
+        m_fillOffsets.clear();
+        m_outlineCounts.clear();
+        m_outlineOffsets.clear();
+        for (const Chunk& chunk : m_chunks) {
+            if (chunk.fillCount + chunk.outlineCount == 0 ||
+                chunk.bounds.z < view.x || chunk.bounds.x > view.z || chunk.bounds.w < view.y || chunk.bounds.y > view.w)
+                continue;
+            ++visibleChunks;
+            m_fillCounts.push_back(static_cast<GLsizei>(chunk.fillCount));
+            m_fillOffsets.push_back(reinterpret_cast<const void*>(chunk.fillFirst * sizeof(uint32_t)));
+            m_outlineCounts.push_back(static_cast<GLsizei>(chunk.outlineCount));
+            m_outlineOffsets.push_back(reinterpret_cast<const void*>(chunk.outlineFirst * sizeof(uint32_t)));
+            trianglesDrawn += static_cast<long long>(chunk.fillCount / 3);
+        }
+        if (visibleChunks == 0)
+            return;
+
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_BUFFER, styleTexture);
+        glUniform1i(stylesLoc, 0);
+        if (showFill) {
+            glUniform1i(outlinePassLoc, 0);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, fillEBO);
+            glMultiDrawElements(GL_TRIANGLES, m_fillCounts.data(), GL_UNSIGNED_INT, m_fillOffsets.data(), visibleChunks);
+            ++drawCalls;
+        }
+        // Outlines only once parcels are a few pixels wide; before that they would just cover the fill
+        if (showOutlines && camera.getScale() > 4.0f) {
+            glUniform1i(outlinePassLoc, 1);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, outlineEBO);
+            glMultiDrawElements(GL_LINES, m_outlineCounts.data(), GL_UNSIGNED_INT, m_outlineOffsets.data(), visibleChunks);
+            ++drawCalls;
+        }
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &fillEBO);
+        glDeleteBuffers(1, &outlineEBO);
+        glDeleteBuffers(1, &styleBuffer);
+        glDeleteTextures(1, &styleTexture);
+        glDeleteProgram(shaderProgram);
+    }
+
+private:
+    struct Vertex {
+        glm::vec2 position;
+        uint32_t feature;
+    };
+    struct Chunk {
+        size_t fillFirst = 0, fillCount = 0;
+        size_t outlineFirst = 0, outlineCount = 0;
+        glm::vec4 bounds = glm::vec4(0.0f);
+    };
+    std::vector<Chunk> m_chunks;
+    std::vector<GLsizei> m_fillCounts, m_outlineCounts;
+    std::vector<const void*> m_fillOffsets, m_outlineOffsets;
+};
+
+// The raster under the overlay: one image stretched over x in [-1, 1], keeping its aspect ratio
+class RasterBackground {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 rect;   // world x0, y0, x1, y1
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(rect.xw, rect.zy, corner), 0.0, 1.0);
+    texCoord = corner;
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+    GLuint shaderProgram = 0;
+    GLuint VAO = 0, texture = 0;
+    GLint rectLoc;
+    glm::vec4 rect;
+    bool visible = true;
+
+    bool init(Camera* camera, const std::string& imagePath) {
+        int width, height, nrChannels;
+        unsigned char* data = stbi_load(imagePath.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha);
+        if (!data) {
+            std::cerr << "Failed to load raster " << imagePath << ", drawing the overlay alone" << std::endl;
+            return false;
+        }
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        stbi_image_free(data);
+
+        float halfHeight = static_cast<float>(height) / width;
+        rect = glm::vec4(-1.0f, -halfHeight, 1.0f, halfHeight);
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        rectLoc = glGetUniformLocation(shaderProgram, "rect");
+        glGenVertexArrays(1, &VAO);
+        return true;
+    }
+
+    void render() {
+        if (!texture || !visible)
+            return;
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glUniform4f(rectLoc, rect.x, rect.y, rect.z, rect.w);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        if (!texture)
+            return;
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteTextures(1, &texture);
+        glDeleteProgram(shaderProgram);
+    }
+};
+
+int main(int argc, char** argv) {
+    std::string geoJsonPath;
+    std::string rasterPath = "src/textures/assets/test_nb.png";
+    int parcelCount = defaultParcelCount;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--parcels" && i + 1 < argc)
+            parcelCount = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--raster" && i + 1 < argc)
+            rasterPath = argv[++i];
+        else
+            geoJsonPath = arg;
+    }
+
+    FeatureSet features;
+    if (geoJsonPath.empty()) {
+        generateParcels(parcelCount, features);
+    } else if (!loadGeoJson(geoJsonPath, features)) {
+        std::cerr << "No polygons in " << geoJsonPath << std::endl;
+        return -1;
+    }
+
+    // Triangulate once; later runs over the same geometry load the cached triangles
+    Triangulation triangulation;
+    uint64_t hash = geometryHash(features);
+    std::string cachePath = triangulationCachePath(hash);
+    auto start = std::chrono::steady_clock::now();
+    if (loadTriangulation(cachePath, hash, features, triangulation)) {
+        printf("Triangulation loaded from %s in %.1f ms\n", cachePath.c_str(), millisecondsSince(start));
+    } else {
+        int threadCount = resolveThreadCount();
+        triangulateAll(features, threadCount, triangulation);
+        printf("Triangulated %zu features on %d threads in %.1f ms\n", features.featureCount(), threadCount, millisecondsSince(start));
+        saveTriangulation(cachePath, hash, triangulation);
+    }
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    // No vsync, so the title shows what the overlay really costs
+    glfwSwapInterval(0);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    RasterBackground raster;
+    raster.init(&camera, rasterPath);
+
+    ColorScheme scheme = ColorScheme::Category;
+    std::vector<uint32_t> styles;
+    computeStyles(features, scheme, styles);
+    PolygonOverlay overlay;
+    overlay.init(&camera, features, triangulation, styles);
+
+    bool fillKeyDown = false, outlineKeyDown = false, schemeKeyDown = false, rasterKeyDown = false;
+    int frame = 0;
+    int framesSinceTitle = 0;
+    double lastTitleTime = glfwGetTime();
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool fillKeyPressed = glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS;
+        if (fillKeyPressed && !fillKeyDown)
+            overlay.showFill = !overlay.showFill;
+        fillKeyDown = fillKeyPressed;
+
+        bool outlineKeyPressed = glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS;
+        if (outlineKeyPressed && !outlineKeyDown)
+            overlay.showOutlines = !overlay.showOutlines;
+        outlineKeyDown = outlineKeyPressed;
+
+        bool rasterKeyPressed = glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS;
+        if (rasterKeyPressed && !rasterKeyDown)
+            raster.visible = !raster.visible;
+        rasterKeyDown = rasterKeyPressed;
+
+        // C: restyle every feature; only the style buffer is rewritten
+        bool schemeKeyPressed = glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS;
+        if (schemeKeyPressed && !schemeKeyDown) {
+            scheme = static_cast<ColorScheme>((static_cast<int>(scheme) + 1) % 3);
+            computeStyles(features, scheme, styles);
+            overlay.updateStyles(styles.data(), 0, styles.size());
+        }
+        schemeKeyDown = schemeKeyPressed;
+
+        camera.publish(width, height);
+        raster.render();
+        overlay.render(camera);
+
+        ++framesSinceTitle;
+        double now = glfwGetTime();
+        if (now - lastTitleTime > 0.5) {
+            char title[256];
+            snprintf(title, sizeof(title), "OpenGL - %zu features | %d chunks visible, %.2fM triangles in %d draw calls | %s colours | %.1f ms/frame",
+                     features.featureCount(), overlay.visibleChunks, overlay.trianglesDrawn / 1e6, overlay.drawCalls,
+                     colorSchemeNames[static_cast<int>(scheme)], 1000.0 * (now - lastTitleTime) / framesSinceTitle);
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+            framesSinceTitle = 0;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    printf("Frames: %d\n", frame);
+
+    overlay.destroy();
+    raster.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,2084 @@
+// polygon overlay drawn from a per-zoom simplification pyramid
+// Vector geometry gets levels the way a raster gets a tile pyramid: level 0 is the full geometry at a nominal
+// levelZeroWidth pixels across the world, every further level halves that resolution, and the level drawn is
+// chosen from the camera scale with the same formula the raster tile pyramid uses. Level L keeps only the
+// detail above simplifyTolerance of its own pixels (Douglas-Peucker), so a zoomed-out view draws a fraction of
+// the vertices.
+// Simplification preserves topology the way TopoJSON does: rings are cut into arcs at junctions (points where
+// the neighbouring rings change), every arc is stored once however many rings share it, and arcs are
+// simplified with their end points fixed. Neighbouring parcels therefore keep exactly the same shared
+// boundary at every level, with no gaps or overlaps, and a ring that would fall under three points keeps the
+// most significant interior point of its arcs. The levels are built in parallel (arcs per level, rings per
+// feature), triangulated once and cached on disk like the full geometry, and culled through the packed R-tree
+// over the full-detail feature boxes, which bound every coarser level as well.
+// Usage: vector_pyramid [features.geojson] [--parcels N] [--raster image]
+// Keys: WASD pan, Q/E zoom, F fill, O outlines, C cycle colour scheme, B raster, L full detail at every zoom.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdio> // Include for printf
+
+// Generated city: parcel count, parcels per block edge (streets between blocks), share with a courtyard
+const int defaultParcelCount = 300000;
+const int parcelsPerBlock = 4;
+const float courtyardShare = 0.05f;
+
+// Triangulation, bulk-load and simplification threads (0 = one per hardware thread) and features per task
+const int triangulationThreadCount = 0;
+const int featuresPerTask = 2048;
+
+// Children per R-tree node; 16 floats per box coordinate fill one cache line
+const int rtreeFanout = 16;
+
+// Pyramid: level 0 spans this many pixels across x in [-1, 1]; levels down to 256 pixels
+const int levelZeroWidth = 65536;
+const int vectorLevelCount = 9;
+// Deviation a level may drop, in pixels of that level
+const float simplifyTolerance = 0.5f;
+// Added to the selected level (positive = coarser)
+const float lodBias = 0.0f;
+
+// Land-use classes of the generated parcels, and fill opacity over the raster
+const int categoryCount = 8;
+const float fillOpacity = 0.55f;
+
+const GLuint cameraBindingPoint = 0;
+
+const char* cameraBlockSource = R"(
+layout (std140) uniform CameraBlock
+{
+    mat4 viewProjection;
+    vec4 viewport;      // x, y, width, height in pixels
+    vec4 cameraParams;  // scale, offset.x, offset.y, unused
+};
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader Compilation Error: " << infoLog << std::endl;
+    }
+    return shader;
+}
+
+GLuint createCameraShaderProgram(const char* vertexBody, const char* fragmentSource) {
+    std::string vertexSource = std::string("#version 330 core\n") + cameraBlockSource + vertexBody;
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Program Linking Error: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+int resolveThreadCount() {
+    if (triangulationThreadCount > 0)
+        return triangulationThreadCount;
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Runs task(i) for i in [0, count) on up to threadCount threads (the caller is one of them)
+template <typename Task>
+void parallelFor(int count, int threadCount, const Task& task) {
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for (int i = next++; i < count; i = next++)
+            task(i);
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < std::min(threadCount, count); ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+class Camera {
+public:
+    struct BlockData {
+        glm::mat4 viewProjection;
+        glm::vec4 viewport;
+        glm::vec4 cameraParams;
+    };
+
+    Camera()
+        : scale(1.0f), offset(0.0f, 0.0f) {}
+
+    void processKeyboardInput(GLFWwindow* window) {
+        float cameraSpeed = 0.01f / scale;  // Adjusted sensitivity, constant on screen at any zoom
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            offset.y += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            offset.y -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            offset.x -= cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            offset.x += cameraSpeed;
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            scale *= 1.01f;
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            scale *= 0.99f;
+    }
+
+    glm::mat4 getTransform() const {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
+        model = glm::translate(model, glm::vec3(offset, 0.0f));
+        return model;
+    }
+
+    // World-space rectangle covered by the screen (min.x, min.y, max.x, max.y)
+    glm::vec4 getVisibleRect() const {
+        return glm::vec4(-1.0f / scale - offset.x, -1.0f / scale - offset.y,
+                          1.0f / scale - offset.x,  1.0f / scale - offset.y);
+    }
+
+    float getScale() const { return scale; }
+
+    void initUniformBuffer() {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, cameraBindingPoint, ubo);
+    }
+
+    void attachProgram(GLuint program) const {
+        GLuint blockIndex = glGetUniformBlockIndex(program, "CameraBlock");
+        if (blockIndex == GL_INVALID_INDEX) {
+            std::cerr << "Program has no CameraBlock" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, blockIndex, cameraBindingPoint);
+    }
+
+    void publish(int framebufferWidth, int framebufferHeight) {
+        BlockData data;
+        data.viewProjection = getTransform();
+        data.viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+        data.cameraParams = glm::vec4(scale, offset.x, offset.y, 0.0f);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    float scale;
+    glm::vec2 offset;
+    GLuint ubo = 0;
+};
+
+// ---------------------------------------------------------------------------------------------------------
+// Features
+// ---------------------------------------------------------------------------------------------------------
+
+// Polygons in flat arrays: feature f owns rings [featureRings[f], featureRings[f + 1]), ring r owns points
+// [ringPoints[r], ringPoints[r + 1]). The first ring of a feature is its outer boundary, the others are holes;
+// rings are open (the first point is not repeated).
+struct FeatureSet {
+    std::vector<glm::vec2> points;
+    std::vector<uint32_t> ringPoints = { 0 };
+    std::vector<uint32_t> featureRings = { 0 };
+    std::vector<uint8_t> categories;
+
+    size_t featureCount() const { return featureRings.size() - 1; }
+    uint32_t firstPoint(size_t feature) const { return ringPoints[featureRings[feature]]; }
+    uint32_t pointCount(size_t feature) const { return ringPoints[featureRings[feature + 1]] - firstPoint(feature); }
+
+    void addRing(const std::vector<glm::vec2>& ring) {
+        points.insert(points.end(), ring.begin(), ring.end());
+        ringPoints.push_back(static_cast<uint32_t>(points.size()));
+    }
+    void endFeature(uint8_t category) {
+        featureRings.push_back(static_cast<uint32_t>(ringPoints.size() - 1));
+        categories.push_back(category);
+    }
+
+    // Bounding box of a feature (min.x, min.y, max.x, max.y)
+    glm::vec4 bounds(size_t feature) const {
+        glm::vec4 box(1e30f, 1e30f, -1e30f, -1e30f);
+        for (uint32_t i = firstPoint(feature), end = i + pointCount(feature); i < end; ++i) {
+            box.x = std::min(box.x, points[i].x);
+            box.y = std::min(box.y, points[i].y);
+            box.z = std::max(box.z, points[i].x);
+            box.w = std::max(box.w, points[i].y);
+        }
+        return box;
+    }
+};
+
+// Hash of coordinates and ring structure, the key of the triangulation cache (FNV-1a)
+uint64_t geometryHash(const FeatureSet& features) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    };
+    mix(features.points.data(), features.points.size() * sizeof(glm::vec2));
+    mix(features.ringPoints.data(), features.ringPoints.size() * sizeof(uint32_t));
+    mix(features.featureRings.data(), features.featureRings.size() * sizeof(uint32_t));
+    return hash;
+}
+
+// Deterministic noise in [0, 1) from a lattice coordinate, so neighbouring parcels agree on shared points
+float latticeNoise(int x, int y, int salt) {
+    uint32_t h = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u ^ static_cast<uint32_t>(salt) * 83492791u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return (h & 0xFFFFFF) / 16777216.0f;
+}
+
+// A square city of blocks of parcelsPerBlock^2 parcels separated by streets. Corners inside a block are
+// jittered and parcel edges get 0-3 extra points; both are derived from lattice coordinates, so every edge
+// has exactly the same points in the two parcels sharing it.
+void generateParcels(int parcelCount, FeatureSet& features) {
+    int perSide = std::max(parcelsPerBlock, static_cast<int>(std::ceil(std::sqrt(static_cast<float>(parcelCount)))));
+    perSide = (perSide + parcelsPerBlock - 1) / parcelsPerBlock * parcelsPerBlock;
+    int blocks = perSide / parcelsPerBlock;
+    // World [-1, 1]: each block is parcelsPerBlock cells plus a street of 0.6 cells
+    float cell = 2.0f / (perSide + blocks * 0.6f);
+    float street = 0.6f * cell;
+
+    // Lattice corner (i, j) as seen from the parcels of block (bi, bj): corners on the block edge belong to
+    // that block, so neighbouring blocks never share them and the streets stay open
+    auto corner = [&](int bi, int bj, int i, int j) {
+        int li = i - bi * parcelsPerBlock, lj = j - bj * parcelsPerBlock;
+        glm::vec2 p(-1.0f + street * 0.5f + bi * (parcelsPerBlock * cell + street) + li * cell,
+                    -1.0f + street * 0.5f + bj * (parcelsPerBlock * cell + street) + lj * cell);
+        // Block outlines stay straight along the streets
+        if (li > 0 && li < parcelsPerBlock)
+            p.x += (latticeNoise(i, j, 1) - 0.5f) * 0.35f * cell;
+        if (lj > 0 && lj < parcelsPerBlock)
+            p.y += (latticeNoise(i, j, 2) - 0.5f) * 0.35f * cell;
+        return p;
+    };
+    // Points strictly between corner (i0, j0) and its neighbour along one axis, in that direction
+    auto edgePoints = [&](int bi, int bj, int i0, int j0, bool alongX, std::vector<glm::vec2>& out) {
+        int i1 = alongX ? i0 + 1 : i0, j1 = alongX ? j0 : j0 + 1;
+        glm::vec2 a = corner(bi, bj, i0, j0), b = corner(bi, bj, i1, j1);
+        int salt = alongX ? 3 : 4;
+        int extra = static_cast<int>(latticeNoise(i0, j0, salt) * 4.0f);
+        bool onStreet = alongX ? (j0 % parcelsPerBlock == 0) : (i0 % parcelsPerBlock == 0);
+        glm::vec2 normal(-(b.y - a.y), b.x - a.x);
+        for (int k = 1; k <= extra; ++k) {
+            float t = static_cast<float>(k) / (extra + 1);
+            float bend = onStreet ? 0.0f : (latticeNoise(i0 * 4 + k, j0, salt + 2) - 0.5f) * 0.15f;
+            out.push_back(a + (b - a) * t + normal * bend);
+        }
+    };
+
+    int count = std::min(parcelCount, perSide * perSide);
+    std::vector<glm::vec2> ring, edge;
+    for (int n = 0; n < count; ++n) {
+        int i = n % perSide, j = n / perSide;
+        int bi = i / parcelsPerBlock, bj = j / parcelsPerBlock;
+        // Counter-clockwise: bottom, right, top (reversed), left (reversed)
+        ring.clear();
+        ring.push_back(corner(bi, bj, i, j));
+        edgePoints(bi, bj, i, j, true, ring);
+        ring.push_back(corner(bi, bj, i + 1, j));
+        edgePoints(bi, bj, i + 1, j, false, ring);
+        ring.push_back(corner(bi, bj, i + 1, j + 1));
+        edge.clear();
+        edgePoints(bi, bj, i, j + 1, true, edge);
+        ring.insert(ring.end(), edge.rbegin(), edge.rend());
+        ring.push_back(corner(bi, bj, i, j + 1));
+        edge.clear();
+        edgePoints(bi, bj, i, j, false, edge);
+        ring.insert(ring.end(), edge.rbegin(), edge.rend());
+        features.addRing(ring);
+
+        if (latticeNoise(i, j, 7) < courtyardShare) {
+            // Clockwise square in the middle third of the parcel
+            glm::vec2 lo = corner(bi, bj, i, j) * (2.0f / 3.0f) + corner(bi, bj, i + 1, j + 1) * (1.0f / 3.0f);
+            glm::vec2 hi = corner(bi, bj, i, j) * (1.0f / 3.0f) + corner(bi, bj, i + 1, j + 1) * (2.0f / 3.0f);
+            features.addRing({ lo, glm::vec2(lo.x, hi.y), hi, glm::vec2(hi.x, lo.y) });
+        }
+        features.endFeature(static_cast<uint8_t>(latticeNoise(i / 2, j / 2, 9) * categoryCount));
+    }
+    printf("Generated %d parcels in %d x %d blocks, %zu points\n", count, blocks, blocks, features.points.size());
+}
+
+// Polygon and MultiPolygon geometries of a GeoJSON file, one feature per polygon, fitted to x in [-1, 1].
+// Only "coordinates" arrays are parsed; coordinate nesting depth tells the geometry type, other types are
+// skipped.
+bool loadGeoJson(const std::string& path, FeatureSet& features) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+
+    std::vector<glm::dvec2> points;
+    std::vector<uint32_t> ringEnds, polygonEnds;   // into points / ringEnds
+    size_t pos = 0;
+    while ((pos = text.find("\"coordinates\"", pos)) != std::string::npos) {
+        pos = text.find('[', pos);
+        if (pos == std::string::npos)
+            break;
+        int numberDepth = 0;
+        for (size_t p = pos; p < text.size() && (text[p] == '[' || isspace(static_cast<unsigned char>(text[p]))); ++p)
+            numberDepth += text[p] == '[';
+        int depth = 0;
+        std::vector<double> values;
+        do {
+            char c = text[pos];
+            if (c == '[') {
+                ++depth;
+                ++pos;
+            } else if (c == ']') {
+                if (depth == numberDepth && values.size() >= 2)
+                    points.push_back(glm::dvec2(values[0], values[1]));
+                else if (depth == numberDepth - 1 && (numberDepth == 3 || numberDepth == 4))
+                    ringEnds.push_back(static_cast<uint32_t>(points.size()));
+                else if (depth == numberDepth - 2 && (numberDepth == 3 || numberDepth == 4))
+                    polygonEnds.push_back(static_cast<uint32_t>(ringEnds.size()));
+                values.clear();
+                --depth;
+                ++pos;
+            } else if (c == '-' || c == '+' || c == '.' || isdigit(static_cast<unsigned char>(c))) {
+                char* end = nullptr;
+                values.push_back(std::strtod(text.c_str() + pos, &end));
+                pos = end - text.c_str();
+            } else {
+                ++pos;
+            }
+        } while (depth > 0 && pos < text.size());
+        // Points and lines leave no rings behind; drop what they added
+        if (numberDepth < 3) {
+            size_t kept = ringEnds.empty() ? 0 : ringEnds.back();
+            points.resize(kept);
+        }
+    }
+    if (polygonEnds.empty())
+        return false;
+
+    glm::dvec2 lo(1e300, 1e300), hi(-1e300, -1e300);
+    for (const glm::dvec2& p : points) {
+        lo.x = std::min(lo.x, p.x);
+        lo.y = std::min(lo.y, p.y);
+        hi.x = std::max(hi.x, p.x);
+        hi.y = std::max(hi.y, p.y);
+    }
+    double scale = 2.0 / std::max(hi.x - lo.x, 1e-12);
+    glm::dvec2 center((lo.x + hi.x) * 0.5, (lo.y + hi.y) * 0.5);
+
+    std::vector<glm::vec2> ring;
+    uint32_t ringStart = 0, ringIndex = 0;
+    for (size_t polygon = 0; polygon < polygonEnds.size(); ++polygon) {
+        for (; ringIndex < polygonEnds[polygon]; ++ringIndex) {
+            uint32_t ringEnd = ringEnds[ringIndex];
+            // GeoJSON closes rings by repeating the first point
+            uint32_t last = ringEnd;
+            if (last - ringStart > 1 && points[last - 1].x == points[ringStart].x && points[last - 1].y == points[ringStart].y)
+                --last;
+            ring.clear();
+            for (uint32_t i = ringStart; i < last; ++i)
+                ring.push_back(glm::vec2(static_cast<float>((points[i].x - center.x) * scale), static_cast<float>((points[i].y - center.y) * scale)));
+            if (ring.size() >= 3)
+                features.addRing(ring);
+            ringStart = ringEnd;
+        }
+        if (features.ringPoints.size() - 1 > features.featureRings.back())
+            features.endFeature(static_cast<uint8_t>(polygon % categoryCount));
+    }
+    printf("GeoJSON %s: %zu polygons, %zu points\n", path.c_str(), features.featureCount(), features.points.size());
+    return features.featureCount() > 0;
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Triangulation
+// ---------------------------------------------------------------------------------------------------------
+
+// Ear clipping with holes after Mapbox's earcut: holes are joined to the outer ring through bridge edges, then
+// ears are cut from the resulting single ring. When no ear is left, points are filtered, local
+// self-intersections are cured and finally the ring is split along a valid diagonal, so malformed input still
+// yields triangles. No z-order hashing: features here are parcels of tens of points.
+// One Triangulator per thread; its node pool is reused from feature to feature.
+class Triangulator {
+public:
+    // triangles receives point indices relative to the feature's first point
+    void triangulate(const FeatureSet& features, size_t feature, std::vector<uint32_t>& triangles) {
+        triangles.clear();
+        uint32_t firstRing = features.featureRings[feature], endRing = features.featureRings[feature + 1];
+        uint32_t base = features.ringPoints[firstRing];
+        m_nodes.clear();
+        m_nodes.reserve(4 * static_cast<size_t>(features.ringPoints[endRing] - base) + 16);
+
+        Node* outer = linkedList(features, firstRing, base, true);
+        if (!outer || outer->next == outer->prev)
+            return;
+        if (endRing - firstRing > 1)
+            outer = eliminateHoles(features, firstRing + 1, endRing, base, outer);
+        earcutLinked(outer, triangles, 0);
+    }
+
+private:
+    struct Node {
+        uint32_t i;
+        double x, y;
+        Node* prev = nullptr;
+        Node* next = nullptr;
+        bool steiner = false;
+    };
+    // Reserved up front for every node a feature can need, so node pointers stay valid
+    std::vector<Node> m_nodes;
+
+    Node* insertNode(uint32_t i, double x, double y, Node* last) {
+        m_nodes.push_back(Node());
+        Node* p = &m_nodes.back();
+        p->i = i;
+        p->x = x;
+        p->y = y;
+        if (!last) {
+            p->prev = p;
+            p->next = p;
+        } else {
+            p->next = last->next;
+            p->prev = last;
+            last->next->prev = p;
+            last->next = p;
+        }
+        return p;
+    }
+
+    static void removeNode(Node* p) {
+        p->next->prev = p->prev;
+        p->prev->next = p->next;
+    }
+
+    static double area(const Node* p, const Node* q, const Node* r) {
+        return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+    }
+    static bool equals(const Node* a, const Node* b) { return a->x == b->x && a->y == b->y; }
+    static int sign(double v) { return v > 0.0 ? 1 : v < 0.0 ? -1 : 0; }
+
+    static bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py) {
+        return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+               (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+               (bx - px) * (cy - py) >= (cx - px) * (by - py);
+    }
+
+    static bool onSegment(const Node* p, const Node* q, const Node* r) {
+        return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) && q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+    }
+
+    static bool intersects(const Node* p1, const Node* q1, const Node* p2, const Node* q2) {
+        int o1 = sign(area(p1, q1, p2)), o2 = sign(area(p1, q1, q2)), o3 = sign(area(p2, q2, p1)), o4 = sign(area(p2, q2, q1));
+        if (o1 != o2 && o3 != o4)
+            return true;
+        return (o1 == 0 && onSegment(p1, p2, q1)) || (o2 == 0 && onSegment(p1, q2, q1)) ||
+               (o3 == 0 && onSegment(p2, p1, q2)) || (o4 == 0 && onSegment(p2, q1, q2));
+    }
+
+    static bool intersectsPolygon(const Node* a, const Node* b) {
+        const Node* p = a;
+        do {
+            if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i && intersects(p, p->next, a, b))
+                return true;
+            p = p->next;
+        } while (p != a);
+        return false;
+    }
+
+    static bool locallyInside(const Node* a, const Node* b) {
+        return area(a->prev, a, a->next) < 0 ? area(a, b, a->next) >= 0 && area(a, a->prev, b) >= 0
+                                              : area(a, b, a->prev) < 0 || area(a, a->next, b) < 0;
+    }
+
+    static bool middleInside(const Node* a, const Node* b) {
+        const Node* p = a;
+        bool inside = false;
+        double px = (a->x + b->x) / 2, py = (a->y + b->y) / 2;
+        do {
+            if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
+                (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
+                inside = !inside;
+            p = p->next;
+        } while (p != a);
+        return inside;
+    }
+
+    static bool isValidDiagonal(const Node* a, const Node* b) {
+        return a->next->i != b->i && a->prev->i != b->i && !intersectsPolygon(a, b) &&
+               ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) && (area(a->prev, a, b->prev) != 0 || area(a, b->prev, b) != 0)) ||
+                (equals(a, b) && area(a->prev, a, a->next) > 0 && area(b->prev, b, b->next) > 0));
+    }
+
+    // Ring in the winding the ear test expects (clockwise for the outer ring in earcut's convention)
+    Node* linkedList(const FeatureSet& features, uint32_t ring, uint32_t base, bool clockwise) {
+        uint32_t start = features.ringPoints[ring], end = features.ringPoints[ring + 1];
+        double sum = 0.0;
+        for (uint32_t i = start, j = end - 1; i < end; j = i++)
+            sum += (static_cast<double>(features.points[j].x) - features.points[i].x) * (static_cast<double>(features.points[i].y) + features.points[j].y);
+        Node* last = nullptr;
+        if (clockwise == (sum > 0.0)) {
+            for (uint32_t i = start; i < end; ++i)
+                last = insertNode(i - base, features.points[i].x, features.points[i].y, last);
+        } else {
+            for (uint32_t i = end; i-- > start;)
+                last = insertNode(i - base, features.points[i].x, features.points[i].y, last);
+        }
+        if (last && equals(last, last->next)) {
+            removeNode(last);
+            last = last->next;
+        }
+        return last;
+    }
+
+    // Removes duplicate and collinear points
+    static Node* filterPoints(Node* start, Node* end = nullptr) {
+        if (!start)
+            return start;
+        if (!end)
+            end = start;
+        Node* p = start;
+        bool again;
+        do {
+            again = false;
+            if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0)) {
+                removeNode(p);
+                p = end = p->prev;
+                if (p == p->next)
+                    break;
+                again = true;
+            } else {
+                p = p->next;
+            }
+        } while (again || p != end);
+        return end;
+    }
+
+    static bool isEar(const Node* ear) {
+        const Node* a = ear->prev;
+        const Node* b = ear;
+        const Node* c = ear->next;
+        if (area(a, b, c) >= 0)
+            return false;   // reflex
+        double x0 = std::min(a->x, std::min(b->x, c->x)), y0 = std::min(a->y, std::min(b->y, c->y));
+        double x1 = std::max(a->x, std::max(b->x, c->x)), y1 = std::max(a->y, std::max(b->y, c->y));
+        for (const Node* p = c->next; p != a; p = p->next) {
+            if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+                pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) && area(p->prev, p, p->next) >= 0)
+                return false;
+        }
+        return true;
+    }
+
+    static void emit(std::vector<uint32_t>& triangles, const Node* a, const Node* b, const Node* c) {
+        triangles.push_back(a->i);
+        triangles.push_back(b->i);
+        triangles.push_back(c->i);
+    }
+
+    void earcutLinked(Node* ear, std::vector<uint32_t>& triangles, int pass) {
+        if (!ear)
+            return;
+        Node* stop = ear;
+        while (ear->prev != ear->next) {
+            Node* prev = ear->prev;
+            Node* next = ear->next;
+            if (isEar(ear)) {
+                emit(triangles, prev, ear, next);
+                removeNode(ear);
+                ear = next->next;
+                stop = next->next;
+                continue;
+            }
+            ear = next;
+            if (ear == stop) {
+                if (pass == 0) {
+                    earcutLinked(filterPoints(ear), triangles, 1);
+                } else if (pass == 1) {
+                    ear = cureLocalIntersections(filterPoints(ear), triangles);
+                    earcutLinked(ear, triangles, 2);
+                } else {
+                    splitEarcut(ear, triangles);
+                }
+                break;
+            }
+        }
+    }
+
+    static Node* cureLocalIntersections(Node* start, std::vector<uint32_t>& triangles) {
+        Node* p = start;
+        do {
+            Node* a = p->prev;
+            Node* b = p->next->next;
+            if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a)) {
+                emit(triangles, a, p, b);
+                removeNode(p);
+                removeNode(p->next);
+                p = start = b;
+            }
+            p = p->next;
+        } while (p != start);
+        return filterPoints(p);
+    }
+
+    void splitEarcut(Node* start, std::vector<uint32_t>& triangles) {
+        Node* a = start;
+        do {
+            for (Node* b = a->next->next; b != a->prev; b = b->next) {
+                if (a->i != b->i && isValidDiagonal(a, b)) {
+                    Node* c = splitPolygon(a, b);
+                    a = filterPoints(a, a->next);
+                    c = filterPoints(c, c->next);
+                    earcutLinked(a, triangles, 0);
+                    earcutLinked(c, triangles, 0);
+                    return;
+                }
+            }
+            a = a->next;
+        } while (a != start);
+    }
+
+    // Links a and b with a two-way edge; returns the copy of b on the split-off ring
+    Node* splitPolygon(Node* a, Node* b) {
+        Node* a2 = insertNode(a->i, a->x, a->y, nullptr);
+        Node* b2 = insertNode(b->i, b->x, b->y, nullptr);
+        Node* an = a->next;
+        Node* bp = b->prev;
+        a->next = b;
+        b->prev = a;
+        a2->next = an;
+        an->prev = a2;
+        b2->next = a2;
+        a2->prev = b2;
+        bp->next = b2;
+        b2->prev = bp;
+        return b2;
+    }
+
+    static Node* getLeftmost(Node* start) {
+        Node* p = start;
+        Node* leftmost = start;
+        do {
+            if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y))
+                leftmost = p;
+            p = p->next;
+        } while (p != start);
+        return leftmost;
+    }
+
+    static bool sectorContainsSector(const Node* m, const Node* p) {
+        return area(m->prev, m, p->prev) < 0 && area(p->next, m, m->next) < 0;
+    }
+
+    // Outer-ring point that the hole's leftmost point can see: the nearest edge hit by a ray to the left,
+    // then the reflex point inside that triangle with the smallest angle to the ray
+    static Node* findHoleBridge(Node* hole, Node* outerNode) {
+        Node* p = outerNode;
+        double hx = hole->x, hy = hole->y, qx = -1e300;
+        Node* m = nullptr;
+        do {
+            if (hy <= p->y && hy >= p->next->y && p->next->y != p->y) {
+                double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+                if (x <= hx && x > qx) {
+                    qx = x;
+                    m = p->x < p->next->x ? p : p->next;
+                    if (x == hx)
+                        return m;
+                }
+            }
+            p = p->next;
+        } while (p != outerNode);
+        if (!m)
+            return nullptr;
+
+        Node* stop = m;
+        double mx = m->x, my = m->y, tanMin = 1e300;
+        p = m;
+        do {
+            if (hx >= p->x && p->x >= mx && hx != p->x &&
+                pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y)) {
+                double tan = std::fabs(hy - p->y) / (hx - p->x);
+                if (locallyInside(p, hole) &&
+                    (tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p)))))) {
+                    m = p;
+                    tanMin = tan;
+                }
+            }
+            p = p->next;
+        } while (p != stop);
+        return m;
+    }
+
+    Node* eliminateHoles(const FeatureSet& features, uint32_t firstHole, uint32_t endRing, uint32_t base, Node* outerNode) {
+        std::vector<Node*> queue;
+        for (uint32_t ring = firstHole; ring < endRing; ++ring) {
+            Node* list = linkedList(features, ring, base, false);
+            if (!list)
+                continue;
+            if (list == list->next)
+                list->steiner = true;
+            queue.push_back(getLeftmost(list));
+        }
+        std::sort(queue.begin(), queue.end(), [](const Node* a, const Node* b) { return a->x < b->x; });
+        for (Node* hole : queue) {
+            Node* bridge = findHoleBridge(hole, outerNode);
+            if (!bridge)
+                continue;
+            Node* bridgeReverse = splitPolygon(bridge, hole);
+            filterPoints(bridgeReverse, bridgeReverse->next);
+            outerNode = filterPoints(bridge, bridge->next);
+        }
+        return outerNode;
+    }
+};
+
+// Triangles of every feature, relative to the feature's first point
+struct Triangulation {
+    std::vector<uint32_t> featureIndices = { 0 };   // feature f owns indices [featureIndices[f], featureIndices[f + 1])
+    std::vector<uint32_t> indices;
+};
+
+void triangulateAll(const FeatureSet& features, int threadCount, Triangulation& result) {
+    size_t featureCount = features.featureCount();
+    int taskCount = static_cast<int>((featureCount + featuresPerTask - 1) / featuresPerTask);
+    std::vector<std::vector<uint32_t>> taskIndices(taskCount), taskCounts(taskCount);
+    parallelFor(taskCount, threadCount, [&](int task) {
+        Triangulator triangulator;
+        std::vector<uint32_t> triangles;
+        size_t end = std::min(featureCount, static_cast<size_t>(task + 1) * featuresPerTask);
+        for (size_t f = static_cast<size_t>(task) * featuresPerTask; f < end; ++f) {
+            triangulator.triangulate(features, f, triangles);
+            taskIndices[task].insert(taskIndices[task].end(), triangles.begin(), triangles.end());
+            taskCounts[task].push_back(static_cast<uint32_t>(triangles.size()));
+        }
+    });
+    result.featureIndices.assign(1, 0);
+    result.indices.clear();
+    for (int task = 0; task < taskCount; ++task) {
+        for (uint32_t count : taskCounts[task])
+            result.featureIndices.push_back(result.featureIndices.back() + count);
+        result.indices.insert(result.indices.end(), taskIndices[task].begin(), taskIndices[task].end());
+    }
+}
+
+// Triangulations on disk, named by geometry hash: magic, hash, feature count, per-feature offsets, indices
+const char triangulationMagic[8] = { 'I', 'O', 'R', 'P', 'T', 'R', 'I', '1' };
+
+std::string triangulationCachePath(uint64_t hash) {
+    char name[64];
+    snprintf(name, sizeof(name), "iorp_triangles_%016llx.bin", static_cast<unsigned long long>(hash));
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// The cache sits under a predictable name in the shared temp directory, so nothing read from it is trusted:
+// the sizes must match the file, the feature offsets must rise from 0 to the index count in whole triangles,
+// and every index must name a point of its own feature. Any mismatch means triangulating again.
+bool loadTriangulation(const std::string& path, uint64_t hash, const FeatureSet& features, Triangulation& result) {
+    size_t featureCount = features.featureCount();
+    std::error_code error;
+    uint64_t fileSize = std::filesystem::file_size(path, error);
+    if (error)
+        return false;
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    char magic[8];
+    uint64_t storedHash = 0, storedCount = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&storedHash), sizeof(storedHash));
+    in.read(reinterpret_cast<char*>(&storedCount), sizeof(storedCount));
+    if (!in || memcmp(magic, triangulationMagic, sizeof(magic)) != 0 || storedHash != hash || storedCount != featureCount)
+        return false;
+    uint64_t headerBytes = sizeof(magic) + sizeof(storedHash) + sizeof(storedCount);
+    uint64_t offsetBytes = (static_cast<uint64_t>(featureCount) + 1) * sizeof(uint32_t);
+    if (fileSize < headerBytes + offsetBytes)
+        return false;
+    result.featureIndices.resize(featureCount + 1);
+    in.read(reinterpret_cast<char*>(result.featureIndices.data()), result.featureIndices.size() * sizeof(uint32_t));
+    if (!in || result.featureIndices[0] != 0 || fileSize != headerBytes + offsetBytes + static_cast<uint64_t>(result.featureIndices.back()) * sizeof(uint32_t))
+        return false;
+    for (size_t f = 0; f < featureCount; ++f)
+        if (result.featureIndices[f + 1] < result.featureIndices[f] || (result.featureIndices[f + 1] - result.featureIndices[f]) % 3 != 0)
+            return false;
+    result.indices.resize(result.featureIndices.back());
+    in.read(reinterpret_cast<char*>(result.indices.data()), result.indices.size() * sizeof(uint32_t));
+    if (!in)
+        return false;
+    for (size_t f = 0; f < featureCount; ++f) {
+        uint32_t pointCount = features.pointCount(f);
+        for (uint32_t i = result.featureIndices[f]; i < result.featureIndices[f + 1]; ++i)
+            if (result.indices[i] >= pointCount)
+                return false;
+    }
+    return true;
+}
+
+void saveTriangulation(const std::string& path, uint64_t hash, const Triangulation& triangulation) {
+    // Written aside and renamed, so a concurrent run never reads half a file
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary);
+        uint64_t count = triangulation.featureIndices.size() - 1;
+        out.write(triangulationMagic, sizeof(triangulationMagic));
+        out.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char*>(triangulation.featureIndices.data()), triangulation.featureIndices.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(triangulation.indices.data()), triangulation.indices.size() * sizeof(uint32_t));
+        if (!out) {
+            std::cerr << "Failed to write triangulation cache " << temporary << std::endl;
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error)
+        std::cerr << "Failed to write triangulation cache " << path << ": " << error.message() << std::endl;
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Spatial index
+// ---------------------------------------------------------------------------------------------------------
+
+// Sorts on up to threadCount threads: ranges are sorted in parallel, then merged pairwise in parallel rounds
+template <typename T, typename Less>
+void parallelSort(std::vector<T>& values, int threadCount, Less less) {
+    int parts = static_cast<int>(std::min<size_t>(threadCount, values.size() / 4096));
+    if (parts <= 1) {
+        std::sort(values.begin(), values.end(), less);
+        return;
+    }
+    std::vector<size_t> bounds(parts + 1);
+    for (int i = 0; i <= parts; ++i)
+        bounds[i] = values.size() * i / parts;
+    parallelFor(parts, threadCount, [&](int i) {
+        std::sort(values.begin() + bounds[i], values.begin() + bounds[i + 1], less);
+    });
+    for (int width = 1; width < parts; width *= 2) {
+        int merges = (parts + 2 * width - 1) / (2 * width);
+        parallelFor(merges, threadCount, [&](int m) {
+            int first = m * 2 * width;
+            int middle = std::min(first + width, parts), last = std::min(first + 2 * width, parts);
+            if (middle < last)
+                std::inplace_merge(values.begin() + bounds[first], values.begin() + bounds[middle], values.begin() + bounds[last], less);
+        });
+    }
+}
+
+// Index of the lowest set bit of a non-zero mask
+inline int countTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// Static R-tree over feature boxes (min.x, min.y, max.x, max.y).
+// build() packs the boxes Sort-Tile-Recursive level by level (sorted into vertical slices by centre x, each
+// slice by centre y, rtreeFanout to a node) and then lays the nodes out breadth first, root first. It returns
+// the features in the order of the leaves; once the caller renumbers its features in that order, item i of the
+// tree is feature i and every node covers one contiguous run of features [firstItem, firstItem + itemCount).
+class FeatureIndex {
+public:
+    struct Stats {
+        double sortMilliseconds = 0.0;
+        double layoutMilliseconds = 0.0;
+        int levels = 0;
+    };
+
+    std::vector<uint32_t> build(const std::vector<glm::vec4>& boxes, int threadCount) {
+        m_nodes.clear();
+        m_firstLeaf = 0;
+        m_stats = Stats();
+        std::vector<uint32_t> order;
+        if (boxes.empty())
+            return order;
+
+        // Bottom up: level 0 groups features into leaves, each further level groups the nodes below
+        auto start = std::chrono::steady_clock::now();
+        std::vector<BuildLevel> levels;
+        const std::vector<glm::vec4>* entryBoxes = &boxes;
+        while (levels.empty() || levels.back().boxes.size() > 1) {
+            BuildLevel level;
+            size_t entryCount = entryBoxes->size();
+            level.children.resize(entryCount);
+            for (size_t i = 0; i < entryCount; ++i)
+                level.children[i] = static_cast<uint32_t>(i);
+            sortTiles(level.children, *entryBoxes, threadCount);
+
+            size_t nodeCount = (entryCount + rtreeFanout - 1) / rtreeFanout;
+            level.boxes.resize(nodeCount);
+            parallelFor(static_cast<int>(nodeCount), threadCount, [&](int node) {
+                size_t first = static_cast<size_t>(node) * rtreeFanout, end = std::min(first + rtreeFanout, entryCount);
+                glm::vec4 box = (*entryBoxes)[level.children[first]];
+                for (size_t i = first + 1; i < end; ++i)
+                    box = unite(box, (*entryBoxes)[level.children[i]]);
+                level.boxes[node] = box;
+            });
+            levels.push_back(std::move(level));
+            entryBoxes = &levels.back().boxes;
+        }
+        m_stats.sortMilliseconds = millisecondsSince(start);
+        m_stats.levels = static_cast<int>(levels.size());
+
+        // Breadth first from the root: the children of consecutive nodes are consecutive, so a node's subtree
+        // ends up over one run of leaves and the leaves, read in order, give the feature order
+        start = std::chrono::steady_clock::now();
+        struct Placement {
+            int level;
+            uint32_t node;   // index within its build level
+        };
+        std::vector<Placement> placements;
+        std::vector<uint32_t> current(1, 0), next;
+        for (int level = static_cast<int>(levels.size()) - 1; level >= 0; --level) {
+            if (level == 0)
+                m_firstLeaf = static_cast<uint32_t>(placements.size());
+            next.clear();
+            for (uint32_t node : current) {
+                placements.push_back(Placement{ level, node });
+                size_t first = static_cast<size_t>(node) * rtreeFanout;
+                size_t end = std::min(first + rtreeFanout, levels[level].children.size());
+                for (size_t i = first; i < end; ++i)
+                    (level == 0 ? order : next).push_back(levels[level].children[i]);
+            }
+            current.swap(next);
+        }
+
+        // Child boxes in parallel; the child ranges follow from the breadth-first numbering
+        m_nodes.resize(placements.size());
+        std::vector<uint32_t> firstChild(placements.size() + 1);
+        uint32_t childBase = 1;
+        for (size_t n = 0; n < placements.size(); ++n) {
+            if (n == m_firstLeaf)
+                childBase = 0;   // leaf children are items, numbered from 0
+            firstChild[n] = childBase;
+            const BuildLevel& level = levels[placements[n].level];
+            size_t first = static_cast<size_t>(placements[n].node) * rtreeFanout;
+            childBase += static_cast<uint32_t>(std::min<size_t>(rtreeFanout, level.children.size() - first));
+        }
+        parallelFor(static_cast<int>(placements.size()), threadCount, [&](int n) {
+            const Placement& placement = placements[n];
+            const BuildLevel& level = levels[placement.level];
+            const std::vector<glm::vec4>& childBoxes = placement.level == 0 ? boxes : levels[placement.level - 1].boxes;
+            size_t first = static_cast<size_t>(placement.node) * rtreeFanout;
+            size_t count = std::min<size_t>(rtreeFanout, level.children.size() - first);
+            Node& node = m_nodes[n];
+            node.firstChild = firstChild[n];
+            node.childCount = static_cast<uint32_t>(count);
+            for (size_t c = 0; c < rtreeFanout; ++c) {
+                // Unused slots get an empty box that no query overlaps
+                glm::vec4 box = c < count ? childBoxes[level.children[first + c]] : glm::vec4(1e30f, 1e30f, -1e30f, -1e30f);
+                node.minX[c] = box.x;
+                node.minY[c] = box.y;
+                node.maxX[c] = box.z;
+                node.maxY[c] = box.w;
+            }
+        });
+        // Item runs bottom up; children always come after their parent
+        for (size_t n = m_nodes.size(); n-- > 0;) {
+            Node& node = m_nodes[n];
+            if (n >= m_firstLeaf) {
+                node.firstItem = node.firstChild;
+                node.itemCount = node.childCount;
+            } else {
+                node.firstItem = m_nodes[node.firstChild].firstItem;
+                node.itemCount = 0;
+                for (uint32_t c = 0; c < node.childCount; ++c)
+                    node.itemCount += m_nodes[node.firstChild + c].itemCount;
+            }
+        }
+        m_bounds = levels.back().boxes[0];
+        m_stats.layoutMilliseconds = millisecondsSince(start);
+        return order;
+    }
+
+    // Calls visit(firstItem, count) for runs of items whose box overlaps rect (edges included), in increasing
+    // item order. A child wholly inside rect is reported as one run without visiting its subtree.
+    template <typename Visit>
+    void query(const glm::vec4& rect, Visit visit) const {
+        if (m_nodes.empty() || !overlaps(m_bounds, rect))
+            return;
+        if (contains(rect, m_bounds)) {
+            visit(m_nodes[0].firstItem, m_nodes[0].itemCount);
+            return;
+        }
+        // Depth first, children pushed last to first so runs come out in order; every level adds at most
+        // rtreeFanout - 1 entries
+        uint32_t stack[512];
+        int depth = 0;
+        stack[depth++] = 0;
+        while (depth > 0) {
+            uint32_t nodeIndex = stack[--depth];
+            if (nodeIndex & insideFlag) {
+                const Node& inside = m_nodes[nodeIndex & ~insideFlag];
+                visit(inside.firstItem, inside.itemCount);
+                continue;
+            }
+            const Node& node = m_nodes[nodeIndex];
+            bool leaf = nodeIndex >= m_firstLeaf;
+            uint32_t overlapMask = 0, insideMask = 0;
+            for (int c = 0; c < rtreeFanout; ++c) {
+                bool overlap = node.minX[c] <= rect.z && node.maxX[c] >= rect.x && node.minY[c] <= rect.w && node.maxY[c] >= rect.y;
+                bool inside = node.minX[c] >= rect.x && node.maxX[c] <= rect.z && node.minY[c] >= rect.y && node.maxY[c] <= rect.w;
+                overlapMask |= static_cast<uint32_t>(overlap) << c;
+                insideMask |= static_cast<uint32_t>(inside) << c;
+            }
+            if (leaf) {
+                // Runs of consecutive overlapping items
+                while (overlapMask) {
+                    int first = countTrailingZeros(overlapMask);
+                    int run = countTrailingZeros(~(overlapMask >> first));
+                    visit(node.firstChild + first, static_cast<uint32_t>(run));
+                    overlapMask &= ~0u << (first + run);
+                }
+                continue;
+            }
+            for (int c = rtreeFanout - 1; c >= 0; --c) {
+                if (!(overlapMask >> c & 1))
+                    continue;
+                // Wholly inside children are reported when popped, which keeps the runs in order
+                if (insideMask >> c & 1)
+                    stack[depth++] = (node.firstChild + c) | insideFlag;
+                else
+                    stack[depth++] = node.firstChild + c;
+            }
+        }
+    }
+
+    // Items whose box contains point
+    template <typename Visit>
+    void queryPoint(const glm::vec2& point, Visit visit) const {
+        query(glm::vec4(point.x, point.y, point.x, point.y), [&](uint32_t first, uint32_t count) {
+            for (uint32_t i = first; i < first + count; ++i)
+                visit(i);
+        });
+    }
+
+    size_t nodeCount() const { return m_nodes.size(); }
+    size_t memoryBytes() const { return m_nodes.size() * sizeof(Node); }
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct alignas(64) Node {
+        float minX[rtreeFanout], minY[rtreeFanout], maxX[rtreeFanout], maxY[rtreeFanout];   // child boxes
+        uint32_t firstChild = 0, childCount = 0;   // items for a leaf, nodes otherwise
+        uint32_t firstItem = 0, itemCount = 0;     // the run of items under this node
+    };
+    struct BuildLevel {
+        std::vector<uint32_t> children;   // entries of the level below, grouped rtreeFanout to a node
+        std::vector<glm::vec4> boxes;     // one per node
+    };
+    static_assert(rtreeFanout < 32, "child masks are 32-bit");
+    // Marks a stack entry whose subtree lies inside the query
+    static const uint32_t insideFlag = 0x80000000u;
+
+    std::vector<Node> m_nodes;   // breadth first, root at 0, leaves last
+    uint32_t m_firstLeaf = 0;
+    glm::vec4 m_bounds = glm::vec4(0.0f);
+    Stats m_stats;
+
+    static glm::vec4 unite(const glm::vec4& a, const glm::vec4& b) {
+        return glm::vec4(std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.z, b.z), std::max(a.w, b.w));
+    }
+    static bool overlaps(const glm::vec4& a, const glm::vec4& b) {
+        return a.x <= b.z && b.x <= a.z && a.y <= b.w && b.y <= a.w;
+    }
+    static bool contains(const glm::vec4& outer, const glm::vec4& inner) {
+        return inner.x >= outer.x && inner.z <= outer.z && inner.y >= outer.y && inner.w <= outer.w;
+    }
+
+    // Orders entries for packing: ceil(sqrt(nodes)) slices by centre x, each slice by centre y. Ties go by
+    // entry index, so the order (and the triangulation cache key that depends on it) is the same for any
+    // thread count.
+    static void sortTiles(std::vector<uint32_t>& entries, const std::vector<glm::vec4>& boxes, int threadCount) {
+        std::vector<float> centerX(boxes.size()), centerY(boxes.size());
+        parallelFor(static_cast<int>((boxes.size() + 4095) / 4096), threadCount, [&](int block) {
+            size_t end = std::min(boxes.size(), static_cast<size_t>(block + 1) * 4096);
+            for (size_t i = static_cast<size_t>(block) * 4096; i < end; ++i) {
+                centerX[i] = boxes[i].x + boxes[i].z;
+                centerY[i] = boxes[i].y + boxes[i].w;
+            }
+        });
+        parallelSort(entries, threadCount, [&](uint32_t a, uint32_t b) {
+            return centerX[a] < centerX[b] || (centerX[a] == centerX[b] && a < b);
+        });
+        size_t nodes = (entries.size() + rtreeFanout - 1) / rtreeFanout;
+        size_t slices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nodes))));
+        size_t sliceSize = slices * rtreeFanout;
+        int sliceCount = static_cast<int>((entries.size() + sliceSize - 1) / sliceSize);
+        parallelFor(sliceCount, threadCount, [&](int slice) {
+            auto first = entries.begin() + static_cast<size_t>(slice) * sliceSize;
+            auto end = entries.begin() + std::min(static_cast<size_t>(slice + 1) * sliceSize, entries.size());
+            std::sort(first, end, [&](uint32_t a, uint32_t b) {
+                return centerY[a] < centerY[b] || (centerY[a] == centerY[b] && a < b);
+            });
+        });
+    }
+};
+
+// Bounding boxes of all features, computed in parallel
+std::vector<glm::vec4> featureBounds(const FeatureSet& features, int threadCount) {
+    std::vector<glm::vec4> boxes(features.featureCount());
+    int blocks = static_cast<int>((boxes.size() + 4095) / 4096);
+    parallelFor(blocks, threadCount, [&](int block) {
+        size_t end = std::min(boxes.size(), static_cast<size_t>(block + 1) * 4096);
+        for (size_t f = static_cast<size_t>(block) * 4096; f < end; ++f)
+            boxes[f] = features.bounds(f);
+    });
+    return boxes;
+}
+
+// The features in a new order: feature i of the result is feature order[i] of the input
+FeatureSet reorderFeatures(const FeatureSet& features, const std::vector<uint32_t>& order, int threadCount) {
+    FeatureSet result;
+    size_t featureCount = order.size();
+    result.featureRings.resize(featureCount + 1);
+    result.categories.resize(featureCount);
+    result.featureRings[0] = 0;
+    for (size_t i = 0; i < featureCount; ++i) {
+        uint32_t f = order[i];
+        result.featureRings[i + 1] = result.featureRings[i] + (features.featureRings[f + 1] - features.featureRings[f]);
+        result.categories[i] = features.categories[f];
+    }
+    result.ringPoints.resize(result.featureRings.back() + 1);
+    result.ringPoints[0] = 0;
+    for (size_t i = 0; i < featureCount; ++i) {
+        uint32_t f = order[i];
+        uint32_t ring = result.featureRings[i];
+        for (uint32_t r = features.featureRings[f]; r < features.featureRings[f + 1]; ++r, ++ring)
+            result.ringPoints[ring + 1] = result.ringPoints[ring] + (features.ringPoints[r + 1] - features.ringPoints[r]);
+    }
+    result.points.resize(features.points.size());
+    int blocks = static_cast<int>((featureCount + 4095) / 4096);
+    parallelFor(blocks, threadCount, [&](int block) {
+        size_t end = std::min(featureCount, static_cast<size_t>(block + 1) * 4096);
+        for (size_t i = static_cast<size_t>(block) * 4096; i < end; ++i) {
+            uint32_t f = order[i];
+            std::copy(features.points.begin() + features.firstPoint(f), features.points.begin() + features.firstPoint(f) + features.pointCount(f),
+                      result.points.begin() + result.firstPoint(i));
+        }
+    });
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------
+// Simplification pyramid
+// ---------------------------------------------------------------------------------------------------------
+
+// Rings as shared arcs. Points with bitwise equal coordinates are one vertex, and a junction is a vertex whose
+// pair of neighbours differs between the rings passing through it. Rings are cut at their junctions; a ring
+// without one is a single closed arc from its lowest vertex, so two rings sharing that boundary still agree.
+// Every arc is stored once; ring r walks arcs ringArcs[ringArcStart[r], ringArcStart[r + 1]), each entry being
+// the arc index times two, plus one when the ring walks the arc backwards.
+// Shared boundaries must share their points (as in topologically clean data); a point lying on a neighbour's
+// edge without being one of its points makes that boundary two separate arcs.
+class ArcTopology {
+public:
+    std::vector<glm::vec2> vertices;
+    std::vector<uint32_t> arcStart = { 0 };   // arc a is arcVertices[arcStart[a], arcStart[a + 1])
+    std::vector<uint32_t> arcVertices;
+    std::vector<uint32_t> ringArcStart;
+    std::vector<uint32_t> ringArcs;
+
+    size_t arcCount() const { return arcStart.size() - 1; }
+    size_t ringCount() const { return ringArcStart.size() - 1; }
+
+    void build(const FeatureSet& features, int threadCount) {
+        size_t pointCount = features.points.size();
+        size_t ringCount = features.ringPoints.size() - 1;
+
+        // Vertices: the points sorted by coordinate bits, equal runs merged
+        std::vector<std::pair<uint64_t, uint32_t>> keyed(pointCount);
+        parallelFor(blockCount(pointCount), threadCount, [&](int block) {
+            for (size_t i = blockBegin(block), end = blockEnd(block, pointCount); i < end; ++i)
+                keyed[i] = std::make_pair(coordinateKey(features.points[i]), static_cast<uint32_t>(i));
+        });
+        parallelSort(keyed, threadCount, [](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b) { return a < b; });
+        std::vector<uint32_t> vertexOf(pointCount);
+        vertices.clear();
+        for (size_t i = 0; i < pointCount; ++i) {
+            if (i == 0 || keyed[i].first != keyed[i - 1].first)
+                vertices.push_back(features.points[keyed[i].second]);
+            vertexOf[keyed[i].second] = static_cast<uint32_t>(vertices.size() - 1);
+        }
+        keyed = std::vector<std::pair<uint64_t, uint32_t>>();
+
+        // Each ring as a cycle of vertices without repeats; rings left with fewer than 3 get no arcs
+        std::vector<uint32_t> cycleStart(ringCount + 1, 0), cycles;
+        cycles.reserve(pointCount);
+        for (size_t r = 0; r < ringCount; ++r) {
+            size_t start = cycles.size();
+            for (uint32_t i = features.ringPoints[r]; i < features.ringPoints[r + 1]; ++i) {
+                if (cycles.size() == start || cycles.back() != vertexOf[i])
+                    cycles.push_back(vertexOf[i]);
+            }
+            while (cycles.size() - start > 1 && cycles.back() == cycles[start])
+                cycles.pop_back();
+            if (cycles.size() - start < 3)
+                cycles.resize(start);
+            cycleStart[r + 1] = static_cast<uint32_t>(cycles.size());
+        }
+        auto cycleVertex = [&](size_t r, size_t position) {
+            size_t length = cycleStart[r + 1] - cycleStart[r];
+            return cycles[cycleStart[r] + position % length];
+        };
+
+        // Junctions: sort every (vertex, neighbour pair) occurrence; a vertex met with two different pairs is one
+        std::vector<Occurrence> occurrences(cycles.size());
+        parallelFor(blockCount(ringCount), threadCount, [&](int block) {
+            for (size_t r = blockBegin(block), end = blockEnd(block, ringCount); r < end; ++r) {
+                size_t length = cycleStart[r + 1] - cycleStart[r];
+                for (size_t p = 0; p < length; ++p) {
+                    uint32_t prev = cycleVertex(r, p + length - 1), next = cycleVertex(r, p + 1);
+                    occurrences[cycleStart[r] + p] = Occurrence{ cycleVertex(r, p), std::min(prev, next), std::max(prev, next) };
+                }
+            }
+        });
+        parallelSort(occurrences, threadCount, [](const Occurrence& a, const Occurrence& b) {
+            return a.vertex != b.vertex ? a.vertex < b.vertex : a.low != b.low ? a.low < b.low : a.high < b.high;
+        });
+        std::vector<uint8_t> junction(vertices.size(), 0);
+        for (size_t i = 1; i < occurrences.size(); ++i) {
+            if (occurrences[i].vertex == occurrences[i - 1].vertex &&
+                (occurrences[i].low != occurrences[i - 1].low || occurrences[i].high != occurrences[i - 1].high))
+                junction[occurrences[i].vertex] = 1;
+        }
+        occurrences = std::vector<Occurrence>();
+
+        // Arc uses: a ring with k junctions walks k arcs, one without walks one closed arc
+        ringArcStart.assign(ringCount + 1, 0);
+        parallelFor(blockCount(ringCount), threadCount, [&](int block) {
+            for (size_t r = blockBegin(block), end = blockEnd(block, ringCount); r < end; ++r) {
+                uint32_t junctions = 0;
+                for (uint32_t i = cycleStart[r]; i < cycleStart[r + 1]; ++i)
+                    junctions += junction[cycles[i]];
+                ringArcStart[r + 1] = cycleStart[r + 1] > cycleStart[r] ? std::max(junctions, 1u) : 0;
+            }
+        });
+        for (size_t r = 0; r < ringCount; ++r)
+            ringArcStart[r + 1] += ringArcStart[r];
+        size_t useCount = ringArcStart[ringCount];
+        std::vector<ArcUse> uses(useCount);
+        std::vector<std::pair<uint64_t, uint32_t>> useKeys(useCount);
+        parallelFor(blockCount(ringCount), threadCount, [&](int block) {
+            std::vector<uint32_t> cuts;
+            for (size_t r = blockBegin(block), end = blockEnd(block, ringCount); r < end; ++r) {
+                uint32_t length = cycleStart[r + 1] - cycleStart[r];
+                if (length == 0)
+                    continue;
+                cuts.clear();
+                for (uint32_t p = 0; p < length; ++p)
+                    if (junction[cycleVertex(r, p)])
+                        cuts.push_back(p);
+                if (cuts.empty()) {
+                    uint32_t lowest = 0;
+                    for (uint32_t p = 1; p < length; ++p)
+                        if (cycleVertex(r, p) < cycleVertex(r, lowest))
+                            lowest = p;
+                    cuts.push_back(lowest);
+                }
+                for (size_t c = 0; c < cuts.size(); ++c) {
+                    ArcUse use;
+                    use.ring = static_cast<uint32_t>(r);
+                    use.begin = cuts[c];
+                    use.edges = (c + 1 < cuts.size() ? cuts[c + 1] : cuts[0] + length) - cuts[c];
+                    uint64_t forward = static_cast<uint64_t>(cycleVertex(r, use.begin)) << 32 | cycleVertex(r, use.begin + 1);
+                    uint64_t backward = static_cast<uint64_t>(cycleVertex(r, use.begin + use.edges)) << 32 | cycleVertex(r, use.begin + use.edges - 1);
+                    use.reversed = backward < forward;
+                    size_t index = ringArcStart[r] + c;
+                    uses[index] = use;
+                    useKeys[index] = std::make_pair(std::min(forward, backward), static_cast<uint32_t>(index));
+                }
+            }
+        });
+
+        // Uses with the same key walk the same arc; the arc is stored in its key's direction
+        parallelSort(useKeys, threadCount, [](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b) { return a < b; });
+        ringArcs.resize(useCount);
+        std::vector<uint32_t> arcFirstUse;
+        arcStart.assign(1, 0);
+        for (size_t i = 0; i < useCount; ++i) {
+            uint32_t use = useKeys[i].second;
+            if (i == 0 || useKeys[i].first != useKeys[i - 1].first) {
+                arcFirstUse.push_back(use);
+                arcStart.push_back(arcStart.back() + uses[use].edges + 1);
+            }
+            ringArcs[use] = static_cast<uint32_t>(arcFirstUse.size() - 1) * 2 + (uses[use].reversed ? 1 : 0);
+        }
+        arcVertices.resize(arcStart.back());
+        parallelFor(blockCount(arcFirstUse.size()), threadCount, [&](int block) {
+            for (size_t a = blockBegin(block), end = blockEnd(block, arcFirstUse.size()); a < end; ++a) {
+                const ArcUse& use = uses[arcFirstUse[a]];
+                for (uint32_t e = 0; e <= use.edges; ++e) {
+                    uint32_t position = use.reversed ? use.begin + use.edges - e : use.begin + e;
+                    arcVertices[arcStart[a] + e] = cycleVertex(use.ring, position);
+                }
+            }
+        });
+    }
+
+private:
+    struct Occurrence {
+        uint32_t vertex, low, high;
+    };
+    struct ArcUse {
+        uint32_t ring = 0, begin = 0, edges = 0;   // cycle positions [begin, begin + edges], wrapping
+        bool reversed = false;
+    };
+
+    // Coordinate bits; adding zero folds -0 into +0
+    static uint64_t coordinateKey(const glm::vec2& p) {
+        float x = p.x + 0.0f, y = p.y + 0.0f;
+        uint32_t xBits, yBits;
+        memcpy(&xBits, &x, sizeof(xBits));
+        memcpy(&yBits, &y, sizeof(yBits));
+        return static_cast<uint64_t>(xBits) << 32 | yBits;
+    }
+
+    static int blockCount(size_t count) { return static_cast<int>((count + 4095) / 4096); }
+    static size_t blockBegin(int block) { return static_cast<size_t>(block) * 4096; }
+    static size_t blockEnd(int block, size_t count) { return std::min(count, static_cast<size_t>(block + 1) * 4096); }
+};
+
+// Douglas-Peucker over one arc, end points always kept. force keeps the first split point (the one farthest
+// from the chord) whatever its distance. A closed arc is first split at the point farthest from its start and
+// both halves are forced, so a closed ring keeps at least four points. One per thread; scratch is reused.
+class ArcSimplifier {
+public:
+    void simplify(const ArcTopology& topology, size_t arc, float tolerance, bool force, std::vector<uint32_t>& kept) {
+        const uint32_t* vertices = topology.arcVertices.data() + topology.arcStart[arc];
+        uint32_t count = topology.arcStart[arc + 1] - topology.arcStart[arc];
+        m_keep.assign(count, 0);
+        m_keep[0] = 1;
+        m_keep[count - 1] = 1;
+        m_stack.clear();
+        auto position = [&](uint32_t i) { return topology.vertices[vertices[i]]; };
+        if (vertices[0] == vertices[count - 1] && count > 3) {
+            uint32_t farthest = 1;
+            float farthestDistance = -1.0f;
+            for (uint32_t i = 1; i + 1 < count; ++i) {
+                glm::vec2 d = position(i) - position(0);
+                float distance = d.x * d.x + d.y * d.y;
+                if (distance > farthestDistance) {
+                    farthest = i;
+                    farthestDistance = distance;
+                }
+            }
+            m_keep[farthest] = 1;
+            m_stack.push_back(Span{ 0, farthest, true });
+            m_stack.push_back(Span{ farthest, count - 1, true });
+        } else {
+            m_stack.push_back(Span{ 0, count - 1, force });
+        }
+
+        float toleranceSquared = tolerance * tolerance;
+        while (!m_stack.empty()) {
+            Span span = m_stack.back();
+            m_stack.pop_back();
+            if (span.last - span.first < 2)
+                continue;
+            glm::vec2 a = position(span.first), b = position(span.last);
+            uint32_t split = span.first + 1;
+            float splitDistance = -1.0f;
+            for (uint32_t i = span.first + 1; i < span.last; ++i) {
+                float distance = segmentDistanceSquared(position(i), a, b);
+                if (distance > splitDistance) {
+                    split = i;
+                    splitDistance = distance;
+                }
+            }
+            if (!span.forced && splitDistance <= toleranceSquared)
+                continue;
+            m_keep[split] = 1;
+            m_stack.push_back(Span{ span.first, split, false });
+            m_stack.push_back(Span{ split, span.last, false });
+        }
+        for (uint32_t i = 0; i < count; ++i)
+            if (m_keep[i])
+                kept.push_back(vertices[i]);
+    }
+
+private:
+    struct Span {
+        uint32_t first, last;
+        bool forced;
+    };
+    std::vector<uint8_t> m_keep;
+    std::vector<Span> m_stack;
+
+    static float segmentDistanceSquared(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b) {
+        glm::vec2 ab = b - a, ap = p - a;
+        float lengthSquared = ab.x * ab.x + ab.y * ab.y;
+        float t = lengthSquared > 0.0f ? std::max(0.0f, std::min(1.0f, (ap.x * ab.x + ap.y * ab.y) / lengthSquared)) : 0.0f;
+        glm::vec2 d = ap - ab * t;
+        return d.x * d.x + d.y * d.y;
+    }
+};
+
+// Level 0 is the full geometry; level L holds every ring rebuilt from its arcs simplified to
+// simplifyTolerance pixels of that level. Feature and ring numbering are the same at every level.
+class VectorPyramid {
+public:
+    void build(const FeatureSet& full, int threadCount) {
+        auto start = std::chrono::steady_clock::now();
+        ArcTopology topology;
+        topology.build(full, threadCount);
+        printf("Topology: %zu vertices, %zu arcs in %.1f ms\n", topology.vertices.size(), topology.arcCount(), millisecondsSince(start));
+
+        m_levels.assign(vectorLevelCount, FeatureSet());
+        m_levels[0] = full;
+        int arcBlocks = static_cast<int>((topology.arcCount() + 4095) / 4096);
+        for (int level = 1; level < vectorLevelCount; ++level) {
+            start = std::chrono::steady_clock::now();
+            float tolerance = simplifyTolerance * worldPerPixel() * static_cast<float>(1 << level);
+
+            // Arcs in parallel blocks; a second pass forces a point into the arcs of rings that fell below three
+            std::vector<uint8_t> force(topology.arcCount(), 0);
+            std::vector<uint32_t> keptStart, kept;
+            int forcedRings = 0;
+            for (int pass = 0; pass < 2; ++pass) {
+                std::vector<std::vector<uint32_t>> blockKept(arcBlocks), blockCounts(arcBlocks);
+                parallelFor(arcBlocks, threadCount, [&](int block) {
+                    ArcSimplifier simplifier;
+                    size_t end = std::min(topology.arcCount(), static_cast<size_t>(block + 1) * 4096);
+                    for (size_t arc = static_cast<size_t>(block) * 4096; arc < end; ++arc) {
+                        size_t before = blockKept[block].size();
+                        simplifier.simplify(topology, arc, tolerance, force[arc] != 0, blockKept[block]);
+                        blockCounts[block].push_back(static_cast<uint32_t>(blockKept[block].size() - before));
+                    }
+                });
+                keptStart.assign(1, 0);
+                kept.clear();
+                for (int block = 0; block < arcBlocks; ++block) {
+                    for (uint32_t count : blockCounts[block])
+                        keptStart.push_back(keptStart.back() + count);
+                    kept.insert(kept.end(), blockKept[block].begin(), blockKept[block].end());
+                }
+                if (pass == 1)
+                    break;
+                for (size_t ring = 0; ring < topology.ringCount(); ++ring) {
+                    if (ringPointCount(topology, keptStart, ring) >= 3 || topology.ringArcStart[ring] == topology.ringArcStart[ring + 1])
+                        continue;
+                    for (uint32_t use = topology.ringArcStart[ring]; use < topology.ringArcStart[ring + 1]; ++use)
+                        force[topology.ringArcs[use] / 2] = 1;
+                    ++forcedRings;
+                }
+                if (forcedRings == 0)
+                    break;
+            }
+
+            // Rings rebuilt from their arcs, rings in parallel; each arc contributes all but its last point
+            FeatureSet& features = m_levels[level];
+            features.featureRings = full.featureRings;
+            features.categories = full.categories;
+            features.ringPoints.assign(topology.ringCount() + 1, 0);
+            for (size_t ring = 0; ring < topology.ringCount(); ++ring)
+                features.ringPoints[ring + 1] = features.ringPoints[ring] + ringPointCount(topology, keptStart, ring);
+            features.points.resize(features.ringPoints.back());
+            int ringBlocks = static_cast<int>((topology.ringCount() + 4095) / 4096);
+            parallelFor(ringBlocks, threadCount, [&](int block) {
+                size_t end = std::min(topology.ringCount(), static_cast<size_t>(block + 1) * 4096);
+                for (size_t ring = static_cast<size_t>(block) * 4096; ring < end; ++ring) {
+                    uint32_t out = features.ringPoints[ring];
+                    for (uint32_t use = topology.ringArcStart[ring]; use < topology.ringArcStart[ring + 1]; ++use) {
+                        uint32_t arc = topology.ringArcs[use] / 2;
+                        bool reversed = (topology.ringArcs[use] & 1) != 0;
+                        uint32_t first = keptStart[arc], last = keptStart[arc + 1] - 1;
+                        for (uint32_t i = 0; i < last - first; ++i)
+                            features.points[out++] = topology.vertices[kept[reversed ? last - i : first + i]];
+                    }
+                }
+            });
+            printf("Level %d: tolerance %.2g, %zu points (%.1f%% of full), %d rings kept at three points, %.1f ms\n", level, tolerance,
+                   features.points.size(), 100.0 * features.points.size() / std::max<size_t>(full.points.size(), 1), forcedRings, millisecondsSince(start));
+        }
+    }
+
+    float worldPerPixel() const { return 2.0f / levelZeroWidth; }
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    const FeatureSet& level(int level) const { return m_levels[level]; }
+
+    // As for raster tiles: the coarsest level whose pixels are no larger than a screen pixel
+    int selectLevel(const Camera& camera, int framebufferWidth, int framebufferHeight) const {
+        float screenPixelsPerWorld = camera.getScale() * 0.5f * std::max(framebufferWidth, framebufferHeight);
+        float texelsPerScreenPixel = 1.0f / (worldPerPixel() * screenPixelsPerWorld);
+        int level = static_cast<int>(std::floor(std::log2(std::max(texelsPerScreenPixel, 1e-6f)) + lodBias));
+        return std::max(0, std::min(level, levelCount() - 1));
+    }
+
+private:
+    std::vector<FeatureSet> m_levels;
+
+    static uint32_t ringPointCount(const ArcTopology& topology, const std::vector<uint32_t>& keptStart, size_t ring) {
+        uint32_t count = 0;
+        for (uint32_t use = topology.ringArcStart[ring]; use < topology.ringArcStart[ring + 1]; ++use) {
+            uint32_t arc = topology.ringArcs[use] / 2;
+            count += keptStart[arc + 1] - keptStart[arc] - 1;
+        }
+        return count;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------
+// Drawing
+// ---------------------------------------------------------------------------------------------------------
+
+enum class ColorScheme { Category, Area, Random };
+
+const char* colorSchemeNames[] = { "land use", "area", "random" };
+
+// RGBA8 fill per feature
+void computeStyles(const FeatureSet& features, ColorScheme scheme, std::vector<uint32_t>& styles) {
+    static const uint8_t palette[categoryCount][3] = {
+        { 230, 85, 13 }, { 49, 130, 189 }, { 49, 163, 84 }, { 253, 208, 162 },
+        { 158, 154, 200 }, { 255, 237, 111 }, { 188, 128, 189 }, { 141, 211, 199 },
+    };
+    auto pack = [](float r, float g, float b) {
+        uint32_t alpha = static_cast<uint32_t>(fillOpacity * 255.0f + 0.5f);
+        return static_cast<uint32_t>(r) | (static_cast<uint32_t>(g) << 8) | (static_cast<uint32_t>(b) << 16) | (alpha << 24);
+    };
+    styles.resize(features.featureCount());
+    for (size_t f = 0; f < features.featureCount(); ++f) {
+        if (scheme == ColorScheme::Category) {
+            const uint8_t* c = palette[features.categories[f] % categoryCount];
+            styles[f] = pack(c[0], c[1], c[2]);
+        } else if (scheme == ColorScheme::Area) {
+            glm::vec4 box = features.bounds(f);
+            float area = (box.z - box.x) * (box.w - box.y);
+            float t = std::min(1.0f, std::max(0.0f, (std::log10(std::max(area, 1e-12f)) + 6.0f) / 3.0f));
+            styles[f] = pack(255.0f * t, 80.0f, 255.0f * (1.0f - t));
+        } else {
+            uint32_t h = static_cast<uint32_t>(f) * 2654435761u;
+            styles[f] = pack(static_cast<float>(h & 0xFF), static_cast<float>((h >> 8) & 0xFF), static_cast<float>((h >> 16) & 0xFF));
+        }
+    }
+}
+
+// Every pyramid level as one vertex buffer and two index buffers in feature order, sharing one style buffer;
+// the index reports the visible runs of features and each run is one range of a multi-draw on the chosen level
+class PolygonOverlay {
+public:
+    const char* vertexShaderSource = R"(
+layout (location = 0) in vec2 position;
+layout (location = 1) in uint feature;
+
+uniform samplerBuffer styles;   // RGBA8 per feature
+uniform int outlinePass;
+
+out vec4 color;
+
+void main()
+{
+    vec4 style = texelFetch(styles, int(feature));
+    color = outlinePass != 0 ? vec4(style.rgb * 0.45, style.a > 0.0 ? 1.0 : 0.0) : style;
+    gl_Position = viewProjection * vec4(position, 0.0, 1.0);
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec4 color;
+
+void main()
+{
+    if (color.a == 0.0)
+        discard;
+    FragColor = color;
+}
+)";
+    GLuint shaderProgram;
+    GLuint styleBuffer, styleTexture;
+    GLint stylesLoc, outlinePassLoc;
+    bool showFill = true, showOutlines = true;
+    int drawCalls = 0, visibleRuns = 0;
+    size_t visibleFeatures = 0;
+    long long trianglesDrawn = 0, trianglesAtFullDetail = 0, outlineVerticesDrawn = 0, outlineVerticesAtFullDetail = 0;
+    double queryMicroseconds = 0.0;
+
+    void init(Camera* camera, const VectorPyramid& pyramid, const std::vector<Triangulation>& triangulations, const std::vector<uint32_t>& styles) {
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        stylesLoc = glGetUniformLocation(shaderProgram, "styles");
+        outlinePassLoc = glGetUniformLocation(shaderProgram, "outlinePass");
+
+        size_t bytes = 0;
+        m_levels.resize(pyramid.levelCount());
+        for (int l = 0; l < pyramid.levelCount(); ++l)
+            bytes += initLevel(m_levels[l], pyramid.level(l), triangulations[l]);
+
+        glGenBuffers(1, &styleBuffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, styleBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, styles.size() * sizeof(uint32_t), styles.data(), GL_DYNAMIC_DRAW);
+        glGenTextures(1, &styleTexture);
+        glBindTexture(GL_TEXTURE_BUFFER, styleTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA8, styleBuffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        printf("Overlay: %d levels, %.1f MB of buffers (level 0 %.1f MB)\n", pyramid.levelCount(),
+               (bytes + styles.size() * sizeof(uint32_t)) / 1048576.0, m_levels[0].bytes / 1048576.0);
+    }
+
+    // Replaces the styles of features [first, first + count)
+    void updateStyles(const uint32_t* styles, size_t first, size_t count) {
+        glBindBuffer(GL_TEXTURE_BUFFER, styleBuffer);
+        glBufferSubData(GL_TEXTURE_BUFFER, first * sizeof(uint32_t), count * sizeof(uint32_t), styles);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // Collects the visible runs of features and their index ranges on one level; the run arrays keep their
+    // capacity, so a frame allocates nothing once the view has been at its widest
+    void cull(const Camera& camera, const FeatureIndex& index, int level) {
+        auto start = std::chrono::steady_clock::now();
+        m_runFirst.clear();
+        m_runEnd.clear();
+        visibleFeatures = 0;
+        index.query(camera.getVisibleRect(), [&](uint32_t first, uint32_t count) {
+            visibleFeatures += count;
+            if (!m_runEnd.empty() && m_runEnd.back() == first) {
+                m_runEnd.back() = first + count;
+            } else {
+                m_runFirst.push_back(first);
+                m_runEnd.push_back(first + count);
+            }
+        });
+        visibleRuns = static_cast<int>(m_runFirst.size());
+
+        const LevelBuffers& buffers = m_levels[level];
+        const LevelBuffers& full = m_levels[0];
+        m_fillCounts.resize(m_runFirst.size());
+        m_fillOffsets.resize(m_runFirst.size());
+        m_outlineCounts.resize(m_runFirst.size());
+        m_outlineOffsets.resize(m_runFirst.size());
+        trianglesDrawn = trianglesAtFullDetail = outlineVerticesDrawn = outlineVerticesAtFullDetail = 0;
+        for (size_t r = 0; r < m_runFirst.size(); ++r) {
+            uint32_t fillFirst = buffers.fillStart[m_runFirst[r]], fillEnd = buffers.fillStart[m_runEnd[r]];
+            uint32_t outlineFirst = buffers.outlineStart[m_runFirst[r]], outlineEnd = buffers.outlineStart[m_runEnd[r]];
+            m_fillCounts[r] = static_cast<GLsizei>(fillEnd - fillFirst);
+            m_fillOffsets[r] = reinterpret_cast<const void*>(static_cast<size_t>(fillFirst) * sizeof(uint32_t));
+            m_outlineCounts[r] = static_cast<GLsizei>(outlineEnd - outlineFirst);
+            m_outlineOffsets[r] = reinterpret_cast<const void*>(static_cast<size_t>(outlineFirst) * sizeof(uint32_t));
+            trianglesDrawn += (fillEnd - fillFirst) / 3;
+            outlineVerticesDrawn += outlineEnd - outlineFirst;
+            trianglesAtFullDetail += (full.fillStart[m_runEnd[r]] - full.fillStart[m_runFirst[r]]) / 3;
+            outlineVerticesAtFullDetail += full.outlineStart[m_runEnd[r]] - full.outlineStart[m_runFirst[r]];
+        }
+        m_culledLevel = level;
+        queryMicroseconds = millisecondsSince(start) * 1000.0;
+    }
+
+    // Draws what the last cull() found, on its level
+    void render(const Camera& camera) {
+        drawCalls = 0;
+        if (visibleRuns == 0)
+            return;
+
+        const LevelBuffers& buffers = m_levels[m_culledLevel];
+        glUseProgram(shaderProgram);
+        glBindVertexArray(buffers.VAO);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_BUFFER, styleTexture);
+        glUniform1i(stylesLoc, 0);
+        if (showFill) {
+            glUniform1i(outlinePassLoc, 0);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.fillEBO);
+            glMultiDrawElements(GL_TRIANGLES, m_fillCounts.data(), GL_UNSIGNED_INT, m_fillOffsets.data(), visibleRuns);
+            ++drawCalls;
+        }
+        // Outlines only once parcels are a few pixels wide; before that they would just cover the fill
+        if (showOutlines && camera.getScale() > 4.0f) {
+            glUniform1i(outlinePassLoc, 1);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.outlineEBO);
+            glMultiDrawElements(GL_LINES, m_outlineCounts.data(), GL_UNSIGNED_INT, m_outlineOffsets.data(), visibleRuns);
+            ++drawCalls;
+        }
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        for (LevelBuffers& buffers : m_levels) {
+            glDeleteVertexArrays(1, &buffers.VAO);
+            glDeleteBuffers(1, &buffers.VBO);
+            glDeleteBuffers(1, &buffers.fillEBO);
+            glDeleteBuffers(1, &buffers.outlineEBO);
+        }
+        glDeleteBuffers(1, &styleBuffer);
+        glDeleteTextures(1, &styleTexture);
+        glDeleteProgram(shaderProgram);
+    }
+
+private:
+    struct Vertex {
+        glm::vec2 position;
+        uint32_t feature;
+    };
+    struct LevelBuffers {
+        GLuint VAO = 0, VBO = 0, fillEBO = 0, outlineEBO = 0;
+        // Index buffer offsets of each feature; feature f owns [start[f], start[f + 1])
+        std::vector<uint32_t> fillStart, outlineStart;
+        size_t bytes = 0;
+    };
+    std::vector<LevelBuffers> m_levels;
+    int m_culledLevel = 0;
+    std::vector<uint32_t> m_runFirst, m_runEnd;
+    std::vector<GLsizei> m_fillCounts, m_outlineCounts;
+    std::vector<const void*> m_fillOffsets, m_outlineOffsets;
+
+    // Uploads one level; returns its buffer bytes
+    size_t initLevel(LevelBuffers& buffers, const FeatureSet& features, const Triangulation& triangulation) {
+        size_t featureCount = features.featureCount();
+        std::vector<Vertex> vertices(features.points.size());
+        std::vector<uint32_t> fill, outline;
+        fill.reserve(triangulation.indices.size());
+        outline.reserve(features.points.size() * 2);
+        buffers.fillStart.assign(1, 0);
+        buffers.outlineStart.assign(1, 0);
+        for (size_t f = 0; f < featureCount; ++f) {
+            uint32_t base = features.firstPoint(f);
+            for (uint32_t i = base, end = base + features.pointCount(f); i < end; ++i)
+                vertices[i] = Vertex{ features.points[i], static_cast<uint32_t>(f) };
+            for (uint32_t i = triangulation.featureIndices[f]; i < triangulation.featureIndices[f + 1]; ++i)
+                fill.push_back(base + triangulation.indices[i]);
+            for (uint32_t ring = features.featureRings[f]; ring < features.featureRings[f + 1]; ++ring) {
+                uint32_t start = features.ringPoints[ring], end = features.ringPoints[ring + 1];
+                for (uint32_t i = start; i < end; ++i) {
+                    outline.push_back(i);
+                    outline.push_back(i + 1 < end ? i + 1 : start);
+                }
+            }
+            buffers.fillStart.push_back(static_cast<uint32_t>(fill.size()));
+            buffers.outlineStart.push_back(static_cast<uint32_t>(outline.size()));
+        }
+
+        glGenVertexArrays(1, &buffers.VAO);
+        glGenBuffers(1, &buffers.VBO);
+        glGenBuffers(1, &buffers.fillEBO);
+        glGenBuffers(1, &buffers.outlineEBO);
+        glBindVertexArray(buffers.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+        glEnableVertexAttribArray(0);
+        glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(Vertex), (void*)offsetof(Vertex, feature));
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.fillEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, fill.size() * sizeof(uint32_t), fill.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.outlineEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, outline.size() * sizeof(uint32_t), outline.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        buffers.bytes = vertices.size() * sizeof(Vertex) + (fill.size() + outline.size()) * sizeof(uint32_t);
+        return buffers.bytes;
+    }
+};
+
+// The raster under the overlay: one image stretched over x in [-1, 1], keeping its aspect ratio
+class RasterBackground {
+public:
+    const char* vertexShaderSource = R"(
+uniform vec4 rect;   // world x0, y0, x1, y1
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = viewProjection * vec4(mix(rect.xw, rect.zy, corner), 0.0, 1.0);
+    texCoord = corner;
+}
+)";
+
+    const char* fragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 texCoord;
+
+uniform sampler2D tex0;
+
+void main()
+{
+    FragColor = texture(tex0, texCoord);
+}
+)";
+    GLuint shaderProgram = 0;
+    GLuint VAO = 0, texture = 0;
+    GLint rectLoc;
+    glm::vec4 rect;
+    bool visible = true;
+
+    bool init(Camera* camera, const std::string& imagePath) {
+        int width, height, nrChannels;
+        unsigned char* data = stbi_load(imagePath.c_str(), &width, &height, &nrChannels, STBI_rgb_alpha);
+        if (!data) {
+            std::cerr << "Failed to load raster " << imagePath << ", drawing the overlay alone" << std::endl;
+            return false;
+        }
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        stbi_image_free(data);
+
+        float halfHeight = static_cast<float>(height) / width;
+        rect = glm::vec4(-1.0f, -halfHeight, 1.0f, halfHeight);
+        shaderProgram = createCameraShaderProgram(vertexShaderSource, fragmentShaderSource);
+        camera->attachProgram(shaderProgram);
+        rectLoc = glGetUniformLocation(shaderProgram, "rect");
+        glGenVertexArrays(1, &VAO);
+        return true;
+    }
+
+    void render() {
+        if (!texture || !visible)
+            return;
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glUniform4f(rectLoc, rect.x, rect.y, rect.z, rect.w);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        if (!texture)
+            return;
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteTextures(1, &texture);
+        glDeleteProgram(shaderProgram);
+    }
+};
+
+int main(int argc, char** argv) {
+    std::string geoJsonPath;
+    std::string rasterPath = "src/textures/assets/test_nb.png";
+    int parcelCount = defaultParcelCount;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--parcels" && i + 1 < argc)
+            parcelCount = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--raster" && i + 1 < argc)
+            rasterPath = argv[++i];
+        else
+            geoJsonPath = arg;
+    }
+
+    FeatureSet loaded;
+    if (geoJsonPath.empty()) {
+        generateParcels(parcelCount, loaded);
+    } else if (!loadGeoJson(geoJsonPath, loaded)) {
+        std::cerr << "No polygons in " << geoJsonPath << std::endl;
+        return -1;
+    }
+
+    // Index first, then renumber the features in leaf order so every subtree is one run of features
+    int threadCount = resolveThreadCount();
+    auto start = std::chrono::steady_clock::now();
+    FeatureIndex index;
+    std::vector<uint32_t> order = index.build(featureBounds(loaded, threadCount), threadCount);
+    FeatureSet features = reorderFeatures(loaded, order, threadCount);
+    loaded = FeatureSet();
+    printf("R-tree: %zu nodes, %d levels in %.1f ms on %d threads\n", index.nodeCount(), index.stats().levels, millisecondsSince(start), threadCount);
+
+    start = std::chrono::steady_clock::now();
+    VectorPyramid pyramid;
+    pyramid.build(features, threadCount);
+    printf("Pyramid: %d levels in %.1f ms\n", pyramid.levelCount(), millisecondsSince(start));
+
+    // Triangulate every level once; later runs over the same geometry load the cached triangles
+    std::vector<Triangulation> triangulations(pyramid.levelCount());
+    start = std::chrono::steady_clock::now();
+    int cachedLevels = 0;
+    for (int level = 0; level < pyramid.levelCount(); ++level) {
+        uint64_t hash = geometryHash(pyramid.level(level));
+        std::string cachePath = triangulationCachePath(hash);
+        if (loadTriangulation(cachePath, hash, pyramid.level(level), triangulations[level])) {
+            ++cachedLevels;
+            continue;
+        }
+        triangulateAll(pyramid.level(level), threadCount, triangulations[level]);
+        saveTriangulation(cachePath, hash, triangulations[level]);
+    }
+    printf("Triangulated %d levels (%d from cache) in %.1f ms\n", pyramid.levelCount(), cachedLevels, millisecondsSince(start));
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow* window = glfwCreateWindow(800, 800, "OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    // No vsync, so the title shows what the overlay really costs
+    glfwSwapInterval(0);
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err) << std::endl;
+        return -1;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    Camera camera;
+    camera.initUniformBuffer();
+
+    RasterBackground raster;
+    raster.init(&camera, rasterPath);
+
+    ColorScheme scheme = ColorScheme::Category;
+    std::vector<uint32_t> styles;
+    computeStyles(features, scheme, styles);
+    PolygonOverlay overlay;
+    overlay.init(&camera, pyramid, triangulations, styles);
+
+    bool fillKeyDown = false, outlineKeyDown = false, schemeKeyDown = false, rasterKeyDown = false, detailKeyDown = false;
+    bool fullDetail = false;
+    int frame = 0;
+    int framesSinceTitle = 0;
+    double lastTitleTime = glfwGetTime();
+
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        camera.processKeyboardInput(window);
+
+        bool fillKeyPressed = glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS;
+        if (fillKeyPressed && !fillKeyDown)
+            overlay.showFill = !overlay.showFill;
+        fillKeyDown = fillKeyPressed;
+
+        bool outlineKeyPressed = glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS;
+        if (outlineKeyPressed && !outlineKeyDown)
+            overlay.showOutlines = !overlay.showOutlines;
+        outlineKeyDown = outlineKeyPressed;
+
+        bool rasterKeyPressed = glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS;
+        if (rasterKeyPressed && !rasterKeyDown)
+            raster.visible = !raster.visible;
+        rasterKeyDown = rasterKeyPressed;
+
+        // L: level 0 at every zoom, to compare against the pyramid
+        bool detailKeyPressed = glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS;
+        if (detailKeyPressed && !detailKeyDown)
+            fullDetail = !fullDetail;
+        detailKeyDown = detailKeyPressed;
+
+        // C: restyle every feature; only the style buffer is rewritten
+        bool schemeKeyPressed = glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS;
+        if (schemeKeyPressed && !schemeKeyDown) {
+            scheme = static_cast<ColorScheme>((static_cast<int>(scheme) + 1) % 3);
+            computeStyles(features, scheme, styles);
+            overlay.updateStyles(styles.data(), 0, styles.size());
+        }
+        schemeKeyDown = schemeKeyPressed;
+
+        int level = fullDetail ? 0 : pyramid.selectLevel(camera, width, height);
+        camera.publish(width, height);
+        overlay.cull(camera, index, level);
+        raster.render();
+        overlay.render(camera);
+
+        ++framesSinceTitle;
+        double now = glfwGetTime();
+        if (now - lastTitleTime > 0.5) {
+            char title[320];
+            snprintf(title, sizeof(title), "OpenGL - level %d%s | %zu of %zu features | %.2fM of %.2fM triangles, %.2fM of %.2fM outline vertices | %d draw calls | %.1f ms/frame",
+                     level, fullDetail ? " (full detail)" : "", overlay.visibleFeatures, features.featureCount(),
+                     overlay.trianglesDrawn / 1e6, overlay.trianglesAtFullDetail / 1e6,
+                     overlay.outlineVerticesDrawn / 1e6, overlay.outlineVerticesAtFullDetail / 1e6, overlay.drawCalls,
+                     1000.0 * (now - lastTitleTime) / framesSinceTitle);
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+            framesSinceTitle = 0;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        ++frame;
+    }
+
+    printf("Frames: %d\n", frame);
+
+    overlay.destroy();
+    raster.destroy();
+    camera.destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}